@@ -160,4 +160,6 @@ FMILIB_EXPORT const char* fmilib_get_build_stamp(void);
 #define jm_rpl_vsnprintf vsnprintf
 #endif
 
+#cmakedefine FMILIB_HAVE_AVX2
+
 #endif
@@ -18,6 +18,7 @@
 /* PATHs to test files */
 #define FMU1_DLL_ME_PATH @FMU1_DLL_ME_PATH@ 
 #define FMU1_DLL_CS_PATH @FMU1_DLL_CS_PATH@
+#define FMI2_CAPI_HOST_PATH @FMI2_CAPI_HOST_PATH@
 #define COMPRESS_DUMMY_FILE_PATH_SRC "@COMPRESS_DUMMY_FILE_PATH_SRC@"
 #define COMPRESS_DUMMY_FILE_PATH_DIST "@COMPRESS_DUMMY_FILE_PATH_DIST@"
 #define UNCOMPRESSED_DUMMY_FILE_PATH_SRC "@UNCOMPRESSED_DUMMY_FILE_PATH_SRC@"
@@ -22,18 +22,24 @@ include_directories("${FMICAPIDIR}/include" "${FMICAPIDIR}/src")
 set(FMICAPI_LIBRARIES fmicapi)
 
 set(FMICAPISOURCE
+    src/FMI/fmi_capi_registry.c
     src/FMI1/fmi1_capi_cs.c
     src/FMI1/fmi1_capi_me.c
     src/FMI1/fmi1_capi.c
+    src/FMI1/fmi1_capi_trace.c
     src/FMI2/fmi2_capi_cs.c
     src/FMI2/fmi2_capi_me.c
     src/FMI2/fmi2_capi.c
+    src/FMI2/fmi2_capi_trace.c
+    src/FMI2/fmi2_capi_remote.c
 )
 set(FMICAPIHEADERS
+	include/FMI/fmi_capi_registry.h
 	include/FMI1/fmi1_capi.h	
 	src/FMI1/fmi1_capi_impl.h
 	include/FMI2/fmi2_capi.h	
 	src/FMI2/fmi2_capi_impl.h
+	src/FMI2/fmi2_capi_remote.h
 )
  
 include_directories(${FMILIB_FMI_STANDARD_HEADERS})
@@ -45,6 +51,17 @@ add_library(fmicapi ${FMILIBKIND} ${FMICAPISOURCE} ${FMICAPIHEADERS})
 
 target_link_libraries(fmicapi ${JMUTIL_LIBRARIES})
 
+if(UNIX AND NOT APPLE)
+    target_compile_definitions(fmicapi PRIVATE -D_GNU_SOURCE)
+endif()
+
+# Host process for FMUs loaded with fmi2_capi_set_host()
+if(UNIX)
+	add_executable(fmi2_capi_host ${FMICAPIDIR}/src/FMI2/fmi2_capi_host.c)
+	target_link_libraries(fmi2_capi_host fmicapi)
+	install(TARGETS fmi2_capi_host RUNTIME DESTINATION bin)
+endif(UNIX)
+
 # install(DIRECTORY ${FMIXMLDIR}/include DESTINATION .)
 # install(DIRECTORY ${FMICAPIDIR}/include DESTINATION .)
 #install(DIRECTORY ${JMRUNTIMEHOME}/FMI/ZIP/include DESTINATION include)
@@ -41,12 +41,28 @@ set(FMIIMPORT_PUBHEADERS
 	include/FMI2/fmi2_import_variable.h
 	include/FMI2/fmi2_import_variable_list.h
 	include/FMI2/fmi2_import_convenience.h
+	include/FMI2/fmi2_import_jacobian.h
+	include/FMI2/fmi2_import_dependencies.h
+	include/FMI2/fmi2_import_instance.h
+	include/FMI2/fmi2_import_master.h
+	include/FMI2/fmi2_import_async.h
+	include/FMI2/fmi2_import_io_plan.h
+	include/FMI2/fmi2_import_checkpoint.h
+	include/FMI2/fmi2_import_ensemble.h
+	include/FMI2/fmi2_import_command_buffer.h
+	include/FMI2/fmi2_import_result_recorder.h
+	include/FMI2/fmi2_import_input_table.h
 
 	include/FMI/fmi_import_context.h
 	include/FMI/fmi_import_util.h
+	include/FMI/fmi_import_system_graph.h
+	include/FMI/fmi_import_solver.h
+	include/FMI/fmi_import_zero_crossing.h
  )
 							
 set(FMIIMPORT_PRIVHEADERS
+	src/FMI/fmi_import_zero_crossing_impl.h
+
 	src/FMI1/fmi1_import_impl.h
 	src/FMI1/fmi1_import_variable_list_impl.h
 
@@ -64,6 +80,9 @@ set(FMIIMPORTHEADERS
 set(FMIIMPORTSOURCE
 	src/FMI/fmi_import_context.c
 	src/FMI/fmi_import_util.c
+	src/FMI/fmi_import_system_graph.c
+	src/FMI/fmi_import_solver.c
+	src/FMI/fmi_import_zero_crossing.c
 	
 	src/FMI1/fmi1_import_cosim.c
 	src/FMI1/fmi1_import_capi.c
@@ -83,12 +102,40 @@ set(FMIIMPORTSOURCE
 	src/FMI2/fmi2_import_variable_list.c
 	src/FMI2/fmi2_import.c
 	src/FMI2/fmi2_import_convenience.c
+	src/FMI2/fmi2_import_jacobian.c
+	src/FMI2/fmi2_import_dependencies.c
+	src/FMI2/fmi2_import_instance.c
+	src/FMI2/fmi2_import_master.c
+	src/FMI2/fmi2_import_async.c
+	src/FMI2/fmi2_import_io_plan.c
+	src/FMI2/fmi2_import_checkpoint.c
+	src/FMI2/fmi2_import_ensemble.c
+	src/FMI2/fmi2_import_command_buffer.c
+	src/FMI2/fmi2_import_result_recorder.c
+	src/FMI2/fmi2_import_input_table.c
 	)
 
+# The AVX2 zero crossing kernel is built if the compiler can generate AVX2 code.
+# It is selected at run time if the processor supports it.
+if(MSVC)
+	set(FMILIB_AVX2_FLAG "/arch:AVX2")
+else()
+	set(FMILIB_AVX2_FLAG "-mavx2")
+endif()
+include(CheckCCompilerFlag)
+CHECK_C_COMPILER_FLAG(${FMILIB_AVX2_FLAG} FMILIB_HAVE_AVX2)
+if(FMILIB_HAVE_AVX2)
+	list(APPEND FMIIMPORTSOURCE src/FMI/fmi_import_zero_crossing_avx2.c)
+	set_source_files_properties(${FMIIMPORTDIR}/src/FMI/fmi_import_zero_crossing_avx2.c PROPERTIES COMPILE_FLAGS ${FMILIB_AVX2_FLAG})
+endif()
+
 PREFIXLIST(FMIIMPORTSOURCE  ${FMIIMPORTDIR}/)
 
 add_library(fmiimport ${FMILIBKIND} ${FMIIMPORTSOURCE} ${FMIIMPORTHEADERS})
 target_link_libraries(fmiimport ${JMUTIL_LIBRARIES} ${FMIXML_LIBRARIES} ${FMIZIP_LIBRARIES} ${FMICAPI_LIBRARIES})
+if(UNIX)
+	target_link_libraries(fmiimport m)
+endif(UNIX)
 #target_link_libraries(fmiimportshared fmiimport)
 
 #add_library(fmiimport_shared SHARED ${FMIIMPORTSOURCE} ${FMIIMPORTHEADERS} )
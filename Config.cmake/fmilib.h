@@ -27,5 +27,9 @@
 #include <FMI/fmi_import_context.h>
 #include <FMI1/fmi1_import.h>
 #include <FMI2/fmi2_import.h>
+#include <FMI/fmi_import_system_graph.h>
+#include <FMI/fmi_import_solver.h>
+#include <FMI/fmi_import_zero_crossing.h>
+#include <FMI/fmi_trace_recorder.h>
 
 #endif
@@ -22,8 +22,13 @@ set(JMUTILSOURCE
  JM/jm_templates_inst.c
  JM/jm_named_ptr.c
  JM/jm_portability.c
+ JM/jm_thread.c
+ JM/jm_thread_pool.c
+ JM/jm_log_queue.c
  FMI/fmi_version.c
  FMI/fmi_util.c
+ FMI/fmi_call_stats.c
+ FMI/fmi_trace_recorder.c
  
  FMI1/fmi1_enums.c
  FMI2/fmi2_enums.c
@@ -38,8 +43,13 @@ set(JMUTILHEADERS
   JM/jm_named_ptr.h
   JM/jm_string_set.h
   JM/jm_portability.h
+  JM/jm_thread.h
+  JM/jm_thread_pool.h
+  JM/jm_log_queue.h
   FMI/fmi_version.h
   FMI/fmi_util.h
+  FMI/fmi_call_stats.h
+  FMI/fmi_trace_recorder.h
 
   FMI1/fmi1_functions.h
   FMI1/fmi1_types.h
@@ -66,8 +76,11 @@ if(UNIX AND NOT APPLE)
     target_compile_definitions(jmutils PRIVATE -D_GNU_SOURCE)
 endif()
 
+find_package(Threads REQUIRED)
+target_link_libraries(jmutils ${CMAKE_THREAD_LIBS_INIT})
+
 if(UNIX)
-	target_link_libraries(jmutils dl)
+	target_link_libraries(jmutils dl m)
 endif(UNIX)
 if(WIN32)
 	target_link_libraries(jmutils Shlwapi)
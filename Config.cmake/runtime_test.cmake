@@ -24,12 +24,22 @@ if(FMILIB_TEST_LOCALE)
     target_compile_definitions(jm_locale_test PRIVATE -DFMILIB_TEST_LOCALE)
 endif()
 
+# Test: jm log queue
+add_executable (jm_log_queue_test ${RTTESTDIR}/jm_log_queue_test.c)
+target_link_libraries (jm_log_queue_test ${JMUTIL_LIBRARIES})
+add_executable (jm_thread_pool_test ${RTTESTDIR}/jm_thread_pool_test.c)
+target_link_libraries (jm_thread_pool_test ${JMUTIL_LIBRARIES})
+
+# Test: jm last error
+add_executable (jm_last_error_test ${RTTESTDIR}/jm_last_error_test.c)
+target_link_libraries (jm_last_error_test ${JMUTIL_LIBRARIES})
+
 #Create function that zipz the dummy FMUs 
 add_executable (compress_test_fmu_zip ${RTTESTDIR}/compress_test_fmu_zip.c)
 target_link_libraries (compress_test_fmu_zip ${FMIZIP_LIBRARIES})
 
 set_target_properties(
-	jm_vector_test jm_locale_test compress_test_fmu_zip
+	jm_vector_test jm_locale_test jm_log_queue_test jm_thread_pool_test jm_last_error_test compress_test_fmu_zip
     PROPERTIES FOLDER "Test")
 
 #Path to the executable
@@ -156,6 +166,14 @@ to_native_c_path(${TEST_OUTPUT_FOLDER}/tempfolder FMU_TEMPFOLDER)
 
 file(MAKE_DIRECTORY ${TEST_OUTPUT_FOLDER}/tempfolder)
 
+# Add a test that unpacks an FMU into a temporary folder of its own, so that it can run in parallel with other tests.
+# Further arguments are passed to the test after the folder.
+function(add_fmu_test TEST_NAME EXECUTABLE FMU_PATH)
+	file(MAKE_DIRECTORY ${TEST_OUTPUT_FOLDER}/tempfolder/${TEST_NAME})
+	to_native_c_path(${TEST_OUTPUT_FOLDER}/tempfolder/${TEST_NAME} TEST_TEMPFOLDER)
+	add_test(${TEST_NAME} ${EXECUTABLE} ${FMU_PATH} ${TEST_TEMPFOLDER} ${ARGN})
+endfunction()
+
 if(FMILIB_BUILD_BEFORE_TESTS)
 	add_test(
 		NAME ctest_build_all 
@@ -163,6 +181,9 @@ if(FMILIB_BUILD_BEFORE_TESTS)
 endif()
 
 add_test(ctest_jm_locale_test jm_locale_test)
+add_test(ctest_jm_log_queue_test jm_log_queue_test)
+add_test(ctest_jm_thread_pool_test jm_thread_pool_test)
+add_test(ctest_jm_last_error_test jm_last_error_test)
 
 ADD_TEST(ctest_fmi_zip_unzip_test fmi_zip_unzip_test)
 ADD_TEST(ctest_fmi_zip_zip_test fmi_zip_zip_test)
@@ -172,10 +193,10 @@ include(test_fmi2)
 
 ADD_TEST(ctest_fmi_import_test_no_xml fmi_import_test ${UNCOMPRESSED_DUMMY_FILE_PATH_SRC} ${TEST_OUTPUT_FOLDER})	
   set_tests_properties(ctest_fmi_import_test_no_xml PROPERTIES WILL_FAIL TRUE)
-ADD_TEST(ctest_fmi_import_test_me_1 fmi_import_test ${FMU_ME_PATH} ${FMU_TEMPFOLDER})
-ADD_TEST(ctest_fmi_import_test_cs_1 fmi_import_test ${FMU_CS_PATH} ${FMU_TEMPFOLDER})
-ADD_TEST(ctest_fmi_import_test_me_2 fmi_import_test ${FMU2_ME_PATH} ${FMU_TEMPFOLDER})
-ADD_TEST(ctest_fmi_import_test_cs_2 fmi_import_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_fmu_test(ctest_fmi_import_test_me_1 fmi_import_test ${FMU_ME_PATH})
+add_fmu_test(ctest_fmi_import_test_cs_1 fmi_import_test ${FMU_CS_PATH})
+add_fmu_test(ctest_fmi_import_test_me_2 fmi_import_test ${FMU2_ME_PATH})
+add_fmu_test(ctest_fmi_import_test_cs_2 fmi_import_test ${FMU2_CS_PATH})
 
 if(FMILIB_BUILD_BEFORE_TESTS)
 	SET_TESTS_PROPERTIES ( 
@@ -85,6 +85,8 @@ target_link_libraries (fmi_import_xml_test  ${FMILIBFORTEST}  )
 
 add_executable (fmi_import_me_test ${RTTESTDIR}/FMI1/fmi_import_me_test.c)
 target_link_libraries (fmi_import_me_test  ${FMILIBFORTEST})
+add_executable (fmi1_import_solver_test ${RTTESTDIR}/FMI1/fmi1_import_solver_test.c)
+target_link_libraries (fmi1_import_solver_test  ${FMILIBFORTEST})
 add_executable (fmi_import_cs_test ${RTTESTDIR}/FMI1/fmi_import_cs_test.c)
 target_link_libraries (fmi_import_cs_test  ${FMILIBFORTEST})
 
@@ -101,12 +103,14 @@ add_test(ctest_fmi1_variable_bad_type_variability_test fmi1_variable_bad_type_va
 add_test(ctest_fmi1_xml_parsing_test fmi1_import_default_experiment_test ${RTTESTDIR}/FMI1/parser_test_xmls/default_experiment/)
 add_test(ctest_fmi1_xml_parsing_test fmi1_xml_parsing_test ${RTTESTDIR}/FMI1/parser_test_xmls/)
 add_test(ctest_fmi1_type_definitions_test fmi1_type_definitions_test ${TYPE_DEFINITIONS_MODEL_DESC_DIR})
-ADD_TEST(ctest_fmi_import_me_test fmi_import_me_test ${FMU_ME_PATH} ${FMU_TEMPFOLDER})
-ADD_TEST(ctest_fmi_import_cs_test fmi_import_cs_test ${FMU_CS_PATH} ${FMU_TEMPFOLDER} "modelDescription_cs.xml")
-ADD_TEST(ctest_fmi_import_cs_tc_test fmi_import_cs_test ${FMU_CS_TC_PATH} ${FMU_TEMPFOLDER} "modelDescription_cs_tc.xml")
-# the next test relies on the output from the previous one.
+add_fmu_test(ctest_fmi_import_me_test fmi_import_me_test ${FMU_ME_PATH})
+add_fmu_test(ctest_fmi1_import_solver_test fmi1_import_solver_test ${FMU_ME_PATH})
+add_fmu_test(ctest_fmi_import_cs_test fmi_import_cs_test ${FMU_CS_PATH} "modelDescription_cs.xml")
+add_fmu_test(ctest_fmi_import_cs_tc_test fmi_import_cs_test ${FMU_CS_TC_PATH} "modelDescription_cs_tc.xml")
 ADD_TEST(ctest_fmi_import_xml_test_empty fmi_import_xml_test ${FMU_DUMMY_FOLDER})
-ADD_TEST(ctest_fmi_import_xml_test fmi_import_xml_test ${FMU_TEMPFOLDER})
+# the next test parses the FMU unpacked by ctest_fmi_import_cs_test.
+to_native_c_path(${TEST_OUTPUT_FOLDER}/tempfolder/ctest_fmi_import_cs_test FMU_CS_TEMPFOLDER)
+ADD_TEST(ctest_fmi_import_xml_test fmi_import_xml_test ${FMU_CS_TEMPFOLDER})
 add_test(ctest_fmi_import_xml_test_mf fmi_import_xml_test ${TEST_OUTPUT_FOLDER}/${FMU_DUMMY_MF_MODEL_IDENTIFIER}_mf)
   set_tests_properties(ctest_fmi_import_xml_test_mf PROPERTIES WILL_FAIL TRUE)
 
@@ -120,7 +124,7 @@ target_link_libraries (fmi1_logger_test  ${FMILIBFORTEST})
 set(logger_output_file "${TEST_OUTPUT_FOLDER}/fmi1_logger_test_output.txt")
 set(logger_reference_file "${RTTESTDIR}/FMI1/fmi1_logger_test_output.txt")
 
-add_test(ctest_fmi1_logger_test_run fmi1_logger_test ${FMU_ME_PATH} ${FMU_TEMPFOLDER} ${logger_output_file})
+add_fmu_test(ctest_fmi1_logger_test_run fmi1_logger_test ${FMU_ME_PATH} ${logger_output_file})
 
 if(NOT CMAKE_GENERATOR STREQUAL "MSYS Makefiles")
     # Skip test for MinGW, since we know it won't pass due to issues with long log messages and vsnprintf.
@@ -133,6 +137,7 @@ endif()
 
 set_target_properties(
 	fmi_import_me_test 
+	fmi1_import_solver_test
 	fmi_import_cs_test 
 	fmi_import_xml_test
 	fmi1_capi_cs_test
@@ -145,6 +150,7 @@ set_target_properties(
 if(FMILIB_BUILD_BEFORE_TESTS)
 	SET_TESTS_PROPERTIES ( 
 		ctest_fmi_import_me_test
+		ctest_fmi1_import_solver_test
 		ctest_fmi_import_cs_test 
 		ctest_fmi_import_xml_test
 		ctest_fmi_import_xml_test_empty
@@ -52,6 +52,8 @@ set(VARIABLE_BAD_TYPE_VARIABILITY_MODEL_DESC_DIR
     ${RTTESTDIR}/FMI2/parser_test_xmls/variable_bad_type_variability)
 set(TYPE_DEFINITIONS_MODEL_DESC_DIR
     ${RTTESTDIR}/FMI2/parser_test_xmls/type_definitions)
+set(JACOBIAN_MODEL_DESC_DIR
+    ${RTTESTDIR}/FMI2/parser_test_xmls/jacobian)
 
 set(SHARED_LIBRARY_ME_PATH ${CMAKE_CURRENT_BINARY_DIR}/${CMAKE_CFG_INTDIR}/${CMAKE_SHARED_LIBRARY_PREFIX}fmu2_dll_me${CMAKE_SHARED_LIBRARY_SUFFIX})
 set(SHARED_LIBRARY_CS_PATH ${CMAKE_CURRENT_BINARY_DIR}/${CMAKE_CFG_INTDIR}/${CMAKE_SHARED_LIBRARY_PREFIX}fmu2_dll_cs${CMAKE_SHARED_LIBRARY_SUFFIX})
@@ -65,6 +67,8 @@ to_native_c_path("\"${CMAKE_CURRENT_BINARY_DIR}/\" CMAKE_INTDIR \"/${CMAKE_SHARE
                  fmu2_DLL_ME_PATH)
 to_native_c_path("\"${CMAKE_CURRENT_BINARY_DIR}/\" CMAKE_INTDIR \"/${CMAKE_SHARED_LIBRARY_PREFIX}fmu2_dll_cs${CMAKE_SHARED_LIBRARY_SUFFIX}\""
                  fmu2_DLL_CS_PATH)
+to_native_c_path("\"${FMILibrary_BINARY_DIR}/\" CMAKE_INTDIR \"/fmi2_capi_host${CMAKE_EXECUTABLE_SUFFIX}\""
+                 FMI2_CAPI_HOST_PATH)
 
 #function(compress_fmu OUTPUT_FOLDER MODEL_IDENTIFIER FILE_NAME_CS_ME_EXT TARGET_NAME XML_PATH SHARED_LIBRARY_PATH)
 compress_fmu("${TEST_OUTPUT_FOLDER}" "${FMU2_DUMMY_ME_MODEL_IDENTIFIER}" "me" "fmu2_dll_me" "${XML_ME_PATH}" "${SHARED_LIBRARY_ME_PATH}")
@@ -104,6 +108,50 @@ add_executable(fmi2_variable_bad_type_variability_test
 target_link_libraries(fmi2_variable_bad_type_variability_test ${FMILIBFORTEST})
 add_executable(fmi2_enum_test ${RTTESTDIR}/FMI2/fmi2_enum_test.c)
 target_link_libraries(fmi2_enum_test ${FMILIBFORTEST})
+add_executable(fmi2_import_jacobian_test ${RTTESTDIR}/FMI2/fmi2_import_jacobian_test.c)
+target_link_libraries(fmi2_import_jacobian_test ${FMILIBFORTEST})
+add_executable(fmi2_import_system_graph_test ${RTTESTDIR}/FMI2/fmi2_import_system_graph_test.c)
+target_link_libraries(fmi2_import_system_graph_test ${FMILIBFORTEST})
+add_executable(fmi2_import_dependencies_test ${RTTESTDIR}/FMI2/fmi2_import_dependencies_test.c)
+target_link_libraries(fmi2_import_dependencies_test ${FMILIBFORTEST})
+add_executable(fmi2_import_instance_test ${RTTESTDIR}/FMI2/fmi2_import_instance_test.c)
+target_link_libraries(fmi2_import_instance_test ${FMILIBFORTEST})
+add_executable(fmi2_import_binary_cache_test ${RTTESTDIR}/FMI2/fmi2_import_binary_cache_test.c)
+target_link_libraries(fmi2_import_binary_cache_test ${FMILIBFORTEST})
+add_executable(fmi2_import_master_test ${RTTESTDIR}/FMI2/fmi2_import_master_test.c)
+target_link_libraries(fmi2_import_master_test ${FMILIBFORTEST})
+add_executable(fmi2_import_async_test ${RTTESTDIR}/FMI2/fmi2_import_async_test.c)
+target_link_libraries(fmi2_import_async_test ${FMILIBFORTEST})
+add_executable(fmi2_import_io_plan_test ${RTTESTDIR}/FMI2/fmi2_import_io_plan_test.c)
+target_link_libraries(fmi2_import_io_plan_test ${FMILIBFORTEST})
+add_executable(fmi2_import_solver_test ${RTTESTDIR}/FMI2/fmi2_import_solver_test.c)
+target_link_libraries(fmi2_import_solver_test ${FMILIBFORTEST})
+# Benchmarks are built with the tests but not run by ctest
+add_executable(fmi2_import_solver_benchmark ${RTTESTDIR}/FMI2/fmi2_import_solver_benchmark.c)
+target_link_libraries(fmi2_import_solver_benchmark ${FMILIBFORTEST})
+add_executable(fmi2_import_zero_crossing_test ${RTTESTDIR}/FMI2/fmi2_import_zero_crossing_test.c)
+target_link_libraries(fmi2_import_zero_crossing_test ${FMILIBFORTEST})
+add_executable(fmi2_import_checkpoint_test ${RTTESTDIR}/FMI2/fmi2_import_checkpoint_test.c)
+target_link_libraries(fmi2_import_checkpoint_test ${FMILIBFORTEST})
+add_executable(fmi2_import_ensemble_test ${RTTESTDIR}/FMI2/fmi2_import_ensemble_test.c)
+target_link_libraries(fmi2_import_ensemble_test ${FMILIBFORTEST})
+add_executable(fmi2_import_ensemble_benchmark ${RTTESTDIR}/FMI2/fmi2_import_ensemble_benchmark.c)
+target_link_libraries(fmi2_import_ensemble_benchmark ${FMILIBFORTEST})
+add_executable(fmi2_import_call_stats_test ${RTTESTDIR}/FMI2/fmi2_import_call_stats_test.c)
+target_link_libraries(fmi2_import_call_stats_test ${FMILIBFORTEST})
+add_executable(fmi2_import_trace_recorder_test ${RTTESTDIR}/FMI2/fmi2_import_trace_recorder_test.c)
+target_link_libraries(fmi2_import_trace_recorder_test ${FMILIBFORTEST})
+add_executable(fmi2_import_command_buffer_test ${RTTESTDIR}/FMI2/fmi2_import_command_buffer_test.c)
+target_link_libraries(fmi2_import_command_buffer_test ${FMILIBFORTEST})
+add_executable(fmi2_import_result_recorder_test ${RTTESTDIR}/FMI2/fmi2_import_result_recorder_test.c)
+target_link_libraries(fmi2_import_result_recorder_test ${FMILIBFORTEST})
+add_executable(fmi2_import_input_table_test ${RTTESTDIR}/FMI2/fmi2_import_input_table_test.c)
+target_link_libraries(fmi2_import_input_table_test ${FMILIBFORTEST})
+if(UNIX)
+	add_executable(fmi2_import_out_of_process_test ${RTTESTDIR}/FMI2/fmi2_import_out_of_process_test.c)
+	target_link_libraries(fmi2_import_out_of_process_test ${FMILIBFORTEST})
+	add_dependencies(fmi2_import_out_of_process_test fmi2_capi_host)
+endif(UNIX)
 
 set_target_properties(
     fmi2_xml_parsing_test
@@ -123,8 +171,8 @@ add_test(ctest_fmi2_import_xml_test_me fmi2_import_xml_test ${TEST_OUTPUT_FOLDER
 add_test(ctest_fmi2_import_xml_test_cs fmi2_import_xml_test ${TEST_OUTPUT_FOLDER}/${FMU2_DUMMY_CS_MODEL_IDENTIFIER}_cs)
 add_test(ctest_fmi2_import_xml_test_mf fmi2_import_xml_test ${TEST_OUTPUT_FOLDER}/${FMU2_DUMMY_MF_MODEL_IDENTIFIER}_mf)
 set_tests_properties(ctest_fmi2_import_xml_test_mf PROPERTIES WILL_FAIL TRUE)
-add_test(ctest_fmi2_import_test_me fmi2_import_me_test ${FMU2_ME_PATH} ${FMU_TEMPFOLDER})
-add_test(ctest_fmi2_import_test_cs fmi2_import_cs_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_fmu_test(ctest_fmi2_import_test_me fmi2_import_me_test ${FMU2_ME_PATH})
+add_fmu_test(ctest_fmi2_import_test_cs fmi2_import_cs_test ${FMU2_CS_PATH})
 add_test(ctest_fmi2_import_variable_test
          fmi2_import_variable_test
          ${VARIALBE_TEST_MODEL_DESC_DIR})
@@ -145,6 +193,33 @@ add_test(ctest_fmi2_type_definitions_test
          ${TYPE_DEFINITIONS_MODEL_DESC_DIR})
 add_test(ctest_fmi2_enum_test
          fmi2_enum_test)
+add_test(ctest_fmi2_import_jacobian_test
+         fmi2_import_jacobian_test
+         ${JACOBIAN_MODEL_DESC_DIR})
+add_test(ctest_fmi2_import_system_graph_test
+         fmi2_import_system_graph_test
+         ${JACOBIAN_MODEL_DESC_DIR})
+add_test(ctest_fmi2_import_dependencies_test
+         fmi2_import_dependencies_test
+         ${JACOBIAN_MODEL_DESC_DIR})
+add_fmu_test(ctest_fmi2_import_instance_test fmi2_import_instance_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_binary_cache_test fmi2_import_binary_cache_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_master_test fmi2_import_master_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_async_test fmi2_import_async_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_io_plan_test fmi2_import_io_plan_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_solver_test fmi2_import_solver_test ${FMU2_ME_PATH})
+add_test(ctest_fmi2_import_zero_crossing_test
+         fmi2_import_zero_crossing_test)
+add_fmu_test(ctest_fmi2_import_checkpoint_test fmi2_import_checkpoint_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_ensemble_test fmi2_import_ensemble_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_call_stats_test fmi2_import_call_stats_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_trace_recorder_test fmi2_import_trace_recorder_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_command_buffer_test fmi2_import_command_buffer_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_result_recorder_test fmi2_import_result_recorder_test ${FMU2_CS_PATH})
+add_fmu_test(ctest_fmi2_import_input_table_test fmi2_import_input_table_test ${FMU2_CS_PATH})
+if(UNIX)
+	add_fmu_test(ctest_fmi2_import_out_of_process_test fmi2_import_out_of_process_test ${FMU2_CS_PATH})
+endif(UNIX)
 
 if(FMILIB_BUILD_BEFORE_TESTS)
     SET_TESTS_PROPERTIES (
@@ -162,5 +237,25 @@ if(FMILIB_BUILD_BEFORE_TESTS)
         ctest_fmi2_enum_test
         ctest_fmi2_variable_bad_variability_causality_test
         ctest_fmi2_variable_bad_type_variability_test
+        ctest_fmi2_import_jacobian_test
+        ctest_fmi2_import_system_graph_test
+        ctest_fmi2_import_dependencies_test
+        ctest_fmi2_import_instance_test
+        ctest_fmi2_import_binary_cache_test
+        ctest_fmi2_import_master_test
+        ctest_fmi2_import_async_test
+        ctest_fmi2_import_io_plan_test
+        ctest_fmi2_import_solver_test
+        ctest_fmi2_import_zero_crossing_test
+        ctest_fmi2_import_checkpoint_test
+        ctest_fmi2_import_ensemble_test
+        ctest_fmi2_import_call_stats_test
+        ctest_fmi2_import_trace_recorder_test
+        ctest_fmi2_import_command_buffer_test
+        ctest_fmi2_import_result_recorder_test
+        ctest_fmi2_import_input_table_test
         PROPERTIES DEPENDS ctest_build_all)
+    if(UNIX)
+        SET_TESTS_PROPERTIES(ctest_fmi2_import_out_of_process_test PROPERTIES DEPENDS ctest_build_all)
+    endif(UNIX)
 endif()
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+
+/* The dummy FMU is a bouncing ball: HIGHT' = HIGHT_SPEED, HIGHT_SPEED' = GRAVITY, starting at 1 m with 4 m/s */
+#define GRAVITY -9.81
+#define BOUNCE_COF 0.5
+#define END_TIME 2.0
+
+/* Analytic states at END_TIME and the number of bounces before it */
+static void reference(fmi1_real_t *states, size_t *bounces)
+{
+    fmi1_real_t t0 = 0.0, x0 = 1.0, v0 = 4.0, tb, dt;
+
+    *bounces = 0;
+    for (;;) {
+        tb = t0 + (v0 + sqrt(v0 * v0 - 2.0 * GRAVITY * x0)) / -GRAVITY;
+        if (tb > END_TIME) break;
+        v0 = -BOUNCE_COF * (v0 + GRAVITY * (tb - t0));
+        x0 = 0.0;
+        t0 = tb;
+        (*bounces)++;
+    }
+    dt = END_TIME - t0;
+    states[0] = x0 + v0 * dt + 0.5 * GRAVITY * dt * dt;
+    states[1] = v0 + GRAVITY * dt;
+}
+
+static int simulate(fmi1_import_t *fmu, fmi_import_solver_method_enu_t method, fmi1_real_t *states, fmi_import_solver_stats_t *stats)
+{
+    fmi1_event_info_t eventInfo;
+    fmi_import_solver_t *s;
+
+    ASSERT_MSG(fmi1_import_instantiate_model(fmu, "solver") == jm_status_success, "could not instantiate the model");
+    ASSERT_MSG(fmi1_import_set_time(fmu, 0.0) == fmi1_status_ok, "could not set time");
+    ASSERT_MSG(fmi1_import_initialize(fmu, fmi1_false, 0.0, &eventInfo) == fmi1_status_ok, "could not initialize the model");
+
+    s = fmi1_import_solver_allocate(fmu, method);
+    ASSERT_MSG(s, "could not allocate solver");
+    ASSERT_MSG(fmi2_import_solver_initialize(s, 0.0) == fmi2_status_error, "solver accepted the wrong FMI version");
+    ASSERT_MSG(fmi_import_solver_set_step_size(s, 1e-3) == jm_status_success, "could not set step size");
+    ASSERT_MSG(fmi1_import_solver_initialize(s, 0.0, &eventInfo) == fmi1_status_ok, "could not initialize solver");
+    ASSERT_MSG(fmi_import_solver_integrate(s, END_TIME) == fmi1_status_ok, "integration failed");
+    ASSERT_MSG(fmi_import_solver_get_time(s) == END_TIME, "end time not reached");
+    memcpy(states, fmi_import_solver_get_states(s), 2 * sizeof(fmi1_real_t));
+    fmi_import_solver_get_stats(s, stats);
+    fmi_import_solver_free(s);
+
+    fmi1_import_terminate(fmu);
+    fmi1_import_free_model_instance(fmu);
+    return TEST_OK;
+}
+
+static int test_solver(fmi1_import_t *fmu)
+{
+    fmi_import_solver_stats_t stats;
+    fmi1_real_t states[2], ref[2];
+    size_t bounces;
+
+    reference(ref, &bounces);
+
+    /* fixed step: the bounces are handled at the end of the step that contains them */
+    ASSERT_MSG(simulate(fmu, fmi_import_solver_rk4, states, &stats), "simulation failed");
+    ASSERT_MSG(stats.stateEventsNum == bounces, "wrong number of bounces");
+    ASSERT_MSG(fabs(states[0] - ref[0]) < 0.05, "wrong height with RK4");
+
+    /* adaptive: the bounces are located */
+    ASSERT_MSG(simulate(fmu, fmi_import_solver_dopri5, states, &stats), "simulation failed");
+    ASSERT_MSG(stats.stateEventsNum == bounces, "wrong number of bounces");
+    ASSERT_MSG(fabs(states[0] - ref[0]) < 1e-9 && fabs(states[1] - ref[1]) < 1e-9, "wrong states with DOPRI5");
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    fmi1_callback_functions_t callBackFunctions;
+    jm_callbacks *cb = jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi1_import_t *fmu;
+    int ret = 1;
+
+    if (argc < 3) {
+        printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+        return CTEST_RETURN_FAIL;
+    }
+
+    printf("Running fmi1_import_solver_test\n");
+
+    callBackFunctions.logger = fmi1_log_forwarding;
+    callBackFunctions.allocateMemory = calloc;
+    callBackFunctions.freeMemory = free;
+
+    context = fmi_import_allocate_context(cb);
+    if (fmi_import_get_fmi_version(context, argv[1], argv[2]) != fmi_version_1_enu) {
+        printf("The code only supports version 1.0\n");
+        return CTEST_RETURN_FAIL;
+    }
+    fmu = fmi1_import_parse_xml(context, argv[2]);
+    if (!fmu || fmi1_import_create_dllfmu(fmu, callBackFunctions, 0) != jm_status_success) {
+        printf("Could not load the FMU\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_solver(fmu);
+
+    fmi1_import_destroy_dllfmu(fmu);
+    fmi1_import_free(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define FMUS_NUM 4
+#define STEPS_NUM 20
+#define STEP_SIZE 0.01
+
+/* Steps of FMUs without async support run on the queue threads and complete in any order */
+static int test_emulated(fmi_import_context_t *context, const char *dir)
+{
+    fmi2_import_t *fmus[FMUS_NUM], *ref;
+    fmi2_import_async_step_t *steps[FMUS_NUM];
+    fmi2_import_completion_queue_t *q;
+    fmi2_value_reference_t hight = 0;
+    fmi2_real_t expected, value;
+    int i, k, step, collected[FMUS_NUM];
+
+    ref = fmi2_test_load_started(context, dir, "async");
+    ASSERT_MSG(ref, "could not load FMU");
+    for (step = 0; step < STEPS_NUM; step++) {
+        fmi2_import_do_step(ref, step * STEP_SIZE, STEP_SIZE, fmi2_true);
+    }
+    fmi2_import_get_real(ref, &hight, 1, &expected);
+    fmi2_test_unload_started(ref);
+
+    q = fmi2_import_completion_queue_allocate(jm_get_default_callbacks(), 2);
+    ASSERT_MSG(q, "could not allocate queue");
+    for (i = 0; i < FMUS_NUM; i++) {
+        fmus[i] = fmi2_test_load_started(context, dir, "async");
+        ASSERT_MSG(fmus[i], "could not load FMU");
+        steps[i] = fmi2_import_async_step_allocate(q, fmus[i], fmi2_import_async_auto, &collected[i]);
+        ASSERT_MSG(steps[i], "could not allocate step");
+        ASSERT_MSG(!fmi2_import_async_step_is_native(steps[i]), "the test FMU cannot run asynchronously");
+    }
+    ASSERT_MSG(fmi2_import_async_step_allocate(q, fmus[0], fmi2_import_async_auto, NULL) == NULL,
+               "only one handle per FMU is allowed");
+
+    for (step = 0; step < STEPS_NUM; step++) {
+        for (i = 0; i < FMUS_NUM; i++) {
+            ASSERT_MSG(fmi2_import_async_step_submit(steps[i], step * STEP_SIZE, STEP_SIZE, fmi2_true) == fmi2_status_ok,
+                       "could not submit step");
+            collected[i] = 0;
+        }
+        for (k = 0; k < FMUS_NUM; k++) {
+            fmi2_import_async_step_t *done = fmi2_import_completion_queue_wait(q, -1);
+            ASSERT_MSG(done, "step not completed");
+            ASSERT_MSG(fmi2_import_async_step_get_status(done) == fmi2_status_ok, "step failed");
+            (*(int *)fmi2_import_async_step_get_user_data(done))++;
+        }
+        for (i = 0; i < FMUS_NUM; i++) {
+            ASSERT_MSG(collected[i] == 1, "each step must be reported once");
+        }
+        ASSERT_MSG(fmi2_import_completion_queue_poll(q) == NULL, "no step should be running");
+        ASSERT_MSG(fmi2_import_completion_queue_get_running_num(q) == 0, "no step should be running");
+    }
+
+    for (i = 0; i < FMUS_NUM; i++) {
+        fmi2_import_get_real(fmus[i], &hight, 1, &value);
+        ASSERT_MSG(value == expected, "asynchronous result differs from the synchronous one");
+    }
+
+    /* Wait on a single step, it is then not reported by the queue */
+    ASSERT_MSG(fmi2_import_async_step_submit(steps[0], STEPS_NUM * STEP_SIZE, STEP_SIZE, fmi2_true) == fmi2_status_ok,
+               "could not submit step");
+    ASSERT_MSG(fmi2_import_async_step_wait(steps[0]) == fmi2_status_ok, "step failed");
+    ASSERT_MSG(fmi2_import_async_step_is_done(steps[0]), "step should be done");
+    ASSERT_MSG(fmi2_import_completion_queue_poll(q) == NULL, "collected step must not be reported");
+
+    /* Running steps are waited for and handles are freed with the queue */
+    for (i = 1; i < FMUS_NUM; i++) {
+        fmi2_import_async_step_submit(steps[i], STEPS_NUM * STEP_SIZE, STEP_SIZE, fmi2_true);
+    }
+    fmi2_import_async_step_free(steps[0]);
+    fmi2_import_completion_queue_free(q);
+    for (i = 0; i < FMUS_NUM; i++) {
+        fmi2_test_unload_started(fmus[i]);
+    }
+    return TEST_OK;
+}
+
+/* Native steps call fmi2DoStep directly, an FMU that does not return fmi2Pending completes at once */
+static int test_native(fmi_import_context_t *context, const char *dir)
+{
+    fmi2_import_t *fmu = fmi2_test_load_started(context, dir, "async");
+    fmi2_import_completion_queue_t *q;
+    fmi2_import_async_step_t *step;
+
+    ASSERT_MSG(fmu, "could not load FMU");
+    q = fmi2_import_completion_queue_allocate(NULL, 1);
+    ASSERT_MSG(q, "could not allocate queue");
+    step = fmi2_import_async_step_allocate(q, fmu, fmi2_import_async_native, NULL);
+    ASSERT_MSG(step && fmi2_import_async_step_is_native(step), "could not allocate native step");
+    ASSERT_MSG(fmi2_import_async_step_get_fmu(step) == fmu, "wrong FMU");
+    ASSERT_MSG(fmi2_import_async_step_wait(step) == fmi2_status_error, "no step was submitted");
+
+    ASSERT_MSG(fmi2_import_async_step_submit(step, 0.0, STEP_SIZE, fmi2_true) == fmi2_status_ok, "could not submit step");
+    ASSERT_MSG(fmi2_import_async_step_is_done(step), "synchronous step should complete at once");
+
+    /* A finished step that was not collected is replaced on resubmission */
+    ASSERT_MSG(fmi2_import_async_step_submit(step, STEP_SIZE, STEP_SIZE, fmi2_true) == fmi2_status_ok, "could not submit step");
+    ASSERT_MSG(fmi2_import_completion_queue_poll(q) == step, "step should be reported");
+    ASSERT_MSG(fmi2_import_completion_queue_poll(q) == NULL, "step should be reported once");
+
+    /* A stepFinished call without a pending step is ignored */
+    fmi2_step_finished_forwarding(fmu, fmi2_status_error);
+    ASSERT_MSG(fmi2_import_async_step_get_status(step) == fmi2_status_ok, "status must not change");
+
+    fmi2_import_async_step_free(step);
+    fmi2_import_completion_queue_free(q);
+    fmi2_test_unload_started(fmu);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    fmi_import_context_t *context;
+    int ret = 1;
+
+    context = fmi2_test_open(argc, argv, "fmi2_import_async_test", NULL);
+    if (!context) return CTEST_RETURN_FAIL;
+
+    ret &= test_emulated(context, argv[2]);
+    ret &= test_native(context, argv[2]);
+
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
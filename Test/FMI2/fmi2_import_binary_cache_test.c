@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include <JM/jm_thread.h>
+#include <JM/jm_portability.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define PARALLEL_LOAD_THREADS 8
+#define PARALLEL_LOAD_REPEATS 10
+
+typedef struct {
+    const char *dir;
+    int isolate;
+    int ok;
+} load_thread_t;
+
+/* Objects loading the same binary share it, it is unloaded with the last one */
+static int test_shared_binary(fmi_import_context_t *context, const char *dir)
+{
+    fmi2_import_t *a, *b;
+
+    ASSERT_MSG(fmi_import_get_binary_cache_size() == 0, "binaries must be unloaded by default");
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 0, "no binary should be loaded");
+
+    a = fmi2_test_load(context, dir, NULL);
+    b = fmi2_test_load(context, dir, NULL);
+    ASSERT_MSG(a && b, "could not load FMU");
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 1, "binary should be shared");
+    ASSERT_MSG(fmi2_import_get_version(a) && fmi2_import_get_version(b), "functions not resolved");
+
+    fmi2_test_unload(a);
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 1, "binary still in use");
+    ASSERT_MSG(fmi2_import_instantiate(b, "b", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+               "binary must stay usable");
+    fmi2_import_free_instance(b);
+    fmi2_test_unload(b);
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 0, "binary should be unloaded with the last user");
+    return TEST_OK;
+}
+
+/* Unused binaries are kept up to the cache size */
+static int test_cache(fmi_import_context_t *context, const char *dir)
+{
+    fmi2_import_t *a;
+
+    fmi_import_set_binary_cache_size(1);
+    a = fmi2_test_load(context, dir, NULL);
+    ASSERT_MSG(a, "could not load FMU");
+    fmi2_test_unload(a);
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 1, "unused binary should be kept");
+
+    a = fmi2_test_load(context, dir, NULL);
+    ASSERT_MSG(a, "could not load FMU from the cache");
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 1, "cached binary should be reused");
+    ASSERT_MSG(fmi_import_evict_unused_binaries() == 0, "a binary in use must not be evicted");
+    fmi2_test_unload(a);
+
+    ASSERT_MSG(fmi_import_evict_unused_binaries() == 1, "unused binary should be evicted");
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 0, "no binary should be loaded");
+
+    a = fmi2_test_load(context, dir, NULL);
+    ASSERT_MSG(a, "could not load FMU");
+    fmi2_test_unload(a);
+    fmi_import_set_binary_cache_size(0);
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 0, "reducing the cache size should evict");
+    return TEST_OK;
+}
+
+/* An instance keeps the binary loaded after the object it was created from released it */
+static int test_instance_reference(fmi_import_context_t *context, const char *dir)
+{
+    fmi2_import_t *a = fmi2_test_load(context, dir, NULL);
+    fmi2_import_instance_t *inst;
+
+    ASSERT_MSG(a, "could not load FMU");
+    inst = fmi2_import_instance_allocate(a, NULL);
+    ASSERT_MSG(inst, "could not allocate instance");
+    fmi2_import_destroy_dllfmu(a);
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 1, "instance should hold the binary");
+    ASSERT_MSG(fmi2_import_instance_instantiate(inst, "inst", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+               "instance must stay usable");
+    fmi2_import_instance_free(inst);
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 0, "binary should be unloaded with the instance");
+    fmi2_import_free(a);
+    return TEST_OK;
+}
+
+/* Isolated objects and their instances load private copies of the binary */
+static int test_isolation(fmi_import_context_t *context, const char *dir)
+{
+    fmi2_import_t *a = fmi2_import_parse_xml(context, dir, NULL);
+    fmi2_import_t *b;
+    fmi2_import_instance_t *inst[2];
+    int i;
+
+    ASSERT_MSG(a, "could not parse FMU");
+    fmi2_import_set_binary_isolation(a, 1);
+    ASSERT_MSG(fmi2_import_create_dllfmu(a, fmi2_fmu_kind_cs, NULL) == jm_status_success, "could not load isolated FMU");
+    b = fmi2_test_load(context, dir, NULL);
+    ASSERT_MSG(b, "could not load FMU");
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 2, "isolated binary must not be shared");
+
+    for (i = 0; i < 2; i++) {
+        inst[i] = fmi2_import_instance_allocate(a, NULL);
+        ASSERT_MSG(inst[i], "could not allocate instance");
+        ASSERT_MSG(fmi2_import_instance_instantiate(inst[i], "inst", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+                   "could not instantiate isolated instance");
+    }
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 4, "each instance should load its own copy");
+
+    for (i = 0; i < 2; i++) {
+        fmi2_import_instance_free(inst[i]);
+    }
+    fmi2_test_unload(a);
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 1, "isolated copies should be unloaded");
+    fmi2_test_unload(b);
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 0, "no binary should be loaded");
+    return TEST_OK;
+}
+
+static void load_thread(void *arg)
+{
+    load_thread_t *t = (load_thread_t *)arg;
+    fmi_import_context_t *context = fmi_import_allocate_context(jm_get_default_callbacks());
+    int i;
+
+    t->ok = context != NULL;
+    for (i = 0; t->ok && i < PARALLEL_LOAD_REPEATS; i++) {
+        fmi2_import_t *fmu = fmi2_import_parse_xml(context, t->dir, NULL);
+        fmi2_value_reference_t vr = 0;
+        fmi2_real_t h;
+
+        if (!fmu) {
+            t->ok = 0;
+            break;
+        }
+        fmi2_import_set_binary_isolation(fmu, t->isolate);
+        t->ok = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, NULL) == jm_status_success
+            && fmi2_import_instantiate(fmu, "parallel", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success
+            && fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok
+            && fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok
+            && fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok
+            && fmi2_import_do_step(fmu, 0.0, 0.1, fmi2_true) == fmi2_status_ok
+            && fmi2_import_get_real(fmu, &vr, 1, &h) == fmi2_status_ok
+            && h > 1.0; /* thrown upwards from 1 m */
+        fmi2_import_free_instance(fmu);
+        fmi2_test_unload(fmu);
+    }
+    if (context) fmi_import_free_context(context);
+}
+
+/* Loading from several threads at once is safe and does not change the working directory */
+static int test_parallel_load(const char *dir)
+{
+    char cwdBefore[FILENAME_MAX + 2], cwdAfter[FILENAME_MAX + 2];
+    jm_thread_t threads[PARALLEL_LOAD_THREADS];
+    load_thread_t args[PARALLEL_LOAD_THREADS];
+    int i;
+
+    ASSERT_MSG(jm_portability_get_current_working_directory(cwdBefore, sizeof(cwdBefore)) == jm_status_success,
+               "could not get working directory");
+    for (i = 0; i < PARALLEL_LOAD_THREADS; i++) {
+        args[i].dir = dir;
+        args[i].isolate = i % 2;
+        args[i].ok = 0;
+        ASSERT_MSG(jm_thread_create(&threads[i], load_thread, &args[i]) == jm_status_success, "could not start thread");
+    }
+    for (i = 0; i < PARALLEL_LOAD_THREADS; i++) {
+        jm_thread_join(&threads[i]);
+    }
+    for (i = 0; i < PARALLEL_LOAD_THREADS; i++) {
+        ASSERT_MSG(args[i].ok, "parallel load failed");
+    }
+    ASSERT_MSG(fmi_import_get_loaded_binaries_num() == 0, "no binary should be loaded");
+    ASSERT_MSG(jm_portability_get_current_working_directory(cwdAfter, sizeof(cwdAfter)) == jm_status_success,
+               "could not get working directory");
+    ASSERT_MSG(strcmp(cwdBefore, cwdAfter) == 0, "working directory changed");
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    fmi_import_context_t *context;
+    int ret = 1;
+
+    context = fmi2_test_open(argc, argv, "fmi2_import_binary_cache_test", NULL);
+    if (!context) return CTEST_RETURN_FAIL;
+
+    ret &= test_shared_binary(context, argv[2]);
+    ret &= test_cache(context, argv[2]);
+    ret &= test_instance_reference(context, argv[2]);
+    ret &= test_isolation(context, argv[2]);
+    ret &= test_parallel_load(argv[2]);
+
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define STEPS_NUM 100
+#define STEP_SIZE 0.01
+#define STATS_NUM 64
+
+/* Find the statistics of one function in a snapshot */
+static const fmi_call_stats_t *find(const fmi_call_stats_t *stats, size_t n, const char *name)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        if (strcmp(stats[i].name, name) == 0) return &stats[i];
+    }
+    return NULL;
+}
+
+static size_t histogram_sum(const fmi_call_stats_t *s)
+{
+    size_t b, sum = 0;
+    for (b = 0; b < FMI_CALL_STATS_BUCKETS; b++) sum += s->histogram[b];
+    return sum;
+}
+
+static size_t total_calls(const fmi_call_stats_t *stats, size_t n)
+{
+    size_t i, sum = 0;
+    for (i = 0; i < n; i++) sum += stats[i].count;
+    return sum;
+}
+
+static int test_buckets(void)
+{
+    double durations[] = {0.0, 1e-9, 3.5e-9, 4e-9, 1e-6, 3.3e-5, 0.25, 7.0, 3000.0};
+    size_t i, b;
+
+    ASSERT_MSG(fmi_call_stats_bucket(-1.0) == 0, "negative duration");
+    ASSERT_MSG(fmi_call_stats_bucket(1e9) == FMI_CALL_STATS_BUCKETS - 1, "long durations go to the last bucket");
+    for (i = 0; i < sizeof(durations) / sizeof(durations[0]); i++) {
+        b = fmi_call_stats_bucket(durations[i]);
+        ASSERT_MSG(b < FMI_CALL_STATS_BUCKETS - 1, "bucket out of range");
+        ASSERT_MSG(fmi_call_stats_bucket_seconds(b) <= durations[i] * (1 + 1e-12) &&
+                   durations[i] < fmi_call_stats_bucket_seconds(b + 1), "duration outside its bucket");
+    }
+    for (b = 1; b < FMI_CALL_STATS_BUCKETS; b++) {
+        ASSERT_MSG(fmi_call_stats_bucket_seconds(b - 1) < fmi_call_stats_bucket_seconds(b), "bucket bounds not increasing");
+    }
+    return TEST_OK;
+}
+
+static fmi2_real_t simulate_steps(fmi2_import_t *fmu, fmi2_real_t *time)
+{
+    fmi2_value_reference_t hight = 0;
+    fmi2_real_t value = 0;
+    int k;
+    for (k = 0; k < STEPS_NUM; k++) {
+        fmi2_import_do_step(fmu, *time, STEP_SIZE, fmi2_true);
+        *time += STEP_SIZE;
+        fmi2_import_get_real(fmu, &hight, 1, &value);
+    }
+    return value;
+}
+
+static int test_tracing(fmi2_import_t *fmu)
+{
+    fmi_call_stats_t stats[STATS_NUM];
+    const fmi_call_stats_t *doStep, *getReal, *instantiate;
+    fmi2_real_t time = 0, traced, untraced;
+    size_t n;
+
+    n = fmi2_import_get_call_stats(fmu, stats, STATS_NUM);
+    ASSERT_MSG(n > 0 && n <= STATS_NUM, "unexpected number of traced functions");
+    ASSERT_MSG(total_calls(stats, n) == 0, "calls recorded before tracing was switched on");
+
+    ASSERT_MSG(fmi2_import_set_call_tracing(fmu, 1) == jm_status_success, "could not switch tracing on");
+    ASSERT_MSG(fmi2_import_instantiate(fmu, "traced", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+               "instantiate failed while tracing");
+    fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0);
+    fmi2_import_enter_initialization_mode(fmu);
+    fmi2_import_exit_initialization_mode(fmu);
+    traced = simulate_steps(fmu, &time);
+
+    fmi2_import_get_call_stats(fmu, stats, n);
+    instantiate = find(stats, n, "fmi2Instantiate");
+    doStep = find(stats, n, "fmi2DoStep");
+    getReal = find(stats, n, "fmi2GetReal");
+    ASSERT_MSG(instantiate && doStep && getReal, "missing function names");
+    ASSERT_MSG(instantiate->count == 1, "instantiate not recorded");
+    ASSERT_MSG(doStep->count == STEPS_NUM && getReal->count == STEPS_NUM, "wrong call counts");
+    ASSERT_MSG(find(stats, n, "fmi2EnterInitializationMode")->count == 1, "wrong call count");
+    ASSERT_MSG(total_calls(stats, n) == 4 + 2 * STEPS_NUM, "unexpected calls recorded");
+    ASSERT_MSG(histogram_sum(doStep) == doStep->count, "histogram does not add up");
+    ASSERT_MSG(doStep->totalSeconds >= doStep->maxSeconds && doStep->maxSeconds > 0, "inconsistent times");
+    ASSERT_MSG(fmi_call_stats_percentile(doStep, 50) <= fmi_call_stats_percentile(doStep, 99) &&
+               fmi_call_stats_percentile(doStep, 99) <= doStep->maxSeconds, "inconsistent percentiles");
+    printf("fmi2DoStep: %u calls, mean %.3f us, p50 %.3f us, p99 %.3f us, max %.3f us\n", (unsigned)doStep->count,
+           1e6 * doStep->totalSeconds / doStep->count, 1e6 * fmi_call_stats_percentile(doStep, 50),
+           1e6 * fmi_call_stats_percentile(doStep, 99), 1e6 * doStep->maxSeconds);
+
+    /* the untraced calls are not recorded and continue the same simulation */
+    ASSERT_MSG(fmi2_import_set_call_tracing(fmu, 0) == jm_status_success, "could not switch tracing off");
+    untraced = simulate_steps(fmu, &time);
+    fmi2_import_get_call_stats(fmu, stats, n);
+    ASSERT_MSG(total_calls(stats, n) == 4 + 2 * STEPS_NUM, "calls recorded while tracing was off");
+    ASSERT_MSG(traced != untraced, "the simulation did not continue");
+
+    /* switching on with an instantiated component and freeing it while traced */
+    fmi2_import_set_call_tracing(fmu, 1);
+    simulate_steps(fmu, &time);
+    fmi2_import_terminate(fmu);
+    fmi2_import_free_instance(fmu);
+    fmi2_import_get_call_stats(fmu, stats, n);
+    ASSERT_MSG(find(stats, n, "fmi2DoStep")->count == 2 * STEPS_NUM, "steps not recorded after switching on again");
+    ASSERT_MSG(find(stats, n, "fmi2FreeInstance")->count == 1, "free instance not recorded");
+
+    fmi2_import_reset_call_stats(fmu);
+    fmi2_import_get_call_stats(fmu, stats, n);
+    ASSERT_MSG(total_calls(stats, n) == 0 && stats[0].name != NULL, "statistics not reset");
+    fmi2_import_set_call_tracing(fmu, 0);
+    return TEST_OK;
+}
+
+/* Instances are traced separately from the FMU they are allocated from */
+static int test_instance(fmi2_import_t *fmu)
+{
+    fmi_call_stats_t stats[STATS_NUM];
+    fmi2_import_instance_t *inst = fmi2_import_instance_allocate(fmu, NULL);
+    fmi2_value_reference_t hight = 0;
+    fmi2_real_t value = 0;
+    size_t n;
+
+    ASSERT_MSG(inst != NULL, "could not allocate an instance");
+    fmi2_import_set_call_tracing(fmu, 1);
+    fmi2_import_instance_set_call_tracing(inst, 1);
+    ASSERT_MSG(fmi2_import_instance_instantiate(inst, "instance", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+               "instantiate failed");
+    ASSERT_MSG(fmi2_import_instance_get_component(inst) != NULL, "no component");
+    fmi2_import_instance_setup_experiment(inst, fmi2_false, 0.0, 0.0, fmi2_false, 0.0);
+    fmi2_import_instance_enter_initialization_mode(inst);
+    fmi2_import_instance_exit_initialization_mode(inst);
+    fmi2_import_instance_do_step(inst, 0.0, STEP_SIZE, fmi2_true);
+    ASSERT_MSG(fmi2_import_instance_get_real(inst, &hight, 1, &value) == fmi2_status_ok, "get real failed");
+
+    n = fmi2_import_instance_get_call_stats(inst, stats, STATS_NUM);
+    ASSERT_MSG(find(stats, n, "fmi2DoStep")->count == 1 && find(stats, n, "fmi2Instantiate")->count == 1, "instance calls not recorded");
+    fmi2_import_get_call_stats(fmu, stats, n);
+    ASSERT_MSG(total_calls(stats, n) == 0, "instance calls recorded in the FMU");
+
+    fmi2_import_instance_free(inst);
+    fmi2_import_set_call_tracing(fmu, 0);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks callbacks = *jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    int ret = 1;
+
+    callbacks.log_level = jm_log_level_warning;
+    context = fmi2_test_open(argc, argv, "fmi2_import_call_stats_test", &callbacks);
+    if (!context) return CTEST_RETURN_FAIL;
+    fmu = fmi2_import_parse_xml(context, argv[2], NULL);
+    if (!fmu) {
+        printf("Could not parse the model description\n");
+        return CTEST_RETURN_FAIL;
+    }
+    ASSERT_MSG(fmi2_import_set_call_tracing(fmu, 1) == jm_status_error, "tracing switched on without loaded functions");
+    if (fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, NULL) != jm_status_success) {
+        printf("Could not load the FMU binary\n");
+        fmi2_import_free(fmu);
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_buckets();
+    ret &= test_tracing(fmu);
+    ret &= test_instance(fmu);
+
+    fmi2_test_unload(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define STEPS_NUM 200
+#define STEP_SIZE 0.01
+#define LIVE_NUM 4
+#define ARENA_BYTES 1048576
+
+static fmi2_real_t hight(fmi2_import_t *fmu)
+{
+    fmi2_value_reference_t vr = 0;
+    fmi2_real_t value = 0;
+    fmi2_import_get_real(fmu, &vr, 1, &value);
+    return value;
+}
+
+/* Step from times[first] to times[last], saving a checkpoint after each step and recording HIGHT */
+static int run(fmi2_import_t *fmu, fmi2_import_checkpoint_manager_t *m, fmi2_real_t *times, fmi2_real_t *hights, int first, int last)
+{
+    int k;
+    for (k = first; k < last; k++) {
+        ASSERT_MSG(fmi2_import_do_step(fmu, times[k], STEP_SIZE, fmi2_true) == fmi2_status_ok, "do_step failed");
+        times[k + 1] = times[k] + STEP_SIZE;
+        hights[k + 1] = hight(fmu);
+        if (m) ASSERT_MSG(fmi2_import_checkpoint_save(m, times[k + 1]) == fmi2_status_ok, "save failed");
+    }
+    return TEST_OK;
+}
+
+static int rollback(fmi2_import_t *fmu, fmi2_import_checkpoint_manager_t *m, const fmi2_real_t *times, const fmi2_real_t *hights, int k)
+{
+    fmi2_real_t restored = -1;
+    ASSERT_MSG(fmi2_import_checkpoint_rollback(m, times[k], &restored) == fmi2_status_ok, "rollback failed");
+    ASSERT_MSG(restored == times[k], "wrong checkpoint restored");
+    ASSERT_MSG(hight(fmu) == hights[k], "restored state differs from the saved one");
+    return TEST_OK;
+}
+
+static void print_stats(const char *title, fmi2_import_checkpoint_manager_t *m)
+{
+    fmi2_import_checkpoint_stats_t s;
+    fmi2_import_checkpoint_get_stats(m, &s);
+    printf("%s: %u saves (%u states created, %u reused), %u rollbacks (%u live, %u arena, %u missed)\n", title,
+           (unsigned)s.savesNum, (unsigned)s.statesCreatedNum, (unsigned)s.statesReusedNum, (unsigned)s.rollbacksNum,
+           (unsigned)s.liveHitsNum, (unsigned)s.arenaHitsNum, (unsigned)s.missesNum);
+    printf("%s: %u live, %u serialized (%u dropped), %u of %u bytes stored in %u byte arena, ratio %.2f, %u bytes allocated\n", title,
+           (unsigned)s.liveCheckpointsNum, (unsigned)s.arenaCheckpointsNum, (unsigned)s.droppedNum, (unsigned)s.storedBytes,
+           (unsigned)s.rawBytes, (unsigned)s.arenaBytes, s.storedBytes ? (double)s.rawBytes / s.storedBytes : 0.0,
+           (unsigned)s.memoryBytes);
+}
+
+static int test_rollback(fmi_import_context_t *context, const char *dir, fmi2_import_checkpoint_compression_enu_t compression)
+{
+    fmi2_import_t *fmu = fmi2_test_load_started(context, dir, "checkpoint");
+    fmi2_import_checkpoint_manager_t *m;
+    fmi2_import_checkpoint_stats_t s;
+    fmi2_real_t times[STEPS_NUM + 1], hights[STEPS_NUM + 1], replay[STEPS_NUM + 1];
+    int ok = 1;
+
+    ASSERT_MSG(fmu != NULL, "Could not load the FMU");
+    m = fmi2_import_checkpoint_manager_allocate(fmu, LIVE_NUM, ARENA_BYTES);
+    if (!m) {
+        fmi2_test_unload_started(fmu);
+        ASSERT_MSG(0, "Could not allocate the checkpoint manager");
+    }
+    fmi2_import_checkpoint_set_compression(m, compression);
+
+    times[0] = 0.0;
+    hights[0] = hight(fmu);
+    ok = ok && fmi2_import_checkpoint_save(m, times[0]) == fmi2_status_ok;
+    ok = ok && run(fmu, m, times, hights, 0, STEPS_NUM);
+
+    /* the latest checkpoints are live, older ones are serialized */
+    ok = ok && rollback(fmu, m, times, hights, STEPS_NUM - 1);
+    ok = ok && rollback(fmu, m, times, hights, STEPS_NUM / 2);
+    ok = ok && rollback(fmu, m, times, hights, STEPS_NUM / 2);
+
+    /* a rejected step is repeated after the rollback and gives the same result */
+    memcpy(replay, hights, sizeof(hights));
+    ok = ok && run(fmu, m, times, replay, STEPS_NUM / 2, STEPS_NUM / 2 + 10);
+    ok = ok && memcmp(replay, hights, sizeof(hights)) == 0;
+
+    /* a rollback between checkpoints restores the one before */
+    if (ok) {
+        fmi2_real_t restored;
+        ok = fmi2_import_checkpoint_rollback(m, times[5] + STEP_SIZE / 2, &restored) == fmi2_status_ok && restored == times[5]
+            && hight(fmu) == hights[5];
+    }
+    ok = ok && fmi2_import_checkpoint_rollback(m, -1.0, NULL) == fmi2_status_error;
+
+    fmi2_import_checkpoint_get_stats(m, &s);
+    print_stats(compression == fmi2_import_checkpoint_compression_delta ? "delta" : "none", m);
+    fmi2_import_checkpoint_manager_free(m);
+    fmi2_test_unload_started(fmu);
+
+    ASSERT_MSG(ok, "rollback test failed");
+    ASSERT_MSG(s.liveHitsNum >= 1 && s.arenaHitsNum >= 2 && s.missesNum == 1, "rollbacks not counted");
+    ASSERT_MSG(s.statesCreatedNum <= LIVE_NUM && s.statesReusedNum > 0, "state objects not reused");
+    ASSERT_MSG(s.droppedNum == 0, "no checkpoints should be dropped");
+    ASSERT_MSG(compression == fmi2_import_checkpoint_compression_none || s.storedBytes < s.rawBytes, "no compression");
+    return TEST_OK;
+}
+
+/* An arena that holds few checkpoints drops the oldest and still restores the recent ones */
+static int test_small_arena(fmi_import_context_t *context, const char *dir)
+{
+    fmi2_import_t *fmu = fmi2_test_load_started(context, dir, "checkpoint");
+    fmi2_import_checkpoint_manager_t *m;
+    fmi2_import_checkpoint_stats_t s;
+    fmi2_real_t times[STEPS_NUM + 1], hights[STEPS_NUM + 1];
+    size_t stateSize = 0;
+    int ok = 1;
+
+    ASSERT_MSG(fmu != NULL, "Could not load the FMU");
+    {
+        fmi2_FMU_state_t state = NULL;
+        fmi2_import_get_fmu_state(fmu, &state);
+        fmi2_import_serialized_fmu_state_size(fmu, state, &stateSize);
+        fmi2_import_free_fmu_state(fmu, &state);
+    }
+    m = fmi2_import_checkpoint_manager_allocate(fmu, 1, 3 * stateSize);
+    if (!m) {
+        fmi2_test_unload_started(fmu);
+        ASSERT_MSG(0, "Could not allocate the checkpoint manager");
+    }
+    fmi2_import_checkpoint_set_compression(m, fmi2_import_checkpoint_compression_none);
+    times[0] = 0.0;
+    hights[0] = hight(fmu);
+    ok = ok && fmi2_import_checkpoint_save(m, times[0]) == fmi2_status_ok;
+    ok = ok && run(fmu, m, times, hights, 0, STEPS_NUM);
+    ok = ok && fmi2_import_checkpoint_rollback(m, times[0], NULL) == fmi2_status_error;
+    ok = ok && rollback(fmu, m, times, hights, STEPS_NUM - 2);
+    fmi2_import_checkpoint_get_stats(m, &s);
+    print_stats("small", m);
+    fmi2_import_checkpoint_manager_free(m);
+    fmi2_test_unload_started(fmu);
+
+    ASSERT_MSG(ok, "small arena test failed");
+    ASSERT_MSG(s.droppedNum > 0 && s.arenaHitsNum == 1, "old checkpoints should be dropped");
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    fmi_import_context_t *context;
+    int ret = 1;
+
+    context = fmi2_test_open(argc, argv, "fmi2_import_checkpoint_test", NULL);
+    if (!context) return CTEST_RETURN_FAIL;
+
+    ret &= test_rollback(context, argv[2], fmi2_import_checkpoint_compression_none);
+    ret &= test_rollback(context, argv[2], fmi2_import_checkpoint_compression_delta);
+    ret &= test_small_arena(context, argv[2]);
+
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define STEPS_NUM 200
+#define STEP_SIZE 0.01
+
+/* The dummy FMU passes the component instead of the environment when it rejects a value,
+   so the messages are not forwarded to the import library */
+static void fmu_logger(fmi2_component_environment_t env, fmi2_string_t instanceName, fmi2_status_t status,
+                       fmi2_string_t category, fmi2_string_t message, ...)
+{
+    (void)env; (void)instanceName; (void)status; (void)category; (void)message;
+}
+
+static fmi2_import_t *load(fmi_import_context_t *context, const char *tmpPath)
+{
+    static fmi2_callback_functions_t callBackFunctions;
+    callBackFunctions.logger = fmu_logger;
+    callBackFunctions.allocateMemory = calloc;
+    callBackFunctions.freeMemory = free;
+    return fmi2_test_load(context, tmpPath, &callBackFunctions);
+}
+
+/* A buffer gives the same results as the direct calls and is reused for each step */
+static int test_step_buffer(fmi2_import_t *fmu)
+{
+    fmi2_value_reference_t inVr = 3, outVr[] = {0, 1};
+    fmi2_real_t bounce = 0.7, time = 0.0, step = STEP_SIZE, out[2], lastTime = -1.0;
+    fmi2_real_t expected[STEPS_NUM][2];
+    fmi2_status_t stepStatus = fmi2_status_error;
+    fmi2_import_command_buffer_t *buf;
+    int k;
+
+    if (!fmi2_test_start(fmu, "buffer")) return 0;
+    for (k = 0; k < STEPS_NUM; k++) {
+        ASSERT_MSG(fmi2_import_set_real(fmu, &inVr, 1, &bounce) == fmi2_status_ok, "set real failed");
+        ASSERT_MSG(fmi2_import_do_step(fmu, k * STEP_SIZE, STEP_SIZE, fmi2_true) == fmi2_status_ok, "step failed");
+        ASSERT_MSG(fmi2_import_get_real(fmu, outVr, 2, expected[k]) == fmi2_status_ok, "get real failed");
+    }
+    fmi2_test_stop(fmu);
+
+    if (!fmi2_test_start(fmu, "buffer")) return 0;
+    buf = fmi2_import_command_buffer_allocate(fmu);
+    ASSERT_MSG(buf != NULL, "could not allocate a command buffer");
+    ASSERT_MSG(fmi2_import_command_buffer_set_real(buf, &inVr, 1, &bounce) == jm_status_success, "recording set real failed");
+    ASSERT_MSG(fmi2_import_command_buffer_do_step(buf, &time, &step, fmi2_true) == jm_status_success, "recording do step failed");
+    ASSERT_MSG(fmi2_import_command_buffer_get_real(buf, outVr, 2, out) == jm_status_success, "recording get real failed");
+    ASSERT_MSG(fmi2_import_command_buffer_get_status(buf, fmi2_do_step_status, &stepStatus) == jm_status_success,
+               "recording get status failed");
+    ASSERT_MSG(fmi2_import_command_buffer_get_real_status(buf, fmi2_last_successful_time, &lastTime) == jm_status_success,
+               "recording get real status failed");
+    ASSERT_MSG(fmi2_import_command_buffer_get_size(buf) == 5, "wrong number of recorded calls");
+
+    for (k = 0; k < STEPS_NUM; k++) {
+        time = k * STEP_SIZE;
+        ASSERT_MSG(fmi2_import_command_buffer_submit(buf) == fmi2_status_ok, "submission failed");
+        ASSERT_MSG(fmi2_import_command_buffer_get_executed_num(buf) == 5, "not all calls executed");
+        ASSERT_MSG(out[0] == expected[k][0] && out[1] == expected[k][1], "results differ from the direct calls");
+    }
+    ASSERT_MSG(stepStatus == fmi2_status_ok, "step status not written");
+    ASSERT_MSG(lastTime != -1.0, "last successful time not written");
+
+    fmi2_import_command_buffer_clear(buf);
+    ASSERT_MSG(fmi2_import_command_buffer_get_size(buf) == 0, "buffer not cleared");
+    fmi2_import_command_buffer_free(buf);
+    fmi2_test_stop(fmu);
+    return TEST_OK;
+}
+
+/* Invalid calls are rejected when recorded */
+static int test_validation(fmi2_import_t *fmu)
+{
+    fmi2_import_command_buffer_t *buf = fmi2_import_command_buffer_allocate(fmu);
+    fmi2_value_reference_t unknown = 999, gravity = 2;
+    fmi2_integer_t ivalue, order = 1;
+    fmi2_real_t rvalue = 0.0;
+
+    ASSERT_MSG(buf != NULL, "could not allocate a command buffer");
+    ASSERT_MSG(fmi2_import_command_buffer_get_real(buf, &unknown, 1, &rvalue) == jm_status_error,
+               "unknown value reference accepted");
+    ASSERT_MSG(fmi2_import_command_buffer_get_integer(buf, &gravity, 1, &ivalue) == jm_status_error,
+               "value reference of the wrong type accepted");
+    ASSERT_MSG(fmi2_import_command_buffer_set_time(buf, &rvalue) == jm_status_error,
+               "model exchange call accepted for a co-simulation FMU");
+    order = 0;
+    ASSERT_MSG(fmi2_import_command_buffer_set_real_input_derivatives(buf, &gravity, 1, &order, &rvalue) == jm_status_error,
+               "derivative order 0 accepted");
+    ASSERT_MSG(fmi2_import_command_buffer_do_step(buf, NULL, &rvalue, fmi2_true) == jm_status_error,
+               "missing communication point accepted");
+    ASSERT_MSG(fmi2_import_command_buffer_get_size(buf) == 0, "invalid calls recorded");
+    ASSERT_MSG(fmi2_import_command_buffer_submit(buf) == fmi2_status_error, "submission without an instance succeeded");
+    fmi2_import_command_buffer_free(buf);
+    return TEST_OK;
+}
+
+/* A submission stops at the first error */
+static int test_stop_on_error(fmi2_import_t *fmu)
+{
+    fmi2_import_command_buffer_t *buf;
+    fmi2_value_reference_t acc = 4, hight = 0;
+    fmi2_real_t value = 1.0, out = -1.0;
+    const fmi2_status_t *statuses;
+
+    if (!fmi2_test_start(fmu, "buffer")) return 0;
+    buf = fmi2_import_command_buffer_allocate(fmu);
+    ASSERT_MSG(buf != NULL, "could not allocate a command buffer");
+    ASSERT_MSG(fmi2_import_command_buffer_set_real(buf, &acc, 1, &value) == jm_status_success, "recording set real failed");
+    ASSERT_MSG(fmi2_import_command_buffer_get_real(buf, &hight, 1, &out) == jm_status_success, "recording get real failed");
+    ASSERT_MSG(fmi2_import_command_buffer_submit(buf) == fmi2_status_error, "error not returned");
+    statuses = fmi2_import_command_buffer_get_statuses(buf);
+    ASSERT_MSG(fmi2_import_command_buffer_get_executed_num(buf) == 1 && statuses[0] == fmi2_status_error,
+               "submission did not stop at the error");
+    ASSERT_MSG(out == -1.0, "call after the error executed");
+    fmi2_import_command_buffer_free(buf);
+    fmi2_test_stop(fmu);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks callbacks = *jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    int ret = 1;
+
+    callbacks.log_level = jm_log_level_warning;
+    context = fmi2_test_open(argc, argv, "fmi2_import_command_buffer_test", &callbacks);
+    if (!context) return CTEST_RETURN_FAIL;
+    fmu = load(context, argv[2]);
+    if (!fmu) {
+        printf("Could not load the FMU\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_step_buffer(fmu);
+    ret &= test_validation(fmu);
+    ret &= test_stop_on_error(fmu);
+
+    fmi2_test_unload(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
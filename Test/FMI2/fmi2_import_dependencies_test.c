@@ -0,0 +1,171 @@
+#include <stdio.h>
+
+#include <fmilib.h>
+#include <JM/jm_thread.h>
+#include "config_test.h"
+#include "fmil_test.h"
+
+/* original order indices in the jacobian test model */
+#define VAR_X1 0
+#define VAR_X2 1
+#define VAR_X3 2
+#define VAR_X5 4
+#define VAR_U1 10
+#define VAR_U2 11
+
+#define QUERY_THREADS 4
+#define QUERY_REPEAT 20000
+
+static fmi2_import_t *parse_xml(const char *model_desc_path)
+{
+    jm_callbacks *cb = jm_get_default_callbacks();
+    fmi_import_context_t *ctx = fmi_import_allocate_context(cb);
+    fmi2_import_t *xml;
+
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    xml = fmi2_import_parse_xml(ctx, model_desc_path, NULL);
+
+    fmi_import_free_context(ctx);
+    return xml;
+}
+
+static int test_transpose(fmi2_import_t *xml)
+{
+    size_t *startIndex, *dependent;
+
+    ASSERT_MSG(fmi2_import_get_dependents(xml, fmi2_import_dependency_outputs, &startIndex, &dependent) == jm_status_success,
+               "failed to get output dependents");
+    ASSERT_MSG(startIndex[VAR_U1 + 1] - startIndex[VAR_U1] == 1 && dependent[startIndex[VAR_U1]] == 0, "y1 should depend on u1");
+    ASSERT_MSG(startIndex[VAR_U2 + 1] - startIndex[VAR_U2] == 1 && dependent[startIndex[VAR_U2]] == 1, "y2 should depend on u2");
+    ASSERT_MSG(startIndex[VAR_X2 + 1] == startIndex[VAR_X2], "no output should depend on x2");
+    ASSERT_MSG(startIndex[14] == 4, "incorrect number of output dependencies");
+
+    ASSERT_MSG(fmi2_import_get_dependents(xml, fmi2_import_dependency_derivatives, &startIndex, &dependent) == jm_status_success,
+               "failed to get derivative dependents");
+    ASSERT_MSG(startIndex[VAR_X2 + 1] - startIndex[VAR_X2] == 3, "three derivatives should depend on x2");
+    ASSERT_MSG(dependent[startIndex[VAR_X2]] == 0 && dependent[startIndex[VAR_X2] + 1] == 1 && dependent[startIndex[VAR_X2] + 2] == 2,
+               "incorrect derivatives depending on x2");
+    ASSERT_MSG(startIndex[14] == 15, "incorrect number of derivative dependencies");
+
+    ASSERT_MSG(fmi2_import_get_dependents(xml, fmi2_import_dependency_discrete_states, &startIndex, &dependent) == jm_status_success,
+               "failed to get discrete state dependents");
+    ASSERT_MSG(startIndex[14] == 0, "there are no discrete states");
+
+    return TEST_OK;
+}
+
+/* the same queries must give the same answer with and without bitsets */
+static int test_queries(fmi2_import_t *xml)
+{
+    size_t inputs[] = {VAR_U1, VAR_U2};
+    size_t edges[] = {VAR_X1, VAR_X5};
+    size_t inner[] = {VAR_X2, VAR_X3};
+    size_t unknowns[5];
+    size_t n;
+
+    n = fmi2_import_get_dependents_union(xml, fmi2_import_dependency_derivatives, inputs, 2, unknowns);
+    ASSERT_MSG(n == 2 && unknowns[0] == 0 && unknowns[1] == 4, "incorrect derivatives affected by the inputs");
+    n = fmi2_import_get_dependents_union(xml, fmi2_import_dependency_derivatives, edges, 2, unknowns);
+    ASSERT_MSG(n == 4 && unknowns[0] == 0 && unknowns[1] == 1 && unknowns[2] == 3 && unknowns[3] == 4,
+               "incorrect derivatives affected by x1 and x5");
+    n = fmi2_import_get_dependents_intersection(xml, fmi2_import_dependency_derivatives, inner, 2, unknowns);
+    ASSERT_MSG(n == 2 && unknowns[0] == 1 && unknowns[1] == 2, "incorrect derivatives depending on both x2 and x3");
+    n = fmi2_import_get_dependents_intersection(xml, fmi2_import_dependency_derivatives, edges, 2, unknowns);
+    ASSERT_MSG(n == 0, "no derivative depends on both x1 and x5");
+    n = fmi2_import_get_dependents_union(xml, fmi2_import_dependency_outputs, inputs, 2, unknowns);
+    ASSERT_MSG(n == 2 && unknowns[0] == 0 && unknowns[1] == 1, "incorrect outputs affected by the inputs");
+
+    return TEST_OK;
+}
+
+typedef struct query_thread_t {
+    fmi2_import_t *xml;
+    jm_thread_t thread;
+    int failed;
+} query_thread_t;
+
+/* Repeat queries with overlapping columns; the results must not depend on other threads */
+static void query_loop(void *arg)
+{
+    query_thread_t *q = (query_thread_t *)arg;
+    size_t knowns[] = {VAR_X2, VAR_X1, VAR_X3, VAR_X5, VAR_U2};
+    size_t unknowns[5];
+    int r;
+
+    for (r = 0; r < QUERY_REPEAT && !q->failed; r++) {
+        size_t n = fmi2_import_get_dependents_union(q->xml, fmi2_import_dependency_derivatives, knowns, 5, unknowns);
+        if (n != 5 || unknowns[0] != 0 || unknowns[4] != 4) q->failed = 1;
+        n = fmi2_import_get_dependents_intersection(q->xml, fmi2_import_dependency_derivatives, knowns, 1, unknowns);
+        if (n != 3 || unknowns[0] != 0 || unknowns[2] != 2) q->failed = 1;
+    }
+}
+
+/* Queries on a built index may run concurrently */
+static int test_concurrent_queries(fmi2_import_t *xml)
+{
+    query_thread_t threads[QUERY_THREADS];
+    size_t unknowns[5];
+    size_t knowns[] = {VAR_X2};
+    int i, failed = 0;
+
+    fmi2_import_get_dependents_union(xml, fmi2_import_dependency_derivatives, knowns, 1, unknowns);
+    for (i = 0; i < QUERY_THREADS; i++) {
+        threads[i].xml = xml;
+        threads[i].failed = 0;
+        ASSERT_MSG(jm_thread_create(&threads[i].thread, query_loop, &threads[i]) == jm_status_success, "could not start a thread");
+    }
+    for (i = 0; i < QUERY_THREADS; i++) {
+        jm_thread_join(&threads[i].thread);
+        failed |= threads[i].failed;
+    }
+    ASSERT_MSG(!failed, "concurrent queries gave wrong results");
+    return TEST_OK;
+}
+
+static int test_bitsets(fmi2_import_t *xml)
+{
+    size_t nWords;
+    const size_t *bits;
+
+    ASSERT_MSG(fmi2_import_get_dependency_bitsets(xml, fmi2_import_dependency_derivatives, &nWords, &bits) == jm_status_success,
+               "failed to build bitsets");
+    ASSERT_MSG(nWords == 1, "five derivatives fit in one word");
+    ASSERT_MSG(bits[VAR_X2 * nWords] == 7, "incorrect bitset for x2");
+    ASSERT_MSG(bits[VAR_U2 * nWords] == 16, "incorrect bitset for u2");
+    ASSERT_MSG(fmi2_import_get_dependency_bitsets(xml, fmi2_import_dependency_outputs, &nWords, &bits) == jm_status_success,
+               "failed to build output bitsets");
+
+    return TEST_OK;
+}
+
+int main(int argc, char **argv)
+{
+    fmi2_import_t *xml;
+    int ret = 1;
+
+    if (argc != 2) {
+        printf("Usage: %s <path to folder jacobian>\n", argv[0]);
+        return CTEST_RETURN_FAIL;
+    }
+
+    printf("Running fmi2_import_dependencies_test\n");
+
+    xml = parse_xml(argv[1]);
+    if (xml == NULL) {
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_transpose(xml);
+    ret &= test_queries(xml);
+    ret &= test_concurrent_queries(xml);
+    ret &= test_bitsets(xml);
+    ret &= test_queries(xml);
+    ret &= test_concurrent_queries(xml);
+
+    fmi2_import_free(xml);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
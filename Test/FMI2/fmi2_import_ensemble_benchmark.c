@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include <JM/jm_portability.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+/* Time per run of separate simulations of the co-simulation dummy FMU and of ensembles with
+   one and several threads. Built with the tests but not run by ctest, since the timings depend on the machine.
+   Usage: fmi2_import_ensemble_benchmark <fmu_file> <temporary_dir> [runs] [threads] */
+
+#define RUNS_NUM 256
+#define THREADS_NUM 4
+#define STOP_TIME 1.0
+#define STEP_SIZE 0.01
+#define STEPS_NUM 100
+
+static void parameters(fmi2_real_t *values, size_t runsNum)
+{
+    size_t run;
+    for (run = 0; run < runsNum; run++) {
+        values[2 * run] = -9.81 + 0.05 * (run % 64); /* GRAVITY */
+        values[2 * run + 1] = 0.3 + 0.01 * (run % 50); /* BOUNCE_COF */
+    }
+}
+
+/* One run done the usual way: parse, load, instantiate, simulate and free */
+static void separate_run(fmi_import_context_t *context, const char *dir, const fmi2_real_t *values)
+{
+    fmi2_import_t *fmu = fmi2_test_load(context, dir, NULL);
+    fmi2_value_reference_t vrs[2] = {2, 3};
+    fmi2_real_t time = 0;
+    int k;
+
+    if (!fmu) return;
+    if (fmi2_import_instantiate(fmu, "separate", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success) {
+        fmi2_import_setup_experiment(fmu, fmi2_true, 1e-4, 0.0, fmi2_true, STOP_TIME);
+        fmi2_import_enter_initialization_mode(fmu);
+        fmi2_import_set_real(fmu, vrs, 2, values);
+        fmi2_import_exit_initialization_mode(fmu);
+        for (k = 1; k <= STEPS_NUM; k++) {
+            fmi2_real_t next = (k == STEPS_NUM) ? STOP_TIME : k * STEP_SIZE;
+            fmi2_import_do_step(fmu, time, next - time, fmi2_true);
+            time = next;
+        }
+        fmi2_test_stop(fmu);
+    }
+    fmi2_test_unload(fmu);
+}
+
+static int benchmark(fmi_import_context_t *context, const char *dir, fmi2_import_t *fmu, const fmi2_real_t *values,
+                     size_t runsNum, size_t threadsNum)
+{
+    const char *parameterNames[] = {"GRAVITY", "BOUNCE_COF"};
+    fmi2_import_variable_list_t *pl = fmi2_import_alloc_variable_list(fmu, 0);
+    size_t threads[2], i, run;
+    double start;
+
+    ASSERT_MSG(pl != NULL, "Could not allocate the parameter list");
+    for (i = 0; i < 2; i++) {
+        fmi2_import_var_list_push_back(pl, fmi2_import_get_variable_by_name(fmu, parameterNames[i]));
+    }
+
+    start = jm_portability_get_time();
+    for (run = 0; run < runsNum; run++) {
+        separate_run(context, dir, values + 2 * run);
+    }
+    printf("separate runs        %10.3f us per run\n", 1e6 * (jm_portability_get_time() - start) / runsNum);
+
+    threads[0] = 1;
+    threads[1] = threadsNum;
+    for (i = 0; i < 2; i++) {
+        fmi2_import_ensemble_t *e = fmi2_import_ensemble_allocate(fmu, pl, NULL, threads[i]);
+        ASSERT_MSG(e != NULL, "Could not allocate the ensemble");
+        ASSERT_MSG(fmi2_import_ensemble_set_experiment(e, 0.0, STOP_TIME, STEP_SIZE) == jm_status_success,
+                   "Could not set the experiment");
+        start = jm_portability_get_time();
+        ASSERT_MSG(fmi2_import_ensemble_run(e, values, runsNum, NULL) == fmi2_status_ok, "The ensemble failed");
+        printf("ensemble, %2u threads %10.3f us per run\n", (unsigned)threads[i],
+               1e6 * (jm_portability_get_time() - start) / runsNum);
+        fmi2_import_ensemble_free(e);
+    }
+    fmi2_import_free_variable_list(pl);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks callbacks = *jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    fmi2_real_t *values;
+    size_t runsNum = RUNS_NUM, threadsNum = THREADS_NUM;
+    int ret;
+
+    if (argc > 3) runsNum = (size_t)atoi(argv[3]);
+    if (argc > 4) threadsNum = (size_t)atoi(argv[4]);
+    if (runsNum == 0 || threadsNum == 0) {
+        printf("Usage: %s <fmu_file> <temporary_dir> [runs] [threads]\n", argv[0]);
+        return CTEST_RETURN_FAIL;
+    }
+
+    /* the FMU logs every initialization; keep the output readable */
+    callbacks.log_level = jm_log_level_warning;
+    context = fmi2_test_open(argc, argv, "fmi2_import_ensemble_benchmark", &callbacks);
+    if (!context) return CTEST_RETURN_FAIL;
+    fmu = fmi2_test_load(context, argv[2], NULL);
+    values = (fmi2_real_t *)malloc(2 * runsNum * sizeof(fmi2_real_t));
+    if (!fmu || !values) {
+        printf("Could not load the FMU\n");
+        free(values);
+        if (fmu) fmi2_test_unload(fmu);
+        fmi_import_free_context(context);
+        return CTEST_RETURN_FAIL;
+    }
+
+    parameters(values, runsNum);
+    ret = benchmark(context, argv[2], fmu, values, runsNum, threadsNum);
+
+    free(values);
+    fmi2_test_unload(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
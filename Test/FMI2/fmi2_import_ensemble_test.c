@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define RUNS_NUM 64
+#define THREADS_NUM 4
+#define STOP_TIME 1.0
+#define STEP_SIZE 0.01
+#define STEPS_NUM 100
+#define REFERENCE_RUNS_NUM 4
+
+/* Output of the runs, written by the sink */
+typedef struct results_t {
+    fmi2_real_t final[RUNS_NUM];
+    size_t calls[RUNS_NUM];
+    int ordered[RUNS_NUM];
+    fmi2_real_t lastTime[RUNS_NUM];
+} results_t;
+
+static void sink(void *userData, size_t run, fmi2_real_t time, const fmi2_real_t outputs[], size_t outputsNum)
+{
+    results_t *r = (results_t *)userData;
+    /* the calls of one run come from one thread, so no locking is needed */
+    if (r->calls[run] > 0 && !(time > r->lastTime[run])) r->ordered[run] = 0;
+    r->lastTime[run] = time;
+    r->calls[run]++;
+    if (outputsNum == 1) r->final[run] = outputs[0];
+}
+
+static void parameters(fmi2_real_t *values)
+{
+    int run;
+    for (run = 0; run < RUNS_NUM; run++) {
+        values[2 * run] = -9.81 + 0.05 * run;          /* GRAVITY */
+        values[2 * run + 1] = 0.3 + 0.01 * (run % 50); /* BOUNCE_COF */
+    }
+}
+
+static fmi2_import_variable_list_t *variables(fmi2_import_t *fmu, const char **names, size_t n)
+{
+    fmi2_import_variable_list_t *vl = fmi2_import_alloc_variable_list(fmu, 0);
+    size_t i;
+    for (i = 0; vl && i < n; i++) {
+        fmi2_import_var_list_push_back(vl, fmi2_import_get_variable_by_name(fmu, names[i]));
+    }
+    return vl;
+}
+
+/* One run done the usual way: parse, load, instantiate, simulate and free */
+static fmi2_real_t reference(fmi_import_context_t *context, const char *dir, const fmi2_real_t *values)
+{
+    fmi2_import_t *fmu = fmi2_test_load(context, dir, NULL);
+    fmi2_value_reference_t vrs[2] = {2, 3}, hight = 0;
+    fmi2_real_t result = 0, time = 0;
+    int k;
+
+    if (!fmu) return -1;
+    if (fmi2_import_instantiate(fmu, "reference", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success) {
+        fmi2_import_setup_experiment(fmu, fmi2_true, 1e-4, 0.0, fmi2_true, STOP_TIME);
+        fmi2_import_enter_initialization_mode(fmu);
+        fmi2_import_set_real(fmu, vrs, 2, values);
+        fmi2_import_exit_initialization_mode(fmu);
+        for (k = 1; k <= STEPS_NUM; k++) {
+            fmi2_real_t next = (k == STEPS_NUM) ? STOP_TIME : k * STEP_SIZE;
+            fmi2_import_do_step(fmu, time, next - time, fmi2_true);
+            time = next;
+        }
+        fmi2_import_get_real(fmu, &hight, 1, &result);
+        fmi2_test_stop(fmu);
+    }
+    fmi2_test_unload(fmu);
+    return result;
+}
+
+static int test_ensemble(fmi_import_context_t *context, const char *dir, fmi2_import_t *fmu, const fmi2_real_t *values)
+{
+    const char *parameterNames[] = {"GRAVITY", "BOUNCE_COF"}, *outputNames[] = {"HIGHT"};
+    fmi2_import_variable_list_t *pl = variables(fmu, parameterNames, 2), *ol = variables(fmu, outputNames, 1);
+    fmi2_import_ensemble_t *e = fmi2_import_ensemble_allocate(fmu, pl, ol, THREADS_NUM);
+    fmi2_import_ensemble_stats_t stats;
+    fmi2_status_t runStatus[RUNS_NUM];
+    results_t *r = (results_t *)calloc(1, sizeof(results_t));
+    fmi2_real_t first[RUNS_NUM];
+    int run, pass, ok = 1;
+
+    fmi2_import_free_variable_list(pl);
+    fmi2_import_free_variable_list(ol);
+    ASSERT_MSG(e != NULL && r != NULL, "Could not allocate the ensemble");
+    ASSERT_MSG(fmi2_import_ensemble_get_threads_num(e) == THREADS_NUM, "wrong number of threads");
+    ASSERT_MSG(fmi2_import_ensemble_set_experiment(e, 1.0, 0.0, STEP_SIZE) == jm_status_error, "empty interval accepted");
+    ASSERT_MSG(fmi2_import_ensemble_set_solver(e, fmi_import_solver_rk4, 1e-6) == jm_status_error, "solver accepted for co-simulation");
+    fmi2_import_ensemble_set_experiment(e, 0.0, STOP_TIME, STEP_SIZE);
+    fmi2_import_ensemble_set_sink(e, sink, r);
+
+    /* the second pass reuses the instances and pins the threads */
+    for (pass = 0; ok && pass < 2; pass++) {
+        memset(r, 0, sizeof(*r));
+        for (run = 0; run < RUNS_NUM; run++) r->ordered[run] = 1;
+        fmi2_import_ensemble_set_pinning(e, pass);
+        ok = fmi2_import_ensemble_run(e, values, RUNS_NUM, runStatus) == fmi2_status_ok;
+        for (run = 0; ok && run < RUNS_NUM; run++) {
+            ok = runStatus[run] == fmi2_status_ok && r->calls[run] == STEPS_NUM + 1 && r->ordered[run] && r->lastTime[run] == STOP_TIME;
+            if (pass == 0) first[run] = r->final[run];
+            else ok = ok && first[run] == r->final[run];
+        }
+    }
+    fmi2_import_ensemble_get_stats(e, &stats);
+    printf("%u runs, %u instances, %u resets, %u steps, %.3f ms setup, %.3f ms simulation\n", (unsigned)stats.runsNum,
+           (unsigned)stats.instancesNum, (unsigned)stats.resetsNum, (unsigned)stats.stepsNum,
+           1e3 * stats.setupSeconds, 1e3 * stats.simulationSeconds);
+    fmi2_import_ensemble_free(e);
+
+    /* the final values match separate simulations, so that nothing leaks from one run to the next */
+    for (run = 0; ok && run < REFERENCE_RUNS_NUM; run++) {
+        int k = run * (RUNS_NUM / REFERENCE_RUNS_NUM) + 1;
+        ok = reference(context, dir, values + 2 * k) == first[k];
+    }
+    free(r);
+
+    ASSERT_MSG(ok, "ensemble results differ from the reference");
+    ASSERT_MSG(stats.runsNum == 2 * RUNS_NUM && stats.failedRunsNum == 0, "wrong number of runs");
+    ASSERT_MSG(stats.instancesNum <= THREADS_NUM && stats.instancesNum + stats.resetsNum == stats.runsNum, "instances not reused");
+    ASSERT_MSG(stats.stepsNum == 2 * RUNS_NUM * STEPS_NUM, "wrong number of steps");
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks callbacks = *jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    fmi2_real_t values[2 * RUNS_NUM];
+    int ret = 1;
+
+    /* the FMU logs every initialization; keep the output readable */
+    callbacks.log_level = jm_log_level_warning;
+    context = fmi2_test_open(argc, argv, "fmi2_import_ensemble_test", &callbacks);
+    if (!context) return CTEST_RETURN_FAIL;
+    fmu = fmi2_test_load(context, argv[2], NULL);
+    if (!fmu) {
+        printf("Could not load the FMU\n");
+        fmi_import_free_context(context);
+        return CTEST_RETURN_FAIL;
+    }
+
+    parameters(values);
+    ret &= test_ensemble(context, argv[2], fmu, values);
+
+    fmi2_test_unload(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+/* The second sample at time 1 is a discontinuity, the last channel has no variable in the FMU */
+static const char *table =
+    "time, BOUNCE_COF,\"GRAVITY\",unknown\n"
+    "0,0.5,-9.81,1\n"
+    "1,0.7,-9.0,2\r\n"
+    "\n"
+    "1,0.9,-8.0,3\n"
+    "3, 0.1 ,-10.0,4\n";
+
+static int write_text(const char *fileName, const char *text)
+{
+    FILE *f = fopen(fileName, "wb");
+    ASSERT_MSG(f != NULL, "could not create a file");
+    fputs(text, f);
+    fclose(f);
+    return TEST_OK;
+}
+
+/* Replace a text in a file that is smaller than the buffer */
+static int replace_text(const char *fileName, const char *from, const char *to)
+{
+    static char text[65536];
+    char *found;
+    size_t len;
+    FILE *f = fopen(fileName, "rb");
+
+    ASSERT_MSG(f != NULL, "could not open a file");
+    len = fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    text[len] = 0;
+    found = strstr(text, from);
+    ASSERT_MSG(found != NULL, "text to replace not found");
+    f = fopen(fileName, "wb");
+    ASSERT_MSG(f != NULL, "could not create a file");
+    fwrite(text, 1, found - text, f);
+    fputs(to, f);
+    fputs(found + strlen(from), f);
+    fclose(f);
+    return TEST_OK;
+}
+
+/* The test FMU has neither inputs nor tunable parameters. Make GRAVITY an input
+   and BOUNCE_COF a tunable parameter in the unzipped model description. */
+static int make_inputs(const char *dir)
+{
+    char fileName[FILENAME_MAX];
+
+    sprintf(fileName, "%s/modelDescription.xml", dir);
+    if (!replace_text(fileName, "description=\"Gravity constant\" initial=\"exact\"",
+                      "description=\"Gravity constant\" causality=\"input\"")) return 0;
+    return replace_text(fileName, "initial=\"exact\" description=\"Bouncing coefficient\"",
+                        "causality=\"parameter\" variability=\"tunable\" description=\"Bouncing coefficient\"");
+}
+
+static int near(fmi2_real_t a, fmi2_real_t b)
+{
+    return fabs(a - b) < 1e-12;
+}
+
+static int check(fmi2_import_input_table_t *t, fmi2_real_t time, fmi2_real_t a, fmi2_real_t b, fmi2_real_t c)
+{
+    fmi2_real_t values[3];
+    fmi2_import_input_table_evaluate(t, time, values);
+    if (!near(values[0], a) || !near(values[1], b) || !near(values[2], c)) {
+        printf("At time %g expected %g %g %g but got %g %g %g\n", time, a, b, c, values[0], values[1], values[2]);
+        return 0;
+    }
+    return TEST_OK;
+}
+
+/* Interpolation, discontinuities, holding outside the samples and evaluation at decreasing times */
+static int test_evaluate(fmi2_import_input_table_t *t)
+{
+    fmi2_real_t slopes[3];
+    size_t index;
+
+    ASSERT_MSG(fmi2_import_input_table_get_channels_num(t) == 3, "wrong number of channels");
+    ASSERT_MSG(fmi2_import_input_table_get_samples_num(t) == 4, "wrong number of samples");
+    ASSERT_MSG(strcmp(fmi2_import_input_table_get_channel_name(t, 1), "GRAVITY") == 0, "quotes not removed");
+    ASSERT_MSG(fmi2_import_input_table_find_channel(t, "unknown", &index) == jm_status_success && index == 2,
+               "channel not found");
+    ASSERT_MSG(fmi2_import_input_table_find_channel(t, "time", &index) == jm_status_error, "time found as a channel");
+    ASSERT_MSG(fmi2_import_input_table_get_time(t)[3] == 3.0, "wrong time");
+
+    fmi2_import_input_table_set_interpolation(t, fmi2_import_input_linear);
+    ASSERT_MSG(check(t, 0.5, 0.6, -9.405, 1.5), "wrong linear interpolation");
+    ASSERT_MSG(check(t, 1.0, 0.9, -8.0, 3.0), "the later sample does not apply at a discontinuity");
+    ASSERT_MSG(check(t, 2.0, 0.5, -9.0, 3.5), "wrong linear interpolation after a discontinuity");
+    ASSERT_MSG(check(t, 5.0, 0.1, -10.0, 4.0), "last value not held");
+    ASSERT_MSG(check(t, -1.0, 0.5, -9.81, 1.0), "first value not held");
+    ASSERT_MSG(check(t, 2.5, 0.3, -9.5, 3.75), "wrong value after a jump forward");
+    ASSERT_MSG(check(t, 0.25, 0.55, -9.6075, 1.25), "wrong value after a jump back");
+
+    fmi2_import_input_table_evaluate_slopes(t, 2.0, slopes);
+    ASSERT_MSG(near(slopes[0], -0.4) && near(slopes[1], -1.0) && near(slopes[2], 0.5), "wrong slopes");
+    fmi2_import_input_table_evaluate_slopes(t, 5.0, slopes);
+    ASSERT_MSG(slopes[0] == 0.0 && slopes[2] == 0.0, "slopes after the last sample");
+
+    fmi2_import_input_table_set_interpolation(t, fmi2_import_input_zero_order_hold);
+    ASSERT_MSG(check(t, 0.99, 0.5, -9.81, 1.0), "wrong zero-order hold");
+    ASSERT_MSG(check(t, 2.5, 0.9, -8.0, 3.0), "wrong zero-order hold after a discontinuity");
+    fmi2_import_input_table_evaluate_slopes(t, 0.5, slopes);
+    ASSERT_MSG(slopes[0] == 0.0, "slopes with zero-order hold");
+    fmi2_import_input_table_set_interpolation(t, fmi2_import_input_linear);
+    return TEST_OK;
+}
+
+/* A mapped binary table evaluates like the table it was written from */
+static int test_binary(jm_callbacks *cb, fmi2_import_input_table_t *t, const char *fileName)
+{
+    fmi2_import_input_table_t *mapped;
+    fmi2_real_t a[3], b[3];
+    int k;
+
+    ASSERT_MSG(fmi2_import_input_table_write_binary(t, fileName) == jm_status_success, "could not write the table");
+    mapped = fmi2_import_input_table_map_binary(cb, fileName);
+    ASSERT_MSG(mapped != NULL, "could not map the table");
+    ASSERT_MSG(strcmp(fmi2_import_input_table_get_channel_name(mapped, 2), "unknown") == 0, "wrong name in the mapped table");
+    for (k = -10; k < 40; k++) {
+        fmi2_import_input_table_evaluate(t, k * 0.1, a);
+        fmi2_import_input_table_evaluate(mapped, k * 0.1, b);
+        ASSERT_MSG(memcmp(a, b, sizeof(a)) == 0, "the mapped table evaluates differently");
+    }
+    fmi2_import_input_table_free(mapped);
+    return TEST_OK;
+}
+
+/* The input and the tunable parameter are set, the FMU cannot interpolate inputs so no derivatives are set */
+static int test_apply(fmi2_import_input_table_t *t, fmi2_import_t *fmu)
+{
+    fmi2_value_reference_t vr[] = {3, 2};
+    fmi2_real_t values[2];
+
+    ASSERT_MSG(fmi2_import_input_table_apply(t, 0.0) == fmi2_status_error, "applied without an FMU");
+    ASSERT_MSG(fmi2_import_input_table_bind(t, fmu) == jm_status_success, "could not bind the table");
+    ASSERT_MSG(fmi2_import_input_table_get_bound_num(t) == 2, "wrong number of bound channels");
+    ASSERT_MSG(!fmi2_import_input_table_sets_derivatives(t), "derivatives set without inputs");
+
+    ASSERT_MSG(fmi2_import_instantiate(fmu, "input table", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+               "instantiation failed");
+    ASSERT_MSG(fmi2_import_input_table_apply(t, 2.0) == fmi2_status_ok, "could not apply the table");
+    ASSERT_MSG(fmi2_import_get_real(fmu, vr, 2, values) == fmi2_status_ok, "could not get the values");
+    ASSERT_MSG(near(values[0], 0.5) && near(values[1], -9.0), "the variables were not set");
+    fmi2_import_free_instance(fmu);
+    return TEST_OK;
+}
+
+/* A binary table whose names are not terminated within the names is rejected */
+static int test_unterminated(jm_callbacks *cb, fmi2_import_input_table_t *t, const char *fileName)
+{
+    unsigned int namesSize;
+    FILE *f;
+
+    ASSERT_MSG(fmi2_import_input_table_write_binary(t, fileName) == jm_status_success, "could not write the table");
+    f = fopen(fileName, "r+b");
+    ASSERT_MSG(f != NULL, "could not open the table");
+    ASSERT_MSG(fseek(f, 8 + 3 * sizeof(unsigned int), SEEK_SET) == 0 && fread(&namesSize, sizeof(namesSize), 1, f) == 1,
+               "could not read the table header");
+    fseek(f, 8 + 4 * sizeof(unsigned int), SEEK_SET);
+    for (; namesSize > 0; namesSize--) fputc('x', f);
+    fclose(f);
+    ASSERT_MSG(fmi2_import_input_table_map_binary(cb, fileName) == NULL, "unterminated names accepted");
+    return TEST_OK;
+}
+
+/* Malformed files are rejected */
+static int test_errors(jm_callbacks *cb, fmi2_import_t *fmu, const char *dir)
+{
+    char fileName[FILENAME_MAX];
+    fmi2_import_input_table_t *t;
+
+    sprintf(fileName, "%s/input_errors.csv", dir);
+    ASSERT_MSG(fmi2_import_input_table_load_csv(cb, "no_such_file.csv") == NULL, "missing file loaded");
+    if (!write_text(fileName, "time,a\n0,1\n1\n")) return 0;
+    ASSERT_MSG(fmi2_import_input_table_load_csv(cb, fileName) == NULL, "missing value accepted");
+    if (!write_text(fileName, "time,a\n0,1\n1,2,3\n")) return 0;
+    ASSERT_MSG(fmi2_import_input_table_load_csv(cb, fileName) == NULL, "extra value accepted");
+    if (!write_text(fileName, "time,a\n0,1\n1,x\n")) return 0;
+    ASSERT_MSG(fmi2_import_input_table_load_csv(cb, fileName) == NULL, "invalid number accepted");
+    if (!write_text(fileName, "time,a\n1,1\n0,2\n")) return 0;
+    ASSERT_MSG(fmi2_import_input_table_load_csv(cb, fileName) == NULL, "decreasing time accepted");
+    if (!write_text(fileName, "time,a\n")) return 0;
+    ASSERT_MSG(fmi2_import_input_table_load_csv(cb, fileName) == NULL, "table without samples accepted");
+    ASSERT_MSG(fmi2_import_input_table_map_binary(cb, fileName) == NULL, "text file mapped");
+
+    if (!write_text(fileName, "time;LOGGER_TEST;HIGHT;HIGHT_SPEED\n0;1;2;3\n")) return 0;
+    t = fmi2_import_input_table_load_csv(cb, fileName);
+    ASSERT_MSG(t != NULL, "could not load a table separated by semicolons");
+    ASSERT_MSG(fmi2_import_input_table_bind(t, fmu) == jm_status_success, "could not bind the table");
+    ASSERT_MSG(fmi2_import_input_table_get_bound_num(t) == 0, "a variable that is not an input was bound");
+    fmi2_import_input_table_free(t);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks callbacks = *jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_input_table_t *t;
+    fmi2_import_t *fmu;
+    char fileName[FILENAME_MAX];
+    int ret = 1;
+
+    callbacks.log_level = jm_log_level_warning;
+    context = fmi2_test_open(argc, argv, "fmi2_import_input_table_test", &callbacks);
+    if (!context) return CTEST_RETURN_FAIL;
+    if (!make_inputs(argv[2])) return CTEST_RETURN_FAIL;
+    fmu = fmi2_test_load(context, argv[2], NULL);
+    if (!fmu) {
+        printf("Could not load the FMU\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    sprintf(fileName, "%s/input.csv", argv[2]);
+    if (!write_text(fileName, table)) return CTEST_RETURN_FAIL;
+    t = fmi2_import_input_table_load_csv(&callbacks, fileName);
+    if (!t) {
+        printf("Could not load the input table\n");
+        return CTEST_RETURN_FAIL;
+    }
+    ret &= test_evaluate(t);
+    sprintf(fileName, "%s/input.bin", argv[2]);
+    ret &= test_binary(&callbacks, t, fileName);
+    ret &= test_unterminated(&callbacks, t, fileName);
+    ret &= test_apply(t, fmu);
+    fmi2_import_input_table_free(t);
+    ret &= test_errors(&callbacks, fmu, argv[2]);
+
+    fmi2_test_unload(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
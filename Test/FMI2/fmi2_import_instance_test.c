@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+
+#define N_INSTANCES 3
+
+static const fmi2_value_reference_t height_vr[] = {0, 1};
+/* height and speed of the bouncing ball at t = 2, see fmi2_import_cs_test */
+static const fmi2_real_t reference[] = {0.0143633, -1.62417};
+
+static int init_instance(fmi2_import_instance_t *inst, const char *name)
+{
+    ASSERT_MSG(fmi2_import_instance_instantiate(inst, name, fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+               "instantiate failed");
+    ASSERT_MSG(fmi2_import_instance_setup_experiment(inst, fmi2_true, 1e-4, 0.0, fmi2_false, 2.0) == fmi2_status_ok,
+               "setup experiment failed");
+    ASSERT_MSG(fmi2_import_instance_enter_initialization_mode(inst) == fmi2_status_ok, "enter initialization mode failed");
+    ASSERT_MSG(fmi2_import_instance_exit_initialization_mode(inst) == fmi2_status_ok, "exit initialization mode failed");
+    return TEST_OK;
+}
+
+static int check_result(fmi2_import_instance_t *inst)
+{
+    fmi2_real_t val[2];
+    size_t k;
+
+    ASSERT_MSG(fmi2_import_instance_get_real(inst, height_vr, 2, val) == fmi2_status_ok, "get real failed");
+    for (k = 0; k < 2; k++) {
+        fmi2_real_t res = val[k] - reference[k];
+        res = res > 0 ? res : -res;
+        ASSERT_MSG(res < 3e-3, "simulation result is wrong");
+    }
+    return TEST_OK;
+}
+
+/* Instances created from one loaded binary must keep separate state.
+ * They are stepped interleaved, with different step sizes. */
+static int test_instances(fmi2_import_t *fmu)
+{
+    fmi2_import_instance_t *inst[N_INSTANCES];
+    fmi2_real_t h[N_INSTANCES] = {0.1, 0.05, 0.1};
+    fmi2_real_t t[N_INSTANCES] = {0.0, 0.0, 0.0};
+    int done = 0;
+    size_t i;
+
+    for (i = 0; i < N_INSTANCES; i++) {
+        inst[i] = fmi2_import_instance_allocate(fmu, NULL);
+        ASSERT_MSG(inst[i] != NULL, "could not allocate instance");
+        ASSERT_MSG(fmi2_import_instance_get_fmu(inst[i]) == fmu, "instance does not refer to its FMU");
+        ASSERT_MSG(fmi2_import_instance_get_component(inst[i]) == NULL, "component must not exist before instantiation");
+        ASSERT_MSG(init_instance(inst[i], "instance"), "could not initialize instance");
+    }
+    ASSERT_MSG(fmi2_import_instance_get_component(inst[0]) != fmi2_import_instance_get_component(inst[1]),
+               "instances must have separate components");
+
+    /* the last instance is only advanced to t = 1 in the loop and finished afterwards */
+    while (!done) {
+        done = 1;
+        for (i = 0; i < N_INSTANCES; i++) {
+            fmi2_real_t tend = (i == N_INSTANCES - 1) ? 1.0 : 2.0;
+            if (t[i] < tend - 1e-10) {
+                ASSERT_MSG(fmi2_import_instance_do_step(inst[i], t[i], h[i], fmi2_true) == fmi2_status_ok, "do step failed");
+                t[i] += h[i];
+                done = 0;
+            }
+        }
+    }
+
+    ASSERT_MSG(check_result(inst[0]), "first instance");
+    ASSERT_MSG(check_result(inst[1]), "second instance");
+    {
+        fmi2_real_t val[2];
+        ASSERT_MSG(fmi2_import_instance_get_real(inst[2], height_vr, 2, val) == fmi2_status_ok, "get real failed");
+        ASSERT_MSG(val[1] != reference[1], "third instance must not have reached the end time yet");
+    }
+    while (t[2] < 2.0 - 1e-10) {
+        ASSERT_MSG(fmi2_import_instance_do_step(inst[2], t[2], h[2], fmi2_true) == fmi2_status_ok, "do step failed");
+        t[2] += h[2];
+    }
+    ASSERT_MSG(check_result(inst[2]), "third instance");
+
+    /* the component of an instance is freed together with it */
+    ASSERT_MSG(fmi2_import_instance_terminate(inst[0]) == fmi2_status_ok, "terminate failed");
+    fmi2_import_instance_free_instance(inst[0]);
+    ASSERT_MSG(fmi2_import_instance_get_component(inst[0]) == NULL, "component not freed");
+    for (i = 0; i < N_INSTANCES; i++) {
+        fmi2_import_instance_free(inst[i]);
+    }
+    return TEST_OK;
+}
+
+/* Freeing an instance releases the dependency index and the asynchronous step of its view.
+   The step is still running when the instance is freed and must leave its completion queue. */
+static int test_free_in_use(fmi2_import_t *fmu)
+{
+    fmi2_import_instance_t *inst = fmi2_import_instance_allocate(fmu, NULL);
+    fmi2_import_completion_queue_t *q;
+    fmi2_import_async_step_t *step;
+    size_t *startIndex, *dependent;
+
+    ASSERT_MSG(inst != NULL, "could not allocate instance");
+    ASSERT_MSG(init_instance(inst, "in use"), "could not initialize instance");
+    ASSERT_MSG(fmi2_import_get_dependents(fmi2_import_instance_get_view(inst), fmi2_import_dependency_outputs,
+                                          &startIndex, &dependent) == jm_status_success, "could not build the dependency index");
+    q = fmi2_import_completion_queue_allocate(jm_get_default_callbacks(), 1);
+    ASSERT_MSG(q != NULL, "could not allocate a completion queue");
+    step = fmi2_import_async_step_allocate(q, fmi2_import_instance_get_view(inst), fmi2_import_async_emulated, NULL);
+    ASSERT_MSG(step != NULL, "could not allocate an asynchronous step");
+    ASSERT_MSG(fmi2_import_async_step_submit(step, 0.0, 0.1, fmi2_true) == fmi2_status_ok, "could not submit a step");
+
+    fmi2_import_instance_free(inst);
+    ASSERT_MSG(fmi2_import_completion_queue_get_running_num(q) == 0, "the step of the freed instance is still running");
+    ASSERT_MSG(fmi2_import_completion_queue_poll(q) == NULL, "the queue returned the step of the freed instance");
+    fmi2_import_completion_queue_free(q);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks *cb = jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    int ret = 1;
+
+    if (argc < 3) {
+        printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+        return CTEST_RETURN_FAIL;
+    }
+
+    printf("Running fmi2_import_instance_test\n");
+
+    context = fmi_import_allocate_context(cb);
+    if (fmi_import_get_fmi_version(context, argv[1], argv[2]) != fmi_version_2_0_enu) {
+        printf("The code only supports version 2.0\n");
+        return CTEST_RETURN_FAIL;
+    }
+    fmu = fmi2_import_parse_xml(context, argv[2], NULL);
+    if (!fmu) {
+        return CTEST_RETURN_FAIL;
+    }
+
+    if (fmi2_import_instance_allocate(fmu, NULL) != NULL) {
+        printf("Instance allocation must fail before the binary is loaded\n");
+        return CTEST_RETURN_FAIL;
+    }
+    if (fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, NULL) != jm_status_success) {
+        printf("Could not create the DLL loading mechanism(C-API).\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_instances(fmu);
+    ret &= test_free_in_use(fmu);
+
+    fmi2_import_destroy_dllfmu(fmu);
+    fmi2_import_free(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+static const char *names[] = {
+    "HIGHT", "HIGHT_SPEED alias", "GRAVITY", "HIGHT_SPEED", "HIGHT",
+    "LOGGER_TEST_INTEGER", "LOGGER_TEST_BOOLEAN", "LOGGER_TEST"
+};
+#define NAMES_NUM (sizeof(names) / sizeof(names[0]))
+
+static int test_plan(fmi2_import_t *fmu, fmi2_import_io_conversion_enu_t conversion)
+{
+    fmi2_import_variable_list_t *vl = fmi2_import_alloc_variable_list(fmu, 0);
+    fmi2_import_io_plan_t *plan;
+    const fmi2_value_reference_t *vrs;
+    fmi2_value_reference_t gravityVr = 2, integerVr = 0, booleanVr = 0, stringVr = 0;
+    fmi2_real_t *reals, gravity;
+    fmi2_integer_t integer;
+    fmi2_boolean_t boolean;
+    fmi2_string_t str;
+    size_t i;
+
+    ASSERT_MSG(vl, "could not allocate variable list");
+    for (i = 0; i < NAMES_NUM; i++) {
+        fmi2_import_variable_t *v = fmi2_import_get_variable_by_name(fmu, names[i]);
+        ASSERT_MSG(v && fmi2_import_var_list_push_back(vl, v) == jm_status_success, "could not build variable list");
+    }
+    plan = fmi2_import_io_plan_allocate(fmu, vl, conversion);
+    fmi2_import_free_variable_list(vl);
+    ASSERT_MSG(plan, "could not compile plan");
+
+    /* duplicates and aliases are collapsed, value references are sorted */
+    ASSERT_MSG(fmi2_import_io_plan_get_vrs_num(plan, fmi2_base_type_real) == 3, "wrong number of Real value references");
+    ASSERT_MSG(fmi2_import_io_plan_get_vrs_num(plan, fmi2_base_type_int) == 1, "wrong number of Integer value references");
+    ASSERT_MSG(fmi2_import_io_plan_get_vrs_num(plan, fmi2_base_type_enum) == 1, "Enumeration must share the Integer buffer");
+    ASSERT_MSG(fmi2_import_io_plan_get_vrs_num(plan, fmi2_base_type_bool) == 1, "wrong number of Boolean value references");
+    ASSERT_MSG(fmi2_import_io_plan_get_vrs_num(plan, fmi2_base_type_str) == 1, "wrong number of String value references");
+    vrs = fmi2_import_io_plan_get_vrs(plan, fmi2_base_type_real);
+    ASSERT_MSG(vrs[0] == 0 && vrs[1] == 1 && vrs[2] == 2, "value references must be sorted");
+    ASSERT_MSG(fmi2_import_io_plan_get_value_index(plan, 0) == fmi2_import_io_plan_get_value_index(plan, 4),
+               "duplicate variables must share a value");
+    ASSERT_MSG(fmi2_import_io_plan_get_value_index(plan, 1) == fmi2_import_io_plan_get_value_index(plan, 3),
+               "aliases must share a value");
+    ASSERT_MSG(fmi2_import_io_plan_get_value_index(plan, 2) == 2, "wrong value index");
+
+    ASSERT_MSG(fmi2_import_io_plan_get(plan) == fmi2_status_ok, "get failed");
+    reals = fmi2_import_io_plan_get_real_values(plan);
+    ASSERT_MSG(reals[fmi2_import_io_plan_get_value_index(plan, 0)] == 1.0, "wrong HIGHT");
+    ASSERT_MSG(reals[fmi2_import_io_plan_get_value_index(plan, 1)] == 4.0, "wrong HIGHT_SPEED");
+    ASSERT_MSG(reals[fmi2_import_io_plan_get_value_index(plan, 2)] == -9.81, "wrong GRAVITY");
+
+    reals[fmi2_import_io_plan_get_value_index(plan, 2)] = -1.62;
+    fmi2_import_io_plan_get_integer_values(plan)[0] = 42;
+    fmi2_import_io_plan_get_boolean_values(plan)[0] = fmi2_true;
+    fmi2_import_io_plan_get_string_values(plan)[0] = "io plan";
+    ASSERT_MSG(fmi2_import_io_plan_set(plan) == fmi2_status_ok, "set failed");
+
+    fmi2_import_get_real(fmu, &gravityVr, 1, &gravity);
+    fmi2_import_get_integer(fmu, &integerVr, 1, &integer);
+    fmi2_import_get_boolean(fmu, &booleanVr, 1, &boolean);
+    fmi2_import_get_string(fmu, &stringVr, 1, &str);
+    ASSERT_MSG(gravity == -1.62 && integer == 42 && boolean == fmi2_true && strcmp(str, "io plan") == 0,
+               "values not set");
+
+    gravity = -9.81;
+    fmi2_import_set_real(fmu, &gravityVr, 1, &gravity);
+    fmi2_import_io_plan_free(plan);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    int ret = 1;
+
+    context = fmi2_test_open(argc, argv, "fmi2_import_io_plan_test", NULL);
+    if (!context) return CTEST_RETURN_FAIL;
+    fmu = fmi2_test_load_started(context, argv[2], "io_plan");
+    if (!fmu) {
+        printf("Could not load the FMU\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_plan(fmu, fmi2_import_io_no_conversion);
+    /* the test FMU has no units, so the conversions are the identity */
+    ret &= test_plan(fmu, fmi2_import_io_display_unit);
+    ret &= test_plan(fmu, fmi2_import_io_SI_unit);
+
+    fmi2_test_unload_started(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,141 @@
+#include <stdio.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+
+static fmi2_import_t *parse_xml(const char *model_desc_path)
+{
+    jm_callbacks *cb = jm_get_default_callbacks();
+    fmi_import_context_t *ctx = fmi_import_allocate_context(cb);
+    fmi2_import_t *xml;
+
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    xml = fmi2_import_parse_xml(ctx, model_desc_path, NULL);
+
+    fmi_import_free_context(ctx);
+    return xml;
+}
+
+/* no two columns of the same color may have a row in common */
+static int coloring_is_valid(fmi2_import_jacobian_t *jac)
+{
+    const size_t *rowStart, *colIndex;
+    const size_t *colors = fmi2_import_get_jacobian_column_colors(jac);
+    size_t nRows = fmi2_import_get_jacobian_rows_num(jac);
+    size_t r, k, l;
+
+    fmi2_import_get_jacobian_sparsity(jac, &rowStart, &colIndex);
+    for (r = 0; r < nRows; r++) {
+        for (k = rowStart[r]; k < rowStart[r + 1]; k++) {
+            for (l = k + 1; l < rowStart[r + 1]; l++) {
+                if (colors[colIndex[k]] == colors[colIndex[l]]) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+/* tridiagonal state Jacobian plus two outputs */
+static int test_states_jacobian(fmi2_import_t *xml)
+{
+    fmi2_import_jacobian_t *jac = fmi2_import_create_jacobian(xml, fmi2_import_jacobian_states);
+    const size_t *rowStart, *colIndex, *colorStart, *colorColumns;
+    const fmi2_value_reference_t *rowVR, *colVR;
+    size_t expRowStart[] = {0, 2, 5, 8, 11, 13, 14, 15};
+    size_t expColIndex[] = {0, 1, 0, 1, 2, 1, 2, 3, 2, 3, 4, 3, 4, 0, 4};
+    size_t i;
+
+    ASSERT_MSG(jac != NULL, "failed to create states Jacobian");
+    ASSERT_MSG(fmi2_import_get_jacobian_rows_num(jac) == 7, "incorrect number of rows");
+    ASSERT_MSG(fmi2_import_get_jacobian_columns_num(jac) == 5, "incorrect number of columns");
+    ASSERT_MSG(fmi2_import_get_jacobian_nonzeros_num(jac) == 15, "incorrect number of non-zeros");
+
+    rowVR = fmi2_import_get_jacobian_row_vrs(jac);
+    colVR = fmi2_import_get_jacobian_column_vrs(jac);
+    ASSERT_MSG(rowVR[0] == 11 && rowVR[4] == 15 && rowVR[5] == 31 && rowVR[6] == 32, "incorrect row value references");
+    for (i = 0; i < 5; i++) {
+        ASSERT_MSG(colVR[i] == i + 1, "incorrect column value references");
+    }
+
+    fmi2_import_get_jacobian_sparsity(jac, &rowStart, &colIndex);
+    for (i = 0; i < 8; i++) {
+        ASSERT_MSG(rowStart[i] == expRowStart[i], "incorrect row start");
+    }
+    for (i = 0; i < 15; i++) {
+        ASSERT_MSG(colIndex[i] == expColIndex[i], "incorrect column index");
+    }
+
+    ASSERT_MSG(fmi2_import_get_jacobian_colors_num(jac) == 3, "tridiagonal pattern should need three colors");
+    ASSERT_MSG(coloring_is_valid(jac), "invalid coloring of states Jacobian");
+
+    fmi2_import_get_jacobian_coloring(jac, &colorStart, &colorColumns);
+    ASSERT_MSG(colorStart[0] == 0 && colorStart[3] == 5, "incorrect color groups");
+    for (i = 0; i < 5; i++) {
+        ASSERT_MSG(fmi2_import_get_jacobian_column_colors(jac)[colorColumns[i]] ==
+                   (i < colorStart[1] ? 0 : (i < colorStart[2] ? 1 : 2)), "color groups do not match column colors");
+    }
+
+    ASSERT_MSG(fmi2_import_eval_jacobian(xml, jac, NULL) == fmi2_status_error,
+               "evaluation without a loaded binary should fail");
+
+    fmi2_import_free_jacobian(jac);
+    return TEST_OK;
+}
+
+/* inputs touch disjoint rows and can share one color */
+static int test_inputs_jacobian(fmi2_import_t *xml)
+{
+    fmi2_import_jacobian_t *jac = fmi2_import_create_jacobian(xml, fmi2_import_jacobian_inputs);
+    const size_t *rowStart, *colIndex;
+    const fmi2_value_reference_t *colVR;
+
+    ASSERT_MSG(jac != NULL, "failed to create inputs Jacobian");
+    ASSERT_MSG(fmi2_import_get_jacobian_rows_num(jac) == 7, "incorrect number of rows");
+    ASSERT_MSG(fmi2_import_get_jacobian_columns_num(jac) == 2, "incorrect number of columns");
+    ASSERT_MSG(fmi2_import_get_jacobian_nonzeros_num(jac) == 4, "incorrect number of non-zeros");
+
+    colVR = fmi2_import_get_jacobian_column_vrs(jac);
+    ASSERT_MSG(colVR[0] == 21 && colVR[1] == 22, "incorrect column value references");
+
+    fmi2_import_get_jacobian_sparsity(jac, &rowStart, &colIndex);
+    ASSERT_MSG(rowStart[1] - rowStart[0] == 1 && colIndex[rowStart[0]] == 0, "der(x1) should depend on u1");
+    ASSERT_MSG(rowStart[2] == rowStart[1], "der(x2) should not depend on inputs");
+    ASSERT_MSG(rowStart[5] - rowStart[4] == 1 && colIndex[rowStart[4]] == 1, "der(x5) should depend on u2");
+
+    ASSERT_MSG(fmi2_import_get_jacobian_colors_num(jac) == 1, "inputs should need one color");
+    ASSERT_MSG(coloring_is_valid(jac), "invalid coloring of inputs Jacobian");
+
+    fmi2_import_free_jacobian(jac);
+    return TEST_OK;
+}
+
+int main(int argc, char **argv)
+{
+    fmi2_import_t *xml;
+    int ret = 1;
+
+    if (argc != 2) {
+        printf("Usage: %s <path to folder jacobian>\n", argv[0]);
+        return CTEST_RETURN_FAIL;
+    }
+
+    printf("Running fmi2_import_jacobian_test\n");
+
+    xml = parse_xml(argv[1]);
+    if (xml == NULL) {
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_states_jacobian(xml);
+    ret &= test_inputs_jacobian(xml);
+
+    fmi2_import_free(xml);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
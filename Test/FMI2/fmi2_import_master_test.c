@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define FMUS_NUM 3
+#define STEPS_NUM 20
+#define STEP_SIZE 0.01
+
+/* Chain FMU 2 -> FMU 1 -> FMU 0: HIGHT of the source sets GRAVITY of the destination.
+   HIGHT of FMU 2 also fans out to BOUNCE_COF of FMU 0. */
+#define CONNECTIONS_NUM 3
+static const size_t srcFmu[] = {2, 1, 2};
+static const size_t dstFmu[] = {1, 0, 0};
+static const fmi2_value_reference_t dstVr[] = {2, 2, 3};
+
+static void unload(fmi2_import_t **fmus)
+{
+    int i;
+    for (i = 0; i < FMUS_NUM; i++) {
+        if (fmus[i]) fmi2_test_unload_started(fmus[i]);
+    }
+}
+
+static int load_all(fmi_import_context_t *context, const char *dir, fmi2_import_t **fmus)
+{
+    int i, ok = 1;
+    for (i = 0; i < FMUS_NUM; i++) {
+        fmus[i] = fmi2_test_load_started(context, dir, "master");
+        ok = ok && fmus[i];
+    }
+    return ok;
+}
+
+/* Propagate the initial outputs along the chain, like fmi2_import_master_exchange() */
+static void reference_exchange(fmi2_import_t **fmus)
+{
+    fmi2_value_reference_t hight = 0;
+    fmi2_real_t value;
+    int c;
+    for (c = 0; c < CONNECTIONS_NUM; c++) {
+        fmi2_import_get_real(fmus[srcFmu[c]], &hight, 1, &value);
+        fmi2_import_set_real(fmus[dstFmu[c]], &dstVr[c], 1, &value);
+    }
+}
+
+/* Step the chain by hand with either scheme */
+static int reference(fmi_import_context_t *context, const char *dir, fmi2_import_master_mode_enu_t mode, fmi2_real_t *result, fmi2_real_t *bounceCof)
+{
+    fmi2_import_t *fmus[FMUS_NUM];
+    fmi2_value_reference_t hight = 0, bounceCofVr = 3;
+    fmi2_real_t outputs[FMUS_NUM];
+    int i, c, step;
+
+    ASSERT_MSG(load_all(context, dir, fmus), "could not load FMUs");
+    reference_exchange(fmus);
+    for (i = 0; i < FMUS_NUM; i++) {
+        fmi2_import_get_real(fmus[i], &hight, 1, &outputs[i]);
+    }
+    for (step = 0; step < STEPS_NUM; step++) {
+        if (mode == fmi2_import_master_jacobi) {
+            /* the master sets the inputs at the start of the next step */
+            fmi2_import_get_real(fmus[0], &bounceCofVr, 1, bounceCof);
+            for (i = 0; i < FMUS_NUM; i++) {
+                fmi2_import_do_step(fmus[i], step * STEP_SIZE, STEP_SIZE, fmi2_true);
+                fmi2_import_get_real(fmus[i], &hight, 1, &outputs[i]);
+            }
+            for (c = 0; c < CONNECTIONS_NUM; c++) {
+                fmi2_import_set_real(fmus[dstFmu[c]], &dstVr[c], 1, &outputs[srcFmu[c]]);
+            }
+        }
+        else {
+            for (i = FMUS_NUM - 1; i >= 0; i--) {
+                fmi2_import_do_step(fmus[i], step * STEP_SIZE, STEP_SIZE, fmi2_true);
+                fmi2_import_get_real(fmus[i], &hight, 1, &outputs[i]);
+                for (c = 0; c < CONNECTIONS_NUM; c++) {
+                    if (srcFmu[c] == (size_t)i) {
+                        fmi2_import_set_real(fmus[dstFmu[c]], &dstVr[c], 1, &outputs[i]);
+                    }
+                }
+            }
+        }
+    }
+    for (i = 0; i < FMUS_NUM; i++) {
+        result[i] = outputs[i];
+    }
+    if (mode != fmi2_import_master_jacobi) {
+        fmi2_import_get_real(fmus[0], &bounceCofVr, 1, bounceCof);
+    }
+    unload(fmus);
+    return TEST_OK;
+}
+
+static int test_master(fmi_import_context_t *context, const char *dir, fmi2_import_master_mode_enu_t mode, size_t threadsNum, int unitConversion)
+{
+    jm_callbacks *cb = jm_get_default_callbacks();
+    fmi2_import_t *fmus[FMUS_NUM];
+    fmi2_import_master_t *m;
+    fmi2_import_master_stats_t stats;
+    fmi2_import_master_fmu_stats_t fmuStats;
+    fmi2_real_t expected[FMUS_NUM], expectedBounceCof, value;
+    fmi2_value_reference_t hight = 0, bounceCofVr = 3;
+    const size_t *order;
+    size_t i, index;
+    int step, ok = 1;
+
+    ASSERT_MSG(reference(context, dir, mode, expected, &expectedBounceCof), "reference simulation failed");
+    ASSERT_MSG(load_all(context, dir, fmus), "could not load FMUs");
+
+    m = fmi2_import_master_allocate(cb);
+    ASSERT_MSG(m, "could not allocate master");
+    for (i = 0; i < FMUS_NUM; i++) {
+        ok = ok && fmi2_import_master_add_fmu(m, fmus[i], &index) == jm_status_success && index == i;
+    }
+    ASSERT_MSG(ok, "could not add FMUs");
+    ASSERT_MSG(fmi2_import_master_connect(m, 2, "HIGHT", 1, "GRAVITY") == jm_status_success, "could not connect");
+    ASSERT_MSG(fmi2_import_master_connect(m, 1, "HIGHT", 0, "GRAVITY") == jm_status_success, "could not connect");
+    ASSERT_MSG(fmi2_import_master_connect(m, 2, "HIGHT", 0, "BOUNCE_COF") == jm_status_success, "could not connect");
+    ASSERT_MSG(fmi2_import_master_connect(m, 2, "HIGHT", 0, "GRAVITY") == jm_status_error, "input connected twice");
+    ASSERT_MSG(fmi2_import_master_connect(m, 2, "no such variable", 0, "BOUNCE_COF") == jm_status_error, "unknown variable accepted");
+    ASSERT_MSG(fmi2_import_master_do_step(m, 0.0, STEP_SIZE) == fmi2_status_error, "stepping must require prepare");
+    /* the test FMU has no units, so the conversion is the identity */
+    fmi2_import_master_set_unit_conversion(m, unitConversion);
+
+    ASSERT_MSG(fmi2_import_master_prepare(m, mode, threadsNum) == jm_status_success, "could not prepare");
+    ASSERT_MSG(fmi2_import_master_get_fmus_num(m) == FMUS_NUM, "wrong number of FMUs");
+    order = fmi2_import_master_get_order(m);
+    ASSERT_MSG(order[0] == 2 && order[1] == 1 && order[2] == 0, "sources must be stepped before their destinations");
+
+    ASSERT_MSG(fmi2_import_master_exchange(m) == fmi2_status_ok, "exchange failed");
+    for (step = 0; step < STEPS_NUM; step++) {
+        ok = ok && fmi2_import_master_do_step(m, step * STEP_SIZE, STEP_SIZE) == fmi2_status_ok;
+    }
+    ASSERT_MSG(ok, "master step failed");
+
+    for (i = 0; i < FMUS_NUM; i++) {
+        ASSERT_MSG(fmi2_import_master_get_fmu_status(m, i) == fmi2_status_ok, "FMU step failed");
+        fmi2_import_get_real(fmus[i], &hight, 1, &value);
+        ASSERT_MSG(value == expected[i], "master result differs from the reference");
+        fmi2_import_master_get_fmu_stats(m, i, &fmuStats);
+        ASSERT_MSG(fmuStats.totalStepTime >= fmuStats.maxStepTime && fmuStats.maxStepTime >= fmuStats.lastStepTime,
+                   "inconsistent FMU statistics");
+    }
+    fmi2_import_get_real(fmus[0], &bounceCofVr, 1, &value);
+    ASSERT_MSG(value == expectedBounceCof, "fan-out connection differs from the reference");
+    fmi2_import_master_get_stats(m, &stats);
+    ASSERT_MSG(stats.stepsNum == STEPS_NUM, "wrong number of steps");
+    ASSERT_MSG(stats.totalStepTime > 0 && stats.totalStepTime >= stats.maxStepTime, "inconsistent statistics");
+    fmi2_import_master_reset_stats(m);
+    fmi2_import_master_get_stats(m, &stats);
+    ASSERT_MSG(stats.stepsNum == 0 && stats.totalStepTime == 0, "statistics not reset");
+
+    fmi2_import_master_free(m);
+    unload(fmus);
+    return TEST_OK;
+}
+
+/* Simulate the chain closed to a loop by HIGHT of FMU 0 setting BOUNCE_COF of FMU 2, so that the Gauss-Seidel
+   scheme also extrapolates a connection, with the adaptive step size and communication points every STEP_SIZE * 10 */
+static int simulate_adaptive(fmi_import_context_t *context, const char *dir, fmi2_import_master_mode_enu_t mode,
+                             const fmi2_import_master_step_control_t *control, fmi2_real_t stopTime,
+                             fmi2_real_t *result, fmi2_import_master_stats_t *stats)
+{
+    fmi2_import_t *fmus[FMUS_NUM];
+    fmi2_import_master_t *m;
+    fmi2_value_reference_t hight = 0;
+    fmi2_real_t t = 0.0, h, outputTime;
+    size_t i, steps = 0;
+    int ok = 1;
+
+    ASSERT_MSG(load_all(context, dir, fmus), "could not load FMUs");
+    m = fmi2_import_master_allocate(NULL);
+    ASSERT_MSG(m, "could not allocate master");
+    for (i = 0; i < FMUS_NUM; i++) {
+        ok = ok && fmi2_import_master_add_fmu(m, fmus[i], NULL) == jm_status_success;
+    }
+    ok = ok && fmi2_import_master_connect(m, 2, "HIGHT", 1, "GRAVITY") == jm_status_success;
+    ok = ok && fmi2_import_master_connect(m, 1, "HIGHT", 0, "GRAVITY") == jm_status_success;
+    ok = ok && fmi2_import_master_connect(m, 2, "HIGHT", 0, "BOUNCE_COF") == jm_status_success;
+    ok = ok && fmi2_import_master_connect(m, 0, "HIGHT", 2, "BOUNCE_COF") == jm_status_success;
+    ASSERT_MSG(ok, "could not build the system");
+    ASSERT_MSG(fmi2_import_master_do_adaptive_step(m, 0.0, stopTime, &h) == fmi2_status_error, "stepping must require prepare");
+    ASSERT_MSG(fmi2_import_master_set_step_control(m, control) == jm_status_success, "could not set the step control");
+    ASSERT_MSG(fmi2_import_master_prepare(m, mode, 1) == jm_status_success, "could not prepare");
+    ASSERT_MSG(fmi2_import_master_get_next_step_size(m) == control->initialStepSize, "wrong initial step size");
+    ASSERT_MSG(fmi2_import_master_exchange(m) == fmi2_status_ok, "exchange failed");
+
+    for (outputTime = 10 * STEP_SIZE; ok && t < stopTime; outputTime += 10 * STEP_SIZE) {
+        if (outputTime > stopTime) outputTime = stopTime;
+        while (ok && t < outputTime) {
+            ok = fmi2_import_master_do_adaptive_step(m, t, outputTime, &h) == fmi2_status_ok;
+            ok = ok && h > 0 && h <= control->maxStepSize && t + h <= outputTime;
+            t += h;
+            steps++;
+        }
+        ok = ok && t == outputTime;
+    }
+    ASSERT_MSG(ok, "adaptive step failed or missed a communication point");
+    fmi2_import_master_get_stats(m, stats);
+    ASSERT_MSG(stats->stepsNum == steps, "wrong number of steps");
+    for (i = 0; i < FMUS_NUM; i++) {
+        fmi2_import_get_real(fmus[i], &hight, 1, &result[i]);
+    }
+    fmi2_import_master_free(m);
+    unload(fmus);
+    return TEST_OK;
+}
+
+/* The adaptive step size follows the tolerance and stays close to small fixed steps */
+static int test_adaptive(fmi_import_context_t *context, const char *dir, fmi2_import_master_mode_enu_t mode)
+{
+    fmi2_import_master_step_control_t control;
+    fmi2_import_master_stats_t tight, loose;
+    fmi2_real_t fine[FMUS_NUM], coarse[FMUS_NUM], result[FMUS_NUM];
+    fmi2_import_master_t *m;
+    size_t i;
+
+    fmi2_import_master_get_default_step_control(&control);
+    control.maxStepSize = STEP_SIZE;
+    control.minStepSize = STEP_SIZE / 100;
+    control.initialStepSize = STEP_SIZE / 100;
+    control.relativeTolerance = control.absoluteTolerance = 1e-9;
+    ASSERT_MSG(simulate_adaptive(context, dir, mode, &control, STEPS_NUM * STEP_SIZE, fine, &tight), "fine simulation failed");
+
+    control.relativeTolerance = control.absoluteTolerance = 1e-3;
+    control.initialStepSize = STEP_SIZE;
+    ASSERT_MSG(simulate_adaptive(context, dir, mode, &control, STEPS_NUM * STEP_SIZE, result, &tight), "tight simulation failed");
+    ASSERT_MSG(tight.rejectedStepsNum > 0, "a too large initial step must be rejected");
+
+    control.relativeTolerance = control.absoluteTolerance = 1e-1;
+    ASSERT_MSG(simulate_adaptive(context, dir, mode, &control, STEPS_NUM * STEP_SIZE, coarse, &loose), "loose simulation failed");
+    printf("%s: %u steps (%u rejected) with tolerance 1e-3, %u steps (%u rejected) with tolerance 1e-1\n",
+           mode == fmi2_import_master_jacobi ? "Jacobi" : "Gauss-Seidel",
+           (unsigned)tight.stepsNum, (unsigned)tight.rejectedStepsNum, (unsigned)loose.stepsNum, (unsigned)loose.rejectedStepsNum);
+    ASSERT_MSG(loose.stepsNum < tight.stepsNum, "a looser tolerance must take fewer steps");
+    for (i = 0; i < FMUS_NUM; i++) {
+        ASSERT_MSG(fabs(result[i] - fine[i]) <= fabs(coarse[i] - fine[i]) + 1e-9, "a tighter tolerance must not be less accurate");
+    }
+
+    m = fmi2_import_master_allocate(NULL);
+    control.minStepSize = 2 * control.maxStepSize;
+    ASSERT_MSG(fmi2_import_master_set_step_control(m, &control) == jm_status_error, "inconsistent step sizes accepted");
+    fmi2_import_master_free(m);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    fmi_import_context_t *context;
+    int ret = 1;
+
+    context = fmi2_test_open(argc, argv, "fmi2_import_master_test", NULL);
+    if (!context) return CTEST_RETURN_FAIL;
+
+    ret &= test_master(context, argv[2], fmi2_import_master_jacobi, 0, 0);
+    ret &= test_master(context, argv[2], fmi2_import_master_jacobi, 1, 0);
+    ret &= test_master(context, argv[2], fmi2_import_master_gauss_seidel, 0, 0);
+    ret &= test_master(context, argv[2], fmi2_import_master_jacobi, 0, 1);
+    ret &= test_adaptive(context, argv[2], fmi2_import_master_jacobi);
+    ret &= test_adaptive(context, argv[2], fmi2_import_master_gauss_seidel);
+
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
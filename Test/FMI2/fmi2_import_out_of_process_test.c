@@ -0,0 +1,177 @@
+/* kill() */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/types.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define STEPS_NUM 200
+#define SNAPSHOT_STEP 120
+#define STEP_SIZE 0.01
+
+static int initMessages = 0;
+
+/* Count the messages of the FMU initialization and print the warnings */
+static void logger(jm_callbacks *cb, jm_string module, jm_log_level_enu_t log_level, jm_string message)
+{
+    (void)cb;
+    if (strstr(message, "Initializing component")) initMessages++;
+    if (log_level <= jm_log_level_warning) {
+        printf("module = %s, log level = %s: %s\n", module, jm_log_level_to_string(log_level), message);
+    }
+}
+
+static fmi2_import_t *load(fmi_import_context_t *context, const char *tmpPath, const char *hostPath)
+{
+    fmi2_import_t *fmu = fmi2_import_parse_xml(context, tmpPath, NULL);
+    if (!fmu) return NULL;
+    if (fmi2_import_set_out_of_process(fmu, hostPath) != jm_status_success ||
+        fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, NULL) != jm_status_success) {
+        fmi2_import_free(fmu);
+        return NULL;
+    }
+    return fmu;
+}
+
+/* Step from step k to n and record the height */
+static int run(fmi2_import_t *fmu, int k, int n, fmi2_real_t hight[])
+{
+    fmi2_value_reference_t vr = 0;
+    for (; k < n; k++) {
+        ASSERT_MSG(fmi2_import_do_step(fmu, k * STEP_SIZE, STEP_SIZE, fmi2_true) == fmi2_status_ok, "step failed");
+        ASSERT_MSG(fmi2_import_get_real(fmu, &vr, 1, &hight[k]) == fmi2_status_ok, "get real failed");
+    }
+    return TEST_OK;
+}
+
+/* The results are the same as in-process, a snapshot survives a crash of the host */
+static int test_out_of_process(fmi_import_context_t *context, const char *tmpPath)
+{
+    fmi2_real_t expected[STEPS_NUM], hight[STEPS_NUM];
+    fmi2_value_reference_t vr[] = {2, 3};
+    fmi2_real_t values[2];
+    fmi2_string_t str = "remote string", strOut = NULL;
+    fmi2_FMU_state_t state = NULL, freed, stale = NULL;
+    fmi2_byte_t *snapshot;
+    size_t size = 0;
+    fmi2_import_t *fmu;
+    unsigned long pid, restartedPid;
+    int k;
+
+    fmu = load(context, tmpPath, NULL);
+    ASSERT_MSG(fmu != NULL, "could not load the FMU in process");
+    ASSERT_MSG(fmi2_import_get_host_pid(fmu) == 0, "in-process FMU has a host");
+    if (!fmi2_test_start(fmu, "remote") || !run(fmu, 0, STEPS_NUM, expected)) return 0;
+    fmi2_test_unload_started(fmu);
+
+    fmu = load(context, tmpPath, FMI2_CAPI_HOST_PATH);
+    ASSERT_MSG(fmu != NULL, "could not load the FMU out of process");
+    pid = fmi2_import_get_host_pid(fmu);
+    ASSERT_MSG(pid != 0, "no host process");
+    ASSERT_MSG(strcmp(fmi2_import_get_version(fmu), "2.0") == 0, "wrong version");
+    ASSERT_MSG(strcmp(fmi2_import_get_types_platform(fmu), "default") == 0, "wrong types platform");
+
+    initMessages = 0;
+    if (!fmi2_test_start(fmu, "remote")) return 0;
+    ASSERT_MSG(initMessages == 1, "FMU log messages not forwarded");
+    ASSERT_MSG(fmi2_import_get_real(fmu, vr, 2, values) == fmi2_status_ok && values[0] == -9.81 && values[1] == 0.5,
+               "wrong start values");
+    ASSERT_MSG(fmi2_import_set_string(fmu, vr, 1, &str) == fmi2_status_ok, "set string failed");
+    ASSERT_MSG(fmi2_import_get_string(fmu, vr, 1, &strOut) == fmi2_status_ok && strOut && strcmp(strOut, str) == 0,
+               "string not passed");
+
+    if (!run(fmu, 0, SNAPSHOT_STEP, hight)) return 0;
+    ASSERT_MSG(fmi2_import_get_fmu_state(fmu, &state) == fmi2_status_ok, "get state failed");
+    ASSERT_MSG(fmi2_import_serialized_fmu_state_size(fmu, state, &size) == fmi2_status_ok && size > 0, "no state size");
+    snapshot = (fmi2_byte_t *)malloc(size);
+    ASSERT_MSG(fmi2_import_serialize_fmu_state(fmu, state, snapshot, size) == fmi2_status_ok, "serialization failed");
+    freed = state;
+    ASSERT_MSG(fmi2_import_free_fmu_state(fmu, &state) == fmi2_status_ok && state == NULL, "free state failed");
+    ASSERT_MSG(fmi2_import_set_fmu_state(fmu, freed) == fmi2_status_error, "freed state accepted");
+    ASSERT_MSG(fmi2_import_get_fmu_state(fmu, &stale) == fmi2_status_ok, "get state failed");
+    if (!run(fmu, SNAPSHOT_STEP, STEPS_NUM, hight)) return 0;
+    for (k = 0; k < STEPS_NUM; k++) {
+        ASSERT_MSG(hight[k] == expected[k], "results differ from the in-process run");
+    }
+
+    /* crash the host */
+    ASSERT_MSG(!fmi2_import_is_host_crashed(fmu), "host reported crashed");
+    kill((pid_t)pid, SIGKILL);
+    ASSERT_MSG(fmi2_import_do_step(fmu, STEPS_NUM * STEP_SIZE, STEP_SIZE, fmi2_true) == fmi2_status_fatal,
+               "call to a crashed host did not fail");
+    ASSERT_MSG(fmi2_import_is_host_crashed(fmu), "crash not detected");
+    ASSERT_MSG(fmi2_import_get_host_pid(fmu) == 0, "crashed host still has a pid");
+
+    /* continue from the snapshot */
+    ASSERT_MSG(fmi2_import_restart_host(fmu, snapshot, size) == jm_status_success, "restart failed");
+    free(snapshot);
+    ASSERT_MSG(!fmi2_import_is_host_crashed(fmu), "restarted host reported crashed");
+    restartedPid = fmi2_import_get_host_pid(fmu);
+    ASSERT_MSG(restartedPid != 0 && restartedPid != pid, "host not restarted");
+    /* the states of the crashed host are gone */
+    ASSERT_MSG(fmi2_import_set_fmu_state(fmu, stale) == fmi2_status_error, "state of the crashed host accepted");
+    ASSERT_MSG(fmi2_import_serialized_fmu_state_size(fmu, stale, &size) == fmi2_status_error, "state of the crashed host accepted");
+    ASSERT_MSG(fmi2_import_get_fmu_state(fmu, &state) == fmi2_status_ok && state != stale, "get state failed after the restart");
+    ASSERT_MSG(fmi2_import_set_fmu_state(fmu, state) == fmi2_status_ok, "set state failed after the restart");
+    ASSERT_MSG(fmi2_import_free_fmu_state(fmu, &state) == fmi2_status_ok, "free state failed after the restart");
+    memset(hight, 0, sizeof(hight));
+    if (!run(fmu, SNAPSHOT_STEP, STEPS_NUM, hight)) return 0;
+    for (k = SNAPSHOT_STEP; k < STEPS_NUM; k++) {
+        ASSERT_MSG(hight[k] == expected[k], "results after the restart differ from the in-process run");
+    }
+
+    fmi2_test_stop(fmu);
+    fmi2_import_destroy_dllfmu(fmu);
+    /* a host that exited but was not reaped would still accept the signal */
+    ASSERT_MSG(kill((pid_t)restartedPid, 0) != 0, "host process left running or not reaped");
+    fmi2_import_free(fmu);
+    return TEST_OK;
+}
+
+/* Instances get hosts of their own */
+static int test_instances(fmi_import_context_t *context, const char *tmpPath)
+{
+    fmi2_import_t *fmu = load(context, tmpPath, FMI2_CAPI_HOST_PATH);
+    fmi2_import_instance_t *inst;
+    fmi2_value_reference_t vr = 2;
+    fmi2_real_t value = 0, gravity = -1.0;
+
+    ASSERT_MSG(fmu != NULL, "could not load the FMU out of process");
+    inst = fmi2_import_instance_allocate(fmu, NULL);
+    ASSERT_MSG(inst != NULL, "could not allocate an instance");
+    ASSERT_MSG(fmi2_import_instance_instantiate(inst, "inst", fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+               "instance instantiation failed");
+    if (!fmi2_test_start(fmu, "remote")) return 0;
+    ASSERT_MSG(fmi2_import_instance_set_real(inst, &vr, 1, &gravity) == fmi2_status_ok, "instance set real failed");
+    ASSERT_MSG(fmi2_import_get_real(fmu, &vr, 1, &value) == fmi2_status_ok && value == -9.81,
+               "instances share a host");
+    fmi2_import_instance_free(inst);
+    fmi2_test_unload_started(fmu);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks callbacks = *jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    int ret = 1;
+
+    callbacks.logger = logger;
+    callbacks.log_level = jm_log_level_info;
+    context = fmi2_test_open(argc, argv, "fmi2_import_out_of_process_test", &callbacks);
+    if (!context) return CTEST_RETURN_FAIL;
+
+    ret &= test_out_of_process(context, argv[2]);
+    ret &= test_instances(context, argv[2]);
+
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define STEPS_NUM 1000
+#define STEP_SIZE 0.001
+#define CHUNK_ROWS 64
+
+static const char *names[] = {
+    "HIGHT", "HIGHT_SPEED", "HIGHT_SPEED alias", "GRAVITY", "BOUNCE_COF", "LOGGER_TEST_INTEGER", "LOGGER_TEST_BOOLEAN"
+};
+#define VARIABLES_NUM (sizeof(names) / sizeof(names[0]))
+
+static fmi2_real_t expectedHight[STEPS_NUM];
+static fmi2_real_t expectedSpeed[STEPS_NUM];
+
+static fmi2_import_result_recorder_t *allocate(fmi2_import_t *fmu, size_t chunkRows)
+{
+    fmi2_import_result_recorder_t *rec = fmi2_import_result_recorder_allocate(fmu, chunkRows);
+    size_t i;
+    if (!rec) return NULL;
+    for (i = 0; i < VARIABLES_NUM; i++) {
+        if (fmi2_import_result_recorder_add_variable(rec, fmi2_import_get_variable_by_name(fmu, names[i])) != jm_status_success) {
+            fmi2_import_result_recorder_free(rec);
+            return NULL;
+        }
+    }
+    return rec;
+}
+
+/* Simulate and record at each step */
+static int record(fmi2_import_t *fmu, fmi2_import_result_recorder_t *rec, const char *fileName, fmi2_import_result_format_enu_t format)
+{
+    fmi2_value_reference_t vr[] = {0, 1};
+    fmi2_real_t values[2];
+    int k;
+
+    if (!fmi2_test_start(fmu, "recorder")) return 0;
+    ASSERT_MSG(fmi2_import_result_recorder_start(rec, fileName, format) == jm_status_success, "could not start recording");
+    ASSERT_MSG(fmi2_import_result_recorder_get_columns_num(rec) == VARIABLES_NUM - 1, "aliases not collapsed");
+    for (k = 0; k < STEPS_NUM; k++) {
+        ASSERT_MSG(fmi2_import_do_step(fmu, k * STEP_SIZE, STEP_SIZE, fmi2_true) == fmi2_status_ok, "step failed");
+        ASSERT_MSG(fmi2_import_result_recorder_sample(rec, (k + 1) * STEP_SIZE) == fmi2_status_ok, "sampling failed");
+        fmi2_import_get_real(fmu, vr, 2, values);
+        expectedHight[k] = values[0];
+        expectedSpeed[k] = values[1];
+    }
+    ASSERT_MSG(fmi2_import_result_recorder_get_samples_num(rec) == STEPS_NUM, "wrong number of samples");
+    ASSERT_MSG(fmi2_import_result_recorder_stop(rec) == jm_status_success, "could not stop recording");
+    fmi2_test_stop(fmu);
+    return TEST_OK;
+}
+
+/* The binary file reads back the recorded values, with and without compression */
+static int test_binary(fmi2_import_t *fmu, jm_callbacks *cb, const char *fileName, int level)
+{
+    fmi2_import_result_recorder_t *rec = allocate(fmu, CHUNK_ROWS);
+    fmi2_import_result_file_t *res;
+    fmi2_real_t values[STEPS_NUM], alias[STEPS_NUM];
+    size_t index;
+    int k;
+
+    ASSERT_MSG(rec != NULL, "could not allocate a recorder");
+    ASSERT_MSG(fmi2_import_result_recorder_set_compression(rec, level) == jm_status_success, "could not set the compression");
+    if (!record(fmu, rec, fileName, fmi2_import_result_format_binary)) return 0;
+    fmi2_import_result_recorder_free(rec);
+
+    res = fmi2_import_result_file_open(cb, fileName);
+    ASSERT_MSG(res != NULL, "could not read the result file");
+    ASSERT_MSG(fmi2_import_result_file_get_variables_num(res) == VARIABLES_NUM, "wrong number of variables");
+    ASSERT_MSG(fmi2_import_result_file_get_samples_num(res) == STEPS_NUM, "wrong number of samples in the file");
+    ASSERT_MSG(fmi2_import_result_file_get_time(res)[STEPS_NUM - 1] == STEPS_NUM * STEP_SIZE, "wrong time");
+
+    ASSERT_MSG(fmi2_import_result_file_find_variable(res, "HIGHT", &index) == jm_status_success, "HIGHT not found");
+    fmi2_import_result_file_get_values(res, index, values);
+    for (k = 0; k < STEPS_NUM; k++) ASSERT_MSG(values[k] == expectedHight[k], "wrong HIGHT value");
+
+    ASSERT_MSG(fmi2_import_result_file_find_variable(res, "HIGHT_SPEED", &index) == jm_status_success, "HIGHT_SPEED not found");
+    fmi2_import_result_file_get_values(res, index, values);
+    ASSERT_MSG(fmi2_import_result_file_find_variable(res, "HIGHT_SPEED alias", &index) == jm_status_success, "alias not found");
+    fmi2_import_result_file_get_values(res, index, alias);
+    for (k = 0; k < STEPS_NUM; k++) {
+        ASSERT_MSG(values[k] == expectedSpeed[k] && alias[k] == values[k], "wrong HIGHT_SPEED value");
+    }
+
+    ASSERT_MSG(fmi2_import_result_file_find_variable(res, "GRAVITY", &index) == jm_status_success, "GRAVITY not found");
+    fmi2_import_result_file_get_values(res, index, values);
+    ASSERT_MSG(values[0] == -9.81 && values[STEPS_NUM - 1] == -9.81, "wrong GRAVITY value");
+    ASSERT_MSG(fmi2_import_result_file_find_variable(res, "no such variable", &index) == jm_status_error,
+               "unknown variable found");
+    fmi2_import_result_file_close(res);
+    return TEST_OK;
+}
+
+/* A block whose sizes do not match its samples is rejected. With keepRowSize the size
+   grows with the samples, so that only the inflated length of a compressed block is wrong. */
+static int test_corrupt(jm_callbacks *cb, const char *fileName, int keepRowSize)
+{
+    unsigned int block[2];
+    long pos = 8 + 5 * sizeof(unsigned int);
+    size_t i;
+    FILE *f = fopen(fileName, "r+b");
+
+    ASSERT_MSG(f != NULL, "no result file");
+    for (i = 0; i < VARIABLES_NUM; i++) pos += 2 * sizeof(unsigned int) + (long)strlen(names[i]);
+    ASSERT_MSG(fseek(f, pos, SEEK_SET) == 0 && fread(block, sizeof(unsigned int), 2, f) == 2 && block[0] > 0,
+               "no block in the result file");
+    if (keepRowSize) block[1] += block[1] / block[0];
+    block[0]++;
+    fseek(f, pos, SEEK_SET);
+    ASSERT_MSG(fwrite(block, sizeof(unsigned int), 2, f) == 2, "could not change the block");
+    fclose(f);
+    ASSERT_MSG(fmi2_import_result_file_open(cb, fileName) == NULL, "corrupted block accepted");
+    return TEST_OK;
+}
+
+static int read_mat4_header(FILE *f, int header[5], char *name)
+{
+    if (fread(header, sizeof(int), 5, f) != 5 || header[4] > 32) return 0;
+    return fread(name, 1, header[4], f) == (size_t)header[4];
+}
+
+/* Read the header of a text matrix and skip its characters */
+static int skip_mat4_text(FILE *f, const char *expected, int columns)
+{
+    int header[5];
+    char name[33];
+    if (!read_mat4_header(f, header, name) || strcmp(name, expected) != 0 || header[0] % 1000 != 51) return 0;
+    if (columns && header[2] != columns) return 0;
+    return fseek(f, (long)header[1] * header[2], SEEK_CUR) == 0;
+}
+
+/* The MAT-file has the matrices of a Dymola result file */
+static int test_mat4(fmi2_import_t *fmu, const char *fileName)
+{
+    fmi2_import_result_recorder_t *rec = allocate(fmu, CHUNK_ROWS);
+    int header[5], info[8];
+    char name[33];
+    double *data, times[2];
+    size_t rows;
+    FILE *f;
+
+    ASSERT_MSG(rec != NULL, "could not allocate a recorder");
+    if (!record(fmu, rec, fileName, fmi2_import_result_format_mat4)) return 0;
+    fmi2_import_result_recorder_free(rec);
+
+    f = fopen(fileName, "rb");
+    ASSERT_MSG(f != NULL, "no MAT-file");
+    ASSERT_MSG(skip_mat4_text(f, "Aclass", 0), "wrong Aclass matrix");
+    /* the time and the variables */
+    ASSERT_MSG(skip_mat4_text(f, "name", VARIABLES_NUM + 1), "wrong name matrix");
+    ASSERT_MSG(skip_mat4_text(f, "description", VARIABLES_NUM + 1), "wrong description matrix");
+    ASSERT_MSG(read_mat4_header(f, header, name) && strcmp(name, "dataInfo") == 0 && header[1] == 4 &&
+               header[2] == VARIABLES_NUM + 1, "wrong dataInfo matrix");
+    ASSERT_MSG(fread(info, sizeof(int), 8, f) == 8 && info[1] == 1 && info[4] == 2 && info[5] == 2, "wrong data row of HIGHT");
+    fseek(f, (long)(VARIABLES_NUM - 1) * 4 * sizeof(int), SEEK_CUR);
+    ASSERT_MSG(read_mat4_header(f, header, name) && strcmp(name, "data_1") == 0 && header[1] == 1 && header[2] == 2,
+               "wrong data_1 matrix");
+    ASSERT_MSG(fread(times, sizeof(double), 2, f) == 2 && times[0] == STEP_SIZE && times[1] == STEPS_NUM * STEP_SIZE,
+               "wrong times in the data_1 matrix");
+    /* the time and the columns, one less than the variables because of the alias */
+    ASSERT_MSG(read_mat4_header(f, header, name) && strcmp(name, "data_2") == 0 && header[0] % 1000 == 0 &&
+               header[1] == 1 + VARIABLES_NUM - 1 && header[2] == STEPS_NUM, "wrong data_2 matrix");
+    rows = header[1];
+    data = (double *)malloc(rows * STEPS_NUM * sizeof(double));
+    ASSERT_MSG(fread(data, sizeof(double), rows * STEPS_NUM, f) == rows * STEPS_NUM, "data matrix truncated");
+    fclose(f);
+    ASSERT_MSG(data[(STEPS_NUM - 1) * rows] == STEPS_NUM * STEP_SIZE, "wrong time in the data matrix");
+    ASSERT_MSG(data[(STEPS_NUM - 1) * rows + 1] == expectedHight[STEPS_NUM - 1], "wrong HIGHT in the data matrix");
+    free(data);
+    return TEST_OK;
+}
+
+/* String variables and registration after the start are rejected */
+static int test_errors(fmi2_import_t *fmu, const char *fileName)
+{
+    fmi2_import_result_recorder_t *rec = fmi2_import_result_recorder_allocate(fmu, 0);
+    fmi2_import_variable_t *hight = fmi2_import_get_variable_by_name(fmu, "HIGHT");
+
+    ASSERT_MSG(rec != NULL, "could not allocate a recorder");
+    ASSERT_MSG(fmi2_import_result_recorder_start(rec, fileName, fmi2_import_result_format_binary) == jm_status_error,
+               "recording without variables started");
+    ASSERT_MSG(fmi2_import_result_recorder_add_variable(rec, fmi2_import_get_variable_by_name(fmu, "LOGGER_TEST")) == jm_status_error,
+               "String variable accepted");
+    ASSERT_MSG(fmi2_import_result_recorder_set_compression(rec, 10) == jm_status_error, "compression level 10 accepted");
+    ASSERT_MSG(fmi2_import_result_recorder_add_variable(rec, hight) == jm_status_success, "could not add a variable");
+    ASSERT_MSG(fmi2_import_result_recorder_start(rec, fileName, fmi2_import_result_format_binary) == jm_status_success,
+               "could not start recording");
+    ASSERT_MSG(fmi2_import_result_recorder_add_variable(rec, hight) == jm_status_error, "variable added after the start");
+    fmi2_import_result_recorder_free(rec);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks callbacks = *jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    char fileName[FILENAME_MAX];
+    int ret = 1;
+
+    callbacks.log_level = jm_log_level_warning;
+    context = fmi2_test_open(argc, argv, "fmi2_import_result_recorder_test", &callbacks);
+    if (!context) return CTEST_RETURN_FAIL;
+    fmu = fmi2_test_load(context, argv[2], NULL);
+    if (!fmu) {
+        printf("Could not load the FMU\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    sprintf(fileName, "%s/result.bin", argv[2]);
+    ret &= test_binary(fmu, &callbacks, fileName, 0);
+    ret &= test_corrupt(&callbacks, fileName, 0);
+    ret &= test_binary(fmu, &callbacks, fileName, 6);
+    ret &= test_corrupt(&callbacks, fileName, 1);
+    ret &= test_errors(fmu, fileName);
+    sprintf(fileName, "%s/result.mat", argv[2]);
+    ret &= test_mat4(fmu, fileName);
+
+    fmi2_test_unload(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
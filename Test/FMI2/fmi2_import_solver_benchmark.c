@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+
+/* Wall time and evaluation counts of the model exchange solvers on the bouncing ball dummy FMU.
+   The fixed-step methods use the given step size, DOPRI5 starts from it and runs at the default tolerance.
+   Built with the tests but not run by ctest, since the timings depend on the machine.
+   Usage: fmi2_import_solver_benchmark <fmu_file> <temporary_dir> [step_size] [end_time] */
+
+#define GRAVITY -9.81
+#define BOUNCE_COF 0.5
+#define BENCHMARK_STEP_SIZE 1e-5
+#define BENCHMARK_END_TIME 2.0
+
+static const char *method_names[] = {"Euler", "Heun", "RK4", "DOPRI5"};
+
+/* Analytic states at time t */
+static void reference(fmi2_real_t t, fmi2_real_t *states)
+{
+    fmi2_real_t t0 = 0.0, x0 = 1.0, v0 = 4.0, tb, dt;
+
+    for (;;) {
+        tb = t0 + (v0 + sqrt(v0 * v0 - 2.0 * GRAVITY * x0)) / -GRAVITY;
+        if (tb > t) break;
+        v0 = -BOUNCE_COF * (v0 + GRAVITY * (tb - t0));
+        x0 = 0.0;
+        t0 = tb;
+    }
+    dt = t - t0;
+    states[0] = x0 + v0 * dt + 0.5 * GRAVITY * dt * dt;
+    states[1] = v0 + GRAVITY * dt;
+}
+
+static int run(fmi2_import_t *fmu, fmi_import_solver_method_enu_t method, fmi2_real_t stepSize, fmi2_real_t endTime)
+{
+    fmi_import_solver_stats_t stats;
+    fmi_import_solver_t *s;
+    fmi2_real_t ref[2];
+    clock_t c;
+    double seconds;
+
+    ASSERT_MSG(fmi2_import_instantiate(fmu, "benchmark", fmi2_model_exchange, NULL, fmi2_false) == jm_status_success,
+               "instantiation failed");
+    ASSERT_MSG(fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok
+               && fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok
+               && fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "initialization failed");
+    s = fmi2_import_solver_allocate(fmu, method);
+    ASSERT_MSG(s, "could not allocate solver");
+    ASSERT_MSG(fmi_import_solver_set_step_size(s, stepSize) == jm_status_success, "could not set step size");
+
+    c = clock();
+    ASSERT_MSG(fmi2_import_solver_initialize(s, 0.0) == fmi2_status_ok, "could not initialize solver");
+    ASSERT_MSG(fmi_import_solver_integrate(s, endTime) == fmi2_status_ok, "integration failed");
+    seconds = (double)(clock() - c) / CLOCKS_PER_SEC;
+
+    fmi_import_solver_get_stats(s, &stats);
+    reference(endTime, ref);
+    printf("%-6s %9u steps %5u rejected %9u derivatives %9u event indicators %4u events error %8.1e %8.3f s\n",
+           method_names[method], (unsigned)stats.stepsNum, (unsigned)stats.rejectedStepsNum,
+           (unsigned)stats.derivativesNum, (unsigned)stats.eventIndicatorsNum,
+           (unsigned)(stats.stateEventsNum + stats.timeEventsNum + stats.stepEventsNum),
+           fabs(fmi_import_solver_get_states(s)[0] - ref[0]), seconds);
+
+    fmi_import_solver_free(s);
+    fmi2_import_terminate(fmu);
+    fmi2_import_free_instance(fmu);
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks *cb = jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    fmi2_real_t stepSize = BENCHMARK_STEP_SIZE, endTime = BENCHMARK_END_TIME;
+    int ret = 1;
+    int m;
+
+    if (argc < 3) {
+        printf("Usage: %s <fmu_file> <temporary_dir> [step_size] [end_time]\n", argv[0]);
+        return CTEST_RETURN_FAIL;
+    }
+    if (argc > 3) stepSize = atof(argv[3]);
+    if (argc > 4) endTime = atof(argv[4]);
+    if (stepSize <= 0.0 || endTime <= 0.0) {
+        printf("The step size and end time must be positive\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    context = fmi_import_allocate_context(cb);
+    if (fmi_import_get_fmi_version(context, argv[1], argv[2]) != fmi_version_2_0_enu) {
+        printf("The code only supports version 2.0\n");
+        return CTEST_RETURN_FAIL;
+    }
+    fmu = fmi2_import_parse_xml(context, argv[2], NULL);
+    if (!fmu || fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_me, NULL) != jm_status_success) {
+        printf("Could not load the FMU\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    printf("Step size %g, end time %g\n", stepSize, endTime);
+    for (m = fmi_import_solver_euler; m <= fmi_import_solver_dopri5; m++) {
+        ret &= run(fmu, (fmi_import_solver_method_enu_t)m, stepSize, endTime);
+    }
+
+    fmi2_import_destroy_dllfmu(fmu);
+    fmi2_import_free(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+
+/* The dummy FMU is a bouncing ball: HIGHT' = HIGHT_SPEED, HIGHT_SPEED' = GRAVITY, starting at 1 m with 4 m/s */
+#define GRAVITY -9.81
+#define BOUNCE_COF 0.5
+#define COMPARISON_STEP_SIZE 1e-3
+
+static const char *method_names[] = {"Euler", "Heun", "RK4", "DOPRI5"};
+
+/* Analytic states at time t and the number of bounces before t */
+static void reference(fmi2_real_t t, fmi2_real_t *states, size_t *bounces)
+{
+    fmi2_real_t t0 = 0.0, x0 = 1.0, v0 = 4.0, tb, dt;
+
+    *bounces = 0;
+    for (;;) {
+        tb = t0 + (v0 + sqrt(v0 * v0 - 2.0 * GRAVITY * x0)) / -GRAVITY;
+        if (tb > t) break;
+        v0 = -BOUNCE_COF * (v0 + GRAVITY * (tb - t0));
+        x0 = 0.0;
+        t0 = tb;
+        (*bounces)++;
+    }
+    dt = t - t0;
+    states[0] = x0 + v0 * dt + 0.5 * GRAVITY * dt * dt;
+    states[1] = v0 + GRAVITY * dt;
+}
+
+static int start(fmi2_import_t *fmu)
+{
+    if (fmi2_import_instantiate(fmu, "solver", fmi2_model_exchange, NULL, fmi2_false) != jm_status_success) {
+        return 0;
+    }
+    if (fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) != fmi2_status_ok
+        || fmi2_import_enter_initialization_mode(fmu) != fmi2_status_ok
+        || fmi2_import_exit_initialization_mode(fmu) != fmi2_status_ok) {
+        fmi2_import_free_instance(fmu);
+        return 0;
+    }
+    return 1;
+}
+
+static void stop(fmi2_import_t *fmu)
+{
+    fmi2_import_terminate(fmu);
+    fmi2_import_free_instance(fmu);
+}
+
+/* Simulate to endTime and return the states */
+static int simulate(fmi2_import_t *fmu, fmi_import_solver_method_enu_t method, fmi2_real_t stepSize,
+                    fmi2_real_t endTime, fmi2_real_t *states, fmi_import_solver_stats_t *stats)
+{
+    fmi_import_solver_t *s;
+
+    ASSERT_MSG(start(fmu), "could not start the FMU");
+    s = fmi2_import_solver_allocate(fmu, method);
+    ASSERT_MSG(s, "could not allocate solver");
+    ASSERT_MSG(fmi_import_solver_set_step_size(s, 0.0) == jm_status_error, "zero step size accepted");
+    ASSERT_MSG(fmi_import_solver_integrate(s, endTime) == fmi2_status_error, "integration must require initialization");
+    ASSERT_MSG(fmi_import_solver_set_step_size(s, stepSize) == jm_status_success, "could not set step size");
+    ASSERT_MSG(fmi2_import_solver_initialize(s, 0.0) == fmi2_status_ok, "could not initialize solver");
+    ASSERT_MSG(fmi_import_solver_integrate(s, endTime) == fmi2_status_ok, "integration failed");
+    ASSERT_MSG(fmi_import_solver_get_time(s) == endTime, "end time not reached");
+    ASSERT_MSG(!fmi_import_solver_is_terminated(s), "unexpected termination");
+    memcpy(states, fmi_import_solver_get_states(s), 2 * sizeof(fmi2_real_t));
+    fmi_import_solver_get_stats(s, stats);
+    fmi_import_solver_free(s);
+    stop(fmu);
+    return TEST_OK;
+}
+
+static int test_accuracy(fmi2_import_t *fmu)
+{
+    fmi_import_solver_stats_t stats;
+    fmi2_real_t states[2];
+    fmi2_real_t t = 1.0, hight = 1.0 + 4.0 * t + 0.5 * GRAVITY * t * t, speed = 4.0 + GRAVITY * t;
+    int m;
+
+    /* before the first bounce; Heun and RK4 are exact for constant acceleration */
+    for (m = fmi_import_solver_euler; m <= fmi_import_solver_rk4; m++) {
+        fmi2_real_t tol = (m == fmi_import_solver_euler) ? 0.1 : 1e-9;
+        ASSERT_MSG(simulate(fmu, (fmi_import_solver_method_enu_t)m, 0.01, t, states, &stats), "simulation failed");
+        ASSERT_MSG(fabs(states[0] - hight) < tol && fabs(states[1] - speed) < tol, "wrong states before the bounce");
+        ASSERT_MSG(stats.stepsNum == 100 && stats.stateEventsNum == 0, "wrong number of steps");
+        ASSERT_MSG(stats.derivativesNum == 100 * (m == fmi_import_solver_rk4 ? 4 : m + 1), "wrong number of derivative evaluations");
+    }
+
+    /* across bounces */
+    for (m = fmi_import_solver_euler; m <= fmi_import_solver_rk4; m++) {
+        ASSERT_MSG(simulate(fmu, (fmi_import_solver_method_enu_t)m, 0.01, 2.0, states, &stats), "simulation failed");
+        ASSERT_MSG(stats.stateEventsNum >= 1, "bounce not detected");
+        ASSERT_MSG(states[0] >= -0.1 && states[0] < 1.9, "ball below the floor or above the start height");
+    }
+    return TEST_OK;
+}
+
+static int test_dopri5(fmi2_import_t *fmu)
+{
+    fmi_import_solver_stats_t stats;
+    fmi_import_solver_t *s;
+    fmi2_real_t states[2], ref[2], t;
+    size_t bounces;
+
+    /* the method is exact for constant acceleration, so the step size grows quickly */
+    ASSERT_MSG(simulate(fmu, fmi_import_solver_dopri5, 0.01, 1.0, states, &stats), "simulation failed");
+    reference(1.0, ref, &bounces);
+    ASSERT_MSG(fabs(states[0] - ref[0]) < 1e-9 && fabs(states[1] - ref[1]) < 1e-9, "wrong states before the bounce");
+    ASSERT_MSG(stats.stepsNum < 10 && stats.rejectedStepsNum == 0, "step size not increased");
+    ASSERT_MSG(stats.derivativesNum == 1 + 6 * stats.stepsNum, "derivatives of the last stage not reused");
+
+    /* the bounces are located accurately */
+    ASSERT_MSG(simulate(fmu, fmi_import_solver_dopri5, 0.01, 2.0, states, &stats), "simulation failed");
+    reference(2.0, ref, &bounces);
+    ASSERT_MSG(stats.stateEventsNum == bounces, "wrong number of bounces");
+    ASSERT_MSG(fabs(states[0] - ref[0]) < 1e-9 && fabs(states[1] - ref[1]) < 1e-9, "wrong states after the bounces");
+
+    /* integrating to output points gives the same result */
+    ASSERT_MSG(start(fmu), "could not start the FMU");
+    s = fmi2_import_solver_allocate(fmu, fmi_import_solver_dopri5);
+    ASSERT_MSG(s, "could not allocate solver");
+    ASSERT_MSG(fmi_import_solver_set_tolerance(s, -1.0) == jm_status_error, "negative tolerance accepted");
+    ASSERT_MSG(fmi_import_solver_set_tolerance(s, 1e-8) == jm_status_success, "could not set tolerance");
+    ASSERT_MSG(fmi_import_solver_set_event_hysteresis(s, -1.0) == jm_status_error, "negative hysteresis accepted");
+    ASSERT_MSG(fmi_import_solver_set_event_hysteresis(s, 1e-12) == jm_status_success, "could not set hysteresis");
+    ASSERT_MSG(fmi2_import_solver_initialize(s, 0.0) == fmi2_status_ok, "could not initialize solver");
+    for (t = 0.1; t < 2.05; t += 0.1) {
+        ASSERT_MSG(fmi_import_solver_integrate(s, t) == fmi2_status_ok, "integration failed");
+        ASSERT_MSG(fmi_import_solver_get_time(s) == t, "output point not reached");
+        reference(t, ref, &bounces);
+        ASSERT_MSG(fabs(fmi_import_solver_get_states(s)[0] - ref[0]) < 1e-9, "wrong state at output point");
+    }
+    fmi_import_solver_free(s);
+    stop(fmu);
+    return TEST_OK;
+}
+
+/* With hysteresis, the fixed steps land inside the band below the floor before passing it.
+   The indicator keeps its reference sign from above the floor, so each bounce is still detected,
+   only later than without hysteresis. */
+static int test_hysteresis(fmi2_import_t *fmu)
+{
+    fmi_import_solver_stats_t stats;
+    fmi_import_solver_t *s;
+    fmi2_real_t ref[2], lowest, t;
+    size_t bounces;
+    int m;
+
+    reference(2.0, ref, &bounces);
+    for (m = fmi_import_solver_euler; m <= fmi_import_solver_rk4; m++) {
+        lowest = 0.0;
+        ASSERT_MSG(start(fmu), "could not start the FMU");
+        s = fmi2_import_solver_allocate(fmu, (fmi_import_solver_method_enu_t)m);
+        ASSERT_MSG(s, "could not allocate solver");
+        ASSERT_MSG(fmi_import_solver_set_step_size(s, 0.005) == jm_status_success, "could not set step size");
+        ASSERT_MSG(fmi_import_solver_set_event_hysteresis(s, 0.05) == jm_status_success, "could not set hysteresis");
+        ASSERT_MSG(fmi2_import_solver_initialize(s, 0.0) == fmi2_status_ok, "could not initialize solver");
+        for (t = 0.005; t < 2.0025; t += 0.005) {
+            ASSERT_MSG(fmi_import_solver_integrate(s, t) == fmi2_status_ok, "integration failed");
+            if (fmi_import_solver_get_states(s)[0] < lowest) lowest = fmi_import_solver_get_states(s)[0];
+        }
+        fmi_import_solver_get_stats(s, &stats);
+        /* the states are reset to the floor at the event, so only the steps inside the band are seen below it */
+        ASSERT_MSG(lowest < 0.0, "no step ended inside the band");
+        ASSERT_MSG(lowest > -0.05, "a bounce passing through the hysteresis band was lost");
+        ASSERT_MSG(stats.stateEventsNum + 1 >= bounces, "bounces missing");
+        fmi_import_solver_free(s);
+        stop(fmu);
+    }
+    return TEST_OK;
+}
+
+/* DOPRI5 at its default tolerance against the fixed-step methods on the interval with bounces.
+   The evaluation counts are deterministic and checked, the wall time is only reported. */
+static int test_evaluation_counts(fmi2_import_t *fmu)
+{
+    fmi_import_solver_stats_t stats, adaptive;
+    fmi2_real_t states[2], ref[2], adaptiveError;
+    size_t bounces;
+    clock_t c;
+    int m;
+
+    reference(2.0, ref, &bounces);
+    c = clock();
+    ASSERT_MSG(simulate(fmu, fmi_import_solver_dopri5, COMPARISON_STEP_SIZE, 2.0, states, &adaptive), "simulation failed");
+    adaptiveError = fabs(states[0] - ref[0]);
+    printf("%-6s %6u derivatives %6u event indicators error %8.1e %8.3f s\n", method_names[fmi_import_solver_dopri5],
+           (unsigned)adaptive.derivativesNum, (unsigned)adaptive.eventIndicatorsNum, adaptiveError,
+           (double)(clock() - c) / CLOCKS_PER_SEC);
+
+    for (m = fmi_import_solver_euler; m <= fmi_import_solver_rk4; m++) {
+        fmi2_real_t error;
+
+        c = clock();
+        ASSERT_MSG(simulate(fmu, (fmi_import_solver_method_enu_t)m, COMPARISON_STEP_SIZE, 2.0, states, &stats), "simulation failed");
+        error = fabs(states[0] - ref[0]);
+        printf("%-6s %6u derivatives %6u event indicators error %8.1e %8.3f s\n", method_names[m],
+               (unsigned)stats.derivativesNum, (unsigned)stats.eventIndicatorsNum, error,
+               (double)(clock() - c) / CLOCKS_PER_SEC);
+        ASSERT_MSG(stats.stateEventsNum == bounces, "wrong number of bounces");
+        ASSERT_MSG(adaptiveError < error, "the adaptive method is less accurate");
+        ASSERT_MSG(10 * adaptive.derivativesNum < stats.derivativesNum, "the adaptive method needs too many derivative evaluations");
+        ASSERT_MSG(10 * adaptive.eventIndicatorsNum < stats.eventIndicatorsNum, "the adaptive method needs too many event indicator evaluations");
+    }
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks *cb = jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    int ret = 1;
+
+    if (argc < 3) {
+        printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+        return CTEST_RETURN_FAIL;
+    }
+
+    printf("Running fmi2_import_solver_test\n");
+
+    context = fmi_import_allocate_context(cb);
+    if (fmi_import_get_fmi_version(context, argv[1], argv[2]) != fmi_version_2_0_enu) {
+        printf("The code only supports version 2.0\n");
+        return CTEST_RETURN_FAIL;
+    }
+    fmu = fmi2_import_parse_xml(context, argv[2], NULL);
+    if (!fmu || fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_me, NULL) != jm_status_success) {
+        printf("Could not load the FMU\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_accuracy(fmu);
+    ret &= test_dopri5(fmu);
+    ret &= test_hysteresis(fmu);
+    ret &= test_evaluation_counts(fmu);
+
+    fmi2_import_destroy_dllfmu(fmu);
+    fmi2_import_free(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
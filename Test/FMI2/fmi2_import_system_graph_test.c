@@ -0,0 +1,144 @@
+#include <stdio.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+
+/* original order indices of the ports in the jacobian test model */
+#define VAR_U1 10
+#define VAR_U2 11
+#define VAR_Y1 12
+#define VAR_Y2 13
+
+static fmi2_import_t *parse_xml(const char *model_desc_path)
+{
+    jm_callbacks *cb = jm_get_default_callbacks();
+    fmi_import_context_t *ctx = fmi_import_allocate_context(cb);
+    fmi2_import_t *xml;
+
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    xml = fmi2_import_parse_xml(ctx, model_desc_path, NULL);
+
+    fmi_import_free_context(ctx);
+    return xml;
+}
+
+static size_t find_block(fmi_import_system_graph_t *g, size_t fmu, size_t var)
+{
+    const size_t *blockStart, *ports;
+    size_t nBlocks = fmi_import_system_graph_get_blocks_num(g);
+    size_t b, k, f, v;
+    int isOutput;
+
+    fmi_import_system_graph_get_blocks(g, &blockStart, &ports);
+    for (b = 0; b < nBlocks; b++) {
+        for (k = blockStart[b]; k < blockStart[b + 1]; k++) {
+            fmi_import_system_graph_get_port(g, ports[k], &f, &v, &isOutput);
+            if (f == fmu && v == var) {
+                return b;
+            }
+        }
+    }
+    return (size_t)-1;
+}
+
+/* y1 feeds through from u1 and y2 from u2. Connecting two instances
+ * crosswise on u1/y1 gives a loop, the u2/y2 path is a plain chain. */
+static int test_two_fmus(fmi2_import_t *xml)
+{
+    fmi_import_system_graph_t *g = fmi_import_allocate_system_graph(NULL);
+    const size_t *blockStart, *ports;
+    size_t a, b, loop;
+
+    ASSERT_MSG(g != NULL, "failed to allocate system graph");
+    ASSERT_MSG(fmi2_import_add_to_system_graph(g, xml, &a) == jm_status_success, "failed to add FMU a");
+    ASSERT_MSG(fmi2_import_add_to_system_graph(g, xml, &b) == jm_status_success, "failed to add FMU b");
+    ASSERT_MSG(fmi_import_system_graph_get_ports_num(g) == 8, "incorrect number of ports");
+
+    ASSERT_MSG(fmi_import_system_graph_connect(g, a, "y1", b, "u1") == jm_status_success, "connect a.y1 -> b.u1 failed");
+    ASSERT_MSG(fmi_import_system_graph_connect(g, b, "y1", a, "u1") == jm_status_success, "connect b.y1 -> a.u1 failed");
+    ASSERT_MSG(fmi_import_system_graph_connect(g, a, "y2", b, "u2") == jm_status_success, "connect a.y2 -> b.u2 failed");
+    ASSERT_MSG(fmi_import_system_graph_connect(g, b, "y2", b, "u2") == jm_status_error, "an input may only be connected once");
+    ASSERT_MSG(fmi_import_system_graph_connect(g, a, "u2", b, "u1") == jm_status_error, "connection source must be an output");
+    ASSERT_MSG(fmi_import_system_graph_connect(g, a, "y2", b, "x1") == jm_status_error, "connection target must be an input");
+
+    ASSERT_MSG(fmi_import_system_graph_get_blocks_num(g) == 0, "graph should not be analyzed yet");
+    ASSERT_MSG(fmi_import_system_graph_analyze(g) == jm_status_success, "analysis failed");
+    ASSERT_MSG(fmi_import_system_graph_get_blocks_num(g) == 5, "incorrect number of blocks");
+    ASSERT_MSG(fmi_import_system_graph_get_loops_num(g) == 1, "incorrect number of loops");
+
+    loop = fmi_import_system_graph_get_loops(g)[0];
+    fmi_import_system_graph_get_blocks(g, &blockStart, &ports);
+    ASSERT_MSG(blockStart[loop + 1] - blockStart[loop] == 4, "loop should contain four ports");
+    ASSERT_MSG(find_block(g, a, VAR_U1) == loop && find_block(g, a, VAR_Y1) == loop &&
+               find_block(g, b, VAR_U1) == loop && find_block(g, b, VAR_Y1) == loop, "incorrect loop members");
+
+    ASSERT_MSG(find_block(g, a, VAR_U2) < find_block(g, a, VAR_Y2), "a.u2 must be evaluated before a.y2");
+    ASSERT_MSG(find_block(g, a, VAR_Y2) < find_block(g, b, VAR_U2), "a.y2 must be evaluated before b.u2");
+    ASSERT_MSG(find_block(g, b, VAR_U2) < find_block(g, b, VAR_Y2), "b.u2 must be evaluated before b.y2");
+
+    fmi_import_free_system_graph(g);
+    return TEST_OK;
+}
+
+/* a long ring of FMUs must not exhaust the stack and gives one large loop */
+static int test_large_ring(fmi2_import_t *xml)
+{
+#define N_RING 100000
+    fmi_import_system_graph_t *g = fmi_import_allocate_system_graph(NULL);
+    const size_t *blockStart, *ports;
+    size_t i, idx, loop;
+
+    ASSERT_MSG(g != NULL, "failed to allocate system graph");
+    for (i = 0; i < N_RING; i++) {
+        ASSERT_MSG(fmi2_import_add_to_system_graph(g, xml, &idx) == jm_status_success && idx == i, "failed to add FMU");
+    }
+    for (i = 0; i < N_RING; i++) {
+        ASSERT_MSG(fmi_import_system_graph_connect_by_index(g, i, VAR_Y1, (i + 1) % N_RING, VAR_U1) == jm_status_success,
+                   "ring connection failed");
+        if (i + 1 < N_RING) {
+            ASSERT_MSG(fmi_import_system_graph_connect_by_index(g, i, VAR_Y2, i + 1, VAR_U2) == jm_status_success,
+                       "chain connection failed");
+        }
+    }
+
+    ASSERT_MSG(fmi_import_system_graph_analyze(g) == jm_status_success, "analysis failed");
+    ASSERT_MSG(fmi_import_system_graph_get_loops_num(g) == 1, "incorrect number of loops");
+    ASSERT_MSG(fmi_import_system_graph_get_blocks_num(g) == 2 * N_RING + 1, "incorrect number of blocks");
+
+    loop = fmi_import_system_graph_get_loops(g)[0];
+    fmi_import_system_graph_get_blocks(g, &blockStart, &ports);
+    ASSERT_MSG(blockStart[loop + 1] - blockStart[loop] == 2 * N_RING, "incorrect loop size");
+
+    fmi_import_free_system_graph(g);
+    return TEST_OK;
+#undef N_RING
+}
+
+int main(int argc, char **argv)
+{
+    fmi2_import_t *xml;
+    int ret = 1;
+
+    if (argc != 2) {
+        printf("Usage: %s <path to folder jacobian>\n", argv[0]);
+        return CTEST_RETURN_FAIL;
+    }
+
+    printf("Running fmi2_import_system_graph_test\n");
+
+    xml = parse_xml(argv[1]);
+    if (xml == NULL) {
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_two_fmus(xml);
+    ret &= test_large_ring(xml);
+
+    fmi2_import_free(xml);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
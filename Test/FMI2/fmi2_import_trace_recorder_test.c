@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <fmilib.h>
+#include <JM/jm_portability.h>
+#include "config_test.h"
+#include "fmil_test.h"
+#include "fmi2_test_fixture.h"
+
+#define STEPS_NUM 100
+#define STEP_SIZE 0.01
+
+/* Read a whole file; the result must be freed */
+static char *read_file(const char *fileName, size_t *size)
+{
+    FILE *f = fopen(fileName, "rb");
+    char *data;
+    long n;
+
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = (char *)malloc((size_t)n + 1);
+    *size = fread(data, 1, (size_t)n, f);
+    data[*size] = 0;
+    fclose(f);
+    return data;
+}
+
+static size_t count_occurrences(const char *text, const char *pattern)
+{
+    size_t n = 0;
+    const char *p = text;
+    while ((p = strstr(p, pattern)) != NULL) {
+        n++;
+        p += strlen(pattern);
+    }
+    return n;
+}
+
+/* Contains the bytes of a string, also in binary data */
+static int contains_bytes(const char *data, size_t size, const char *pattern)
+{
+    size_t i, n = strlen(pattern);
+    for (i = 0; i + n <= size; i++) {
+        if (memcmp(data + i, pattern, n) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Times are written as microseconds with a decimal point and three decimals, whatever the locale */
+static int check_times(const char *json, const char *key)
+{
+    const char *p = json;
+    size_t n = 0;
+    while ((p = strstr(p, key)) != NULL) {
+        p += strlen(key);
+        if (!isdigit((unsigned char)*p)) return 0;
+        while (isdigit((unsigned char)*p)) p++;
+        if (p[0] != '.' || !isdigit((unsigned char)p[1]) || !isdigit((unsigned char)p[2]) || !isdigit((unsigned char)p[3])
+            || (p[4] != ',' && p[4] != '}')) {
+            return 0;
+        }
+        n++;
+    }
+    return n > 0;
+}
+
+static void simulate(fmi2_import_t *fmu)
+{
+    fmi2_value_reference_t hight = 0;
+    fmi2_real_t time = 0, value;
+    int k;
+
+    fmi2_import_set_call_tracing(fmu, 1);
+    fmi2_import_instantiate(fmu, "traced", fmi2_cosimulation, NULL, fmi2_false);
+    fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0);
+    fmi2_import_enter_initialization_mode(fmu);
+    fmi2_import_exit_initialization_mode(fmu);
+    for (k = 0; k < STEPS_NUM; k++) {
+        fmi2_import_do_step(fmu, time, STEP_SIZE, fmi2_true);
+        time += STEP_SIZE;
+        fmi2_import_get_real(fmu, &hight, 1, &value);
+    }
+    fmi2_import_terminate(fmu);
+    fmi2_import_free_instance(fmu);
+    fmi2_import_set_call_tracing(fmu, 0);
+}
+
+static int test_chrome_json(jm_callbacks *cb, fmi2_import_t *fmu, const char *tmpPath)
+{
+    char fileName[1024];
+    char *json;
+    size_t size;
+
+    sprintf(fileName, "%s/trace.json", tmpPath);
+    ASSERT_MSG(fmi_trace_recorder_start(cb, fileName, fmi_trace_format_chrome_json, 0) == jm_status_success,
+               "could not start recording");
+    ASSERT_MSG(fmi_trace_recorder_is_active(), "recorder not active");
+    ASSERT_MSG(fmi_trace_recorder_start(cb, fileName, fmi_trace_format_chrome_json, 0) == jm_status_error,
+               "a second recorder was started");
+    fmi_trace_recorder_set_thread_name("main \"thread\"");
+    simulate(fmu);
+    fmi_trace_recorder_instant("done", NULL, jm_portability_get_time());
+    ASSERT_MSG(fmi_trace_recorder_get_dropped_num() == 0, "events dropped");
+    ASSERT_MSG(fmi_trace_recorder_stop() == jm_status_success, "could not stop recording");
+    ASSERT_MSG(!fmi_trace_recorder_is_active(), "recorder still active");
+
+    json = read_file(fileName, &size);
+    ASSERT_MSG(json != NULL, "trace file not written");
+    ASSERT_MSG(strncmp(json, "{", 1) == 0 && strstr(json, "]}") != NULL, "trace file not closed");
+    ASSERT_MSG(count_occurrences(json, "\"name\":\"fmi2DoStep\"") == STEPS_NUM, "wrong number of steps");
+    ASSERT_MSG(count_occurrences(json, "\"name\":\"fmi2GetReal\"") == STEPS_NUM, "wrong number of get real calls");
+    ASSERT_MSG(count_occurrences(json, "\"name\":\"fmi2Instantiate\",\"cat\":\"traced\"") == 1, "instantiate not recorded");
+    ASSERT_MSG(strstr(json, "\"ph\":\"i\"") != NULL, "instant event not recorded");
+    ASSERT_MSG(strstr(json, "\"name\":\"main \\\"thread\\\"\"") != NULL, "thread name not escaped");
+    ASSERT_MSG(check_times(json, "\"ts\":") && check_times(json, "\"dur\":"), "malformed time stamps");
+    free(json);
+    return TEST_OK;
+}
+
+static int test_perfetto(jm_callbacks *cb, fmi2_import_t *fmu, const char *tmpPath)
+{
+    char fileName[1024];
+    char *data;
+    size_t size;
+
+    sprintf(fileName, "%s/trace.pftrace", tmpPath);
+    ASSERT_MSG(fmi_trace_recorder_start(cb, fileName, fmi_trace_format_perfetto, 0) == jm_status_success,
+               "could not start recording");
+    simulate(fmu);
+    ASSERT_MSG(fmi_trace_recorder_stop() == jm_status_success, "could not stop recording");
+
+    data = read_file(fileName, &size);
+    ASSERT_MSG(data != NULL && size > 0, "trace file not written");
+    ASSERT_MSG((unsigned char)data[0] == 0x0A, "first packet is not a Trace.packet field");
+    ASSERT_MSG(contains_bytes(data, size, "fmi2DoStep") && contains_bytes(data, size, "traced"), "missing event names");
+    free(data);
+    return TEST_OK;
+}
+
+/* A full buffer drops events instead of blocking */
+static int test_dropped(jm_callbacks *cb, const char *tmpPath)
+{
+    char fileName[1024];
+    int k;
+
+    sprintf(fileName, "%s/dropped.json", tmpPath);
+    fmi_trace_recorder_slice("ignored", NULL, 0, 0);
+    ASSERT_MSG(fmi_trace_recorder_start(cb, fileName, fmi_trace_format_chrome_json, 4) == jm_status_success,
+               "could not start recording");
+    for (k = 0; k < 1000; k++) {
+        fmi_trace_recorder_instant("burst", "test", jm_portability_get_time());
+    }
+    ASSERT_MSG(fmi_trace_recorder_get_dropped_num() > 0, "no events dropped");
+    fmi_trace_recorder_stop();
+    ASSERT_MSG(fmi_trace_recorder_stop() == jm_status_success, "stopping twice failed");
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    jm_callbacks callbacks = *jm_get_default_callbacks();
+    fmi_import_context_t *context;
+    fmi2_import_t *fmu;
+    int ret = 1;
+
+    callbacks.log_level = jm_log_level_warning;
+    context = fmi2_test_open(argc, argv, "fmi2_import_trace_recorder_test", &callbacks);
+    if (!context) return CTEST_RETURN_FAIL;
+    fmu = fmi2_test_load(context, argv[2], NULL);
+    if (!fmu) {
+        printf("Could not load the FMU\n");
+        return CTEST_RETURN_FAIL;
+    }
+
+    ret &= test_chrome_json(&callbacks, fmu, argv[2]);
+    ret &= test_perfetto(&callbacks, fmu, argv[2]);
+    ret &= test_dropped(&callbacks, argv[2]);
+
+    fmi2_test_unload(fmu);
+    fmi_import_free_context(context);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <fmilib.h>
+#include "config_test.h"
+#include "fmil_test.h"
+
+/* Odd size so that the vector kernels also scan a tail */
+#define INDICATORS_NUM 10007
+
+/* Indicators that mostly keep their sign, with some crossings and some values inside the hysteresis band */
+static void fill(double *zPrev, double *z, size_t n)
+{
+    size_t i;
+    srand(17);
+    for (i = 0; i < n; i++) {
+        zPrev[i] = (double)(rand() % 2001 - 1000) / 1000.0;
+        switch (rand() % 50) {
+        case 0: z[i] = -zPrev[i]; break;
+        case 1: z[i] = (zPrev[i] > 0) ? -1e-6 : 1e-6; break;
+        case 2: z[i] = 0.0; break;
+        default: z[i] = zPrev[i] + (double)(rand() % 201 - 100) / 1e5; break;
+        }
+    }
+    zPrev[0] = 0.0;
+    z[0] = 0.5;
+}
+
+/* Straightforward reference */
+static size_t reference(const double *zPrev, const double *z, size_t n, double epsilon, size_t *indices, double *fraction)
+{
+    size_t i, count = 0;
+    *fraction = 1.0;
+    for (i = 0; i < n; i++) {
+        int crossed = zPrev[i] > 0 ? z[i] <= -epsilon : z[i] > epsilon;
+        if (crossed) {
+            double f = zPrev[i] / (zPrev[i] - z[i]);
+            if (f < *fraction) *fraction = f;
+            indices[count++] = i;
+        }
+    }
+    return count;
+}
+
+static int test_kernels(const double *zPrev, const double *z, size_t *indices, size_t *expected)
+{
+    const double epsilons[] = {0.0, 1e-3};
+    double fraction, expectedFraction;
+    size_t e, n, count, expectedCount, i;
+    int k, available = 0;
+
+    /* a crossing from a negative value to zero is not a crossing */
+    {
+        double a[] = {-1.0, 1.0, 0.0, 2.0}, b[] = {0.0, 0.0, 1.0, 1.0};
+        count = fmi_import_find_zero_crossings(a, b, 4, 0.0, indices, &fraction);
+        ASSERT_MSG(count == 2 && indices[0] == 1 && indices[1] == 2 && fraction == 0.0, "wrong crossings in the small case");
+        ASSERT_MSG(fmi_import_find_zero_crossings(a, b, 0, 0.0, NULL, &fraction) == 0 && fraction == 1.0, "no indicators must give no crossings");
+    }
+
+    for (k = fmi_import_zero_crossing_scalar; k <= fmi_import_zero_crossing_avx2; k++) {
+        if (fmi_import_set_zero_crossing_kernel((fmi_import_zero_crossing_kernel_enu_t)k) != jm_status_success) {
+            printf("Kernel %s is not available\n", fmi_import_zero_crossing_kernel_to_string((fmi_import_zero_crossing_kernel_enu_t)k));
+            continue;
+        }
+        ASSERT_MSG(fmi_import_get_zero_crossing_kernel() == k, "kernel not selected");
+        available++;
+        for (e = 0; e < sizeof(epsilons) / sizeof(epsilons[0]); e++) {
+            /* sizes around the vector width check the tails */
+            for (n = 0; n <= INDICATORS_NUM; n = (n < 9) ? n + 1 : n + INDICATORS_NUM / 3) {
+                expectedCount = reference(zPrev, z, n, epsilons[e], expected, &expectedFraction);
+                count = fmi_import_find_zero_crossings(zPrev, z, n, epsilons[e], indices, &fraction);
+                ASSERT_MSG(count == expectedCount, "wrong number of crossings");
+                ASSERT_MSG(fraction == expectedFraction, "wrong earliest crossing");
+                for (i = 0; i < count; i++) {
+                    ASSERT_MSG(indices[i] == expected[i], "wrong crossing index");
+                }
+                ASSERT_MSG(fmi_import_find_zero_crossings(zPrev, z, n, epsilons[e], NULL, NULL) == expectedCount,
+                           "wrong number of crossings without outputs");
+            }
+        }
+    }
+    ASSERT_MSG(available >= 1, "the scalar kernel must always be available");
+    return TEST_OK;
+}
+
+int main(int argc, char *argv[])
+{
+    fmi_import_zero_crossing_kernel_enu_t best;
+    double *zPrev = (double *)calloc(INDICATORS_NUM, sizeof(double));
+    double *z = (double *)calloc(INDICATORS_NUM, sizeof(double));
+    size_t *indices = (size_t *)calloc(INDICATORS_NUM, sizeof(size_t));
+    size_t *expected = (size_t *)calloc(INDICATORS_NUM, sizeof(size_t));
+    int ret = 1;
+
+    printf("Running fmi2_import_zero_crossing_test\n");
+    if (!zPrev || !z || !indices || !expected) {
+        printf("Could not allocate memory\n");
+        return CTEST_RETURN_FAIL;
+    }
+    best = fmi_import_get_zero_crossing_kernel();
+    printf("Selected kernel: %s\n", fmi_import_zero_crossing_kernel_to_string(best));
+
+    fill(zPrev, z, INDICATORS_NUM);
+    ret &= test_kernels(zPrev, z, indices, expected);
+    fmi_import_set_zero_crossing_kernel(best);
+
+    free(zPrev);
+    free(z);
+    free(indices);
+    free(expected);
+
+    return ret == 0 ? CTEST_RETURN_FAIL : CTEST_RETURN_SUCCESS;
+}
@@ -501,6 +501,87 @@ fmi2Status fmi_reset(fmi2Component c)
 	return fmi2OK;
 }
 
+/* The FMU state is a copy of the component. The strings and the callback functions stay with the instance. */
+fmi2Status fmi_get_fmu_state(fmi2Component c, fmi2FMUstate* s)
+{
+	component_ptr_t comp = (fmi2Component)c;
+	component_ptr_t state;
+	if (comp == NULL) {
+		return fmi2Fatal;
+	}
+	state = (component_ptr_t)*s;
+	if (state == NULL) {
+		state = (component_ptr_t)comp->functions->allocateMemory(1, sizeof(component_t));
+		if (state == NULL) {
+			return fmi2Error;
+		}
+		*s = state;
+	}
+	memcpy(state, comp, sizeof(component_t));
+	return fmi2OK;
+}
+
+fmi2Status fmi_set_fmu_state(fmi2Component c, fmi2FMUstate s)
+{
+	component_ptr_t comp = (fmi2Component)c;
+	fmi2String strings[N_STRING];
+	const fmi2CallbackFunctions* functions;
+	if (comp == NULL || s == NULL) {
+		return fmi2Fatal;
+	}
+	memcpy((void*)strings, (void*)comp->strings, sizeof(strings));
+	functions = comp->functions;
+	memcpy(comp, s, sizeof(component_t));
+	memcpy((void*)comp->strings, (void*)strings, sizeof(strings));
+	comp->functions = functions;
+	return fmi2OK;
+}
+
+fmi2Status fmi_free_fmu_state(fmi2Component c, fmi2FMUstate* s)
+{
+	component_ptr_t comp = (fmi2Component)c;
+	if (comp == NULL) {
+		return fmi2Fatal;
+	}
+	comp->functions->freeMemory(*s);
+	*s = NULL;
+	return fmi2OK;
+}
+
+fmi2Status fmi_serialized_fmu_state_size(fmi2Component c, fmi2FMUstate s, size_t* sz)
+{
+	*sz = sizeof(component_t);
+	return fmi2OK;
+}
+
+fmi2Status fmi_serialize_fmu_state(fmi2Component c, fmi2FMUstate s, fmi2Byte data[], size_t sz)
+{
+	if (s == NULL || sz < sizeof(component_t)) {
+		return fmi2Error;
+	}
+	memcpy(data, s, sizeof(component_t));
+	return fmi2OK;
+}
+
+fmi2Status fmi_de_serialize_fmu_state(fmi2Component c, const fmi2Byte data[], size_t sz, fmi2FMUstate* s)
+{
+	component_ptr_t comp = (fmi2Component)c;
+	component_ptr_t state;
+	if (comp == NULL) {
+		return fmi2Fatal;
+	}
+	if (sz != sizeof(component_t)) {
+		return fmi2Error;
+	}
+	state = (component_ptr_t)comp->functions->allocateMemory(1, sizeof(component_t));
+	if (state == NULL) {
+		return fmi2Error;
+	}
+	memcpy(state, data, sizeof(component_t));
+	*s = state;
+	return fmi2OK;
+}
+
 fmi2Status fmi_set_real_input_derivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer order[], const fmi2Real value[])
 {
 
@@ -101,6 +101,13 @@ fmi2Status		fmi_terminate(fmi2Component c);
 fmi2Status		fmi_reset(
 													fmi2Component c);
 
+fmi2Status		fmi_get_fmu_state(fmi2Component c, fmi2FMUstate* s);
+fmi2Status		fmi_set_fmu_state(fmi2Component c, fmi2FMUstate s);
+fmi2Status		fmi_free_fmu_state(fmi2Component c, fmi2FMUstate* s);
+fmi2Status		fmi_serialized_fmu_state_size(fmi2Component c, fmi2FMUstate s, size_t* sz);
+fmi2Status		fmi_serialize_fmu_state(fmi2Component c, fmi2FMUstate s, fmi2Byte data[], size_t sz);
+fmi2Status		fmi_de_serialize_fmu_state(fmi2Component c, const fmi2Byte data[], size_t sz, fmi2FMUstate* s);
+
 
 fmi2Status		fmi_get_real(			
 													fmi2Component c,
@@ -134,6 +134,36 @@ FMI2_Export fmi2Status fmi2Reset(fmi2Component c)
 	return fmi_reset(c);
 }
 
+FMI2_Export fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* s)
+{
+	return fmi_get_fmu_state(c, s);
+}
+
+FMI2_Export fmi2Status fmi2SetFMUstate(fmi2Component c, fmi2FMUstate s)
+{
+	return fmi_set_fmu_state(c, s);
+}
+
+FMI2_Export fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* s)
+{
+	return fmi_free_fmu_state(c, s);
+}
+
+FMI2_Export fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate s, size_t* sz)
+{
+	return fmi_serialized_fmu_state_size(c, s, sz);
+}
+
+FMI2_Export fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate s, fmi2Byte data[], size_t sz)
+{
+	return fmi_serialize_fmu_state(c, s, data, sz);
+}
+
+FMI2_Export fmi2Status fmi2DeSerializeFMUstate(fmi2Component c, const fmi2Byte data[], size_t sz, fmi2FMUstate* s)
+{
+	return fmi_de_serialize_fmu_state(c, data, sz, s);
+}
+
 FMI2_Export fmi2Status fmi2SetRealInputDerivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer order[], const fmi2Real value[])
 {
 	return fmi_set_real_input_derivatives(c, vr, nvr, order, value);
@@ -0,0 +1,95 @@
+#ifndef FMI2_TEST_FIXTURE_H
+#define FMI2_TEST_FIXTURE_H
+
+/* Loading of the FMI 2.0 test FMU for co-simulation, shared by the import tests.
+   The tests are called with <fmu_file> <temporary_dir>, and each test uses its own temporary_dir. */
+
+#include <stdio.h>
+
+#include <fmilib.h>
+#include "fmil_test.h"
+
+/* Check the arguments, allocate a context and unzip the FMU into the temporary dir.
+   Returns NULL after printing the reason on failure. */
+static fmi_import_context_t *fmi2_test_open(int argc, char *argv[], const char *testName, jm_callbacks *cb)
+{
+    fmi_import_context_t *context;
+
+    if (argc < 3) {
+        printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+        return NULL;
+    }
+
+    printf("Running %s\n", testName);
+
+    context = fmi_import_allocate_context(cb ? cb : jm_get_default_callbacks());
+    if (!context) {
+        printf("Could not allocate the import context\n");
+        return NULL;
+    }
+    if (fmi_import_get_fmi_version(context, argv[1], argv[2]) != fmi_version_2_0_enu) {
+        printf("The code only supports version 2.0\n");
+        fmi_import_free_context(context);
+        return NULL;
+    }
+    return context;
+}
+
+/* Parse the unzipped FMU and load its binary. The FMU callbacks may be NULL. */
+static fmi2_import_t *fmi2_test_load(fmi_import_context_t *context, const char *dir, fmi2_callback_functions_t *callBackFunctions)
+{
+    fmi2_import_t *fmu = fmi2_import_parse_xml(context, dir, NULL);
+
+    if (!fmu) return NULL;
+    if (fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, callBackFunctions) != jm_status_success) {
+        fmi2_import_free(fmu);
+        return NULL;
+    }
+    return fmu;
+}
+
+static void fmi2_test_unload(fmi2_import_t *fmu)
+{
+    fmi2_import_destroy_dllfmu(fmu);
+    fmi2_import_free(fmu);
+}
+
+/* Instantiate for co-simulation and initialize at time zero */
+static int fmi2_test_start(fmi2_import_t *fmu, const char *instanceName)
+{
+    ASSERT_MSG(fmi2_import_instantiate(fmu, instanceName, fmi2_cosimulation, NULL, fmi2_false) == jm_status_success,
+               "instantiation failed");
+    if (fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) != fmi2_status_ok
+        || fmi2_import_enter_initialization_mode(fmu) != fmi2_status_ok
+        || fmi2_import_exit_initialization_mode(fmu) != fmi2_status_ok) {
+        fmi2_import_free_instance(fmu);
+        TEST_FAILED("initialization failed");
+    }
+    return TEST_OK;
+}
+
+static void fmi2_test_stop(fmi2_import_t *fmu)
+{
+    fmi2_import_terminate(fmu);
+    fmi2_import_free_instance(fmu);
+}
+
+/* Load, instantiate and initialize. Returns NULL on failure. */
+static fmi2_import_t *fmi2_test_load_started(fmi_import_context_t *context, const char *dir, const char *instanceName)
+{
+    fmi2_import_t *fmu = fmi2_test_load(context, dir, NULL);
+
+    if (fmu && !fmi2_test_start(fmu, instanceName)) {
+        fmi2_test_unload(fmu);
+        return NULL;
+    }
+    return fmu;
+}
+
+static void fmi2_test_unload_started(fmi2_import_t *fmu)
+{
+    fmi2_test_stop(fmu);
+    fmi2_test_unload(fmu);
+}
+
+#endif /* FMI2_TEST_FIXTURE_H */
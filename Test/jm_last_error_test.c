@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "config_test.h"
+
+/* The test links with jmutils directly, see jm_locale_test.c */
+#define FMILIB_BUILDING_LIBRARY
+
+#include <JM/jm_callbacks.h>
+#include <JM/jm_thread.h>
+
+#define THREADS_NUM 4
+#define MESSAGES_NUM 20000
+
+typedef struct worker_t {
+    jm_callbacks* cb;
+    unsigned index;
+    int failed;
+    jm_thread_t thread;
+} worker_t;
+
+static void fail(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    printf("Test failure: ");
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+
+    exit(CTEST_RETURN_FAIL);
+}
+
+/* Each worker sees the last error it logged itself, although all workers share the callbacks. */
+static void work(void* arg) {
+    worker_t* w = (worker_t*)arg;
+    char expected[100];
+    unsigned i;
+    for(i = 0; i < MESSAGES_NUM && !w->failed; i++) {
+        jm_log_error(w->cb, "WORKER", "error %u of thread %u", i, w->index);
+        jm_log_info(w->cb, "WORKER", "info %u of thread %u", i, w->index);
+        sprintf(expected, "error %u of thread %u", i, w->index);
+        if(strcmp(jm_get_last_error(w->cb), expected) != 0) w->failed = 1;
+    }
+}
+
+static void test_threads(void) {
+    jm_callbacks cb = *jm_get_default_callbacks();
+    worker_t workers[THREADS_NUM];
+    unsigned i;
+
+    cb.logger = 0;
+    cb.log_level = jm_log_level_info;
+    jm_log_error(&cb, "MAIN", "error of the main thread");
+    for(i = 0; i < THREADS_NUM; i++) {
+        workers[i].cb = &cb;
+        workers[i].index = i;
+        workers[i].failed = 0;
+        if(jm_thread_create(&workers[i].thread, work, &workers[i]) != jm_status_success) {
+            fail("could not start thread");
+        }
+    }
+    for(i = 0; i < THREADS_NUM; i++) {
+        jm_thread_join(&workers[i].thread);
+    }
+    for(i = 0; i < THREADS_NUM; i++) {
+        if(workers[i].failed) fail("thread %u did not see its own error", i);
+    }
+    if(strcmp(jm_get_last_error(&cb), "error of the main thread") != 0) {
+        fail("the error of the main thread was overwritten");
+    }
+}
+
+static void test_levels(void) {
+    jm_callbacks cb = *jm_get_default_callbacks();
+    char message[2 * JM_MAX_ERROR_MESSAGE_SIZE];
+
+    cb.logger = 0;
+    cb.log_level = jm_log_level_info;
+    jm_log_warning(&cb, "MAIN", "warning");
+    if(strcmp(jm_get_last_error(&cb), "warning") != 0) fail("warning was not kept");
+    jm_log_info(&cb, "MAIN", "info");
+    if(strcmp(jm_get_last_error(&cb), "warning") != 0) fail("info message was kept");
+    jm_clear_last_error(&cb);
+    if(jm_get_last_error(&cb)[0] != 0) fail("message was not cleared");
+    cb.log_level = jm_log_level_error;
+    jm_log_warning(&cb, "MAIN", "disabled warning");
+    if(jm_get_last_error(&cb)[0] != 0) fail("message of a disabled level was kept");
+
+    memset(message, 'a', sizeof(message) - 1);
+    message[sizeof(message) - 1] = 0;
+    jm_set_last_error(&cb, jm_log_level_error, message);
+    if(strlen(jm_get_last_error(&cb)) != JM_MAX_ERROR_MESSAGE_SIZE - 1) fail("long message was not cut");
+}
+
+int main(void) {
+    test_threads();
+    test_levels();
+    return CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "config_test.h"
+
+/* The test links with jmutils directly, see jm_locale_test.c */
+#define FMILIB_BUILDING_LIBRARY
+
+#include <JM/jm_callbacks.h>
+#include <JM/jm_thread.h>
+#include <JM/jm_log_queue.h>
+
+#define PRODUCERS_NUM 4
+
+static void fail(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    printf("Test failure: ");
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+
+    exit(CTEST_RETURN_FAIL);
+}
+
+/* Logger behind the queue. Checks that the messages of each producer arrive in order. */
+typedef struct sink_t {
+    jm_mutex_t lock;      /* only used to sleep */
+    jm_cond_t cond;
+    double delay;         /* seconds spent on each message */
+    size_t receivedNum;
+    unsigned next[PRODUCERS_NUM];
+    size_t longestMessage;
+    int outOfOrder;
+    int unexpected;
+} sink_t;
+
+static void sink_logger(jm_callbacks* c, jm_string module, jm_log_level_enu_t log_level, jm_string message) {
+    sink_t* s = (sink_t*)c->context;
+    unsigned producer, seq;
+
+    s->receivedNum++;
+    if(strlen(message) > s->longestMessage) s->longestMessage = strlen(message);
+    if(strcmp(module, "PRODUCER") == 0 && sscanf(message, "%u %u", &producer, &seq) == 2 && producer < PRODUCERS_NUM) {
+        if(seq < s->next[producer]) s->outOfOrder = 1;
+        s->next[producer] = seq + 1;
+    }
+    else if(strcmp(module, "LONG") != 0) {
+        s->unexpected = 1;
+    }
+    if(s->delay > 0) {
+        jm_mutex_lock(&s->lock);
+        jm_cond_timed_wait(&s->cond, &s->lock, s->delay);
+        jm_mutex_unlock(&s->lock);
+    }
+}
+
+typedef struct producer_t {
+    jm_callbacks* cb;
+    unsigned index;
+    unsigned messagesNum;
+    jm_thread_t thread;
+} producer_t;
+
+static void produce(void* arg) {
+    producer_t* p = (producer_t*)arg;
+    unsigned i;
+    for(i = 0; i < p->messagesNum; i++) {
+        jm_log_info(p->cb, "PRODUCER", "%u %u", p->index, i);
+    }
+}
+
+static void init_sink(sink_t* s, jm_callbacks* cb, double delay) {
+    memset(s, 0, sizeof(sink_t));
+    jm_mutex_init(&s->lock);
+    jm_cond_init(&s->cond);
+    s->delay = delay;
+    *cb = *jm_get_default_callbacks();
+    cb->logger = sink_logger;
+    cb->context = s;
+    cb->log_level = jm_log_level_info;
+}
+
+static void free_sink(sink_t* s) {
+    jm_cond_destroy(&s->cond);
+    jm_mutex_destroy(&s->lock);
+}
+
+static void run_producers(jm_callbacks* cb, unsigned messagesNum) {
+    producer_t producers[PRODUCERS_NUM];
+    unsigned i;
+    for(i = 0; i < PRODUCERS_NUM; i++) {
+        producers[i].cb = cb;
+        producers[i].index = i;
+        producers[i].messagesNum = messagesNum;
+        if(jm_thread_create(&producers[i].thread, produce, &producers[i]) != jm_status_success) {
+            fail("could not start producer thread");
+        }
+    }
+    for(i = 0; i < PRODUCERS_NUM; i++) {
+        jm_thread_join(&producers[i].thread);
+    }
+}
+
+/* With backpressure no message is lost, even with a queue much smaller than the burst. */
+static void test_block(void) {
+    jm_callbacks cb;
+    sink_t sink;
+    jm_log_queue_t* q;
+    jm_log_queue_stats_t stats;
+    unsigned messagesNum = 20000, i;
+
+    init_sink(&sink, &cb, 0);
+    q = jm_log_queue_create(&cb, 64, 0, jm_log_queue_block);
+    if(!q) fail("jm_log_queue_create failed");
+    if(cb.logger == sink_logger) fail("queue was not installed");
+
+    run_producers(&cb, messagesNum);
+    jm_log_queue_flush(q);
+    jm_log_queue_get_stats(q, &stats);
+    printf("block: queued %u, delivered %u, dropped %u, waits %u\n", (unsigned)stats.queuedNum,
+        (unsigned)stats.deliveredNum, (unsigned)stats.droppedNum, (unsigned)stats.waitsNum);
+    if(stats.queuedNum != PRODUCERS_NUM * messagesNum || stats.deliveredNum != stats.queuedNum || stats.droppedNum != 0) {
+        fail("messages were lost with the blocking policy");
+    }
+    if(sink.receivedNum != stats.deliveredNum) fail("sink received %u messages", (unsigned)sink.receivedNum);
+    for(i = 0; i < PRODUCERS_NUM; i++) {
+        if(sink.next[i] != messagesNum) fail("last message of producer %u was %u", i, sink.next[i]);
+    }
+    if(sink.outOfOrder || sink.unexpected) fail("messages were reordered or corrupted");
+
+    jm_log_queue_destroy(q);
+    if(cb.logger != sink_logger || cb.context != &sink) fail("logger was not restored");
+    free_sink(&sink);
+}
+
+/* A slow logger makes the queue drop messages instead of slowing down the producers. */
+static void test_drop(void) {
+    jm_callbacks cb;
+    sink_t sink;
+    jm_log_queue_t* q;
+    jm_log_queue_stats_t stats;
+    unsigned messagesNum = 2000;
+
+    init_sink(&sink, &cb, 0.001);
+    q = jm_log_queue_create(&cb, 16, 0, jm_log_queue_drop);
+    if(!q) fail("jm_log_queue_create failed");
+
+    run_producers(&cb, messagesNum);
+    jm_log_queue_flush(q);
+    jm_log_queue_get_stats(q, &stats);
+    printf("drop: queued %u, delivered %u, dropped %u\n", (unsigned)stats.queuedNum,
+        (unsigned)stats.deliveredNum, (unsigned)stats.droppedNum);
+    if(stats.queuedNum + stats.droppedNum != PRODUCERS_NUM * messagesNum) fail("lost messages were not counted");
+    if(stats.droppedNum == 0) fail("expected dropped messages with a slow logger");
+    if(stats.deliveredNum != stats.queuedNum || sink.receivedNum != stats.deliveredNum) fail("queued messages were not delivered");
+    if(stats.waitsNum != 0) fail("producers waited with the drop policy");
+    if(sink.outOfOrder || sink.unexpected) fail("messages were reordered or corrupted");
+
+    jm_log_queue_destroy(q);
+    free_sink(&sink);
+}
+
+/* Long messages are cut to the slot size; destroy delivers what is left. */
+static void test_truncate(void) {
+    jm_callbacks cb;
+    sink_t sink;
+    jm_log_queue_t* q;
+    jm_log_queue_stats_t stats;
+
+    init_sink(&sink, &cb, 0);
+    q = jm_log_queue_create(&cb, 4, 16, jm_log_queue_block);
+    if(!q) fail("jm_log_queue_create failed");
+    jm_log_warning(&cb, "LONG", "%s", "a message that does not fit into sixteen characters");
+    jm_log_queue_get_stats(q, &stats);
+    if(stats.truncatedNum != 1) fail("truncated message was not counted");
+    jm_log_queue_destroy(q);
+    if(sink.receivedNum != 1 || sink.longestMessage != 15) fail("expected one message of 15 characters");
+    free_sink(&sink);
+}
+
+int main(void) {
+    test_block();
+    test_drop();
+    test_truncate();
+    return CTEST_RETURN_SUCCESS;
+}
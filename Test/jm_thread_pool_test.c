@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "config_test.h"
+
+/* The test links with jmutils directly, see jm_locale_test.c */
+#define FMILIB_BUILDING_LIBRARY
+
+#include <JM/jm_callbacks.h>
+#include <JM/jm_thread.h>
+#include <JM/jm_thread_pool.h>
+
+#define THREADS_NUM 4
+#define TASKS_NUM 16
+#define RUNS_NUM 20
+
+static void fail(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    printf("Test failure: ");
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+
+    exit(CTEST_RETURN_FAIL);
+}
+
+/* Records which thread executed each task. Threads are numbered on their first task in a run. */
+typedef struct run_t {
+    jm_thread_key_t key;
+    int run;
+    int ids[RUNS_NUM][THREADS_NUM];  /* the key points to the entry of the thread in the current run */
+    volatile size_t threadsSeen;
+    int owner[TASKS_NUM];
+    int executed[TASKS_NUM];
+    jm_mutex_t lock;      /* only used to sleep */
+    jm_cond_t cond;
+} run_t;
+
+static void task(void* context, size_t index) {
+    run_t* r = (run_t*)context;
+    int* id = (int*)jm_thread_key_get(&r->key);
+
+    if(!id || id < r->ids[r->run] || id >= r->ids[r->run] + THREADS_NUM) {
+        size_t n = jm_atomic_fetch_add(&r->threadsSeen, 1);
+        if(n >= THREADS_NUM) fail("more threads than the pool has");
+        id = &r->ids[r->run][n];
+        *id = (int)n;
+        jm_thread_key_set(&r->key, id);
+    }
+    r->owner[index] = *id;
+    r->executed[index]++;
+
+    /* Slow tasks give every worker the chance to take part */
+    jm_mutex_lock(&r->lock);
+    jm_cond_timed_wait(&r->cond, &r->lock, 0.005);
+    jm_mutex_unlock(&r->lock);
+}
+
+/* Every run executes each task once, and the workers take part in every run */
+static void test_runs(void) {
+    jm_thread_pool_t* pool = jm_thread_pool_create(0, THREADS_NUM);
+    run_t r;
+    int run, i;
+
+    if(!pool) fail("jm_thread_pool_create failed");
+    if(jm_thread_pool_get_threads_num(pool) != THREADS_NUM) fail("wrong number of threads");
+    if(jm_thread_key_create(&r.key) != jm_status_success) fail("jm_thread_key_create failed");
+    jm_mutex_init(&r.lock);
+    jm_cond_init(&r.cond);
+
+    for(run = 0; run < RUNS_NUM; run++) {
+        int participants[THREADS_NUM], participantsNum = 0;
+
+        r.run = run;
+        r.threadsSeen = 0;
+        memset(r.executed, 0, sizeof(r.executed));
+        memset(participants, 0, sizeof(participants));
+
+        jm_thread_pool_run(pool, TASKS_NUM, task, &r);
+
+        for(i = 0; i < TASKS_NUM; i++) {
+            if(r.executed[i] != 1) fail("run %d: task %d executed %d times", run, i, r.executed[i]);
+            if(!participants[r.owner[i]]++) participantsNum++;
+        }
+        if(participantsNum < 2) fail("run %d: only one thread executed tasks", run);
+    }
+    printf("%d runs of %d tasks on %d threads\n", RUNS_NUM, TASKS_NUM, THREADS_NUM);
+
+    jm_thread_key_delete(&r.key);
+    jm_cond_destroy(&r.cond);
+    jm_mutex_destroy(&r.lock);
+    jm_thread_pool_destroy(pool);
+}
+
+/* Runs without tasks and with fewer tasks than threads return */
+static void test_small_runs(void) {
+    jm_thread_pool_t* pool = jm_thread_pool_create(0, THREADS_NUM);
+    run_t r;
+    int i;
+
+    if(!pool) fail("jm_thread_pool_create failed");
+    jm_mutex_init(&r.lock);
+    jm_cond_init(&r.cond);
+    if(jm_thread_key_create(&r.key) != jm_status_success) fail("jm_thread_key_create failed");
+    r.run = 0;
+    r.threadsSeen = 0;
+    memset(r.executed, 0, sizeof(r.executed));
+
+    jm_thread_pool_run(pool, 0, task, &r);
+    jm_thread_pool_run(pool, 1, task, &r);
+    jm_thread_pool_run(pool, 2, task, &r);
+    for(i = 0; i < TASKS_NUM; i++) {
+        int expected = (i == 0) ? 2 : (i == 1) ? 1 : 0;
+        if(r.executed[i] != expected) fail("task %d executed %d times", i, r.executed[i]);
+    }
+
+    jm_thread_key_delete(&r.key);
+    jm_cond_destroy(&r.cond);
+    jm_mutex_destroy(&r.lock);
+    jm_thread_pool_destroy(pool);
+}
+
+int main(void) {
+    test_runs();
+    test_small_runs();
+    return CTEST_RETURN_SUCCESS;
+}
@@ -0,0 +1,127 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef FMI_CAPI_REGISTRY_H_
+#define FMI_CAPI_REGISTRY_H_
+
+#include <stddef.h>
+#include <JM/jm_callbacks.h>
+#include <JM/jm_portability.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fmi_capi_registry.h
+ * \brief Process-wide registry of loaded FMU binaries and their resolved function tables.
+ *
+ * Entries are keyed by the canonical path of the shared library, the model identifier and
+ * the kind of function table. Each entry holds the library handle and a function table that
+ * is resolved once and never modified afterwards. Entries are reference counted. When the
+ * last reference is released, the entry becomes unused; at most fmi_capi_registry_get_max_unused()
+ * unused entries are kept loaded, the least recently used ones are unloaded first.
+ * All functions are thread-safe.
+ */
+
+/** \brief Kind of function table held by a registry entry. */
+typedef enum fmi_capi_table_kind_enu_t {
+	fmi_capi_table_fmi1_me,
+	fmi_capi_table_fmi1_cs,
+	fmi_capi_table_fmi2_me,
+	fmi_capi_table_fmi2_cs
+} fmi_capi_table_kind_enu_t;
+
+/** \brief Opaque registry entry. */
+typedef struct fmi_capi_registry_entry_t fmi_capi_registry_entry_t;
+
+/**
+ * \brief Function resolving a function table.
+ * @param dllHandle The loaded shared library.
+ * @param table Zero-initialized table to fill in.
+ * @param context User data passed to fmi_capi_registry_get_table().
+ * @return Error status. On jm_status_error the table is discarded.
+ */
+typedef jm_status_enu_t (*fmi_capi_resolve_ft)(DLL_HANDLE dllHandle, void* table, void* context);
+
+/**
+ * \brief Get a reference to the entry for a shared library, loading the library if needed.
+ * @param cb Callbacks used for logging.
+ * @param dllPath Path to the shared library.
+ * @param modelIdentifier The model identifier.
+ * @param kind Kind of function table.
+ * @return The entry or NULL if the library could not be loaded.
+ */
+fmi_capi_registry_entry_t* fmi_capi_registry_acquire(jm_callbacks* cb, const char* dllPath, const char* modelIdentifier, fmi_capi_table_kind_enu_t kind);
+
+/**
+ * \brief Load a private copy of a shared library.
+ *
+ * The library is copied to a new directory next to it and loaded from there, so that
+ * the returned entry does not share global variables with any other entry. This is
+ * needed to run several instances of FMUs that can only be instantiated once per process.
+ * The entry is never returned by fmi_capi_registry_acquire(). When its last reference is
+ * released the library is unloaded and the copy is removed, regardless of the cache size.
+ * @param cb Callbacks used for logging.
+ * @param dllPath Path to the shared library.
+ * @param modelIdentifier The model identifier.
+ * @param kind Kind of function table.
+ * @return The entry or NULL if the library could not be copied or loaded.
+ */
+fmi_capi_registry_entry_t* fmi_capi_registry_acquire_isolated(jm_callbacks* cb, const char* dllPath, const char* modelIdentifier, fmi_capi_table_kind_enu_t kind);
+
+/** \brief Add a reference to an entry that is already referenced by the caller. */
+void fmi_capi_registry_retain(fmi_capi_registry_entry_t* entry);
+
+/**
+ * \brief Release a reference to an entry.
+ * @param cb Callbacks used for logging.
+ * @param entry The entry.
+ * @param unload If zero, the library is never unloaded once the entry is unused (debug mode).
+ * @return Error status. jm_status_error if the library was unloaded and the operation failed.
+ */
+jm_status_enu_t fmi_capi_registry_release(jm_callbacks* cb, fmi_capi_registry_entry_t* entry, int unload);
+
+/** \brief Get the library handle of an entry. */
+DLL_HANDLE fmi_capi_registry_get_dll_handle(fmi_capi_registry_entry_t* entry);
+
+/**
+ * \brief Get the function table of an entry, resolving it on first use.
+ * @param entry The entry.
+ * @param size Size of the table in bytes. Must be the same for all calls on an entry.
+ * @param resolve Function used to fill in the table on first use.
+ * @param context User data passed to the resolve function.
+ * @return The immutable table or NULL if it could not be resolved.
+ */
+const void* fmi_capi_registry_get_table(fmi_capi_registry_entry_t* entry, size_t size, fmi_capi_resolve_ft resolve, void* context);
+
+/** \brief Set the maximum number of unused entries kept loaded. The default is 0, i.e., a library is unloaded when the last user releases it. */
+void fmi_capi_registry_set_max_unused(size_t maxUnused);
+
+/** \brief Get the maximum number of unused entries kept loaded. */
+size_t fmi_capi_registry_get_max_unused(void);
+
+/** \brief Unload all unused entries.
+ * @return The number of entries unloaded.
+ */
+size_t fmi_capi_registry_evict_unused(void);
+
+/** \brief Get the number of entries, used and unused. */
+size_t fmi_capi_registry_get_entries_num(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI_CAPI_REGISTRY_H_ */
@@ -22,6 +22,7 @@
 #include <FMI1/fmi1_enums.h>
 #include <JM/jm_portability.h>
 #include <JM/jm_callbacks.h>
+#include <FMI/fmi_call_stats.h>
 
 typedef struct fmi1_capi_t fmi1_capi_t;
 
@@ -111,6 +112,62 @@ void fmi1_capi_set_debug_mode(fmi1_capi_t* fmu, int mode);
  * @param fmu C-API struct that has succesfully loaded the FMI function. */
 int fmi1_capi_get_debug_mode(fmi1_capi_t* fmu);
 
+/**
+ * \brief Set CAPI isolation mode flag. Setting to non-zero makes fmi1_capi_load_dll() load a private copy
+ *  of the shared library, so that the global variables of the FMU are not shared with other C-API structs.
+ *  The copy is removed by fmi1_capi_free_dll().
+ *
+ * @param fmu C-API struct that has not loaded the shared library yet.
+ * @param mode The isolation mode to set.
+ */
+void fmi1_capi_set_isolation_mode(fmi1_capi_t* fmu, int mode);
+
+/**
+ * \brief Get CAPI isolation mode flag that was set with fmi1_capi_set_isolation_mode()
+ *
+ * @param fmu C-API struct. */
+int fmi1_capi_get_isolation_mode(fmi1_capi_t* fmu);
+
+/**
+ * \brief Switch call tracing on or off. While tracing is on, the function pointers of the C-API struct
+ *  point to timing shims that record the calls in ::fmi_call_stats_t entries, one per FMI function.
+ *  Switching swaps the function table, so the calls cost nothing extra while tracing is off.
+ *  The statistics are kept when tracing is switched off.
+ *
+ * @param fmu C-API struct that has succesfully loaded the FMI functions.
+ * @param enable Non-zero to switch tracing on.
+ * @return Error status. Fails if the memory for the statistics could not be allocated.
+ */
+jm_status_enu_t fmi1_capi_set_tracing(fmi1_capi_t* fmu, int enable);
+
+/**
+ * \brief Get the call tracing flag that was set with fmi1_capi_set_tracing()
+ *
+ * @param fmu C-API struct. */
+int fmi1_capi_get_tracing(fmi1_capi_t* fmu);
+
+/**
+ * \brief Copy the call statistics of the traced FMI functions.
+ *
+ * @param fmu C-API struct.
+ * @param stats Output, receives the statistics of at most n functions. Functions that were not called have a zero count.
+ * @param n Size of the stats array.
+ * @return The number of traced functions.
+ */
+size_t fmi1_capi_get_call_stats(fmi1_capi_t* fmu, fmi_call_stats_t stats[], size_t n);
+
+/**
+ * \brief Clear the call statistics.
+ *
+ * @param fmu C-API struct. */
+void fmi1_capi_reset_call_stats(fmi1_capi_t* fmu);
+
+/**
+ * \brief Get the component returned by the instantiate function of the FMU, also while tracing is on.
+ *
+ * @param fmu C-API struct. */
+fmi1_component_t fmi1_capi_get_component(fmi1_capi_t* fmu);
+
 
 /**@} */
 
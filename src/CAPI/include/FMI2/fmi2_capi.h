@@ -22,6 +22,7 @@
 #include <FMI2/fmi2_enums.h>
 #include <JM/jm_portability.h>
 #include <JM/jm_callbacks.h>
+#include <FMI/fmi_call_stats.h>
 
 typedef struct fmi2_capi_t fmi2_capi_t;
 
@@ -72,6 +73,17 @@ void fmi2_capi_destroy_dllfmu(fmi2_capi_t* fmu);
  */
 fmi2_capi_t* fmi2_capi_create_dllfmu(jm_callbacks* callbacks, const char* dllPath, const char* modelIdentifier, const fmi2_callback_functions_t* callBackFunctions, fmi2_fmu_kind_enu_t standard);
 
+/**
+ * \brief Create a C-API struct that shares the loaded shared library and FMI functions of another one.
+ *
+ * The new struct has its own component and callbacks passed to the FMU. It holds its own
+ * reference to the loaded shared library, so the two structs may be destroyed in any order.
+ * @param fmu A C-API struct with loaded FMI functions, see fmi2_capi_load_fcn().
+ * @param callBackFunctions callbacks passed to the FMU.
+ * @return The new C-API struct or NULL on memory allocation failure.
+ */
+fmi2_capi_t* fmi2_capi_clone_dllfmu(fmi2_capi_t* fmu, const fmi2_callback_functions_t* callBackFunctions);
+
 /**
  * \brief Loads the FMI functions from the shared library. The shared library must be loaded before this function can be called, see fmi2_import_create_dllfmu.
  * 
@@ -112,6 +124,105 @@ void fmi2_capi_set_debug_mode(fmi2_capi_t* fmu, int mode);
  * @param fmu C-API struct that has succesfully loaded the FMI function. */
 int fmi2_capi_get_debug_mode(fmi2_capi_t* fmu);
 
+/**
+ * \brief Set CAPI isolation mode flag. Setting to non-zero makes fmi2_capi_load_dll() load a private copy
+ *  of the shared library, so that the global variables of the FMU are not shared with other C-API structs.
+ *  This is needed to run several instances of FMUs that can only be instantiated once per process.
+ *  Clones of a C-API struct in isolation mode load their own copies. The copy is removed by fmi2_capi_free_dll().
+ *
+ * @param fmu C-API struct that has not loaded the shared library yet.
+ * @param mode The isolation mode to set.
+ */
+void fmi2_capi_set_isolation_mode(fmi2_capi_t* fmu, int mode);
+
+/**
+ * \brief Get CAPI isolation mode flag that was set with fmi2_capi_set_isolation_mode()
+ *
+ * @param fmu C-API struct. */
+int fmi2_capi_get_isolation_mode(fmi2_capi_t* fmu);
+
+/**
+ * \brief Run the binary in a separate host process. Must be called before fmi2_capi_load_dll().
+ *  fmi2_capi_load_dll() starts the host and loads the binary in it, and the function pointers
+ *  forward the calls over shared memory. A crash of the binary terminates only the host; the
+ *  calls then return fmi2_status_fatal. Supported on POSIX systems.
+ *
+ * @param fmu C-API struct.
+ * @param hostPath Path of the fmi2_capi_host executable. NULL runs the binary in this process.
+ * @return Error status. Fails if the platform does not support host processes.
+ */
+jm_status_enu_t fmi2_capi_set_host(fmi2_capi_t* fmu, const char* hostPath);
+
+/**
+ * \brief Get the host executable that was set with fmi2_capi_set_host(), or NULL.
+ *
+ * @param fmu C-API struct. */
+const char* fmi2_capi_get_host(fmi2_capi_t* fmu);
+
+/**
+ * \brief Check if the host process has terminated unexpectedly.
+ *
+ * @param fmu C-API struct. */
+int fmi2_capi_is_host_crashed(fmi2_capi_t* fmu);
+
+/**
+ * \brief Get the process id of the running host process, or 0.
+ *
+ * @param fmu C-API struct. */
+unsigned long fmi2_capi_get_host_pid(fmi2_capi_t* fmu);
+
+/**
+ * \brief Start a new host process and bring it to the state of the lost one. The instance is
+ *  re-created with the arguments of the last instantiation, the experiment setup and the
+ *  initialization are repeated, and the FMU state is restored from the snapshot.
+ *
+ * @param fmu C-API struct that has loaded the FMI functions in a host process.
+ * @param snapshot Serialized FMU state, see fmi2_capi_serialize_fmu_state(). NULL keeps the initialized state.
+ * @param size Size of the snapshot.
+ * @return Error status.
+ */
+jm_status_enu_t fmi2_capi_restart_host(fmi2_capi_t* fmu, const fmi2_byte_t snapshot[], size_t size);
+
+/**
+ * \brief Switch call tracing on or off. While tracing is on, the function pointers of the C-API struct
+ *  point to timing shims that record the calls in ::fmi_call_stats_t entries, one per FMI function.
+ *  Switching swaps the function table, so the calls cost nothing extra while tracing is off.
+ *  The statistics are kept when tracing is switched off.
+ *
+ * @param fmu C-API struct that has succesfully loaded the FMI functions.
+ * @param enable Non-zero to switch tracing on.
+ * @return Error status. Fails if the memory for the statistics could not be allocated.
+ */
+jm_status_enu_t fmi2_capi_set_tracing(fmi2_capi_t* fmu, int enable);
+
+/**
+ * \brief Get the call tracing flag that was set with fmi2_capi_set_tracing()
+ *
+ * @param fmu C-API struct. */
+int fmi2_capi_get_tracing(fmi2_capi_t* fmu);
+
+/**
+ * \brief Copy the call statistics of the traced FMI functions.
+ *
+ * @param fmu C-API struct.
+ * @param stats Output, receives the statistics of at most n functions. Functions that were not called have a zero count.
+ * @param n Size of the stats array.
+ * @return The number of traced functions.
+ */
+size_t fmi2_capi_get_call_stats(fmi2_capi_t* fmu, fmi_call_stats_t stats[], size_t n);
+
+/**
+ * \brief Clear the call statistics.
+ *
+ * @param fmu C-API struct. */
+void fmi2_capi_reset_call_stats(fmi2_capi_t* fmu);
+
+/**
+ * \brief Get the component returned by the instantiate function of the FMU, also while tracing is on.
+ *
+ * @param fmu C-API struct. */
+fmi2_component_t fmi2_capi_get_component(fmi2_capi_t* fmu);
+
 /**
  * \brief Get the FMU kind loaded by the CAPI
  * 
@@ -0,0 +1,383 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <JM/jm_thread.h>
+#include <FMI/fmi_capi_registry.h>
+
+#define FMI_CAPI_MODULE_NAME "FMICAPI"
+
+/* Size of the local copies of loader error messages */
+#define FMI_CAPI_REGISTRY_ERROR_SIZE 1000
+
+struct fmi_capi_registry_entry_t {
+	fmi_capi_registry_entry_t* next;
+
+	/* key */
+	char* dllPath;
+	char* modelIdentifier;
+	fmi_capi_table_kind_enu_t kind;
+
+	DLL_HANDLE dllHandle;
+	void* table;
+
+	/* Directory next to the library holding its private copy for isolated entries */
+	char* isolatedDir;
+
+	size_t refCount;
+	unsigned long lastUse; /* release order of unused entries */
+	int unloadFailed;
+};
+
+/* All registry state is protected by a single lock. Loading and unloading
+   libraries is serialized by the dynamic loader anyway. The user logger is
+   never called with the lock held, loader errors are copied out first. */
+static jm_mutex_t registryLock = JM_MUTEX_INITIALIZER;
+static fmi_capi_registry_entry_t* registryHead = 0;
+static size_t registryMaxUnused = 0;
+static size_t registryUnusedNum = 0;
+static unsigned long registryTick = 0;
+
+static void fmi_capi_registry_free_entry(fmi_capi_registry_entry_t* entry) {
+	jm_callbacks* cb = jm_get_default_callbacks();
+	cb->free(entry->table);
+	cb->free(entry->isolatedDir);
+	cb->free(entry->dllPath);
+	cb->free(entry->modelIdentifier);
+	cb->free(entry);
+}
+
+static void fmi_capi_registry_unlink(fmi_capi_registry_entry_t* entry) {
+	fmi_capi_registry_entry_t** pp = &registryHead;
+	while(*pp != entry) {
+		assert(*pp);
+		pp = &(*pp)->next;
+	}
+	*pp = entry->next;
+}
+
+/* Copy the last loader error. Called with the lock held. */
+static void fmi_capi_registry_copy_dll_error(char* buf) {
+	jm_snprintf(buf, FMI_CAPI_REGISTRY_ERROR_SIZE, "%s", jm_portability_get_last_dll_error());
+}
+
+/* Unload the least recently used unused entries until at most keep remain.
+   Called with the lock held. The unloaded entries are returned in a list that
+   must be passed to fmi_capi_registry_free_unloaded() after unlocking. */
+static fmi_capi_registry_entry_t* fmi_capi_registry_evict(size_t keep, char* dllError) {
+	fmi_capi_registry_entry_t* unloaded = 0;
+	while(registryUnusedNum > keep) {
+		fmi_capi_registry_entry_t* lru = 0;
+		fmi_capi_registry_entry_t* e;
+		for(e = registryHead; e; e = e->next) {
+			if(e->refCount == 0 && (!lru || e->lastUse < lru->lastUse)) {
+				lru = e;
+			}
+		}
+		assert(lru);
+		fmi_capi_registry_unlink(lru);
+		registryUnusedNum--;
+		if(jm_portability_free_dll_handle(lru->dllHandle) == jm_status_error) {
+			if(!dllError[0]) {
+				fmi_capi_registry_copy_dll_error(dllError);
+			}
+			lru->unloadFailed = 1;
+		}
+		lru->next = unloaded;
+		unloaded = lru;
+	}
+	return unloaded;
+}
+
+/* Report and free entries unloaded by fmi_capi_registry_evict(). Called without the lock. */
+static jm_status_enu_t fmi_capi_registry_free_unloaded(jm_callbacks* cb, fmi_capi_registry_entry_t* unloaded, const char* dllError, size_t* evicted) {
+	jm_status_enu_t status = jm_status_success;
+	while(unloaded) {
+		fmi_capi_registry_entry_t* next = unloaded->next;
+		if(unloaded->unloadFailed) {
+			jm_log_error(cb, FMI_CAPI_MODULE_NAME, "Could not free the FMU binary %s: %s", unloaded->dllPath, dllError);
+			status = jm_status_error;
+		}
+		else {
+			jm_log_verbose(cb, FMI_CAPI_MODULE_NAME, "Successfully unloaded FMU binary %s", unloaded->dllPath);
+		}
+		fmi_capi_registry_free_entry(unloaded);
+		if(evicted) (*evicted)++;
+		unloaded = next;
+	}
+	return status;
+}
+
+fmi_capi_registry_entry_t* fmi_capi_registry_acquire(jm_callbacks* cb, const char* dllPath, const char* modelIdentifier, fmi_capi_table_kind_enu_t kind) {
+	jm_callbacks* regcb = jm_get_default_callbacks();
+	char realPath[FILENAME_MAX + 2];
+	const char* path;
+	fmi_capi_registry_entry_t* entry;
+
+	assert(dllPath && modelIdentifier);
+	path = jm_portability_get_real_path(cb, dllPath, realPath, sizeof(realPath));
+	if(!path) {
+		path = dllPath;
+	}
+
+	jm_mutex_lock(&registryLock);
+	for(entry = registryHead; entry; entry = entry->next) {
+		if(!entry->isolatedDir && entry->kind == kind && strcmp(entry->dllPath, path) == 0 && strcmp(entry->modelIdentifier, modelIdentifier) == 0) {
+			break;
+		}
+	}
+	if(entry) {
+		if(entry->refCount == 0) {
+			registryUnusedNum--;
+		}
+		entry->refCount++;
+		jm_mutex_unlock(&registryLock);
+		jm_log_verbose(cb, FMI_CAPI_MODULE_NAME, "Reusing loaded FMU binary %s", path);
+		return entry;
+	}
+
+	entry = (fmi_capi_registry_entry_t*)regcb->calloc(1, sizeof(fmi_capi_registry_entry_t));
+	if(entry) {
+		entry->dllPath = (char*)regcb->malloc(strlen(path) + 1);
+		entry->modelIdentifier = (char*)regcb->malloc(strlen(modelIdentifier) + 1);
+	}
+	if(!entry || !entry->dllPath || !entry->modelIdentifier) {
+		jm_mutex_unlock(&registryLock);
+		jm_log_fatal(cb, FMI_CAPI_MODULE_NAME, "Could not allocate memory for the FMU binary registry.");
+		if(entry) fmi_capi_registry_free_entry(entry);
+		return 0;
+	}
+	strcpy(entry->dllPath, path);
+	strcpy(entry->modelIdentifier, modelIdentifier);
+	entry->kind = kind;
+
+	entry->dllHandle = jm_portability_load_dll_handle(path);
+	if(!entry->dllHandle) {
+		char dllError[FMI_CAPI_REGISTRY_ERROR_SIZE];
+		fmi_capi_registry_copy_dll_error(dllError);
+		jm_mutex_unlock(&registryLock);
+		jm_log_fatal(cb, FMI_CAPI_MODULE_NAME, "Could not load the FMU binary: %s", dllError);
+		fmi_capi_registry_free_entry(entry);
+		return 0;
+	}
+	entry->refCount = 1;
+	entry->next = registryHead;
+	registryHead = entry;
+	jm_mutex_unlock(&registryLock);
+
+	jm_log_verbose(cb, FMI_CAPI_MODULE_NAME, "Loaded FMU binary from %s", path);
+	return entry;
+}
+
+/* Get the file name part of a path */
+static const char* fmi_capi_registry_file_name(const char* path) {
+	const char* name = path;
+	const char* p;
+	for(p = path; *p; p++) {
+		if(*p == '/' || *p == '\\') {
+			name = p + 1;
+		}
+	}
+	return name;
+}
+
+fmi_capi_registry_entry_t* fmi_capi_registry_acquire_isolated(jm_callbacks* cb, const char* dllPath, const char* modelIdentifier, fmi_capi_table_kind_enu_t kind) {
+	jm_callbacks* regcb = jm_get_default_callbacks();
+	const char* fileName = fmi_capi_registry_file_name(dllPath);
+	size_t parentLen = fileName - dllPath; /* directory of the library including the separator */
+	fmi_capi_registry_entry_t* entry;
+	size_t dirLen;
+
+	assert(dllPath && modelIdentifier);
+
+	entry = (fmi_capi_registry_entry_t*)regcb->calloc(1, sizeof(fmi_capi_registry_entry_t));
+	if(entry) {
+		dirLen = (parentLen ? parentLen : strlen(".") + strlen(FMI_FILE_SEP)) + strlen("fmil_bin_XXXXXX");
+		entry->isolatedDir = (char*)regcb->malloc(dirLen + 1);
+		entry->dllPath = (char*)regcb->malloc(dirLen + strlen(FMI_FILE_SEP) + strlen(fileName) + 1);
+		entry->modelIdentifier = (char*)regcb->malloc(strlen(modelIdentifier) + 1);
+	}
+	if(!entry || !entry->isolatedDir || !entry->dllPath || !entry->modelIdentifier) {
+		jm_log_fatal(cb, FMI_CAPI_MODULE_NAME, "Could not allocate memory for the FMU binary registry.");
+		if(entry) fmi_capi_registry_free_entry(entry);
+		return 0;
+	}
+	strcpy(entry->modelIdentifier, modelIdentifier);
+	entry->kind = kind;
+
+	/* Each isolated entry loads a private copy of the library, so that the
+	   dynamic loader maps a separate set of global variables for it. The copy is
+	   placed next to the library, where loading is known to work; system temporary
+	   directories are often mounted without execute permission. */
+	if(parentLen) {
+		memcpy(entry->isolatedDir, dllPath, parentLen);
+		strcpy(entry->isolatedDir + parentLen, "fmil_bin_XXXXXX");
+	}
+	else {
+		sprintf(entry->isolatedDir, ".%sfmil_bin_XXXXXX", FMI_FILE_SEP); /*safe*/
+	}
+	if(!jm_mkdtemp(cb, entry->isolatedDir)) {
+		jm_log_fatal(cb, FMI_CAPI_MODULE_NAME, "Could not create a directory for the FMU binary copy next to %s", dllPath);
+		regcb->free(entry->isolatedDir);
+		entry->isolatedDir = 0;
+		fmi_capi_registry_free_entry(entry);
+		return 0;
+	}
+	sprintf(entry->dllPath, "%s%s%s", entry->isolatedDir, FMI_FILE_SEP, fileName); /*safe*/
+	if(jm_copy_file(cb, dllPath, entry->dllPath) != jm_status_success) {
+		jm_rmdir(cb, entry->isolatedDir);
+		fmi_capi_registry_free_entry(entry);
+		return 0;
+	}
+
+	/* The loader error message is kept in a static buffer, so load and copy it under the lock */
+	jm_mutex_lock(&registryLock);
+	entry->dllHandle = jm_portability_load_dll_handle(entry->dllPath);
+	if(!entry->dllHandle) {
+		char dllError[FMI_CAPI_REGISTRY_ERROR_SIZE];
+		fmi_capi_registry_copy_dll_error(dllError);
+		jm_mutex_unlock(&registryLock);
+		jm_log_fatal(cb, FMI_CAPI_MODULE_NAME, "Could not load the private copy %s of the FMU binary %s: %s",
+			entry->dllPath, dllPath, dllError);
+		jm_rmdir(cb, entry->isolatedDir);
+		fmi_capi_registry_free_entry(entry);
+		return 0;
+	}
+	entry->refCount = 1;
+	entry->next = registryHead;
+	registryHead = entry;
+	jm_mutex_unlock(&registryLock);
+
+	jm_log_verbose(cb, FMI_CAPI_MODULE_NAME, "Loaded a private copy of FMU binary %s from %s", dllPath, entry->dllPath);
+	return entry;
+}
+
+void fmi_capi_registry_retain(fmi_capi_registry_entry_t* entry) {
+	jm_mutex_lock(&registryLock);
+	assert(entry->refCount > 0);
+	entry->refCount++;
+	jm_mutex_unlock(&registryLock);
+}
+
+jm_status_enu_t fmi_capi_registry_release(jm_callbacks* cb, fmi_capi_registry_entry_t* entry, int unload) {
+	jm_status_enu_t status = jm_status_success;
+	fmi_capi_registry_entry_t* unloaded = 0;
+	char dllError[FMI_CAPI_REGISTRY_ERROR_SIZE];
+
+	dllError[0] = 0;
+	jm_mutex_lock(&registryLock);
+	assert(entry->refCount > 0);
+	entry->refCount--;
+	if(entry->refCount == 0 && entry->isolatedDir) {
+		/* Private copies are never cached */
+		fmi_capi_registry_unlink(entry);
+		if(unload && jm_portability_free_dll_handle(entry->dllHandle) == jm_status_error) {
+			fmi_capi_registry_copy_dll_error(dllError);
+			status = jm_status_error;
+		}
+		jm_mutex_unlock(&registryLock);
+		if(status == jm_status_error) {
+			jm_log_error(cb, FMI_CAPI_MODULE_NAME, "Could not free the FMU binary: %s", dllError);
+		}
+		if(jm_rmdir(cb, entry->isolatedDir) != jm_status_success) {
+			status = jm_status_error;
+		}
+		fmi_capi_registry_free_entry(entry);
+		return status;
+	}
+	if(entry->refCount == 0) {
+		if(!unload) {
+			/* Keep the library loaded for good, e.g., for valgrind to track leaks */
+			fmi_capi_registry_unlink(entry);
+			fmi_capi_registry_free_entry(entry);
+		}
+		else {
+			entry->lastUse = ++registryTick;
+			registryUnusedNum++;
+			unloaded = fmi_capi_registry_evict(registryMaxUnused, dllError);
+		}
+	}
+	jm_mutex_unlock(&registryLock);
+	return fmi_capi_registry_free_unloaded(cb, unloaded, dllError, 0);
+}
+
+DLL_HANDLE fmi_capi_registry_get_dll_handle(fmi_capi_registry_entry_t* entry) {
+	return entry->dllHandle;
+}
+
+const void* fmi_capi_registry_get_table(fmi_capi_registry_entry_t* entry, size_t size, fmi_capi_resolve_ft resolve, void* context) {
+	const void* table;
+
+	jm_mutex_lock(&registryLock);
+	if(!entry->table) {
+		void* t = jm_get_default_callbacks()->calloc(1, size);
+		if(t && resolve(entry->dllHandle, t, context) != jm_status_error) {
+			entry->table = t;
+		}
+		else {
+			jm_get_default_callbacks()->free(t);
+		}
+	}
+	table = entry->table;
+	jm_mutex_unlock(&registryLock);
+	return table;
+}
+
+void fmi_capi_registry_set_max_unused(size_t maxUnused) {
+	fmi_capi_registry_entry_t* unloaded;
+	char dllError[FMI_CAPI_REGISTRY_ERROR_SIZE];
+
+	dllError[0] = 0;
+	jm_mutex_lock(&registryLock);
+	registryMaxUnused = maxUnused;
+	unloaded = fmi_capi_registry_evict(registryMaxUnused, dllError);
+	jm_mutex_unlock(&registryLock);
+	fmi_capi_registry_free_unloaded(jm_get_default_callbacks(), unloaded, dllError, 0);
+}
+
+size_t fmi_capi_registry_get_max_unused(void) {
+	size_t n;
+	jm_mutex_lock(&registryLock);
+	n = registryMaxUnused;
+	jm_mutex_unlock(&registryLock);
+	return n;
+}
+
+size_t fmi_capi_registry_evict_unused(void) {
+	size_t evicted = 0;
+	fmi_capi_registry_entry_t* unloaded;
+	char dllError[FMI_CAPI_REGISTRY_ERROR_SIZE];
+
+	dllError[0] = 0;
+	jm_mutex_lock(&registryLock);
+	unloaded = fmi_capi_registry_evict(0, dllError);
+	jm_mutex_unlock(&registryLock);
+	fmi_capi_registry_free_unloaded(jm_get_default_callbacks(), unloaded, dllError, &evicted);
+	return evicted;
+}
+
+size_t fmi_capi_registry_get_entries_num(void) {
+	size_t n = 0;
+	fmi_capi_registry_entry_t* e;
+	jm_mutex_lock(&registryLock);
+	for(e = registryHead; e; e = e->next) {
+		n++;
+	}
+	jm_mutex_unlock(&registryLock);
+	return n;
+}
@@ -20,6 +20,7 @@ extern "C" {
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <stddef.h>
 #include <assert.h>
 
 #include <JM/jm_types.h>
@@ -135,6 +136,36 @@ static jm_status_enu_t fmi1_capi_load_me_fcn(fmi1_capi_t* fmu)
 	return jm_status;
 }
 
+/* Resolve the shared function table of a registry entry. The table is a C-API struct
+   where only the function pointers are set. */
+static jm_status_enu_t fmi1_capi_resolve_fcn(DLL_HANDLE dllHandle, void* table, void* context)
+{
+	fmi1_capi_t* fmu = (fmi1_capi_t*)context;
+	fmi1_capi_t* tbl = (fmi1_capi_t*)table;
+	jm_status_enu_t status;
+
+	tbl->callbacks = fmu->callbacks;
+	tbl->modelIdentifier = fmu->modelIdentifier;
+	tbl->dllHandle = dllHandle;
+	if (fmu->standard == fmi1_fmu_kind_enu_me) {
+		status = fmi1_capi_load_me_fcn(tbl);
+	} else {
+		status = fmi1_capi_load_cs_fcn(tbl);
+	}
+	tbl->callbacks = 0;
+	tbl->modelIdentifier = 0;
+	tbl->dllHandle = 0;
+	return status;
+}
+
+/* Copy the function pointers from a function table */
+void fmi1_capi_copy_fcn(fmi1_capi_t* fmu, const fmi1_capi_t* tbl)
+{
+	size_t first = offsetof(fmi1_capi_t, fmiGetVersion);
+
+	memcpy((char*)fmu + first, (const char*)tbl + first, sizeof(fmi1_capi_t) - first);
+}
+
 void fmi1_capi_destroy_dllfmu(fmi1_capi_t* fmu)
 {
 	if (fmu == NULL) {
@@ -142,6 +173,7 @@ void fmi1_capi_destroy_dllfmu(fmi1_capi_t* fmu)
 	}
 	fmi1_capi_free_dll(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Releasing allocated memory");
+	fmi1_capi_trace_free(fmu);
 	fmu->callbacks->free((void*)fmu->dllPath);
 	fmu->callbacks->free((void*)fmu->modelIdentifier);
 	fmu->callbacks->free((void*)fmu);
@@ -205,29 +237,38 @@ fmi1_capi_t* fmi1_capi_create_dllfmu(jm_callbacks* cb, const char* dllPath, cons
 
 jm_status_enu_t fmi1_capi_load_fcn(fmi1_capi_t* fmu)
 {
-	assert(fmu);
-	/* Load ME functions */
-	if (fmu->standard == fmi1_fmu_kind_enu_me) {
-		return fmi1_capi_load_me_fcn(fmu);
-	/* Load CS functions */
-	} else if (fmu->standard == fmi1_fmu_kind_enu_cs_standalone || fmu->standard == fmi1_fmu_kind_enu_cs_tool) {
-		return fmi1_capi_load_cs_fcn(fmu);
-	} else {
+	const fmi1_capi_t* tbl;
+
+	assert(fmu && fmu->registryEntry);
+	if (fmu->standard != fmi1_fmu_kind_enu_me && fmu->standard != fmi1_fmu_kind_enu_cs_standalone && fmu->standard != fmi1_fmu_kind_enu_cs_tool) {
 		return jm_status_error;
 	}
+
+	/* The function table is resolved once per loaded binary */
+	tbl = (const fmi1_capi_t*)fmi_capi_registry_get_table(fmu->registryEntry, sizeof(fmi1_capi_t), fmi1_capi_resolve_fcn, fmu);
+	if (tbl == NULL) {
+		return jm_status_error;
+	}
+	fmi1_capi_copy_fcn(fmu, tbl);
+	return jm_status_success;
 }
 
 jm_status_enu_t fmi1_capi_load_dll(fmi1_capi_t* fmu)
 {
 	assert(fmu && fmu->dllPath);
-	fmu->dllHandle = jm_portability_load_dll_handle(fmu->dllPath); /* Load the shared library */
-	if (fmu->dllHandle == NULL) {
-		jm_log_fatal(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Could not load the FMU binary: %s", jm_portability_get_last_dll_error());
-		return jm_status_error;
+	/* Load the shared library or get the already loaded one */
+	if (fmu->isolationMode) {
+		fmu->registryEntry = fmi_capi_registry_acquire_isolated(fmu->callbacks, fmu->dllPath, fmu->modelIdentifier,
+			(fmu->standard == fmi1_fmu_kind_enu_me) ? fmi_capi_table_fmi1_me : fmi_capi_table_fmi1_cs);
 	} else {
-		jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Loaded FMU binary from %s", fmu->dllPath);
-		return jm_status_success;
+		fmu->registryEntry = fmi_capi_registry_acquire(fmu->callbacks, fmu->dllPath, fmu->modelIdentifier,
+			(fmu->standard == fmi1_fmu_kind_enu_me) ? fmi_capi_table_fmi1_me : fmi_capi_table_fmi1_cs);
+	}
+	if (fmu->registryEntry == NULL) {
+		return jm_status_error;
 	}
+	fmu->dllHandle = fmi_capi_registry_get_dll_handle(fmu->registryEntry);
+	return jm_status_success;
 }
 
 void fmi1_capi_set_debug_mode(fmi1_capi_t* fmu, int mode) {
@@ -240,26 +281,29 @@ int fmi1_capi_get_debug_mode(fmi1_capi_t* fmu) {
 	return 0;
 }
 
+void fmi1_capi_set_isolation_mode(fmi1_capi_t* fmu, int mode) {
+	if(fmu)
+		fmu->isolationMode = mode;
+}
+
+int fmi1_capi_get_isolation_mode(fmi1_capi_t* fmu) {
+	if(fmu) return fmu->isolationMode;
+	return 0;
+}
+
 jm_status_enu_t fmi1_capi_free_dll(fmi1_capi_t* fmu)
 {
 	if (fmu == NULL) {
 		return jm_status_error; /* Return without writing any log message */
 	}
 
-	if (fmu->dllHandle) {
-		jm_status_enu_t status =
-			(fmu->debugMode != 0) ?
-                /* When running valgrind this may be convenient to track mem leaks */
-                jm_status_success:
-                jm_portability_free_dll_handle(fmu->dllHandle);
+	if (fmu->registryEntry) {
+		/* The binary is unloaded when the last user releases it. In debug mode it is
+		   never unloaded since, when running valgrind, this may be convenient to track mem leaks. */
+		jm_status_enu_t status = fmi_capi_registry_release(fmu->callbacks, fmu->registryEntry, fmu->debugMode == 0);
+		fmu->registryEntry = 0;
 		fmu->dllHandle = 0;
-		if (status == jm_status_error) { /* Free the library handle */
-			jm_log(fmu->callbacks, FMI_CAPI_MODULE_NAME, jm_log_level_error, "Could not free the FMU binary: %s", jm_portability_get_last_dll_error());
-			return jm_status_error;
-		} else {
-			jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Successfully unloaded FMU binary");
-			return jm_status_success;
-		}
+		return status;
 	}
 	return jm_status_success;
 }
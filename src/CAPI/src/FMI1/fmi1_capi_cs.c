@@ -22,7 +22,10 @@ extern "C" {
 
 fmi1_component_t fmi1_capi_instantiate_slave(fmi1_capi_t* fmu, fmi1_string_t instanceName, fmi1_string_t fmuGUID, fmi1_string_t fmuLocation, fmi1_string_t mimeType, fmi1_real_t timeout, fmi1_boolean_t visible, fmi1_boolean_t interactive, fmi1_boolean_t loggingOn)
 {
-	return fmu->c = fmu->fmiInstantiateSlave(instanceName, fmuGUID, fmuLocation, mimeType, timeout, visible, interactive, fmu->callBackFunctions, loggingOn);
+	double start = fmu->trace ? jm_portability_get_time() : 0;
+	fmu->c = fmu->fmiInstantiateSlave(instanceName, fmuGUID, fmuLocation, mimeType, timeout, visible, interactive, fmu->callBackFunctions, loggingOn);
+	if(fmu->trace) fmi1_capi_trace_instantiated(fmu, instanceName, start);
+	return fmi1_capi_get_component(fmu);
 }
 
 void fmi1_capi_free_slave_instance(fmi1_capi_t* fmu)
@@ -27,6 +27,7 @@ extern "C" {
 #include <FMI1/fmi1_capi.h>
 #include <JM/jm_portability.h>
 #include <JM/jm_callbacks.h>
+#include <FMI/fmi_capi_registry.h>
 
 #define FMI_CAPI_MODULE_NAME "FMICAPI"
 
@@ -41,12 +42,17 @@ struct fmi1_capi_t {
 	jm_callbacks* callbacks;
 
 	DLL_HANDLE dllHandle;
+	fmi_capi_registry_entry_t* registryEntry; /* holds the reference to dllHandle */
 
 	fmi1_fmu_kind_enu_t standard;
 
 	fmi1_component_t					c;
 
 	int debugMode;
+	int isolationMode; /* load a private copy of the shared library */
+	struct fmi1_capi_trace_t* trace; /* call statistics and the untraced functions, see fmi1_capi_trace.c */
+
+	/* The function pointers must stay last, starting with fmiGetVersion, see fmi1_capi_copy_fcn() */
 
 	/* FMI common */
 	fmi1_get_version_ft					fmiGetVersion;
@@ -95,6 +101,15 @@ struct fmi1_capi_t {
 
 };
 
+/* Copy the function pointers from a function table */
+void fmi1_capi_copy_fcn(fmi1_capi_t* fmu, const fmi1_capi_t* tbl);
+
+/* Hide a new component behind the trace and record the instantiation that started at startTime */
+void fmi1_capi_trace_instantiated(fmi1_capi_t* fmu, const char* instanceName, double startTime);
+
+/* Free the call statistics */
+void fmi1_capi_trace_free(fmi1_capi_t* fmu);
+
 #ifdef __cplusplus 
 }
 #endif
@@ -24,12 +24,16 @@ extern "C" {
 fmi1_component_t fmi1_capi_instantiate_model(fmi1_capi_t* fmu, fmi1_string_t instanceName, fmi1_string_t GUID, fmi1_boolean_t loggingOn)
 {
 	fmi1_me_callback_functions_t cb;
+	double start;
 	assert(fmu);
+	start = fmu->trace ? jm_portability_get_time() : 0;
 	cb.logger = fmu->callBackFunctions.logger;
     cb.allocateMemory = fmu->callBackFunctions.allocateMemory;
     cb.freeMemory = fmu->callBackFunctions.freeMemory;
 	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiInstantiateModel");
-	return fmu->c = fmu->fmiInstantiateModel(instanceName, GUID, cb, loggingOn);
+	fmu->c = fmu->fmiInstantiateModel(instanceName, GUID, cb, loggingOn);
+	if(fmu->trace) fmi1_capi_trace_instantiated(fmu, instanceName, start);
+	return fmi1_capi_get_component(fmu);
 }
 
 void fmi1_capi_free_model_instance(fmi1_capi_t* fmu)
@@ -0,0 +1,240 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+#include <assert.h>
+
+#include <JM/jm_portability.h>
+#include <FMI/fmi_call_stats.h>
+#include <FMI/fmi_trace_recorder.h>
+
+#include <FMI1/fmi1_capi_impl.h>
+
+/* Functions taking a component, except the free instance functions that return no status */
+#define FMI1_TRACE_SHIMMED(X) \
+	X(fmiSetDebugLogging) \
+	X(fmiSetReal) X(fmiSetInteger) X(fmiSetBoolean) X(fmiSetString) \
+	X(fmiGetReal) X(fmiGetInteger) X(fmiGetBoolean) X(fmiGetString) \
+	X(fmiSetTime) X(fmiSetContinuousStates) X(fmiCompletedIntegratorStep) X(fmiInitialize) \
+	X(fmiGetDerivatives) X(fmiGetEventIndicators) X(fmiEventUpdate) X(fmiGetContinuousStates) \
+	X(fmiGetNominalContinuousStates) X(fmiGetStateValueReferences) X(fmiTerminate) \
+	X(fmiInitializeSlave) X(fmiTerminateSlave) X(fmiResetSlave) \
+	X(fmiSetRealInputDerivatives) X(fmiGetRealOutputDerivatives) X(fmiDoStep) X(fmiCancelStep) \
+	X(fmiGetStatus) X(fmiGetRealStatus) X(fmiGetIntegerStatus) X(fmiGetBooleanStatus) X(fmiGetStringStatus)
+
+#define FMI1_TRACE_ID(FCN) fmi1_trace_##FCN,
+#define FMI1_TRACE_NAME(FCN) #FCN,
+
+typedef enum fmi1_trace_id_enu_t {
+	fmi1_trace_fmiInstantiate,
+	fmi1_trace_fmiFreeModelInstance,
+	fmi1_trace_fmiFreeSlaveInstance,
+	FMI1_TRACE_SHIMMED(FMI1_TRACE_ID)
+	fmi1_trace_num
+} fmi1_trace_id_enu_t;
+
+static const char* fmi1_trace_names[] = {
+	"fmiInstantiate",
+	"fmiFreeModelInstance",
+	"fmiFreeSlaveInstance",
+	FMI1_TRACE_SHIMMED(FMI1_TRACE_NAME)
+};
+
+/* While tracing is on, the component passed to the functions is the trace */
+typedef struct fmi1_capi_trace_t {
+	fmi1_capi_t orig;     /* the untraced function pointers */
+	fmi1_component_t c;   /* the component returned by the instantiate function */
+	int enabled;
+	char name[FMI_TRACE_RECORDER_CATEGORY_MAX + 1]; /* category of the recorded slices */
+	fmi_call_stats_t stats[fmi1_trace_num];
+} fmi1_capi_trace_t;
+
+static void fmi1_capi_trace_record(fmi1_capi_trace_t* trace, fmi1_trace_id_enu_t id, double start)
+{
+	double end = jm_portability_get_time();
+	fmi_call_stats_record(&trace->stats[id], end - start);
+	fmi_trace_recorder_slice(fmi1_trace_names[id], trace->name, start, end);
+}
+
+/* Shim calling the untraced function with the real component and timing the call */
+#define FMI1_TRACE_SHIM(FCN, PARAMS, ARGS) \
+static fmi1_status_t fmi1_trace_shim_##FCN PARAMS \
+{ \
+	fmi1_capi_trace_t* trace = (fmi1_capi_trace_t*)c; \
+	double start = jm_portability_get_time(); \
+	fmi1_status_t status = trace->orig.FCN ARGS; \
+	fmi1_capi_trace_record(trace, fmi1_trace_##FCN, start); \
+	return status; \
+}
+
+/* The component is gone after the free instance functions */
+#define FMI1_TRACE_SHIM_FREE(FCN) \
+static void fmi1_trace_shim_##FCN(fmi1_component_t c) \
+{ \
+	fmi1_capi_trace_t* trace = (fmi1_capi_trace_t*)c; \
+	double start = jm_portability_get_time(); \
+	trace->orig.FCN(trace->c); \
+	fmi1_capi_trace_record(trace, fmi1_trace_##FCN, start); \
+	trace->c = 0; \
+}
+
+#define FMI1_TRACE_SHIM_VR(FCN, FTYPE) \
+	FMI1_TRACE_SHIM(FCN, (fmi1_component_t c, const fmi1_value_reference_t vr[], size_t nvr, FTYPE value[]), (trace->c, vr, nvr, value))
+
+#define FMI1_TRACE_SHIM_STATUS(FCN, FTYPE) \
+	FMI1_TRACE_SHIM(FCN, (fmi1_component_t c, const fmi1_status_kind_t s, FTYPE* value), (trace->c, s, value))
+
+#define FMI1_TRACE_SHIM_ARRAY(FCN) \
+	FMI1_TRACE_SHIM(FCN, (fmi1_component_t c, fmi1_real_t x[], size_t nx), (trace->c, x, nx))
+
+#define FMI1_TRACE_SHIM_VOID(FCN) \
+	FMI1_TRACE_SHIM(FCN, (fmi1_component_t c), (trace->c))
+
+FMI1_TRACE_SHIM(fmiSetDebugLogging, (fmi1_component_t c, fmi1_boolean_t loggingOn), (trace->c, loggingOn))
+
+FMI1_TRACE_SHIM_VR(fmiSetReal, const fmi1_real_t)
+FMI1_TRACE_SHIM_VR(fmiSetInteger, const fmi1_integer_t)
+FMI1_TRACE_SHIM_VR(fmiSetBoolean, const fmi1_boolean_t)
+FMI1_TRACE_SHIM_VR(fmiSetString, const fmi1_string_t)
+FMI1_TRACE_SHIM_VR(fmiGetReal, fmi1_real_t)
+FMI1_TRACE_SHIM_VR(fmiGetInteger, fmi1_integer_t)
+FMI1_TRACE_SHIM_VR(fmiGetBoolean, fmi1_boolean_t)
+FMI1_TRACE_SHIM_VR(fmiGetString, fmi1_string_t)
+
+FMI1_TRACE_SHIM_FREE(fmiFreeModelInstance)
+FMI1_TRACE_SHIM(fmiSetTime, (fmi1_component_t c, fmi1_real_t time), (trace->c, time))
+FMI1_TRACE_SHIM(fmiSetContinuousStates, (fmi1_component_t c, const fmi1_real_t x[], size_t nx), (trace->c, x, nx))
+FMI1_TRACE_SHIM(fmiCompletedIntegratorStep, (fmi1_component_t c, fmi1_boolean_t* callEventUpdate), (trace->c, callEventUpdate))
+FMI1_TRACE_SHIM(fmiInitialize, (fmi1_component_t c, fmi1_boolean_t toleranceControlled, fmi1_real_t relativeTolerance,
+	fmi1_event_info_t* eventInfo), (trace->c, toleranceControlled, relativeTolerance, eventInfo))
+FMI1_TRACE_SHIM_ARRAY(fmiGetDerivatives)
+FMI1_TRACE_SHIM_ARRAY(fmiGetEventIndicators)
+FMI1_TRACE_SHIM(fmiEventUpdate, (fmi1_component_t c, fmi1_boolean_t intermediateResults, fmi1_event_info_t* eventInfo),
+	(trace->c, intermediateResults, eventInfo))
+FMI1_TRACE_SHIM_ARRAY(fmiGetContinuousStates)
+FMI1_TRACE_SHIM_ARRAY(fmiGetNominalContinuousStates)
+FMI1_TRACE_SHIM(fmiGetStateValueReferences, (fmi1_component_t c, fmi1_value_reference_t vrx[], size_t nx), (trace->c, vrx, nx))
+FMI1_TRACE_SHIM_VOID(fmiTerminate)
+
+FMI1_TRACE_SHIM(fmiInitializeSlave, (fmi1_component_t c, fmi1_real_t tStart, fmi1_boolean_t StopTimeDefined, fmi1_real_t tStop),
+	(trace->c, tStart, StopTimeDefined, tStop))
+FMI1_TRACE_SHIM_VOID(fmiTerminateSlave)
+FMI1_TRACE_SHIM_VOID(fmiResetSlave)
+FMI1_TRACE_SHIM_FREE(fmiFreeSlaveInstance)
+FMI1_TRACE_SHIM(fmiSetRealInputDerivatives, (fmi1_component_t c, const fmi1_value_reference_t vr[], size_t nvr,
+	const fmi1_integer_t order[], const fmi1_real_t value[]), (trace->c, vr, nvr, order, value))
+FMI1_TRACE_SHIM(fmiGetRealOutputDerivatives, (fmi1_component_t c, const fmi1_value_reference_t vr[], size_t nvr,
+	const fmi1_integer_t order[], fmi1_real_t value[]), (trace->c, vr, nvr, order, value))
+FMI1_TRACE_SHIM(fmiDoStep, (fmi1_component_t c, fmi1_real_t currentCommunicationPoint, fmi1_real_t communicationStepSize,
+	fmi1_boolean_t newStep), (trace->c, currentCommunicationPoint, communicationStepSize, newStep))
+FMI1_TRACE_SHIM_VOID(fmiCancelStep)
+FMI1_TRACE_SHIM_STATUS(fmiGetStatus, fmi1_status_t)
+FMI1_TRACE_SHIM_STATUS(fmiGetRealStatus, fmi1_real_t)
+FMI1_TRACE_SHIM_STATUS(fmiGetIntegerStatus, fmi1_integer_t)
+FMI1_TRACE_SHIM_STATUS(fmiGetBooleanStatus, fmi1_boolean_t)
+FMI1_TRACE_SHIM_STATUS(fmiGetStringStatus, fmi1_string_t)
+
+/* Point the functions that are present in the untraced table to the shims */
+#define FMI1_TRACE_SWAP(FCN) if(trace->orig.FCN) fmu->FCN = fmi1_trace_shim_##FCN;
+
+static void fmi1_capi_trace_reset(fmi1_capi_trace_t* trace)
+{
+	size_t i;
+	memset(trace->stats, 0, sizeof(trace->stats));
+	for(i = 0; i < fmi1_trace_num; i++) {
+		trace->stats[i].name = fmi1_trace_names[i];
+	}
+}
+
+jm_status_enu_t fmi1_capi_set_tracing(fmi1_capi_t* fmu, int enable)
+{
+	fmi1_capi_trace_t* trace;
+
+	assert(fmu);
+	if(!fmu->trace) {
+		if(!enable) return jm_status_success;
+		fmu->trace = (fmi1_capi_trace_t*)fmu->callbacks->calloc(1, sizeof(fmi1_capi_trace_t));
+		if(!fmu->trace) {
+			jm_log_fatal(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Could not allocate memory for the call statistics");
+			return jm_status_error;
+		}
+		fmi1_capi_trace_reset(fmu->trace);
+		strncpy(fmu->trace->name, fmu->modelIdentifier, FMI_TRACE_RECORDER_CATEGORY_MAX);
+	}
+	trace = fmu->trace;
+	if(!enable == !trace->enabled) return jm_status_success;
+
+	if(enable) {
+		trace->orig = *fmu;
+		trace->c = fmu->c;
+		if(fmu->c) fmu->c = (fmi1_component_t)trace;
+		FMI1_TRACE_SWAP(fmiFreeModelInstance)
+		FMI1_TRACE_SWAP(fmiFreeSlaveInstance)
+		FMI1_TRACE_SHIMMED(FMI1_TRACE_SWAP)
+	}
+	else {
+		fmi1_capi_copy_fcn(fmu, &trace->orig);
+		fmu->c = trace->c;
+	}
+	trace->enabled = enable ? 1 : 0;
+	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Call tracing %s", enable ? "on" : "off");
+	return jm_status_success;
+}
+
+int fmi1_capi_get_tracing(fmi1_capi_t* fmu)
+{
+	return fmu && fmu->trace && fmu->trace->enabled;
+}
+
+size_t fmi1_capi_get_call_stats(fmi1_capi_t* fmu, fmi_call_stats_t stats[], size_t n)
+{
+	size_t i;
+	for(i = 0; i < n && i < fmi1_trace_num; i++) {
+		if(fmu && fmu->trace) {
+			stats[i] = fmu->trace->stats[i];
+		}
+		else {
+			memset(&stats[i], 0, sizeof(stats[i]));
+			stats[i].name = fmi1_trace_names[i];
+		}
+	}
+	return fmi1_trace_num;
+}
+
+void fmi1_capi_reset_call_stats(fmi1_capi_t* fmu)
+{
+	if(fmu && fmu->trace) fmi1_capi_trace_reset(fmu->trace);
+}
+
+fmi1_component_t fmi1_capi_get_component(fmi1_capi_t* fmu)
+{
+	return (fmu->trace && fmu->trace->enabled) ? fmu->trace->c : fmu->c;
+}
+
+void fmi1_capi_trace_instantiated(fmi1_capi_t* fmu, const char* instanceName, double startTime)
+{
+	fmi1_capi_trace_t* trace = fmu->trace;
+	if(!trace || !trace->enabled) return;
+	if(instanceName) strncpy(trace->name, instanceName, FMI_TRACE_RECORDER_CATEGORY_MAX);
+	fmi1_capi_trace_record(trace, fmi1_trace_fmiInstantiate, startTime);
+	trace->c = fmu->c;
+	if(fmu->c) fmu->c = (fmi1_component_t)trace;
+}
+
+void fmi1_capi_trace_free(fmi1_capi_t* fmu)
+{
+	fmu->callbacks->free(fmu->trace);
+	fmu->trace = 0;
+}
@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <stddef.h>
 #include <assert.h>
 
 #include <JM/jm_types.h>
@@ -37,28 +38,34 @@ static jm_status_enu_t fmi2_capi_get_fcn(fmi2_capi_t* fmu, const char* function_
 		return jm_status;
 }
 
-static void fmi2_capi_get_fcn_with_flag(fmi2_capi_t* fmu, const char* function_name,
+/* Functions controlled by capability flags are resolved if present. The flags are checked
+   for each C-API struct separately since the function table is shared. */
+static void fmi2_capi_check_fcn_with_flag(fmi2_capi_t* fmu, const char* function_name,
 													jm_dll_function_ptr* dll_function_ptrptr,
 													unsigned int capabilities[],
 													fmi2_capabilities_enu_t flag) {
-	jm_status_enu_t status = jm_status_success;
-	if(capabilities[flag]) {
-		fmi2_capi_get_fcn(fmu, function_name, dll_function_ptrptr, &status);
-		if(status != jm_status_success) {
-			jm_log_warning(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Resetting flag '%s'", fmi2_capability_to_string(flag));
-			capabilities[flag] = 0;
-		}
+	if(!capabilities[flag]) {
+		*dll_function_ptrptr = 0;
+	}
+	else if(!*dll_function_ptrptr) {
+		jm_log_error(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Could not load the FMI function '%s'.", function_name);
+		jm_log_warning(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Resetting flag '%s'", fmi2_capability_to_string(flag));
+		capabilities[flag] = 0;
 	}
 }
 
 /* Load FMI functions from DLL macro */
 #define LOAD_DLL_FUNCTION(FMIFUNCTION) fmi2_capi_get_fcn(fmu, #FMIFUNCTION, (jm_dll_function_ptr*)&fmu->FMIFUNCTION, &jm_status)
 
-/* Load FMI functions from DLL macro for functions controlled by capability flags */
-#define LOAD_DLL_FUNCTION_WITH_FLAG(FMIFUNCTION, FLAG) \
-	fmi2_capi_get_fcn_with_flag(fmu, #FMIFUNCTION, (jm_dll_function_ptr*)&fmu->FMIFUNCTION, capabilities, FLAG)
+/* Load FMI functions from DLL macro for functions controlled by capability flags, see CHECK_DLL_FUNCTION_WITH_FLAG */
+#define LOAD_DLL_FUNCTION_OPTIONAL(FMIFUNCTION) \
+	jm_portability_load_dll_function(fmu->dllHandle, #FMIFUNCTION, (jm_dll_function_ptr*)&fmu->FMIFUNCTION)
 
-static jm_status_enu_t fmi2_capi_load_common_fcn(fmi2_capi_t* fmu, unsigned int capabilities[])
+/* Check an optional FMI function against its capability flag */
+#define CHECK_DLL_FUNCTION_WITH_FLAG(FMIFUNCTION, FLAG) \
+	fmi2_capi_check_fcn_with_flag(fmu, #FMIFUNCTION, (jm_dll_function_ptr*)&fmu->FMIFUNCTION, capabilities, FLAG)
+
+static jm_status_enu_t fmi2_capi_load_common_fcn(fmi2_capi_t* fmu)
 {
 	jm_status_enu_t jm_status = jm_status_success;
 	/***************************************************
@@ -118,13 +125,13 @@ Types for Common Functions
 }
 
 /* Load FMI 2.0 Co-Simulation functions */
-static jm_status_enu_t fmi2_capi_load_cs_fcn(fmi2_capi_t* fmu, unsigned int capabilities[])
+static jm_status_enu_t fmi2_capi_load_cs_fcn(fmi2_capi_t* fmu)
 {
 	jm_status_enu_t jm_status = jm_status_success;
 
 	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Loading functions for the co-simulation interface");
 
-	jm_status = fmi2_capi_load_common_fcn(fmu, capabilities);
+	jm_status = fmi2_capi_load_common_fcn(fmu);
 
 	/* Getting and setting the internal FMU state */
 /*   typedef fmi2Status fmi2GetFMUstateTYPE           (fmi2Component, fmi2FMUstate*);
@@ -133,18 +140,18 @@ static jm_status_enu_t fmi2_capi_load_cs_fcn(fmi2_capi_t* fmu, unsigned int capa
    typedef fmi2Status fmi2SerializedFMUstateSizeTYPE(fmi2Component, fmi2FMUstate, size_t*);
    typedef fmi2Status fmi2SerializeFMUstateTYPE     (fmi2Component, fmi2FMUstate, fmi2Byte[], size_t);
    typedef fmi2Status fmi2DeSerializeFMUstateTYPE   (fmi2Component, const fmi2Byte[], size_t, fmi2FMUstate*); */
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2GetFMUstate,fmi2_cs_canGetAndSetFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2SetFMUstate,fmi2_cs_canGetAndSetFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2FreeFMUstate,fmi2_cs_canGetAndSetFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2SerializedFMUstateSize,fmi2_cs_canSerializeFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2SerializeFMUstate,fmi2_cs_canSerializeFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2DeSerializeFMUstate,fmi2_cs_canSerializeFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2GetFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2SetFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2FreeFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2SerializedFMUstateSize);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2SerializeFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2DeSerializeFMUstate);
 
 /* Getting directional derivatives */
 /*   typedef fmi2Status fmi2GetDirectionalDerivativeTYPE(fmi2Component, const fmi2ValueReference[], size_t,
                                                                    const fmi2ValueReference[], size_t,
                                                                    const fmi2Real[], fmi2Real[]);*/
-    LOAD_DLL_FUNCTION_WITH_FLAG(fmi2GetDirectionalDerivative,fmi2_cs_providesDirectionalDerivatives);
+    LOAD_DLL_FUNCTION_OPTIONAL(fmi2GetDirectionalDerivative);
 
 /* Simulating the slave */
 /*   typedef fmi2Status fmi2SetRealInputDerivativesTYPE (fmi2Component, const fmi2ValueReference [], size_t, const fmi2Integer [], const fmi2Real []);
@@ -173,13 +180,13 @@ static jm_status_enu_t fmi2_capi_load_cs_fcn(fmi2_capi_t* fmu, unsigned int capa
 }
 
 /* Load FMI 2.0 Model Exchange functions */
-static jm_status_enu_t fmi2_capi_load_me_fcn(fmi2_capi_t* fmu, unsigned int capabilities[])
+static jm_status_enu_t fmi2_capi_load_me_fcn(fmi2_capi_t* fmu)
 {
 	jm_status_enu_t jm_status = jm_status_success;
 
 	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Loading functions for the model exchange interface");
 
-	jm_status = fmi2_capi_load_common_fcn(fmu, capabilities);
+	jm_status = fmi2_capi_load_common_fcn(fmu);
 		/* Getting and setting the internal FMU state */
 /*   typedef fmi2Status fmi2GetFMUstateTYPE           (fmi2Component, fmi2FMUstate*);
    typedef fmi2Status fmi2SetFMUstateTYPE           (fmi2Component, fmi2FMUstate);
@@ -187,18 +194,18 @@ static jm_status_enu_t fmi2_capi_load_me_fcn(fmi2_capi_t* fmu, unsigned int capa
    typedef fmi2Status fmi2SerializedFMUstateSizeTYPE(fmi2Component, fmi2FMUstate, size_t*);
    typedef fmi2Status fmi2SerializeFMUstateTYPE     (fmi2Component, fmi2FMUstate, fmi2Byte[], size_t);
    typedef fmi2Status fmi2DeSerializeFMUstateTYPE   (fmi2Component, const fmi2Byte[], size_t, fmi2FMUstate*); */
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2GetFMUstate,fmi2_me_canGetAndSetFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2SetFMUstate,fmi2_me_canGetAndSetFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2FreeFMUstate,fmi2_me_canGetAndSetFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2SerializedFMUstateSize,fmi2_me_canSerializeFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2SerializeFMUstate,fmi2_me_canSerializeFMUstate);
-   LOAD_DLL_FUNCTION_WITH_FLAG(fmi2DeSerializeFMUstate,fmi2_me_canSerializeFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2GetFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2SetFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2FreeFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2SerializedFMUstateSize);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2SerializeFMUstate);
+   LOAD_DLL_FUNCTION_OPTIONAL(fmi2DeSerializeFMUstate);
 
 /* Getting directional derivatives */
 /*   typedef fmi2Status fmi2GetDirectionalDerivativeTYPE(fmi2Component, const fmi2ValueReference[], size_t,
                                                                    const fmi2ValueReference[], size_t,
                                                                    const fmi2Real[], fmi2Real[]); */
-    LOAD_DLL_FUNCTION_WITH_FLAG(fmi2GetDirectionalDerivative,fmi2_me_providesDirectionalDerivatives);
+    LOAD_DLL_FUNCTION_OPTIONAL(fmi2GetDirectionalDerivative);
 
 /* Enter and exit the different modes */
 /*   typedef fmi2Status fmi2EnterEventModeTYPE         (fmi2Component);
@@ -231,6 +238,57 @@ static jm_status_enu_t fmi2_capi_load_me_fcn(fmi2_capi_t* fmu, unsigned int capa
 	return jm_status;
 }
 
+/* Check the optional functions against the capability flags of this C-API struct */
+static void fmi2_capi_check_fcn_flags(fmi2_capi_t* fmu, unsigned int capabilities[])
+{
+	if (fmu->standard == fmi2_fmu_kind_me) {
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2GetFMUstate,fmi2_me_canGetAndSetFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2SetFMUstate,fmi2_me_canGetAndSetFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2FreeFMUstate,fmi2_me_canGetAndSetFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2SerializedFMUstateSize,fmi2_me_canSerializeFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2SerializeFMUstate,fmi2_me_canSerializeFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2DeSerializeFMUstate,fmi2_me_canSerializeFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2GetDirectionalDerivative,fmi2_me_providesDirectionalDerivatives);
+	} else {
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2GetFMUstate,fmi2_cs_canGetAndSetFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2SetFMUstate,fmi2_cs_canGetAndSetFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2FreeFMUstate,fmi2_cs_canGetAndSetFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2SerializedFMUstateSize,fmi2_cs_canSerializeFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2SerializeFMUstate,fmi2_cs_canSerializeFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2DeSerializeFMUstate,fmi2_cs_canSerializeFMUstate);
+		CHECK_DLL_FUNCTION_WITH_FLAG(fmi2GetDirectionalDerivative,fmi2_cs_providesDirectionalDerivatives);
+	}
+}
+
+/* Resolve the shared function table of a registry entry. The table is a C-API struct
+   where only the function pointers are set. */
+static jm_status_enu_t fmi2_capi_resolve_fcn(DLL_HANDLE dllHandle, void* table, void* context)
+{
+	fmi2_capi_t* fmu = (fmi2_capi_t*)context;
+	fmi2_capi_t* tbl = (fmi2_capi_t*)table;
+	jm_status_enu_t status;
+
+	tbl->callbacks = fmu->callbacks;
+	tbl->dllHandle = dllHandle;
+	if (fmu->standard == fmi2_fmu_kind_me) {
+		status = fmi2_capi_load_me_fcn(tbl);
+	} else {
+		status = fmi2_capi_load_cs_fcn(tbl);
+	}
+	tbl->callbacks = 0;
+	tbl->dllHandle = 0;
+	return status;
+}
+
+/* Copy the function pointers from a function table. They are the last fields of the struct,
+   starting with fmi2GetVersion, so the fields before them are never touched. */
+void fmi2_capi_copy_fcn(fmi2_capi_t* fmu, const fmi2_capi_t* tbl)
+{
+	size_t first = offsetof(fmi2_capi_t, fmi2GetVersion);
+
+	memcpy((char*)fmu + first, (const char*)tbl + first, sizeof(fmi2_capi_t) - first);
+}
+
 void fmi2_capi_destroy_dllfmu(fmi2_capi_t* fmu)
 {
 	if (fmu == NULL) {
@@ -238,6 +296,8 @@ void fmi2_capi_destroy_dllfmu(fmi2_capi_t* fmu)
 	}
 	fmi2_capi_free_dll(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Releasing allocated memory");
+	fmi2_capi_trace_free(fmu);
+	fmi2_capi_remote_free(fmu);
 	fmu->callbacks->free((void*)fmu->dllPath);
 	fmu->callbacks->free((void*)fmu->modelIdentifier);
 	fmu->callbacks->free((void*)fmu);
@@ -300,32 +360,109 @@ fmi2_capi_t* fmi2_capi_create_dllfmu(jm_callbacks* cb, const char* dllPath, cons
 	return fmu;
 }
 
+fmi2_capi_t* fmi2_capi_clone_dllfmu(fmi2_capi_t* fmu, const fmi2_callback_functions_t* callBackFunctions)
+{
+	jm_callbacks* cb;
+	fmi2_capi_t* clone;
+
+	assert(fmu && fmu->dllPath && fmu->modelIdentifier);
+	cb = fmu->callbacks;
+	clone = fmi2_capi_create_dllfmu(cb, fmu->dllPath, fmu->modelIdentifier, callBackFunctions, fmu->standard);
+	if (clone == NULL) {
+		return NULL;
+	}
+
+	clone->debugMode = fmu->debugMode;
+	clone->isolationMode = fmu->isolationMode;
+	if (fmu->remote) {
+		/* Start a host process of its own */
+		if (fmi2_capi_set_host(clone, fmi2_capi_get_host(fmu)) == jm_status_error ||
+			(fmu->capabilities && (fmi2_capi_load_dll(clone) == jm_status_error ||
+			fmi2_capi_load_fcn(clone, fmu->capabilities) == jm_status_error))) {
+			fmi2_capi_destroy_dllfmu(clone);
+			return NULL;
+		}
+		return clone;
+	}
+	if (fmu->registryEntry && fmu->isolationMode) {
+		/* Load a private copy and check its functions against the same flags */
+		if (fmi2_capi_load_dll(clone) == jm_status_error ||
+			fmi2_capi_load_fcn(clone, fmu->capabilities) == jm_status_error) {
+			fmi2_capi_destroy_dllfmu(clone);
+			return NULL;
+		}
+		return clone;
+	}
+
+	/* Share everything but the per-instance fields: the library, the capabilities and the
+	   function pointers. The clone is not traced. */
+	{
+		fmi2_capi_t instance = *clone;
+
+		*clone = *fmu;
+		clone->dllPath = instance.dllPath;
+		clone->modelIdentifier = instance.modelIdentifier;
+		clone->callBackFunctions = instance.callBackFunctions;
+		clone->c = 0;
+		clone->trace = 0;
+		clone->remote = 0;
+	}
+	if (clone->registryEntry) {
+		fmi_capi_registry_retain(clone->registryEntry);
+	}
+	fmi2_capi_copy_fcn(clone, fmi2_capi_get_fcn_table(fmu));
+
+	return clone;
+}
+
 jm_status_enu_t fmi2_capi_load_fcn(fmi2_capi_t* fmu, unsigned int capabilities[])
 {
-	assert(fmu);
-	/* Load ME functions */
-	if (fmu->standard == fmi2_fmu_kind_me) {
-		return fmi2_capi_load_me_fcn(fmu, capabilities);
-	/* Load CS functions */
-	} else if (fmu->standard == fmi2_fmu_kind_cs) {
-		return fmi2_capi_load_cs_fcn(fmu, capabilities);
-	} else {
+	const fmi2_capi_t* tbl;
+
+	assert(fmu && (fmu->registryEntry || fmu->remote));
+	if (fmu->standard != fmi2_fmu_kind_me && fmu->standard != fmi2_fmu_kind_cs) {
 		jm_log_error(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Unexpected FMU kind in FMICAPI.");
 		return jm_status_error;
 	}
+	if (fmu->remote) {
+		/* The host resolves the functions and resets the flags of the missing ones */
+		if (fmi2_capi_remote_load_fcn(fmu, capabilities) == jm_status_error) {
+			return jm_status_error;
+		}
+		fmi2_capi_check_fcn_flags(fmu, capabilities);
+		return jm_status_success;
+	}
+
+	/* The function table is resolved once per loaded binary */
+	tbl = (const fmi2_capi_t*)fmi_capi_registry_get_table(fmu->registryEntry, sizeof(fmi2_capi_t), fmi2_capi_resolve_fcn, fmu);
+	if (tbl == NULL) {
+		return jm_status_error;
+	}
+	fmi2_capi_copy_fcn(fmu, tbl);
+	fmu->capabilities = capabilities;
+	fmi2_capi_check_fcn_flags(fmu, capabilities);
+	return jm_status_success;
 }
 
 jm_status_enu_t fmi2_capi_load_dll(fmi2_capi_t* fmu)
 {
 	assert(fmu && fmu->dllPath);
-	fmu->dllHandle = jm_portability_load_dll_handle(fmu->dllPath); /* Load the shared library */
-	if (fmu->dllHandle == NULL) {
-		jm_log_fatal(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Could not load the FMU binary: %s", jm_portability_get_last_dll_error());
-		return jm_status_error;
+	if (fmu->remote) {
+		return fmi2_capi_remote_start(fmu);
+	}
+	/* Load the shared library or get the already loaded one */
+	if (fmu->isolationMode) {
+		fmu->registryEntry = fmi_capi_registry_acquire_isolated(fmu->callbacks, fmu->dllPath, fmu->modelIdentifier,
+			(fmu->standard == fmi2_fmu_kind_me) ? fmi_capi_table_fmi2_me : fmi_capi_table_fmi2_cs);
 	} else {
-		jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Loaded FMU binary from %s", fmu->dllPath);
-		return jm_status_success;
+		fmu->registryEntry = fmi_capi_registry_acquire(fmu->callbacks, fmu->dllPath, fmu->modelIdentifier,
+			(fmu->standard == fmi2_fmu_kind_me) ? fmi_capi_table_fmi2_me : fmi_capi_table_fmi2_cs);
+	}
+	if (fmu->registryEntry == NULL) {
+		return jm_status_error;
 	}
+	fmu->dllHandle = fmi_capi_registry_get_dll_handle(fmu->registryEntry);
+	return jm_status_success;
 }
 
 void fmi2_capi_set_debug_mode(fmi2_capi_t* fmu, int mode) {
@@ -338,6 +475,16 @@ int fmi2_capi_get_debug_mode(fmi2_capi_t* fmu) {
 	return 0;
 }
 
+void fmi2_capi_set_isolation_mode(fmi2_capi_t* fmu, int mode) {
+	if(fmu)
+		fmu->isolationMode = mode;
+}
+
+int fmi2_capi_get_isolation_mode(fmi2_capi_t* fmu) {
+	if(fmu) return fmu->isolationMode;
+	return 0;
+}
+
 fmi2_fmu_kind_enu_t fmi2_capi_get_fmu_kind(fmi2_capi_t* fmu) {
 	if(fmu) return fmu->standard;
 	return fmi2_fmu_kind_unknown;
@@ -348,21 +495,17 @@ jm_status_enu_t fmi2_capi_free_dll(fmi2_capi_t* fmu)
 	if (fmu == NULL) {
 		return jm_status_error; /* Return without writing any log message */
 	}
+	if (fmu->remote) {
+		fmi2_capi_remote_stop(fmu);
+	}
 
-	if (fmu->dllHandle) {
-		jm_status_enu_t status =
-			(fmu->debugMode != 0) ?
-                /* When running valgrind this may be convenient to track mem leaks */
-                jm_status_success:
-                jm_portability_free_dll_handle(fmu->dllHandle);
+	if (fmu->registryEntry) {
+		/* The binary is unloaded when the last user releases it. In debug mode it is
+		   never unloaded since, when running valgrind, this may be convenient to track mem leaks. */
+		jm_status_enu_t status = fmi_capi_registry_release(fmu->callbacks, fmu->registryEntry, fmu->debugMode == 0);
+		fmu->registryEntry = 0;
 		fmu->dllHandle = 0;
-		if (status == jm_status_error) { /* Free the library handle */
-			jm_log(fmu->callbacks, FMI_CAPI_MODULE_NAME, jm_log_level_error, "Could not free the FMU binary: %s", jm_portability_get_last_dll_error());
-			return jm_status_error;
-		} else {
-			jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Successfully unloaded FMU binary");
-			return jm_status_success;
-		}
+		return status;
 	}
 	return jm_status_success;
 }
@@ -372,6 +515,7 @@ jm_status_enu_t fmi2_capi_free_dll(fmi2_capi_t* fmu)
 const char* fmi2_capi_get_version(fmi2_capi_t* fmu)
 {
 	assert(fmu);
+	if (fmu->remote) return fmi2_capi_remote_get_version(fmu);
 	return fmu->fmi2GetVersion();
 }
 
@@ -379,6 +523,7 @@ const char* fmi2_capi_get_types_platform(fmi2_capi_t* fmu)
 {
 	assert(fmu);
 	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2GetModelTypesPlatform");
+	if (fmu->remote) return fmi2_capi_remote_get_types_platform(fmu);
 	return fmu->fmi2GetTypesPlatform();
 }
 
@@ -392,8 +537,15 @@ fmi2_component_t fmi2_capi_instantiate(fmi2_capi_t* fmu,
   fmi2_string_t fmuResourceLocation, fmi2_boolean_t visible,
   fmi2_boolean_t loggingOn)
 {
-    return fmu->c = fmu->fmi2Instantiate(instanceName, fmuType, fmuGUID,
-        fmuResourceLocation, &fmu->callBackFunctions, visible, loggingOn);
+    double start = fmu->trace ? jm_portability_get_time() : 0;
+    if(fmu->remote)
+        fmu->c = fmi2_capi_remote_instantiate(fmu, instanceName, fmuType, fmuGUID,
+            fmuResourceLocation, visible, loggingOn);
+    else
+        fmu->c = fmu->fmi2Instantiate(instanceName, fmuType, fmuGUID,
+            fmuResourceLocation, &fmu->callBackFunctions, visible, loggingOn);
+    if(fmu->trace) fmi2_capi_trace_instantiated(fmu, instanceName, start);
+    return fmi2_capi_get_component(fmu);
 }
 
 void fmi2_capi_free_instance(fmi2_capi_t* fmu)
@@ -0,0 +1,32 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/* Host process running an FMU binary for an importer that called fmi2_capi_set_host().
+   Started by the importer with the descriptor of the shared memory channel as argument. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fmi2_capi_remote.h"
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2) {
+		fprintf(stderr, "Usage: %s <channel descriptor>\n"
+			"Started by FMI Library to run FMUs out of process.\n", argv[0]);
+		return 1;
+	}
+	return fmi2_remote_serve(atoi(argv[1]));
+}
@@ -27,6 +27,7 @@ extern "C" {
 #include <FMI2/fmi2_capi.h>
 #include <JM/jm_portability.h>
 #include <JM/jm_callbacks.h>
+#include <FMI/fmi_capi_registry.h>
 
 #define FMI_CAPI_MODULE_NAME "FMICAPI"
 
@@ -41,12 +42,19 @@ struct fmi2_capi_t {
 	jm_callbacks* callbacks;
 
 	DLL_HANDLE dllHandle;
+	fmi_capi_registry_entry_t* registryEntry; /* holds the reference to dllHandle */
 
 	fmi2_fmu_kind_enu_t standard;
 
 	fmi2_component_t					c;
 
 	int debugMode;
+	int isolationMode; /* load a private copy of the shared library */
+	unsigned int* capabilities; /* capability flags the functions were checked against */
+	struct fmi2_capi_trace_t* trace; /* call statistics and the untraced functions, see fmi2_capi_trace.c */
+	struct fmi2_capi_remote_t* remote; /* host process running the binary, see fmi2_capi_remote.c */
+
+	/* The function pointers must stay last, starting with fmi2GetVersion, see fmi2_capi_copy_fcn() */
 
 	/* FMI common */
 	fmi2_get_version_ft					fmi2GetVersion;
@@ -109,6 +117,38 @@ struct fmi2_capi_t {
 
 };
 
+/* Copy the function pointers from a function table */
+void fmi2_capi_copy_fcn(fmi2_capi_t* fmu, const fmi2_capi_t* tbl);
+
+/* Get the table of the untraced functions */
+const fmi2_capi_t* fmi2_capi_get_fcn_table(fmi2_capi_t* fmu);
+
+/* Hide a new component behind the trace and record the instantiation that started at startTime */
+void fmi2_capi_trace_instantiated(fmi2_capi_t* fmu, const char* instanceName, double startTime);
+
+/* Free the call statistics */
+void fmi2_capi_trace_free(fmi2_capi_t* fmu);
+
+typedef struct fmi2_capi_remote_t fmi2_capi_remote_t;
+
+/* Start the host process and load the binary in it */
+jm_status_enu_t fmi2_capi_remote_start(fmi2_capi_t* fmu);
+
+/* Resolve the functions in the host process and point the function pointers to the forwarding stubs */
+jm_status_enu_t fmi2_capi_remote_load_fcn(fmi2_capi_t* fmu, unsigned int capabilities[]);
+
+/* Stop the host process */
+void fmi2_capi_remote_stop(fmi2_capi_t* fmu);
+
+/* Stop the host process and free the proxy */
+void fmi2_capi_remote_free(fmi2_capi_t* fmu);
+
+/* The functions without a component argument, called in the host process */
+fmi2_component_t fmi2_capi_remote_instantiate(fmi2_capi_t* fmu, fmi2_string_t instanceName, fmi2_type_t fmuType,
+	fmi2_string_t fmuGUID, fmi2_string_t fmuResourceLocation, fmi2_boolean_t visible, fmi2_boolean_t loggingOn);
+const char* fmi2_capi_remote_get_version(fmi2_capi_t* fmu);
+const char* fmi2_capi_remote_get_types_platform(fmi2_capi_t* fmu);
+
 #ifdef __cplusplus 
 }
 #endif
@@ -0,0 +1,1492 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <assert.h>
+
+#include <JM/jm_portability.h>
+#include <JM/jm_thread.h>
+#include <FMI2/fmi2_capi_impl.h>
+#include "fmi2_capi_remote.h"
+
+#if !defined(_MSC_VER) && !defined(WIN32) && !defined(__MINGW32__)
+#define FMI2_REMOTE_SUPPORTED
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+/* Polls of the state before sleeping, about ten microseconds */
+#define FMI2_REMOTE_SPIN 4000
+/* Seconds between the checks that the other process is alive while sleeping */
+#define FMI2_REMOTE_POLL_INTERVAL 0.01
+#define FMI2_REMOTE_HOST_POLL_INTERVAL 0.1
+/* Seconds to wait for the host to exit before it is killed */
+#define FMI2_REMOTE_QUIT_TIMEOUT 1.0
+
+#define FMI2_REMOTE_ALIGN 8
+
+void* fmi2_remote_reserve(fmi2_remote_cursor_t* cur, size_t bytes) {
+	size_t start = (cur->pos + FMI2_REMOTE_ALIGN - 1) / FMI2_REMOTE_ALIGN * FMI2_REMOTE_ALIGN;
+	if(cur->overflow || start > FMI2_REMOTE_DATA_SIZE || bytes > FMI2_REMOTE_DATA_SIZE - start) {
+		cur->overflow = 1;
+		return 0;
+	}
+	cur->pos = start + bytes;
+	return (char*)cur->ch->data + start;
+}
+
+static void fmi2_remote_cursor_init(fmi2_remote_cursor_t* cur, fmi2_remote_channel_t* ch) {
+	cur->ch = ch;
+	cur->pos = 0;
+	cur->overflow = 0;
+}
+
+/* Copy an input array to the data area */
+static void fmi2_remote_put(fmi2_remote_cursor_t* cur, const void* src, size_t bytes) {
+	void* dst = fmi2_remote_reserve(cur, bytes);
+	if(dst && bytes) memcpy(dst, src, bytes);
+}
+
+/* Strings are stored with their length; NULL has the length (size_t)-1 */
+static void fmi2_remote_write_string(fmi2_remote_cursor_t* cur, const char* s) {
+	size_t* len = (size_t*)fmi2_remote_reserve(cur, sizeof(size_t));
+	if(!len) return;
+	*len = s ? strlen(s) : (size_t)-1;
+	if(s) fmi2_remote_put(cur, s, *len + 1);
+}
+
+static const char* fmi2_remote_read_string(fmi2_remote_cursor_t* cur) {
+	size_t* len = (size_t*)fmi2_remote_reserve(cur, sizeof(size_t));
+	if(!len || *len == (size_t)-1) return 0;
+	return (const char*)fmi2_remote_reserve(cur, *len + 1);
+}
+
+#ifdef FMI2_REMOTE_SUPPORTED
+
+void fmi2_remote_wait(fmi2_remote_channel_t* ch, int value, double timeout) {
+	struct timespec ts;
+	ts.tv_sec = (time_t)timeout;
+	ts.tv_nsec = (long)((timeout - (double)ts.tv_sec) * 1e9);
+#ifdef __linux__
+	syscall(SYS_futex, &ch->state, FUTEX_WAIT, value, &ts, NULL, 0);
+#else
+	/* no futex: sleep shortly and let the caller poll */
+	if(ts.tv_sec > 0 || ts.tv_nsec > 50000) {
+		ts.tv_sec = 0;
+		ts.tv_nsec = 50000;
+	}
+	if(ch->state == value) nanosleep(&ts, 0);
+#endif
+}
+
+void fmi2_remote_wake(fmi2_remote_channel_t* ch) {
+#ifdef __linux__
+	syscall(SYS_futex, &ch->state, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+	(void)ch;
+#endif
+}
+
+/* Switch the state after the data is written */
+static void fmi2_remote_post(fmi2_remote_channel_t* ch, int state) {
+	__sync_synchronize();
+	ch->state = state;
+	fmi2_remote_wake(ch);
+}
+
+/* -------- Importing process -------- */
+
+/* Proxy of an FMU running in a host process. While an instance exists the proxy is the component. */
+struct fmi2_capi_remote_t {
+	jm_callbacks* callbacks;
+	fmi2_capi_t* fmu;
+	char* hostPath;
+	int fd;
+	fmi2_remote_channel_t* ch;
+	pid_t pid;           /* zero if the host is not running */
+	int crashed;
+	size_t launches;     /* host processes started, tags the FMU state handles */
+	char version[32];
+	char typesPlatform[32];
+	char* strings;       /* strings returned by the last call */
+	size_t stringsSize;
+
+	/* arguments replayed when the host is restarted */
+	char* instanceName;
+	char* fmuGUID;
+	char* fmuResourceLocation;
+	int fmuType, visible, loggingOn;
+	int isInstantiated, isExperimentSet, isInitialized;
+	int toleranceDefined, stopTimeDefined;
+	double tolerance, startTime, stopTime;
+};
+
+/* Check that the host is running; reaps and reports it if it has terminated */
+static int fmi2_remote_host_alive(fmi2_capi_remote_t* r) {
+	int st;
+	pid_t res;
+	if(r->pid <= 0) return 0;
+	res = waitpid(r->pid, &st, WNOHANG);
+	if(res == 0) return 1;
+	if(res < 0 && errno == ECHILD && kill(r->pid, 0) == 0) return 1;
+	if(res == r->pid && WIFSIGNALED(st)) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "The FMU host process %d was terminated by signal %d", (int)r->pid, WTERMSIG(st));
+	}
+	else if(res == r->pid && WIFEXITED(st) && WEXITSTATUS(st) == 127) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "Could not start the FMU host process '%s'", r->hostPath);
+	}
+	else {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "The FMU host process %d terminated unexpectedly", (int)r->pid);
+	}
+	r->pid = 0;
+	r->crashed = 1;
+	return 0;
+}
+
+/* Pass the messages logged in the host to the loggers of this process */
+static void fmi2_remote_replay_log(fmi2_capi_remote_t* r) {
+	const char* p = r->ch->log;
+	const char* end = p + r->ch->logSize;
+	while(p < end) {
+		int kind, status;
+		const char *category, *instanceName, *message;
+		memcpy(&kind, p, sizeof(int));
+		memcpy(&status, p + sizeof(int), sizeof(int));
+		p += 2 * sizeof(int);
+		category = p;
+		p += strlen(p) + 1;
+		instanceName = p;
+		p += strlen(p) + 1;
+		message = p;
+		p += strlen(p) + 1;
+		if(kind == FMI2_REMOTE_LOG_LIBRARY) {
+			jm_log(r->callbacks, category, (jm_log_level_enu_t)status, "%s", message);
+		}
+		else if(r->fmu->callBackFunctions.logger) {
+			r->fmu->callBackFunctions.logger(r->fmu->callBackFunctions.componentEnvironment,
+				instanceName, (fmi2_status_t)status, category, "%s", message);
+		}
+	}
+}
+
+/* Start writing a call. Returns zero if the host is not available. */
+static int fmi2_remote_begin(fmi2_capi_remote_t* r, fmi2_remote_cursor_t* cur) {
+	if(!r->ch || r->crashed) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "The FMU host process is not running");
+		return 0;
+	}
+	fmi2_remote_cursor_init(cur, r->ch);
+	return 1;
+}
+
+/* Make the call written to the channel and wait for the result */
+static fmi2_status_t fmi2_remote_call(fmi2_capi_remote_t* r, fmi2_remote_cursor_t* cur, fmi2_remote_fcn_enu_t fcn) {
+	fmi2_remote_channel_t* ch = r->ch;
+	long spin;
+
+	if(cur->overflow) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "The arguments do not fit in the shared memory of the FMU host process");
+		return fmi2_status_error;
+	}
+	ch->fcn = fcn;
+	ch->logSize = 0;
+	fmi2_remote_post(ch, FMI2_REMOTE_REQUEST);
+
+	for(spin = 0; spin < FMI2_REMOTE_SPIN && ch->state != FMI2_REMOTE_RESPONSE; spin++);
+	while(ch->state != FMI2_REMOTE_RESPONSE) {
+		fmi2_remote_wait(ch, FMI2_REMOTE_REQUEST, FMI2_REMOTE_POLL_INTERVAL);
+		if(ch->state != FMI2_REMOTE_RESPONSE && !fmi2_remote_host_alive(r)) {
+			return fmi2_status_fatal;
+		}
+	}
+	__sync_synchronize();
+	fmi2_remote_replay_log(r);
+	/* the host does not wait for the idle state, so no wake-up is needed */
+	ch->state = FMI2_REMOTE_IDLE;
+	return (fmi2_status_t)ch->status;
+}
+
+/* Stubs replacing the FMI functions */
+
+#define FMI2_REMOTE_STUB_BEGIN(c) \
+	fmi2_capi_remote_t* r = (fmi2_capi_remote_t*)c; \
+	fmi2_remote_cursor_t cur; \
+	if(!fmi2_remote_begin(r, &cur)) return fmi2_status_fatal;
+
+#define FMI2_REMOTE_STUB_VOID(FCN, ID) \
+static fmi2_status_t fmi2_remote_##FCN(fmi2_component_t c) \
+{ \
+	FMI2_REMOTE_STUB_BEGIN(c) \
+	return fmi2_remote_call(r, &cur, fmi2_remote_##ID); \
+}
+
+#define FMI2_REMOTE_STUB_SET_VR(FCN, ID, FTYPE) \
+static fmi2_status_t fmi2_remote_##FCN(fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr, const FTYPE value[]) \
+{ \
+	FMI2_REMOTE_STUB_BEGIN(c) \
+	cur.ch->sizes[0] = nvr; \
+	fmi2_remote_put(&cur, vr, nvr * sizeof(fmi2_value_reference_t)); \
+	fmi2_remote_put(&cur, value, nvr * sizeof(FTYPE)); \
+	return fmi2_remote_call(r, &cur, fmi2_remote_##ID); \
+}
+
+#define FMI2_REMOTE_STUB_GET_VR(FCN, ID, FTYPE) \
+static fmi2_status_t fmi2_remote_##FCN(fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr, FTYPE value[]) \
+{ \
+	fmi2_status_t status; \
+	void* out; \
+	FMI2_REMOTE_STUB_BEGIN(c) \
+	cur.ch->sizes[0] = nvr; \
+	fmi2_remote_put(&cur, vr, nvr * sizeof(fmi2_value_reference_t)); \
+	out = fmi2_remote_reserve(&cur, nvr * sizeof(FTYPE)); \
+	status = fmi2_remote_call(r, &cur, fmi2_remote_##ID); \
+	if(status != fmi2_status_fatal && out) memcpy(value, out, nvr * sizeof(FTYPE)); \
+	return status; \
+}
+
+#define FMI2_REMOTE_STUB_GET_ARRAY(FCN, ID) \
+static fmi2_status_t fmi2_remote_##FCN(fmi2_component_t c, fmi2_real_t x[], size_t nx) \
+{ \
+	fmi2_status_t status; \
+	void* out; \
+	FMI2_REMOTE_STUB_BEGIN(c) \
+	cur.ch->sizes[0] = nx; \
+	out = fmi2_remote_reserve(&cur, nx * sizeof(fmi2_real_t)); \
+	status = fmi2_remote_call(r, &cur, fmi2_remote_##ID); \
+	if(status != fmi2_status_fatal && out) memcpy(x, out, nx * sizeof(fmi2_real_t)); \
+	return status; \
+}
+
+#define FMI2_REMOTE_STUB_GET_STATUS(FCN, ID, FTYPE) \
+static fmi2_status_t fmi2_remote_##FCN(fmi2_component_t c, const fmi2_status_kind_t s, FTYPE* value) \
+{ \
+	fmi2_status_t status; \
+	void* out; \
+	FMI2_REMOTE_STUB_BEGIN(c) \
+	cur.ch->ints[0] = (int)s; \
+	out = fmi2_remote_reserve(&cur, sizeof(FTYPE)); \
+	status = fmi2_remote_call(r, &cur, fmi2_remote_##ID); \
+	if(status != fmi2_status_fatal && out) memcpy(value, out, sizeof(FTYPE)); \
+	return status; \
+}
+
+/* Copy the strings returned by the host to storage that is valid until the next call */
+static int fmi2_remote_keep_strings(fmi2_capi_remote_t* r, fmi2_remote_cursor_t* cur, size_t n, fmi2_string_t value[]) {
+	fmi2_remote_cursor_t scan = *cur;
+	size_t i, total = 0, pos = 0;
+	for(i = 0; i < n; i++) {
+		const char* s = fmi2_remote_read_string(&scan);
+		if(s) total += strlen(s) + 1;
+	}
+	if(total > r->stringsSize) {
+		char* strings = (char*)r->callbacks->realloc(r->strings, total);
+		if(!strings) {
+			jm_log_fatal(r->callbacks, FMI_CAPI_MODULE_NAME, "Could not allocate memory");
+			return 0;
+		}
+		r->strings = strings;
+		r->stringsSize = total;
+	}
+	for(i = 0; i < n; i++) {
+		const char* s = fmi2_remote_read_string(cur);
+		value[i] = 0;
+		if(s) {
+			strcpy(r->strings + pos, s);
+			value[i] = r->strings + pos;
+			pos += strlen(s) + 1;
+		}
+	}
+	return 1;
+}
+
+static void fmi2_remote_put_strings(fmi2_remote_cursor_t* cur, size_t n, const fmi2_string_t value[]) {
+	size_t i;
+	for(i = 0; i < n; i++) fmi2_remote_write_string(cur, value[i]);
+}
+
+static fmi2_status_t fmi2_remote_fmi2SetDebugLogging(fmi2_component_t c, fmi2_boolean_t loggingOn, size_t nCategories, const fmi2_string_t categories[])
+{
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->ints[0] = loggingOn;
+	cur.ch->sizes[0] = nCategories;
+	fmi2_remote_put_strings(&cur, nCategories, categories);
+	return fmi2_remote_call(r, &cur, fmi2_remote_set_debug_logging);
+}
+
+static void fmi2_remote_fmi2FreeInstance(fmi2_component_t c)
+{
+	fmi2_capi_remote_t* r = (fmi2_capi_remote_t*)c;
+	fmi2_remote_cursor_t cur;
+	r->isInstantiated = r->isExperimentSet = r->isInitialized = 0;
+	if(!r->ch || r->crashed) return;
+	fmi2_remote_cursor_init(&cur, r->ch);
+	fmi2_remote_call(r, &cur, fmi2_remote_free_instance);
+}
+
+static fmi2_status_t fmi2_remote_fmi2SetupExperiment(fmi2_component_t c, fmi2_boolean_t toleranceDefined, fmi2_real_t tolerance,
+	fmi2_real_t startTime, fmi2_boolean_t stopTimeDefined, fmi2_real_t stopTime)
+{
+	FMI2_REMOTE_STUB_BEGIN(c)
+	r->isExperimentSet = 1;
+	r->toleranceDefined = cur.ch->ints[0] = toleranceDefined;
+	r->tolerance = cur.ch->reals[0] = tolerance;
+	r->startTime = cur.ch->reals[1] = startTime;
+	r->stopTimeDefined = cur.ch->ints[1] = stopTimeDefined;
+	r->stopTime = cur.ch->reals[2] = stopTime;
+	return fmi2_remote_call(r, &cur, fmi2_remote_setup_experiment);
+}
+
+static fmi2_status_t fmi2_remote_fmi2ExitInitializationMode(fmi2_component_t c)
+{
+	fmi2_status_t status;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	status = fmi2_remote_call(r, &cur, fmi2_remote_exit_initialization_mode);
+	if(status < fmi2_status_error) r->isInitialized = 1;
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2Reset(fmi2_component_t c)
+{
+	FMI2_REMOTE_STUB_BEGIN(c)
+	r->isExperimentSet = r->isInitialized = 0;
+	return fmi2_remote_call(r, &cur, fmi2_remote_reset);
+}
+
+FMI2_REMOTE_STUB_VOID(fmi2EnterInitializationMode, enter_initialization_mode)
+FMI2_REMOTE_STUB_VOID(fmi2Terminate, terminate)
+FMI2_REMOTE_STUB_VOID(fmi2EnterEventMode, enter_event_mode)
+FMI2_REMOTE_STUB_VOID(fmi2EnterContinuousTimeMode, enter_continuous_time_mode)
+FMI2_REMOTE_STUB_VOID(fmi2CancelStep, cancel_step)
+
+FMI2_REMOTE_STUB_SET_VR(fmi2SetReal, set_real, fmi2_real_t)
+FMI2_REMOTE_STUB_SET_VR(fmi2SetInteger, set_integer, fmi2_integer_t)
+FMI2_REMOTE_STUB_SET_VR(fmi2SetBoolean, set_boolean, fmi2_boolean_t)
+FMI2_REMOTE_STUB_GET_VR(fmi2GetReal, get_real, fmi2_real_t)
+FMI2_REMOTE_STUB_GET_VR(fmi2GetInteger, get_integer, fmi2_integer_t)
+FMI2_REMOTE_STUB_GET_VR(fmi2GetBoolean, get_boolean, fmi2_boolean_t)
+
+static fmi2_status_t fmi2_remote_fmi2SetString(fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_string_t value[])
+{
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->sizes[0] = nvr;
+	fmi2_remote_put(&cur, vr, nvr * sizeof(fmi2_value_reference_t));
+	fmi2_remote_put_strings(&cur, nvr, value);
+	return fmi2_remote_call(r, &cur, fmi2_remote_set_string);
+}
+
+static fmi2_status_t fmi2_remote_fmi2GetString(fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr, fmi2_string_t value[])
+{
+	fmi2_status_t status;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->sizes[0] = nvr;
+	fmi2_remote_put(&cur, vr, nvr * sizeof(fmi2_value_reference_t));
+	status = fmi2_remote_call(r, &cur, fmi2_remote_get_string);
+	if(status != fmi2_status_fatal && !fmi2_remote_keep_strings(r, &cur, nvr, value)) return fmi2_status_error;
+	return status;
+}
+
+/* FMU states are kept in a table in the host process. The handles seen here carry the
+   table index in the low bits and the number of the host launch above them, so that
+   the states of a host that was restarted are rejected instead of reaching the new one. */
+static fmi2_FMU_state_t fmi2_remote_state_handle(fmi2_capi_remote_t* r, size_t index)
+{
+	if(!index) return 0;
+	return (fmi2_FMU_state_t)((r->launches << FMI2_REMOTE_STATE_INDEX_BITS) | index);
+}
+
+/* Get the table index of a handle, zero for NULL. Returns zero for a handle of an earlier host. */
+static int fmi2_remote_state_index(fmi2_capi_remote_t* r, fmi2_FMU_state_t s, size_t* index)
+{
+	size_t handle = (size_t)s;
+	*index = handle & FMI2_REMOTE_STATE_INDEX_MASK;
+	if(handle && (handle & ~FMI2_REMOTE_STATE_INDEX_MASK) != (r->launches << FMI2_REMOTE_STATE_INDEX_BITS)) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "The FMU state was lost when the FMU host process was restarted");
+		return 0;
+	}
+	return 1;
+}
+
+static fmi2_status_t fmi2_remote_fmi2GetFMUstate(fmi2_component_t c, fmi2_FMU_state_t* s)
+{
+	fmi2_status_t status;
+	size_t index;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	if(!fmi2_remote_state_index(r, *s, &index)) return fmi2_status_error;
+	cur.ch->handle = index;
+	status = fmi2_remote_call(r, &cur, fmi2_remote_get_fmu_state);
+	if(status < fmi2_status_error) *s = fmi2_remote_state_handle(r, r->ch->handle);
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2SetFMUstate(fmi2_component_t c, fmi2_FMU_state_t s)
+{
+	size_t index;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	if(!fmi2_remote_state_index(r, s, &index)) return fmi2_status_error;
+	cur.ch->handle = index;
+	return fmi2_remote_call(r, &cur, fmi2_remote_set_fmu_state);
+}
+
+static fmi2_status_t fmi2_remote_fmi2FreeFMUstate(fmi2_component_t c, fmi2_FMU_state_t* s)
+{
+	fmi2_status_t status;
+	size_t index;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	if(!fmi2_remote_state_index(r, *s, &index)) return fmi2_status_error;
+	cur.ch->handle = index;
+	status = fmi2_remote_call(r, &cur, fmi2_remote_free_fmu_state);
+	if(status == fmi2_status_fatal) *s = 0;
+	else if(status < fmi2_status_error) *s = fmi2_remote_state_handle(r, r->ch->handle);
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2SerializedFMUstateSize(fmi2_component_t c, fmi2_FMU_state_t s, size_t* sz)
+{
+	fmi2_status_t status;
+	size_t index;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	if(!fmi2_remote_state_index(r, s, &index)) return fmi2_status_error;
+	cur.ch->handle = index;
+	status = fmi2_remote_call(r, &cur, fmi2_remote_serialized_fmu_state_size);
+	if(status != fmi2_status_fatal) *sz = r->ch->sizes[0];
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2SerializeFMUstate(fmi2_component_t c, fmi2_FMU_state_t s, fmi2_byte_t data[], size_t sz)
+{
+	fmi2_status_t status;
+	size_t index;
+	void* out;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	if(!fmi2_remote_state_index(r, s, &index)) return fmi2_status_error;
+	cur.ch->handle = index;
+	cur.ch->sizes[0] = sz;
+	out = fmi2_remote_reserve(&cur, sz);
+	status = fmi2_remote_call(r, &cur, fmi2_remote_serialize_fmu_state);
+	if(status != fmi2_status_fatal && out) memcpy(data, out, sz);
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2DeSerializeFMUstate(fmi2_component_t c, const fmi2_byte_t data[], size_t sz, fmi2_FMU_state_t* s)
+{
+	fmi2_status_t status;
+	size_t index;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	if(!fmi2_remote_state_index(r, *s, &index)) return fmi2_status_error;
+	cur.ch->handle = index;
+	cur.ch->sizes[0] = sz;
+	fmi2_remote_put(&cur, data, sz);
+	status = fmi2_remote_call(r, &cur, fmi2_remote_de_serialize_fmu_state);
+	if(status < fmi2_status_error) *s = fmi2_remote_state_handle(r, r->ch->handle);
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2GetDirectionalDerivative(fmi2_component_t c, const fmi2_value_reference_t z_ref[], size_t nz,
+	const fmi2_value_reference_t v_ref[], size_t nv, const fmi2_real_t dv[], fmi2_real_t dz[])
+{
+	fmi2_status_t status;
+	void* out;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->sizes[0] = nz;
+	cur.ch->sizes[1] = nv;
+	fmi2_remote_put(&cur, z_ref, nz * sizeof(fmi2_value_reference_t));
+	fmi2_remote_put(&cur, v_ref, nv * sizeof(fmi2_value_reference_t));
+	fmi2_remote_put(&cur, dv, nv * sizeof(fmi2_real_t));
+	out = fmi2_remote_reserve(&cur, nz * sizeof(fmi2_real_t));
+	status = fmi2_remote_call(r, &cur, fmi2_remote_get_directional_derivative);
+	if(status != fmi2_status_fatal && out) memcpy(dz, out, nz * sizeof(fmi2_real_t));
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2NewDiscreteStates(fmi2_component_t c, fmi2_event_info_t* eventInfo)
+{
+	fmi2_status_t status;
+	void* out;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	out = fmi2_remote_reserve(&cur, sizeof(fmi2_event_info_t));
+	status = fmi2_remote_call(r, &cur, fmi2_remote_new_discrete_states);
+	if(status != fmi2_status_fatal && out) memcpy(eventInfo, out, sizeof(fmi2_event_info_t));
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2CompletedIntegratorStep(fmi2_component_t c, fmi2_boolean_t noSetFMUStatePriorToCurrentPoint,
+	fmi2_boolean_t* enterEventMode, fmi2_boolean_t* terminateSimulation)
+{
+	fmi2_status_t status;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->ints[0] = noSetFMUStatePriorToCurrentPoint;
+	status = fmi2_remote_call(r, &cur, fmi2_remote_completed_integrator_step);
+	if(status != fmi2_status_fatal) {
+		*enterEventMode = r->ch->ints[1];
+		*terminateSimulation = r->ch->ints[2];
+	}
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2SetTime(fmi2_component_t c, fmi2_real_t time)
+{
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->reals[0] = time;
+	return fmi2_remote_call(r, &cur, fmi2_remote_set_time);
+}
+
+static fmi2_status_t fmi2_remote_fmi2SetContinuousStates(fmi2_component_t c, const fmi2_real_t x[], size_t nx)
+{
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->sizes[0] = nx;
+	fmi2_remote_put(&cur, x, nx * sizeof(fmi2_real_t));
+	return fmi2_remote_call(r, &cur, fmi2_remote_set_continuous_states);
+}
+
+FMI2_REMOTE_STUB_GET_ARRAY(fmi2GetDerivatives, get_derivatives)
+FMI2_REMOTE_STUB_GET_ARRAY(fmi2GetEventIndicators, get_event_indicators)
+FMI2_REMOTE_STUB_GET_ARRAY(fmi2GetContinuousStates, get_continuous_states)
+FMI2_REMOTE_STUB_GET_ARRAY(fmi2GetNominalsOfContinuousStates, get_nominals_of_continuous_states)
+
+static fmi2_status_t fmi2_remote_fmi2SetRealInputDerivatives(fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr,
+	const fmi2_integer_t order[], const fmi2_real_t value[])
+{
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->sizes[0] = nvr;
+	fmi2_remote_put(&cur, vr, nvr * sizeof(fmi2_value_reference_t));
+	fmi2_remote_put(&cur, order, nvr * sizeof(fmi2_integer_t));
+	fmi2_remote_put(&cur, value, nvr * sizeof(fmi2_real_t));
+	return fmi2_remote_call(r, &cur, fmi2_remote_set_real_input_derivatives);
+}
+
+static fmi2_status_t fmi2_remote_fmi2GetRealOutputDerivatives(fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr,
+	const fmi2_integer_t order[], fmi2_real_t value[])
+{
+	fmi2_status_t status;
+	void* out;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->sizes[0] = nvr;
+	fmi2_remote_put(&cur, vr, nvr * sizeof(fmi2_value_reference_t));
+	fmi2_remote_put(&cur, order, nvr * sizeof(fmi2_integer_t));
+	out = fmi2_remote_reserve(&cur, nvr * sizeof(fmi2_real_t));
+	status = fmi2_remote_call(r, &cur, fmi2_remote_get_real_output_derivatives);
+	if(status != fmi2_status_fatal && out) memcpy(value, out, nvr * sizeof(fmi2_real_t));
+	return status;
+}
+
+static fmi2_status_t fmi2_remote_fmi2DoStep(fmi2_component_t c, fmi2_real_t currentCommunicationPoint,
+	fmi2_real_t communicationStepSize, fmi2_boolean_t newStep)
+{
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->reals[0] = currentCommunicationPoint;
+	cur.ch->reals[1] = communicationStepSize;
+	cur.ch->ints[0] = newStep;
+	return fmi2_remote_call(r, &cur, fmi2_remote_do_step);
+}
+
+FMI2_REMOTE_STUB_GET_STATUS(fmi2GetStatus, get_status, fmi2_status_t)
+FMI2_REMOTE_STUB_GET_STATUS(fmi2GetRealStatus, get_real_status, fmi2_real_t)
+FMI2_REMOTE_STUB_GET_STATUS(fmi2GetIntegerStatus, get_integer_status, fmi2_integer_t)
+FMI2_REMOTE_STUB_GET_STATUS(fmi2GetBooleanStatus, get_boolean_status, fmi2_boolean_t)
+
+static fmi2_status_t fmi2_remote_fmi2GetStringStatus(fmi2_component_t c, const fmi2_status_kind_t s, fmi2_string_t* value)
+{
+	fmi2_status_t status;
+	FMI2_REMOTE_STUB_BEGIN(c)
+	cur.ch->ints[0] = (int)s;
+	status = fmi2_remote_call(r, &cur, fmi2_remote_get_string_status);
+	if(status != fmi2_status_fatal && !fmi2_remote_keep_strings(r, &cur, 1, value)) return fmi2_status_error;
+	return status;
+}
+
+/* The functions forwarded by stubs, in the order of their presence flags */
+#define FMI2_REMOTE_FORWARDED(X) \
+	X(free_instance, fmi2FreeInstance) \
+	X(set_debug_logging, fmi2SetDebugLogging) \
+	X(setup_experiment, fmi2SetupExperiment) \
+	X(enter_initialization_mode, fmi2EnterInitializationMode) \
+	X(exit_initialization_mode, fmi2ExitInitializationMode) \
+	X(terminate, fmi2Terminate) \
+	X(reset, fmi2Reset) \
+	X(set_real, fmi2SetReal) \
+	X(set_integer, fmi2SetInteger) \
+	X(set_boolean, fmi2SetBoolean) \
+	X(set_string, fmi2SetString) \
+	X(get_real, fmi2GetReal) \
+	X(get_integer, fmi2GetInteger) \
+	X(get_boolean, fmi2GetBoolean) \
+	X(get_string, fmi2GetString) \
+	X(get_fmu_state, fmi2GetFMUstate) \
+	X(set_fmu_state, fmi2SetFMUstate) \
+	X(free_fmu_state, fmi2FreeFMUstate) \
+	X(serialized_fmu_state_size, fmi2SerializedFMUstateSize) \
+	X(serialize_fmu_state, fmi2SerializeFMUstate) \
+	X(de_serialize_fmu_state, fmi2DeSerializeFMUstate) \
+	X(get_directional_derivative, fmi2GetDirectionalDerivative) \
+	X(enter_event_mode, fmi2EnterEventMode) \
+	X(new_discrete_states, fmi2NewDiscreteStates) \
+	X(enter_continuous_time_mode, fmi2EnterContinuousTimeMode) \
+	X(completed_integrator_step, fmi2CompletedIntegratorStep) \
+	X(set_time, fmi2SetTime) \
+	X(set_continuous_states, fmi2SetContinuousStates) \
+	X(get_derivatives, fmi2GetDerivatives) \
+	X(get_event_indicators, fmi2GetEventIndicators) \
+	X(get_continuous_states, fmi2GetContinuousStates) \
+	X(get_nominals_of_continuous_states, fmi2GetNominalsOfContinuousStates) \
+	X(set_real_input_derivatives, fmi2SetRealInputDerivatives) \
+	X(get_real_output_derivatives, fmi2GetRealOutputDerivatives) \
+	X(do_step, fmi2DoStep) \
+	X(cancel_step, fmi2CancelStep) \
+	X(get_status, fmi2GetStatus) \
+	X(get_real_status, fmi2GetRealStatus) \
+	X(get_integer_status, fmi2GetIntegerStatus) \
+	X(get_boolean_status, fmi2GetBooleanStatus) \
+	X(get_string_status, fmi2GetStringStatus)
+
+#define FMI2_REMOTE_INSTALL(ID, FCN) fmu->FCN = present[fmi2_remote_##ID] ? fmi2_remote_##FCN : 0;
+
+static void fmi2_remote_free_args(fmi2_capi_remote_t* r) {
+	jm_callbacks* cb = r->callbacks;
+	cb->free(r->instanceName);
+	cb->free(r->fmuGUID);
+	cb->free(r->fmuResourceLocation);
+	r->instanceName = r->fmuGUID = r->fmuResourceLocation = 0;
+}
+
+static char* fmi2_remote_strdup(jm_callbacks* cb, const char* s) {
+	char* copy;
+	if(!s) return 0;
+	copy = (char*)cb->malloc(strlen(s) + 1);
+	if(copy) strcpy(copy, s);
+	return copy;
+}
+
+/* Ask the host to exit, kill it if it does not, and unmap the channel */
+static void fmi2_remote_shutdown(fmi2_capi_remote_t* r) {
+	if(r->pid > 0 && !r->crashed) {
+		fmi2_remote_cursor_t cur;
+		double deadline = jm_portability_get_time() + FMI2_REMOTE_QUIT_TIMEOUT;
+		struct timespec ts;
+		fmi2_remote_cursor_init(&cur, r->ch);
+		fmi2_remote_call(r, &cur, fmi2_remote_quit);
+		ts.tv_sec = 0;
+		ts.tv_nsec = 1000000;
+		while(r->pid > 0 && jm_portability_get_time() < deadline) {
+			pid_t res = waitpid(r->pid, 0, WNOHANG);
+			if(res == r->pid || (res < 0 && errno != EINTR)) {
+				/* reaped, or not our child any more; the PID must not be signalled */
+				r->pid = 0;
+			}
+			else {
+				nanosleep(&ts, 0);
+			}
+		}
+	}
+	/* still running and not reaped */
+	if(r->pid > 0) {
+		kill(r->pid, SIGKILL);
+		waitpid(r->pid, 0, 0);
+	}
+	r->pid = 0;
+	if(r->ch) {
+		munmap((void*)r->ch, FMI2_REMOTE_SEGMENT_SIZE);
+		close(r->fd);
+	}
+	r->ch = 0;
+	r->fd = -1;
+}
+
+/* Create the shared segment, start the host and load the shared library in it */
+static jm_status_enu_t fmi2_remote_launch(fmi2_capi_remote_t* r) {
+	fmi2_capi_t* fmu = r->fmu;
+	fmi2_remote_cursor_t cur;
+	char path[FILENAME_MAX + 2];
+	char fdArg[32];
+	void* map;
+	pid_t pid;
+	int fd;
+
+	/* an unlinked file in shared memory, passed to the host as an inherited descriptor */
+	strcpy(path, (access("/dev/shm", W_OK) == 0) ? "/dev/shm/" : jm_get_system_temp_dir());
+	strcat(path, "fmil_host_XXXXXX");
+	fd = mkstemp(path);
+	if(fd < 0) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "Could not create the shared memory for the FMU host process: %s", strerror(errno));
+		return jm_status_error;
+	}
+	unlink(path);
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+	map = (ftruncate(fd, FMI2_REMOTE_SEGMENT_SIZE) == 0) ?
+		mmap(0, FMI2_REMOTE_SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+	if(map == MAP_FAILED) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "Could not map the shared memory for the FMU host process: %s", strerror(errno));
+		close(fd);
+		return jm_status_error;
+	}
+	r->fd = fd;
+	r->ch = (fmi2_remote_channel_t*)map;
+	r->crashed = 0;
+	r->launches++;
+
+	sprintf(fdArg, "%d", fd);
+	pid = fork();
+	if(pid == 0) {
+		/* the channel is passed to the host by clearing FD_CLOEXEC on its descriptor */
+		fcntl(fd, F_SETFD, 0);
+		execl(r->hostPath, r->hostPath, fdArg, (char*)0);
+		_exit(127);
+	}
+	if(pid < 0) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "Could not start the FMU host process: %s", strerror(errno));
+		fmi2_remote_shutdown(r);
+		return jm_status_error;
+	}
+	r->pid = pid;
+	jm_log_verbose(r->callbacks, FMI_CAPI_MODULE_NAME, "Started the FMU host process %d", (int)pid);
+
+	fmi2_remote_cursor_init(&cur, r->ch);
+	cur.ch->ints[0] = (int)fmu->standard;
+	cur.ch->ints[1] = (int)r->callbacks->log_level;
+	fmi2_remote_write_string(&cur, fmu->dllPath);
+	fmi2_remote_write_string(&cur, fmu->modelIdentifier);
+	if(fmi2_remote_call(r, &cur, fmi2_remote_load) != fmi2_status_ok) {
+		fmi2_remote_shutdown(r);
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+/* Resolve the functions in the host and install the stubs of the present ones */
+static jm_status_enu_t fmi2_remote_load_functions(fmi2_capi_remote_t* r, unsigned int capabilities[]) {
+	fmi2_capi_t* fmu = r->fmu;
+	fmi2_remote_cursor_t cur;
+	unsigned int* caps;
+	const int* present;
+	const char* s;
+
+	fmi2_remote_cursor_init(&cur, r->ch);
+	fmi2_remote_put(&cur, capabilities, fmi2_capabilities_Num * sizeof(unsigned int));
+	if(fmi2_remote_call(r, &cur, fmi2_remote_load_fcn) != fmi2_status_ok) {
+		return jm_status_error;
+	}
+	fmi2_remote_cursor_init(&cur, r->ch);
+	caps = (unsigned int*)fmi2_remote_reserve(&cur, fmi2_capabilities_Num * sizeof(unsigned int));
+	present = (const int*)fmi2_remote_reserve(&cur, fmi2_remote_fcn_num * sizeof(int));
+	/* the host resets the flags of missing functions */
+	memcpy(capabilities, caps, fmi2_capabilities_Num * sizeof(unsigned int));
+	s = fmi2_remote_read_string(&cur);
+	strncpy(r->version, s ? s : "", sizeof(r->version) - 1);
+	s = fmi2_remote_read_string(&cur);
+	strncpy(r->typesPlatform, s ? s : "", sizeof(r->typesPlatform) - 1);
+
+	FMI2_REMOTE_FORWARDED(FMI2_REMOTE_INSTALL)
+	/* the functions without a component are called through fmi2_capi_remote_* */
+	fmu->fmi2Instantiate = 0;
+	fmu->fmi2GetVersion = 0;
+	fmu->fmi2GetTypesPlatform = 0;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_capi_set_host(fmi2_capi_t* fmu, const char* hostPath)
+{
+	fmi2_capi_remote_t* r;
+
+	assert(fmu && !fmu->registryEntry);
+	if(fmu->remote) {
+		fmi2_capi_remote_free(fmu);
+	}
+	if(!hostPath) return jm_status_success;
+
+	r = (fmi2_capi_remote_t*)fmu->callbacks->calloc(1, sizeof(fmi2_capi_remote_t));
+	if(r) r->hostPath = fmi2_remote_strdup(fmu->callbacks, hostPath);
+	if(!r || !r->hostPath) {
+		if(r) fmu->callbacks->free(r);
+		jm_log_fatal(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Could not allocate memory");
+		return jm_status_error;
+	}
+	r->callbacks = fmu->callbacks;
+	r->fmu = fmu;
+	r->fd = -1;
+	fmu->remote = r;
+	return jm_status_success;
+}
+
+const char* fmi2_capi_get_host(fmi2_capi_t* fmu)
+{
+	return (fmu && fmu->remote) ? fmu->remote->hostPath : 0;
+}
+
+int fmi2_capi_is_host_crashed(fmi2_capi_t* fmu)
+{
+	fmi2_capi_remote_t* r = fmu ? fmu->remote : 0;
+	if(!r) return 0;
+	if(r->pid > 0 && r->ch->state == FMI2_REMOTE_IDLE) fmi2_remote_host_alive(r);
+	return r->crashed;
+}
+
+unsigned long fmi2_capi_get_host_pid(fmi2_capi_t* fmu)
+{
+	return (fmu && fmu->remote && fmu->remote->pid > 0) ? (unsigned long)fmu->remote->pid : 0;
+}
+
+jm_status_enu_t fmi2_capi_restart_host(fmi2_capi_t* fmu, const fmi2_byte_t snapshot[], size_t size)
+{
+	fmi2_capi_remote_t* r = fmu ? fmu->remote : 0;
+	fmi2_component_t c = (fmi2_component_t)r;
+	fmi2_FMU_state_t state = 0;
+	fmi2_status_t status = fmi2_status_ok;
+	int tracing;
+
+	if(!r || !fmu->capabilities) {
+		if(fmu) jm_log_error(fmu->callbacks, FMI_CAPI_MODULE_NAME, "The FMU is not loaded in a host process");
+		return jm_status_error;
+	}
+	jm_log_info(r->callbacks, FMI_CAPI_MODULE_NAME, "Restarting the FMU host process");
+	fmi2_remote_shutdown(r);
+	/* the stubs are installed under the tracing shims */
+	tracing = fmi2_capi_get_tracing(fmu);
+	if(tracing) fmi2_capi_set_tracing(fmu, 0);
+	if(fmi2_remote_launch(r) != jm_status_success ||
+	   fmi2_capi_load_fcn(fmu, fmu->capabilities) != jm_status_success) {
+		fmi2_remote_shutdown(r);
+		r->crashed = 1;
+		if(tracing) fmi2_capi_set_tracing(fmu, 1);
+		return jm_status_error;
+	}
+	if(tracing) fmi2_capi_set_tracing(fmu, 1);
+	if(!r->isInstantiated) return jm_status_success;
+
+	/* bring a new instance to the mode of the lost one */
+	if(!fmi2_capi_remote_instantiate(fmu, r->instanceName, (fmi2_type_t)r->fmuType, r->fmuGUID, r->fmuResourceLocation,
+		r->visible, r->loggingOn)) {
+		return jm_status_error;
+	}
+	if(r->isExperimentSet) {
+		status = fmi2_remote_fmi2SetupExperiment(c, r->toleranceDefined, r->tolerance, r->startTime, r->stopTimeDefined, r->stopTime);
+	}
+	if(r->isInitialized && status < fmi2_status_error) {
+		status = fmi2_remote_fmi2EnterInitializationMode(c);
+		if(status < fmi2_status_error) status = fmi2_remote_fmi2ExitInitializationMode(c);
+	}
+	if(snapshot && status < fmi2_status_error) {
+		if(!fmu->fmi2DeSerializeFMUstate || !fmu->fmi2SetFMUstate) {
+			jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "The FMU cannot restore serialized states");
+			return jm_status_error;
+		}
+		status = fmi2_remote_fmi2DeSerializeFMUstate(c, snapshot, size, &state);
+		if(status < fmi2_status_error) status = fmi2_remote_fmi2SetFMUstate(c, state);
+		if(state) fmi2_remote_fmi2FreeFMUstate(c, &state);
+	}
+	if(status >= fmi2_status_error) {
+		jm_log_error(r->callbacks, FMI_CAPI_MODULE_NAME, "Could not restore the FMU in the restarted host process");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_capi_remote_start(fmi2_capi_t* fmu)
+{
+	return fmi2_remote_launch(fmu->remote);
+}
+
+jm_status_enu_t fmi2_capi_remote_load_fcn(fmi2_capi_t* fmu, unsigned int capabilities[])
+{
+	if(fmi2_remote_load_functions(fmu->remote, capabilities) != jm_status_success) {
+		return jm_status_error;
+	}
+	fmu->capabilities = capabilities;
+	return jm_status_success;
+}
+
+void fmi2_capi_remote_stop(fmi2_capi_t* fmu)
+{
+	fmi2_remote_shutdown(fmu->remote);
+	fmu->remote->crashed = 0;
+}
+
+void fmi2_capi_remote_free(fmi2_capi_t* fmu)
+{
+	fmi2_capi_remote_t* r = fmu->remote;
+	jm_callbacks* cb = fmu->callbacks;
+	if(!r) return;
+	fmi2_remote_shutdown(r);
+	fmi2_remote_free_args(r);
+	cb->free(r->strings);
+	cb->free(r->hostPath);
+	cb->free(r);
+	fmu->remote = 0;
+}
+
+fmi2_component_t fmi2_capi_remote_instantiate(fmi2_capi_t* fmu, fmi2_string_t instanceName, fmi2_type_t fmuType,
+	fmi2_string_t fmuGUID, fmi2_string_t fmuResourceLocation, fmi2_boolean_t visible, fmi2_boolean_t loggingOn)
+{
+	fmi2_capi_remote_t* r = fmu->remote;
+	fmi2_remote_cursor_t cur;
+	jm_callbacks* cb = r->callbacks;
+
+	if(!fmi2_remote_begin(r, &cur)) return 0;
+	cur.ch->ints[0] = (int)fmuType;
+	cur.ch->ints[1] = visible;
+	cur.ch->ints[2] = loggingOn;
+	fmi2_remote_write_string(&cur, instanceName);
+	fmi2_remote_write_string(&cur, fmuGUID);
+	fmi2_remote_write_string(&cur, fmuResourceLocation);
+	if(fmi2_remote_call(r, &cur, fmi2_remote_instantiate) != fmi2_status_ok) {
+		return 0;
+	}
+
+	/* keep the arguments for a restart; instanceName may be the stored copy */
+	if(instanceName != r->instanceName) {
+		char *name = fmi2_remote_strdup(cb, instanceName), *guid = fmi2_remote_strdup(cb, fmuGUID),
+			*location = fmi2_remote_strdup(cb, fmuResourceLocation);
+		fmi2_remote_free_args(r);
+		r->instanceName = name;
+		r->fmuGUID = guid;
+		r->fmuResourceLocation = location;
+		r->fmuType = (int)fmuType;
+		r->visible = visible;
+		r->loggingOn = loggingOn;
+	}
+	r->isInstantiated = 1;
+	r->isExperimentSet = r->isInitialized = 0;
+	return (fmi2_component_t)r;
+}
+
+const char* fmi2_capi_remote_get_version(fmi2_capi_t* fmu)
+{
+	return fmu->remote->version;
+}
+
+const char* fmi2_capi_remote_get_types_platform(fmi2_capi_t* fmu)
+{
+	return fmu->remote->typesPlatform;
+}
+
+/* -------- Host process -------- */
+
+typedef struct fmi2_remote_host_t {
+	jm_callbacks callbacks;
+	fmi2_callback_functions_t fmuCallbacks;
+	unsigned int capabilities[fmi2_capabilities_Num];
+	fmi2_capi_t* capi;
+	fmi2_component_t c;
+	fmi2_string_t* strings; /* scratch for string values */
+	size_t stringsNum;
+	fmi2_FMU_state_t* states; /* FMU states by handle index, entry zero is unused */
+	size_t statesNum;
+} fmi2_remote_host_t;
+
+/* The channel of the host, used by the loggers */
+static fmi2_remote_channel_t* fmi2_remote_host_channel = 0;
+
+/* Serializes the loggers, since an FMU may log from threads of its own */
+static jm_mutex_t fmi2_remote_host_log_lock = JM_MUTEX_INITIALIZER;
+
+/* Append a record to the log area of the current call; dropped if it does not fit */
+static void fmi2_remote_log_v(int kind, int status, const char* category, const char* instanceName, const char* fmt, va_list args) {
+	fmi2_remote_channel_t* ch = fmi2_remote_host_channel;
+	size_t len1, len2, room;
+	char* p;
+	int n;
+
+	if(!ch) return;
+	category = category ? category : "";
+	instanceName = instanceName ? instanceName : "";
+	len1 = strlen(category) + 1;
+	len2 = strlen(instanceName) + 1;
+	jm_mutex_lock(&fmi2_remote_host_log_lock);
+	if(ch->logSize + 2 * sizeof(int) + len1 + len2 + 1 > FMI2_REMOTE_LOG_SIZE) {
+		jm_mutex_unlock(&fmi2_remote_host_log_lock);
+		return;
+	}
+	p = ch->log + ch->logSize;
+	memcpy(p, &kind, sizeof(int));
+	memcpy(p + sizeof(int), &status, sizeof(int));
+	p += 2 * sizeof(int);
+	memcpy(p, category, len1);
+	memcpy(p + len1, instanceName, len2);
+	p += len1 + len2;
+	room = FMI2_REMOTE_LOG_SIZE - (size_t)(p - ch->log);
+	n = jm_vsnprintf(p, room, fmt, args);
+	if(n < 0) p[0] = 0;
+	p[room - 1] = 0;
+	ch->logSize = (size_t)(p - ch->log) + strlen(p) + 1;
+	jm_mutex_unlock(&fmi2_remote_host_log_lock);
+}
+
+static void fmi2_remote_fmu_logger(fmi2_component_environment_t env, fmi2_string_t instanceName, fmi2_status_t status,
+	fmi2_string_t category, fmi2_string_t message, ...) {
+	va_list args;
+	(void)env;
+	va_start(args, message);
+	fmi2_remote_log_v(FMI2_REMOTE_LOG_FMU, (int)status, category, instanceName, message, args);
+	va_end(args);
+}
+
+static void fmi2_remote_library_log(int status, const char* module, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	fmi2_remote_log_v(FMI2_REMOTE_LOG_LIBRARY, status, module, "", fmt, args);
+	va_end(args);
+}
+
+static void fmi2_remote_library_logger(jm_callbacks* cb, jm_string module, jm_log_level_enu_t log_level, jm_string message) {
+	(void)cb;
+	fmi2_remote_library_log((int)log_level, module, "%s", message);
+}
+
+/* Read the strings written by fmi2_remote_put_strings to the scratch array */
+static fmi2_string_t* fmi2_remote_host_strings(fmi2_remote_host_t* h, fmi2_remote_cursor_t* cur, size_t n, int read) {
+	size_t i;
+	if(n > h->stringsNum) {
+		fmi2_string_t* strings = (fmi2_string_t*)h->callbacks.realloc((void*)h->strings, n * sizeof(fmi2_string_t));
+		if(!strings) return 0;
+		h->strings = strings;
+		h->stringsNum = n;
+	}
+	for(i = 0; read && i < n; i++) h->strings[i] = fmi2_remote_read_string(cur);
+	return h->strings;
+}
+
+/* Look up the FMU state of a handle index. Index zero is no state, which is only accepted
+   where the FMI function takes one. Returns zero for an unknown index. */
+static int fmi2_remote_host_state(fmi2_remote_host_t* h, size_t index, int required, fmi2_FMU_state_t* state) {
+	*state = 0;
+	if(index == 0 && !required) return 1;
+	if(index == 0 || index >= h->statesNum || !h->states[index]) {
+		jm_log_error(&h->callbacks, FMI_CAPI_MODULE_NAME, "Unknown FMU state handle %u", (unsigned)index);
+		return 0;
+	}
+	*state = h->states[index];
+	return 1;
+}
+
+/* Keep a state returned by the FMU under the given index, or under a free one if it is zero.
+   Returns the index, zero if the table cannot grow. */
+static size_t fmi2_remote_host_keep_state(fmi2_remote_host_t* h, size_t index, fmi2_FMU_state_t state) {
+	if(index == 0) {
+		for(index = 1; index < h->statesNum && h->states[index]; index++);
+	}
+	if(index >= h->statesNum) {
+		size_t num = h->statesNum ? 2 * h->statesNum : 16;
+		fmi2_FMU_state_t* states;
+		if(num > FMI2_REMOTE_STATE_INDEX_MASK + 1) num = FMI2_REMOTE_STATE_INDEX_MASK + 1;
+		states = (index < num) ? (fmi2_FMU_state_t*)h->callbacks.realloc((void*)h->states, num * sizeof(fmi2_FMU_state_t)) : 0;
+		if(!states) {
+			jm_log_error(&h->callbacks, FMI_CAPI_MODULE_NAME, "Too many FMU states");
+			return 0;
+		}
+		memset(states + h->statesNum, 0, (num - h->statesNum) * sizeof(fmi2_FMU_state_t));
+		h->states = states;
+		h->statesNum = num;
+	}
+	h->states[index] = state;
+	return index;
+}
+
+/* The states of an instance are released with it */
+static void fmi2_remote_host_drop_states(fmi2_remote_host_t* h) {
+	if(h->statesNum) memset((void*)h->states, 0, h->statesNum * sizeof(fmi2_FMU_state_t));
+}
+
+/* Return a state that was created or updated by the FMU under the index of the request */
+static fmi2_status_t fmi2_remote_host_return_state(fmi2_remote_host_t* h, fmi2_remote_channel_t* ch, fmi2_status_t status, fmi2_FMU_state_t state) {
+	size_t index;
+	if(status >= fmi2_status_error || !state) return status;
+	index = fmi2_remote_host_keep_state(h, ch->handle, state);
+	if(!index) {
+		if(h->capi->fmi2FreeFMUstate) h->capi->fmi2FreeFMUstate(h->c, &state);
+		return fmi2_status_error;
+	}
+	ch->handle = index;
+	return status;
+}
+
+#define FMI2_REMOTE_PRESENT(ID, FCN) present[fmi2_remote_##ID] = (h->capi->FCN != 0);
+
+static fmi2_status_t fmi2_remote_host_load(fmi2_remote_host_t* h, fmi2_remote_cursor_t* cur) {
+	fmi2_remote_channel_t* ch = cur->ch;
+	const char* dllPath = fmi2_remote_read_string(cur);
+	const char* modelIdentifier = fmi2_remote_read_string(cur);
+
+	h->callbacks.log_level = (jm_log_level_enu_t)ch->ints[1];
+	if(h->capi || !dllPath || !modelIdentifier) return fmi2_status_error;
+	h->capi = fmi2_capi_create_dllfmu(&h->callbacks, dllPath, modelIdentifier, &h->fmuCallbacks, (fmi2_fmu_kind_enu_t)ch->ints[0]);
+	if(!h->capi) return fmi2_status_error;
+	if(fmi2_capi_load_dll(h->capi) != jm_status_success) {
+		fmi2_capi_destroy_dllfmu(h->capi);
+		h->capi = 0;
+		return fmi2_status_error;
+	}
+	return fmi2_status_ok;
+}
+
+static fmi2_status_t fmi2_remote_host_load_fcn(fmi2_remote_host_t* h, fmi2_remote_cursor_t* cur) {
+	int present[fmi2_remote_fcn_num];
+	unsigned int* caps;
+
+	if(!h->capi) return fmi2_status_error;
+	memcpy(h->capabilities, fmi2_remote_reserve(cur, sizeof(h->capabilities)), sizeof(h->capabilities));
+	if(fmi2_capi_load_fcn(h->capi, h->capabilities) != jm_status_success) return fmi2_status_error;
+
+	memset(present, 0, sizeof(present));
+	FMI2_REMOTE_FORWARDED(FMI2_REMOTE_PRESENT)
+	fmi2_remote_cursor_init(cur, cur->ch);
+	caps = (unsigned int*)fmi2_remote_reserve(cur, sizeof(h->capabilities));
+	memcpy(caps, h->capabilities, sizeof(h->capabilities));
+	fmi2_remote_put(cur, present, sizeof(present));
+	fmi2_remote_write_string(cur, h->capi->fmi2GetVersion());
+	fmi2_remote_write_string(cur, h->capi->fmi2GetTypesPlatform());
+	return fmi2_status_ok;
+}
+
+/* Call the function of the request with the arguments from the data area */
+static fmi2_status_t fmi2_remote_host_dispatch(fmi2_remote_host_t* h, fmi2_remote_channel_t* ch) {
+	fmi2_capi_t* fmu = h->capi;
+	fmi2_component_t c = h->c;
+	fmi2_remote_cursor_t cur;
+	size_t n = ch->sizes[0];
+	fmi2_FMU_state_t state;
+	fmi2_status_t status;
+
+#define FMI2_REMOTE_ARRAY(TYPE, COUNT) ((TYPE*)fmi2_remote_reserve(&cur, (COUNT) * sizeof(TYPE)))
+#define FMI2_REMOTE_VR FMI2_REMOTE_ARRAY(const fmi2_value_reference_t, n)
+#define FMI2_REMOTE_CHECK(FCN) if(!fmu || !fmu->FCN) return fmi2_status_error;
+#define FMI2_REMOTE_STATE(REQUIRED) if(!fmi2_remote_host_state(h, ch->handle, REQUIRED, &state)) return fmi2_status_error;
+
+	fmi2_remote_cursor_init(&cur, ch);
+	switch(ch->fcn) {
+	case fmi2_remote_load:
+		return fmi2_remote_host_load(h, &cur);
+	case fmi2_remote_load_fcn:
+		return fmi2_remote_host_load_fcn(h, &cur);
+	case fmi2_remote_quit:
+		return fmi2_status_ok;
+	case fmi2_remote_instantiate: {
+		const char* instanceName = fmi2_remote_read_string(&cur);
+		const char* fmuGUID = fmi2_remote_read_string(&cur);
+		const char* fmuResourceLocation = fmi2_remote_read_string(&cur);
+		FMI2_REMOTE_CHECK(fmi2Instantiate)
+		if(h->c) fmu->fmi2FreeInstance(h->c);
+		fmi2_remote_host_drop_states(h);
+		h->c = fmu->fmi2Instantiate(instanceName, (fmi2_type_t)ch->ints[0], fmuGUID, fmuResourceLocation,
+			&h->fmuCallbacks, ch->ints[1], ch->ints[2]);
+		return h->c ? fmi2_status_ok : fmi2_status_error;
+	}
+	case fmi2_remote_free_instance:
+		FMI2_REMOTE_CHECK(fmi2FreeInstance)
+		if(h->c) fmu->fmi2FreeInstance(h->c);
+		fmi2_remote_host_drop_states(h);
+		h->c = 0;
+		return fmi2_status_ok;
+	default:
+		break;
+	}
+
+	/* the remaining functions need an instance */
+	if(!fmu || !c) return fmi2_status_error;
+	switch(ch->fcn) {
+	case fmi2_remote_set_debug_logging: {
+		fmi2_string_t* categories = fmi2_remote_host_strings(h, &cur, n, 1);
+		FMI2_REMOTE_CHECK(fmi2SetDebugLogging)
+		return fmu->fmi2SetDebugLogging(c, ch->ints[0], n, categories);
+	}
+	case fmi2_remote_setup_experiment:
+		FMI2_REMOTE_CHECK(fmi2SetupExperiment)
+		return fmu->fmi2SetupExperiment(c, ch->ints[0], ch->reals[0], ch->reals[1], ch->ints[1], ch->reals[2]);
+	case fmi2_remote_enter_initialization_mode:
+		FMI2_REMOTE_CHECK(fmi2EnterInitializationMode)
+		return fmu->fmi2EnterInitializationMode(c);
+	case fmi2_remote_exit_initialization_mode:
+		FMI2_REMOTE_CHECK(fmi2ExitInitializationMode)
+		return fmu->fmi2ExitInitializationMode(c);
+	case fmi2_remote_terminate:
+		FMI2_REMOTE_CHECK(fmi2Terminate)
+		return fmu->fmi2Terminate(c);
+	case fmi2_remote_reset:
+		FMI2_REMOTE_CHECK(fmi2Reset)
+		return fmu->fmi2Reset(c);
+	case fmi2_remote_set_real: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		FMI2_REMOTE_CHECK(fmi2SetReal)
+		return fmu->fmi2SetReal(c, vr, n, FMI2_REMOTE_ARRAY(const fmi2_real_t, n));
+	}
+	case fmi2_remote_set_integer: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		FMI2_REMOTE_CHECK(fmi2SetInteger)
+		return fmu->fmi2SetInteger(c, vr, n, FMI2_REMOTE_ARRAY(const fmi2_integer_t, n));
+	}
+	case fmi2_remote_set_boolean: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		FMI2_REMOTE_CHECK(fmi2SetBoolean)
+		return fmu->fmi2SetBoolean(c, vr, n, FMI2_REMOTE_ARRAY(const fmi2_boolean_t, n));
+	}
+	case fmi2_remote_set_string: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		fmi2_string_t* value = fmi2_remote_host_strings(h, &cur, n, 1);
+		FMI2_REMOTE_CHECK(fmi2SetString)
+		return value ? fmu->fmi2SetString(c, vr, n, value) : fmi2_status_error;
+	}
+	case fmi2_remote_get_real: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		FMI2_REMOTE_CHECK(fmi2GetReal)
+		return fmu->fmi2GetReal(c, vr, n, FMI2_REMOTE_ARRAY(fmi2_real_t, n));
+	}
+	case fmi2_remote_get_integer: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		FMI2_REMOTE_CHECK(fmi2GetInteger)
+		return fmu->fmi2GetInteger(c, vr, n, FMI2_REMOTE_ARRAY(fmi2_integer_t, n));
+	}
+	case fmi2_remote_get_boolean: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		FMI2_REMOTE_CHECK(fmi2GetBoolean)
+		return fmu->fmi2GetBoolean(c, vr, n, FMI2_REMOTE_ARRAY(fmi2_boolean_t, n));
+	}
+	case fmi2_remote_get_string: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		fmi2_string_t* value = fmi2_remote_host_strings(h, &cur, n, 0);
+		size_t i;
+		FMI2_REMOTE_CHECK(fmi2GetString)
+		if(!value) return fmi2_status_error;
+		status = fmu->fmi2GetString(c, vr, n, value);
+		for(i = 0; i < n; i++) fmi2_remote_write_string(&cur, value[i]);
+		return cur.overflow ? fmi2_status_error : status;
+	}
+	case fmi2_remote_get_fmu_state:
+		FMI2_REMOTE_CHECK(fmi2GetFMUstate)
+		FMI2_REMOTE_STATE(0)
+		status = fmu->fmi2GetFMUstate(c, &state);
+		return fmi2_remote_host_return_state(h, ch, status, state);
+	case fmi2_remote_set_fmu_state:
+		FMI2_REMOTE_CHECK(fmi2SetFMUstate)
+		FMI2_REMOTE_STATE(1)
+		return fmu->fmi2SetFMUstate(c, state);
+	case fmi2_remote_free_fmu_state:
+		FMI2_REMOTE_CHECK(fmi2FreeFMUstate)
+		FMI2_REMOTE_STATE(0)
+		if(!state) return fmi2_status_ok;
+		status = fmu->fmi2FreeFMUstate(c, &state);
+		if(status < fmi2_status_error) {
+			h->states[ch->handle] = 0;
+			ch->handle = 0;
+		}
+		return status;
+	case fmi2_remote_serialized_fmu_state_size:
+		FMI2_REMOTE_CHECK(fmi2SerializedFMUstateSize)
+		FMI2_REMOTE_STATE(1)
+		return fmu->fmi2SerializedFMUstateSize(c, state, &ch->sizes[0]);
+	case fmi2_remote_serialize_fmu_state:
+		FMI2_REMOTE_CHECK(fmi2SerializeFMUstate)
+		FMI2_REMOTE_STATE(1)
+		return fmu->fmi2SerializeFMUstate(c, state, FMI2_REMOTE_ARRAY(fmi2_byte_t, n), n);
+	case fmi2_remote_de_serialize_fmu_state:
+		FMI2_REMOTE_CHECK(fmi2DeSerializeFMUstate)
+		FMI2_REMOTE_STATE(0)
+		status = fmu->fmi2DeSerializeFMUstate(c, FMI2_REMOTE_ARRAY(const fmi2_byte_t, n), n, &state);
+		return fmi2_remote_host_return_state(h, ch, status, state);
+	case fmi2_remote_get_directional_derivative: {
+		size_t nv = ch->sizes[1];
+		const fmi2_value_reference_t* z_ref = FMI2_REMOTE_VR;
+		const fmi2_value_reference_t* v_ref = FMI2_REMOTE_ARRAY(const fmi2_value_reference_t, nv);
+		const fmi2_real_t* dv = FMI2_REMOTE_ARRAY(const fmi2_real_t, nv);
+		FMI2_REMOTE_CHECK(fmi2GetDirectionalDerivative)
+		return fmu->fmi2GetDirectionalDerivative(c, z_ref, n, v_ref, nv, dv, FMI2_REMOTE_ARRAY(fmi2_real_t, n));
+	}
+	case fmi2_remote_enter_event_mode:
+		FMI2_REMOTE_CHECK(fmi2EnterEventMode)
+		return fmu->fmi2EnterEventMode(c);
+	case fmi2_remote_new_discrete_states:
+		FMI2_REMOTE_CHECK(fmi2NewDiscreteStates)
+		return fmu->fmi2NewDiscreteStates(c, FMI2_REMOTE_ARRAY(fmi2_event_info_t, 1));
+	case fmi2_remote_enter_continuous_time_mode:
+		FMI2_REMOTE_CHECK(fmi2EnterContinuousTimeMode)
+		return fmu->fmi2EnterContinuousTimeMode(c);
+	case fmi2_remote_completed_integrator_step: {
+		fmi2_boolean_t enterEventMode = 0, terminateSimulation = 0;
+		FMI2_REMOTE_CHECK(fmi2CompletedIntegratorStep)
+		status = fmu->fmi2CompletedIntegratorStep(c, ch->ints[0], &enterEventMode, &terminateSimulation);
+		ch->ints[1] = enterEventMode;
+		ch->ints[2] = terminateSimulation;
+		return status;
+	}
+	case fmi2_remote_set_time:
+		FMI2_REMOTE_CHECK(fmi2SetTime)
+		return fmu->fmi2SetTime(c, ch->reals[0]);
+	case fmi2_remote_set_continuous_states:
+		FMI2_REMOTE_CHECK(fmi2SetContinuousStates)
+		return fmu->fmi2SetContinuousStates(c, FMI2_REMOTE_ARRAY(const fmi2_real_t, n), n);
+	case fmi2_remote_get_derivatives:
+		FMI2_REMOTE_CHECK(fmi2GetDerivatives)
+		return fmu->fmi2GetDerivatives(c, FMI2_REMOTE_ARRAY(fmi2_real_t, n), n);
+	case fmi2_remote_get_event_indicators:
+		FMI2_REMOTE_CHECK(fmi2GetEventIndicators)
+		return fmu->fmi2GetEventIndicators(c, FMI2_REMOTE_ARRAY(fmi2_real_t, n), n);
+	case fmi2_remote_get_continuous_states:
+		FMI2_REMOTE_CHECK(fmi2GetContinuousStates)
+		return fmu->fmi2GetContinuousStates(c, FMI2_REMOTE_ARRAY(fmi2_real_t, n), n);
+	case fmi2_remote_get_nominals_of_continuous_states:
+		FMI2_REMOTE_CHECK(fmi2GetNominalsOfContinuousStates)
+		return fmu->fmi2GetNominalsOfContinuousStates(c, FMI2_REMOTE_ARRAY(fmi2_real_t, n), n);
+	case fmi2_remote_set_real_input_derivatives: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		const fmi2_integer_t* order = FMI2_REMOTE_ARRAY(const fmi2_integer_t, n);
+		FMI2_REMOTE_CHECK(fmi2SetRealInputDerivatives)
+		return fmu->fmi2SetRealInputDerivatives(c, vr, n, order, FMI2_REMOTE_ARRAY(const fmi2_real_t, n));
+	}
+	case fmi2_remote_get_real_output_derivatives: {
+		const fmi2_value_reference_t* vr = FMI2_REMOTE_VR;
+		const fmi2_integer_t* order = FMI2_REMOTE_ARRAY(const fmi2_integer_t, n);
+		FMI2_REMOTE_CHECK(fmi2GetRealOutputDerivatives)
+		return fmu->fmi2GetRealOutputDerivatives(c, vr, n, order, FMI2_REMOTE_ARRAY(fmi2_real_t, n));
+	}
+	case fmi2_remote_do_step:
+		FMI2_REMOTE_CHECK(fmi2DoStep)
+		return fmu->fmi2DoStep(c, ch->reals[0], ch->reals[1], ch->ints[0]);
+	case fmi2_remote_cancel_step:
+		FMI2_REMOTE_CHECK(fmi2CancelStep)
+		return fmu->fmi2CancelStep(c);
+	case fmi2_remote_get_status:
+		FMI2_REMOTE_CHECK(fmi2GetStatus)
+		return fmu->fmi2GetStatus(c, (fmi2_status_kind_t)ch->ints[0], FMI2_REMOTE_ARRAY(fmi2_status_t, 1));
+	case fmi2_remote_get_real_status:
+		FMI2_REMOTE_CHECK(fmi2GetRealStatus)
+		return fmu->fmi2GetRealStatus(c, (fmi2_status_kind_t)ch->ints[0], FMI2_REMOTE_ARRAY(fmi2_real_t, 1));
+	case fmi2_remote_get_integer_status:
+		FMI2_REMOTE_CHECK(fmi2GetIntegerStatus)
+		return fmu->fmi2GetIntegerStatus(c, (fmi2_status_kind_t)ch->ints[0], FMI2_REMOTE_ARRAY(fmi2_integer_t, 1));
+	case fmi2_remote_get_boolean_status:
+		FMI2_REMOTE_CHECK(fmi2GetBooleanStatus)
+		return fmu->fmi2GetBooleanStatus(c, (fmi2_status_kind_t)ch->ints[0], FMI2_REMOTE_ARRAY(fmi2_boolean_t, 1));
+	case fmi2_remote_get_string_status: {
+		fmi2_string_t value = 0;
+		FMI2_REMOTE_CHECK(fmi2GetStringStatus)
+		status = fmu->fmi2GetStringStatus(c, (fmi2_status_kind_t)ch->ints[0], &value);
+		fmi2_remote_write_string(&cur, value);
+		return status;
+	}
+	default:
+		return fmi2_status_error;
+	}
+#undef FMI2_REMOTE_ARRAY
+#undef FMI2_REMOTE_VR
+#undef FMI2_REMOTE_CHECK
+#undef FMI2_REMOTE_STATE
+}
+
+int fmi2_remote_serve(int fd)
+{
+	fmi2_remote_host_t h;
+	fmi2_remote_channel_t* ch;
+	pid_t parent = getppid();
+	void* map;
+	int quit = 0;
+	long spin;
+
+	map = mmap(0, FMI2_REMOTE_SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(map == MAP_FAILED) return 1;
+	ch = (fmi2_remote_channel_t*)map;
+	fmi2_remote_host_channel = ch;
+
+	memset(&h, 0, sizeof(h));
+	h.callbacks = *jm_get_default_callbacks();
+	h.callbacks.logger = fmi2_remote_library_logger;
+	h.fmuCallbacks.logger = fmi2_remote_fmu_logger;
+	h.fmuCallbacks.allocateMemory = calloc;
+	h.fmuCallbacks.freeMemory = free;
+
+	while(!quit) {
+		for(spin = 0; spin < FMI2_REMOTE_SPIN && ch->state != FMI2_REMOTE_REQUEST; spin++);
+		while(ch->state != FMI2_REMOTE_REQUEST) {
+			fmi2_remote_wait(ch, ch->state, FMI2_REMOTE_HOST_POLL_INTERVAL);
+			if(ch->state != FMI2_REMOTE_REQUEST && getppid() != parent) {
+				/* the importing process is gone */
+				quit = 1;
+				break;
+			}
+		}
+		if(quit) break;
+		__sync_synchronize();
+		ch->status = fmi2_remote_host_dispatch(&h, ch);
+		quit = (ch->fcn == fmi2_remote_quit);
+		fmi2_remote_post(ch, FMI2_REMOTE_RESPONSE);
+	}
+
+	fmi2_remote_host_channel = 0;
+	if(h.capi) {
+		if(h.c) h.capi->fmi2FreeInstance(h.c);
+		fmi2_capi_free_dll(h.capi);
+		fmi2_capi_destroy_dllfmu(h.capi);
+	}
+	h.callbacks.free((void*)h.strings);
+	h.callbacks.free((void*)h.states);
+	munmap(map, FMI2_REMOTE_SEGMENT_SIZE);
+	return 0;
+}
+
+#else /* FMI2_REMOTE_SUPPORTED */
+
+void fmi2_remote_wait(fmi2_remote_channel_t* ch, int value, double timeout) {
+	(void)ch; (void)value; (void)timeout;
+}
+
+void fmi2_remote_wake(fmi2_remote_channel_t* ch) {
+	(void)ch;
+}
+
+jm_status_enu_t fmi2_capi_set_host(fmi2_capi_t* fmu, const char* hostPath)
+{
+	if(!hostPath) return jm_status_success;
+	jm_log_error(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Running FMUs in a host process is not supported on this platform");
+	return jm_status_error;
+}
+
+const char* fmi2_capi_get_host(fmi2_capi_t* fmu) { (void)fmu; return 0; }
+int fmi2_capi_is_host_crashed(fmi2_capi_t* fmu) { (void)fmu; return 0; }
+unsigned long fmi2_capi_get_host_pid(fmi2_capi_t* fmu) { (void)fmu; return 0; }
+
+jm_status_enu_t fmi2_capi_restart_host(fmi2_capi_t* fmu, const fmi2_byte_t snapshot[], size_t size)
+{
+	(void)snapshot; (void)size;
+	if(fmu) jm_log_error(fmu->callbacks, FMI_CAPI_MODULE_NAME, "The FMU is not loaded in a host process");
+	return jm_status_error;
+}
+
+jm_status_enu_t fmi2_capi_remote_start(fmi2_capi_t* fmu) { (void)fmu; return jm_status_error; }
+jm_status_enu_t fmi2_capi_remote_load_fcn(fmi2_capi_t* fmu, unsigned int capabilities[]) { (void)fmu; (void)capabilities; return jm_status_error; }
+void fmi2_capi_remote_stop(fmi2_capi_t* fmu) { (void)fmu; }
+void fmi2_capi_remote_free(fmi2_capi_t* fmu) { (void)fmu; }
+
+fmi2_component_t fmi2_capi_remote_instantiate(fmi2_capi_t* fmu, fmi2_string_t instanceName, fmi2_type_t fmuType,
+	fmi2_string_t fmuGUID, fmi2_string_t fmuResourceLocation, fmi2_boolean_t visible, fmi2_boolean_t loggingOn)
+{
+	(void)fmu; (void)instanceName; (void)fmuType; (void)fmuGUID; (void)fmuResourceLocation; (void)visible; (void)loggingOn;
+	return 0;
+}
+
+const char* fmi2_capi_remote_get_version(fmi2_capi_t* fmu) { (void)fmu; return 0; }
+const char* fmi2_capi_remote_get_types_platform(fmi2_capi_t* fmu) { (void)fmu; return 0; }
+
+int fmi2_remote_serve(int fd) { (void)fd; return 1; }
+
+#endif /* FMI2_REMOTE_SUPPORTED */
@@ -0,0 +1,141 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef FMI2_CAPI_REMOTE_H_
+#define FMI2_CAPI_REMOTE_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Channel between the importing process and the host process running the FMU binary.
+   The channel is a shared memory segment with room for one call at a time: the
+   importer writes the arguments and bulk arrays, switches the state to request and
+   waits for the host to switch it to response.
+   One slot is enough since each host serves a single FMU instance, whose FMI calls
+   are synchronous and must not overlap: the caller needs the status and outputs of
+   a call before it makes the next one, so a queue of requests would never hold more
+   than one entry. Concurrency comes from running instances in hosts of their own. */
+
+/* Size of the shared segment, and of the area for the messages logged during a call */
+#define FMI2_REMOTE_SEGMENT_SIZE (16 * 1024 * 1024)
+#define FMI2_REMOTE_LOG_SIZE (64 * 1024)
+
+/* Values of the channel state */
+#define FMI2_REMOTE_IDLE 0
+#define FMI2_REMOTE_REQUEST 1
+#define FMI2_REMOTE_RESPONSE 2
+
+/* FMU states stay in the host, in a table indexed by the low bits of the state handles
+   seen by the importer. Index zero is no state. */
+#define FMI2_REMOTE_STATE_INDEX_BITS 16
+#define FMI2_REMOTE_STATE_INDEX_MASK (((size_t)1 << FMI2_REMOTE_STATE_INDEX_BITS) - 1)
+
+/* Kinds of forwarded log records */
+#define FMI2_REMOTE_LOG_FMU 0     /* from the logger callback of the FMU */
+#define FMI2_REMOTE_LOG_LIBRARY 1 /* from the jm_callbacks of the host */
+
+typedef enum fmi2_remote_fcn_enu_t {
+	fmi2_remote_load,     /* load the shared library */
+	fmi2_remote_load_fcn, /* resolve the functions against the capability flags */
+	fmi2_remote_quit,
+	fmi2_remote_instantiate,
+	fmi2_remote_free_instance,
+	fmi2_remote_set_debug_logging,
+	fmi2_remote_setup_experiment,
+	fmi2_remote_enter_initialization_mode,
+	fmi2_remote_exit_initialization_mode,
+	fmi2_remote_terminate,
+	fmi2_remote_reset,
+	fmi2_remote_set_real,
+	fmi2_remote_set_integer,
+	fmi2_remote_set_boolean,
+	fmi2_remote_set_string,
+	fmi2_remote_get_real,
+	fmi2_remote_get_integer,
+	fmi2_remote_get_boolean,
+	fmi2_remote_get_string,
+	fmi2_remote_get_fmu_state,
+	fmi2_remote_set_fmu_state,
+	fmi2_remote_free_fmu_state,
+	fmi2_remote_serialized_fmu_state_size,
+	fmi2_remote_serialize_fmu_state,
+	fmi2_remote_de_serialize_fmu_state,
+	fmi2_remote_get_directional_derivative,
+	fmi2_remote_enter_event_mode,
+	fmi2_remote_new_discrete_states,
+	fmi2_remote_enter_continuous_time_mode,
+	fmi2_remote_completed_integrator_step,
+	fmi2_remote_set_time,
+	fmi2_remote_set_continuous_states,
+	fmi2_remote_get_derivatives,
+	fmi2_remote_get_event_indicators,
+	fmi2_remote_get_continuous_states,
+	fmi2_remote_get_nominals_of_continuous_states,
+	fmi2_remote_set_real_input_derivatives,
+	fmi2_remote_get_real_output_derivatives,
+	fmi2_remote_do_step,
+	fmi2_remote_cancel_step,
+	fmi2_remote_get_status,
+	fmi2_remote_get_real_status,
+	fmi2_remote_get_integer_status,
+	fmi2_remote_get_boolean_status,
+	fmi2_remote_get_string_status,
+	fmi2_remote_fcn_num
+} fmi2_remote_fcn_enu_t;
+
+typedef struct fmi2_remote_channel_t {
+	volatile int state;   /* FMI2_REMOTE_IDLE, _REQUEST or _RESPONSE; also the futex word */
+	int fcn;              /* fmi2_remote_fcn_enu_t */
+	int status;           /* status returned by the call */
+	int ints[4];          /* scalar arguments and results */
+	double reals[4];
+	size_t sizes[4];
+	size_t handle;        /* index of an FMU state in the table of the host process */
+	size_t logSize;       /* bytes of log records in log */
+	char log[FMI2_REMOTE_LOG_SIZE];
+	double data[1];       /* arrays and strings, to the end of the segment */
+} fmi2_remote_channel_t;
+
+#define FMI2_REMOTE_DATA_SIZE (FMI2_REMOTE_SEGMENT_SIZE - offsetof(fmi2_remote_channel_t, data))
+
+/* Position in the data area. The importer and the host reserve the same sequence of
+   items for a call, so the items are found at the same offsets on both sides. */
+typedef struct fmi2_remote_cursor_t {
+	fmi2_remote_channel_t* ch;
+	size_t pos;
+	int overflow;
+} fmi2_remote_cursor_t;
+
+/* Reserve bytes in the data area. Returns NULL and sets overflow if they do not fit. */
+void* fmi2_remote_reserve(fmi2_remote_cursor_t* cur, size_t bytes);
+
+/* Wait while the state equals value, at most timeout seconds. Spurious returns are possible. */
+void fmi2_remote_wait(fmi2_remote_channel_t* ch, int value, double timeout);
+
+/* Wake the other process waiting on the state */
+void fmi2_remote_wake(fmi2_remote_channel_t* ch);
+
+/* Serve the calls on the channel mapped from the file descriptor until told to quit.
+   This is the main loop of the host process. Returns the exit code of the host. */
+int fmi2_remote_serve(int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_CAPI_REMOTE_H_ */
@@ -0,0 +1,256 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+#include <assert.h>
+
+#include <JM/jm_portability.h>
+#include <FMI/fmi_call_stats.h>
+#include <FMI/fmi_trace_recorder.h>
+
+#include <FMI2/fmi2_capi_impl.h>
+
+/* Functions taking a component, except fmi2FreeInstance that returns no status */
+#define FMI2_TRACE_SHIMMED(X) \
+	X(fmi2SetDebugLogging) \
+	X(fmi2SetupExperiment) X(fmi2EnterInitializationMode) X(fmi2ExitInitializationMode) \
+	X(fmi2Terminate) X(fmi2Reset) \
+	X(fmi2SetReal) X(fmi2SetInteger) X(fmi2SetBoolean) X(fmi2SetString) \
+	X(fmi2GetReal) X(fmi2GetInteger) X(fmi2GetBoolean) X(fmi2GetString) \
+	X(fmi2GetFMUstate) X(fmi2SetFMUstate) X(fmi2FreeFMUstate) \
+	X(fmi2SerializedFMUstateSize) X(fmi2SerializeFMUstate) X(fmi2DeSerializeFMUstate) \
+	X(fmi2GetDirectionalDerivative) \
+	X(fmi2EnterEventMode) X(fmi2NewDiscreteStates) X(fmi2EnterContinuousTimeMode) X(fmi2CompletedIntegratorStep) \
+	X(fmi2SetTime) X(fmi2SetContinuousStates) \
+	X(fmi2GetDerivatives) X(fmi2GetEventIndicators) X(fmi2GetContinuousStates) X(fmi2GetNominalsOfContinuousStates) \
+	X(fmi2SetRealInputDerivatives) X(fmi2GetRealOutputDerivatives) X(fmi2DoStep) X(fmi2CancelStep) \
+	X(fmi2GetStatus) X(fmi2GetRealStatus) X(fmi2GetIntegerStatus) X(fmi2GetBooleanStatus) X(fmi2GetStringStatus)
+
+#define FMI2_TRACE_ID(FCN) fmi2_trace_##FCN,
+#define FMI2_TRACE_NAME(FCN) #FCN,
+
+typedef enum fmi2_trace_id_enu_t {
+	fmi2_trace_fmi2Instantiate,
+	fmi2_trace_fmi2FreeInstance,
+	FMI2_TRACE_SHIMMED(FMI2_TRACE_ID)
+	fmi2_trace_num
+} fmi2_trace_id_enu_t;
+
+static const char* fmi2_trace_names[] = {
+	"fmi2Instantiate",
+	"fmi2FreeInstance",
+	FMI2_TRACE_SHIMMED(FMI2_TRACE_NAME)
+};
+
+/* While tracing is on, the component passed to the functions is the trace */
+typedef struct fmi2_capi_trace_t {
+	fmi2_capi_t orig;     /* the untraced function pointers */
+	fmi2_component_t c;   /* the component returned by fmi2Instantiate */
+	int enabled;
+	char name[FMI_TRACE_RECORDER_CATEGORY_MAX + 1]; /* category of the recorded slices */
+	fmi_call_stats_t stats[fmi2_trace_num];
+} fmi2_capi_trace_t;
+
+static void fmi2_capi_trace_record(fmi2_capi_trace_t* trace, fmi2_trace_id_enu_t id, double start)
+{
+	double end = jm_portability_get_time();
+	fmi_call_stats_record(&trace->stats[id], end - start);
+	fmi_trace_recorder_slice(fmi2_trace_names[id], trace->name, start, end);
+}
+
+/* Shim calling the untraced function with the real component and timing the call */
+#define FMI2_TRACE_SHIM(FCN, PARAMS, ARGS) \
+static fmi2_status_t fmi2_trace_shim_##FCN PARAMS \
+{ \
+	fmi2_capi_trace_t* trace = (fmi2_capi_trace_t*)c; \
+	double start = jm_portability_get_time(); \
+	fmi2_status_t status = trace->orig.FCN ARGS; \
+	fmi2_capi_trace_record(trace, fmi2_trace_##FCN, start); \
+	return status; \
+}
+
+#define FMI2_TRACE_SHIM_VR(FCN, FTYPE) \
+	FMI2_TRACE_SHIM(FCN, (fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr, FTYPE value[]), (trace->c, vr, nvr, value))
+
+#define FMI2_TRACE_SHIM_STATUS(FCN, FTYPE) \
+	FMI2_TRACE_SHIM(FCN, (fmi2_component_t c, const fmi2_status_kind_t s, FTYPE* value), (trace->c, s, value))
+
+#define FMI2_TRACE_SHIM_ARRAY(FCN) \
+	FMI2_TRACE_SHIM(FCN, (fmi2_component_t c, fmi2_real_t x[], size_t nx), (trace->c, x, nx))
+
+#define FMI2_TRACE_SHIM_VOID(FCN) \
+	FMI2_TRACE_SHIM(FCN, (fmi2_component_t c), (trace->c))
+
+FMI2_TRACE_SHIM(fmi2SetDebugLogging, (fmi2_component_t c, fmi2_boolean_t loggingOn, size_t nCategories, const fmi2_string_t categories[]),
+	(trace->c, loggingOn, nCategories, categories))
+FMI2_TRACE_SHIM(fmi2SetupExperiment, (fmi2_component_t c, fmi2_boolean_t toleranceDefined, fmi2_real_t tolerance,
+	fmi2_real_t startTime, fmi2_boolean_t stopTimeDefined, fmi2_real_t stopTime),
+	(trace->c, toleranceDefined, tolerance, startTime, stopTimeDefined, stopTime))
+FMI2_TRACE_SHIM_VOID(fmi2EnterInitializationMode)
+FMI2_TRACE_SHIM_VOID(fmi2ExitInitializationMode)
+FMI2_TRACE_SHIM_VOID(fmi2Terminate)
+FMI2_TRACE_SHIM_VOID(fmi2Reset)
+
+FMI2_TRACE_SHIM_VR(fmi2SetReal, const fmi2_real_t)
+FMI2_TRACE_SHIM_VR(fmi2SetInteger, const fmi2_integer_t)
+FMI2_TRACE_SHIM_VR(fmi2SetBoolean, const fmi2_boolean_t)
+FMI2_TRACE_SHIM_VR(fmi2SetString, const fmi2_string_t)
+FMI2_TRACE_SHIM_VR(fmi2GetReal, fmi2_real_t)
+FMI2_TRACE_SHIM_VR(fmi2GetInteger, fmi2_integer_t)
+FMI2_TRACE_SHIM_VR(fmi2GetBoolean, fmi2_boolean_t)
+FMI2_TRACE_SHIM_VR(fmi2GetString, fmi2_string_t)
+
+FMI2_TRACE_SHIM(fmi2GetFMUstate, (fmi2_component_t c, fmi2_FMU_state_t* s), (trace->c, s))
+FMI2_TRACE_SHIM(fmi2SetFMUstate, (fmi2_component_t c, fmi2_FMU_state_t s), (trace->c, s))
+FMI2_TRACE_SHIM(fmi2FreeFMUstate, (fmi2_component_t c, fmi2_FMU_state_t* s), (trace->c, s))
+FMI2_TRACE_SHIM(fmi2SerializedFMUstateSize, (fmi2_component_t c, fmi2_FMU_state_t s, size_t* sz), (trace->c, s, sz))
+FMI2_TRACE_SHIM(fmi2SerializeFMUstate, (fmi2_component_t c, fmi2_FMU_state_t s, fmi2_byte_t data[], size_t sz), (trace->c, s, data, sz))
+FMI2_TRACE_SHIM(fmi2DeSerializeFMUstate, (fmi2_component_t c, const fmi2_byte_t data[], size_t sz, fmi2_FMU_state_t* s), (trace->c, data, sz, s))
+FMI2_TRACE_SHIM(fmi2GetDirectionalDerivative, (fmi2_component_t c, const fmi2_value_reference_t z_ref[], size_t nz,
+	const fmi2_value_reference_t v_ref[], size_t nv, const fmi2_real_t dv[], fmi2_real_t dz[]),
+	(trace->c, z_ref, nz, v_ref, nv, dv, dz))
+
+FMI2_TRACE_SHIM_VOID(fmi2EnterEventMode)
+FMI2_TRACE_SHIM(fmi2NewDiscreteStates, (fmi2_component_t c, fmi2_event_info_t* eventInfo), (trace->c, eventInfo))
+FMI2_TRACE_SHIM_VOID(fmi2EnterContinuousTimeMode)
+FMI2_TRACE_SHIM(fmi2CompletedIntegratorStep, (fmi2_component_t c, fmi2_boolean_t noSetFMUStatePriorToCurrentPoint,
+	fmi2_boolean_t* enterEventMode, fmi2_boolean_t* terminateSimulation),
+	(trace->c, noSetFMUStatePriorToCurrentPoint, enterEventMode, terminateSimulation))
+FMI2_TRACE_SHIM(fmi2SetTime, (fmi2_component_t c, fmi2_real_t time), (trace->c, time))
+FMI2_TRACE_SHIM(fmi2SetContinuousStates, (fmi2_component_t c, const fmi2_real_t x[], size_t nx), (trace->c, x, nx))
+FMI2_TRACE_SHIM_ARRAY(fmi2GetDerivatives)
+FMI2_TRACE_SHIM_ARRAY(fmi2GetEventIndicators)
+FMI2_TRACE_SHIM_ARRAY(fmi2GetContinuousStates)
+FMI2_TRACE_SHIM_ARRAY(fmi2GetNominalsOfContinuousStates)
+
+FMI2_TRACE_SHIM(fmi2SetRealInputDerivatives, (fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr,
+	const fmi2_integer_t order[], const fmi2_real_t value[]), (trace->c, vr, nvr, order, value))
+FMI2_TRACE_SHIM(fmi2GetRealOutputDerivatives, (fmi2_component_t c, const fmi2_value_reference_t vr[], size_t nvr,
+	const fmi2_integer_t order[], fmi2_real_t value[]), (trace->c, vr, nvr, order, value))
+FMI2_TRACE_SHIM(fmi2DoStep, (fmi2_component_t c, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize,
+	fmi2_boolean_t newStep), (trace->c, currentCommunicationPoint, communicationStepSize, newStep))
+FMI2_TRACE_SHIM_VOID(fmi2CancelStep)
+FMI2_TRACE_SHIM_STATUS(fmi2GetStatus, fmi2_status_t)
+FMI2_TRACE_SHIM_STATUS(fmi2GetRealStatus, fmi2_real_t)
+FMI2_TRACE_SHIM_STATUS(fmi2GetIntegerStatus, fmi2_integer_t)
+FMI2_TRACE_SHIM_STATUS(fmi2GetBooleanStatus, fmi2_boolean_t)
+FMI2_TRACE_SHIM_STATUS(fmi2GetStringStatus, fmi2_string_t)
+
+/* The component is gone after fmi2FreeInstance */
+static void fmi2_trace_shim_fmi2FreeInstance(fmi2_component_t c)
+{
+	fmi2_capi_trace_t* trace = (fmi2_capi_trace_t*)c;
+	double start = jm_portability_get_time();
+	trace->orig.fmi2FreeInstance(trace->c);
+	fmi2_capi_trace_record(trace, fmi2_trace_fmi2FreeInstance, start);
+	trace->c = 0;
+}
+
+/* Point the functions that are present in the untraced table to the shims */
+#define FMI2_TRACE_SWAP(FCN) if(trace->orig.FCN) fmu->FCN = fmi2_trace_shim_##FCN;
+
+static void fmi2_capi_trace_reset(fmi2_capi_trace_t* trace)
+{
+	size_t i;
+	memset(trace->stats, 0, sizeof(trace->stats));
+	for(i = 0; i < fmi2_trace_num; i++) {
+		trace->stats[i].name = fmi2_trace_names[i];
+	}
+}
+
+jm_status_enu_t fmi2_capi_set_tracing(fmi2_capi_t* fmu, int enable)
+{
+	fmi2_capi_trace_t* trace;
+
+	assert(fmu);
+	if(!fmu->trace) {
+		if(!enable) return jm_status_success;
+		fmu->trace = (fmi2_capi_trace_t*)fmu->callbacks->calloc(1, sizeof(fmi2_capi_trace_t));
+		if(!fmu->trace) {
+			jm_log_fatal(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Could not allocate memory for the call statistics");
+			return jm_status_error;
+		}
+		fmi2_capi_trace_reset(fmu->trace);
+		strncpy(fmu->trace->name, fmu->modelIdentifier, FMI_TRACE_RECORDER_CATEGORY_MAX);
+	}
+	trace = fmu->trace;
+	if(!enable == !trace->enabled) return jm_status_success;
+
+	if(enable) {
+		trace->orig = *fmu;
+		trace->c = fmu->c;
+		if(fmu->c) fmu->c = (fmi2_component_t)trace;
+		FMI2_TRACE_SWAP(fmi2FreeInstance)
+		FMI2_TRACE_SHIMMED(FMI2_TRACE_SWAP)
+	}
+	else {
+		fmi2_capi_copy_fcn(fmu, &trace->orig);
+		fmu->c = trace->c;
+	}
+	trace->enabled = enable ? 1 : 0;
+	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Call tracing %s", enable ? "on" : "off");
+	return jm_status_success;
+}
+
+int fmi2_capi_get_tracing(fmi2_capi_t* fmu)
+{
+	return fmu && fmu->trace && fmu->trace->enabled;
+}
+
+size_t fmi2_capi_get_call_stats(fmi2_capi_t* fmu, fmi_call_stats_t stats[], size_t n)
+{
+	size_t i;
+	for(i = 0; i < n && i < fmi2_trace_num; i++) {
+		if(fmu && fmu->trace) {
+			stats[i] = fmu->trace->stats[i];
+		}
+		else {
+			memset(&stats[i], 0, sizeof(stats[i]));
+			stats[i].name = fmi2_trace_names[i];
+		}
+	}
+	return fmi2_trace_num;
+}
+
+void fmi2_capi_reset_call_stats(fmi2_capi_t* fmu)
+{
+	if(fmu && fmu->trace) fmi2_capi_trace_reset(fmu->trace);
+}
+
+fmi2_component_t fmi2_capi_get_component(fmi2_capi_t* fmu)
+{
+	return (fmu->trace && fmu->trace->enabled) ? fmu->trace->c : fmu->c;
+}
+
+const fmi2_capi_t* fmi2_capi_get_fcn_table(fmi2_capi_t* fmu)
+{
+	return (fmu->trace && fmu->trace->enabled) ? &fmu->trace->orig : fmu;
+}
+
+void fmi2_capi_trace_instantiated(fmi2_capi_t* fmu, const char* instanceName, double startTime)
+{
+	fmi2_capi_trace_t* trace = fmu->trace;
+	if(!trace || !trace->enabled) return;
+	if(instanceName) strncpy(trace->name, instanceName, FMI_TRACE_RECORDER_CATEGORY_MAX);
+	fmi2_capi_trace_record(trace, fmi2_trace_fmi2Instantiate, startTime);
+	trace->c = fmu->c;
+	if(fmu->c) fmu->c = (fmi2_component_t)trace;
+}
+
+void fmi2_capi_trace_free(fmi2_capi_t* fmu)
+{
+	fmu->callbacks->free(fmu->trace);
+	fmu->trace = 0;
+}
@@ -0,0 +1,174 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi_import_solver.h
+*  \brief Built-in integrators for model exchange FMUs.
+*/
+
+#ifndef FMI_IMPORT_SOLVER_H_
+#define FMI_IMPORT_SOLVER_H_
+
+#include <stddef.h>
+#include <fmilib_config.h>
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI1/fmi1_functions.h>
+#include <FMI2/fmi2_functions.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+\addtogroup fmi_import
+@{
+\addtogroup fmi_import_solver Model exchange solvers
+@}
+\addtogroup fmi_import_solver
+\brief Integrate a model exchange FMU over time, including event handling.
+
+The solver drives an instantiated and initialized FMI 1.0 or 2.0 model exchange FMU through the
+FMI functions: it sets time and continuous states, evaluates the derivatives, and handles
+events. All working vectors are allocated once in a single contiguous buffer when the solver is
+created, so integration does not allocate memory. Nothing is logged while integrating unless an
+FMI function fails.
+
+After every step the event indicators are compared with those of the previous step with
+fmi_import_find_zero_crossings(). A sign change is a state event. Fixed step methods complete the step that contains the crossing and
+handle the event at its end. ::fmi_import_solver_dopri5 locates the crossing within the step:
+the states are interpolated with the dense output of the method and the event indicators are
+evaluated at the interpolated states, refining the crossing time with the Illinois variant of
+regula falsi. The step is then truncated at the crossing, without repeating any derivative
+evaluation.
+
+Steps are shortened to hit time events exactly. The completed integrator step function is
+called after every step and may request step events. Events are handled by the event iteration
+of the FMI version (fmi2NewDiscreteStates or fmiEventUpdate), after which the continuous states
+and nominals are read back from the FMU if they changed.
+@{
+*/
+
+/** \brief Opaque model exchange solver. */
+typedef struct fmi_import_solver_t fmi_import_solver_t;
+
+/** \brief Integration method. */
+typedef enum fmi_import_solver_method_enu_t {
+	fmi_import_solver_euler,  /**< \brief Explicit Euler, first order, one derivative evaluation per step */
+	fmi_import_solver_heun,   /**< \brief Heun's method, second order, two derivative evaluations per step */
+	fmi_import_solver_rk4,    /**< \brief Classical Runge-Kutta, fourth order, four derivative evaluations per step */
+	fmi_import_solver_dopri5  /**< \brief Dormand-Prince 5(4) with step size control, six derivative evaluations per step */
+} fmi_import_solver_method_enu_t;
+
+/** \brief Counters of the work done by a solver. */
+typedef struct fmi_import_solver_stats_t {
+	size_t stepsNum;              /**< \brief Number of completed integrator steps */
+	size_t rejectedStepsNum;      /**< \brief Steps repeated with a smaller step size because of the error estimate */
+	size_t derivativesNum;        /**< \brief Number of derivative evaluations */
+	size_t eventIndicatorsNum;    /**< \brief Number of event indicator evaluations, including event localisation */
+	size_t stateEventsNum;        /**< \brief Events triggered by a sign change of an event indicator */
+	size_t timeEventsNum;         /**< \brief Events triggered by reaching the next event time */
+	size_t stepEventsNum;         /**< \brief Events requested when completing an integrator step */
+} fmi_import_solver_stats_t;
+
+/** \brief Create a solver for an FMI 1.0 model exchange FMU.
+	@param fmu An FMU object that has loaded the model exchange FMI functions, see fmi1_import_create_dllfmu().
+	       The FMU must stay valid as long as the solver is used.
+	@param method Integration method.
+	@return A new solver or NULL on error.
+*/
+FMILIB_EXPORT fmi_import_solver_t* fmi1_import_solver_allocate(fmi1_import_t* fmu, fmi_import_solver_method_enu_t method);
+
+/** \brief Create a solver for an FMI 2.0 model exchange FMU.
+	@param fmu An FMU object that has loaded the model exchange FMI functions, see fmi2_import_create_dllfmu().
+	       The FMU must stay valid as long as the solver is used.
+	@param method Integration method.
+	@return A new solver or NULL on error.
+*/
+FMILIB_EXPORT fmi_import_solver_t* fmi2_import_solver_allocate(fmi2_import_t* fmu, fmi_import_solver_method_enu_t method);
+
+/** \brief Free a solver. The FMU is not affected. */
+FMILIB_EXPORT void fmi_import_solver_free(fmi_import_solver_t* s);
+
+/** \brief Set the step size of fixed step methods, or the initial step size of adaptive methods. The default is 1e-3.
+	@return Error status. Fails if the step size is not positive.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_import_solver_set_step_size(fmi_import_solver_t* s, double stepSize);
+
+/** \brief Set the relative tolerance of adaptive methods. The default is 1e-6.
+	The error of each state is measured relative to the tolerance times the sum of the
+	magnitude of the state and its nominal value, so the nominals act as absolute tolerances.
+	@return Error status. Fails if the tolerance is not positive.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_import_solver_set_tolerance(fmi_import_solver_t* s, double relativeTolerance);
+
+/** \brief Set the hysteresis of state event detection. The default is zero.
+	An indicator only triggers an event when it passes zero by more than epsilon,
+	see fmi_import_find_zero_crossings(). Its sign is taken from the last value outside
+	the band, so an indicator that passes through the band over several steps still
+	triggers the event.
+	@return Error status. Fails if epsilon is negative.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_import_solver_set_event_hysteresis(fmi_import_solver_t* s, double epsilon);
+
+/** \brief Start integration of an FMI 1.0 FMU at the current point.
+	Must be called after fmi1_import_initialize().
+	@param s A solver created with fmi1_import_solver_allocate().
+	@param startTime Time of the initial point.
+	@param eventInfo The event information returned by fmi1_import_initialize().
+	@return The most severe status returned by the FMU.
+*/
+FMILIB_EXPORT fmi1_status_t fmi1_import_solver_initialize(fmi_import_solver_t* s, double startTime, const fmi1_event_info_t* eventInfo);
+
+/** \brief Start integration of an FMI 2.0 FMU at the current point.
+	Must be called after fmi2_import_exit_initialization_mode() while the FMU is in event mode.
+	The initial event iteration is performed and the FMU is switched to continuous time mode.
+	@param s A solver created with fmi2_import_solver_allocate().
+	@param startTime Time of the initial point, as given to fmi2_import_setup_experiment().
+	@return The most severe status returned by the FMU.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_solver_initialize(fmi_import_solver_t* s, double startTime);
+
+/** \brief Integrate until a time is reached or the FMU requests termination.
+	May be called repeatedly with increasing end times, for instance at output points.
+	@param s A solver.
+	@param endTime Time to integrate to.
+	@return The most severe status returned by the FMU, as an ::fmi1_status_t or ::fmi2_status_t value
+	        depending on the FMI version. Integration stops at the first error.
+*/
+FMILIB_EXPORT int fmi_import_solver_integrate(fmi_import_solver_t* s, double endTime);
+
+/** \brief Get the time reached by the solver. */
+FMILIB_EXPORT double fmi_import_solver_get_time(fmi_import_solver_t* s);
+
+/** \brief Get the continuous states at the time reached by the solver.
+	The array is owned by the solver and holds one value per continuous state of the FMU.
+*/
+FMILIB_EXPORT const double* fmi_import_solver_get_states(fmi_import_solver_t* s);
+
+/** \brief Check if the FMU requested to terminate the simulation. */
+FMILIB_EXPORT int fmi_import_solver_is_terminated(fmi_import_solver_t* s);
+
+/** \brief Get the work counters of a solver. */
+FMILIB_EXPORT void fmi_import_solver_get_stats(fmi_import_solver_t* s, fmi_import_solver_stats_t* stats);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI_IMPORT_SOLVER_H_ */
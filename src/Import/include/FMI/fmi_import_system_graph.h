@@ -0,0 +1,141 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi_import_system_graph.h
+*  \brief Direct feedthrough and algebraic loop analysis of coupled FMUs.
+*/
+
+#ifndef FMI_IMPORT_SYSTEM_GRAPH_H_
+#define FMI_IMPORT_SYSTEM_GRAPH_H_
+
+#include <stddef.h>
+#include <fmilib_config.h>
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+\addtogroup fmi_import
+@{
+\addtogroup fmi_import_system_graph System graph analysis
+@}
+\addtogroup fmi_import_system_graph
+\brief Evaluation order and algebraic loops of a system of connected FMUs.
+
+The nodes of the system graph are the input and output ports of all FMUs added to it.
+An edge from an input to an output of the same FMU is added for each direct dependency
+(fmi2_import_get_outputs_dependencies() for FMI 2.0 and fmi1_import_get_direct_dependency()
+for FMI 1.0). An edge from an output to an input is added for each connection.
+The strongly connected components of the graph, computed with Tarjan's algorithm,
+form the blocks of a block lower triangular (BLT) evaluation order. Blocks with more
+than one port are algebraic loops. The analysis runs in time linear in the number of
+ports, dependencies and connections.
+
+Variables are identified by their index in the list of model variables in the
+original order (see fmi2_import_get_variable_original_order()).
+@{
+*/
+
+/** \brief Opaque system graph structure. */
+typedef struct fmi_import_system_graph_t fmi_import_system_graph_t;
+
+/** \brief Allocate an empty system graph.
+	@param cb Callbacks for memory management and logging. May be NULL if defaults are utilized.
+	@return A new system graph or NULL on memory allocation failure.
+*/
+FMILIB_EXPORT fmi_import_system_graph_t* fmi_import_allocate_system_graph(jm_callbacks* cb);
+
+/** \brief Free a system graph. The FMUs added to the graph are not affected. */
+FMILIB_EXPORT void fmi_import_free_system_graph(fmi_import_system_graph_t* g);
+
+/** \brief Add the ports and direct feedthrough of an FMI 1.0 model to the graph.
+	The FMU must stay valid as long as connections are made by name.
+	@param g A system graph.
+	@param fmu An FMU object as returned by fmi1_import_parse_xml().
+	@param fmuIndex Output: index identifying the FMU in the graph.
+	@return Error status.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi1_import_add_to_system_graph(fmi_import_system_graph_t* g, fmi1_import_t* fmu, size_t* fmuIndex);
+
+/** \brief Add the ports and direct feedthrough of an FMI 2.0 model to the graph.
+	The FMU must stay valid as long as connections are made by name.
+	@param g A system graph.
+	@param fmu An FMU object as returned by fmi2_import_parse_xml().
+	@param fmuIndex Output: index identifying the FMU in the graph.
+	@return Error status.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_add_to_system_graph(fmi_import_system_graph_t* g, fmi2_import_t* fmu, size_t* fmuIndex);
+
+/** \brief Connect an output to an input. Each input may be connected only once.
+	@param g A system graph.
+	@param srcFmu Index of the FMU providing the output.
+	@param output Name of the output variable.
+	@param dstFmu Index of the FMU receiving the input.
+	@param input Name of the input variable.
+	@return Error status.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_import_system_graph_connect(fmi_import_system_graph_t* g, size_t srcFmu, const char* output, size_t dstFmu, const char* input);
+
+/** \brief Connect an output to an input, both identified by the original order index of the variable.
+	@see fmi_import_system_graph_connect()
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_import_system_graph_connect_by_index(fmi_import_system_graph_t* g, size_t srcFmu, size_t output, size_t dstFmu, size_t input);
+
+/** \brief Compute the strongly connected components and the evaluation order of the graph.
+	Must be called again after the graph has been modified.
+	@return Error status.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_import_system_graph_analyze(fmi_import_system_graph_t* g);
+
+/** \brief Get the number of ports (inputs and outputs of all FMUs) in the graph. */
+FMILIB_EXPORT size_t fmi_import_system_graph_get_ports_num(fmi_import_system_graph_t* g);
+
+/** \brief Get information about a port.
+	@param g A system graph.
+	@param port Port index.
+	@param fmuIndex Output: index of the FMU the port belongs to.
+	@param varIndex Output: original order index of the variable.
+	@param isOutput Output: 1 for outputs, 0 for inputs.
+*/
+FMILIB_EXPORT void fmi_import_system_graph_get_port(fmi_import_system_graph_t* g, size_t port, size_t* fmuIndex, size_t* varIndex, int* isOutput);
+
+/** \brief Get the number of blocks of the BLT evaluation order. Zero if the graph is not analyzed. */
+FMILIB_EXPORT size_t fmi_import_system_graph_get_blocks_num(fmi_import_system_graph_t* g);
+
+/** \brief Get the BLT evaluation order in compressed format.
+	@param g An analyzed system graph.
+	@param blockStart Output: pointer to an array of start indices (size of array is number of blocks + 1).
+	@param ports Output: pointer to the port indices of all blocks. Blocks are listed in evaluation order,
+	             i.e., a block only depends on ports in the same or earlier blocks.
+*/
+FMILIB_EXPORT void fmi_import_system_graph_get_blocks(fmi_import_system_graph_t* g, const size_t** blockStart, const size_t** ports);
+
+/** \brief Get the number of algebraic loops (blocks with more than one port). */
+FMILIB_EXPORT size_t fmi_import_system_graph_get_loops_num(fmi_import_system_graph_t* g);
+
+/** \brief Get the block indices of the algebraic loops in evaluation order. */
+FMILIB_EXPORT const size_t* fmi_import_system_graph_get_loops(fmi_import_system_graph_t* g);
+
+/** @} */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI_IMPORT_SYSTEM_GRAPH_H_ */
@@ -62,6 +62,31 @@ FMILIB_EXPORT char* fmi_import_get_dll_path(const char* fmu_unzipped_path, const
 	@return Pointer to a string with the file name. Caller is responsible for freeing the memory.
 */
 FMILIB_EXPORT char* fmi_import_get_model_description_path(const char* fmu_unzipped_path, jm_callbacks* callBackFunctions);
+
+/**
+	\brief Set the number of unused FMU binaries kept loaded.
+
+	FMU binaries and their resolved FMI functions are shared process-wide by all objects that
+	loaded the same binary (same canonical path and model identifier) with fmi1_import_create_dllfmu()
+	or fmi2_import_create_dllfmu(). A binary becomes unused when the last of them is destroyed.
+	By default it is unloaded right away. Keeping a number of unused binaries loaded, with the least
+	recently used ones unloaded first, avoids loading the same binary repeatedly.
+	Note that a binary that is kept loaded is not reloaded if the file is replaced on disk.
+	\param maxUnused - maximum number of unused binaries kept loaded.
+*/
+FMILIB_EXPORT void fmi_import_set_binary_cache_size(size_t maxUnused);
+
+/** \brief Get the number of unused FMU binaries kept loaded, see fmi_import_set_binary_cache_size(). */
+FMILIB_EXPORT size_t fmi_import_get_binary_cache_size(void);
+
+/**
+	\brief Unload all unused FMU binaries, see fmi_import_set_binary_cache_size().
+	\return Number of binaries unloaded.
+*/
+FMILIB_EXPORT size_t fmi_import_evict_unused_binaries(void);
+
+/** \brief Get the number of FMU binaries currently loaded by the library, used and unused. */
+FMILIB_EXPORT size_t fmi_import_get_loaded_binaries_num(void);
 /**
 @}
 @}
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi_import_zero_crossing.h
+*  \brief Detection of sign changes of event indicators.
+*/
+
+#ifndef FMI_IMPORT_ZERO_CROSSING_H_
+#define FMI_IMPORT_ZERO_CROSSING_H_
+
+#include <stddef.h>
+#include <fmilib_config.h>
+#include <JM/jm_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+\addtogroup fmi_import
+@{
+\addtogroup fmi_import_zero_crossing Zero crossing detection
+@}
+\addtogroup fmi_import_zero_crossing
+\brief Compare two arrays of event indicators and find the indicators that changed sign.
+
+The scan is vectorized with SSE2 or AVX2 when the library was built for a processor that
+supports them. The kernel is selected at the first call from the instruction sets reported by
+the processor, with a scalar loop as fallback, and can be overridden with
+fmi_import_set_zero_crossing_kernel().
+@{
+*/
+
+/** \brief Implementations of the zero crossing scan. */
+typedef enum fmi_import_zero_crossing_kernel_enu_t {
+	fmi_import_zero_crossing_scalar, /**< \brief Portable scalar loop */
+	fmi_import_zero_crossing_sse2,   /**< \brief Two indicators per instruction */
+	fmi_import_zero_crossing_avx2    /**< \brief Four indicators per instruction */
+} fmi_import_zero_crossing_kernel_enu_t;
+
+/** \brief Find the event indicators that crossed zero.
+
+	Indicator i crosses zero when it goes from positive, <tt>zPrev[i] > 0</tt>, to
+	<tt>z[i] <= -epsilon</tt>, or from <tt>zPrev[i] <= 0</tt> to <tt>z[i] > epsilon</tt>.
+	The hysteresis epsilon keeps indicators that hover around zero from triggering repeated
+	events; with epsilon zero this is a plain sign change. The result is the same for all kernels.
+
+	@param zPrev Event indicators at the start of the step, for instance from fmi2_import_get_event_indicators().
+	@param z Event indicators at the end of the step.
+	@param n Number of event indicators.
+	@param epsilon Hysteresis, zero or positive.
+	@param indices Output array with room for n elements, receives the indices of the indicators that crossed in increasing order. May be NULL.
+	@param fraction Output, receives an estimate of the fraction of the step where the earliest crossing
+		happened, from linear interpolation of each crossing indicator. One if no indicator crossed. May be NULL.
+	@return The number of indicators that crossed zero.
+*/
+FMILIB_EXPORT size_t fmi_import_find_zero_crossings(const double zPrev[], const double z[], size_t n, double epsilon,
+													size_t indices[], double* fraction);
+
+/** \brief Get the kernel used by fmi_import_find_zero_crossings(). */
+FMILIB_EXPORT fmi_import_zero_crossing_kernel_enu_t fmi_import_get_zero_crossing_kernel(void);
+
+/** \brief Select the kernel used by fmi_import_find_zero_crossings(), for instance to compare them.
+	The setting is global and should not be changed while other threads scan for crossings.
+	@return Error status. Fails if the kernel was not built or is not supported by the processor.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_import_set_zero_crossing_kernel(fmi_import_zero_crossing_kernel_enu_t kernel);
+
+/** \brief Get the name of a kernel. */
+FMILIB_EXPORT const char* fmi_import_zero_crossing_kernel_to_string(fmi_import_zero_crossing_kernel_enu_t kernel);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI_IMPORT_ZERO_CROSSING_H_ */
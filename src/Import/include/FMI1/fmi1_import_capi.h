@@ -23,6 +23,7 @@ extern "C" {
 #include <JM/jm_callbacks.h>
 #include <FMI/fmi_import_util.h>
 #include <FMI/fmi_import_context.h>
+#include <FMI/fmi_call_stats.h>
 /* #include <FMI1/fmi1_xml_model_description.h>*/
 
 #include <FMI1/fmi1_types.h>
@@ -88,6 +89,46 @@ FMILIB_EXPORT void fmi1_import_destroy_dllfmu(fmi1_import_t* fmu);
  */
 FMILIB_EXPORT void fmi1_import_set_debug_mode(fmi1_import_t* fmu, int mode);
 
+/**
+ * \brief Set binary isolation mode. Setting to non-zero makes fmi1_import_create_dllfmu() load a private
+ *  copy of the FMU shared library from a new directory next to the binaries of the FMU, so that the global variables of the FMU are
+ *  not shared with other loaded FMUs. This allows several instances of FMUs that can only be instantiated
+ *  once per process (canBeInstantiatedOnlyOncePerProcess) to run in the same process.
+ *  The copy is removed in fmi1_import_destroy_dllfmu(). The mode must be set before the binary is loaded.
+ *
+ * @param fmu A model description object returned by fmi1_import_parse_xml().
+ * @param mode The isolation mode to set.
+ */
+FMILIB_EXPORT void fmi1_import_set_binary_isolation(fmi1_import_t* fmu, int mode);
+
+/**
+ * \brief Switch call tracing of the FMI functions on or off. While tracing is on, each call through the
+ *  wrappers is timed and counted per FMI function. Switching replaces the loaded function pointers, so
+ *  the calls cost nothing extra while tracing is off. The statistics are kept when tracing is switched off.
+ *
+ * @param fmu A model description object that has loaded the FMI functions, see fmi1_import_create_dllfmu().
+ * @param enable Non-zero to switch tracing on.
+ * @return Error status.
+ */
+FMILIB_EXPORT jm_status_enu_t fmi1_import_set_call_tracing(fmi1_import_t* fmu, int enable);
+
+/**
+ * \brief Get a snapshot of the call statistics collected by fmi1_import_set_call_tracing().
+ *
+ * @param fmu A model description object that has loaded the FMI functions.
+ * @param stats Output, receives the statistics of at most n FMI functions. Functions that were not called have a zero count.
+ * @param n Size of the stats array.
+ * @return The number of traced FMI functions, zero if the functions are not loaded.
+ */
+FMILIB_EXPORT size_t fmi1_import_get_call_stats(fmi1_import_t* fmu, fmi_call_stats_t stats[], size_t n);
+
+/**
+ * \brief Clear the call statistics.
+ *
+ * @param fmu A model description object that has loaded the FMI functions.
+ */
+FMILIB_EXPORT void fmi1_import_reset_call_stats(fmi1_import_t* fmu);
+
 /**@} */
 
 /**
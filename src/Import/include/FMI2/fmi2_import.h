@@ -38,6 +38,17 @@
 
 #include "fmi2_import_capi.h"
 #include "fmi2_import_convenience.h"
+#include "fmi2_import_jacobian.h"
+#include "fmi2_import_dependencies.h"
+#include "fmi2_import_instance.h"
+#include "fmi2_import_master.h"
+#include "fmi2_import_async.h"
+#include "fmi2_import_io_plan.h"
+#include "fmi2_import_checkpoint.h"
+#include "fmi2_import_ensemble.h"
+#include "fmi2_import_command_buffer.h"
+#include "fmi2_import_result_recorder.h"
+#include "fmi2_import_input_table.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -0,0 +1,150 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_async.h
+*  \brief Public interface to the FMI import C-library. Asynchronous co-simulation steps.
+*/
+
+#ifndef FMI2_IMPORT_ASYNC_H_
+#define FMI2_IMPORT_ASYNC_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_async Asynchronous steps
+	@}
+	\addtogroup fmi2_import_async Asynchronous steps
+	\brief Submit fmi2DoStep calls and collect their results later.
+
+	An ::fmi2_import_async_step_t handle is allocated once for each co-simulation FMU and may
+	be submitted repeatedly. Finished steps are collected either one by one with
+	fmi2_import_async_step_wait() or in completion order from the ::fmi2_import_completion_queue_t
+	the handles belong to. While steps run the caller is free to exchange and record data.
+
+	A step runs in one of two ways:
+	- Native: fmi2DoStep is called by fmi2_import_async_step_submit(). If it returns fmi2Pending the
+	  step completes when the FMU calls the stepFinished callback or, for FMUs that do not call it,
+	  when fmi2GetStatus(fmi2DoStepStatus) stops reporting fmi2Pending. The stepFinished callback
+	  is connected when fmi2_import_create_dllfmu() is called with default callbacks; user provided
+	  callbacks may use fmi2_step_finished_forwarding() with the ::fmi2_import_t as componentEnvironment.
+	- Emulated: fmi2DoStep is called synchronously on a background thread of the queue. Any
+	  co-simulation FMU can be stepped this way, but the FMU and the ::jm_callbacks memory and
+	  logger functions must then tolerate being called from a different thread.
+
+	The queue and handle functions are intended to be called from one thread.
+	@{
+	*/
+
+/** \brief Opaque completion queue with the background threads for emulated steps. */
+typedef struct fmi2_import_completion_queue_t fmi2_import_completion_queue_t;
+
+/** \brief Opaque asynchronous step handle of one FMU. */
+typedef struct fmi2_import_async_step_t fmi2_import_async_step_t;
+
+/** \brief How steps of an FMU are run. */
+typedef enum fmi2_import_async_mode_enu_t {
+	fmi2_import_async_auto,     /**< \brief Native if the FMU has the canRunAsynchronuously capability, emulated otherwise */
+	fmi2_import_async_native,   /**< \brief Always call fmi2DoStep from the submitting thread */
+	fmi2_import_async_emulated  /**< \brief Always call fmi2DoStep on a background thread */
+} fmi2_import_async_mode_enu_t;
+
+/** \brief Create a completion queue.
+	@param cb Callbacks for memory management and logging. May be NULL if defaults are utilized.
+	@param threadsNum Number of background threads running emulated steps. Zero is treated as one.
+	@return A new queue or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_completion_queue_t* fmi2_import_completion_queue_allocate(jm_callbacks* cb, size_t threadsNum);
+
+/** \brief Wait for all running steps, stop the background threads and free the queue.
+	Step handles that were not freed are freed as well.
+*/
+FMILIB_EXPORT void fmi2_import_completion_queue_free(fmi2_import_completion_queue_t* q);
+
+/** \brief Wait for the next finished step.
+	@param q A completion queue.
+	@param timeout Maximum time to wait in seconds. A negative value waits without limit.
+	@return The finished step that was not yet collected, in completion order. NULL if no step is
+	        running or the timeout expired.
+*/
+FMILIB_EXPORT fmi2_import_async_step_t* fmi2_import_completion_queue_wait(fmi2_import_completion_queue_t* q, double timeout);
+
+/** \brief Get a finished step without waiting. Same as fmi2_import_completion_queue_wait() with zero timeout. */
+FMILIB_EXPORT fmi2_import_async_step_t* fmi2_import_completion_queue_poll(fmi2_import_completion_queue_t* q);
+
+/** \brief Get the number of submitted steps that did not finish yet. */
+FMILIB_EXPORT size_t fmi2_import_completion_queue_get_running_num(fmi2_import_completion_queue_t* q);
+
+/** \brief Create a step handle for an FMU. Only one handle may exist for each FMU.
+	@param q The completion queue the finished steps are reported to.
+	@param fmu An FMU object that has loaded the co-simulation FMI functions and is instantiated.
+	@param mode How steps are run.
+	@param userData Arbitrary pointer returned by fmi2_import_async_step_get_user_data().
+	@return A new handle or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_async_step_t* fmi2_import_async_step_allocate(fmi2_import_completion_queue_t* q, fmi2_import_t* fmu, fmi2_import_async_mode_enu_t mode, void* userData);
+
+/** \brief Wait for a running step and free the handle. */
+FMILIB_EXPORT void fmi2_import_async_step_free(fmi2_import_async_step_t* step);
+
+/** \brief Start a step. The arguments are those of fmi2_import_do_step().
+	A step that finished but was not collected is discarded.
+	@return fmi2_status_ok if the step was started, fmi2_status_error if the previous step is still running.
+	        The result of the step itself is returned when it is collected.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_async_step_submit(fmi2_import_async_step_t* step, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize, fmi2_boolean_t noSetFMUStatePriorToCurrentPoint);
+
+/** \brief Wait for the step to finish and collect it, so that it is not returned by the queue.
+	@return The status of the step, fmi2_status_error if no step was submitted.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_async_step_wait(fmi2_import_async_step_t* step);
+
+/** \brief Check if the last submitted step finished. */
+FMILIB_EXPORT int fmi2_import_async_step_is_done(fmi2_import_async_step_t* step);
+
+/** \brief Get the status of the last finished step. */
+FMILIB_EXPORT fmi2_status_t fmi2_import_async_step_get_status(fmi2_import_async_step_t* step);
+
+/** \brief Check if the steps are run natively by the FMU rather than emulated. */
+FMILIB_EXPORT int fmi2_import_async_step_is_native(fmi2_import_async_step_t* step);
+
+/** \brief Get the FMU stepped by the handle. */
+FMILIB_EXPORT fmi2_import_t* fmi2_import_async_step_get_fmu(fmi2_import_async_step_t* step);
+
+/** \brief Get the pointer given to fmi2_import_async_step_allocate(). */
+FMILIB_EXPORT void* fmi2_import_async_step_get_user_data(fmi2_import_async_step_t* step);
+
+/**
+	\brief An implementation of the FMI 2.0 stepFinished callback that completes the running step of the FMU.
+
+	The componentEnvironment must be the ::fmi2_import_t object. The function may be called from any thread.
+*/
+FMILIB_EXPORT void fmi2_step_finished_forwarding(fmi2_component_environment_t c, fmi2_status_t status);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_ASYNC_H_ */
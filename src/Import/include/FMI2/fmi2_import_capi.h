@@ -23,6 +23,7 @@ extern "C" {
 #include <JM/jm_callbacks.h>
 #include <FMI/fmi_import_util.h>
 #include <FMI/fmi_import_context.h>
+#include <FMI/fmi_call_stats.h>
 /* #include <FMI2/fmi2_xml_model_description.h>*/
 
 #include <FMI2/fmi2_types.h>
@@ -69,7 +70,7 @@ Wrapper functions for the FMI 2.0 functions
  * @param fmu A model description object returned by fmi2_import_parse_xml().
  * @param fmuKind Specifies if ModelExchange or CoSimulation binary should be loaded.
  * @param callBackFunctions Callback functions to be used by the FMI functions internally. If this parameter is NULL
- *           then the jm_callbacks:: and fmi2_log_forwarding are utitlized to fill in the default structure.
+ *           then the jm_callbacks::, fmi2_log_forwarding and fmi2_step_finished_forwarding are utitlized to fill in the default structure.
  * @return Error status. If the function returns with an error, it is not allowed to call any of the other C-API functions.
  */
 FMILIB_EXPORT jm_status_enu_t fmi2_import_create_dllfmu(fmi2_import_t* fmu, fmi2_fmu_kind_enu_t fmuKind, const fmi2_callback_functions_t* callBackFunctions);
@@ -88,6 +89,89 @@ FMILIB_EXPORT void fmi2_import_destroy_dllfmu(fmi2_import_t* fmu);
  * @param mode The debug mode to set.
  */
 FMILIB_EXPORT void fmi2_import_set_debug_mode(fmi2_import_t* fmu, int mode);
+
+/**
+ * \brief Set binary isolation mode. Setting to non-zero makes fmi2_import_create_dllfmu() load a private
+ *  copy of the FMU shared library from a new directory next to the binaries of the FMU, so that the global variables of the FMU are
+ *  not shared with other loaded FMUs. This allows several instances of FMUs that can only be instantiated
+ *  once per process (canBeInstantiatedOnlyOncePerProcess) to run in the same process.
+ *  Each instance allocated with fmi2_import_instance_allocate() then also gets its own copy.
+ *  The copy is removed in fmi2_import_destroy_dllfmu(). The mode must be set before the binary is loaded.
+ *
+ * @param fmu A model description object returned by fmi2_import_parse_xml().
+ * @param mode The isolation mode to set.
+ */
+FMILIB_EXPORT void fmi2_import_set_binary_isolation(fmi2_import_t* fmu, int mode);
+
+/**
+ * \brief Run the FMU binary out of process. Setting a host executable makes fmi2_import_create_dllfmu()
+ *  start the host, which loads the binary, and forward the FMI calls to it over shared memory. The API
+ *  is used as usual. A crash of the binary then terminates only the host: the calls return
+ *  fmi2_status_fatal and the simulation can continue with fmi2_import_restart_host().
+ *  Each instance allocated with fmi2_import_instance_allocate() gets a host of its own.
+ *  Must be set before the binary is loaded. Supported on POSIX systems.
+ *
+ * @param fmu A model description object returned by fmi2_import_parse_xml().
+ * @param hostPath Path of the fmi2_capi_host executable installed with the library. NULL loads the binary in this process.
+ * @return Error status.
+ */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_set_out_of_process(fmi2_import_t* fmu, const char* hostPath);
+
+/**
+ * \brief Check if the host process running the FMU binary has terminated unexpectedly.
+ *
+ * @param fmu A model description object.
+ */
+FMILIB_EXPORT int fmi2_import_is_host_crashed(fmi2_import_t* fmu);
+
+/**
+ * \brief Get the process id of the host process running the FMU binary, or 0 if the binary runs in this process.
+ *
+ * @param fmu A model description object.
+ */
+FMILIB_EXPORT unsigned long fmi2_import_get_host_pid(fmi2_import_t* fmu);
+
+/**
+ * \brief Restart the host process after a crash and bring the FMU back to a snapshot. The instance is
+ *  re-created with the arguments of the last fmi2_import_instantiate(), the experiment setup and the
+ *  initialization are repeated, and the state is restored from the snapshot.
+ *  FMU states obtained before the restart lived in the old host process and are invalidated: they need
+ *  not be freed, and passing them to the FMU state functions returns fmi2_status_error.
+ *
+ * @param fmu A model description object running the binary out of process.
+ * @param snapshot FMU state serialized with fmi2_import_serialize_fmu_state(). NULL keeps the initialized state.
+ * @param size Size of the snapshot.
+ * @return Error status.
+ */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_restart_host(fmi2_import_t* fmu, const fmi2_byte_t snapshot[], size_t size);
+
+/**
+ * \brief Switch call tracing of the FMI functions on or off. While tracing is on, each call through the
+ *  wrappers is timed and counted per FMI function. Switching replaces the loaded function pointers, so
+ *  the calls cost nothing extra while tracing is off. The statistics are kept when tracing is switched off.
+ *
+ * @param fmu A model description object that has loaded the FMI functions, see fmi2_import_create_dllfmu().
+ * @param enable Non-zero to switch tracing on.
+ * @return Error status.
+ */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_set_call_tracing(fmi2_import_t* fmu, int enable);
+
+/**
+ * \brief Get a snapshot of the call statistics collected by fmi2_import_set_call_tracing().
+ *
+ * @param fmu A model description object that has loaded the FMI functions.
+ * @param stats Output, receives the statistics of at most n FMI functions. Functions that were not called have a zero count.
+ * @param n Size of the stats array.
+ * @return The number of traced FMI functions, zero if the functions are not loaded.
+ */
+FMILIB_EXPORT size_t fmi2_import_get_call_stats(fmi2_import_t* fmu, fmi_call_stats_t stats[], size_t n);
+
+/**
+ * \brief Clear the call statistics.
+ *
+ * @param fmu A model description object that has loaded the FMI functions.
+ */
+FMILIB_EXPORT void fmi2_import_reset_call_stats(fmi2_import_t* fmu);
 /**@} */
 
 /**
@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_checkpoint.h
+*  \brief Public interface to the FMI import C-library. Checkpoints of the FMU state with rollback.
+*/
+
+#ifndef FMI2_IMPORT_CHECKPOINT_H_
+#define FMI2_IMPORT_CHECKPOINT_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_checkpoint Checkpoints
+	@}
+	\addtogroup fmi2_import_checkpoint Checkpoints
+	\brief Save the FMU state at a sequence of times and roll back to any of them.
+
+	A checkpoint manager keeps the most recent checkpoints as FMU state objects
+	(fmi2GetFMUstate). State objects are never freed while the manager lives: a new checkpoint
+	reuses the object of an evicted or discarded checkpoint, which the FMU may update in place
+	instead of allocating. When the live checkpoints are all used, the oldest one is serialized
+	(fmi2SerializeFMUstate) into a byte arena before its state object is reused. The arena is a
+	ring buffer of fixed size: when it is full, the oldest serialized checkpoints are dropped.
+	Serialized checkpoints may be delta compressed: each one is stored as the run length encoded
+	difference to the previous one, with a full snapshot at regular intervals.
+
+	Rolling back to a time restores the latest checkpoint at or before that time and discards all
+	later checkpoints, as needed when a variable step co-simulation master rejects a step.
+
+	The FMU must have the canGetAndSetFMUstate capability, and canSerializeFMUstate if an arena is used.
+	All buffers are allocated up front or grow to the serialized state size once.
+	@{
+	*/
+
+/** \brief Opaque checkpoint manager of one FMU. */
+typedef struct fmi2_import_checkpoint_manager_t fmi2_import_checkpoint_manager_t;
+
+/** \brief Storage of serialized checkpoints. */
+typedef enum fmi2_import_checkpoint_compression_enu_t {
+	fmi2_import_checkpoint_compression_none,  /**< \brief Store the serialized state as is */
+	fmi2_import_checkpoint_compression_delta  /**< \brief Store the run length encoded difference to the previous checkpoint */
+} fmi2_import_checkpoint_compression_enu_t;
+
+/** \brief Counters and memory usage of a checkpoint manager. */
+typedef struct fmi2_import_checkpoint_stats_t {
+	size_t savesNum;             /**< \brief Number of saved checkpoints */
+	size_t statesCreatedNum;     /**< \brief fmi2GetFMUstate calls that allocated a new state object */
+	size_t statesReusedNum;      /**< \brief fmi2GetFMUstate calls that updated a recycled state object */
+	size_t rollbacksNum;         /**< \brief Number of rollbacks */
+	size_t liveHitsNum;          /**< \brief Rollbacks restored from a live state object */
+	size_t arenaHitsNum;         /**< \brief Rollbacks restored from a serialized checkpoint */
+	size_t missesNum;            /**< \brief Rollbacks with no checkpoint at or before the requested time */
+	size_t serializedNum;        /**< \brief Checkpoints serialized into the arena */
+	size_t droppedNum;           /**< \brief Serialized checkpoints dropped to make room in the arena */
+	size_t liveCheckpointsNum;   /**< \brief Current number of live checkpoints */
+	size_t arenaCheckpointsNum;  /**< \brief Current number of serialized checkpoints */
+	size_t rawBytes;             /**< \brief Serialized size of the checkpoints in the arena */
+	size_t storedBytes;          /**< \brief Bytes the checkpoints in the arena occupy after compression */
+	size_t arenaBytes;           /**< \brief Size of the arena */
+	size_t memoryBytes;          /**< \brief Memory allocated by the manager, excluding the FMU state objects */
+} fmi2_import_checkpoint_stats_t;
+
+/** \brief Create a checkpoint manager.
+	@param fmu An instantiated FMU with the canGetAndSetFMUstate capability.
+	@param liveStatesNum Maximum number of checkpoints kept as FMU state objects, at least one.
+	@param arenaBytes Size of the arena for serialized checkpoints. Zero disables serialization,
+		older checkpoints are then forgotten when the live checkpoints are all used.
+	@return A new manager or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_checkpoint_manager_t* fmi2_import_checkpoint_manager_allocate(fmi2_import_t* fmu, size_t liveStatesNum, size_t arenaBytes);
+
+/** \brief Free the FMU state objects and the manager. Must be called before the FMU instance is freed. */
+FMILIB_EXPORT void fmi2_import_checkpoint_manager_free(fmi2_import_checkpoint_manager_t* m);
+
+/** \brief Set how serialized checkpoints are stored. The default is ::fmi2_import_checkpoint_compression_delta.
+	Applies to checkpoints serialized after the call.
+*/
+FMILIB_EXPORT void fmi2_import_checkpoint_set_compression(fmi2_import_checkpoint_manager_t* m, fmi2_import_checkpoint_compression_enu_t compression);
+
+/** \brief Save the current FMU state as a checkpoint at the given time.
+	Checkpoints later than the time are discarded first.
+	@return The most severe status returned by the FMU.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_checkpoint_save(fmi2_import_checkpoint_manager_t* m, fmi2_real_t time);
+
+/** \brief Restore the latest checkpoint at or before a time and discard later checkpoints.
+	The restored checkpoint is kept, so it is possible to roll back to it again.
+	@param m A checkpoint manager.
+	@param time Time to roll back to.
+	@param restoredTime Output, receives the time of the restored checkpoint. May be NULL.
+	@return The most severe status returned by the FMU, or fmi2_status_error if there is no such checkpoint.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_checkpoint_rollback(fmi2_import_checkpoint_manager_t* m, fmi2_real_t time, fmi2_real_t* restoredTime);
+
+/** \brief Forget all checkpoints. The FMU state objects are kept for reuse. */
+FMILIB_EXPORT void fmi2_import_checkpoint_clear(fmi2_import_checkpoint_manager_t* m);
+
+/** \brief Get the counters and memory usage of a manager. */
+FMILIB_EXPORT void fmi2_import_checkpoint_get_stats(fmi2_import_checkpoint_manager_t* m, fmi2_import_checkpoint_stats_t* stats);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_CHECKPOINT_H_ */
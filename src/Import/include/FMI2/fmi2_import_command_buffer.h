@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_command_buffer.h
+*  \brief Public interface to the FMI import C-library. Recorded sequences of FMI runtime calls.
+*/
+
+#ifndef FMI2_IMPORT_COMMAND_BUFFER_H_
+#define FMI2_IMPORT_COMMAND_BUFFER_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+#include "fmi2_import_instance.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_command_buffer Command buffers
+	@}
+	\addtogroup fmi2_import_command_buffer Command buffers
+	\brief Record a sequence of FMI calls once and make them back-to-back many times.
+
+	A command buffer holds the calls of, e.g., one communication step: set the inputs, do the
+	step, get the outputs and the status. The arguments are checked when a call is recorded:
+	the function must be provided by the FMU and fit its kind, the value references must belong
+	to variables of the base type of the call (Enumeration counts as Integer) and the derivative
+	orders must be in range. The value references and orders are copied.
+
+	The value arrays and scalar arguments are referenced, not copied. fmi2_import_command_buffer_submit()
+	reads the inputs from the caller's buffers and writes the outputs into them, so the same
+	buffer is submitted again after the caller has updated the inputs, e.g., the communication point.
+	A submission makes the calls directly through the loaded function pointers without further checks
+	and stops at the first call that returns fmi2_status_error, fmi2_status_fatal or fmi2_status_pending.
+	The status of each executed call is kept in the buffer.
+	@{
+	*/
+
+/** \brief Opaque command buffer. */
+typedef struct fmi2_import_command_buffer_t fmi2_import_command_buffer_t;
+
+/** \brief Allocate an empty command buffer for the instance of an FMU.
+	@param fmu An FMU that has loaded its binary, see fmi2_import_create_dllfmu(). The buffer must be freed before the binary is unloaded.
+	@return A new buffer or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_command_buffer_t* fmi2_import_command_buffer_allocate(fmi2_import_t* fmu);
+
+/** \brief Allocate an empty command buffer for an instance allocated with fmi2_import_instance_allocate().
+	The buffer must be freed before the instance.
+	@return A new buffer or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_command_buffer_t* fmi2_import_command_buffer_allocate_for_instance(fmi2_import_instance_t* inst);
+
+/** \brief Free a command buffer. */
+FMILIB_EXPORT void fmi2_import_command_buffer_free(fmi2_import_command_buffer_t* buf);
+
+/** \brief Remove all recorded calls. */
+FMILIB_EXPORT void fmi2_import_command_buffer_clear(fmi2_import_command_buffer_t* buf);
+
+/** \brief Get the number of recorded calls. A call recorded next gets this number as its index. */
+FMILIB_EXPORT size_t fmi2_import_command_buffer_get_size(fmi2_import_command_buffer_t* buf);
+
+/** \name Recording
+	Each function appends one call and returns jm_status_error, without recording, if the arguments are invalid.
+	@{
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_set_real(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_real_t value[]);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_set_integer(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t value[]);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_set_boolean(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_boolean_t value[]);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_set_string(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_string_t value[]);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_real(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_real_t value[]);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_integer(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_integer_t value[]);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_boolean(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_boolean_t value[]);
+/** \brief Record fmi2GetString. The strings are owned by the FMU and only valid until its next call. */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_string(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_string_t value[]);
+
+/** \brief Record fmi2SetRealInputDerivatives. The orders must be positive. */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_set_real_input_derivatives(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], const fmi2_real_t value[]);
+/** \brief Record fmi2GetRealOutputDerivatives. The orders must be in the range 1 to maxOutputDerivativeOrder. */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_real_output_derivatives(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], fmi2_real_t value[]);
+/** \brief Record fmi2DoStep. The communication point and step size are read from the referenced variables at submission. */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_do_step(fmi2_import_command_buffer_t* buf, const fmi2_real_t* currentCommunicationPoint, const fmi2_real_t* communicationStepSize, fmi2_boolean_t newStep);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_status_t* value);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_real_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_real_t* value);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_integer_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_integer_t* value);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_boolean_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_boolean_t* value);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_string_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_string_t* value);
+
+/** \brief Record fmi2SetTime. The time is read from the referenced variable at submission. */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_set_time(fmi2_import_command_buffer_t* buf, const fmi2_real_t* time);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_set_continuous_states(fmi2_import_command_buffer_t* buf, const fmi2_real_t x[], size_t nx);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_continuous_states(fmi2_import_command_buffer_t* buf, fmi2_real_t x[], size_t nx);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_derivatives(fmi2_import_command_buffer_t* buf, fmi2_real_t derivatives[], size_t nx);
+FMILIB_EXPORT jm_status_enu_t fmi2_import_command_buffer_get_event_indicators(fmi2_import_command_buffer_t* buf, fmi2_real_t eventIndicators[], size_t ni);
+/** @} */
+
+/** \brief Make the recorded calls in order.
+	@return The most severe status of the executed calls, or fmi2_status_error if the FMU is not instantiated.
+		fmi2_status_pending is returned if a call returned it.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_command_buffer_submit(fmi2_import_command_buffer_t* buf);
+
+/** \brief Get the number of calls executed by the last submission. Less than the size if the submission stopped early. */
+FMILIB_EXPORT size_t fmi2_import_command_buffer_get_executed_num(fmi2_import_command_buffer_t* buf);
+
+/** \brief Get the statuses of the calls of the last submission, indexed by the order of recording.
+	Only the first fmi2_import_command_buffer_get_executed_num() entries are valid.
+*/
+FMILIB_EXPORT const fmi2_status_t* fmi2_import_command_buffer_get_statuses(fmi2_import_command_buffer_t* buf);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_COMMAND_BUFFER_H_ */
@@ -0,0 +1,112 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_dependencies.h
+*  \brief Public interface to the FMI import C-library. Reverse dependency queries.
+*/
+
+#ifndef FMI2_IMPORT_DEPENDENCIES_H_
+#define FMI2_IMPORT_DEPENDENCIES_H_
+
+#include <FMI/fmi_import_context.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_dependencies Reverse dependency queries
+	@}
+	\addtogroup fmi2_import_dependencies Reverse dependency queries
+	\brief Answer "which unknowns depend on this known" questions.
+
+	The dependency information in the ModelStructure is stored row-wise: each unknown
+	lists the knowns it depends on. The functions in this module provide the transposed
+	(column-compressed) index, built on first use and cached in the ::fmi2_import_t object.
+	For small models a dense bitset matrix can be requested as well, which turns union and
+	intersection queries into word-wise OR/AND loops over contiguous columns.
+
+	Knowns are identified by their index in the list of model variables in the original
+	order (see fmi2_import_get_variable_original_order()). Unknowns are identified by their
+	0-based position in the corresponding list (e.g., fmi2_import_get_outputs_list()).
+	Unknowns without dependency information, or with the "depends on all" marker, are
+	recorded as depending on all inputs, continuous states and the independent variable.
+
+	The cached indexes are not protected against concurrent first use from several threads.
+	Queries only read an index that is built, so they may run concurrently once the index
+	of the kind (and the bitsets, if used) has been requested on one thread.
+	@{
+	*/
+
+/** \brief Selects the unknowns of a dependency index. */
+typedef enum fmi2_import_dependency_kind_enu_t {
+	fmi2_import_dependency_outputs = 0,         /**< \brief Outputs in ModelStructure order */
+	fmi2_import_dependency_derivatives = 1,     /**< \brief State derivatives in ModelStructure order */
+	fmi2_import_dependency_discrete_states = 2  /**< \brief Discrete states in ModelStructure order */
+} fmi2_import_dependency_kind_enu_t;
+
+/** \brief Maximum size in bytes of a dependency bitset matrix, see fmi2_import_get_dependency_bitsets(). */
+#define FMI2_IMPORT_DEPENDENCY_BITSET_MAX_BYTES (1024*1024)
+
+/** \brief Get the transposed dependency information in column-compressed format.
+ * @param fmu An FMU object as returned by fmi2_import_parse_xml().
+ * @param kind Selects the unknowns.
+ * @param startIndex - outputs a pointer to an array of start indices (size of array is number of model variables + 1).
+ * @param dependent - outputs a pointer to the 0-based indices of the unknowns depending on each variable, sorted within a column.
+ * @return Error status. On error both pointers are set to NULL.
+ */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_get_dependents(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind, size_t** startIndex, size_t** dependent);
+
+/** \brief Get the dense dependency bitset matrix.
+ *
+ * Column v of the matrix is stored in words [v*nWords, (v+1)*nWords) and has bit (i % bits in size_t)
+ * of word (i / bits in size_t) set if unknown i depends on variable v.
+ * The matrix is only built if it does not exceed ::FMI2_IMPORT_DEPENDENCY_BITSET_MAX_BYTES.
+ * Once built, it is used by fmi2_import_get_dependents_union() and fmi2_import_get_dependents_intersection().
+ * @param fmu An FMU object as returned by fmi2_import_parse_xml().
+ * @param kind Selects the unknowns.
+ * @param nWords - outputs the number of words per column.
+ * @param bits - outputs a pointer to the matrix (number of model variables * nWords words).
+ * @return Error status. jm_status_warning is returned if the model is too large for the bitset representation.
+ */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_get_dependency_bitsets(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind, size_t* nWords, const size_t** bits);
+
+/** \brief Get the unknowns depending on at least one of the given knowns.
+ * @param fmu An FMU object as returned by fmi2_import_parse_xml().
+ * @param kind Selects the unknowns.
+ * @param knowns Original order indices of the knowns.
+ * @param nKnowns Size of the knowns array.
+ * @param unknowns Output array, sized for the total number of unknowns of this kind, receiving the sorted 0-based indices.
+ * @return Number of unknowns written.
+ */
+FMILIB_EXPORT size_t fmi2_import_get_dependents_union(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind,
+                                                      const size_t knowns[], size_t nKnowns, size_t unknowns[]);
+
+/** \brief Get the unknowns depending on all of the given knowns.
+ * @see fmi2_import_get_dependents_union()
+ */
+FMILIB_EXPORT size_t fmi2_import_get_dependents_intersection(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind,
+                                                             const size_t knowns[], size_t nKnowns, size_t unknowns[]);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_DEPENDENCIES_H_ */
@@ -0,0 +1,141 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_ensemble.h
+*  \brief Public interface to the FMI import C-library. Parallel runs of one FMU with different parameters.
+*/
+
+#ifndef FMI2_IMPORT_ENSEMBLE_H_
+#define FMI2_IMPORT_ENSEMBLE_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI/fmi_import_solver.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_ensemble Ensembles
+	@}
+	\addtogroup fmi2_import_ensemble Ensembles
+	\brief Simulate one FMU many times with different parameter values on several threads.
+
+	An ensemble is created from an FMU that is parsed and has loaded its binary once (see
+	fmi2_import_create_dllfmu()). Each worker thread owns an ::fmi2_import_instance_t of the FMU
+	that is instantiated at its first run and only reset (fmi2Reset) for the following runs, so
+	the per-run overhead is the reset, the initialization and the set calls.
+
+	A run is one row of a parameter table: the values of the parameter variables are set in
+	initialization mode with one I/O plan call per base type (see fmi2_import_io_plan.h). A
+	co-simulation FMU is then stepped with a fixed communication step size; a model exchange
+	FMU is integrated with an ::fmi_import_solver_t and the same output interval. The output
+	variables are read at the start time and after each step and passed to a sink.
+
+	The FMU must allow several instances per process (canBeInstantiatedOnlyOncePerProcess is false)
+	and the ::jm_callbacks memory and logger functions must be thread-safe.
+	@{
+	*/
+
+/** \brief Opaque ensemble. */
+typedef struct fmi2_import_ensemble_t fmi2_import_ensemble_t;
+
+/** \brief Receives the outputs of a run.
+	Called from the worker threads, concurrently for different runs. The calls of one run are made
+	in time order from a single thread.
+	@param userData The pointer given to fmi2_import_ensemble_set_sink().
+	@param run Index of the run, i.e., the row of the parameter table.
+	@param time Time of the output point.
+	@param outputs Values of the output variables, in the order of the output list. Integer and
+		Boolean values are converted to Real.
+	@param outputsNum Number of output variables.
+*/
+typedef void (*fmi2_import_ensemble_sink_ft)(void* userData, size_t run, fmi2_real_t time, const fmi2_real_t outputs[], size_t outputsNum);
+
+/** \brief Counters of an ensemble. */
+typedef struct fmi2_import_ensemble_stats_t {
+	size_t runsNum;           /**< \brief Completed runs */
+	size_t failedRunsNum;     /**< \brief Runs that ended with an error status */
+	size_t instancesNum;      /**< \brief Instantiated FMU components */
+	size_t resetsNum;         /**< \brief Runs that reused an instance with fmi2Reset */
+	size_t stepsNum;          /**< \brief Communication steps over all runs */
+	double setupSeconds;      /**< \brief Time summed over the workers spent in instantiation, reset, initialization and parameter setting */
+	double simulationSeconds; /**< \brief Time summed over the workers spent stepping and reading outputs */
+} fmi2_import_ensemble_stats_t;
+
+/** \brief Create an ensemble.
+	@param fmu An FMU object that has loaded the FMI functions, see fmi2_import_create_dllfmu().
+		Model exchange runs are integrated, co-simulation runs are stepped.
+	@param parameters Variables set for each run. Real, Integer, Enumeration and Boolean
+		variables are supported. The list is not referenced after the call.
+	@param outputs Variables passed to the sink. Real, Integer, Enumeration and Boolean
+		variables are supported. May be NULL. The list is not referenced after the call.
+	@param threadsNum Number of worker threads and instances. Zero uses one per processor.
+	@return A new ensemble or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_ensemble_t* fmi2_import_ensemble_allocate(fmi2_import_t* fmu, fmi2_import_variable_list_t* parameters,
+                                                                    fmi2_import_variable_list_t* outputs, size_t threadsNum);
+
+/** \brief Free the instances and the ensemble. Must be called before fmi2_import_free() on the FMU. */
+FMILIB_EXPORT void fmi2_import_ensemble_free(fmi2_import_ensemble_t* e);
+
+/** \brief Set the simulated interval and the communication step size or output interval.
+	The default is the default experiment of the model description.
+	@return jm_status_error if the interval is empty or the step size is not positive.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_ensemble_set_experiment(fmi2_import_ensemble_t* e, fmi2_real_t startTime, fmi2_real_t stopTime, fmi2_real_t stepSize);
+
+/** \brief Set the integration method and relative tolerance used for model exchange runs.
+	The default is ::fmi_import_solver_dopri5 with the tolerance of the default experiment.
+	The step size of the fixed step methods is the output interval.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_ensemble_set_solver(fmi2_import_ensemble_t* e, fmi_import_solver_method_enu_t method, fmi2_real_t relativeTolerance);
+
+/** \brief Set the function receiving the outputs. Without a sink the outputs are not read. */
+FMILIB_EXPORT void fmi2_import_ensemble_set_sink(fmi2_import_ensemble_t* e, fmi2_import_ensemble_sink_ft sink, void* userData);
+
+/** \brief Pin worker thread i to processor i modulo the number of processors. Off by default.
+	Pinning keeps the instance data of each worker in the caches of one processor.
+*/
+FMILIB_EXPORT void fmi2_import_ensemble_set_pinning(fmi2_import_ensemble_t* e, int pinThreads);
+
+/** \brief Get the number of worker threads. */
+FMILIB_EXPORT size_t fmi2_import_ensemble_get_threads_num(fmi2_import_ensemble_t* e);
+
+/** \brief Run a parameter table and wait for all runs to finish.
+	@param e An ensemble.
+	@param values Parameter values, runsNum rows of one value per parameter variable in the order
+		of the parameter list. Integer values are rounded and Boolean values are true if non-zero.
+	@param runsNum Number of runs.
+	@param runStatus Output, receives the most severe status of each run. May be NULL.
+	@return The most severe status of all runs.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_ensemble_run(fmi2_import_ensemble_t* e, const fmi2_real_t values[], size_t runsNum, fmi2_status_t runStatus[]);
+
+/** \brief Get the counters accumulated over all runs. */
+FMILIB_EXPORT void fmi2_import_ensemble_get_stats(fmi2_import_ensemble_t* e, fmi2_import_ensemble_stats_t* stats);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_ENSEMBLE_H_ */
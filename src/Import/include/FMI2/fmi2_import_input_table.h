@@ -0,0 +1,149 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_input_table.h
+*  \brief Public interface to the FMI import C-library. Time series of input values.
+*/
+
+#ifndef FMI2_IMPORT_INPUT_TABLE_H_
+#define FMI2_IMPORT_INPUT_TABLE_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_input_table Input tables
+	@}
+	\addtogroup fmi2_import_input_table Input tables
+	\brief Interpolate measured or precomputed input signals and set them as inputs of an FMU.
+
+	An input table holds the values of a number of channels at increasing sample times. Repeated
+	sample times describe discontinuities; the later sample applies from that time on.
+	Before the first and after the last sample the first and last values are held.
+
+	Tables are loaded from CSV files, where the first line holds the channel names and the first
+	column the time, or mapped into memory from binary files written with fmi2_import_input_table_write_binary().
+	The binary files hold all values of one sample next to each other, so that evaluating all channels
+	at a time reads two consecutive rows. The time of the last evaluation is remembered, so that evaluation
+	at increasing times finds the samples without searching.
+
+	A table is not thread-safe since evaluation updates the remembered time.
+	@{
+	*/
+
+/** \brief Opaque input table. */
+typedef struct fmi2_import_input_table_t fmi2_import_input_table_t;
+
+/** \brief Interpolation between samples. */
+typedef enum fmi2_import_input_interpolation_enu_t {
+	fmi2_import_input_zero_order_hold, /**< \brief Hold the value of the last sample */
+	fmi2_import_input_linear           /**< \brief Linear interpolation between the samples (the default) */
+} fmi2_import_input_interpolation_enu_t;
+
+/** \brief Load a table from a CSV file.
+	The first line holds the names, the following lines one sample each. The values are separated by
+	commas, semicolons or tabs, as in the first line, and use a decimal point. The times must not decrease.
+	@param cb Callbacks used for memory and logging.
+	@param fileName The CSV file.
+	@return A new table or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_input_table_t* fmi2_import_input_table_load_csv(jm_callbacks* cb, const char* fileName);
+
+/** \brief Map a table from a binary file into memory. The file must not change while the table is used.
+	@param cb Callbacks used for memory and logging.
+	@param fileName A file written with fmi2_import_input_table_write_binary() on a machine with the same byte order.
+	@return A new table or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_input_table_t* fmi2_import_input_table_map_binary(jm_callbacks* cb, const char* fileName);
+
+/** \brief Write a table to a binary file for fmi2_import_input_table_map_binary(). */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_input_table_write_binary(fmi2_import_input_table_t* t, const char* fileName);
+
+/** \brief Free a table. */
+FMILIB_EXPORT void fmi2_import_input_table_free(fmi2_import_input_table_t* t);
+
+/** \brief Get the number of channels, not counting the time. */
+FMILIB_EXPORT size_t fmi2_import_input_table_get_channels_num(fmi2_import_input_table_t* t);
+
+/** \brief Get the name of a channel. */
+FMILIB_EXPORT const char* fmi2_import_input_table_get_channel_name(fmi2_import_input_table_t* t, size_t index);
+
+/** \brief Get the index of a channel by its name.
+	@return jm_status_error if there is no such channel.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_input_table_find_channel(fmi2_import_input_table_t* t, const char* name, size_t* index);
+
+/** \brief Get the number of samples. */
+FMILIB_EXPORT size_t fmi2_import_input_table_get_samples_num(fmi2_import_input_table_t* t);
+
+/** \brief Get the sample times. */
+FMILIB_EXPORT const fmi2_real_t* fmi2_import_input_table_get_time(fmi2_import_input_table_t* t);
+
+/** \brief Select the interpolation between the samples. */
+FMILIB_EXPORT void fmi2_import_input_table_set_interpolation(fmi2_import_input_table_t* t, fmi2_import_input_interpolation_enu_t interpolation);
+
+/** \brief Evaluate all channels at a time.
+	@param t The table.
+	@param time The time.
+	@param values An array with one entry per channel.
+*/
+FMILIB_EXPORT void fmi2_import_input_table_evaluate(fmi2_import_input_table_t* t, fmi2_real_t time, fmi2_real_t values[]);
+
+/** \brief Evaluate the time derivatives of all channels at a time.
+	The derivatives are zero for zero-order hold and outside the sampled time range. At a sample time
+	the derivative towards the next sample is given.
+	@param t The table.
+	@param time The time.
+	@param slopes An array with one entry per channel.
+*/
+FMILIB_EXPORT void fmi2_import_input_table_evaluate_slopes(fmi2_import_input_table_t* t, fmi2_real_t time, fmi2_real_t slopes[]);
+
+/** \brief Connect the channels to the Real variables of an FMU with the same names.
+	Only variables with causality input and tunable parameters are connected. The other channels are
+	ignored with a warning. The derivatives of the variables with causality input are
+	set by fmi2_import_input_table_apply() for co-simulation FMUs with the canInterpolateInputs capability.
+	The FMU must stay loaded while the table is applied.
+	@return jm_status_error if a channel names an input or tunable parameter that is not a Real.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_input_table_bind(fmi2_import_input_table_t* t, fmi2_import_t* fmu);
+
+/** \brief Get the number of channels connected to variables by fmi2_import_input_table_bind(). */
+FMILIB_EXPORT size_t fmi2_import_input_table_get_bound_num(fmi2_import_input_table_t* t);
+
+/** \brief Check if fmi2_import_input_table_apply() sets the input derivatives, i.e., the FMU can
+	interpolate inputs, has connected inputs and the interpolation is linear. */
+FMILIB_EXPORT int fmi2_import_input_table_sets_derivatives(fmi2_import_input_table_t* t);
+
+/** \brief Set the connected variables to their values at a time, and the first derivatives of the inputs if
+	fmi2_import_input_table_sets_derivatives().
+	@return The most severe status of the set calls, fmi2_status_error if the table is not bound.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_input_table_apply(fmi2_import_input_table_t* t, fmi2_real_t time);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_INPUT_TABLE_H_ */
@@ -0,0 +1,219 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_instance.h
+*  \brief Public interface to the FMI import C-library. Several instances of one loaded FMU binary.
+*/
+
+#ifndef FMI2_IMPORT_INSTANCE_H_
+#define FMI2_IMPORT_INSTANCE_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI/fmi_call_stats.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_functions.h>
+#include <FMI2/fmi2_enums.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_instance Multiple instances
+	@}
+	\addtogroup fmi2_import_instance Multiple instances
+	\brief Several FMU instances sharing one parsed model description and one loaded binary.
+
+	An ::fmi2_import_t object holds a single FMU component. An ::fmi2_import_instance_t
+	refers to an ::fmi2_import_t that has loaded the FMU binary (see fmi2_import_create_dllfmu())
+	and reuses its model description, shared library handle and resolved FMI functions. Each
+	instance has its own FMU component, callback functions passed to the FMU, log message
+	buffers and ::jm_callbacks copy.
+
+	The functions of this module are the instance counterparts of the FMI wrappers in
+	fmi2_import_capi.h and behave the same. Different instances may be used concurrently
+	from different threads as long as the FMU allows several instances per process and
+	the ::jm_callbacks memory and logger functions are thread-safe. A single instance must
+	not be used from several threads at the same time.
+
+	Each instance holds a reference to the loaded binary. All instances must be freed before
+	fmi2_import_free() is called on the ::fmi2_import_t.
+	@{
+	*/
+
+/** \brief Opaque FMU instance. */
+typedef struct fmi2_import_instance_t fmi2_import_instance_t;
+
+/** \brief Create a new instance of a loaded FMU binary. No FMU component is instantiated yet.
+ * @param fmu A model description object returned by fmi2_import_parse_xml() that has loaded the FMI functions, see fmi2_import_create_dllfmu().
+ * @param callBackFunctions Callback functions passed to the FMU. If this parameter is NULL
+ *           then the jm_callbacks:: and fmi2_log_forwarding are utilized to fill in the default structure.
+ *           The componentEnvironment is then the instance specific object used for log forwarding.
+ * @return The new instance or NULL on error.
+ */
+FMILIB_EXPORT fmi2_import_instance_t* fmi2_import_instance_allocate(fmi2_import_t* fmu, const fmi2_callback_functions_t* callBackFunctions);
+
+/** \brief Free an instance. The FMU component is freed with fmiFreeInstance if still instantiated.
+	An asynchronous step handle allocated for the instance view is freed as well, after waiting for a running step,
+	and so are the dependency indexes built on the view. */
+FMILIB_EXPORT void fmi2_import_instance_free(fmi2_import_instance_t* inst);
+
+/** \brief Get the model description object the instance was created from. */
+FMILIB_EXPORT fmi2_import_t* fmi2_import_instance_get_fmu(fmi2_import_instance_t* inst);
+
+/** \brief Get the FMU object the instance operates on, to use the instance with functions that take an
+	::fmi2_import_t, e.g., asynchronous steps or dependency queries. It is valid until the instance is freed. */
+FMILIB_EXPORT fmi2_import_t* fmi2_import_instance_get_view(fmi2_import_instance_t* inst);
+
+/** \brief Get the FMU component, or NULL if not instantiated. */
+FMILIB_EXPORT fmi2_component_t fmi2_import_instance_get_component(fmi2_import_instance_t* inst);
+
+/** \brief Get the last error message logged by the calling thread, see jm_get_last_error(). */
+FMILIB_EXPORT const char* fmi2_import_instance_get_last_error(fmi2_import_instance_t* inst);
+
+/** \brief Switch call tracing of this instance on or off, see fmi2_import_set_call_tracing().
+	Instances are not traced when the FMU they are allocated from is. */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_instance_set_call_tracing(fmi2_import_instance_t* inst, int enable);
+
+/** \brief Get a snapshot of the call statistics of this instance, see fmi2_import_get_call_stats(). */
+FMILIB_EXPORT size_t fmi2_import_instance_get_call_stats(fmi2_import_instance_t* inst, fmi_call_stats_t stats[], size_t n);
+
+/** \brief Clear the call statistics of this instance. */
+FMILIB_EXPORT void fmi2_import_instance_reset_call_stats(fmi2_import_instance_t* inst);
+
+/** \name Common functions
+ * @see fmi2_import_capi_common
+ * @{
+ */
+/** \brief Instance variant of fmi2_import_set_debug_logging(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_debug_logging(fmi2_import_instance_t* inst, fmi2_boolean_t loggingOn, size_t nCategories, fmi2_string_t categories[]);
+/** \brief Instance variant of fmi2_import_instantiate(). */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_instance_instantiate(fmi2_import_instance_t* inst,
+    fmi2_string_t instanceName, fmi2_type_t fmuType,
+    fmi2_string_t fmuResourceLocation, fmi2_boolean_t visible);
+/** \brief Instance variant of fmi2_import_free_instance(). */
+FMILIB_EXPORT void fmi2_import_instance_free_instance(fmi2_import_instance_t* inst);
+/** \brief Instance variant of fmi2_import_setup_experiment(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_setup_experiment(fmi2_import_instance_t* inst,
+    fmi2_boolean_t toleranceDefined, fmi2_real_t tolerance,
+    fmi2_real_t startTime, fmi2_boolean_t stopTimeDefined,
+    fmi2_real_t stopTime);
+/** \brief Instance variant of fmi2_import_enter_initialization_mode(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_enter_initialization_mode(fmi2_import_instance_t* inst);
+/** \brief Instance variant of fmi2_import_exit_initialization_mode(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_exit_initialization_mode(fmi2_import_instance_t* inst);
+/** \brief Instance variant of fmi2_import_terminate(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_terminate(fmi2_import_instance_t* inst);
+/** \brief Instance variant of fmi2_import_reset(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_reset(fmi2_import_instance_t* inst);
+
+/** \brief Instance variant of fmi2_import_set_real(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_real(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_real_t    value[]);
+/** \brief Instance variant of fmi2_import_set_integer(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_integer(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t value[]);
+/** \brief Instance variant of fmi2_import_set_boolean(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_boolean(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_boolean_t value[]);
+/** \brief Instance variant of fmi2_import_set_string(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_string(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_string_t  value[]);
+
+/** \brief Instance variant of fmi2_import_get_real(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_real(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, fmi2_real_t    value[]);
+/** \brief Instance variant of fmi2_import_get_integer(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_integer(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, fmi2_integer_t value[]);
+/** \brief Instance variant of fmi2_import_get_boolean(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_boolean(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, fmi2_boolean_t value[]);
+/** \brief Instance variant of fmi2_import_get_string(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_string(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, fmi2_string_t  value[]);
+
+/** \brief Instance variant of fmi2_import_get_fmu_state(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_fmu_state(fmi2_import_instance_t* inst, fmi2_FMU_state_t* s);
+/** \brief Instance variant of fmi2_import_set_fmu_state(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_fmu_state(fmi2_import_instance_t* inst, fmi2_FMU_state_t s);
+/** \brief Instance variant of fmi2_import_free_fmu_state(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_free_fmu_state(fmi2_import_instance_t* inst, fmi2_FMU_state_t* s);
+/** \brief Instance variant of fmi2_import_serialized_fmu_state_size(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_serialized_fmu_state_size(fmi2_import_instance_t* inst, fmi2_FMU_state_t s, size_t* sz);
+/** \brief Instance variant of fmi2_import_serialize_fmu_state(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_serialize_fmu_state(fmi2_import_instance_t* inst, fmi2_FMU_state_t s, fmi2_byte_t data[], size_t sz);
+/** \brief Instance variant of fmi2_import_de_serialize_fmu_state(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_de_serialize_fmu_state(fmi2_import_instance_t* inst, const fmi2_byte_t data[], size_t sz, fmi2_FMU_state_t* s);
+/** \brief Instance variant of fmi2_import_get_directional_derivative(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_directional_derivative(fmi2_import_instance_t* inst, const fmi2_value_reference_t v_ref[], size_t nv,
+                                                                            const fmi2_value_reference_t z_ref[], size_t nz,
+                                                                            const fmi2_real_t dv[], fmi2_real_t dz[]);
+/** @} */
+
+/** \name Model Exchange functions
+ * @see fmi2_import_capi_me
+ * @{
+ */
+/** \brief Instance variant of fmi2_import_enter_event_mode(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_enter_event_mode(fmi2_import_instance_t* inst);
+/** \brief Instance variant of fmi2_import_new_discrete_states(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_new_discrete_states(fmi2_import_instance_t* inst, fmi2_event_info_t* eventInfo);
+/** \brief Instance variant of fmi2_import_enter_continuous_time_mode(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_enter_continuous_time_mode(fmi2_import_instance_t* inst);
+/** \brief Instance variant of fmi2_import_set_time(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_time(fmi2_import_instance_t* inst, fmi2_real_t time);
+/** \brief Instance variant of fmi2_import_set_continuous_states(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_continuous_states(fmi2_import_instance_t* inst, const fmi2_real_t x[], size_t nx);
+/** \brief Instance variant of fmi2_import_completed_integrator_step(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_completed_integrator_step(fmi2_import_instance_t* inst,
+    fmi2_boolean_t noSetFMUStatePriorToCurrentPoint,
+    fmi2_boolean_t* enterEventMode, fmi2_boolean_t* terminateSimulation);
+/** \brief Instance variant of fmi2_import_get_derivatives(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_derivatives(fmi2_import_instance_t* inst, fmi2_real_t derivatives[], size_t nx);
+/** \brief Instance variant of fmi2_import_get_event_indicators(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_event_indicators(fmi2_import_instance_t* inst, fmi2_real_t eventIndicators[], size_t ni);
+/** \brief Instance variant of fmi2_import_get_continuous_states(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_continuous_states(fmi2_import_instance_t* inst, fmi2_real_t states[], size_t nx);
+/** \brief Instance variant of fmi2_import_get_nominals_of_continuous_states(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_nominals_of_continuous_states(fmi2_import_instance_t* inst, fmi2_real_t x_nominal[], size_t nx);
+/** @} */
+
+/** \name Co-Simulation functions
+ * @see fmi2_import_capi_cs
+ * @{
+ */
+/** \brief Instance variant of fmi2_import_set_real_input_derivatives(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_set_real_input_derivatives(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], const  fmi2_real_t value[]);
+/** \brief Instance variant of fmi2_import_get_real_output_derivatives(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_real_output_derivatives(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], fmi2_real_t value[]);
+/** \brief Instance variant of fmi2_import_cancel_step(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_cancel_step(fmi2_import_instance_t* inst);
+/** \brief Instance variant of fmi2_import_do_step(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_do_step(fmi2_import_instance_t* inst, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize, fmi2_boolean_t newStep);
+/** \brief Instance variant of fmi2_import_get_status(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_status_t*  value);
+/** \brief Instance variant of fmi2_import_get_real_status(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_real_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_real_t*    value);
+/** \brief Instance variant of fmi2_import_get_integer_status(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_integer_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_integer_t* value);
+/** \brief Instance variant of fmi2_import_get_boolean_status(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_boolean_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_boolean_t* value);
+/** \brief Instance variant of fmi2_import_get_string_status(). */
+FMILIB_EXPORT fmi2_status_t fmi2_import_instance_get_string_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_string_t*  value);
+/** @} */
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_INSTANCE_H_ */
@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_io_plan.h
+*  \brief Public interface to the FMI import C-library. Precompiled batched get and set of a variable list.
+*/
+
+#ifndef FMI2_IMPORT_IO_PLAN_H_
+#define FMI2_IMPORT_IO_PLAN_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+#include "fmi2_import_variable_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_io_plan I/O plans
+	@}
+	\addtogroup fmi2_import_io_plan I/O plans
+	\brief Read and write a fixed set of variables with one FMI call per base type.
+
+	A plan is compiled once from a variable list. The variables are partitioned by base type
+	(Enumeration variables are handled as Integer), the value references of each type are sorted
+	and duplicates, including aliases, are removed. Value buffers are allocated for each type.
+	fmi2_import_io_plan_get() and fmi2_import_io_plan_set() then make at most one fmi2GetXXX or
+	fmi2SetXXX call per type without any allocation.
+
+	The buffers are accessed directly. fmi2_import_io_plan_get_value_index() gives the position of
+	a variable of the list in the buffer of its type.
+
+	Real values may optionally be presented in the display unit or the SI base unit of each
+	variable. The conversion is applied on the buffer after the get and on a separate buffer
+	before the set, so the values in the Real buffer are always in the selected unit. For aliased
+	variables the unit of the alias base variable is used.
+	@{
+	*/
+
+/** \brief Opaque I/O plan. */
+typedef struct fmi2_import_io_plan_t fmi2_import_io_plan_t;
+
+/** \brief Unit of the values in the Real buffer of a plan. */
+typedef enum fmi2_import_io_conversion_enu_t {
+	fmi2_import_io_no_conversion, /**< \brief Values as exchanged with the FMU */
+	fmi2_import_io_display_unit,  /**< \brief Values in the display unit of the variable, if it has one */
+	fmi2_import_io_SI_unit        /**< \brief Values in SI base units, if the variable has a unit */
+} fmi2_import_io_conversion_enu_t;
+
+/** \brief Compile a plan for a variable list.
+	@param fmu The FMU the plan is executed on. The plan must be freed before the FMU.
+	@param vl The variables. The list is not referenced after the call.
+	@param conversion Unit of the values in the Real buffer.
+	@return A new plan or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_io_plan_t* fmi2_import_io_plan_allocate(fmi2_import_t* fmu, fmi2_import_variable_list_t* vl, fmi2_import_io_conversion_enu_t conversion);
+
+/** \brief Free a plan. */
+FMILIB_EXPORT void fmi2_import_io_plan_free(fmi2_import_io_plan_t* plan);
+
+/** \brief Read all variables of the plan into the buffers.
+	@return The most severe status of the FMI calls.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_io_plan_get(fmi2_import_io_plan_t* plan);
+
+/** \brief Write the buffers to all variables of the plan.
+	@return The most severe status of the FMI calls.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_io_plan_set(fmi2_import_io_plan_t* plan);
+
+/** \brief Get the number of distinct value references of a base type. Enumeration is counted as Integer. */
+FMILIB_EXPORT size_t fmi2_import_io_plan_get_vrs_num(fmi2_import_io_plan_t* plan, fmi2_base_type_enu_t type);
+
+/** \brief Get the sorted value references of a base type. Enumeration is returned as Integer. */
+FMILIB_EXPORT const fmi2_value_reference_t* fmi2_import_io_plan_get_vrs(fmi2_import_io_plan_t* plan, fmi2_base_type_enu_t type);
+
+/** \brief Get the position of a variable of the list the plan was compiled from within the buffer of its base type. */
+FMILIB_EXPORT size_t fmi2_import_io_plan_get_value_index(fmi2_import_io_plan_t* plan, size_t listIndex);
+
+/** \brief Get the Real value buffer. */
+FMILIB_EXPORT fmi2_real_t* fmi2_import_io_plan_get_real_values(fmi2_import_io_plan_t* plan);
+
+/** \brief Get the Integer and Enumeration value buffer. */
+FMILIB_EXPORT fmi2_integer_t* fmi2_import_io_plan_get_integer_values(fmi2_import_io_plan_t* plan);
+
+/** \brief Get the Boolean value buffer. */
+FMILIB_EXPORT fmi2_boolean_t* fmi2_import_io_plan_get_boolean_values(fmi2_import_io_plan_t* plan);
+
+/** \brief Get the String value buffer. After a get the strings are owned by the FMU and only valid until the next FMI call. */
+FMILIB_EXPORT fmi2_string_t* fmi2_import_io_plan_get_string_values(fmi2_import_io_plan_t* plan);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_IO_PLAN_H_ */
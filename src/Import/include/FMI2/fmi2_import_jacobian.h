@@ -0,0 +1,131 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_jacobian.h
+*  \brief Public interface to the FMI import C-library. Sparse Jacobian support.
+*
+*  The functions in this file build the sparsity pattern of the state and input
+*  Jacobians from the ModelStructure dependency information, compute a column
+*  coloring and evaluate the sparse Jacobian with one call to
+*  fmi2GetDirectionalDerivative per color.
+*/
+
+#ifndef FMI2_IMPORT_JACOBIAN_H_
+#define FMI2_IMPORT_JACOBIAN_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_functions.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_jacobian Sparse Jacobian evaluation
+	@}
+	\addtogroup fmi2_import_jacobian Sparse Jacobian evaluation
+	\brief Sparsity pattern, column coloring and compressed evaluation of model Jacobians.
+
+	The rows of a Jacobian are the state derivatives followed by the outputs, in the
+	order they are listed in the ModelStructure element. The columns are either the
+	continuous states (in the order of the derivatives) or the Real inputs (in the
+	order of the ModelVariables list). Rows without dependency information are treated
+	as dense.
+
+	Two columns get the same color only if they have no row in common (distance-2
+	coloring of the column intersection graph). All columns of one color can therefore
+	be seeded together and the full Jacobian is recovered from one directional
+	derivative call per color.
+	@{
+	*/
+
+/** \brief Selects the known variables (columns) of a Jacobian. */
+typedef enum fmi2_import_jacobian_kind_enu_t {
+	fmi2_import_jacobian_states = 0, /**< \brief Derivatives and outputs with respect to the continuous states. */
+	fmi2_import_jacobian_inputs = 1  /**< \brief Derivatives and outputs with respect to the Real inputs. */
+} fmi2_import_jacobian_kind_enu_t;
+
+/** \brief Opaque Jacobian object holding the sparsity pattern and the column coloring. */
+typedef struct fmi2_import_jacobian_t fmi2_import_jacobian_t;
+
+/** \brief Build the sparsity pattern and column coloring of a Jacobian.
+ *
+ * Only the model description is used, i.e., the FMU binary does not need to be loaded.
+ * @param fmu An FMU object as returned by fmi2_import_parse_xml().
+ * @param kind Selects the columns of the Jacobian.
+ * @return A Jacobian object that must be freed with fmi2_import_free_jacobian(), or NULL on error.
+ */
+FMILIB_EXPORT fmi2_import_jacobian_t* fmi2_import_create_jacobian(fmi2_import_t* fmu, fmi2_import_jacobian_kind_enu_t kind);
+
+/** \brief Free a Jacobian object created with fmi2_import_create_jacobian(). */
+FMILIB_EXPORT void fmi2_import_free_jacobian(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the number of rows (derivatives + outputs) of the Jacobian. */
+FMILIB_EXPORT size_t fmi2_import_get_jacobian_rows_num(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the number of columns (states or inputs) of the Jacobian. */
+FMILIB_EXPORT size_t fmi2_import_get_jacobian_columns_num(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the number of structurally non-zero elements of the Jacobian. */
+FMILIB_EXPORT size_t fmi2_import_get_jacobian_nonzeros_num(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the value references of the rows (unknowns) of the Jacobian. */
+FMILIB_EXPORT const fmi2_value_reference_t* fmi2_import_get_jacobian_row_vrs(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the value references of the columns (knowns) of the Jacobian. */
+FMILIB_EXPORT const fmi2_value_reference_t* fmi2_import_get_jacobian_column_vrs(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the sparsity pattern in row-compressed format.
+ * @param jac A Jacobian object.
+ * @param rowStart - outputs a pointer to an array of start indices (size of array is number of rows + 1).
+ *                   First element is zero, last is equal to the number of non-zeros.
+ * @param columnIndex - outputs a pointer to the 0-based column indices. Indices within a row are sorted.
+ */
+FMILIB_EXPORT void fmi2_import_get_jacobian_sparsity(fmi2_import_jacobian_t* jac, const size_t** rowStart, const size_t** columnIndex);
+
+/** \brief Get the number of colors, i.e., the number of directional derivative calls needed to evaluate the Jacobian. */
+FMILIB_EXPORT size_t fmi2_import_get_jacobian_colors_num(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the color assigned to each column (array of size number of columns). */
+FMILIB_EXPORT const size_t* fmi2_import_get_jacobian_column_colors(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the column groups of the coloring in compressed format.
+ * @param jac A Jacobian object.
+ * @param colorStart - outputs a pointer to an array of start indices (size of array is number of colors + 1).
+ * @param colorColumns - outputs a pointer to the 0-based column indices of each color, sorted within a color.
+ */
+FMILIB_EXPORT void fmi2_import_get_jacobian_coloring(fmi2_import_jacobian_t* jac, const size_t** colorStart, const size_t** colorColumns);
+
+/** \brief Evaluate the sparse Jacobian using one call to fmi2GetDirectionalDerivative per color.
+ *
+ * The FMU must be loaded and instantiated and provide directional derivatives.
+ * @param fmu An FMU object the Jacobian was created for.
+ * @param jac A Jacobian object.
+ * @param values Output array of size fmi2_import_get_jacobian_nonzeros_num() that receives the
+ *               non-zero elements in the order of the row-compressed sparsity pattern.
+ * @return The worst FMI status returned by the FMU calls. The evaluation stops at the first error.
+ */
+FMILIB_EXPORT fmi2_status_t fmi2_import_eval_jacobian(fmi2_import_t* fmu, fmi2_import_jacobian_t* jac, fmi2_real_t values[]);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_JACOBIAN_H_ */
@@ -0,0 +1,240 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_master.h
+*  \brief Public interface to the FMI import C-library. Co-simulation master stepping connected FMUs.
+*/
+
+#ifndef FMI2_IMPORT_MASTER_H_
+#define FMI2_IMPORT_MASTER_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_master Co-simulation master
+	@}
+	\addtogroup fmi2_import_master Co-simulation master
+	\brief Fixed step co-simulation of a set of connected FMUs.
+
+	The master steps a set of co-simulation FMUs and exchanges values between them over
+	connections from outputs to inputs. The FMUs are instantiated and initialized by the user;
+	the master only calls the set, get and fmi2DoStep functions.
+
+	Connections are compiled by fmi2_import_master_prepare() into a plan: every connection gets
+	a slot in one shared value buffer per base type (Real, Integer/Enumeration, Boolean). The slots
+	are grouped by source FMU and then by destination FMU, so each FMU gets its outputs with one
+	call per type directly into its slots, and sets its inputs directly from the slots with one
+	call per connected source FMU and type. No values are copied between the FMUs. String
+	connections are not supported.
+
+	Optionally, see fmi2_import_master_set_unit_conversion(), Real values are converted from the
+	unit of the output to the unit of the input. The linear conversion is computed from the unit
+	definitions once and applied on the slots after each get.
+
+	In ::fmi2_import_master_jacobi mode all FMUs set their inputs, step and get their outputs
+	concurrently on a work-stealing thread pool. The buffers are double buffered: the FMUs read
+	the values of the previous step from one buffer while writing the new values to the other,
+	and the buffers are swapped after all FMUs completed the step. The wall time of a macro step is then bounded by the slowest FMU rather than by the
+	sum over all FMUs. The FMUs must therefore support being called from different threads and the
+	::jm_callbacks memory and logger functions must be thread-safe.
+
+	In ::fmi2_import_master_gauss_seidel mode the FMUs are stepped one by one, each using the
+	outputs its sources produced in the same macro step. The order follows the connection graph:
+	an FMU is stepped after the FMUs it gets inputs from. Loops are broken at the FMU with the
+	fewest pending inputs with direct feedthrough to its outputs (see fmi2_import_get_dependents()).
+
+	With a step control, see fmi2_import_master_set_step_control(), fmi2_import_master_do_adaptive_step()
+	adapts the communication step size to the coupling error. At the start of a step the master gets the
+	output derivatives of the connected Real outputs, up to the maxOutputDerivativeOrder of the source FMU.
+	FMUs with the canInterpolateInputs capability get them with fmi2_import_set_real_input_derivatives()
+	and extrapolate their inputs with a polynomial of that order; other FMUs hold their inputs constant.
+	After the step, the difference between the new output and the extrapolation the destination used
+	estimates the coupling error of each connection. In Gauss-Seidel mode only the connections closing a loop
+	are extrapolated and checked, since the other inputs already come from the end of the step.
+	If the error exceeds the tolerance and all FMUs can get and set their FMU state, the FMUs are rolled
+	back and the step is repeated with a smaller size. Otherwise the step is accepted. The next step size
+	follows from the error and the extrapolation order. All FMUs must have the canHandleVariableCommunicationStepSize
+	capability.
+	@{
+	*/
+
+/** \brief Opaque co-simulation master. */
+typedef struct fmi2_import_master_t fmi2_import_master_t;
+
+/** \brief Stepping scheme. */
+typedef enum fmi2_import_master_mode_enu_t {
+	fmi2_import_master_jacobi,      /**< \brief All FMUs step in parallel using the outputs of the previous macro step */
+	fmi2_import_master_gauss_seidel /**< \brief FMUs step sequentially in connection order using the latest outputs */
+} fmi2_import_master_mode_enu_t;
+
+/** \brief Timing statistics of the master. Times are wall clock times in seconds. */
+typedef struct fmi2_import_master_stats_t {
+	size_t stepsNum;          /**< \brief Number of macro steps */
+	double lastStepTime;      /**< \brief Duration of the last macro step */
+	double maxStepTime;       /**< \brief Longest macro step */
+	double totalStepTime;     /**< \brief Sum over all macro steps */
+	double totalExchangeTime; /**< \brief Time spent setting inputs and getting outputs, summed over all FMUs */
+	size_t rejectedStepsNum;  /**< \brief Number of adaptive steps that were rolled back and repeated */
+} fmi2_import_master_stats_t;
+
+/** \brief Timing statistics of one FMU. The times include setting inputs and getting outputs. */
+typedef struct fmi2_import_master_fmu_stats_t {
+	double lastStepTime;      /**< \brief Duration of the last step */
+	double maxStepTime;       /**< \brief Longest step */
+	double totalStepTime;     /**< \brief Sum over all steps */
+} fmi2_import_master_fmu_stats_t;
+
+/** \brief Parameters of the adaptive communication step size. */
+typedef struct fmi2_import_master_step_control_t {
+	fmi2_real_t relativeTolerance; /**< \brief Relative tolerance of the coupling error */
+	fmi2_real_t absoluteTolerance; /**< \brief Absolute tolerance of the coupling error */
+	fmi2_real_t initialStepSize;   /**< \brief Size of the first step */
+	fmi2_real_t minStepSize;       /**< \brief Steps of this size are accepted whatever the error */
+	fmi2_real_t maxStepSize;       /**< \brief Largest step size */
+	fmi2_real_t safetyFactor;      /**< \brief Factor below one applied to the step size predicted by the error */
+	fmi2_real_t maxIncrease;       /**< \brief Largest factor from one step size to the next */
+	fmi2_real_t maxDecrease;       /**< \brief Smallest factor from one step size to the next */
+	unsigned int maxDerivativeOrder; /**< \brief Highest order of output derivatives used for extrapolation, at most 2 */
+} fmi2_import_master_step_control_t;
+
+/** \brief Create an empty master.
+	@param cb Callbacks for memory management and logging. May be NULL if defaults are utilized.
+	@return A new master or NULL on memory allocation failure.
+*/
+FMILIB_EXPORT fmi2_import_master_t* fmi2_import_master_allocate(jm_callbacks* cb);
+
+/** \brief Free a master and its thread pool. The FMUs are not affected. */
+FMILIB_EXPORT void fmi2_import_master_free(fmi2_import_master_t* m);
+
+/** \brief Add a co-simulation FMU. The FMU must stay valid as long as the master is used.
+	@param m A master.
+	@param fmu An FMU object that has loaded the co-simulation FMI functions, see fmi2_import_create_dllfmu().
+	@param fmuIndex Output: index identifying the FMU in the master.
+	@return Error status.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_master_add_fmu(fmi2_import_master_t* m, fmi2_import_t* fmu, size_t* fmuIndex);
+
+/** \brief Connect an output of one FMU to an input of another. Each input may be connected only once.
+	The variables must have the same base type; Enumeration and Integer variables may be connected to each other.
+	A warning is logged if the source is not an output or the destination is not an input.
+	@param m A master.
+	@param srcFmu Index of the FMU providing the value.
+	@param output Name of the source variable.
+	@param dstFmu Index of the FMU receiving the value.
+	@param input Name of the destination variable.
+	@return Error status.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_master_connect(fmi2_import_master_t* m, size_t srcFmu, const char* output, size_t dstFmu, const char* input);
+
+/** \brief Enable or disable unit conversion on Real connections.
+	When enabled, values are converted with the SI factor and offset of the units of the
+	connected variables. Offsets are not applied if either variable is a relative quantity.
+	Connections between variables without units or with incompatible units are not converted.
+	Disabled by default. Takes effect at the next fmi2_import_master_prepare().
+	@param m A master.
+	@param enable Non-zero to enable the conversion.
+*/
+FMILIB_EXPORT void fmi2_import_master_set_unit_conversion(fmi2_import_master_t* m, int enable);
+
+/** \brief Compile the connections into the exchange plan and start the thread pool.
+	Must be called after the last FMU or connection was added and before stepping.
+	@param m A master.
+	@param mode The stepping scheme.
+	@param threadsNum Number of threads used in Jacobi mode, including the calling thread.
+	       Zero selects one thread per FMU. Ignored in Gauss-Seidel mode.
+	@return Error status.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_master_prepare(fmi2_import_master_t* m, fmi2_import_master_mode_enu_t mode, size_t threadsNum);
+
+/** \brief Propagate the current outputs to the connected inputs.
+	The FMUs are visited in Gauss-Seidel order, setting the inputs of each FMU before reading its
+	outputs, so that values pass through chains of direct feedthrough. Typically called once when
+	all FMUs are initialized, before the first step.
+	@return The most severe status returned by the FMUs.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_master_exchange(fmi2_import_master_t* m);
+
+/** \brief Perform one macro step with all FMUs.
+	@param m A prepared master.
+	@param currentCommunicationPoint Start time of the step.
+	@param communicationStepSize Length of the step.
+	@return The most severe status returned by the FMUs. The status of each FMU is available through fmi2_import_master_get_fmu_status().
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_master_do_step(fmi2_import_master_t* m, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize);
+
+/** \brief Get the default step control: tolerances 1e-4, step sizes from 1e-6 to 1, initial step size 1e-3,
+	safety factor 0.9, step size change between 0.2 and 2 times, derivatives up to order 2. */
+FMILIB_EXPORT void fmi2_import_master_get_default_step_control(fmi2_import_master_step_control_t* control);
+
+/** \brief Enable the adaptive communication step size. Takes effect at the next fmi2_import_master_prepare(),
+	which fails if an FMU cannot handle variable communication step sizes.
+	The FMU states used for rollback are freed by fmi2_import_master_free(), which must therefore be
+	called before the FMUs are freed.
+	@param m A master.
+	@param control The step control parameters, copied. NULL disables the adaptive step size.
+	@return jm_status_error if the parameters are not consistent.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_master_set_step_control(fmi2_import_master_t* m, const fmi2_import_master_step_control_t* control);
+
+/** \brief Perform one macro step with all FMUs with the adaptive step size.
+	Rejected attempts are rolled back and repeated within the call.
+	@param m A master prepared with a step control.
+	@param currentCommunicationPoint Start time of the step.
+	@param stopTime The step does not go beyond this time, e.g., the next output time or the end of the simulation.
+	@param stepSize Output: size of the accepted step.
+	@return The most severe status returned by the FMUs in the accepted step.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_master_do_adaptive_step(fmi2_import_master_t* m, fmi2_real_t currentCommunicationPoint, fmi2_real_t stopTime, fmi2_real_t* stepSize);
+
+/** \brief Get the size the next adaptive step will try. */
+FMILIB_EXPORT fmi2_real_t fmi2_import_master_get_next_step_size(fmi2_import_master_t* m);
+
+/** \brief Get the number of FMUs added to the master. */
+FMILIB_EXPORT size_t fmi2_import_master_get_fmus_num(fmi2_import_master_t* m);
+
+/** \brief Get the most severe status returned by an FMU in the last step or exchange. */
+FMILIB_EXPORT fmi2_status_t fmi2_import_master_get_fmu_status(fmi2_import_master_t* m, size_t fmuIndex);
+
+/** \brief Get the order in which the FMUs are stepped in Gauss-Seidel mode.
+	@param m A prepared master.
+	@return Array of FMU indices, fmi2_import_master_get_fmus_num() long.
+*/
+FMILIB_EXPORT const size_t* fmi2_import_master_get_order(fmi2_import_master_t* m);
+
+/** \brief Get the timing statistics of the master. */
+FMILIB_EXPORT void fmi2_import_master_get_stats(fmi2_import_master_t* m, fmi2_import_master_stats_t* stats);
+
+/** \brief Get the timing statistics of one FMU. */
+FMILIB_EXPORT void fmi2_import_master_get_fmu_stats(fmi2_import_master_t* m, size_t fmuIndex, fmi2_import_master_fmu_stats_t* stats);
+
+/** \brief Reset all timing statistics. */
+FMILIB_EXPORT void fmi2_import_master_reset_stats(fmi2_import_master_t* m);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_MASTER_H_ */
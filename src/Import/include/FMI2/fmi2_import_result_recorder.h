@@ -0,0 +1,162 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+
+
+/** \file fmi2_import_result_recorder.h
+*  \brief Public interface to the FMI import C-library. Recording of simulation results to files.
+*/
+
+#ifndef FMI2_IMPORT_RESULT_RECORDER_H_
+#define FMI2_IMPORT_RESULT_RECORDER_H_
+
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+#include "fmi2_import_variable.h"
+#include "fmi2_import_variable_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+		/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_result_recorder Result recording
+	@}
+	\addtogroup fmi2_import_result_recorder Result recording
+	\brief Record the values of variables at each sample time to a binary result file.
+
+	The Real, Integer, Enumeration and Boolean variables of an FMU are registered with a recorder.
+	Aliases share a value reference and are stored in one column. Each sample makes one get call
+	per base type and stores the values in a chunk of columns. Full chunks are handed to a background
+	thread that writes them to the file while the simulation fills the other chunk. The simulation
+	only waits if the writer has not finished the previous chunk, which is counted as a stall.
+
+	Two file formats are supported:
+	- ::fmi2_import_result_format_binary is a compact columnar format read by fmi2_import_result_file_open().
+	It stores Real columns as doubles, Integer columns as 32 bit integers and Boolean columns as bytes,
+	in the byte order of the writing machine. Each chunk is one block that may be compressed with zlib.
+	- ::fmi2_import_result_format_mat4 is a MATLAB v4 MAT-file in the layout of Dymola result files,
+	version 1.1 with transposed matrices, so that tools that read such files can read it. The matrices are
+	"Aclass", "name" and "description" (one column per variable, the first is the time), "dataInfo"
+	(a column of 4 per variable: the data matrix, the row in it, interpolation and extrapolation),
+	"data_1" (the first and last sample time) and "data_2" (one column per sample with the time in row 1,
+	all values as doubles). The format has no compression.
+	@{
+	*/
+
+/** \brief Opaque result recorder. */
+typedef struct fmi2_import_result_recorder_t fmi2_import_result_recorder_t;
+
+/** \brief Result file formats. */
+typedef enum fmi2_import_result_format_enu_t {
+	fmi2_import_result_format_binary, /**< \brief Columnar binary blocks, optionally compressed */
+	fmi2_import_result_format_mat4    /**< \brief MATLAB v4 MAT-file */
+} fmi2_import_result_format_enu_t;
+
+/** \brief Allocate a recorder for the instance of an FMU.
+	@param fmu An FMU that has loaded its binary. The recorder must be freed before the binary is unloaded.
+	@param chunkRows Number of samples per chunk and per block of the file. Zero selects 256.
+	@return A new recorder or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_result_recorder_t* fmi2_import_result_recorder_allocate(fmi2_import_t* fmu, size_t chunkRows);
+
+/** \brief Stop the recorder if it is started and free it. */
+FMILIB_EXPORT void fmi2_import_result_recorder_free(fmi2_import_result_recorder_t* rec);
+
+/** \brief Set the zlib compression level of the blocks of the binary format.
+	@param level 0 stores the blocks uncompressed (the default), 1 to 9 trade speed for size.
+	@return jm_status_error if the level is out of range or the recorder is started.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_result_recorder_set_compression(fmi2_import_result_recorder_t* rec, int level);
+
+/** \brief Register a variable. Must be called before fmi2_import_result_recorder_start().
+	@return jm_status_error for String variables or if the recorder is started.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_result_recorder_add_variable(fmi2_import_result_recorder_t* rec, fmi2_import_variable_t* v);
+
+/** \brief Register the variables of a list. String variables are skipped with a warning. */
+FMILIB_EXPORT jm_status_enu_t fmi2_import_result_recorder_add_variables(fmi2_import_result_recorder_t* rec, fmi2_import_variable_list_t* vl);
+
+/** \brief Get the number of registered variables. */
+FMILIB_EXPORT size_t fmi2_import_result_recorder_get_variables_num(fmi2_import_result_recorder_t* rec);
+
+/** \brief Get the number of stored columns, i.e., the registered variables without aliases. Valid after start. */
+FMILIB_EXPORT size_t fmi2_import_result_recorder_get_columns_num(fmi2_import_result_recorder_t* rec);
+
+/** \brief Create the result file and start the writer thread.
+	@param fileName The result file, overwritten if it exists.
+	@param format Format of the file.
+	@return jm_status_error if no variables are registered, the file could not be created or the thread not started.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_result_recorder_start(fmi2_import_result_recorder_t* rec, const char* fileName, fmi2_import_result_format_enu_t format);
+
+/** \brief Record the values of the variables at a time.
+	@return The most severe status of the get calls. The sample is recorded unless an error occurred.
+*/
+FMILIB_EXPORT fmi2_status_t fmi2_import_result_recorder_sample(fmi2_import_result_recorder_t* rec, fmi2_real_t time);
+
+/** \brief Write the remaining samples, close the file and stop the writer thread.
+	@return jm_status_error if the file could not be written.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_result_recorder_stop(fmi2_import_result_recorder_t* rec);
+
+/** \brief Get the number of recorded samples since the start. */
+FMILIB_EXPORT size_t fmi2_import_result_recorder_get_samples_num(fmi2_import_result_recorder_t* rec);
+
+/** \brief Get the number of times a sample waited for the writer since the start. */
+FMILIB_EXPORT size_t fmi2_import_result_recorder_get_stalls_num(fmi2_import_result_recorder_t* rec);
+
+/** \brief Opaque result file read into memory. */
+typedef struct fmi2_import_result_file_t fmi2_import_result_file_t;
+
+/** \brief Read a result file written in the ::fmi2_import_result_format_binary format.
+	@param cb Callbacks used for memory and logging.
+	@param fileName The result file.
+	@return The results or NULL on error.
+*/
+FMILIB_EXPORT fmi2_import_result_file_t* fmi2_import_result_file_open(jm_callbacks* cb, const char* fileName);
+
+/** \brief Free the results read with fmi2_import_result_file_open(). */
+FMILIB_EXPORT void fmi2_import_result_file_close(fmi2_import_result_file_t* res);
+
+/** \brief Get the number of variables in a result file. */
+FMILIB_EXPORT size_t fmi2_import_result_file_get_variables_num(fmi2_import_result_file_t* res);
+
+/** \brief Get the name of a variable in a result file. */
+FMILIB_EXPORT const char* fmi2_import_result_file_get_variable_name(fmi2_import_result_file_t* res, size_t index);
+
+/** \brief Get the index of a variable by its name.
+	@return jm_status_error if there is no such variable.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_result_file_find_variable(fmi2_import_result_file_t* res, const char* name, size_t* index);
+
+/** \brief Get the number of samples in a result file. */
+FMILIB_EXPORT size_t fmi2_import_result_file_get_samples_num(fmi2_import_result_file_t* res);
+
+/** \brief Get the sample times. The array has fmi2_import_result_file_get_samples_num() entries. */
+FMILIB_EXPORT const fmi2_real_t* fmi2_import_result_file_get_time(fmi2_import_result_file_t* res);
+
+/** \brief Copy the values of a variable, converted to Real, to an array with fmi2_import_result_file_get_samples_num() entries. */
+FMILIB_EXPORT void fmi2_import_result_file_get_values(fmi2_import_result_file_t* res, size_t index, fmi2_real_t values[]);
+
+/**@} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI2_IMPORT_RESULT_RECORDER_H_ */
@@ -0,0 +1,765 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <FMI/fmi_import_solver.h>
+#include <FMI/fmi_import_zero_crossing.h>
+#include <FMI/fmi_trace_recorder.h>
+#include <JM/jm_portability.h>
+#include "../FMI1/fmi1_import_impl.h"
+#include "../FMI2/fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+/* The FMI 1.0 and 2.0 status codes have the same values */
+#define FMI_SOLVER_ERROR fmi2_status_error
+
+#define FMI_SOLVER_WORST(a, b) (((b) > (a)) ? (b) : (a))
+
+/* Number of stage derivative vectors (Dormand-Prince uses seven) */
+#define FMI_SOLVER_STAGES 7
+
+/* Number of dense output coefficient vectors besides the states */
+#define FMI_SOLVER_DENSE 4
+
+/* Event localisation stops when the crossing is bracketed this tightly, relative to max(1, |t|) */
+#define FMI_SOLVER_EVENT_TOLERANCE 1e-12
+#define FMI_SOLVER_EVENT_ITERATIONS 100
+
+/* Result of an event iteration */
+typedef struct fmi_import_solver_event_t {
+	int terminate;
+	int statesChanged;
+	int nominalsChanged;
+	int nextEventTimeDefined;
+	double nextEventTime;
+} fmi_import_solver_event_t;
+
+/* The model functions of one FMI version. The context is the CAPI of the FMU.
+   All functions return an FMI status. */
+typedef struct fmi_import_solver_model_t {
+	int (*set_time)(void* capi, double time);
+	int (*set_states)(void* capi, const double x[], size_t nx);
+	int (*get_states)(void* capi, double x[], size_t nx);
+	int (*get_derivatives)(void* capi, double dx[], size_t nx);
+	int (*get_event_indicators)(void* capi, double z[], size_t nz);
+	int (*get_nominals)(void* capi, double nominal[], size_t nx);
+	int (*completed_step)(void* capi, int* stepEvent, int* terminate);
+	/* handle an event during continuous time integration */
+	int (*event_update)(void* capi, fmi_import_solver_event_t* event);
+} fmi_import_solver_model_t;
+
+struct fmi_import_solver_t {
+	jm_callbacks* callbacks;
+	const fmi_import_solver_model_t* model;
+	void* capi;
+	fmi_import_solver_method_enu_t method;
+	double stepSize;
+	double tolerance;
+	double hysteresis;
+
+	size_t nx;
+	size_t nz;
+
+	/* all working vectors are views into one buffer */
+	double* buffer;
+	double* x;       /* states at the current time */
+	double* xNew;    /* states at the end of the step */
+	double* xStage;  /* states of an intermediate stage */
+	double* nominal; /* magnitude of the nominal values of the states */
+	double* k[FMI_SOLVER_STAGES];
+	double* dense[FMI_SOLVER_DENSE];
+	double* z;       /* event indicators at the end of the step */
+	double* zPrev;   /* event indicators at the current time */
+	double* zMid;    /* event indicators during event localisation */
+
+	double time;
+	double hNext;    /* proposed size of the next adaptive step */
+	int fsal;        /* k[0] holds the derivatives at the current point */
+	fmi_import_solver_event_t event;
+	int isInitialized;
+	int isTerminated;
+
+	fmi_import_solver_stats_t stats;
+};
+
+/* Dormand-Prince 5(4) coefficients */
+static const double dp_c[FMI_SOLVER_STAGES] = { 0.0, 1.0/5, 3.0/10, 4.0/5, 8.0/9, 1.0, 1.0 };
+static const double dp_a[FMI_SOLVER_STAGES][FMI_SOLVER_STAGES - 1] = {
+	{ 0 },
+	{ 1.0/5 },
+	{ 3.0/40, 9.0/40 },
+	{ 44.0/45, -56.0/15, 32.0/9 },
+	{ 19372.0/6561, -25360.0/2187, 64448.0/6561, -212.0/729 },
+	{ 9017.0/3168, -355.0/33, 46732.0/5247, 49.0/176, -5103.0/18656 },
+	{ 35.0/384, 0.0, 500.0/1113, 125.0/192, -2187.0/6784, 11.0/84 }
+};
+/* difference between the fifth and fourth order solutions */
+static const double dp_e[FMI_SOLVER_STAGES] = {
+	71.0/57600, 0.0, -71.0/16695, 71.0/1920, -17253.0/339200, 22.0/525, -1.0/40
+};
+/* dense output */
+static const double dp_d[FMI_SOLVER_STAGES] = {
+	-12715105075.0/11282082432, 0.0, 87487479700.0/32700410799, -10690763975.0/1880347072,
+	701980252875.0/199316789632, -1453857185.0/822651844, 69997945.0/29380423
+};
+
+/* ------------------------------------------------------------------ */
+/* FMI 1.0 model functions */
+
+static int fmi1_import_solver_set_time(void* capi, double time) {
+	return fmi1_capi_set_time((fmi1_capi_t*)capi, time);
+}
+
+static int fmi1_import_solver_set_states(void* capi, const double x[], size_t nx) {
+	return fmi1_capi_set_continuous_states((fmi1_capi_t*)capi, x, nx);
+}
+
+static int fmi1_import_solver_get_states(void* capi, double x[], size_t nx) {
+	return fmi1_capi_get_continuous_states((fmi1_capi_t*)capi, x, nx);
+}
+
+static int fmi1_import_solver_get_derivatives(void* capi, double dx[], size_t nx) {
+	return fmi1_capi_get_derivatives((fmi1_capi_t*)capi, dx, nx);
+}
+
+static int fmi1_import_solver_get_event_indicators(void* capi, double z[], size_t nz) {
+	return fmi1_capi_get_event_indicators((fmi1_capi_t*)capi, z, nz);
+}
+
+static int fmi1_import_solver_get_nominals(void* capi, double nominal[], size_t nx) {
+	return fmi1_capi_get_nominal_continuous_states((fmi1_capi_t*)capi, nominal, nx);
+}
+
+static int fmi1_import_solver_completed_step(void* capi, int* stepEvent, int* terminate) {
+	fmi1_boolean_t callEventUpdate = fmi1_false;
+	int status = fmi1_capi_completed_integrator_step((fmi1_capi_t*)capi, &callEventUpdate);
+	*stepEvent = callEventUpdate;
+	*terminate = 0;
+	return status;
+}
+
+static void fmi1_import_solver_convert_event(const fmi1_event_info_t* info, fmi_import_solver_event_t* event) {
+	event->terminate = info->terminateSimulation;
+	event->statesChanged = info->stateValuesChanged || info->stateValueReferencesChanged;
+	event->nominalsChanged = info->stateValueReferencesChanged;
+	event->nextEventTimeDefined = info->upcomingTimeEvent;
+	event->nextEventTime = info->nextEventTime;
+}
+
+static int fmi1_import_solver_event_update(void* capi, fmi_import_solver_event_t* event) {
+	fmi1_event_info_t info;
+	int status = fmi1_status_ok;
+
+	memset(&info, 0, sizeof(info));
+	do {
+		status = FMI_SOLVER_WORST(status, fmi1_capi_eventUpdate((fmi1_capi_t*)capi, fmi1_false, &info));
+	} while(!info.iterationConverged && !info.terminateSimulation && status < FMI_SOLVER_ERROR);
+	fmi1_import_solver_convert_event(&info, event);
+	return status;
+}
+
+static const fmi_import_solver_model_t fmi1_import_solver_model = {
+	fmi1_import_solver_set_time,
+	fmi1_import_solver_set_states,
+	fmi1_import_solver_get_states,
+	fmi1_import_solver_get_derivatives,
+	fmi1_import_solver_get_event_indicators,
+	fmi1_import_solver_get_nominals,
+	fmi1_import_solver_completed_step,
+	fmi1_import_solver_event_update
+};
+
+/* ------------------------------------------------------------------ */
+/* FMI 2.0 model functions */
+
+static int fmi2_import_solver_set_time(void* capi, double time) {
+	return fmi2_capi_set_time((fmi2_capi_t*)capi, time);
+}
+
+static int fmi2_import_solver_set_states(void* capi, const double x[], size_t nx) {
+	return fmi2_capi_set_continuous_states((fmi2_capi_t*)capi, x, nx);
+}
+
+static int fmi2_import_solver_get_states(void* capi, double x[], size_t nx) {
+	return fmi2_capi_get_continuous_states((fmi2_capi_t*)capi, x, nx);
+}
+
+static int fmi2_import_solver_get_derivatives(void* capi, double dx[], size_t nx) {
+	return fmi2_capi_get_derivatives((fmi2_capi_t*)capi, dx, nx);
+}
+
+static int fmi2_import_solver_get_event_indicators(void* capi, double z[], size_t nz) {
+	return fmi2_capi_get_event_indicators((fmi2_capi_t*)capi, z, nz);
+}
+
+static int fmi2_import_solver_get_nominals(void* capi, double nominal[], size_t nx) {
+	return fmi2_capi_get_nominals_of_continuous_states((fmi2_capi_t*)capi, nominal, nx);
+}
+
+static int fmi2_import_solver_completed_step(void* capi, int* stepEvent, int* terminate) {
+	fmi2_boolean_t enterEventMode = fmi2_false, terminateSimulation = fmi2_false;
+	int status = fmi2_capi_completed_integrator_step((fmi2_capi_t*)capi, fmi2_true, &enterEventMode, &terminateSimulation);
+	*stepEvent = enterEventMode;
+	*terminate = terminateSimulation;
+	return status;
+}
+
+/* Event iteration; the FMU is in event mode and is left in continuous time mode */
+static int fmi2_import_solver_event_iteration(fmi2_capi_t* capi, fmi_import_solver_event_t* event) {
+	fmi2_event_info_t info;
+	int status = fmi2_status_ok;
+
+	memset(&info, 0, sizeof(info));
+	info.newDiscreteStatesNeeded = fmi2_true;
+	while(info.newDiscreteStatesNeeded && !info.terminateSimulation && status < FMI_SOLVER_ERROR) {
+		status = FMI_SOLVER_WORST(status, fmi2_capi_new_discrete_states(capi, &info));
+	}
+	event->terminate = info.terminateSimulation;
+	event->statesChanged = info.valuesOfContinuousStatesChanged;
+	event->nominalsChanged = info.nominalsOfContinuousStatesChanged;
+	event->nextEventTimeDefined = info.nextEventTimeDefined;
+	event->nextEventTime = info.nextEventTime;
+	if(status < FMI_SOLVER_ERROR && !event->terminate) {
+		status = FMI_SOLVER_WORST(status, fmi2_capi_enter_continuous_time_mode(capi));
+	}
+	return status;
+}
+
+static int fmi2_import_solver_event_update(void* capi, fmi_import_solver_event_t* event) {
+	int status = fmi2_capi_enter_event_mode((fmi2_capi_t*)capi);
+	if(status >= FMI_SOLVER_ERROR) return status;
+	return FMI_SOLVER_WORST(status, fmi2_import_solver_event_iteration((fmi2_capi_t*)capi, event));
+}
+
+static const fmi_import_solver_model_t fmi2_import_solver_model = {
+	fmi2_import_solver_set_time,
+	fmi2_import_solver_set_states,
+	fmi2_import_solver_get_states,
+	fmi2_import_solver_get_derivatives,
+	fmi2_import_solver_get_event_indicators,
+	fmi2_import_solver_get_nominals,
+	fmi2_import_solver_completed_step,
+	fmi2_import_solver_event_update
+};
+
+/* ------------------------------------------------------------------ */
+/* Allocation and setup */
+
+static fmi_import_solver_t* fmi_import_solver_allocate(jm_callbacks* cb, const fmi_import_solver_model_t* model, void* capi,
+														fmi_import_solver_method_enu_t method, size_t nx, size_t nz) {
+	fmi_import_solver_t* s;
+	double* p;
+	size_t i;
+
+	if(method < fmi_import_solver_euler || method > fmi_import_solver_dopri5) {
+		jm_log_error(cb, module, "Unknown integration method");
+		return 0;
+	}
+	s = (fmi_import_solver_t*)cb->calloc(1, sizeof(fmi_import_solver_t));
+	if(s) {
+		s->buffer = (double*)cb->calloc((4 + FMI_SOLVER_STAGES + FMI_SOLVER_DENSE) * nx + 3 * nz + 1, sizeof(double));
+	}
+	if(!s || !s->buffer) {
+		if(s) cb->free(s);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	s->callbacks = cb;
+	s->model = model;
+	s->capi = capi;
+	s->method = method;
+	s->stepSize = 1e-3;
+	s->tolerance = 1e-6;
+	s->nx = nx;
+	s->nz = nz;
+	p = s->buffer;
+	s->x = p; p += nx;
+	s->xNew = p; p += nx;
+	s->xStage = p; p += nx;
+	s->nominal = p; p += nx;
+	for(i = 0; i < FMI_SOLVER_STAGES; i++) {
+		s->k[i] = p; p += nx;
+	}
+	for(i = 0; i < FMI_SOLVER_DENSE; i++) {
+		s->dense[i] = p; p += nx;
+	}
+	s->z = p; p += nz;
+	s->zPrev = p; p += nz;
+	s->zMid = p;
+	return s;
+}
+
+fmi_import_solver_t* fmi1_import_solver_allocate(fmi1_import_t* fmu, fmi_import_solver_method_enu_t method) {
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module, "FMU CAPI is not loaded");
+		return 0;
+	}
+	if(fmu->capi->standard != fmi1_fmu_kind_enu_me) {
+		jm_log_error(fmu->callbacks, module, "The solver requires the model exchange FMI functions, see fmi1_import_create_dllfmu()");
+		return 0;
+	}
+	return fmi_import_solver_allocate(fmu->callbacks, &fmi1_import_solver_model, fmu->capi, method,
+		fmi1_import_get_number_of_continuous_states(fmu), fmi1_import_get_number_of_event_indicators(fmu));
+}
+
+fmi_import_solver_t* fmi2_import_solver_allocate(fmi2_import_t* fmu, fmi_import_solver_method_enu_t method) {
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module, "FMU CAPI is not loaded");
+		return 0;
+	}
+	if(fmu->capi->standard != fmi2_fmu_kind_me) {
+		jm_log_error(fmu->callbacks, module, "The solver requires the model exchange FMI functions, see fmi2_import_create_dllfmu()");
+		return 0;
+	}
+	return fmi_import_solver_allocate(fmu->callbacks, &fmi2_import_solver_model, fmu->capi, method,
+		fmi2_import_get_number_of_continuous_states(fmu), fmi2_import_get_number_of_event_indicators(fmu));
+}
+
+void fmi_import_solver_free(fmi_import_solver_t* s) {
+	if(!s) return;
+	s->callbacks->free(s->buffer);
+	s->callbacks->free(s);
+}
+
+jm_status_enu_t fmi_import_solver_set_step_size(fmi_import_solver_t* s, double stepSize) {
+	if(!(stepSize > 0)) {
+		jm_log_error(s->callbacks, module, "The step size must be positive");
+		return jm_status_error;
+	}
+	s->stepSize = stepSize;
+	s->hNext = stepSize;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi_import_solver_set_event_hysteresis(fmi_import_solver_t* s, double epsilon) {
+	if(!(epsilon >= 0)) {
+		jm_log_error(s->callbacks, module, "The event hysteresis must not be negative");
+		return jm_status_error;
+	}
+	s->hysteresis = epsilon;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi_import_solver_set_tolerance(fmi_import_solver_t* s, double relativeTolerance) {
+	if(!(relativeTolerance > 0)) {
+		jm_log_error(s->callbacks, module, "The tolerance must be positive");
+		return jm_status_error;
+	}
+	s->tolerance = relativeTolerance;
+	return jm_status_success;
+}
+
+/* Read the nominal values used to scale the error estimate */
+static int fmi_import_solver_update_nominals(fmi_import_solver_t* s) {
+	int status;
+	size_t i;
+	if(s->method != fmi_import_solver_dopri5) return fmi2_status_ok;
+	status = s->model->get_nominals(s->capi, s->nominal, s->nx);
+	for(i = 0; i < s->nx; i++) {
+		s->nominal[i] = fabs(s->nominal[i]);
+		if(s->nominal[i] == 0) s->nominal[i] = 1.0;
+	}
+	return status;
+}
+
+/* Take over the result of an event iteration and read the values that changed */
+static int fmi_import_solver_after_event(fmi_import_solver_t* s, int status, int initial) {
+	if(status >= FMI_SOLVER_ERROR) return status;
+	s->fsal = 0;
+	if(s->event.terminate) {
+		s->isTerminated = 1;
+		return status;
+	}
+	if(initial || s->event.statesChanged) {
+		status = FMI_SOLVER_WORST(status, s->model->get_states(s->capi, s->x, s->nx));
+	}
+	if(initial || s->event.nominalsChanged) {
+		status = FMI_SOLVER_WORST(status, fmi_import_solver_update_nominals(s));
+	}
+	status = FMI_SOLVER_WORST(status, s->model->get_event_indicators(s->capi, s->zPrev, s->nz));
+	s->stats.eventIndicatorsNum++;
+	return status;
+}
+
+static int fmi_import_solver_start(fmi_import_solver_t* s, double startTime, int status) {
+	s->time = startTime;
+	s->hNext = s->stepSize;
+	s->isTerminated = 0;
+	status = fmi_import_solver_after_event(s, status, 1);
+	if(status >= FMI_SOLVER_ERROR) {
+		jm_log_error(s->callbacks, module, "Could not start the integration");
+	}
+	s->isInitialized = (status < FMI_SOLVER_ERROR);
+	return status;
+}
+
+fmi1_status_t fmi1_import_solver_initialize(fmi_import_solver_t* s, double startTime, const fmi1_event_info_t* eventInfo) {
+	if(s->model != &fmi1_import_solver_model) {
+		jm_log_error(s->callbacks, module, "The solver was not created for an FMI 1.0 FMU");
+		return fmi1_status_error;
+	}
+	fmi1_import_solver_convert_event(eventInfo, &s->event);
+	return (fmi1_status_t)fmi_import_solver_start(s, startTime, fmi1_status_ok);
+}
+
+fmi2_status_t fmi2_import_solver_initialize(fmi_import_solver_t* s, double startTime) {
+	int status;
+	if(s->model != &fmi2_import_solver_model) {
+		jm_log_error(s->callbacks, module, "The solver was not created for an FMI 2.0 FMU");
+		return fmi2_status_error;
+	}
+	memset(&s->event, 0, sizeof(s->event));
+	status = fmi2_import_solver_event_iteration((fmi2_capi_t*)s->capi, &s->event);
+	return (fmi2_status_t)fmi_import_solver_start(s, startTime, status);
+}
+
+/* ------------------------------------------------------------------ */
+/* Integration */
+
+/* Evaluate the derivatives k at an intermediate point */
+static int fmi_import_solver_stage(fmi_import_solver_t* s, double t, const double* x, double* k) {
+	int status = s->model->set_time(s->capi, t);
+	status = FMI_SOLVER_WORST(status, s->model->set_states(s->capi, x, s->nx));
+	status = FMI_SOLVER_WORST(status, s->model->get_derivatives(s->capi, k, s->nx));
+	s->stats.derivativesNum++;
+	return status;
+}
+
+/* Derivatives at the current point into k[0]. The FMU holds the current point unless k[0] is already valid. */
+static int fmi_import_solver_first_stage(fmi_import_solver_t* s) {
+	int status;
+	if(s->fsal) return fmi2_status_ok;
+	status = s->model->get_derivatives(s->capi, s->k[0], s->nx);
+	s->stats.derivativesNum++;
+	s->fsal = (status < FMI_SOLVER_ERROR);
+	return status;
+}
+
+/* Check the event indicators at the end of the step for a sign change */
+static int fmi_import_solver_find_crossing(fmi_import_solver_t* s) {
+	return fmi_import_find_zero_crossings(s->zPrev, s->z, s->nz, s->hysteresis, 0, 0) > 0;
+}
+
+/* Take the indicators at the end of a step without event as the reference for the next step.
+   An indicator inside the hysteresis band keeps its reference value, so that it still
+   triggers the event when it leaves the band on the other side in a later step. */
+static void fmi_import_solver_advance_indicators(fmi_import_solver_t* s) {
+	const double eps = s->hysteresis;
+	size_t i;
+	if(eps == 0.0) {
+		double* tmp = s->zPrev;
+		s->zPrev = s->z;
+		s->z = tmp;
+		return;
+	}
+	for(i = 0; i < s->nz; i++) {
+		if(s->z[i] > eps || s->z[i] <= -eps) {
+			s->zPrev[i] = s->z[i];
+		}
+	}
+}
+
+static void fmi_import_solver_swap_states(fmi_import_solver_t* s) {
+	double* tmp = s->x;
+	s->x = s->xNew;
+	s->xNew = tmp;
+}
+
+/* One step of a fixed step method towards tLimit. The FMU holds the end point on return. */
+static int fmi_import_solver_fixed_step(fmi_import_solver_t* s, double tLimit, int* stateEvent) {
+	const size_t nx = s->nx;
+	const double t = s->time;
+	double tNext = t + s->stepSize, h;
+	double *x = s->x, *xs = s->xStage, *xn = s->xNew;
+	double *k1 = s->k[0], *k2 = s->k[1], *k3 = s->k[2], *k4 = s->k[3];
+	int status;
+	size_t i;
+
+	/* do not leave a step much shorter than the step size before the limit */
+	if(tNext > tLimit - 1e-9 * s->stepSize) tNext = tLimit;
+	h = tNext - t;
+
+	status = fmi_import_solver_first_stage(s);
+	if(status >= FMI_SOLVER_ERROR) return status;
+
+	switch(s->method) {
+	case fmi_import_solver_euler:
+		for(i = 0; i < nx; i++) xn[i] = x[i] + h * k1[i];
+		break;
+	case fmi_import_solver_heun:
+		for(i = 0; i < nx; i++) xs[i] = x[i] + h * k1[i];
+		status = FMI_SOLVER_WORST(status, fmi_import_solver_stage(s, tNext, xs, k2));
+		if(status >= FMI_SOLVER_ERROR) return status;
+		for(i = 0; i < nx; i++) xn[i] = x[i] + 0.5 * h * (k1[i] + k2[i]);
+		break;
+	default:
+		for(i = 0; i < nx; i++) xs[i] = x[i] + 0.5 * h * k1[i];
+		status = FMI_SOLVER_WORST(status, fmi_import_solver_stage(s, t + 0.5 * h, xs, k2));
+		if(status >= FMI_SOLVER_ERROR) return status;
+		for(i = 0; i < nx; i++) xs[i] = x[i] + 0.5 * h * k2[i];
+		status = FMI_SOLVER_WORST(status, fmi_import_solver_stage(s, t + 0.5 * h, xs, k3));
+		if(status >= FMI_SOLVER_ERROR) return status;
+		for(i = 0; i < nx; i++) xs[i] = x[i] + h * k3[i];
+		status = FMI_SOLVER_WORST(status, fmi_import_solver_stage(s, tNext, xs, k4));
+		if(status >= FMI_SOLVER_ERROR) return status;
+		for(i = 0; i < nx; i++) xn[i] = x[i] + h / 6.0 * (k1[i] + 2.0 * (k2[i] + k3[i]) + k4[i]);
+		break;
+	}
+	status = FMI_SOLVER_WORST(status, s->model->set_time(s->capi, tNext));
+	status = FMI_SOLVER_WORST(status, s->model->set_states(s->capi, xn, nx));
+	if(status >= FMI_SOLVER_ERROR) return status;
+	fmi_import_solver_swap_states(s);
+	s->time = tNext;
+	s->fsal = 0;
+
+	status = FMI_SOLVER_WORST(status, s->model->get_event_indicators(s->capi, s->z, s->nz));
+	s->stats.eventIndicatorsNum++;
+	*stateEvent = fmi_import_solver_find_crossing(s);
+	return status;
+}
+
+/* States at the fraction theta of the last Dormand-Prince step from x */
+static void fmi_import_solver_interpolate(fmi_import_solver_t* s, double theta, double* out) {
+	const double theta1 = 1.0 - theta;
+	double *r2 = s->dense[0], *r3 = s->dense[1], *r4 = s->dense[2], *r5 = s->dense[3];
+	size_t i;
+	for(i = 0; i < s->nx; i++) {
+		out[i] = s->x[i] + theta * (r2[i] + theta1 * (r3[i] + theta * (r4[i] + theta1 * r5[i])));
+	}
+}
+
+/* Locate the earliest sign change of the event indicators within the step from t to t + h.
+   zPrev and z hold the indicators at the ends of the step. On return, theta is the fraction of
+   the step just after the crossing and the FMU holds the interpolated point there. */
+static int fmi_import_solver_locate_event(fmi_import_solver_t* s, double t, double h, double* theta) {
+	double *zl = s->zPrev, *zr = s->z, *zm = s->zMid, *tmp;
+	double tl = 0.0, tr = 1.0;
+	double tol = FMI_SOLVER_EVENT_TOLERANCE * (fabs(t) > 1.0 ? fabs(t) : 1.0) / h;
+	int status = fmi2_status_ok, side = 0, iter;
+	size_t i;
+
+	/* the bracket is narrowed to the plain sign change, the hysteresis only applies to detection */
+	for(iter = 0; iter < FMI_SOLVER_EVENT_ITERATIONS && tr - tl > tol; iter++) {
+		double tm, fraction;
+		int crossed;
+
+		/* regula falsi on every crossing indicator; the earliest estimate wins */
+		fmi_import_find_zero_crossings(zl, zr, s->nz, 0.0, 0, &fraction);
+		tm = tl + (tr - tl) * fraction;
+		if(!(tm > tl && tm < tr)) tm = 0.5 * (tl + tr);
+
+		fmi_import_solver_interpolate(s, tm, s->xStage);
+		status = FMI_SOLVER_WORST(status, s->model->set_time(s->capi, t + tm * h));
+		status = FMI_SOLVER_WORST(status, s->model->set_states(s->capi, s->xStage, s->nx));
+		status = FMI_SOLVER_WORST(status, s->model->get_event_indicators(s->capi, zm, s->nz));
+		s->stats.eventIndicatorsNum++;
+		if(status >= FMI_SOLVER_ERROR) break;
+
+		crossed = fmi_import_find_zero_crossings(zl, zm, s->nz, 0.0, 0, 0) > 0;
+		if(crossed) {
+			tr = tm;
+			tmp = zr; zr = zm; zm = tmp;
+			/* Illinois: halve the retained end point when it is kept twice in a row */
+			if(side == 1) for(i = 0; i < s->nz; i++) zl[i] *= 0.5;
+			side = 1;
+		}
+		else {
+			tl = tm;
+			tmp = zl; zl = zm; zm = tmp;
+			if(side == -1) for(i = 0; i < s->nz; i++) zr[i] *= 0.5;
+			side = -1;
+		}
+	}
+	s->zPrev = zl;
+	s->z = zr;
+	s->zMid = zm;
+
+	*theta = tr;
+	if(status < FMI_SOLVER_ERROR) {
+		fmi_import_solver_interpolate(s, tr, s->xNew);
+		status = FMI_SOLVER_WORST(status, s->model->set_time(s->capi, t + tr * h));
+		status = FMI_SOLVER_WORST(status, s->model->set_states(s->capi, s->xNew, s->nx));
+	}
+	return status;
+}
+
+/* One accepted Dormand-Prince step towards tLimit. The FMU holds the end point on return. */
+static int fmi_import_solver_dopri5_step(fmi_import_solver_t* s, double tLimit, int* stateEvent) {
+	const size_t nx = s->nx;
+	const double t = s->time;
+	double h = s->hNext, tEnd, err, fac, hNew;
+	double *x = s->x, *xs = s->xStage, *xn = s->xNew, **k = s->k;
+	int status, limited = 0, rejected = 0;
+	size_t i, j, stage;
+
+	/* avoid a very short step right before the limit */
+	if(t + 1.01 * h >= tLimit) {
+		h = tLimit - t;
+		limited = 1;
+	}
+	status = fmi_import_solver_first_stage(s);
+	if(status >= FMI_SOLVER_ERROR) return status;
+
+	for(;;) {
+		tEnd = limited ? tLimit : t + h;
+		for(stage = 1; stage < FMI_SOLVER_STAGES; stage++) {
+			const double* a = dp_a[stage];
+			double* out = (stage == FMI_SOLVER_STAGES - 1) ? xn : xs;
+			for(i = 0; i < nx; i++) {
+				double sum = 0.0;
+				for(j = 0; j < stage; j++) sum += a[j] * k[j][i];
+				out[i] = x[i] + h * sum;
+			}
+			status = FMI_SOLVER_WORST(status, fmi_import_solver_stage(s,
+				(stage == FMI_SOLVER_STAGES - 1) ? tEnd : t + dp_c[stage] * h, out, k[stage]));
+			if(status >= FMI_SOLVER_ERROR) return status;
+		}
+
+		/* error relative to tolerance * (|x| + nominal) */
+		err = 0.0;
+		for(i = 0; i < nx; i++) {
+			double e = 0.0, sc, xmax = fabs(x[i]) > fabs(xn[i]) ? fabs(x[i]) : fabs(xn[i]);
+			for(j = 0; j < FMI_SOLVER_STAGES; j++) e += dp_e[j] * k[j][i];
+			sc = s->tolerance * (s->nominal[i] + xmax);
+			e = h * e / sc;
+			err += e * e;
+		}
+		err = nx ? sqrt(err / nx) : 0.0;
+		if(err <= 1.0) break;
+
+		s->stats.rejectedStepsNum++;
+		rejected = 1;
+		fac = 0.9 * pow(err, -0.2);
+		h *= (fac > 0.2) ? fac : 0.2;
+		limited = 0;
+		if(h < 1e-14 * (fabs(t) > 1.0 ? fabs(t) : 1.0)) {
+			jm_log_error(s->callbacks, module, "Step size too small at time %g", t);
+			return fmi2_status_error;
+		}
+	}
+
+	/* next step size; a step shortened by the limit does not reduce the proposal */
+	fac = (err > 0.0) ? 0.9 * pow(err, -0.2) : 5.0;
+	if(fac > 5.0) fac = 5.0;
+	if(fac < 0.2) fac = 0.2;
+	hNew = h * fac;
+	if(rejected && hNew > h) hNew = h;
+	s->hNext = (limited && !rejected && hNew < s->hNext) ? s->hNext : hNew;
+
+	/* dense output coefficients */
+	for(i = 0; i < nx; i++) {
+		double ydiff = xn[i] - x[i], bspl = h * k[0][i] - ydiff, d = 0.0;
+		for(j = 0; j < FMI_SOLVER_STAGES; j++) d += dp_d[j] * k[j][i];
+		s->dense[0][i] = ydiff;
+		s->dense[1][i] = bspl;
+		s->dense[2][i] = ydiff - h * k[FMI_SOLVER_STAGES - 1][i] - bspl;
+		s->dense[3][i] = h * d;
+	}
+
+	status = FMI_SOLVER_WORST(status, s->model->get_event_indicators(s->capi, s->z, s->nz));
+	s->stats.eventIndicatorsNum++;
+	if(status >= FMI_SOLVER_ERROR) return status;
+	*stateEvent = fmi_import_solver_find_crossing(s);
+	if(*stateEvent) {
+		double theta;
+		status = FMI_SOLVER_WORST(status, fmi_import_solver_locate_event(s, t, h, &theta));
+		if(status >= FMI_SOLVER_ERROR) return status;
+		tEnd = t + theta * h;
+		s->fsal = 0;
+	}
+	else {
+		/* first same as last: the derivatives at the end point start the next step */
+		double* tmp = k[0];
+		k[0] = k[FMI_SOLVER_STAGES - 1];
+		k[FMI_SOLVER_STAGES - 1] = tmp;
+		s->fsal = 1;
+	}
+	fmi_import_solver_swap_states(s);
+	s->time = tEnd;
+	return status;
+}
+
+int fmi_import_solver_integrate(fmi_import_solver_t* s, double endTime) {
+	int status = fmi2_status_ok;
+
+	if(!s->isInitialized) {
+		jm_log_error(s->callbacks, module, "The solver must be initialized before integration");
+		return fmi2_status_error;
+	}
+	while(s->time < endTime && !s->isTerminated) {
+		double tLimit = endTime;
+		int stateEvent = 0, timeEvent = 0, stepEvent = 0, terminate = 0;
+
+		if(s->event.nextEventTimeDefined && s->event.nextEventTime < tLimit) {
+			tLimit = s->event.nextEventTime;
+		}
+		if(tLimit > s->time) {
+			if(s->method == fmi_import_solver_dopri5) {
+				status = FMI_SOLVER_WORST(status, fmi_import_solver_dopri5_step(s, tLimit, &stateEvent));
+			}
+			else {
+				status = FMI_SOLVER_WORST(status, fmi_import_solver_fixed_step(s, tLimit, &stateEvent));
+			}
+			if(status >= FMI_SOLVER_ERROR) break;
+			status = FMI_SOLVER_WORST(status, s->model->completed_step(s->capi, &stepEvent, &terminate));
+			s->stats.stepsNum++;
+			if(status >= FMI_SOLVER_ERROR) break;
+			if(terminate) {
+				s->isTerminated = 1;
+				break;
+			}
+		}
+		timeEvent = s->event.nextEventTimeDefined && s->time >= s->event.nextEventTime;
+
+		if(stateEvent || timeEvent || stepEvent) {
+			double eventStart = jm_portability_get_time();
+			if(stateEvent) s->stats.stateEventsNum++;
+			if(timeEvent) s->stats.timeEventsNum++;
+			if(stepEvent) s->stats.stepEventsNum++;
+			status = FMI_SOLVER_WORST(status, fmi_import_solver_after_event(s,
+				s->model->event_update(s->capi, &s->event), 0));
+			fmi_trace_recorder_slice(stateEvent ? "state event" : (timeEvent ? "time event" : "step event"), "solver",
+				eventStart, jm_portability_get_time());
+			if(status >= FMI_SOLVER_ERROR) break;
+		}
+		else {
+			fmi_import_solver_advance_indicators(s);
+		}
+	}
+	if(status >= FMI_SOLVER_ERROR) {
+		jm_log_error(s->callbacks, module, "Integration failed at time %g", s->time);
+	}
+	return status;
+}
+
+double fmi_import_solver_get_time(fmi_import_solver_t* s) {
+	return s->time;
+}
+
+const double* fmi_import_solver_get_states(fmi_import_solver_t* s) {
+	return s->x;
+}
+
+int fmi_import_solver_is_terminated(fmi_import_solver_t* s) {
+	return s->isTerminated;
+}
+
+void fmi_import_solver_get_stats(fmi_import_solver_t* s, fmi_import_solver_stats_t* stats) {
+	*stats = s->stats;
+}
@@ -0,0 +1,466 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <JM/jm_vector.h>
+#include <FMI/fmi_import_system_graph.h>
+#include <FMI1/fmi1_import.h>
+#include <FMI2/fmi2_import.h>
+
+static const char* module = "FMILIB";
+
+#define FMI_GRAPH_NONE ((size_t)-1)
+
+typedef struct fmi_import_system_graph_fmu_t {
+	fmi_version_enu_t version;
+	void* fmu;          /* fmi1_import_t* or fmi2_import_t* */
+	size_t nVars;
+	size_t* portOfVar;  /* nVars, FMI_GRAPH_NONE for variables that are not inputs or outputs */
+} fmi_import_system_graph_fmu_t;
+
+struct fmi_import_system_graph_t {
+	jm_callbacks* callbacks;
+
+	jm_vector(jm_voidp) fmus;
+
+	/* ports */
+	jm_vector(size_t) portFmu;
+	jm_vector(size_t) portVar;
+	jm_vector(char) portIsOutput;
+	jm_vector(size_t) portSource;
+
+	/* edges, data flows from edgeFrom to edgeTo */
+	jm_vector(size_t) edgeFrom;
+	jm_vector(size_t) edgeTo;
+
+	/* analysis result */
+	int isAnalyzed;
+	jm_vector(size_t) blockStart;
+	jm_vector(size_t) blockPorts;
+	jm_vector(size_t) loops;
+};
+
+fmi_import_system_graph_t* fmi_import_allocate_system_graph(jm_callbacks* cb) {
+	fmi_import_system_graph_t* g;
+	if(!cb) cb = jm_get_default_callbacks();
+	g = (fmi_import_system_graph_t*)cb->calloc(1, sizeof(fmi_import_system_graph_t));
+	if(!g) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	g->callbacks = cb;
+	jm_vector_init(jm_voidp)(&g->fmus, 0, cb);
+	jm_vector_init(size_t)(&g->portFmu, 0, cb);
+	jm_vector_init(size_t)(&g->portVar, 0, cb);
+	jm_vector_init(char)(&g->portIsOutput, 0, cb);
+	jm_vector_init(size_t)(&g->portSource, 0, cb);
+	jm_vector_init(size_t)(&g->edgeFrom, 0, cb);
+	jm_vector_init(size_t)(&g->edgeTo, 0, cb);
+	jm_vector_init(size_t)(&g->blockStart, 0, cb);
+	jm_vector_init(size_t)(&g->blockPorts, 0, cb);
+	jm_vector_init(size_t)(&g->loops, 0, cb);
+	return g;
+}
+
+void fmi_import_free_system_graph(fmi_import_system_graph_t* g) {
+	jm_callbacks* cb;
+	size_t i;
+	if(!g) return;
+	cb = g->callbacks;
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(&g->fmus); i++) {
+		fmi_import_system_graph_fmu_t* f = (fmi_import_system_graph_fmu_t*)jm_vector_get_item(jm_voidp)(&g->fmus, i);
+		cb->free(f->portOfVar);
+		cb->free(f);
+	}
+	jm_vector_free_data(jm_voidp)(&g->fmus);
+	jm_vector_free_data(size_t)(&g->portFmu);
+	jm_vector_free_data(size_t)(&g->portVar);
+	jm_vector_free_data(char)(&g->portIsOutput);
+	jm_vector_free_data(size_t)(&g->portSource);
+	jm_vector_free_data(size_t)(&g->edgeFrom);
+	jm_vector_free_data(size_t)(&g->edgeTo);
+	jm_vector_free_data(size_t)(&g->blockStart);
+	jm_vector_free_data(size_t)(&g->blockPorts);
+	jm_vector_free_data(size_t)(&g->loops);
+	cb->free(g);
+}
+
+static fmi_import_system_graph_fmu_t* fmi_import_system_graph_new_fmu(fmi_import_system_graph_t* g, fmi_version_enu_t version, void* fmu, size_t nVars) {
+	jm_callbacks* cb = g->callbacks;
+	fmi_import_system_graph_fmu_t* f = (fmi_import_system_graph_fmu_t*)cb->calloc(1, sizeof(fmi_import_system_graph_fmu_t));
+	size_t i;
+	if(f) f->portOfVar = (size_t*)cb->calloc(nVars ? nVars : 1, sizeof(size_t));
+	if(!f || !f->portOfVar || !jm_vector_push_back(jm_voidp)(&g->fmus, f)) {
+		if(f) cb->free(f->portOfVar);
+		cb->free(f);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	f->version = version;
+	f->fmu = fmu;
+	f->nVars = nVars;
+	for(i = 0; i < nVars; i++) f->portOfVar[i] = FMI_GRAPH_NONE;
+	g->isAnalyzed = 0;
+	return f;
+}
+
+static jm_status_enu_t fmi_import_system_graph_add_port(fmi_import_system_graph_t* g, fmi_import_system_graph_fmu_t* f, size_t var, int isOutput) {
+	size_t fmuIndex = jm_vector_get_size(jm_voidp)(&g->fmus) - 1;
+	f->portOfVar[var] = jm_vector_get_size(size_t)(&g->portFmu);
+	if(!jm_vector_push_back(size_t)(&g->portFmu, fmuIndex) ||
+	   !jm_vector_push_back(size_t)(&g->portVar, var) ||
+	   !jm_vector_push_back(char)(&g->portIsOutput, (char)(isOutput != 0)) ||
+	   !jm_vector_push_back(size_t)(&g->portSource, FMI_GRAPH_NONE)) {
+		jm_log_fatal(g->callbacks, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+static jm_status_enu_t fmi_import_system_graph_add_edge(fmi_import_system_graph_t* g, size_t from, size_t to) {
+	if(!jm_vector_push_back(size_t)(&g->edgeFrom, from) || !jm_vector_push_back(size_t)(&g->edgeTo, to)) {
+		jm_log_fatal(g->callbacks, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	g->isAnalyzed = 0;
+	return jm_status_success;
+}
+
+/* Feedthrough edge from an input port to an output port of the same FMU, unless the dependency is not an input */
+static jm_status_enu_t fmi_import_system_graph_add_feedthrough(fmi_import_system_graph_t* g, fmi_import_system_graph_fmu_t* f, size_t inputVar, size_t outputPort) {
+	size_t port;
+	if(inputVar >= f->nVars) return jm_status_success;
+	port = f->portOfVar[inputVar];
+	if(port == FMI_GRAPH_NONE || jm_vector_get_item(char)(&g->portIsOutput, port)) return jm_status_success;
+	return fmi_import_system_graph_add_edge(g, port, outputPort);
+}
+
+/* Edges from all inputs of the last added FMU to an output */
+static jm_status_enu_t fmi_import_system_graph_add_dense_feedthrough(fmi_import_system_graph_t* g, size_t firstPort, size_t outputPort) {
+	size_t p, n = jm_vector_get_size(size_t)(&g->portFmu);
+	for(p = firstPort; p < n; p++) {
+		if(!jm_vector_get_item(char)(&g->portIsOutput, p)) {
+			if(fmi_import_system_graph_add_edge(g, p, outputPort) != jm_status_success) return jm_status_error;
+		}
+	}
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi1_import_add_to_system_graph(fmi_import_system_graph_t* g, fmi1_import_t* fmu, size_t* fmuIndex) {
+	fmi1_import_variable_list_t* vars = fmi1_import_get_variable_list(fmu);
+	fmi_import_system_graph_fmu_t* f;
+	size_t firstPort = jm_vector_get_size(size_t)(&g->portFmu);
+	size_t nVars, i, k;
+	jm_status_enu_t status = jm_status_success;
+
+	if(!vars) return jm_status_error;
+	nVars = fmi1_import_get_variable_list_size(vars);
+	f = fmi_import_system_graph_new_fmu(g, fmi_version_1_enu, fmu, nVars);
+	if(!f) {
+		fmi1_import_free_variable_list(vars);
+		return jm_status_error;
+	}
+	*fmuIndex = jm_vector_get_size(jm_voidp)(&g->fmus) - 1;
+
+	for(i = 0; i < nVars && status == jm_status_success; i++) {
+		fmi1_causality_enu_t causality = fmi1_import_get_causality(fmi1_import_get_variable(vars, (unsigned int)i));
+		if(causality == fmi1_causality_enu_input || causality == fmi1_causality_enu_output)
+			status = fmi_import_system_graph_add_port(g, f, i, causality == fmi1_causality_enu_output);
+	}
+
+	for(i = 0; i < nVars && status == jm_status_success; i++) {
+		fmi1_import_variable_t* v = fmi1_import_get_variable(vars, (unsigned int)i);
+		fmi1_import_variable_list_t* deps;
+		if(fmi1_import_get_causality(v) != fmi1_causality_enu_output) continue;
+		deps = fmi1_import_get_direct_dependency(fmu, v);
+		if(!deps) {
+			status = fmi_import_system_graph_add_dense_feedthrough(g, firstPort, f->portOfVar[i]);
+			continue;
+		}
+		for(k = 0; k < fmi1_import_get_variable_list_size(deps) && status == jm_status_success; k++) {
+			size_t var = fmi1_import_get_variable_original_order(fmi1_import_get_variable(deps, (unsigned int)k));
+			status = fmi_import_system_graph_add_feedthrough(g, f, var, f->portOfVar[i]);
+		}
+		fmi1_import_free_variable_list(deps);
+	}
+	fmi1_import_free_variable_list(vars);
+	return status;
+}
+
+jm_status_enu_t fmi2_import_add_to_system_graph(fmi_import_system_graph_t* g, fmi2_import_t* fmu, size_t* fmuIndex) {
+	fmi2_import_variable_list_t* vars = fmi2_import_get_variable_list(fmu, 0);
+	fmi2_import_variable_list_t* outputs = fmi2_import_get_outputs_list(fmu);
+	fmi_import_system_graph_fmu_t* f = 0;
+	size_t firstPort = jm_vector_get_size(size_t)(&g->portFmu);
+	size_t *startIndex, *dependency;
+	char* factorKind;
+	size_t nVars = 0, i, k;
+	jm_status_enu_t status = jm_status_error;
+
+	if(!vars || !outputs) goto cleanup;
+	nVars = fmi2_import_get_variable_list_size(vars);
+	f = fmi_import_system_graph_new_fmu(g, fmi_version_2_0_enu, fmu, nVars);
+	if(!f) goto cleanup;
+	*fmuIndex = jm_vector_get_size(jm_voidp)(&g->fmus) - 1;
+
+	status = jm_status_success;
+	for(i = 0; i < nVars && status == jm_status_success; i++) {
+		fmi2_causality_enu_t causality = fmi2_import_get_causality(fmi2_import_get_variable(vars, i));
+		if(causality == fmi2_causality_enu_input || causality == fmi2_causality_enu_output)
+			status = fmi_import_system_graph_add_port(g, f, i, causality == fmi2_causality_enu_output);
+	}
+
+	fmi2_import_get_outputs_dependencies(fmu, &startIndex, &dependency, &factorKind);
+	for(i = 0; i < fmi2_import_get_variable_list_size(outputs) && status == jm_status_success; i++) {
+		size_t var = fmi2_import_get_variable_original_order(fmi2_import_get_variable(outputs, i));
+		size_t port = f->portOfVar[var];
+		int dense = (startIndex == 0);
+		if(port == FMI_GRAPH_NONE) continue;
+		if(!dense) {
+			for(k = startIndex[i]; k < startIndex[i + 1]; k++) {
+				if(dependency[k] == 0) {
+					dense = 1;
+					break;
+				}
+			}
+		}
+		if(dense) {
+			status = fmi_import_system_graph_add_dense_feedthrough(g, firstPort, port);
+		}
+		else {
+			for(k = startIndex[i]; k < startIndex[i + 1] && status == jm_status_success; k++) {
+				status = fmi_import_system_graph_add_feedthrough(g, f, dependency[k] - 1, port);
+			}
+		}
+	}
+
+cleanup:
+	fmi2_import_free_variable_list(vars);
+	fmi2_import_free_variable_list(outputs);
+	return status;
+}
+
+static fmi_import_system_graph_fmu_t* fmi_import_system_graph_get_fmu(fmi_import_system_graph_t* g, size_t fmuIndex) {
+	if(fmuIndex >= jm_vector_get_size(jm_voidp)(&g->fmus)) {
+		jm_log_error(g->callbacks, module, "FMU index %u is out of range", (unsigned)fmuIndex);
+		return 0;
+	}
+	return (fmi_import_system_graph_fmu_t*)jm_vector_get_item(jm_voidp)(&g->fmus, fmuIndex);
+}
+
+static size_t fmi_import_system_graph_find_var(fmi_import_system_graph_t* g, fmi_import_system_graph_fmu_t* f, const char* name) {
+	if(f->version == fmi_version_1_enu) {
+		fmi1_import_variable_t* v = fmi1_import_get_variable_by_name((fmi1_import_t*)f->fmu, name);
+		if(v) return fmi1_import_get_variable_original_order(v);
+	}
+	else {
+		fmi2_import_variable_t* v = fmi2_import_get_variable_by_name((fmi2_import_t*)f->fmu, name);
+		if(v) return fmi2_import_get_variable_original_order(v);
+	}
+	jm_log_error(g->callbacks, module, "Variable '%s' not found", name);
+	return FMI_GRAPH_NONE;
+}
+
+jm_status_enu_t fmi_import_system_graph_connect(fmi_import_system_graph_t* g, size_t srcFmu, const char* output, size_t dstFmu, const char* input) {
+	fmi_import_system_graph_fmu_t* src = fmi_import_system_graph_get_fmu(g, srcFmu);
+	fmi_import_system_graph_fmu_t* dst = fmi_import_system_graph_get_fmu(g, dstFmu);
+	size_t outVar, inVar;
+	if(!src || !dst) return jm_status_error;
+	outVar = fmi_import_system_graph_find_var(g, src, output);
+	inVar = fmi_import_system_graph_find_var(g, dst, input);
+	if(outVar == FMI_GRAPH_NONE || inVar == FMI_GRAPH_NONE) return jm_status_error;
+	return fmi_import_system_graph_connect_by_index(g, srcFmu, outVar, dstFmu, inVar);
+}
+
+jm_status_enu_t fmi_import_system_graph_connect_by_index(fmi_import_system_graph_t* g, size_t srcFmu, size_t output, size_t dstFmu, size_t input) {
+	fmi_import_system_graph_fmu_t* src = fmi_import_system_graph_get_fmu(g, srcFmu);
+	fmi_import_system_graph_fmu_t* dst = fmi_import_system_graph_get_fmu(g, dstFmu);
+	size_t outPort, inPort;
+	size_t* source;
+	if(!src || !dst) return jm_status_error;
+
+	outPort = (output < src->nVars) ? src->portOfVar[output] : FMI_GRAPH_NONE;
+	inPort = (input < dst->nVars) ? dst->portOfVar[input] : FMI_GRAPH_NONE;
+	if(outPort == FMI_GRAPH_NONE || !jm_vector_get_item(char)(&g->portIsOutput, outPort)) {
+		jm_log_error(g->callbacks, module, "Variable %u of FMU %u is not an output", (unsigned)output, (unsigned)srcFmu);
+		return jm_status_error;
+	}
+	if(inPort == FMI_GRAPH_NONE || jm_vector_get_item(char)(&g->portIsOutput, inPort)) {
+		jm_log_error(g->callbacks, module, "Variable %u of FMU %u is not an input", (unsigned)input, (unsigned)dstFmu);
+		return jm_status_error;
+	}
+	source = jm_vector_get_itemp(size_t)(&g->portSource, inPort);
+	if(*source != FMI_GRAPH_NONE) {
+		jm_log_error(g->callbacks, module, "Input %u of FMU %u is already connected", (unsigned)input, (unsigned)dstFmu);
+		return jm_status_error;
+	}
+	*source = outPort;
+	return fmi_import_system_graph_add_edge(g, outPort, inPort);
+}
+
+jm_status_enu_t fmi_import_system_graph_analyze(fmi_import_system_graph_t* g) {
+	jm_callbacks* cb = g->callbacks;
+	size_t nPorts = jm_vector_get_size(size_t)(&g->portFmu);
+	size_t nEdges = jm_vector_get_size(size_t)(&g->edgeFrom);
+	size_t *adjStart = 0, *adj = 0, *index = 0, *low = 0, *iter = 0, *stack = 0, *callStack = 0, *scc = 0, *sccStart = 0;
+	char* onStack = 0;
+	size_t counter = 0, stackSize = 0, nScc = 0, nSccPorts = 0;
+	size_t i, s;
+	jm_status_enu_t status = jm_status_error;
+
+	g->isAnalyzed = 0;
+	jm_vector_resize(size_t)(&g->blockStart, 0);
+	jm_vector_resize(size_t)(&g->blockPorts, 0);
+	jm_vector_resize(size_t)(&g->loops, 0);
+
+	adjStart = (size_t*)cb->calloc(nPorts + 1, sizeof(size_t));
+	adj = (size_t*)cb->calloc(nEdges ? nEdges : 1, sizeof(size_t));
+	index = (size_t*)cb->calloc(nPorts + 1, sizeof(size_t));
+	low = (size_t*)cb->calloc(nPorts + 1, sizeof(size_t));
+	iter = (size_t*)cb->calloc(nPorts + 1, sizeof(size_t));
+	stack = (size_t*)cb->calloc(nPorts + 1, sizeof(size_t));
+	callStack = (size_t*)cb->calloc(nPorts + 1, sizeof(size_t));
+	scc = (size_t*)cb->calloc(nPorts + 1, sizeof(size_t));
+	sccStart = (size_t*)cb->calloc(nPorts + 1, sizeof(size_t));
+	onStack = (char*)cb->calloc(nPorts + 1, sizeof(char));
+	if(!adjStart || !adj || !index || !low || !iter || !stack || !callStack || !scc || !sccStart || !onStack) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		goto cleanup;
+	}
+
+	/* adjacency in compressed format, counting sort on the source port */
+	for(i = 0; i < nEdges; i++) adjStart[jm_vector_get_item(size_t)(&g->edgeFrom, i) + 1]++;
+	for(i = 0; i < nPorts; i++) {
+		adjStart[i + 1] += adjStart[i];
+		iter[i] = adjStart[i];
+	}
+	for(i = 0; i < nEdges; i++) adj[iter[jm_vector_get_item(size_t)(&g->edgeFrom, i)]++] = jm_vector_get_item(size_t)(&g->edgeTo, i);
+
+	/* iterative Tarjan; components are found in reverse topological order */
+	for(i = 0; i < nPorts; i++) {
+		index[i] = FMI_GRAPH_NONE;
+		iter[i] = adjStart[i];
+	}
+	sccStart[0] = 0;
+	for(s = 0; s < nPorts; s++) {
+		size_t callSize = 0;
+		if(index[s] != FMI_GRAPH_NONE) continue;
+
+		index[s] = low[s] = counter++;
+		stack[stackSize++] = s;
+		onStack[s] = 1;
+		callStack[callSize++] = s;
+
+		while(callSize) {
+			size_t v = callStack[callSize - 1];
+			if(iter[v] < adjStart[v + 1]) {
+				size_t w = adj[iter[v]++];
+				if(index[w] == FMI_GRAPH_NONE) {
+					index[w] = low[w] = counter++;
+					stack[stackSize++] = w;
+					onStack[w] = 1;
+					callStack[callSize++] = w;
+				}
+				else if(onStack[w] && index[w] < low[v]) {
+					low[v] = index[w];
+				}
+				continue;
+			}
+			callSize--;
+			if(low[v] == index[v]) {
+				size_t w;
+				do {
+					w = stack[--stackSize];
+					onStack[w] = 0;
+					scc[nSccPorts++] = w;
+				} while(w != v);
+				sccStart[++nScc] = nSccPorts;
+			}
+			if(callSize) {
+				size_t u = callStack[callSize - 1];
+				if(low[v] < low[u]) low[u] = low[v];
+			}
+		}
+	}
+
+	/* evaluation order is the reverse of the order the components were found in */
+	if((jm_vector_reserve(size_t)(&g->blockStart, nScc + 1) < nScc + 1) ||
+	   (jm_vector_reserve(size_t)(&g->blockPorts, nPorts) < nPorts)) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		goto cleanup;
+	}
+	jm_vector_push_back(size_t)(&g->blockStart, 0);
+	for(i = nScc; i > 0; i--) {
+		size_t first = sccStart[i - 1], last = sccStart[i], k;
+		for(k = first; k < last; k++) jm_vector_push_back(size_t)(&g->blockPorts, scc[k]);
+		jm_vector_push_back(size_t)(&g->blockStart, jm_vector_get_size(size_t)(&g->blockPorts));
+		if(last - first > 1) {
+			if(!jm_vector_push_back(size_t)(&g->loops, nScc - i)) goto cleanup;
+		}
+	}
+	g->isAnalyzed = 1;
+	status = jm_status_success;
+	jm_log_verbose(cb, module, "System graph with %u ports and %u edges has %u blocks and %u algebraic loops",
+	               (unsigned)nPorts, (unsigned)nEdges, (unsigned)nScc, (unsigned)jm_vector_get_size(size_t)(&g->loops));
+
+cleanup:
+	cb->free(adjStart);
+	cb->free(adj);
+	cb->free(index);
+	cb->free(low);
+	cb->free(iter);
+	cb->free(stack);
+	cb->free(callStack);
+	cb->free(scc);
+	cb->free(sccStart);
+	cb->free(onStack);
+	return status;
+}
+
+size_t fmi_import_system_graph_get_ports_num(fmi_import_system_graph_t* g) {
+	return jm_vector_get_size(size_t)(&g->portFmu);
+}
+
+void fmi_import_system_graph_get_port(fmi_import_system_graph_t* g, size_t port, size_t* fmuIndex, size_t* varIndex, int* isOutput) {
+	*fmuIndex = jm_vector_get_item(size_t)(&g->portFmu, port);
+	*varIndex = jm_vector_get_item(size_t)(&g->portVar, port);
+	*isOutput = jm_vector_get_item(char)(&g->portIsOutput, port);
+}
+
+size_t fmi_import_system_graph_get_blocks_num(fmi_import_system_graph_t* g) {
+	if(!g->isAnalyzed) return 0;
+	return jm_vector_get_size(size_t)(&g->blockStart) - 1;
+}
+
+void fmi_import_system_graph_get_blocks(fmi_import_system_graph_t* g, const size_t** blockStart, const size_t** ports) {
+	if(!g->isAnalyzed) {
+		*blockStart = 0;
+		*ports = 0;
+		return;
+	}
+	*blockStart = jm_vector_get_itemp(size_t)(&g->blockStart, 0);
+	*ports = jm_vector_get_size(size_t)(&g->blockPorts) ? jm_vector_get_itemp(size_t)(&g->blockPorts, 0) : 0;
+}
+
+size_t fmi_import_system_graph_get_loops_num(fmi_import_system_graph_t* g) {
+	if(!g->isAnalyzed) return 0;
+	return jm_vector_get_size(size_t)(&g->loops);
+}
+
+const size_t* fmi_import_system_graph_get_loops(fmi_import_system_graph_t* g) {
+	if(!g->isAnalyzed || !jm_vector_get_size(size_t)(&g->loops)) return 0;
+	return jm_vector_get_itemp(size_t)(&g->loops, 0);
+}
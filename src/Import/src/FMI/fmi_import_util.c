@@ -21,6 +21,7 @@
 #include <fmilib_config.h>
 #include <JM/jm_portability.h>
 #include <FMI/fmi_import_util.h>
+#include <FMI/fmi_capi_registry.h>
 
 char* fmi_import_mk_temp_dir(jm_callbacks* cb, const char* systemTempDir, const char* tempPrefix) {
 	if(!tempPrefix) tempPrefix = "fmil";
@@ -75,3 +76,19 @@ char* fmi_import_get_model_description_path(const char* fmu_unzipped_path, jm_ca
 
 	return model_description_path;
 }
+
+void fmi_import_set_binary_cache_size(size_t maxUnused) {
+	fmi_capi_registry_set_max_unused(maxUnused);
+}
+
+size_t fmi_import_get_binary_cache_size(void) {
+	return fmi_capi_registry_get_max_unused();
+}
+
+size_t fmi_import_evict_unused_binaries(void) {
+	return fmi_capi_registry_evict_unused();
+}
+
+size_t fmi_import_get_loaded_binaries_num(void) {
+	return fmi_capi_registry_get_entries_num();
+}
@@ -0,0 +1,167 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include "fmi_import_zero_crossing_impl.h"
+
+/* SSE2 is part of every x86-64 processor; on 32-bit x86 it depends on the target of the compiler */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FMI_ZERO_CROSSING_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(FMILIB_HAVE_AVX2) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+size_t fmi_import_zero_crossings_scalar_range(const double* zPrev, const double* z, size_t first, size_t n, double epsilon,
+											  size_t* indices, double* fraction) {
+	double fmin = *fraction;
+	size_t i, count = 0;
+	for(i = first; i < n; i++) {
+		double a = zPrev[i], b = z[i];
+		if((a > 0) ? (b <= -epsilon) : (b > epsilon)) {
+			double f = a / (a - b);
+			if(f < fmin) fmin = f;
+			if(indices) indices[count] = i;
+			count++;
+		}
+	}
+	*fraction = fmin;
+	return count;
+}
+
+static size_t fmi_import_zero_crossings_scalar(const double* zPrev, const double* z, size_t n, double epsilon,
+											   size_t* indices, double* fraction) {
+	*fraction = 1.0;
+	return fmi_import_zero_crossings_scalar_range(zPrev, z, 0, n, epsilon, indices, fraction);
+}
+
+#ifdef FMI_ZERO_CROSSING_SSE2
+static size_t fmi_import_zero_crossings_sse2(const double* zPrev, const double* z, size_t n, double epsilon,
+											 size_t* indices, double* fraction) {
+	const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0);
+	const __m128d eps = _mm_set1_pd(epsilon), negEps = _mm_set1_pd(-epsilon);
+	__m128d fmin = one;
+	double f[2];
+	size_t i, count = 0;
+
+	for(i = 0; i + 2 <= n; i += 2) {
+		__m128d a = _mm_loadu_pd(zPrev + i), b = _mm_loadu_pd(z + i);
+		__m128d positive = _mm_cmpgt_pd(a, zero);
+		__m128d cross = _mm_or_pd(_mm_and_pd(positive, _mm_cmple_pd(b, negEps)),
+								  _mm_andnot_pd(positive, _mm_cmpgt_pd(b, eps)));
+		int mask = _mm_movemask_pd(cross);
+		if(mask) {
+			/* lanes that did not cross may divide by zero; they are replaced by one */
+			__m128d frac = _mm_div_pd(a, _mm_sub_pd(a, b));
+			fmin = _mm_min_pd(fmin, _mm_or_pd(_mm_and_pd(cross, frac), _mm_andnot_pd(cross, one)));
+			if(indices) {
+				if(mask & 1) indices[count++] = i;
+				if(mask & 2) indices[count++] = i + 1;
+			}
+			else {
+				count += (mask & 1) + (mask >> 1);
+			}
+		}
+	}
+	_mm_storeu_pd(f, fmin);
+	*fraction = (f[0] < f[1]) ? f[0] : f[1];
+	return count + fmi_import_zero_crossings_scalar_range(zPrev, z, i, n, epsilon, indices ? indices + count : 0, fraction);
+}
+#endif
+
+#ifdef FMILIB_HAVE_AVX2
+static int fmi_import_cpu_has_avx2(void) {
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7) return 0;
+	__cpuid(info, 1);
+	/* OSXSAVE and AVX, and the operating system saves the YMM registers */
+	if((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return 0;
+	if((_xgetbv(0) & 6) != 6) return 0;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return 0;
+#endif
+}
+#endif
+
+/* Selected kernel. Selection is idempotent, so concurrent first calls at worst select twice. */
+static fmi_import_zero_crossing_kernel_enu_t fmi_import_zero_crossing_kernel = fmi_import_zero_crossing_scalar;
+static fmi_import_zero_crossing_fn_t fmi_import_zero_crossing_fn = 0;
+
+static fmi_import_zero_crossing_fn_t fmi_import_zero_crossing_get_fn(fmi_import_zero_crossing_kernel_enu_t kernel) {
+	switch(kernel) {
+#ifdef FMILIB_HAVE_AVX2
+	case fmi_import_zero_crossing_avx2:
+		return fmi_import_cpu_has_avx2() ? fmi_import_zero_crossings_avx2 : 0;
+#endif
+#ifdef FMI_ZERO_CROSSING_SSE2
+	case fmi_import_zero_crossing_sse2:
+		return fmi_import_zero_crossings_sse2;
+#endif
+	case fmi_import_zero_crossing_scalar:
+		return fmi_import_zero_crossings_scalar;
+	default:
+		return 0;
+	}
+}
+
+static void fmi_import_zero_crossing_select(void) {
+	int k;
+	for(k = fmi_import_zero_crossing_avx2; k >= fmi_import_zero_crossing_scalar; k--) {
+		fmi_import_zero_crossing_fn_t fn = fmi_import_zero_crossing_get_fn((fmi_import_zero_crossing_kernel_enu_t)k);
+		if(fn) {
+			fmi_import_zero_crossing_kernel = (fmi_import_zero_crossing_kernel_enu_t)k;
+			fmi_import_zero_crossing_fn = fn;
+			return;
+		}
+	}
+}
+
+size_t fmi_import_find_zero_crossings(const double zPrev[], const double z[], size_t n, double epsilon,
+									  size_t indices[], double* fraction) {
+	double f;
+	if(!fmi_import_zero_crossing_fn) fmi_import_zero_crossing_select();
+	return fmi_import_zero_crossing_fn(zPrev, z, n, epsilon, indices, fraction ? fraction : &f);
+}
+
+fmi_import_zero_crossing_kernel_enu_t fmi_import_get_zero_crossing_kernel(void) {
+	if(!fmi_import_zero_crossing_fn) fmi_import_zero_crossing_select();
+	return fmi_import_zero_crossing_kernel;
+}
+
+jm_status_enu_t fmi_import_set_zero_crossing_kernel(fmi_import_zero_crossing_kernel_enu_t kernel) {
+	fmi_import_zero_crossing_fn_t fn = fmi_import_zero_crossing_get_fn(kernel);
+	if(!fn) return jm_status_error;
+	fmi_import_zero_crossing_kernel = kernel;
+	fmi_import_zero_crossing_fn = fn;
+	return jm_status_success;
+}
+
+const char* fmi_import_zero_crossing_kernel_to_string(fmi_import_zero_crossing_kernel_enu_t kernel) {
+	switch(kernel) {
+	case fmi_import_zero_crossing_scalar: return "scalar";
+	case fmi_import_zero_crossing_sse2: return "SSE2";
+	case fmi_import_zero_crossing_avx2: return "AVX2";
+	default: return "unknown";
+	}
+}
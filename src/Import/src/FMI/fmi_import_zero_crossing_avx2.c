@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/* This file is compiled with AVX2 code generation and is only built when the compiler supports it */
+
+#include <immintrin.h>
+
+#include "fmi_import_zero_crossing_impl.h"
+
+size_t fmi_import_zero_crossings_avx2(const double* zPrev, const double* z, size_t n, double epsilon,
+									  size_t* indices, double* fraction) {
+	const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+	const __m256d eps = _mm256_set1_pd(epsilon), negEps = _mm256_set1_pd(-epsilon);
+	__m256d fmin = one;
+	double f[4];
+	size_t i, count = 0;
+	int k;
+
+	for(i = 0; i + 4 <= n; i += 4) {
+		__m256d a = _mm256_loadu_pd(zPrev + i), b = _mm256_loadu_pd(z + i);
+		__m256d positive = _mm256_cmp_pd(a, zero, _CMP_GT_OQ);
+		__m256d cross = _mm256_or_pd(_mm256_and_pd(positive, _mm256_cmp_pd(b, negEps, _CMP_LE_OQ)),
+									 _mm256_andnot_pd(positive, _mm256_cmp_pd(b, eps, _CMP_GT_OQ)));
+		int mask = _mm256_movemask_pd(cross);
+		if(mask) {
+			/* lanes that did not cross may divide by zero; they are replaced by one */
+			__m256d frac = _mm256_div_pd(a, _mm256_sub_pd(a, b));
+			fmin = _mm256_min_pd(fmin, _mm256_blendv_pd(one, frac, cross));
+			for(k = 0; k < 4; k++) {
+				if(mask & (1 << k)) {
+					if(indices) indices[count] = i + k;
+					count++;
+				}
+			}
+		}
+	}
+	_mm256_storeu_pd(f, fmin);
+	*fraction = f[0];
+	for(k = 1; k < 4; k++) {
+		if(f[k] < *fraction) *fraction = f[k];
+	}
+	return count + fmi_import_zero_crossings_scalar_range(zPrev, z, i, n, epsilon, indices ? indices + count : 0, fraction);
+}
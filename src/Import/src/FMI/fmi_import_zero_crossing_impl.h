@@ -0,0 +1,45 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef FMI_IMPORT_ZERO_CROSSING_IMPL_H_
+#define FMI_IMPORT_ZERO_CROSSING_IMPL_H_
+
+#include <FMI/fmi_import_zero_crossing.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A kernel scans all n indicators, writes the crossing indices (if indices is not NULL) and
+   sets *fraction to the earliest crossing fraction or one. Returns the number of crossings. */
+typedef size_t (*fmi_import_zero_crossing_fn_t)(const double* zPrev, const double* z, size_t n, double epsilon,
+												size_t* indices, double* fraction);
+
+/* Scalar scan of the indicators [first, n), used for the tails of the vector kernels.
+   Indices are written from indices[0]; *fraction is lowered to the earliest crossing. */
+size_t fmi_import_zero_crossings_scalar_range(const double* zPrev, const double* z, size_t first, size_t n, double epsilon,
+											  size_t* indices, double* fraction);
+
+#ifdef FMILIB_HAVE_AVX2
+/* Compiled separately with AVX2 code generation; only called if the processor supports it */
+size_t fmi_import_zero_crossings_avx2(const double* zPrev, const double* z, size_t n, double epsilon,
+									  size_t* indices, double* fraction);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMI_IMPORT_ZERO_CROSSING_IMPL_H_ */
@@ -19,6 +19,7 @@ extern "C" {
 
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 #include <FMI1/fmi1_types.h>
 #include <FMI1/fmi1_functions.h>
 #include <FMI1/fmi1_enums.h>
@@ -31,7 +32,7 @@ static const char * module = "FMILIB";
 /* Load and destroy functions */
 jm_status_enu_t fmi1_import_create_dllfmu(fmi1_import_t* fmu, fmi1_callback_functions_t callBackFunctions, int registerGlobally) {
 
-	char curDir[FILENAME_MAX + 2];
+	char absDllDirPath[FILENAME_MAX + 2];
 	char* dllDirPath = 0;
 	char* dllFileName = 0;
 	const char* modelIdentifier;
@@ -54,11 +55,6 @@ jm_status_enu_t fmi1_import_create_dllfmu(fmi1_import_t* fmu, fmi1_callback_func
 		return jm_status_error;
 	}
 
-	if( jm_portability_get_current_working_directory(curDir, FILENAME_MAX+1) != jm_status_success) {
-		jm_log_warning(fmu->callbacks, module, "Could not get current working directory (%s)", strerror(errno));
-		curDir[0] = 0;
-	};
-
 	dllDirPath = fmi_construct_dll_dir_name(fmu->callbacks, fmu->dirPath);
 	dllFileName = fmi_construct_dll_file_name(fmu->callbacks, dllDirPath, modelIdentifier);
 
@@ -67,16 +63,29 @@ jm_status_enu_t fmi1_import_create_dllfmu(fmi1_import_t* fmu, fmi1_callback_func
 		return jm_status_error;
 	}
 
-	if(jm_portability_set_current_working_directory(dllDirPath) != jm_status_success) {
-		jm_log_fatal(fmu->callbacks, module, "Could not change to the DLL directory %s", dllDirPath);
+	/* The binary is loaded by its path. The working directory is not changed since it is shared by all threads. */
+	if(!jm_get_dir_abspath(fmu->callbacks, dllDirPath, absDllDirPath, FILENAME_MAX + 2)) {
+		jm_log_fatal(fmu->callbacks, module, "Could not access the DLL directory %s", dllDirPath);
 		if(ENOENT == errno)
 			jm_log_fatal(fmu->callbacks, module, "The FMU contains no binary for this platform.");
 		else
 			jm_log_fatal(fmu->callbacks, module, "System error: %s", strerror(errno));
 	}
 	else {
+		/* Load the binary by its absolute path, so that the loader searches its directory for the
+		   libraries it depends on (LOAD_WITH_ALTERED_SEARCH_PATH on Windows needs an absolute path)
+		   and the path stays valid if the application changes the working directory. */
+		size_t n = strlen(absDllDirPath);
+		if(n + 1 < sizeof(absDllDirPath) && n && absDllDirPath[n - 1] != FMI_FILE_SEP[0]) {
+			strcat(absDllDirPath, FMI_FILE_SEP);
+		}
+		fmu->callbacks->free(dllFileName);
+		dllFileName = fmi_construct_dll_file_name(fmu->callbacks, absDllDirPath, modelIdentifier);
+
 		/* Allocate memory for the C-API struct */
-		fmu -> capi = fmi1_capi_create_dllfmu(fmu->callbacks, dllFileName, modelIdentifier, callBackFunctions, standard);
+		if (dllFileName) {
+			fmu -> capi = fmi1_capi_create_dllfmu(fmu->callbacks, dllFileName, modelIdentifier, callBackFunctions, standard);
+		}
 	}
 
 
@@ -85,16 +94,13 @@ jm_status_enu_t fmi1_import_create_dllfmu(fmi1_import_t* fmu, fmi1_callback_func
 		jm_log_info(fmu->callbacks, module, 
 			"Loading '" FMI_PLATFORM "' binary with '%s' platform types", fmi1_get_platform() );
 
+		fmi1_capi_set_isolation_mode(fmu -> capi, fmu->isolateBinary);
 		if(fmi1_capi_load_dll(fmu -> capi) == jm_status_error) {		
 			fmi1_capi_destroy_dllfmu(fmu -> capi);
 			fmu -> capi = NULL;
 		}
 	}
 
-	if(curDir[0] && (jm_portability_set_current_working_directory(curDir) != jm_status_success)) {
-		jm_log_error(fmu->callbacks, module, "Could not restore current working directory (%s)", strerror(errno));
-	}
-
 	fmu->callbacks->free((jm_voidp)dllDirPath);
 	fmu->callbacks->free((jm_voidp)dllFileName);
 
@@ -135,6 +141,33 @@ void fmi1_import_set_debug_mode(fmi1_import_t* fmu, int mode) {
 	fmi1_capi_set_debug_mode(fmu->capi, mode);
 }
 
+void fmi1_import_set_binary_isolation(fmi1_import_t* fmu, int mode) {
+	if (fmu == NULL) {
+		return;
+	}
+	if (fmu->capi) {
+		jm_log_warning(fmu->callbacks, module, "Binary isolation mode has no effect on an already loaded FMU binary");
+	}
+	fmu->isolateBinary = mode;
+}
+
+jm_status_enu_t fmi1_import_set_call_tracing(fmi1_import_t* fmu, int enable) {
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module,"FMU CAPI is not loaded");
+		return jm_status_error;
+	}
+	return fmi1_capi_set_tracing(fmu->capi, enable);
+}
+
+size_t fmi1_import_get_call_stats(fmi1_import_t* fmu, fmi_call_stats_t stats[], size_t n) {
+	if(!fmu->capi) return 0;
+	return fmi1_capi_get_call_stats(fmu->capi, stats, n);
+}
+
+void fmi1_import_reset_call_stats(fmi1_import_t* fmu) {
+	fmi1_capi_reset_call_stats(fmu->capi);
+}
+
 void fmi1_import_destroy_dllfmu(fmi1_import_t* fmu) {
 	
 	if (fmu == NULL) {
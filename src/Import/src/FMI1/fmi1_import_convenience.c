@@ -89,18 +89,20 @@ void fmi1_import_collect_model_counts(fmi1_import_t* fmu, fmi1_import_model_coun
     return;
 }
 
-void fmi1_import_expand_variable_references_impl(fmi1_import_t* fmu, const char* msgIn);
+void fmi1_import_expand_variable_references_impl(fmi1_import_t* fmu, const char* msgIn, jm_vector(char)* msgOut);
 
 void fmi1_import_expand_variable_references(fmi1_import_t* fmu, const char* msgIn, char* msgOut, size_t maxMsgSize) {
-	fmi1_import_expand_variable_references_impl(fmu, msgIn);
-	strncpy(msgOut, jm_vector_get_itemp(char)(&fmu->logMessageBufferExpanded,0),maxMsgSize);
+	jm_vector(char) expanded;
+	jm_vector_init(char)(&expanded, 0, fmu->callbacks);
+	fmi1_import_expand_variable_references_impl(fmu, msgIn, &expanded);
+	strncpy(msgOut, jm_vector_get_itemp(char)(&expanded,0),maxMsgSize);
 	msgOut[maxMsgSize - 1] = '\0';
+	jm_vector_free_data(char)(&expanded);
 }
 
 /* Print msgIn into msgOut by expanding variable references of the form #<Type><VR># into variable names
   and replacing '##' with a single # */
-void fmi1_import_expand_variable_references_impl(fmi1_import_t* fmu, const char* msgIn){
-	jm_vector(char)* msgOut = &fmu->logMessageBufferExpanded;
+void fmi1_import_expand_variable_references_impl(fmi1_import_t* fmu, const char* msgIn, jm_vector(char)* msgOut){
 	fmi1_xml_model_description_t* md = fmu->md;
 	jm_callbacks* callbacks = fmu->callbacks;
     char curCh;
@@ -237,7 +239,9 @@ void  fmi1_log_forwarding(fmi1_component_t c, fmi1_string_t instanceName, fmi1_s
 
 void  fmi1_log_forwarding_v(fmi1_component_t c, fmi1_string_t instanceName, fmi1_status_t status, fmi1_string_t category, fmi1_string_t message, va_list args) {
 #define BUFSIZE JM_MAX_ERROR_MESSAGE_SIZE
-    char buffer[BUFSIZE], *buf, *curp, *msg;
+    /* All buffers are local to the call, so that FMUs on different threads can log at the same time. */
+    char buffer[BUFSIZE], *buf = buffer, *heapBuf = 0, *curp, *msg;
+	jm_vector(char) expanded;
 	const char* statusStr;
 	fmi1_import_t* fmu = 0;
 	jm_callbacks* cb = jm_get_default_callbacks();
@@ -247,7 +251,7 @@ void  fmi1_log_forwarding_v(fmi1_component_t c, fmi1_string_t instanceName, fmi1
 		size_t i;
 		for(i= 0; i < n; i++) {
 			fmu = (fmi1_import_t*)jm_vector_get_item(jm_voidp)(fmi1_import_active_fmu, i);
-			if(fmu->capi->c == c) {
+			if(fmi1_capi_get_component(fmu->capi) == c) {
 				cb = fmu->callbacks;
 				break;
 			}
@@ -257,12 +261,6 @@ void  fmi1_log_forwarding_v(fmi1_component_t c, fmi1_string_t instanceName, fmi1
 			cb = jm_get_default_callbacks();
 		}
 	}
-    if(fmu) {
-         buf = jm_vector_get_itemp(char)(&fmu->logMessageBufferCoded,0);
-	}
-	else  {
-         buf = buffer;
-    }
 	switch(status) {
 		case fmi1_status_discard:
 		case fmi1_status_pending:
@@ -291,41 +289,44 @@ void  fmi1_log_forwarding_v(fmi1_component_t c, fmi1_string_t instanceName, fmi1
 	statusStr = fmi1_status_to_string(status);
     curp += jm_snprintf(curp, 100,"[FMU status:%s] ", statusStr);        
 
-	if(fmu) {
-	    int bufsize = jm_vector_get_size(char)(&fmu->logMessageBufferCoded);
+	{
+		/* Messages that do not fit on the stack are formatted again into memory owned by this call. */
+        int offset = (int)(curp - buf);
         int len;
 #ifdef JM_VA_COPY
         va_list argscp;
         JM_VA_COPY(argscp, args);
 #endif
-		/* WARNING:
-		 * We don't handle the compiler/platform dependent case when vsnprintf
-		 * returns -1 on failure to write the full message. */
-        len = jm_vsnprintf(curp, bufsize -(curp-buf), message, args);
-        if(len > (bufsize -(curp-buf+1))) {
-            int offset = (curp-buf);
-            len = jm_vector_resize(char)(&fmu->logMessageBufferCoded, len + offset + 1) - offset;
-            buf = jm_vector_get_itemp(char)(&fmu->logMessageBufferCoded,0);
-            curp = buf + offset;
+        len = jm_vsnprintf(curp, BUFSIZE - offset, message, args);
 #ifdef JM_VA_COPY
-            jm_vsnprintf(curp, len, message, argscp);
-#endif
+        if(len >= BUFSIZE - offset) {
+            heapBuf = (char*)cb->malloc(offset + len + 1);
+            if(heapBuf) {
+                memcpy(heapBuf, buf, offset);
+                jm_vsnprintf(heapBuf + offset, len + 1, message, argscp);
+                buf = heapBuf;
+            }
         }
-#ifdef JM_VA_COPY
         va_end(argscp);
 #endif
-	    fmi1_import_expand_variable_references(fmu, buf, cb->errMessageBuffer,JM_MAX_ERROR_MESSAGE_SIZE);
-		msg = jm_vector_get_itemp(char)(&fmu->logMessageBufferExpanded,0);
 	}
-	else {
-		jm_vsnprintf(curp, BUFSIZE -(curp-buf), message, args);
-        strncpy(cb->errMessageBuffer, buf, JM_MAX_ERROR_MESSAGE_SIZE);
-		cb->errMessageBuffer[JM_MAX_ERROR_MESSAGE_SIZE - 1] = '\0';
-		msg = cb->errMessageBuffer;
+
+	msg = buf;
+	if(fmu && strchr(buf, '#')) {
+		jm_vector_init(char)(&expanded, 0, cb);
+		fmi1_import_expand_variable_references_impl(fmu, buf, &expanded);
+		msg = jm_vector_get_itemp(char)(&expanded,0);
 	}
+	jm_set_last_error(cb, logLevel, msg);
 	if(cb->logger) {
 		cb->logger(cb, instanceName, logLevel, msg);
 	}
+	if(msg != buf) {
+		jm_vector_free_data(char)(&expanded);
+	}
+	if(heapBuf) {
+		cb->free(heapBuf);
+	}
 }
 
 void  fmi1_default_callback_logger(fmi1_component_t c, fmi1_string_t instanceName, fmi1_status_t status, fmi1_string_t category, fmi1_string_t message, ...) {
@@ -34,9 +34,8 @@ static const char* module = "FMILIB";
 fmi2_import_t* fmi2_import_allocate(jm_callbacks* cb) {
 	fmi2_import_t* fmu = (fmi2_import_t*)cb->calloc(1, sizeof(fmi2_import_t));
 
-	if(!fmu || (jm_vector_init(char)(&fmu->logMessageBufferCoded,JM_MAX_ERROR_MESSAGE_SIZE,cb) < JM_MAX_ERROR_MESSAGE_SIZE)) {
+	if(!fmu) {
 		jm_log_fatal(cb, module, "Could not allocate memory");
-        if(fmu) cb->free(fmu);
 		return 0;
 	}
 	fmu->dirPath = 0;
@@ -44,7 +43,6 @@ fmi2_import_t* fmi2_import_allocate(jm_callbacks* cb) {
 	fmu->callbacks = cb;
 	fmu->capi = 0;
 	fmu->md = fmi2_xml_allocate_model_description(cb);
-	jm_vector_init(char)(&fmu->logMessageBufferExpanded,0,cb);
 
 	if(!fmu->md) {
 		cb->free(fmu);
@@ -119,11 +117,13 @@ void fmi2_import_free(fmi2_import_t* fmu) {
 
 	fmi2_import_destroy_dllfmu(fmu);
 	fmi2_xml_free_model_description(fmu->md);
-	jm_vector_free_data(char)(&fmu->logMessageBufferCoded);
-	jm_vector_free_data(char)(&fmu->logMessageBufferExpanded);
+	fmi2_import_free_dependency_index(cb, fmu->dependencyIndex[fmi2_import_dependency_outputs]);
+	fmi2_import_free_dependency_index(cb, fmu->dependencyIndex[fmi2_import_dependency_derivatives]);
+	fmi2_import_free_dependency_index(cb, fmu->dependencyIndex[fmi2_import_dependency_discrete_states]);
 
 	cb->free(fmu->resourceLocation);
 	cb->free(fmu->dirPath);
+	cb->free(fmu->hostPath);
     cb->free(fmu);
 }
 
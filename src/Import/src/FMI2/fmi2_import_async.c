@@ -0,0 +1,415 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <JM/jm_vector.h>
+#include <JM/jm_thread.h>
+#include <JM/jm_portability.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+/* Interval for polling fmi2GetStatus(fmi2DoStepStatus) while native steps are pending */
+#define FMI2_ASYNC_POLL_INTERVAL 1e-3
+
+typedef enum fmi2_import_async_state_enu_t {
+	fmi2_import_async_idle,
+	fmi2_import_async_running,
+	fmi2_import_async_done
+} fmi2_import_async_state_enu_t;
+
+struct fmi2_import_async_step_t {
+	fmi2_import_completion_queue_t* queue;
+	fmi2_import_t* fmu;
+	void* userData;
+	int native;
+
+	/* fields below are protected by the queue lock */
+	fmi2_import_async_state_enu_t state;
+	int pending;              /* native fmi2DoStep returned fmi2Pending */
+	int finishedEarly;        /* stepFinished was called before fmi2DoStep returned */
+	fmi2_status_t earlyStatus;
+	fmi2_status_t status;
+	fmi2_real_t currentCommunicationPoint;
+	fmi2_real_t communicationStepSize;
+	fmi2_boolean_t noSetFMUStatePriorToCurrentPoint;
+	fmi2_import_async_step_t* next; /* link in the work or the done list */
+};
+
+struct fmi2_import_completion_queue_t {
+	jm_callbacks* callbacks;
+	jm_vector(jm_voidp) steps;
+
+	jm_mutex_t lock;
+	jm_cond_t workCond;
+	jm_cond_t doneCond;
+	fmi2_import_async_step_t* workFirst; /* emulated steps waiting for a thread */
+	fmi2_import_async_step_t* workLast;
+	fmi2_import_async_step_t* doneFirst; /* finished steps not yet collected */
+	fmi2_import_async_step_t* doneLast;
+	size_t runningNum;
+	size_t pendingNum;
+	int shutdown;
+
+	jm_thread_t* threads;
+	size_t threadsStarted;
+};
+
+/* Finish a running step. Called with the queue lock held. */
+static void fmi2_import_async_complete(fmi2_import_async_step_t* step, fmi2_status_t status) {
+	fmi2_import_completion_queue_t* q = step->queue;
+	if(step->pending) q->pendingNum--;
+	step->pending = 0;
+	step->status = status;
+	step->state = fmi2_import_async_done;
+	step->next = 0;
+	if(q->doneLast) q->doneLast->next = step;
+	else q->doneFirst = step;
+	q->doneLast = step;
+	q->runningNum--;
+	jm_cond_broadcast(&q->doneCond);
+}
+
+/* Remove a step from the done list. Called with the queue lock held. */
+static void fmi2_import_async_collect(fmi2_import_async_step_t* step) {
+	fmi2_import_completion_queue_t* q = step->queue;
+	fmi2_import_async_step_t *prev = 0, *cur = q->doneFirst;
+	while(cur && cur != step) {
+		prev = cur;
+		cur = cur->next;
+	}
+	if(!cur) return;
+	if(prev) prev->next = step->next;
+	else q->doneFirst = step->next;
+	if(q->doneLast == step) q->doneLast = prev;
+	step->next = 0;
+}
+
+static void fmi2_import_async_worker(void* arg) {
+	fmi2_import_completion_queue_t* q = (fmi2_import_completion_queue_t*)arg;
+
+	jm_mutex_lock(&q->lock);
+	for(;;) {
+		fmi2_import_async_step_t* step;
+		fmi2_status_t status;
+
+		while(!q->shutdown && !q->workFirst) {
+			jm_cond_wait(&q->workCond, &q->lock);
+		}
+		if(!q->workFirst) break;
+		step = q->workFirst;
+		q->workFirst = step->next;
+		if(!q->workFirst) q->workLast = 0;
+		jm_mutex_unlock(&q->lock);
+
+		status = fmi2_import_do_step(step->fmu, step->currentCommunicationPoint,
+			step->communicationStepSize, step->noSetFMUStatePriorToCurrentPoint);
+
+		jm_mutex_lock(&q->lock);
+		fmi2_import_async_complete(step, status);
+	}
+	jm_mutex_unlock(&q->lock);
+}
+
+/* Query native steps that returned fmi2Pending. Called without the queue lock since the FMU may
+   call stepFinished from within fmi2GetStatus. */
+static void fmi2_import_async_poll_pending(fmi2_import_completion_queue_t* q) {
+	size_t i;
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(&q->steps); i++) {
+		fmi2_import_async_step_t* step = (fmi2_import_async_step_t*)jm_vector_get_item(jm_voidp)(&q->steps, i);
+		fmi2_status_t value;
+		int pending;
+
+		jm_mutex_lock(&q->lock);
+		pending = step->pending;
+		jm_mutex_unlock(&q->lock);
+		if(!pending) continue;
+
+		if(fmi2_import_get_status(step->fmu, fmi2_do_step_status, &value) != fmi2_status_ok || value == fmi2_status_pending) {
+			continue;
+		}
+		jm_mutex_lock(&q->lock);
+		if(step->pending) fmi2_import_async_complete(step, value);
+		jm_mutex_unlock(&q->lock);
+	}
+}
+
+/* Wait for a signal on doneCond. Called with the queue lock held.
+   Returns zero if the deadline passed. */
+static int fmi2_import_async_wait_done(fmi2_import_completion_queue_t* q, double deadline) {
+	double wait = -1;
+	if(deadline >= 0) {
+		wait = deadline - jm_portability_get_time();
+		if(wait <= 0) return 0;
+	}
+	if(q->pendingNum && (wait < 0 || wait > FMI2_ASYNC_POLL_INTERVAL)) {
+		wait = FMI2_ASYNC_POLL_INTERVAL;
+	}
+	if(wait < 0) {
+		jm_cond_wait(&q->doneCond, &q->lock);
+	}
+	else {
+		jm_cond_timed_wait(&q->doneCond, &q->lock, wait);
+	}
+	return 1;
+}
+
+fmi2_import_completion_queue_t* fmi2_import_completion_queue_allocate(jm_callbacks* cb, size_t threadsNum) {
+	fmi2_import_completion_queue_t* q;
+	size_t i;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	if(threadsNum < 1) threadsNum = 1;
+	q = (fmi2_import_completion_queue_t*)cb->calloc(1, sizeof(fmi2_import_completion_queue_t));
+	if(q) q->threads = (jm_thread_t*)cb->calloc(threadsNum, sizeof(jm_thread_t));
+	if(!q || !q->threads) {
+		if(q) cb->free(q);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	q->callbacks = cb;
+	jm_vector_init(jm_voidp)(&q->steps, 0, cb);
+	jm_mutex_init(&q->lock);
+	jm_cond_init(&q->workCond);
+	jm_cond_init(&q->doneCond);
+
+	for(i = 0; i < threadsNum; i++) {
+		if(jm_thread_create(&q->threads[i], fmi2_import_async_worker, q) != jm_status_success) {
+			jm_log_error(cb, module, "Could not start worker thread");
+			fmi2_import_completion_queue_free(q);
+			return 0;
+		}
+		q->threadsStarted++;
+	}
+	return q;
+}
+
+void fmi2_import_completion_queue_free(fmi2_import_completion_queue_t* q) {
+	jm_callbacks* cb;
+	size_t i;
+	if(!q) return;
+	cb = q->callbacks;
+
+	while(jm_vector_get_size(jm_voidp)(&q->steps)) {
+		fmi2_import_async_step_free((fmi2_import_async_step_t*)jm_vector_get_last(jm_voidp)(&q->steps));
+	}
+
+	jm_mutex_lock(&q->lock);
+	q->shutdown = 1;
+	jm_cond_broadcast(&q->workCond);
+	jm_mutex_unlock(&q->lock);
+	for(i = 0; i < q->threadsStarted; i++) {
+		jm_thread_join(&q->threads[i]);
+	}
+
+	jm_cond_destroy(&q->doneCond);
+	jm_cond_destroy(&q->workCond);
+	jm_mutex_destroy(&q->lock);
+	jm_vector_free_data(jm_voidp)(&q->steps);
+	cb->free(q->threads);
+	cb->free(q);
+}
+
+fmi2_import_async_step_t* fmi2_import_completion_queue_wait(fmi2_import_completion_queue_t* q, double timeout) {
+	double deadline = (timeout < 0) ? -1 : jm_portability_get_time() + timeout;
+	fmi2_import_async_step_t* step = 0;
+
+	for(;;) {
+		fmi2_import_async_poll_pending(q);
+		jm_mutex_lock(&q->lock);
+		step = q->doneFirst;
+		if(step) {
+			fmi2_import_async_collect(step);
+			break;
+		}
+		if(!q->runningNum || !fmi2_import_async_wait_done(q, deadline)) break;
+		jm_mutex_unlock(&q->lock);
+	}
+	jm_mutex_unlock(&q->lock);
+	return step;
+}
+
+fmi2_import_async_step_t* fmi2_import_completion_queue_poll(fmi2_import_completion_queue_t* q) {
+	return fmi2_import_completion_queue_wait(q, 0);
+}
+
+size_t fmi2_import_completion_queue_get_running_num(fmi2_import_completion_queue_t* q) {
+	size_t n;
+	jm_mutex_lock(&q->lock);
+	n = q->runningNum;
+	jm_mutex_unlock(&q->lock);
+	return n;
+}
+
+fmi2_import_async_step_t* fmi2_import_async_step_allocate(fmi2_import_completion_queue_t* q, fmi2_import_t* fmu, fmi2_import_async_mode_enu_t mode, void* userData) {
+	jm_callbacks* cb = q->callbacks;
+	fmi2_import_async_step_t* step;
+
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module, "FMU CAPI is not loaded");
+		return 0;
+	}
+	if(fmu->asyncStep) {
+		jm_log_error(fmu->callbacks, module, "The FMU already has an asynchronous step handle");
+		return 0;
+	}
+	step = (fmi2_import_async_step_t*)cb->calloc(1, sizeof(fmi2_import_async_step_t));
+	if(!step || !jm_vector_push_back(jm_voidp)(&q->steps, step)) {
+		cb->free(step);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	step->queue = q;
+	step->fmu = fmu;
+	step->userData = userData;
+	step->status = fmi2_status_error;
+	if(mode == fmi2_import_async_auto) {
+		step->native = fmi2_import_get_capability(fmu, fmi2_cs_canRunAsynchronuously) != 0;
+	}
+	else {
+		step->native = (mode == fmi2_import_async_native);
+	}
+	fmu->asyncStep = step;
+	jm_log_verbose(fmu->callbacks, module, "Asynchronous steps are %s", step->native ? "run by the FMU" : "emulated");
+	return step;
+}
+
+void fmi2_import_async_step_free(fmi2_import_async_step_t* step) {
+	fmi2_import_completion_queue_t* q;
+	size_t i, n;
+	if(!step) return;
+	q = step->queue;
+
+	fmi2_import_async_step_wait(step);
+	n = jm_vector_get_size(jm_voidp)(&q->steps);
+	for(i = 0; i < n; i++) {
+		if(jm_vector_get_item(jm_voidp)(&q->steps, i) == step) {
+			jm_vector_remove_item(jm_voidp)(&q->steps, i);
+			break;
+		}
+	}
+	step->fmu->asyncStep = 0;
+	q->callbacks->free(step);
+}
+
+fmi2_status_t fmi2_import_async_step_submit(fmi2_import_async_step_t* step, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize, fmi2_boolean_t noSetFMUStatePriorToCurrentPoint) {
+	fmi2_import_completion_queue_t* q = step->queue;
+	fmi2_status_t status;
+
+	jm_mutex_lock(&q->lock);
+	if(step->state == fmi2_import_async_running) {
+		jm_mutex_unlock(&q->lock);
+		jm_log_error(step->fmu->callbacks, module, "The previous step is still running");
+		return fmi2_status_error;
+	}
+	fmi2_import_async_collect(step);
+	step->state = fmi2_import_async_running;
+	step->finishedEarly = 0;
+	step->currentCommunicationPoint = currentCommunicationPoint;
+	step->communicationStepSize = communicationStepSize;
+	step->noSetFMUStatePriorToCurrentPoint = noSetFMUStatePriorToCurrentPoint;
+	q->runningNum++;
+	if(!step->native) {
+		step->next = 0;
+		if(q->workLast) q->workLast->next = step;
+		else q->workFirst = step;
+		q->workLast = step;
+		jm_cond_signal(&q->workCond);
+		jm_mutex_unlock(&q->lock);
+		return fmi2_status_ok;
+	}
+	jm_mutex_unlock(&q->lock);
+
+	status = fmi2_import_do_step(step->fmu, currentCommunicationPoint, communicationStepSize, noSetFMUStatePriorToCurrentPoint);
+
+	jm_mutex_lock(&q->lock);
+	if(status != fmi2_status_pending) {
+		fmi2_import_async_complete(step, status);
+	}
+	else if(step->finishedEarly) {
+		fmi2_import_async_complete(step, step->earlyStatus);
+	}
+	else {
+		step->pending = 1;
+		q->pendingNum++;
+	}
+	jm_mutex_unlock(&q->lock);
+	return fmi2_status_ok;
+}
+
+fmi2_status_t fmi2_import_async_step_wait(fmi2_import_async_step_t* step) {
+	fmi2_import_completion_queue_t* q = step->queue;
+	fmi2_status_t status;
+
+	for(;;) {
+		fmi2_import_async_poll_pending(q);
+		jm_mutex_lock(&q->lock);
+		if(step->state != fmi2_import_async_running) break;
+		fmi2_import_async_wait_done(q, -1);
+		jm_mutex_unlock(&q->lock);
+	}
+	fmi2_import_async_collect(step);
+	status = step->status;
+	jm_mutex_unlock(&q->lock);
+	return status;
+}
+
+int fmi2_import_async_step_is_done(fmi2_import_async_step_t* step) {
+	int done;
+	jm_mutex_lock(&step->queue->lock);
+	done = (step->state == fmi2_import_async_done);
+	jm_mutex_unlock(&step->queue->lock);
+	return done;
+}
+
+fmi2_status_t fmi2_import_async_step_get_status(fmi2_import_async_step_t* step) {
+	fmi2_status_t status;
+	jm_mutex_lock(&step->queue->lock);
+	status = step->status;
+	jm_mutex_unlock(&step->queue->lock);
+	return status;
+}
+
+int fmi2_import_async_step_is_native(fmi2_import_async_step_t* step) {
+	return step->native;
+}
+
+fmi2_import_t* fmi2_import_async_step_get_fmu(fmi2_import_async_step_t* step) {
+	return step->fmu;
+}
+
+void* fmi2_import_async_step_get_user_data(fmi2_import_async_step_t* step) {
+	return step->userData;
+}
+
+void fmi2_step_finished_forwarding(fmi2_component_environment_t c, fmi2_status_t status) {
+	fmi2_import_t* fmu = (fmi2_import_t*)c;
+	fmi2_import_async_step_t* step = fmu ? fmu->asyncStep : 0;
+	fmi2_import_completion_queue_t* q;
+
+	if(!step || !step->native) return;
+	q = step->queue;
+	jm_mutex_lock(&q->lock);
+	if(step->state == fmi2_import_async_running) {
+		if(step->pending) {
+			fmi2_import_async_complete(step, status);
+		}
+		else {
+			step->finishedEarly = 1;
+			step->earlyStatus = status;
+		}
+	}
+	jm_mutex_unlock(&q->lock);
+}
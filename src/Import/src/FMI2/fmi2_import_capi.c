@@ -19,6 +19,7 @@ extern "C" {
 
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 #include <FMI2/fmi2_types.h>
 #include <FMI2/fmi2_functions.h>
 #include <FMI2/fmi2_enums.h>
@@ -31,7 +32,7 @@ static const char * module = "FMILIB";
 /* Load and destroy functions */
 jm_status_enu_t fmi2_import_create_dllfmu(fmi2_import_t* fmu, fmi2_fmu_kind_enu_t fmuKind, const fmi2_callback_functions_t* callBackFunctions) {
 
-	char curDir[FILENAME_MAX + 2];
+	char absDllDirPath[FILENAME_MAX + 2];
 	char* dllDirPath = 0;
 	char* dllFileName = 0;
 	const char* modelIdentifier;
@@ -65,11 +66,6 @@ jm_status_enu_t fmi2_import_create_dllfmu(fmi2_import_t* fmu, fmi2_fmu_kind_enu_
 		return jm_status_error;
 	}
 
-	if( jm_portability_get_current_working_directory(curDir, FILENAME_MAX+1) != jm_status_success) {
-		jm_log_warning(fmu->callbacks, module, "Could not get current working directory (%s)", strerror(errno));
-		curDir[0] = 0;
-	};
-
 	dllDirPath = fmi_construct_dll_dir_name(fmu->callbacks, fmu->dirPath);
 	dllFileName = fmi_construct_dll_file_name(fmu->callbacks, dllDirPath, modelIdentifier);
 
@@ -84,20 +80,33 @@ jm_status_enu_t fmi2_import_create_dllfmu(fmi2_import_t* fmu, fmi2_fmu_kind_enu_
 		defaultCallbacks.freeMemory = cb->free;
 		defaultCallbacks.componentEnvironment = fmu;
 		defaultCallbacks.logger = fmi2_log_forwarding;
-		defaultCallbacks.stepFinished = 0;
+		defaultCallbacks.stepFinished = fmi2_step_finished_forwarding;
 		callBackFunctions = &defaultCallbacks;
 	}
 
-	if(jm_portability_set_current_working_directory(dllDirPath) != jm_status_success) {
-		jm_log_fatal(fmu->callbacks, module, "Could not change to the DLL directory %s", dllDirPath);
+	/* The binary is loaded by its path. The working directory is not changed since it is shared by all threads. */
+	if(!jm_get_dir_abspath(fmu->callbacks, dllDirPath, absDllDirPath, FILENAME_MAX + 2)) {
+		jm_log_fatal(fmu->callbacks, module, "Could not access the DLL directory %s", dllDirPath);
 		if(ENOENT == errno)
 			jm_log_fatal(fmu->callbacks, module, "The FMU contains no binary for this platform.");
 		else
 			jm_log_fatal(fmu->callbacks, module, "System error: %s", strerror(errno));
 	}
 	else {
+		/* Load the binary by its absolute path, so that the loader searches its directory for the
+		   libraries it depends on (LOAD_WITH_ALTERED_SEARCH_PATH on Windows needs an absolute path)
+		   and the path stays valid if the application changes the working directory. */
+		size_t n = strlen(absDllDirPath);
+		if(n + 1 < sizeof(absDllDirPath) && n && absDllDirPath[n - 1] != FMI_FILE_SEP[0]) {
+			strcat(absDllDirPath, FMI_FILE_SEP);
+		}
+		fmu->callbacks->free(dllFileName);
+		dllFileName = fmi_construct_dll_file_name(fmu->callbacks, absDllDirPath, modelIdentifier);
+
 		/* Allocate memory for the C-API struct */
-		fmu -> capi = fmi2_capi_create_dllfmu(fmu->callbacks, dllFileName, modelIdentifier, callBackFunctions, fmuKind);
+		if (dllFileName) {
+			fmu -> capi = fmi2_capi_create_dllfmu(fmu->callbacks, dllFileName, modelIdentifier, callBackFunctions, fmuKind);
+		}
 	}
 
 
@@ -106,16 +115,14 @@ jm_status_enu_t fmi2_import_create_dllfmu(fmi2_import_t* fmu, fmi2_fmu_kind_enu_
 		jm_log_info(fmu->callbacks, module, 
 			"Loading '" FMI_PLATFORM "' binary with '%s' platform types", fmi2_get_types_platform() );
 
-		if(fmi2_capi_load_dll(fmu -> capi) == jm_status_error) {		
+		fmi2_capi_set_isolation_mode(fmu -> capi, fmu->isolateBinary);
+		if(fmi2_capi_set_host(fmu -> capi, fmu->hostPath) == jm_status_error ||
+		   fmi2_capi_load_dll(fmu -> capi) == jm_status_error) {		
 			fmi2_capi_destroy_dllfmu(fmu -> capi);
 			fmu -> capi = NULL;
 		}
 	}
 
-	if(curDir[0] && (jm_portability_set_current_working_directory(curDir) != jm_status_success)) {
-		jm_log_error(fmu->callbacks, module, "Could not restore current working directory (%s)", strerror(errno));
-	}
-
 	fmu->callbacks->free((jm_voidp)dllDirPath);
 	fmu->callbacks->free((jm_voidp)dllFileName);
 
@@ -143,6 +150,70 @@ void fmi2_import_set_debug_mode(fmi2_import_t* fmu, int mode) {
 	fmi2_capi_set_debug_mode(fmu->capi, mode);
 }
 
+void fmi2_import_set_binary_isolation(fmi2_import_t* fmu, int mode) {
+	if (fmu == NULL) {
+		return;
+	}
+	if (fmu->capi) {
+		jm_log_warning(fmu->callbacks, module, "Binary isolation mode has no effect on an already loaded FMU binary");
+	}
+	fmu->isolateBinary = mode;
+}
+
+jm_status_enu_t fmi2_import_set_out_of_process(fmi2_import_t* fmu, const char* hostPath) {
+	char* copy = 0;
+	if (fmu == NULL) {
+		return jm_status_error;
+	}
+	if (fmu->capi) {
+		jm_log_warning(fmu->callbacks, module, "Out-of-process execution has no effect on an already loaded FMU binary");
+	}
+	if (hostPath) {
+		copy = (char*)fmu->callbacks->malloc(strlen(hostPath) + 1);
+		if (!copy) {
+			jm_log_fatal(fmu->callbacks, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+		strcpy(copy, hostPath);
+	}
+	fmu->callbacks->free(fmu->hostPath);
+	fmu->hostPath = copy;
+	return jm_status_success;
+}
+
+int fmi2_import_is_host_crashed(fmi2_import_t* fmu) {
+	return fmu && fmi2_capi_is_host_crashed(fmu->capi);
+}
+
+unsigned long fmi2_import_get_host_pid(fmi2_import_t* fmu) {
+	return fmu ? fmi2_capi_get_host_pid(fmu->capi) : 0;
+}
+
+jm_status_enu_t fmi2_import_restart_host(fmi2_import_t* fmu, const fmi2_byte_t snapshot[], size_t size) {
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module,"FMU CAPI is not loaded");
+		return jm_status_error;
+	}
+	return fmi2_capi_restart_host(fmu->capi, snapshot, size);
+}
+
+jm_status_enu_t fmi2_import_set_call_tracing(fmi2_import_t* fmu, int enable) {
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module,"FMU CAPI is not loaded");
+		return jm_status_error;
+	}
+	return fmi2_capi_set_tracing(fmu->capi, enable);
+}
+
+size_t fmi2_import_get_call_stats(fmi2_import_t* fmu, fmi_call_stats_t stats[], size_t n) {
+	if(!fmu->capi) return 0;
+	return fmi2_capi_get_call_stats(fmu->capi, stats, n);
+}
+
+void fmi2_import_reset_call_stats(fmi2_import_t* fmu) {
+	fmi2_capi_reset_call_stats(fmu->capi);
+}
+
 void fmi2_import_destroy_dllfmu(fmi2_import_t* fmu) {
 	
 	if (fmu == NULL) {
@@ -0,0 +1,538 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_CHECKPOINT_WORST(a, b) (((b) > (a)) ? (b) : (a))
+
+/* A full snapshot is stored at least this often, so that decoding a delta stays cheap */
+#define FMI2_CHECKPOINT_KEYFRAME_INTERVAL 16
+
+/* Zero runs shorter than this are stored as literals */
+#define FMI2_CHECKPOINT_MIN_ZERO_RUN 4
+
+/* Storage of a serialized checkpoint */
+typedef enum fmi2_import_checkpoint_kind_enu_t {
+	fmi2_import_checkpoint_raw,   /* full snapshot as is */
+	fmi2_import_checkpoint_rle,   /* full snapshot, run length encoded */
+	fmi2_import_checkpoint_delta  /* run length encoded XOR with the previous checkpoint */
+} fmi2_import_checkpoint_kind_enu_t;
+
+typedef struct fmi2_import_checkpoint_live_t {
+	fmi2_FMU_state_t state; /* kept for reuse also when the slot is not in use */
+	fmi2_real_t time;
+} fmi2_import_checkpoint_live_t;
+
+typedef struct fmi2_import_checkpoint_entry_t {
+	fmi2_real_t time;
+	size_t offset;  /* in the arena */
+	size_t size;    /* bytes in the arena */
+	size_t rawSize; /* serialized size */
+	fmi2_import_checkpoint_kind_enu_t kind;
+} fmi2_import_checkpoint_entry_t;
+
+struct fmi2_import_checkpoint_manager_t {
+	jm_callbacks* callbacks;
+	fmi2_import_t* fmu;
+	fmi2_import_checkpoint_compression_enu_t compression;
+
+	/* live checkpoints, a ring ordered by time */
+	fmi2_import_checkpoint_live_t* live;
+	size_t liveCapacity;
+	size_t liveFirst;
+	size_t liveNum;
+
+	/* serialized checkpoints, a ring of entries ordered by time over a ring of bytes */
+	unsigned char* arena;
+	size_t arenaSize;
+	size_t head; /* end of the newest entry */
+	fmi2_import_checkpoint_entry_t* entries;
+	size_t entriesCapacity;
+	size_t entryFirst;
+	size_t entryNum;
+	size_t sinceKeyframe; /* entries since the newest full snapshot */
+
+	/* work buffers of the serialized size */
+	unsigned char* raw;
+	unsigned char* prevRaw; /* serialized state of the newest entry if prevValid */
+	unsigned char* encoded;
+	size_t rawCapacity;
+	size_t encodedCapacity;
+	int prevValid;
+
+	fmi2_FMU_state_t restoreState; /* deserialized checkpoint being restored */
+
+	fmi2_import_checkpoint_stats_t stats;
+};
+
+fmi2_import_checkpoint_manager_t* fmi2_import_checkpoint_manager_allocate(fmi2_import_t* fmu, size_t liveStatesNum, size_t arenaBytes) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_import_checkpoint_manager_t* m;
+
+	if(!fmu->capi) {
+		jm_log_error(cb, module, "FMU CAPI is not loaded");
+		return 0;
+	}
+	if(!fmu->capi->fmi2GetFMUstate || !fmu->capi->fmi2SetFMUstate || !fmu->capi->fmi2FreeFMUstate) {
+		jm_log_error(cb, module, "Checkpoints require the canGetAndSetFMUstate capability");
+		return 0;
+	}
+	if(liveStatesNum == 0) {
+		jm_log_error(cb, module, "At least one live checkpoint is needed");
+		return 0;
+	}
+	if(arenaBytes && (!fmu->capi->fmi2SerializedFMUstateSize || !fmu->capi->fmi2SerializeFMUstate || !fmu->capi->fmi2DeSerializeFMUstate)) {
+		jm_log_warning(cb, module, "The FMU cannot serialize its state, older checkpoints will not be kept");
+		arenaBytes = 0;
+	}
+	m = (fmi2_import_checkpoint_manager_t*)cb->calloc(1, sizeof(fmi2_import_checkpoint_manager_t));
+	if(!m) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	m->callbacks = cb;
+	m->fmu = fmu;
+	m->compression = fmi2_import_checkpoint_compression_delta;
+	m->liveCapacity = liveStatesNum;
+	m->live = (fmi2_import_checkpoint_live_t*)cb->calloc(liveStatesNum, sizeof(fmi2_import_checkpoint_live_t));
+	m->arenaSize = arenaBytes;
+	if(arenaBytes) {
+		m->arena = (unsigned char*)cb->malloc(arenaBytes);
+		m->entriesCapacity = 16;
+		m->entries = (fmi2_import_checkpoint_entry_t*)cb->calloc(m->entriesCapacity, sizeof(fmi2_import_checkpoint_entry_t));
+	}
+	if(!m->live || (arenaBytes && (!m->arena || !m->entries))) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		fmi2_import_checkpoint_manager_free(m);
+		return 0;
+	}
+	return m;
+}
+
+void fmi2_import_checkpoint_manager_free(fmi2_import_checkpoint_manager_t* m) {
+	jm_callbacks* cb;
+	size_t i;
+	if(!m) return;
+	cb = m->callbacks;
+	for(i = 0; m->live && i < m->liveCapacity; i++) {
+		if(m->live[i].state) fmi2_import_free_fmu_state(m->fmu, &m->live[i].state);
+	}
+	if(m->restoreState) fmi2_import_free_fmu_state(m->fmu, &m->restoreState);
+	cb->free(m->live);
+	cb->free(m->arena);
+	cb->free(m->entries);
+	cb->free(m->raw);
+	cb->free(m->prevRaw);
+	cb->free(m->encoded);
+	cb->free(m);
+}
+
+void fmi2_import_checkpoint_set_compression(fmi2_import_checkpoint_manager_t* m, fmi2_import_checkpoint_compression_enu_t compression) {
+	m->compression = compression;
+	m->prevValid = 0;
+}
+
+/* ------------------------------------------------------------------ */
+/* Run length encoding of zero bytes */
+
+static unsigned char* fmi2_import_checkpoint_put_varint(unsigned char* p, size_t v) {
+	while(v >= 0x80) {
+		*p++ = (unsigned char)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (unsigned char)v;
+	return p;
+}
+
+static const unsigned char* fmi2_import_checkpoint_get_varint(const unsigned char* p, const unsigned char* end, size_t* v) {
+	size_t shift = 0;
+	*v = 0;
+	while(p < end && shift < 8 * sizeof(size_t)) {
+		unsigned char b = *p++;
+		*v |= (size_t)(b & 0x7f) << shift;
+		if(!(b & 0x80)) return p;
+		shift += 7;
+	}
+	return 0;
+}
+
+/* Encode data, or data XOR prev if prev is not NULL, as tokens of a zero run length,
+   a literal length and the literal bytes. Returns the encoded size. */
+static size_t fmi2_import_checkpoint_encode(const unsigned char* data, const unsigned char* prev, size_t n, unsigned char* out) {
+	unsigned char* p = out;
+	size_t i = 0;
+#define FMI2_CHECKPOINT_BYTE(k) (prev ? (unsigned char)(data[k] ^ prev[k]) : data[k])
+	while(i < n) {
+		size_t zeros = 0, start, k;
+		while(i < n && FMI2_CHECKPOINT_BYTE(i) == 0) {
+			zeros++;
+			i++;
+		}
+		start = i;
+		/* literals run until a long enough zero run or a zero run that ends the data */
+		while(i < n) {
+			if(FMI2_CHECKPOINT_BYTE(i) == 0) {
+				size_t j = i;
+				while(j < n && FMI2_CHECKPOINT_BYTE(j) == 0 && j - i < FMI2_CHECKPOINT_MIN_ZERO_RUN) j++;
+				if(j - i >= FMI2_CHECKPOINT_MIN_ZERO_RUN || j == n) break;
+				i = j;
+			}
+			else {
+				i++;
+			}
+		}
+		p = fmi2_import_checkpoint_put_varint(p, zeros);
+		p = fmi2_import_checkpoint_put_varint(p, i - start);
+		for(k = start; k < i; k++) {
+			*p++ = FMI2_CHECKPOINT_BYTE(k);
+		}
+	}
+#undef FMI2_CHECKPOINT_BYTE
+	return (size_t)(p - out);
+}
+
+/* Decode into out, or XOR into out if delta is set. Returns zero if the data is corrupt. */
+static int fmi2_import_checkpoint_decode(const unsigned char* in, size_t size, unsigned char* out, size_t n, int delta) {
+	const unsigned char* end = in + size;
+	size_t pos = 0;
+	while(in < end) {
+		size_t zeros, literals, k;
+		in = fmi2_import_checkpoint_get_varint(in, end, &zeros);
+		if(in) in = fmi2_import_checkpoint_get_varint(in, end, &literals);
+		if(!in || zeros > n - pos || literals > n - pos - zeros || literals > (size_t)(end - in)) return 0;
+		if(!delta) memset(out + pos, 0, zeros);
+		pos += zeros;
+		for(k = 0; k < literals; k++) {
+			if(delta) out[pos + k] ^= in[k];
+			else out[pos + k] = in[k];
+		}
+		in += literals;
+		pos += literals;
+	}
+	return pos == n;
+}
+
+/* ------------------------------------------------------------------ */
+/* Arena */
+
+static fmi2_import_checkpoint_entry_t* fmi2_import_checkpoint_entry(fmi2_import_checkpoint_manager_t* m, size_t k) {
+	return &m->entries[(m->entryFirst + k) % m->entriesCapacity];
+}
+
+static void fmi2_import_checkpoint_forget_entry(fmi2_import_checkpoint_manager_t* m, fmi2_import_checkpoint_entry_t* e) {
+	m->stats.rawBytes -= e->rawSize;
+	m->stats.storedBytes -= e->size;
+}
+
+/* Drop the oldest entry and the deltas that depend on it */
+static void fmi2_import_checkpoint_drop_oldest(fmi2_import_checkpoint_manager_t* m) {
+	do {
+		fmi2_import_checkpoint_forget_entry(m, fmi2_import_checkpoint_entry(m, 0));
+		m->entryFirst = (m->entryFirst + 1) % m->entriesCapacity;
+		m->entryNum--;
+		m->stats.droppedNum++;
+	} while(m->entryNum && fmi2_import_checkpoint_entry(m, 0)->kind == fmi2_import_checkpoint_delta);
+	if(!m->entryNum) {
+		m->head = 0;
+		m->prevValid = 0;
+	}
+}
+
+/* Drop the entries after the first n */
+static void fmi2_import_checkpoint_truncate(fmi2_import_checkpoint_manager_t* m, size_t n) {
+	fmi2_import_checkpoint_entry_t* e;
+	if(n >= m->entryNum) return;
+	while(m->entryNum > n) {
+		fmi2_import_checkpoint_forget_entry(m, fmi2_import_checkpoint_entry(m, m->entryNum - 1));
+		m->entryNum--;
+	}
+	m->prevValid = 0;
+	if(!n) {
+		m->head = 0;
+		return;
+	}
+	e = fmi2_import_checkpoint_entry(m, n - 1);
+	m->head = e->offset + e->size;
+}
+
+/* Find room for n contiguous bytes, dropping the oldest entries as needed */
+static int fmi2_import_checkpoint_reserve(fmi2_import_checkpoint_manager_t* m, size_t n, size_t* offset) {
+	if(n > m->arenaSize) return 0;
+	for(;;) {
+		size_t tail;
+		if(!m->entryNum) {
+			*offset = 0;
+			return 1;
+		}
+		tail = fmi2_import_checkpoint_entry(m, 0)->offset;
+		if(m->head > tail) {
+			if(n <= m->arenaSize - m->head) {
+				*offset = m->head;
+				return 1;
+			}
+			if(n <= tail) {
+				*offset = 0;
+				return 1;
+			}
+		}
+		else if(n <= tail - m->head) {
+			*offset = m->head;
+			return 1;
+		}
+		fmi2_import_checkpoint_drop_oldest(m);
+	}
+}
+
+static int fmi2_import_checkpoint_grow_entries(fmi2_import_checkpoint_manager_t* m) {
+	size_t cap = 2 * m->entriesCapacity, k;
+	fmi2_import_checkpoint_entry_t* entries = (fmi2_import_checkpoint_entry_t*)m->callbacks->calloc(cap, sizeof(fmi2_import_checkpoint_entry_t));
+	if(!entries) return 0;
+	for(k = 0; k < m->entryNum; k++) {
+		entries[k] = *fmi2_import_checkpoint_entry(m, k);
+	}
+	m->callbacks->free(m->entries);
+	m->entries = entries;
+	m->entriesCapacity = cap;
+	m->entryFirst = 0;
+	return 1;
+}
+
+static int fmi2_import_checkpoint_grow_buffers(fmi2_import_checkpoint_manager_t* m, size_t rawSize) {
+	jm_callbacks* cb = m->callbacks;
+	/* the encoding adds at most two length bytes per zero run of several bytes, plus long lengths */
+	size_t encodedSize = rawSize + rawSize / 2 + 32;
+	if(rawSize <= m->rawCapacity) return 1;
+	cb->free(m->raw);
+	cb->free(m->prevRaw);
+	cb->free(m->encoded);
+	m->raw = (unsigned char*)cb->malloc(rawSize);
+	m->prevRaw = (unsigned char*)cb->malloc(rawSize);
+	m->encoded = (unsigned char*)cb->malloc(encodedSize);
+	m->prevValid = 0;
+	if(!m->raw || !m->prevRaw || !m->encoded) {
+		cb->free(m->raw);
+		cb->free(m->prevRaw);
+		cb->free(m->encoded);
+		m->raw = m->prevRaw = m->encoded = 0;
+		m->rawCapacity = m->encodedCapacity = 0;
+		return 0;
+	}
+	m->rawCapacity = rawSize;
+	m->encodedCapacity = encodedSize;
+	return 1;
+}
+
+/* Serialize an FMU state object into the arena */
+static fmi2_status_t fmi2_import_checkpoint_serialize(fmi2_import_checkpoint_manager_t* m, fmi2_import_checkpoint_live_t* l) {
+	fmi2_import_checkpoint_entry_t e;
+	const unsigned char* data;
+	unsigned char* tmp;
+	size_t rawSize = 0;
+	fmi2_status_t status;
+
+	status = fmi2_import_serialized_fmu_state_size(m->fmu, l->state, &rawSize);
+	if(status > fmi2_status_warning) return status;
+	if(rawSize == 0) return status;
+	if(!fmi2_import_checkpoint_grow_buffers(m, rawSize)) {
+		jm_log_fatal(m->callbacks, module, "Could not allocate memory");
+		return fmi2_status_error;
+	}
+	status = FMI2_CHECKPOINT_WORST(status, fmi2_import_serialize_fmu_state(m->fmu, l->state, (fmi2_byte_t*)m->raw, rawSize));
+	if(status > fmi2_status_warning) return status;
+	if(m->entryNum == m->entriesCapacity && !fmi2_import_checkpoint_grow_entries(m)) {
+		jm_log_fatal(m->callbacks, module, "Could not allocate memory");
+		return fmi2_status_error;
+	}
+
+	e.time = l->time;
+	e.rawSize = rawSize;
+	for(;;) {
+		int delta = m->compression == fmi2_import_checkpoint_compression_delta && m->prevValid && m->entryNum
+			&& m->sinceKeyframe < FMI2_CHECKPOINT_KEYFRAME_INTERVAL
+			&& fmi2_import_checkpoint_entry(m, m->entryNum - 1)->rawSize == rawSize;
+		if(m->compression == fmi2_import_checkpoint_compression_none) {
+			e.kind = fmi2_import_checkpoint_raw;
+		}
+		else {
+			e.size = fmi2_import_checkpoint_encode(m->raw, delta ? m->prevRaw : 0, rawSize, m->encoded);
+			e.kind = delta ? fmi2_import_checkpoint_delta : fmi2_import_checkpoint_rle;
+			if(e.size >= rawSize && !delta) e.kind = fmi2_import_checkpoint_raw;
+			else if(e.size >= rawSize) {
+				/* a delta larger than the snapshot is not worth keeping; start a new group */
+				m->prevValid = 0;
+				continue;
+			}
+		}
+		if(e.kind == fmi2_import_checkpoint_raw) e.size = rawSize;
+		if(!fmi2_import_checkpoint_reserve(m, e.size, &e.offset)) {
+			m->stats.droppedNum++;
+			m->prevValid = 0;
+			return status;
+		}
+		/* a delta needs the entry it was encoded against, which may have been dropped to make room */
+		if(e.kind != fmi2_import_checkpoint_delta || m->entryNum) break;
+	}
+	data = (e.kind == fmi2_import_checkpoint_raw) ? m->raw : m->encoded;
+	memcpy(m->arena + e.offset, data, e.size);
+	m->head = e.offset + e.size;
+	m->entryNum++;
+	*fmi2_import_checkpoint_entry(m, m->entryNum - 1) = e;
+	m->sinceKeyframe = (e.kind == fmi2_import_checkpoint_delta) ? m->sinceKeyframe + 1 : 1;
+	tmp = m->prevRaw;
+	m->prevRaw = m->raw;
+	m->raw = tmp;
+	m->prevValid = 1;
+	m->stats.serializedNum++;
+	m->stats.rawBytes += e.rawSize;
+	m->stats.storedBytes += e.size;
+	return status;
+}
+
+/* Reconstruct the serialized state of entry k into prevRaw */
+static int fmi2_import_checkpoint_decode_entry(fmi2_import_checkpoint_manager_t* m, size_t k) {
+	size_t first = k, i;
+	while(first > 0 && fmi2_import_checkpoint_entry(m, first)->kind == fmi2_import_checkpoint_delta) first--;
+	for(i = first; i <= k; i++) {
+		fmi2_import_checkpoint_entry_t* e = fmi2_import_checkpoint_entry(m, i);
+		const unsigned char* data = m->arena + e->offset;
+		if(e->kind == fmi2_import_checkpoint_raw) {
+			memcpy(m->prevRaw, data, e->rawSize);
+		}
+		else if(!fmi2_import_checkpoint_decode(data, e->size, m->prevRaw, e->rawSize, e->kind == fmi2_import_checkpoint_delta)) {
+			return 0;
+		}
+	}
+	m->sinceKeyframe = k - first + 1;
+	return 1;
+}
+
+/* ------------------------------------------------------------------ */
+/* Checkpoints */
+
+static fmi2_import_checkpoint_live_t* fmi2_import_checkpoint_live(fmi2_import_checkpoint_manager_t* m, size_t k) {
+	return &m->live[(m->liveFirst + k) % m->liveCapacity];
+}
+
+/* Forget the checkpoints after the given time */
+static void fmi2_import_checkpoint_discard_after(fmi2_import_checkpoint_manager_t* m, fmi2_real_t time) {
+	size_t n;
+	while(m->liveNum && fmi2_import_checkpoint_live(m, m->liveNum - 1)->time > time) m->liveNum--;
+	if(m->liveNum) return;
+	for(n = m->entryNum; n > 0 && fmi2_import_checkpoint_entry(m, n - 1)->time > time; n--);
+	fmi2_import_checkpoint_truncate(m, n);
+}
+
+fmi2_status_t fmi2_import_checkpoint_save(fmi2_import_checkpoint_manager_t* m, fmi2_real_t time) {
+	fmi2_import_checkpoint_live_t* l;
+	fmi2_status_t status = fmi2_status_ok;
+	int reused;
+
+	fmi2_import_checkpoint_discard_after(m, time);
+	if(m->liveNum == m->liveCapacity) {
+		/* the oldest live checkpoint moves to the arena and its state object is reused */
+		l = fmi2_import_checkpoint_live(m, 0);
+		if(m->arenaSize) {
+			status = fmi2_import_checkpoint_serialize(m, l);
+			if(status > fmi2_status_warning) {
+				jm_log_error(m->callbacks, module, "Could not serialize the checkpoint at time %g", l->time);
+				return status;
+			}
+		}
+		m->liveFirst = (m->liveFirst + 1) % m->liveCapacity;
+		m->liveNum--;
+	}
+	l = fmi2_import_checkpoint_live(m, m->liveNum);
+	reused = (l->state != 0);
+	status = FMI2_CHECKPOINT_WORST(status, fmi2_import_get_fmu_state(m->fmu, &l->state));
+	if(status > fmi2_status_warning) {
+		jm_log_error(m->callbacks, module, "Could not get the FMU state at time %g", time);
+		return status;
+	}
+	if(reused) m->stats.statesReusedNum++;
+	else m->stats.statesCreatedNum++;
+	l->time = time;
+	m->liveNum++;
+	m->stats.savesNum++;
+	return status;
+}
+
+fmi2_status_t fmi2_import_checkpoint_rollback(fmi2_import_checkpoint_manager_t* m, fmi2_real_t time, fmi2_real_t* restoredTime) {
+	fmi2_status_t status;
+	size_t k;
+
+	m->stats.rollbacksNum++;
+	for(k = m->liveNum; k > 0; k--) {
+		fmi2_import_checkpoint_live_t* l = fmi2_import_checkpoint_live(m, k - 1);
+		if(l->time <= time) {
+			status = fmi2_import_set_fmu_state(m->fmu, l->state);
+			if(status > fmi2_status_warning) break;
+			m->liveNum = k;
+			m->stats.liveHitsNum++;
+			if(restoredTime) *restoredTime = l->time;
+			return status;
+		}
+	}
+	if(k == 0) {
+		for(k = m->entryNum; k > 0; k--) {
+			fmi2_import_checkpoint_entry_t* e = fmi2_import_checkpoint_entry(m, k - 1);
+			if(e->time > time) continue;
+			if(!fmi2_import_checkpoint_decode_entry(m, k - 1)) {
+				jm_log_error(m->callbacks, module, "Corrupt checkpoint at time %g", e->time);
+				return fmi2_status_error;
+			}
+			/* the FMU allocates the deserialized state; the previous one is released first */
+			if(m->restoreState) fmi2_import_free_fmu_state(m->fmu, &m->restoreState);
+			status = fmi2_import_de_serialize_fmu_state(m->fmu, (const fmi2_byte_t*)m->prevRaw, e->rawSize, &m->restoreState);
+			if(status <= fmi2_status_warning) {
+				status = FMI2_CHECKPOINT_WORST(status, fmi2_import_set_fmu_state(m->fmu, m->restoreState));
+			}
+			if(status > fmi2_status_warning) break;
+			m->liveNum = 0;
+			fmi2_import_checkpoint_truncate(m, k);
+			m->prevValid = 1;
+			m->stats.arenaHitsNum++;
+			if(restoredTime) *restoredTime = e->time;
+			return status;
+		}
+		if(k == 0) {
+			m->stats.missesNum++;
+			jm_log_error(m->callbacks, module, "No checkpoint at or before time %g", time);
+			return fmi2_status_error;
+		}
+	}
+	jm_log_error(m->callbacks, module, "Could not restore the FMU state");
+	return status;
+}
+
+void fmi2_import_checkpoint_clear(fmi2_import_checkpoint_manager_t* m) {
+	m->liveNum = 0;
+	fmi2_import_checkpoint_truncate(m, 0);
+}
+
+void fmi2_import_checkpoint_get_stats(fmi2_import_checkpoint_manager_t* m, fmi2_import_checkpoint_stats_t* stats) {
+	*stats = m->stats;
+	stats->liveCheckpointsNum = m->liveNum;
+	stats->arenaCheckpointsNum = m->entryNum;
+	stats->arenaBytes = m->arenaSize;
+	stats->memoryBytes = sizeof(fmi2_import_checkpoint_manager_t)
+		+ m->liveCapacity * sizeof(fmi2_import_checkpoint_live_t)
+		+ m->arenaSize + m->entriesCapacity * sizeof(fmi2_import_checkpoint_entry_t)
+		+ 2 * m->rawCapacity + m->encodedCapacity;
+}
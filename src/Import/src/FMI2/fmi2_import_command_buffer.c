@@ -0,0 +1,465 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+typedef enum fmi2_command_enu_t {
+	fmi2_command_set_real,
+	fmi2_command_set_integer,
+	fmi2_command_set_boolean,
+	fmi2_command_set_string,
+	fmi2_command_get_real,
+	fmi2_command_get_integer,
+	fmi2_command_get_boolean,
+	fmi2_command_get_string,
+	fmi2_command_set_real_input_derivatives,
+	fmi2_command_get_real_output_derivatives,
+	fmi2_command_do_step,
+	fmi2_command_get_status,
+	fmi2_command_get_real_status,
+	fmi2_command_get_integer_status,
+	fmi2_command_get_boolean_status,
+	fmi2_command_get_string_status,
+	fmi2_command_set_time,
+	fmi2_command_set_continuous_states,
+	fmi2_command_get_continuous_states,
+	fmi2_command_get_derivatives,
+	fmi2_command_get_event_indicators
+} fmi2_command_enu_t;
+
+/* One recorded call. The value references and orders are owned, the values are the caller's. */
+typedef struct fmi2_command_t {
+	fmi2_command_enu_t kind;
+	size_t n;
+	fmi2_value_reference_t* vr;
+	fmi2_integer_t* order;
+	const void* in;                 /* input values, communication point or time */
+	void* out;                      /* output values */
+	const fmi2_real_t* stepSize;
+	fmi2_boolean_t newStep;
+	fmi2_status_kind_t statusKind;
+} fmi2_command_t;
+
+struct fmi2_import_command_buffer_t {
+	jm_callbacks* callbacks;
+	fmi2_import_t* fmu;
+	fmi2_command_t* commands;
+	fmi2_status_t* statuses;
+	size_t size;
+	size_t capacity;
+	size_t executedNum;
+};
+
+static fmi2_import_command_buffer_t* fmi2_import_command_buffer_create(fmi2_import_t* fmu) {
+	fmi2_import_command_buffer_t* buf;
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module, "FMU CAPI is not loaded");
+		return 0;
+	}
+	buf = (fmi2_import_command_buffer_t*)fmu->callbacks->calloc(1, sizeof(fmi2_import_command_buffer_t));
+	if(!buf) {
+		jm_log_fatal(fmu->callbacks, module, "Could not allocate memory");
+		return 0;
+	}
+	buf->callbacks = fmu->callbacks;
+	buf->fmu = fmu;
+	return buf;
+}
+
+fmi2_import_command_buffer_t* fmi2_import_command_buffer_allocate(fmi2_import_t* fmu) {
+	return fmi2_import_command_buffer_create(fmu);
+}
+
+fmi2_import_command_buffer_t* fmi2_import_command_buffer_allocate_for_instance(fmi2_import_instance_t* inst) {
+	return fmi2_import_command_buffer_create(fmi2_import_instance_get_view(inst));
+}
+
+void fmi2_import_command_buffer_clear(fmi2_import_command_buffer_t* buf) {
+	size_t i;
+	for(i = 0; i < buf->size; i++) {
+		buf->callbacks->free(buf->commands[i].vr);
+		buf->callbacks->free(buf->commands[i].order);
+	}
+	buf->size = 0;
+	buf->executedNum = 0;
+}
+
+void fmi2_import_command_buffer_free(fmi2_import_command_buffer_t* buf) {
+	if(!buf) return;
+	fmi2_import_command_buffer_clear(buf);
+	buf->callbacks->free(buf->commands);
+	buf->callbacks->free(buf->statuses);
+	buf->callbacks->free(buf);
+}
+
+size_t fmi2_import_command_buffer_get_size(fmi2_import_command_buffer_t* buf) {
+	return buf->size;
+}
+
+size_t fmi2_import_command_buffer_get_executed_num(fmi2_import_command_buffer_t* buf) {
+	return buf->executedNum;
+}
+
+const fmi2_status_t* fmi2_import_command_buffer_get_statuses(fmi2_import_command_buffer_t* buf) {
+	return buf->statuses;
+}
+
+/* Check that the FMU provides the function and that it is one of its kind (NULL kind for both) */
+static int fmi2_command_check_fcn(fmi2_import_command_buffer_t* buf, int provided, const char* name, fmi2_fmu_kind_enu_t kind) {
+	fmi2_capi_t* capi = buf->fmu->capi;
+	if(kind != fmi2_fmu_kind_unknown && fmi2_capi_get_fmu_kind(capi) != kind) {
+		jm_log_error(buf->callbacks, module, "%s is not available for %s FMUs", name,
+			(kind == fmi2_fmu_kind_cs) ? "model exchange" : "co-simulation");
+		return 0;
+	}
+	if(!provided) {
+		jm_log_error(buf->callbacks, module, "%s is not provided by the FMU", name);
+		return 0;
+	}
+	return 1;
+}
+
+/* Check that all value references belong to variables of the base type */
+static int fmi2_command_check_vrs(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_base_type_enu_t bt) {
+	size_t i;
+	if(nvr && !vr) {
+		jm_log_error(buf->callbacks, module, "No value references given");
+		return 0;
+	}
+	for(i = 0; i < nvr; i++) {
+		if(!fmi2_import_get_variable_by_vr(buf->fmu, bt, vr[i]) &&
+		   !(bt == fmi2_base_type_int && fmi2_import_get_variable_by_vr(buf->fmu, fmi2_base_type_enum, vr[i]))) {
+			jm_log_error(buf->callbacks, module, "No %s variable with value reference %u",
+				fmi2_base_type_to_string(bt), (unsigned)vr[i]);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Append a command with copies of the value references and orders */
+static jm_status_enu_t fmi2_command_append(fmi2_import_command_buffer_t* buf, const fmi2_command_t* cmd) {
+	jm_callbacks* cb = buf->callbacks;
+	fmi2_command_t copy = *cmd;
+
+	if(buf->size == buf->capacity) {
+		size_t capacity = buf->capacity ? 2 * buf->capacity : 16;
+		fmi2_command_t* commands = (fmi2_command_t*)cb->realloc(buf->commands, capacity * sizeof(fmi2_command_t));
+		fmi2_status_t* statuses;
+		if(commands) buf->commands = commands;
+		statuses = commands ? (fmi2_status_t*)cb->realloc(buf->statuses, capacity * sizeof(fmi2_status_t)) : 0;
+		if(!statuses) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+		buf->statuses = statuses;
+		buf->capacity = capacity;
+	}
+	copy.vr = 0;
+	copy.order = 0;
+	if(cmd->vr && cmd->n) {
+		copy.vr = (fmi2_value_reference_t*)cb->malloc(cmd->n * sizeof(fmi2_value_reference_t));
+		if(copy.vr) memcpy(copy.vr, cmd->vr, cmd->n * sizeof(fmi2_value_reference_t));
+	}
+	if(cmd->order && cmd->n) {
+		copy.order = (fmi2_integer_t*)cb->malloc(cmd->n * sizeof(fmi2_integer_t));
+		if(copy.order) memcpy(copy.order, cmd->order, cmd->n * sizeof(fmi2_integer_t));
+	}
+	if((cmd->vr && cmd->n && !copy.vr) || (cmd->order && cmd->n && !copy.order)) {
+		cb->free(copy.vr);
+		cb->free(copy.order);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	buf->commands[buf->size++] = copy;
+	return jm_status_success;
+}
+
+static jm_status_enu_t fmi2_command_record_values(fmi2_import_command_buffer_t* buf, fmi2_command_enu_t kind, int provided, const char* name,
+	fmi2_base_type_enu_t bt, const fmi2_value_reference_t vr[], size_t nvr, const void* in, void* out) {
+	fmi2_command_t cmd;
+	if(!fmi2_command_check_fcn(buf, provided, name, fmi2_fmu_kind_unknown) || !fmi2_command_check_vrs(buf, vr, nvr, bt)) {
+		return jm_status_error;
+	}
+	if(nvr && !in && !out) {
+		jm_log_error(buf->callbacks, module, "No values given for %s", name);
+		return jm_status_error;
+	}
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.kind = kind;
+	cmd.n = nvr;
+	cmd.vr = (fmi2_value_reference_t*)vr;
+	cmd.in = in;
+	cmd.out = out;
+	return fmi2_command_append(buf, &cmd);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_set_real(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_real_t value[]) {
+	return fmi2_command_record_values(buf, fmi2_command_set_real, buf->fmu->capi->fmi2SetReal != 0, "fmi2SetReal", fmi2_base_type_real, vr, nvr, value, 0);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_set_integer(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t value[]) {
+	return fmi2_command_record_values(buf, fmi2_command_set_integer, buf->fmu->capi->fmi2SetInteger != 0, "fmi2SetInteger", fmi2_base_type_int, vr, nvr, value, 0);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_set_boolean(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_boolean_t value[]) {
+	return fmi2_command_record_values(buf, fmi2_command_set_boolean, buf->fmu->capi->fmi2SetBoolean != 0, "fmi2SetBoolean", fmi2_base_type_bool, vr, nvr, value, 0);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_set_string(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_string_t value[]) {
+	return fmi2_command_record_values(buf, fmi2_command_set_string, buf->fmu->capi->fmi2SetString != 0, "fmi2SetString", fmi2_base_type_str, vr, nvr, value, 0);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_real(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_real_t value[]) {
+	return fmi2_command_record_values(buf, fmi2_command_get_real, buf->fmu->capi->fmi2GetReal != 0, "fmi2GetReal", fmi2_base_type_real, vr, nvr, 0, value);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_integer(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_integer_t value[]) {
+	return fmi2_command_record_values(buf, fmi2_command_get_integer, buf->fmu->capi->fmi2GetInteger != 0, "fmi2GetInteger", fmi2_base_type_int, vr, nvr, 0, value);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_boolean(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_boolean_t value[]) {
+	return fmi2_command_record_values(buf, fmi2_command_get_boolean, buf->fmu->capi->fmi2GetBoolean != 0, "fmi2GetBoolean", fmi2_base_type_bool, vr, nvr, 0, value);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_string(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, fmi2_string_t value[]) {
+	return fmi2_command_record_values(buf, fmi2_command_get_string, buf->fmu->capi->fmi2GetString != 0, "fmi2GetString", fmi2_base_type_str, vr, nvr, 0, value);
+}
+
+static jm_status_enu_t fmi2_command_record_derivatives(fmi2_import_command_buffer_t* buf, fmi2_command_enu_t kind, int provided, const char* name,
+	const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], const void* in, void* out, unsigned int maxOrder) {
+	fmi2_command_t cmd;
+	size_t i;
+	if(!fmi2_command_check_fcn(buf, provided, name, fmi2_fmu_kind_cs) || !fmi2_command_check_vrs(buf, vr, nvr, fmi2_base_type_real)) {
+		return jm_status_error;
+	}
+	if(nvr && (!order || (!in && !out))) {
+		jm_log_error(buf->callbacks, module, "No orders or values given for %s", name);
+		return jm_status_error;
+	}
+	for(i = 0; i < nvr; i++) {
+		if(order[i] < 1 || (unsigned int)order[i] > maxOrder) {
+			jm_log_error(buf->callbacks, module, "Derivative order %d is out of range for %s", (int)order[i], name);
+			return jm_status_error;
+		}
+	}
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.kind = kind;
+	cmd.n = nvr;
+	cmd.vr = (fmi2_value_reference_t*)vr;
+	cmd.order = (fmi2_integer_t*)order;
+	cmd.in = in;
+	cmd.out = out;
+	return fmi2_command_append(buf, &cmd);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_set_real_input_derivatives(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], const fmi2_real_t value[]) {
+	return fmi2_command_record_derivatives(buf, fmi2_command_set_real_input_derivatives, buf->fmu->capi->fmi2SetRealInputDerivatives != 0,
+		"fmi2SetRealInputDerivatives", vr, nvr, order, value, 0, (unsigned int)-1);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_real_output_derivatives(fmi2_import_command_buffer_t* buf, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], fmi2_real_t value[]) {
+	return fmi2_command_record_derivatives(buf, fmi2_command_get_real_output_derivatives, buf->fmu->capi->fmi2GetRealOutputDerivatives != 0,
+		"fmi2GetRealOutputDerivatives", vr, nvr, order, 0, value, fmi2_import_get_capability(buf->fmu, fmi2_cs_maxOutputDerivativeOrder));
+}
+
+jm_status_enu_t fmi2_import_command_buffer_do_step(fmi2_import_command_buffer_t* buf, const fmi2_real_t* currentCommunicationPoint, const fmi2_real_t* communicationStepSize, fmi2_boolean_t newStep) {
+	fmi2_command_t cmd;
+	if(!fmi2_command_check_fcn(buf, buf->fmu->capi->fmi2DoStep != 0, "fmi2DoStep", fmi2_fmu_kind_cs)) {
+		return jm_status_error;
+	}
+	if(!currentCommunicationPoint || !communicationStepSize) {
+		jm_log_error(buf->callbacks, module, "No communication point or step size given for fmi2DoStep");
+		return jm_status_error;
+	}
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.kind = fmi2_command_do_step;
+	cmd.in = currentCommunicationPoint;
+	cmd.stepSize = communicationStepSize;
+	cmd.newStep = newStep;
+	return fmi2_command_append(buf, &cmd);
+}
+
+static jm_status_enu_t fmi2_command_record_status(fmi2_import_command_buffer_t* buf, fmi2_command_enu_t kind, int provided, const char* name,
+	fmi2_status_kind_t s, void* value) {
+	fmi2_command_t cmd;
+	if(!fmi2_command_check_fcn(buf, provided, name, fmi2_fmu_kind_cs)) {
+		return jm_status_error;
+	}
+	if(!value) {
+		jm_log_error(buf->callbacks, module, "No value given for %s", name);
+		return jm_status_error;
+	}
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.kind = kind;
+	cmd.statusKind = s;
+	cmd.out = value;
+	return fmi2_command_append(buf, &cmd);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_status_t* value) {
+	return fmi2_command_record_status(buf, fmi2_command_get_status, buf->fmu->capi->fmi2GetStatus != 0, "fmi2GetStatus", s, value);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_real_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_real_t* value) {
+	return fmi2_command_record_status(buf, fmi2_command_get_real_status, buf->fmu->capi->fmi2GetRealStatus != 0, "fmi2GetRealStatus", s, value);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_integer_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_integer_t* value) {
+	return fmi2_command_record_status(buf, fmi2_command_get_integer_status, buf->fmu->capi->fmi2GetIntegerStatus != 0, "fmi2GetIntegerStatus", s, value);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_boolean_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_boolean_t* value) {
+	return fmi2_command_record_status(buf, fmi2_command_get_boolean_status, buf->fmu->capi->fmi2GetBooleanStatus != 0, "fmi2GetBooleanStatus", s, value);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_string_status(fmi2_import_command_buffer_t* buf, fmi2_status_kind_t s, fmi2_string_t* value) {
+	return fmi2_command_record_status(buf, fmi2_command_get_string_status, buf->fmu->capi->fmi2GetStringStatus != 0, "fmi2GetStringStatus", s, value);
+}
+
+static jm_status_enu_t fmi2_command_record_array(fmi2_import_command_buffer_t* buf, fmi2_command_enu_t kind, int provided, const char* name,
+	size_t n, const void* in, void* out) {
+	fmi2_command_t cmd;
+	if(!fmi2_command_check_fcn(buf, provided, name, fmi2_fmu_kind_me)) {
+		return jm_status_error;
+	}
+	if(!in && !out) {
+		jm_log_error(buf->callbacks, module, "No values given for %s", name);
+		return jm_status_error;
+	}
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.kind = kind;
+	cmd.n = n;
+	cmd.in = in;
+	cmd.out = out;
+	return fmi2_command_append(buf, &cmd);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_set_time(fmi2_import_command_buffer_t* buf, const fmi2_real_t* time) {
+	return fmi2_command_record_array(buf, fmi2_command_set_time, buf->fmu->capi->fmi2SetTime != 0, "fmi2SetTime", 1, time, 0);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_set_continuous_states(fmi2_import_command_buffer_t* buf, const fmi2_real_t x[], size_t nx) {
+	return fmi2_command_record_array(buf, fmi2_command_set_continuous_states, buf->fmu->capi->fmi2SetContinuousStates != 0, "fmi2SetContinuousStates", nx, x, 0);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_continuous_states(fmi2_import_command_buffer_t* buf, fmi2_real_t x[], size_t nx) {
+	return fmi2_command_record_array(buf, fmi2_command_get_continuous_states, buf->fmu->capi->fmi2GetContinuousStates != 0, "fmi2GetContinuousStates", nx, 0, x);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_derivatives(fmi2_import_command_buffer_t* buf, fmi2_real_t derivatives[], size_t nx) {
+	return fmi2_command_record_array(buf, fmi2_command_get_derivatives, buf->fmu->capi->fmi2GetDerivatives != 0, "fmi2GetDerivatives", nx, 0, derivatives);
+}
+
+jm_status_enu_t fmi2_import_command_buffer_get_event_indicators(fmi2_import_command_buffer_t* buf, fmi2_real_t eventIndicators[], size_t ni) {
+	return fmi2_command_record_array(buf, fmi2_command_get_event_indicators, buf->fmu->capi->fmi2GetEventIndicators != 0, "fmi2GetEventIndicators", ni, 0, eventIndicators);
+}
+
+fmi2_status_t fmi2_import_command_buffer_submit(fmi2_import_command_buffer_t* buf) {
+	/* The function pointers and the component are read at each submission since
+	   switching call tracing or restarting a host process replaces them */
+	fmi2_capi_t* capi = buf->fmu->capi;
+	fmi2_component_t c = capi ? capi->c : 0;
+	fmi2_status_t worst = fmi2_status_ok;
+	size_t i;
+
+	buf->executedNum = 0;
+	if(!c) {
+		jm_log_error(buf->callbacks, module, "The FMU is not instantiated");
+		return fmi2_status_error;
+	}
+	for(i = 0; i < buf->size; i++) {
+		const fmi2_command_t* cmd = &buf->commands[i];
+		fmi2_status_t status;
+		switch(cmd->kind) {
+		case fmi2_command_set_real:
+			status = capi->fmi2SetReal(c, cmd->vr, cmd->n, (const fmi2_real_t*)cmd->in);
+			break;
+		case fmi2_command_set_integer:
+			status = capi->fmi2SetInteger(c, cmd->vr, cmd->n, (const fmi2_integer_t*)cmd->in);
+			break;
+		case fmi2_command_set_boolean:
+			status = capi->fmi2SetBoolean(c, cmd->vr, cmd->n, (const fmi2_boolean_t*)cmd->in);
+			break;
+		case fmi2_command_set_string:
+			status = capi->fmi2SetString(c, cmd->vr, cmd->n, (const fmi2_string_t*)cmd->in);
+			break;
+		case fmi2_command_get_real:
+			status = capi->fmi2GetReal(c, cmd->vr, cmd->n, (fmi2_real_t*)cmd->out);
+			break;
+		case fmi2_command_get_integer:
+			status = capi->fmi2GetInteger(c, cmd->vr, cmd->n, (fmi2_integer_t*)cmd->out);
+			break;
+		case fmi2_command_get_boolean:
+			status = capi->fmi2GetBoolean(c, cmd->vr, cmd->n, (fmi2_boolean_t*)cmd->out);
+			break;
+		case fmi2_command_get_string:
+			status = capi->fmi2GetString(c, cmd->vr, cmd->n, (fmi2_string_t*)cmd->out);
+			break;
+		case fmi2_command_set_real_input_derivatives:
+			status = capi->fmi2SetRealInputDerivatives(c, cmd->vr, cmd->n, cmd->order, (const fmi2_real_t*)cmd->in);
+			break;
+		case fmi2_command_get_real_output_derivatives:
+			status = capi->fmi2GetRealOutputDerivatives(c, cmd->vr, cmd->n, cmd->order, (fmi2_real_t*)cmd->out);
+			break;
+		case fmi2_command_do_step:
+			status = capi->fmi2DoStep(c, *(const fmi2_real_t*)cmd->in, *cmd->stepSize, cmd->newStep);
+			break;
+		case fmi2_command_get_status:
+			status = capi->fmi2GetStatus(c, cmd->statusKind, (fmi2_status_t*)cmd->out);
+			break;
+		case fmi2_command_get_real_status:
+			status = capi->fmi2GetRealStatus(c, cmd->statusKind, (fmi2_real_t*)cmd->out);
+			break;
+		case fmi2_command_get_integer_status:
+			status = capi->fmi2GetIntegerStatus(c, cmd->statusKind, (fmi2_integer_t*)cmd->out);
+			break;
+		case fmi2_command_get_boolean_status:
+			status = capi->fmi2GetBooleanStatus(c, cmd->statusKind, (fmi2_boolean_t*)cmd->out);
+			break;
+		case fmi2_command_get_string_status:
+			status = capi->fmi2GetStringStatus(c, cmd->statusKind, (fmi2_string_t*)cmd->out);
+			break;
+		case fmi2_command_set_time:
+			status = capi->fmi2SetTime(c, *(const fmi2_real_t*)cmd->in);
+			break;
+		case fmi2_command_set_continuous_states:
+			status = capi->fmi2SetContinuousStates(c, (const fmi2_real_t*)cmd->in, cmd->n);
+			break;
+		case fmi2_command_get_continuous_states:
+			status = capi->fmi2GetContinuousStates(c, (fmi2_real_t*)cmd->out, cmd->n);
+			break;
+		case fmi2_command_get_derivatives:
+			status = capi->fmi2GetDerivatives(c, (fmi2_real_t*)cmd->out, cmd->n);
+			break;
+		default:
+			status = capi->fmi2GetEventIndicators(c, (fmi2_real_t*)cmd->out, cmd->n);
+			break;
+		}
+		buf->statuses[i] = status;
+		if(status > worst) worst = status;
+		if(status >= fmi2_status_error) {
+			i++;
+			break;
+		}
+	}
+	buf->executedNum = i;
+	return worst;
+}
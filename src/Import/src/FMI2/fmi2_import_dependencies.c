@@ -0,0 +1,329 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <FMI2/fmi2_xml_model_description.h>
+#include <FMI2/fmi2_xml_model_structure.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_DEPENDENCY_WORD_BITS (sizeof(size_t) * 8)
+
+struct fmi2_import_dependency_index_t {
+	size_t nRows;
+	size_t nVars;
+
+	/* column-compressed transpose */
+	size_t* startIndex;  /* nVars + 1 */
+	size_t* dependent;   /* number of dependencies */
+
+	/* dense bitset matrix, built on first use */
+	size_t nWords;
+	size_t* bits;        /* nVars * nWords */
+	int bitsTooLarge;
+};
+
+void fmi2_import_free_dependency_index(jm_callbacks* cb, fmi2_import_dependency_index_t* idx) {
+	if(!idx) return;
+	cb->free(idx->startIndex);
+	cb->free(idx->dependent);
+	cb->free(idx->bits);
+	cb->free(idx);
+}
+
+/* Variables that an unknown without dependency information may depend on */
+static char* fmi2_import_get_possible_knowns(fmi2_import_t* fmu, size_t nVars) {
+	jm_vector(jm_voidp)* vars = fmi2_xml_get_variables_original_order(fmu->md);
+	jm_vector(jm_voidp)* derivatives = fmi2_xml_get_derivatives(fmi2_xml_get_model_structure(fmu->md));
+	char* isKnown = (char*)fmu->callbacks->calloc(nVars ? nVars : 1, sizeof(char));
+	size_t i;
+
+	if(!isKnown) return 0;
+	for(i = 0; i < nVars; i++) {
+		fmi2_import_variable_t* v = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(vars, i);
+		fmi2_causality_enu_t causality = fmi2_import_get_causality(v);
+		if(causality == fmi2_causality_enu_input || causality == fmi2_causality_enu_independent) isKnown[i] = 1;
+	}
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(derivatives); i++) {
+		fmi2_import_variable_t* der = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(derivatives, i);
+		fmi2_import_variable_t* state = (fmi2_import_variable_t*)fmi2_import_get_real_variable_derivative_of(fmi2_import_get_variable_as_real(der));
+		if(state) isKnown[fmi2_import_get_variable_original_order(state)] = 1;
+	}
+	return isKnown;
+}
+
+/* Count (pass 0) or store (pass 1) the entry of row r in column col, skipping duplicates */
+static void fmi2_import_dependency_index_add(fmi2_import_dependency_index_t* idx, size_t pass, size_t* fill, size_t* last, size_t col, size_t r) {
+	if(last[col] == r) return;
+	last[col] = r;
+	if(pass == 0)
+		idx->startIndex[col + 1]++;
+	else
+		idx->dependent[fill[col]++] = r;
+}
+
+static fmi2_import_dependency_index_t* fmi2_import_build_dependency_index(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_xml_model_structure_t* ms = fmi2_xml_get_model_structure(fmu->md);
+	jm_vector(jm_voidp)* vars = fmi2_xml_get_variables_original_order(fmu->md);
+	jm_vector(jm_voidp)* unknowns;
+	fmi2_import_dependency_index_t* idx;
+	size_t *startIndex, *dependency, *fill = 0, *last = 0;
+	char* factorKind;
+	char* isKnown = 0;
+	size_t nVars = vars ? jm_vector_get_size(jm_voidp)(vars) : 0;
+	size_t pass, r, k, v;
+
+	switch(kind) {
+	case fmi2_import_dependency_outputs:
+		unknowns = fmi2_xml_get_outputs(ms);
+		fmi2_xml_get_outputs_dependencies(ms, &startIndex, &dependency, &factorKind);
+		break;
+	case fmi2_import_dependency_derivatives:
+		unknowns = fmi2_xml_get_derivatives(ms);
+		fmi2_xml_get_derivatives_dependencies(ms, &startIndex, &dependency, &factorKind);
+		break;
+	case fmi2_import_dependency_discrete_states:
+		unknowns = fmi2_xml_get_discrete_states(ms);
+		fmi2_xml_get_discrete_states_dependencies(ms, &startIndex, &dependency, &factorKind);
+		break;
+	default:
+		jm_log_error(cb, module, "Unknown dependency kind %d", (int)kind);
+		return 0;
+	}
+
+	idx = (fmi2_import_dependency_index_t*)cb->calloc(1, sizeof(fmi2_import_dependency_index_t));
+	if(!idx) goto fail;
+	idx->nRows = jm_vector_get_size(jm_voidp)(unknowns);
+	idx->nVars = nVars;
+	idx->nWords = (idx->nRows + FMI2_DEPENDENCY_WORD_BITS - 1) / FMI2_DEPENDENCY_WORD_BITS;
+	idx->startIndex = (size_t*)cb->calloc(nVars + 1, sizeof(size_t));
+	fill = (size_t*)cb->calloc(nVars ? nVars : 1, sizeof(size_t));
+	last = (size_t*)cb->calloc(nVars ? nVars : 1, sizeof(size_t));
+	isKnown = fmi2_import_get_possible_knowns(fmu, nVars);
+	if(!idx->startIndex || !fill || !last || !isKnown) goto fail;
+
+	/* first pass counts the entries per column, second pass fills them in row order */
+	for(pass = 0; pass < 2; pass++) {
+		for(v = 0; v < nVars; v++) last[v] = (size_t)-1;
+		for(r = 0; r < idx->nRows; r++) {
+			int dense = (startIndex == 0);
+			if(!dense) {
+				for(k = startIndex[r]; k < startIndex[r + 1]; k++) {
+					if(dependency[k] == 0) dense = 1;
+				}
+			}
+			if(dense) {
+				for(v = 0; v < nVars; v++) {
+					if(isKnown[v]) fmi2_import_dependency_index_add(idx, pass, fill, last, v, r);
+				}
+			}
+			else {
+				for(k = startIndex[r]; k < startIndex[r + 1]; k++) {
+					if(dependency[k] <= nVars) fmi2_import_dependency_index_add(idx, pass, fill, last, dependency[k] - 1, r);
+				}
+			}
+		}
+		if(pass == 0) {
+			for(v = 0; v < nVars; v++) {
+				idx->startIndex[v + 1] += idx->startIndex[v];
+				fill[v] = idx->startIndex[v];
+			}
+			idx->dependent = (size_t*)cb->calloc(idx->startIndex[nVars] ? idx->startIndex[nVars] : 1, sizeof(size_t));
+			if(!idx->dependent) goto fail;
+		}
+	}
+
+	cb->free(fill);
+	cb->free(last);
+	cb->free(isKnown);
+	return idx;
+
+fail:
+	jm_log_fatal(cb, module, "Could not allocate memory");
+	cb->free(fill);
+	cb->free(last);
+	cb->free(isKnown);
+	fmi2_import_free_dependency_index(cb, idx);
+	return 0;
+}
+
+static fmi2_import_dependency_index_t* fmi2_import_get_dependency_index(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind) {
+	if(!fmi2_import_check_has_FMU(fmu)) return 0;
+	if((unsigned)kind >= sizeof(fmu->dependencyIndex)/sizeof(fmu->dependencyIndex[0])) {
+		jm_log_error(fmu->callbacks, module, "Unknown dependency kind %d", (int)kind);
+		return 0;
+	}
+	if(!fmu->dependencyIndex[kind]) {
+		fmu->dependencyIndex[kind] = fmi2_import_build_dependency_index(fmu, kind);
+	}
+	return fmu->dependencyIndex[kind];
+}
+
+static jm_status_enu_t fmi2_import_build_dependency_bitsets(jm_callbacks* cb, fmi2_import_dependency_index_t* idx) {
+	size_t v, k;
+	if(idx->bits) return jm_status_success;
+	if(idx->bitsTooLarge) return jm_status_warning;
+	if(idx->nWords && (idx->nVars > FMI2_IMPORT_DEPENDENCY_BITSET_MAX_BYTES / sizeof(size_t) / idx->nWords)) {
+		idx->bitsTooLarge = 1;
+		return jm_status_warning;
+	}
+	idx->bits = (size_t*)cb->calloc((idx->nVars && idx->nWords) ? idx->nVars * idx->nWords : 1, sizeof(size_t));
+	if(!idx->bits) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	for(v = 0; v < idx->nVars; v++) {
+		size_t* col = idx->bits + v * idx->nWords;
+		for(k = idx->startIndex[v]; k < idx->startIndex[v + 1]; k++) {
+			size_t r = idx->dependent[k];
+			col[r / FMI2_DEPENDENCY_WORD_BITS] |= ((size_t)1) << (r % FMI2_DEPENDENCY_WORD_BITS);
+		}
+	}
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_get_dependents(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind, size_t** startIndex, size_t** dependent) {
+	fmi2_import_dependency_index_t* idx = fmi2_import_get_dependency_index(fmu, kind);
+	if(!idx) {
+		*startIndex = 0;
+		*dependent = 0;
+		return jm_status_error;
+	}
+	*startIndex = idx->startIndex;
+	*dependent = idx->dependent;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_get_dependency_bitsets(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind, size_t* nWords, const size_t** bits) {
+	fmi2_import_dependency_index_t* idx = fmi2_import_get_dependency_index(fmu, kind);
+	jm_status_enu_t status;
+	*nWords = 0;
+	*bits = 0;
+	if(!idx) return jm_status_error;
+	status = fmi2_import_build_dependency_bitsets(fmu->callbacks, idx);
+	if(status == jm_status_success) {
+		*nWords = idx->nWords;
+		*bits = idx->bits;
+	}
+	return status;
+}
+
+/* Combine the bitset columns of the knowns word by word and expand the result into indices.
+   The index is only read, so that queries may run concurrently. */
+static size_t fmi2_import_combine_dependency_bitsets(fmi2_import_dependency_index_t* idx, const size_t knowns[], size_t nKnowns,
+                                                      int intersect, size_t unknowns[]) {
+	size_t nWords = idx->nWords;
+	size_t i, w, n = 0;
+
+	for(w = 0; w < nWords; w++) {
+		size_t word = idx->bits[knowns[0] * nWords + w];
+		size_t b = 0;
+		for(i = 1; i < nKnowns; i++) {
+			if(intersect)
+				word &= idx->bits[knowns[i] * nWords + w];
+			else
+				word |= idx->bits[knowns[i] * nWords + w];
+		}
+		while(word) {
+			if(word & 1) unknowns[n++] = w * FMI2_DEPENDENCY_WORD_BITS + b;
+			word >>= 1;
+			b++;
+		}
+	}
+	return n;
+}
+
+static int fmi2_import_check_knowns(fmi2_import_t* fmu, fmi2_import_dependency_index_t* idx, const size_t knowns[], size_t nKnowns) {
+	size_t i;
+	for(i = 0; i < nKnowns; i++) {
+		if(knowns[i] >= idx->nVars) {
+			jm_log_error(fmu->callbacks, module, "Variable index %u is out of range", (unsigned)knowns[i]);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+size_t fmi2_import_get_dependents_union(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind,
+                                        const size_t knowns[], size_t nKnowns, size_t unknowns[]) {
+	fmi2_import_dependency_index_t* idx = fmi2_import_get_dependency_index(fmu, kind);
+	size_t i, k, n = 0;
+
+	if(!idx || !nKnowns || !fmi2_import_check_knowns(fmu, idx, knowns, nKnowns)) return 0;
+	if(idx->bits)
+		return fmi2_import_combine_dependency_bitsets(idx, knowns, nKnowns, 0, unknowns);
+
+	/* columns are sorted, so merge them one by one into the sorted union. The merge runs backwards
+	   in place, after counting the size of the result, so that no scratch memory is needed. */
+	for(i = 0; i < nKnowns; i++) {
+		const size_t* col = idx->dependent + idx->startIndex[knowns[i]];
+		size_t nCol = idx->startIndex[knowns[i] + 1] - idx->startIndex[knowns[i]];
+		size_t a = 0, b = 0, m = 0;
+		while(a < n || b < nCol) {
+			if(b == nCol || (a < n && unknowns[a] < col[b])) a++;
+			else if(a == n || unknowns[a] > col[b]) b++;
+			else {
+				a++;
+				b++;
+			}
+			m++;
+		}
+		for(k = m; k > 0; k--) {
+			if(b > 0 && (a == 0 || col[b - 1] > unknowns[a - 1]))
+				unknowns[k - 1] = col[--b];
+			else {
+				if(b > 0 && col[b - 1] == unknowns[a - 1]) b--;
+				unknowns[k - 1] = unknowns[--a];
+			}
+		}
+		n = m;
+	}
+	return n;
+}
+
+size_t fmi2_import_get_dependents_intersection(fmi2_import_t* fmu, fmi2_import_dependency_kind_enu_t kind,
+                                               const size_t knowns[], size_t nKnowns, size_t unknowns[]) {
+	fmi2_import_dependency_index_t* idx = fmi2_import_get_dependency_index(fmu, kind);
+	size_t i, k, n;
+
+	if(!idx || !nKnowns || !fmi2_import_check_knowns(fmu, idx, knowns, nKnowns)) return 0;
+	if(idx->bits)
+		return fmi2_import_combine_dependency_bitsets(idx, knowns, nKnowns, 1, unknowns);
+
+	/* columns are sorted, so intersect them pairwise in place */
+	n = 0;
+	for(k = idx->startIndex[knowns[0]]; k < idx->startIndex[knowns[0] + 1]; k++) unknowns[n++] = idx->dependent[k];
+	for(i = 1; i < nKnowns && n; i++) {
+		const size_t* col = idx->dependent + idx->startIndex[knowns[i]];
+		size_t nCol = idx->startIndex[knowns[i] + 1] - idx->startIndex[knowns[i]];
+		size_t a = 0, b = 0, m = 0;
+		while(a < n && b < nCol) {
+			if(unknowns[a] < col[b]) a++;
+			else if(unknowns[a] > col[b]) b++;
+			else {
+				unknowns[m++] = unknowns[a];
+				a++;
+				b++;
+			}
+		}
+		n = m;
+	}
+	return n;
+}
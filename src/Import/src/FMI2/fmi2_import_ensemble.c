@@ -0,0 +1,475 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <JM/jm_portability.h>
+#include <JM/jm_thread.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_ENSEMBLE_WORST(a, b) (((b) > (a)) ? (b) : (a))
+
+/* Position of a variable of a list in the buffers of an I/O plan */
+typedef struct fmi2_import_ensemble_slot_t {
+	fmi2_base_type_enu_t type;
+	size_t index;
+} fmi2_import_ensemble_slot_t;
+
+typedef struct fmi2_import_ensemble_worker_t {
+	fmi2_import_ensemble_t* ensemble;
+	size_t index;
+	jm_thread_t thread;
+
+	fmi2_import_instance_t* instance;
+	fmi2_import_t* view; /* the FMU object of the instance, for the plans and the solver */
+	int instantiated;
+	fmi2_import_io_plan_t* parameters;
+	fmi2_import_io_plan_t* outputs;
+	fmi_import_solver_t* solver;
+	fmi2_real_t* outputValues;
+
+	fmi2_status_t status; /* worst of the runs of the current call */
+	fmi2_import_ensemble_stats_t stats;
+} fmi2_import_ensemble_worker_t;
+
+struct fmi2_import_ensemble_t {
+	jm_callbacks* callbacks;
+	fmi2_import_t* fmu;
+	fmi2_fmu_kind_enu_t kind;
+
+	fmi2_import_ensemble_slot_t* parameterSlots;
+	size_t parametersNum;
+	fmi2_import_ensemble_slot_t* outputSlots;
+	size_t outputsNum;
+
+	fmi2_real_t startTime;
+	fmi2_real_t stopTime;
+	fmi2_real_t stepSize;
+	fmi_import_solver_method_enu_t method;
+	fmi2_real_t tolerance;
+	fmi2_import_ensemble_sink_ft sink;
+	void* sinkData;
+	int pinThreads;
+
+	fmi2_import_ensemble_worker_t* workers;
+	size_t workersNum;
+
+	/* the current call of fmi2_import_ensemble_run() */
+	jm_mutex_t lock;
+	const fmi2_real_t* values;
+	size_t runsNum;
+	size_t nextRun; /* protected by lock */
+	fmi2_status_t* runStatus;
+};
+
+/* Find the buffer position of each variable of a list */
+static fmi2_import_ensemble_slot_t* fmi2_import_ensemble_map(jm_callbacks* cb, fmi2_import_io_plan_t* plan, fmi2_import_variable_list_t* vl, size_t* num) {
+	fmi2_import_ensemble_slot_t* slots;
+	size_t i, n = vl ? fmi2_import_get_variable_list_size(vl) : 0;
+
+	*num = n;
+	slots = (fmi2_import_ensemble_slot_t*)cb->calloc(n ? n : 1, sizeof(fmi2_import_ensemble_slot_t));
+	if(!slots) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	for(i = 0; i < n; i++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, i);
+		slots[i].type = fmi2_import_get_variable_base_type(v);
+		if(slots[i].type == fmi2_base_type_str) {
+			jm_log_error(cb, module, "String variable '%s' is not supported in an ensemble", fmi2_import_get_variable_name(v));
+			cb->free(slots);
+			return 0;
+		}
+		if(slots[i].type == fmi2_base_type_enum) slots[i].type = fmi2_base_type_int;
+		slots[i].index = plan ? fmi2_import_io_plan_get_value_index(plan, i) : 0;
+	}
+	return slots;
+}
+
+static fmi2_import_io_plan_t* fmi2_import_ensemble_plan(fmi2_import_t* view, fmi2_import_variable_list_t* vl) {
+	return (vl && fmi2_import_get_variable_list_size(vl)) ? fmi2_import_io_plan_allocate(view, vl, fmi2_import_io_no_conversion) : 0;
+}
+
+static jm_status_enu_t fmi2_import_ensemble_init_worker(fmi2_import_ensemble_t* e, fmi2_import_ensemble_worker_t* w,
+	fmi2_import_variable_list_t* parameters, fmi2_import_variable_list_t* outputs) {
+	jm_callbacks* cb = e->callbacks;
+
+	w->ensemble = e;
+	w->instance = fmi2_import_instance_allocate(e->fmu, NULL);
+	if(!w->instance) return jm_status_error;
+	w->view = fmi2_import_instance_get_view(w->instance);
+	w->parameters = fmi2_import_ensemble_plan(w->view, parameters);
+	w->outputs = fmi2_import_ensemble_plan(w->view, outputs);
+	if((e->parametersNum && !w->parameters) || (e->outputsNum && !w->outputs)) return jm_status_error;
+	if(e->kind == fmi2_fmu_kind_me) {
+		w->solver = fmi2_import_solver_allocate(w->view, e->method);
+		if(!w->solver) return jm_status_error;
+	}
+	w->outputValues = (fmi2_real_t*)cb->calloc(e->outputsNum ? e->outputsNum : 1, sizeof(fmi2_real_t));
+	if(!w->outputValues) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+static void fmi2_import_ensemble_free_worker(fmi2_import_ensemble_t* e, fmi2_import_ensemble_worker_t* w) {
+	fmi_import_solver_free(w->solver);
+	fmi2_import_io_plan_free(w->parameters);
+	fmi2_import_io_plan_free(w->outputs);
+	if(w->instance) fmi2_import_instance_free(w->instance);
+	e->callbacks->free(w->outputValues);
+}
+
+fmi2_import_ensemble_t* fmi2_import_ensemble_allocate(fmi2_import_t* fmu, fmi2_import_variable_list_t* parameters,
+                                                      fmi2_import_variable_list_t* outputs, size_t threadsNum) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_import_ensemble_t* e;
+	fmi2_import_io_plan_t* plan;
+	size_t i;
+
+	if(!fmu->capi) {
+		jm_log_error(cb, module, "FMU CAPI is not loaded");
+		return 0;
+	}
+	if(threadsNum == 0) threadsNum = jm_thread_get_cpus_num();
+	if(threadsNum > 1 && fmi2_import_get_capability(fmu, (fmu->capi->standard == fmi2_fmu_kind_me) ?
+			fmi2_me_canBeInstantiatedOnlyOncePerProcess : fmi2_cs_canBeInstantiatedOnlyOncePerProcess)) {
+		jm_log_warning(cb, module, "The FMU can only be instantiated once per process, the ensemble uses one thread");
+		threadsNum = 1;
+	}
+
+	e = (fmi2_import_ensemble_t*)cb->calloc(1, sizeof(fmi2_import_ensemble_t));
+	if(!e) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	e->callbacks = cb;
+	e->fmu = fmu;
+	e->kind = fmu->capi->standard;
+	/* the same defaults as returned by the default experiment functions, without their warnings */
+	e->startTime = fmi2_import_get_default_experiment_has_start(fmu) ? fmi2_import_get_default_experiment_start(fmu) : 0.0;
+	e->stopTime = fmi2_import_get_default_experiment_has_stop(fmu) ? fmi2_import_get_default_experiment_stop(fmu) : 1.0;
+	e->stepSize = fmi2_import_get_default_experiment_has_step(fmu) ? fmi2_import_get_default_experiment_step(fmu) : 1e-2;
+	e->tolerance = fmi2_import_get_default_experiment_has_tolerance(fmu) ? fmi2_import_get_default_experiment_tolerance(fmu) : 1e-4;
+	e->method = fmi_import_solver_dopri5;
+	jm_mutex_init(&e->lock);
+
+	/* the buffer positions only depend on the variable lists, so one plan is enough to find them */
+	plan = fmi2_import_ensemble_plan(fmu, parameters);
+	e->parameterSlots = fmi2_import_ensemble_map(cb, plan, parameters, &e->parametersNum);
+	fmi2_import_io_plan_free(plan);
+	plan = fmi2_import_ensemble_plan(fmu, outputs);
+	e->outputSlots = fmi2_import_ensemble_map(cb, plan, outputs, &e->outputsNum);
+	fmi2_import_io_plan_free(plan);
+	e->workers = (fmi2_import_ensemble_worker_t*)cb->calloc(threadsNum, sizeof(fmi2_import_ensemble_worker_t));
+	if(!e->parameterSlots || !e->outputSlots || !e->workers) {
+		if(!e->workers) jm_log_fatal(cb, module, "Could not allocate memory");
+		fmi2_import_ensemble_free(e);
+		return 0;
+	}
+	for(i = 0; i < threadsNum; i++) {
+		e->workers[i].index = i;
+		e->workersNum++;
+		if(fmi2_import_ensemble_init_worker(e, &e->workers[i], parameters, outputs) != jm_status_success) {
+			fmi2_import_ensemble_free(e);
+			return 0;
+		}
+	}
+	jm_log_verbose(cb, module, "Created ensemble with %u workers", (unsigned)threadsNum);
+	return e;
+}
+
+void fmi2_import_ensemble_free(fmi2_import_ensemble_t* e) {
+	jm_callbacks* cb;
+	size_t i;
+	if(!e) return;
+	cb = e->callbacks;
+	for(i = 0; i < e->workersNum; i++) {
+		fmi2_import_ensemble_free_worker(e, &e->workers[i]);
+	}
+	jm_mutex_destroy(&e->lock);
+	cb->free(e->workers);
+	cb->free(e->parameterSlots);
+	cb->free(e->outputSlots);
+	cb->free(e);
+}
+
+jm_status_enu_t fmi2_import_ensemble_set_experiment(fmi2_import_ensemble_t* e, fmi2_real_t startTime, fmi2_real_t stopTime, fmi2_real_t stepSize) {
+	if(!(stopTime > startTime) || !(stepSize > 0)) {
+		jm_log_error(e->callbacks, module, "Invalid experiment: start %g, stop %g, step size %g", startTime, stopTime, stepSize);
+		return jm_status_error;
+	}
+	e->startTime = startTime;
+	e->stopTime = stopTime;
+	e->stepSize = stepSize;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_ensemble_set_solver(fmi2_import_ensemble_t* e, fmi_import_solver_method_enu_t method, fmi2_real_t relativeTolerance) {
+	size_t i;
+	if(!(relativeTolerance > 0)) {
+		jm_log_error(e->callbacks, module, "The tolerance must be positive");
+		return jm_status_error;
+	}
+	if(e->kind != fmi2_fmu_kind_me) {
+		jm_log_error(e->callbacks, module, "A solver is only used for model exchange FMUs");
+		return jm_status_error;
+	}
+	for(i = 0; i < e->workersNum; i++) {
+		fmi2_import_ensemble_worker_t* w = &e->workers[i];
+		fmi_import_solver_t* s = fmi2_import_solver_allocate(w->view, method);
+		if(!s) return jm_status_error;
+		fmi_import_solver_free(w->solver);
+		w->solver = s;
+	}
+	e->method = method;
+	e->tolerance = relativeTolerance;
+	return jm_status_success;
+}
+
+void fmi2_import_ensemble_set_sink(fmi2_import_ensemble_t* e, fmi2_import_ensemble_sink_ft sink, void* userData) {
+	e->sink = sink;
+	e->sinkData = userData;
+}
+
+void fmi2_import_ensemble_set_pinning(fmi2_import_ensemble_t* e, int pinThreads) {
+	e->pinThreads = pinThreads;
+}
+
+size_t fmi2_import_ensemble_get_threads_num(fmi2_import_ensemble_t* e) {
+	return e->workersNum;
+}
+
+/* ------------------------------------------------------------------ */
+/* Runs */
+
+static fmi2_status_t fmi2_import_ensemble_set_parameters(fmi2_import_ensemble_worker_t* w, size_t run) {
+	fmi2_import_ensemble_t* e = w->ensemble;
+	const fmi2_real_t* row;
+	fmi2_real_t* reals;
+	fmi2_integer_t* integers;
+	fmi2_boolean_t* booleans;
+	size_t i;
+
+	if(!e->parametersNum) return fmi2_status_ok;
+	row = e->values + run * e->parametersNum;
+	reals = fmi2_import_io_plan_get_real_values(w->parameters);
+	integers = fmi2_import_io_plan_get_integer_values(w->parameters);
+	booleans = fmi2_import_io_plan_get_boolean_values(w->parameters);
+	for(i = 0; i < e->parametersNum; i++) {
+		const fmi2_import_ensemble_slot_t* slot = &e->parameterSlots[i];
+		switch(slot->type) {
+		case fmi2_base_type_real: reals[slot->index] = row[i]; break;
+		case fmi2_base_type_int: integers[slot->index] = (fmi2_integer_t)floor(row[i] + 0.5); break;
+		default: booleans[slot->index] = (row[i] != 0) ? fmi2_true : fmi2_false; break;
+		}
+	}
+	return fmi2_import_io_plan_set(w->parameters);
+}
+
+static fmi2_status_t fmi2_import_ensemble_output(fmi2_import_ensemble_worker_t* w, size_t run, fmi2_real_t time) {
+	fmi2_import_ensemble_t* e = w->ensemble;
+	fmi2_status_t status = fmi2_status_ok;
+	size_t i;
+
+	if(!e->sink) return status;
+	if(e->outputsNum) {
+		const fmi2_real_t* reals = fmi2_import_io_plan_get_real_values(w->outputs);
+		const fmi2_integer_t* integers = fmi2_import_io_plan_get_integer_values(w->outputs);
+		const fmi2_boolean_t* booleans = fmi2_import_io_plan_get_boolean_values(w->outputs);
+		status = fmi2_import_io_plan_get(w->outputs);
+		for(i = 0; i < e->outputsNum; i++) {
+			const fmi2_import_ensemble_slot_t* slot = &e->outputSlots[i];
+			switch(slot->type) {
+			case fmi2_base_type_real: w->outputValues[i] = reals[slot->index]; break;
+			case fmi2_base_type_int: w->outputValues[i] = (fmi2_real_t)integers[slot->index]; break;
+			default: w->outputValues[i] = booleans[slot->index] ? 1.0 : 0.0; break;
+			}
+		}
+	}
+	e->sink(e->sinkData, run, time, w->outputValues, e->outputsNum);
+	return status;
+}
+
+/* Instantiate or reset, initialize and set the parameters */
+static fmi2_status_t fmi2_import_ensemble_setup(fmi2_import_ensemble_worker_t* w, size_t run) {
+	fmi2_import_ensemble_t* e = w->ensemble;
+	fmi2_import_t* view = w->view;
+	fmi2_status_t status = fmi2_status_ok;
+
+	if(!w->instantiated) {
+		char name[64];
+		sprintf(name, "ensemble%u", (unsigned)w->index);
+		if(fmi2_import_instantiate(view, name, (e->kind == fmi2_fmu_kind_me) ? fmi2_model_exchange : fmi2_cosimulation,
+				NULL, fmi2_false) != jm_status_success) {
+			return fmi2_status_error;
+		}
+		w->instantiated = 1;
+		w->stats.instancesNum++;
+	}
+	else {
+		status = fmi2_import_reset(view);
+		w->stats.resetsNum++;
+	}
+	if(status <= fmi2_status_warning) {
+		status = FMI2_ENSEMBLE_WORST(status, fmi2_import_setup_experiment(view, fmi2_true, e->tolerance, e->startTime, fmi2_true, e->stopTime));
+	}
+	if(status <= fmi2_status_warning) {
+		status = FMI2_ENSEMBLE_WORST(status, fmi2_import_enter_initialization_mode(view));
+	}
+	if(status <= fmi2_status_warning) {
+		status = FMI2_ENSEMBLE_WORST(status, fmi2_import_ensemble_set_parameters(w, run));
+	}
+	if(status <= fmi2_status_warning) {
+		status = FMI2_ENSEMBLE_WORST(status, fmi2_import_exit_initialization_mode(view));
+	}
+	if(status <= fmi2_status_warning && w->solver) {
+		if(e->method == fmi_import_solver_dopri5) fmi_import_solver_set_tolerance(w->solver, e->tolerance);
+		else fmi_import_solver_set_step_size(w->solver, e->stepSize);
+		status = FMI2_ENSEMBLE_WORST(status, fmi2_import_solver_initialize(w->solver, e->startTime));
+	}
+	return status;
+}
+
+static fmi2_status_t fmi2_import_ensemble_simulate(fmi2_import_ensemble_worker_t* w, size_t run) {
+	fmi2_import_ensemble_t* e = w->ensemble;
+	fmi2_status_t status = fmi2_import_ensemble_output(w, run, e->startTime);
+	fmi2_real_t time = e->startTime;
+	size_t k;
+
+	/* output points are computed from the start time so that rounding errors do not accumulate */
+	for(k = 1; status <= fmi2_status_warning && time < e->stopTime; k++) {
+		fmi2_real_t next = e->startTime + (fmi2_real_t)k * e->stepSize;
+		if(next > e->stopTime - 1e-9 * e->stepSize) next = e->stopTime;
+		if(w->solver) {
+			status = FMI2_ENSEMBLE_WORST(status, (fmi2_status_t)fmi_import_solver_integrate(w->solver, next));
+			next = fmi_import_solver_get_time(w->solver);
+		}
+		else {
+			status = FMI2_ENSEMBLE_WORST(status, fmi2_import_do_step(w->view, time, next - time, fmi2_true));
+		}
+		time = next;
+		w->stats.stepsNum++;
+		if(status <= fmi2_status_warning) {
+			status = FMI2_ENSEMBLE_WORST(status, fmi2_import_ensemble_output(w, run, time));
+		}
+		if(w->solver && fmi_import_solver_is_terminated(w->solver)) break;
+	}
+	return status;
+}
+
+static fmi2_status_t fmi2_import_ensemble_run_one(fmi2_import_ensemble_worker_t* w, size_t run) {
+	double start = jm_portability_get_time(), setupEnd;
+	fmi2_status_t status = fmi2_import_ensemble_setup(w, run);
+
+	setupEnd = jm_portability_get_time();
+	w->stats.setupSeconds += setupEnd - start;
+	if(status <= fmi2_status_warning) {
+		status = fmi2_import_ensemble_simulate(w, run);
+	}
+	if(status <= fmi2_status_warning) {
+		status = FMI2_ENSEMBLE_WORST(status, fmi2_import_terminate(w->view));
+	}
+	w->stats.simulationSeconds += jm_portability_get_time() - setupEnd;
+	w->stats.runsNum++;
+	if(status > fmi2_status_warning) {
+		jm_log_error(w->view->callbacks, module, "Run %u failed with status %s", (unsigned)run, fmi2_status_to_string(status));
+		w->stats.failedRunsNum++;
+		/* the component may be unusable after an error; the next run instantiates a new one */
+		if(w->instantiated) {
+			fmi2_import_free_instance(w->view);
+			w->instantiated = 0;
+		}
+	}
+	return status;
+}
+
+static void fmi2_import_ensemble_worker(void* arg) {
+	fmi2_import_ensemble_worker_t* w = (fmi2_import_ensemble_worker_t*)arg;
+	fmi2_import_ensemble_t* e = w->ensemble;
+
+	if(e->pinThreads && jm_thread_pin_current(w->index % jm_thread_get_cpus_num()) != jm_status_success) {
+		jm_log_verbose(w->view->callbacks, module, "Could not pin worker %u", (unsigned)w->index);
+	}
+	for(;;) {
+		fmi2_status_t status;
+		size_t run;
+
+		jm_mutex_lock(&e->lock);
+		run = e->nextRun++;
+		jm_mutex_unlock(&e->lock);
+		if(run >= e->runsNum) break;
+
+		status = fmi2_import_ensemble_run_one(w, run);
+		if(e->runStatus) e->runStatus[run] = status;
+		w->status = FMI2_ENSEMBLE_WORST(w->status, status);
+	}
+}
+
+fmi2_status_t fmi2_import_ensemble_run(fmi2_import_ensemble_t* e, const fmi2_real_t values[], size_t runsNum, fmi2_status_t runStatus[]) {
+	fmi2_status_t status = fmi2_status_ok;
+	size_t i, started = 0;
+
+	if(runsNum == 0) return status;
+	if(e->parametersNum && !values) {
+		jm_log_error(e->callbacks, module, "No parameter values given");
+		return fmi2_status_error;
+	}
+	e->values = values;
+	e->runsNum = runsNum;
+	e->nextRun = 0;
+	e->runStatus = runStatus;
+
+	/* the calling thread only waits, so that pinning never changes its affinity */
+	for(i = 0; i < e->workersNum; i++) {
+		fmi2_import_ensemble_worker_t* w = &e->workers[i];
+		w->status = fmi2_status_ok;
+		if(jm_thread_create(&w->thread, fmi2_import_ensemble_worker, w) != jm_status_success) {
+			jm_log_error(e->callbacks, module, "Could not start worker thread");
+			break;
+		}
+		started++;
+	}
+	if(!started) {
+		return fmi2_status_error;
+	}
+	for(i = 0; i < started; i++) {
+		jm_thread_join(&e->workers[i].thread);
+		status = FMI2_ENSEMBLE_WORST(status, e->workers[i].status);
+	}
+	return status;
+}
+
+void fmi2_import_ensemble_get_stats(fmi2_import_ensemble_t* e, fmi2_import_ensemble_stats_t* stats) {
+	size_t i;
+	memset(stats, 0, sizeof(*stats));
+	for(i = 0; i < e->workersNum; i++) {
+		const fmi2_import_ensemble_stats_t* s = &e->workers[i].stats;
+		stats->runsNum += s->runsNum;
+		stats->failedRunsNum += s->failedRunsNum;
+		stats->instancesNum += s->instancesNum;
+		stats->resetsNum += s->resetsNum;
+		stats->stepsNum += s->stepsNum;
+		stats->setupSeconds += s->setupSeconds;
+		stats->simulationSeconds += s->simulationSeconds;
+	}
+}
@@ -33,16 +33,24 @@
 extern "C" {
 #endif
 
+typedef struct fmi2_import_dependency_index_t fmi2_import_dependency_index_t;
+
 struct fmi2_import_t {	
 	char* dirPath;
 	char* resourceLocation;
 	jm_callbacks* callbacks;
 	fmi2_xml_model_description_t* md;
 	fmi2_capi_t* capi;
-	jm_vector(char) logMessageBufferCoded;
-	jm_vector(char) logMessageBufferExpanded;
+	int isolateBinary;
+	char* hostPath; /* host executable running the binary out of process, or NULL */
+	fmi2_import_dependency_index_t* dependencyIndex[3];
+	fmi2_import_async_step_t* asyncStep;
 };
 
+int fmi2_import_check_has_FMU(fmi2_import_t* fmu);
+
+void fmi2_import_free_dependency_index(jm_callbacks* cb, fmi2_import_dependency_index_t* idx);
+
 #ifdef __cplusplus
 }
 #endif
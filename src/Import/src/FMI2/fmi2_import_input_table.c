@@ -0,0 +1,600 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <JM/jm_portability.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_INPUT_TABLE_MAGIC "FMILTAB\n"
+#define FMI2_INPUT_TABLE_VERSION 1
+/* Magic, version, channels, samples and size of the names */
+#define FMI2_INPUT_TABLE_HEADER_SIZE (8 + 4 * sizeof(unsigned int))
+
+#define FMI2_INPUT_TABLE_WORST(a, b) (((b) > (a)) ? (b) : (a))
+
+struct fmi2_import_input_table_t {
+	jm_callbacks* callbacks;
+	size_t channelsNum;
+	size_t samplesNum;
+	char** names;
+
+	/* samplesNum times and samplesNum rows of channelsNum values, owned or in the mapping */
+	const fmi2_real_t* time;
+	const fmi2_real_t* rows;
+	fmi2_real_t* ownedTime;
+	fmi2_real_t* ownedRows;
+	jm_mapped_file_t map;
+
+	fmi2_import_input_interpolation_enu_t interpolation;
+	size_t cursor;          /* last sample at or before the last evaluated time */
+
+	/* connection to an FMU */
+	fmi2_import_t* fmu;
+	size_t boundNum;
+	size_t* boundChannel;
+	fmi2_value_reference_t* boundVr;
+	size_t derivativesNum;  /* the first derivativesNum connections are inputs */
+	fmi2_integer_t* order;
+	fmi2_real_t* values;    /* all channels */
+	fmi2_real_t* slopes;
+	fmi2_real_t* boundValues;
+};
+
+static fmi2_import_input_table_t* fmi2_input_table_create(jm_callbacks* cb, size_t channelsNum) {
+	fmi2_import_input_table_t* t = (fmi2_import_input_table_t*)cb->calloc(1, sizeof(fmi2_import_input_table_t));
+	if(t) t->names = (char**)cb->calloc(channelsNum, sizeof(char*));
+	if(!t || !t->names) {
+		if(t) cb->free(t);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	t->callbacks = cb;
+	t->channelsNum = channelsNum;
+	t->interpolation = fmi2_import_input_linear;
+	return t;
+}
+
+static void fmi2_input_table_unbind(fmi2_import_input_table_t* t) {
+	jm_callbacks* cb = t->callbacks;
+	cb->free(t->boundChannel);
+	cb->free(t->boundVr);
+	cb->free(t->order);
+	cb->free(t->values);
+	cb->free(t->slopes);
+	cb->free(t->boundValues);
+	t->boundChannel = 0;
+	t->boundVr = 0;
+	t->order = 0;
+	t->values = 0;
+	t->slopes = 0;
+	t->boundValues = 0;
+	t->boundNum = 0;
+	t->derivativesNum = 0;
+	t->fmu = 0;
+}
+
+void fmi2_import_input_table_free(fmi2_import_input_table_t* t) {
+	jm_callbacks* cb;
+	size_t i;
+	if(!t) return;
+	cb = t->callbacks;
+	fmi2_input_table_unbind(t);
+	for(i = 0; i < t->channelsNum; i++) cb->free(t->names[i]);
+	cb->free(t->names);
+	cb->free(t->ownedTime);
+	cb->free(t->ownedRows);
+	jm_unmap_file(&t->map);
+	cb->free(t);
+}
+
+static char* fmi2_input_table_strdup(jm_callbacks* cb, const char* s, size_t len) {
+	char* copy = (char*)cb->malloc(len + 1);
+	if(copy) {
+		memcpy(copy, s, len);
+		copy[len] = 0;
+	}
+	return copy;
+}
+
+/* Check that the times do not decrease */
+static int fmi2_input_table_check_time(fmi2_import_input_table_t* t, const char* fileName) {
+	size_t i;
+	for(i = 1; i < t->samplesNum; i++) {
+		if(t->time[i] < t->time[i - 1]) {
+			jm_log_error(t->callbacks, module, "The time decreases at sample %u in '%s'", (unsigned)(i + 1), fileName);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Read a whole text file into a terminated buffer */
+static char* fmi2_input_table_read_text(jm_callbacks* cb, const char* fileName) {
+	FILE* f = fopen(fileName, "rb");
+	char* text = 0;
+	long size;
+	if(!f) {
+		jm_log_error(cb, module, "Could not open the input file '%s'", fileName);
+		return 0;
+	}
+	if(fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+		text = (char*)cb->malloc((size_t)size + 1);
+		if(text && fread(text, 1, (size_t)size, f) == (size_t)size) {
+			text[size] = 0;
+		}
+		else {
+			cb->free(text);
+			text = 0;
+		}
+	}
+	fclose(f);
+	if(!text) jm_log_error(cb, module, "Could not read the input file '%s'", fileName);
+	return text;
+}
+
+static const char* fmi2_input_table_skip_blanks(const char* p) {
+	while(*p == ' ') p++;
+	return p;
+}
+
+/* Copy the names of the header line, without quotes and blanks. Returns the start of the next line or NULL. */
+static const char* fmi2_input_table_parse_names(fmi2_import_input_table_t* t, const char* p, char sep) {
+	size_t i;
+	/* the name of the time column is not used */
+	while(*p && *p != sep && *p != '\n') p++;
+	for(i = 0; i < t->channelsNum; i++) {
+		const char *start, *end;
+		p = fmi2_input_table_skip_blanks(p + 1);
+		start = p;
+		while(*p && *p != sep && *p != '\n' && *p != '\r') p++;
+		end = p;
+		while(end > start && end[-1] == ' ') end--;
+		if(end - start >= 2 && *start == '"' && end[-1] == '"') {
+			start++;
+			end--;
+		}
+		t->names[i] = fmi2_input_table_strdup(t->callbacks, start, (size_t)(end - start));
+		if(!t->names[i]) return 0;
+		while(*p == '\r') p++;
+	}
+	return (*p == '\n') ? p + 1 : p;
+}
+
+/* Make room for one more sample */
+static int fmi2_input_table_grow(fmi2_import_input_table_t* t, size_t* capacity) {
+	fmi2_real_t* p;
+	size_t n = *capacity ? 2 * *capacity : 1024;
+	if(t->samplesNum < *capacity) return 1;
+	p = (fmi2_real_t*)t->callbacks->realloc(t->ownedTime, n * sizeof(fmi2_real_t));
+	if(!p) return 0;
+	t->ownedTime = p;
+	p = (fmi2_real_t*)t->callbacks->realloc(t->ownedRows, n * t->channelsNum * sizeof(fmi2_real_t));
+	if(!p) return 0;
+	t->ownedRows = p;
+	*capacity = n;
+	return 1;
+}
+
+fmi2_import_input_table_t* fmi2_import_input_table_load_csv(jm_callbacks* cb, const char* fileName) {
+	fmi2_import_input_table_t* t = 0;
+	jm_locale_t* locale;
+	const char *p, *eol;
+	char* text = fmi2_input_table_read_text(cb, fileName);
+	char sep = ',';
+	size_t channelsNum = 0, capacity = 0, line = 1;
+	int ok = 0;
+
+	if(!text) return 0;
+	eol = strchr(text, '\n');
+	if(!eol) eol = text + strlen(text);
+	for(p = text; p < eol; p++) {
+		if(*p == ',' || *p == ';' || *p == '\t') {
+			sep = *p;
+			break;
+		}
+	}
+	for(; p < eol; p++) {
+		if(*p == sep) channelsNum++;
+	}
+	if(!channelsNum) {
+		jm_log_error(cb, module, "The input file '%s' has no channels", fileName);
+		cb->free(text);
+		return 0;
+	}
+	t = fmi2_input_table_create(cb, channelsNum);
+	if(!t) {
+		cb->free(text);
+		return 0;
+	}
+	p = fmi2_input_table_parse_names(t, text, sep);
+	if(!p) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(text);
+		fmi2_import_input_table_free(t);
+		return 0;
+	}
+
+	/* parse the numbers independently of the locale of the environment */
+	locale = jm_setlocale_numeric(cb, "C");
+	while(*p) {
+		fmi2_real_t* row;
+		char* end;
+		size_t c;
+
+		line++;
+		p = fmi2_input_table_skip_blanks(p);
+		if(*p == '\r' || *p == '\n') {
+			while(*p == '\r') p++;
+			if(*p == '\n') p++;
+			continue;
+		}
+		if(!fmi2_input_table_grow(t, &capacity)) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			goto done;
+		}
+		row = t->ownedRows + t->samplesNum * channelsNum;
+		for(c = 0; c <= channelsNum; c++) {
+			double v = strtod(p, &end);
+			if(end == p) {
+				jm_log_error(cb, module, "Invalid number on line %u of '%s'", (unsigned)line, fileName);
+				goto done;
+			}
+			if(c == 0) t->ownedTime[t->samplesNum] = v;
+			else row[c - 1] = v;
+			p = fmi2_input_table_skip_blanks(end);
+			if(c < channelsNum) {
+				if(*p != sep) {
+					jm_log_error(cb, module, "Line %u of '%s' has %u values but %u were expected", (unsigned)line, fileName,
+						(unsigned)c + 1, (unsigned)channelsNum + 1);
+					goto done;
+				}
+				p++;
+			}
+		}
+		while(*p == '\r') p++;
+		if(*p && *p != '\n') {
+			jm_log_error(cb, module, "Line %u of '%s' has more than %u values", (unsigned)line, fileName, (unsigned)channelsNum + 1);
+			goto done;
+		}
+		if(*p) p++;
+		t->samplesNum++;
+	}
+	t->time = t->ownedTime;
+	t->rows = t->ownedRows;
+	if(!t->samplesNum) {
+		jm_log_error(cb, module, "The input file '%s' has no samples", fileName);
+		goto done;
+	}
+	ok = fmi2_input_table_check_time(t, fileName);
+
+done:
+	if(locale) jm_resetlocale_numeric(cb, locale);
+	cb->free(text);
+	if(!ok) {
+		fmi2_import_input_table_free(t);
+		return 0;
+	}
+	jm_log_verbose(cb, module, "Loaded %u samples of %u channels from '%s'", (unsigned)t->samplesNum, (unsigned)channelsNum, fileName);
+	return t;
+}
+
+fmi2_import_input_table_t* fmi2_import_input_table_map_binary(jm_callbacks* cb, const char* fileName) {
+	fmi2_import_input_table_t* t;
+	jm_mapped_file_t map;
+	unsigned int header[4];
+	const char* data;
+	const char* names;
+	const char* namesEnd;
+	size_t i, dataSize;
+
+	if(jm_map_file(cb, fileName, &map) != jm_status_success) return 0;
+	data = (const char*)map.data;
+	if(map.size < FMI2_INPUT_TABLE_HEADER_SIZE || memcmp(data, FMI2_INPUT_TABLE_MAGIC, 8) != 0) {
+		jm_unmap_file(&map);
+		jm_log_error(cb, module, "'%s' is not an input table file", fileName);
+		return 0;
+	}
+	memcpy(header, data + 8, sizeof(header));
+	dataSize = (size_t)header[2] * (1 + header[1]) * sizeof(fmi2_real_t);
+	if(header[0] != FMI2_INPUT_TABLE_VERSION || !header[1] || !header[2] || header[3] % sizeof(fmi2_real_t) ||
+	   map.size != FMI2_INPUT_TABLE_HEADER_SIZE + header[3] + dataSize) {
+		jm_unmap_file(&map);
+		jm_log_error(cb, module, "The input table file '%s' is not valid", fileName);
+		return 0;
+	}
+	t = fmi2_input_table_create(cb, header[1]);
+	if(!t) {
+		jm_unmap_file(&map);
+		return 0;
+	}
+	t->map = map;
+	t->samplesNum = header[2];
+
+	/* the names are terminated strings, padded to align the values; the terminator is searched within the names */
+	names = data + FMI2_INPUT_TABLE_HEADER_SIZE;
+	namesEnd = names + header[3];
+	for(i = 0; i < t->channelsNum; i++) {
+		const char* end = (const char*)memchr(names, 0, (size_t)(namesEnd - names));
+		size_t len;
+		if(!end) {
+			jm_log_error(cb, module, "The input table file '%s' is not valid", fileName);
+			fmi2_import_input_table_free(t);
+			return 0;
+		}
+		len = (size_t)(end - names);
+		t->names[i] = fmi2_input_table_strdup(cb, names, len);
+		if(!t->names[i]) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			fmi2_import_input_table_free(t);
+			return 0;
+		}
+		names += len + 1;
+	}
+	t->time = (const fmi2_real_t*)(data + FMI2_INPUT_TABLE_HEADER_SIZE + header[3]);
+	t->rows = t->time + t->samplesNum;
+	if(!fmi2_input_table_check_time(t, fileName)) {
+		fmi2_import_input_table_free(t);
+		return 0;
+	}
+	jm_log_verbose(cb, module, "Mapped %u samples of %u channels from '%s'", (unsigned)t->samplesNum, (unsigned)t->channelsNum, fileName);
+	return t;
+}
+
+jm_status_enu_t fmi2_import_input_table_write_binary(fmi2_import_input_table_t* t, const char* fileName) {
+	unsigned int header[4];
+	size_t i, namesSize = 0;
+	int failed;
+	FILE* f = fopen(fileName, "wb");
+
+	if(!f) {
+		jm_log_error(t->callbacks, module, "Could not open the input table file '%s'", fileName);
+		return jm_status_error;
+	}
+	for(i = 0; i < t->channelsNum; i++) namesSize += strlen(t->names[i]) + 1;
+	namesSize = (namesSize + sizeof(fmi2_real_t) - 1) / sizeof(fmi2_real_t) * sizeof(fmi2_real_t);
+	header[0] = FMI2_INPUT_TABLE_VERSION;
+	header[1] = (unsigned int)t->channelsNum;
+	header[2] = (unsigned int)t->samplesNum;
+	header[3] = (unsigned int)namesSize;
+
+	failed = fwrite(FMI2_INPUT_TABLE_MAGIC, 1, 8, f) != 8 || fwrite(header, sizeof(header), 1, f) != 1;
+	for(i = 0; i < t->channelsNum; i++) {
+		size_t len = strlen(t->names[i]) + 1;
+		failed |= fwrite(t->names[i], 1, len, f) != len;
+		namesSize -= len;
+	}
+	for(; namesSize; namesSize--) failed |= fputc(0, f) == EOF;
+	failed |= fwrite(t->time, sizeof(fmi2_real_t), t->samplesNum, f) != t->samplesNum;
+	failed |= fwrite(t->rows, sizeof(fmi2_real_t), t->samplesNum * t->channelsNum, f) != t->samplesNum * t->channelsNum;
+	failed |= fclose(f) != 0;
+	if(failed) {
+		jm_log_error(t->callbacks, module, "Could not write the input table file '%s'", fileName);
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+size_t fmi2_import_input_table_get_channels_num(fmi2_import_input_table_t* t) {
+	return t->channelsNum;
+}
+
+const char* fmi2_import_input_table_get_channel_name(fmi2_import_input_table_t* t, size_t index) {
+	return (index < t->channelsNum) ? t->names[index] : 0;
+}
+
+jm_status_enu_t fmi2_import_input_table_find_channel(fmi2_import_input_table_t* t, const char* name, size_t* index) {
+	size_t i;
+	for(i = 0; i < t->channelsNum; i++) {
+		if(strcmp(t->names[i], name) == 0) {
+			*index = i;
+			return jm_status_success;
+		}
+	}
+	return jm_status_error;
+}
+
+size_t fmi2_import_input_table_get_samples_num(fmi2_import_input_table_t* t) {
+	return t->samplesNum;
+}
+
+const fmi2_real_t* fmi2_import_input_table_get_time(fmi2_import_input_table_t* t) {
+	return t->time;
+}
+
+void fmi2_import_input_table_set_interpolation(fmi2_import_input_table_t* t, fmi2_import_input_interpolation_enu_t interpolation) {
+	t->interpolation = interpolation;
+}
+
+/* Find the last sample at or before the time, zero before the first sample.
+   Neighbours of the remembered sample are checked before searching. */
+static size_t fmi2_input_table_locate(fmi2_import_input_table_t* t, fmi2_real_t time) {
+	const fmi2_real_t* ts = t->time;
+	size_t n = t->samplesNum, i = t->cursor, lo, hi;
+
+	if(time >= ts[i]) {
+		if(i + 1 == n || time < ts[i + 1]) return i;
+		if(i + 2 == n || time < ts[i + 2]) {
+			t->cursor = i + 1;
+			return i + 1;
+		}
+		lo = i + 2;
+		hi = n;
+	}
+	else {
+		if(i > 0 && time >= ts[i - 1]) {
+			t->cursor = i - 1;
+			return i - 1;
+		}
+		lo = 0;
+		hi = i;
+	}
+	/* ts[lo] <= time unless lo is 0, and time < ts[hi] unless hi is n */
+	while(hi - lo > 1) {
+		size_t mid = lo + (hi - lo) / 2;
+		if(ts[mid] <= time) lo = mid;
+		else hi = mid;
+	}
+	t->cursor = lo;
+	return lo;
+}
+
+void fmi2_import_input_table_evaluate(fmi2_import_input_table_t* t, fmi2_real_t time, fmi2_real_t values[]) {
+	size_t i = fmi2_input_table_locate(t, time), c, nc = t->channelsNum;
+	const fmi2_real_t* a = t->rows + i * nc;
+
+	if(t->interpolation == fmi2_import_input_zero_order_hold || i + 1 == t->samplesNum || time <= t->time[i]) {
+		memcpy(values, a, nc * sizeof(fmi2_real_t));
+	}
+	else {
+		const fmi2_real_t* b = a + nc;
+		fmi2_real_t w = (time - t->time[i]) / (t->time[i + 1] - t->time[i]);
+		for(c = 0; c < nc; c++) values[c] = a[c] + w * (b[c] - a[c]);
+	}
+}
+
+void fmi2_import_input_table_evaluate_slopes(fmi2_import_input_table_t* t, fmi2_real_t time, fmi2_real_t slopes[]) {
+	size_t i = fmi2_input_table_locate(t, time), c, nc = t->channelsNum;
+
+	if(t->interpolation == fmi2_import_input_zero_order_hold || i + 1 == t->samplesNum || time < t->time[i]) {
+		memset(slopes, 0, nc * sizeof(fmi2_real_t));
+	}
+	else {
+		const fmi2_real_t* a = t->rows + i * nc;
+		const fmi2_real_t* b = a + nc;
+		fmi2_real_t r = 1.0 / (t->time[i + 1] - t->time[i]);
+		for(c = 0; c < nc; c++) slopes[c] = r * (b[c] - a[c]);
+	}
+}
+
+/* Only the variables that an importer may set during the simulation are connected */
+static int fmi2_input_table_is_settable(fmi2_import_variable_t* v) {
+	fmi2_causality_enu_t causality = fmi2_import_get_causality(v);
+	return causality == fmi2_causality_enu_input ||
+		(causality == fmi2_causality_enu_parameter && fmi2_import_get_variability(v) == fmi2_variability_enu_tunable);
+}
+
+jm_status_enu_t fmi2_import_input_table_bind(fmi2_import_input_table_t* t, fmi2_import_t* fmu) {
+	jm_callbacks* cb = t->callbacks;
+	size_t c, k, inputsNum = 0;
+	fmi2_import_variable_t** vars;
+
+	fmi2_input_table_unbind(t);
+	vars = (fmi2_import_variable_t**)cb->calloc(t->channelsNum, sizeof(fmi2_import_variable_t*));
+	t->boundChannel = (size_t*)cb->calloc(t->channelsNum, sizeof(size_t));
+	t->boundVr = (fmi2_value_reference_t*)cb->calloc(t->channelsNum, sizeof(fmi2_value_reference_t));
+	t->order = (fmi2_integer_t*)cb->calloc(t->channelsNum, sizeof(fmi2_integer_t));
+	t->values = (fmi2_real_t*)cb->calloc(t->channelsNum, sizeof(fmi2_real_t));
+	t->slopes = (fmi2_real_t*)cb->calloc(t->channelsNum, sizeof(fmi2_real_t));
+	t->boundValues = (fmi2_real_t*)cb->calloc(t->channelsNum, sizeof(fmi2_real_t));
+	if(!vars || !t->boundChannel || !t->boundVr || !t->order || !t->values || !t->slopes || !t->boundValues) {
+		cb->free(vars);
+		fmi2_input_table_unbind(t);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+
+	for(c = 0; c < t->channelsNum; c++) {
+		vars[c] = fmi2_import_get_variable_by_name(fmu, t->names[c]);
+		if(!vars[c]) {
+			jm_log_warning(cb, module, "Channel %s is not connected since the FMU has no such variable", t->names[c]);
+			continue;
+		}
+		if(!fmi2_input_table_is_settable(vars[c])) {
+			jm_log_warning(cb, module, "Channel %s is not connected since the variable is neither an input nor a tunable parameter", t->names[c]);
+			vars[c] = 0;
+			continue;
+		}
+		if(fmi2_import_get_variable_base_type(vars[c]) != fmi2_base_type_real) {
+			jm_log_error(cb, module, "Channel %s is not connected since the variable is not a Real", t->names[c]);
+			cb->free(vars);
+			fmi2_input_table_unbind(t);
+			return jm_status_error;
+		}
+		if(fmi2_import_get_causality(vars[c]) == fmi2_causality_enu_input) inputsNum++;
+	}
+
+	/* inputs first, so that their derivatives are set with one call */
+	for(c = 0, k = 0; c < t->channelsNum; c++) {
+		int isInput = vars[c] && fmi2_import_get_causality(vars[c]) == fmi2_causality_enu_input;
+		if(isInput) {
+			t->boundChannel[k] = c;
+			t->boundVr[k] = fmi2_import_get_variable_vr(vars[c]);
+			t->order[k] = 1;
+			k++;
+		}
+	}
+	for(c = 0; c < t->channelsNum; c++) {
+		if(vars[c] && fmi2_import_get_causality(vars[c]) != fmi2_causality_enu_input) {
+			t->boundChannel[k] = c;
+			t->boundVr[k] = fmi2_import_get_variable_vr(vars[c]);
+			k++;
+		}
+	}
+	cb->free(vars);
+	t->boundNum = k;
+	t->derivativesNum = inputsNum;
+	t->fmu = fmu;
+	if(k < t->channelsNum) {
+		jm_log_verbose(cb, module, "%u of %u channels are not connected", (unsigned)(t->channelsNum - k), (unsigned)t->channelsNum);
+	}
+	return jm_status_success;
+}
+
+size_t fmi2_import_input_table_get_bound_num(fmi2_import_input_table_t* t) {
+	return t->boundNum;
+}
+
+int fmi2_import_input_table_sets_derivatives(fmi2_import_input_table_t* t) {
+	fmi2_import_t* fmu = t->fmu;
+	return fmu && t->derivativesNum && t->interpolation == fmi2_import_input_linear &&
+		fmu->capi && fmi2_capi_get_fmu_kind(fmu->capi) == fmi2_fmu_kind_cs &&
+		fmi2_import_get_capability(fmu, fmi2_cs_canInterpolateInputs);
+}
+
+fmi2_status_t fmi2_import_input_table_apply(fmi2_import_input_table_t* t, fmi2_real_t time) {
+	const fmi2_real_t* values = t->values;
+	fmi2_status_t status;
+	size_t k;
+
+	if(!t->fmu) {
+		jm_log_error(t->callbacks, module, "The input table is not connected to an FMU");
+		return fmi2_status_error;
+	}
+	if(!t->boundNum) return fmi2_status_ok;
+
+	fmi2_import_input_table_evaluate(t, time, t->values);
+	/* the values are passed in place when all channels are connected in order */
+	for(k = 0; k < t->boundNum && t->boundChannel[k] == k; k++);
+	if(k < t->channelsNum) {
+		for(k = 0; k < t->boundNum; k++) t->boundValues[k] = t->values[t->boundChannel[k]];
+		values = t->boundValues;
+	}
+	status = fmi2_import_set_real(t->fmu, t->boundVr, t->boundNum, values);
+
+	if(status < fmi2_status_error && fmi2_import_input_table_sets_derivatives(t)) {
+		fmi2_status_t s;
+		fmi2_import_input_table_evaluate_slopes(t, time, t->slopes);
+		for(k = 0; k < t->derivativesNum; k++) t->boundValues[k] = t->slopes[t->boundChannel[k]];
+		s = fmi2_import_set_real_input_derivatives(t->fmu, t->boundVr, t->derivativesNum, t->order, t->boundValues);
+		status = FMI2_INPUT_TABLE_WORST(status, s);
+	}
+	return status;
+}
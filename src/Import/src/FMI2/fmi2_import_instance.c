@@ -0,0 +1,307 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <FMI2/fmi2_capi.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+struct fmi2_import_instance_t {
+	/* The object the instance was created from */
+	fmi2_import_t* fmu;
+
+	/* Own copy of the callbacks; the instance logs through it and keeps its own last error */
+	jm_callbacks callbacks;
+
+	/* Shallow copy of fmu sharing the model description, with own C-API struct.
+	   All wrappers operate on this object and it is used as componentEnvironment for log forwarding. */
+	fmi2_import_t view;
+};
+
+fmi2_import_instance_t* fmi2_import_instance_allocate(fmi2_import_t* fmu, const fmi2_callback_functions_t* callBackFunctions) {
+	jm_callbacks* cb;
+	fmi2_import_instance_t* inst;
+	fmi2_callback_functions_t defaultCallbacks;
+
+	if(!fmu) {
+		assert(0);
+		return 0;
+	}
+	cb = fmu->callbacks;
+	if(!fmu->capi) {
+		jm_log_error(cb, module, "FMU CAPI is not loaded");
+		return 0;
+	}
+
+	inst = (fmi2_import_instance_t*)cb->calloc(1, sizeof(fmi2_import_instance_t));
+	if(!inst) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	inst->fmu = fmu;
+	inst->callbacks = *cb;
+
+	inst->view = *fmu;
+	inst->view.callbacks = &inst->callbacks;
+	inst->view.capi = 0;
+	memset(inst->view.dependencyIndex, 0, sizeof(inst->view.dependencyIndex));
+	inst->view.asyncStep = 0;
+
+	if(!callBackFunctions) {
+		defaultCallbacks.allocateMemory = cb->calloc;
+		defaultCallbacks.freeMemory = cb->free;
+		defaultCallbacks.componentEnvironment = &inst->view;
+		defaultCallbacks.logger = fmi2_log_forwarding;
+		defaultCallbacks.stepFinished = fmi2_step_finished_forwarding;
+		callBackFunctions = &defaultCallbacks;
+	}
+
+	inst->view.capi = fmi2_capi_clone_dllfmu(fmu->capi, callBackFunctions);
+	if(!inst->view.capi) {
+		fmi2_import_instance_free(inst);
+		return 0;
+	}
+	return inst;
+}
+
+void fmi2_import_instance_free(fmi2_import_instance_t* inst) {
+	jm_callbacks* cb;
+	if(!inst) return;
+	cb = inst->fmu->callbacks;
+	/* the step waits for a running step and leaves its completion queue before the component is freed */
+	fmi2_import_async_step_free(inst->view.asyncStep);
+	fmi2_import_free_dependency_index(cb, inst->view.dependencyIndex[fmi2_import_dependency_outputs]);
+	fmi2_import_free_dependency_index(cb, inst->view.dependencyIndex[fmi2_import_dependency_derivatives]);
+	fmi2_import_free_dependency_index(cb, inst->view.dependencyIndex[fmi2_import_dependency_discrete_states]);
+	if(inst->view.capi) {
+		if(inst->view.capi->c) {
+			jm_log_verbose(cb, module, "Freeing FMU component of the instance");
+			fmi2_capi_free_instance(inst->view.capi);
+		}
+		fmi2_capi_destroy_dllfmu(inst->view.capi);
+	}
+	cb->free(inst);
+}
+
+fmi2_import_t* fmi2_import_instance_get_fmu(fmi2_import_instance_t* inst) {
+	return inst->fmu;
+}
+
+fmi2_import_t* fmi2_import_instance_get_view(fmi2_import_instance_t* inst) {
+	return &inst->view;
+}
+
+fmi2_component_t fmi2_import_instance_get_component(fmi2_import_instance_t* inst) {
+	return fmi2_capi_get_component(inst->view.capi);
+}
+
+const char* fmi2_import_instance_get_last_error(fmi2_import_instance_t* inst) {
+	return jm_get_last_error(&inst->callbacks);
+}
+
+jm_status_enu_t fmi2_import_instance_set_call_tracing(fmi2_import_instance_t* inst, int enable) {
+	return fmi2_capi_set_tracing(inst->view.capi, enable);
+}
+
+size_t fmi2_import_instance_get_call_stats(fmi2_import_instance_t* inst, fmi_call_stats_t stats[], size_t n) {
+	return fmi2_capi_get_call_stats(inst->view.capi, stats, n);
+}
+
+void fmi2_import_instance_reset_call_stats(fmi2_import_instance_t* inst) {
+	fmi2_capi_reset_call_stats(inst->view.capi);
+}
+
+/* Common functions */
+fmi2_status_t fmi2_import_instance_set_debug_logging(fmi2_import_instance_t* inst, fmi2_boolean_t loggingOn, size_t nCategories, fmi2_string_t categories[]) {
+	return fmi2_import_set_debug_logging(&inst->view, loggingOn, nCategories, categories);
+}
+
+jm_status_enu_t fmi2_import_instance_instantiate(fmi2_import_instance_t* inst,
+    fmi2_string_t instanceName, fmi2_type_t fmuType,
+    fmi2_string_t fmuResourceLocation, fmi2_boolean_t visible) {
+	return fmi2_import_instantiate(&inst->view, instanceName, fmuType, fmuResourceLocation, visible);
+}
+
+void fmi2_import_instance_free_instance(fmi2_import_instance_t* inst) {
+	fmi2_import_free_instance(&inst->view);
+}
+
+fmi2_status_t fmi2_import_instance_setup_experiment(fmi2_import_instance_t* inst,
+    fmi2_boolean_t toleranceDefined, fmi2_real_t tolerance,
+    fmi2_real_t startTime, fmi2_boolean_t stopTimeDefined,
+    fmi2_real_t stopTime) {
+	return fmi2_import_setup_experiment(&inst->view, toleranceDefined, tolerance, startTime, stopTimeDefined, stopTime);
+}
+
+fmi2_status_t fmi2_import_instance_enter_initialization_mode(fmi2_import_instance_t* inst) {
+	return fmi2_import_enter_initialization_mode(&inst->view);
+}
+
+fmi2_status_t fmi2_import_instance_exit_initialization_mode(fmi2_import_instance_t* inst) {
+	return fmi2_import_exit_initialization_mode(&inst->view);
+}
+
+fmi2_status_t fmi2_import_instance_terminate(fmi2_import_instance_t* inst) {
+	return fmi2_import_terminate(&inst->view);
+}
+
+fmi2_status_t fmi2_import_instance_reset(fmi2_import_instance_t* inst) {
+	return fmi2_import_reset(&inst->view);
+}
+
+fmi2_status_t fmi2_import_instance_set_real(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_real_t    value[]) {
+	return fmi2_import_set_real(&inst->view, vr, nvr, value);
+}
+
+fmi2_status_t fmi2_import_instance_set_integer(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t value[]) {
+	return fmi2_import_set_integer(&inst->view, vr, nvr, value);
+}
+
+fmi2_status_t fmi2_import_instance_set_boolean(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_boolean_t value[]) {
+	return fmi2_import_set_boolean(&inst->view, vr, nvr, value);
+}
+
+fmi2_status_t fmi2_import_instance_set_string(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_string_t  value[]) {
+	return fmi2_import_set_string(&inst->view, vr, nvr, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_real(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, fmi2_real_t    value[]) {
+	return fmi2_import_get_real(&inst->view, vr, nvr, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_integer(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, fmi2_integer_t value[]) {
+	return fmi2_import_get_integer(&inst->view, vr, nvr, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_boolean(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, fmi2_boolean_t value[]) {
+	return fmi2_import_get_boolean(&inst->view, vr, nvr, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_string(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, fmi2_string_t  value[]) {
+	return fmi2_import_get_string(&inst->view, vr, nvr, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_fmu_state(fmi2_import_instance_t* inst, fmi2_FMU_state_t* s) {
+	return fmi2_import_get_fmu_state(&inst->view, s);
+}
+
+fmi2_status_t fmi2_import_instance_set_fmu_state(fmi2_import_instance_t* inst, fmi2_FMU_state_t s) {
+	return fmi2_import_set_fmu_state(&inst->view, s);
+}
+
+fmi2_status_t fmi2_import_instance_free_fmu_state(fmi2_import_instance_t* inst, fmi2_FMU_state_t* s) {
+	return fmi2_import_free_fmu_state(&inst->view, s);
+}
+
+fmi2_status_t fmi2_import_instance_serialized_fmu_state_size(fmi2_import_instance_t* inst, fmi2_FMU_state_t s, size_t* sz) {
+	return fmi2_import_serialized_fmu_state_size(&inst->view, s, sz);
+}
+
+fmi2_status_t fmi2_import_instance_serialize_fmu_state(fmi2_import_instance_t* inst, fmi2_FMU_state_t s, fmi2_byte_t data[], size_t sz) {
+	return fmi2_import_serialize_fmu_state(&inst->view, s, data, sz);
+}
+
+fmi2_status_t fmi2_import_instance_de_serialize_fmu_state(fmi2_import_instance_t* inst, const fmi2_byte_t data[], size_t sz, fmi2_FMU_state_t* s) {
+	return fmi2_import_de_serialize_fmu_state(&inst->view, data, sz, s);
+}
+
+fmi2_status_t fmi2_import_instance_get_directional_derivative(fmi2_import_instance_t* inst, const fmi2_value_reference_t v_ref[], size_t nv,
+                                                              const fmi2_value_reference_t z_ref[], size_t nz,
+                                                              const fmi2_real_t dv[], fmi2_real_t dz[]) {
+	return fmi2_import_get_directional_derivative(&inst->view, v_ref, nv, z_ref, nz, dv, dz);
+}
+
+/* Model Exchange functions */
+fmi2_status_t fmi2_import_instance_enter_event_mode(fmi2_import_instance_t* inst) {
+	return fmi2_import_enter_event_mode(&inst->view);
+}
+
+fmi2_status_t fmi2_import_instance_new_discrete_states(fmi2_import_instance_t* inst, fmi2_event_info_t* eventInfo) {
+	return fmi2_import_new_discrete_states(&inst->view, eventInfo);
+}
+
+fmi2_status_t fmi2_import_instance_enter_continuous_time_mode(fmi2_import_instance_t* inst) {
+	return fmi2_import_enter_continuous_time_mode(&inst->view);
+}
+
+fmi2_status_t fmi2_import_instance_set_time(fmi2_import_instance_t* inst, fmi2_real_t time) {
+	return fmi2_import_set_time(&inst->view, time);
+}
+
+fmi2_status_t fmi2_import_instance_set_continuous_states(fmi2_import_instance_t* inst, const fmi2_real_t x[], size_t nx) {
+	return fmi2_import_set_continuous_states(&inst->view, x, nx);
+}
+
+fmi2_status_t fmi2_import_instance_completed_integrator_step(fmi2_import_instance_t* inst,
+    fmi2_boolean_t noSetFMUStatePriorToCurrentPoint,
+    fmi2_boolean_t* enterEventMode, fmi2_boolean_t* terminateSimulation) {
+	return fmi2_import_completed_integrator_step(&inst->view, noSetFMUStatePriorToCurrentPoint, enterEventMode, terminateSimulation);
+}
+
+fmi2_status_t fmi2_import_instance_get_derivatives(fmi2_import_instance_t* inst, fmi2_real_t derivatives[], size_t nx) {
+	return fmi2_import_get_derivatives(&inst->view, derivatives, nx);
+}
+
+fmi2_status_t fmi2_import_instance_get_event_indicators(fmi2_import_instance_t* inst, fmi2_real_t eventIndicators[], size_t ni) {
+	return fmi2_import_get_event_indicators(&inst->view, eventIndicators, ni);
+}
+
+fmi2_status_t fmi2_import_instance_get_continuous_states(fmi2_import_instance_t* inst, fmi2_real_t states[], size_t nx) {
+	return fmi2_import_get_continuous_states(&inst->view, states, nx);
+}
+
+fmi2_status_t fmi2_import_instance_get_nominals_of_continuous_states(fmi2_import_instance_t* inst, fmi2_real_t x_nominal[], size_t nx) {
+	return fmi2_import_get_nominals_of_continuous_states(&inst->view, x_nominal, nx);
+}
+
+/* Co-Simulation functions */
+fmi2_status_t fmi2_import_instance_set_real_input_derivatives(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], const  fmi2_real_t value[]) {
+	return fmi2_import_set_real_input_derivatives(&inst->view, vr, nvr, order, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_real_output_derivatives(fmi2_import_instance_t* inst, const fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], fmi2_real_t value[]) {
+	return fmi2_import_get_real_output_derivatives(&inst->view, vr, nvr, order, value);
+}
+
+fmi2_status_t fmi2_import_instance_cancel_step(fmi2_import_instance_t* inst) {
+	return fmi2_import_cancel_step(&inst->view);
+}
+
+fmi2_status_t fmi2_import_instance_do_step(fmi2_import_instance_t* inst, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize, fmi2_boolean_t newStep) {
+	return fmi2_import_do_step(&inst->view, currentCommunicationPoint, communicationStepSize, newStep);
+}
+
+fmi2_status_t fmi2_import_instance_get_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_status_t*  value) {
+	return fmi2_import_get_status(&inst->view, s, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_real_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_real_t*    value) {
+	return fmi2_import_get_real_status(&inst->view, s, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_integer_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_integer_t* value) {
+	return fmi2_import_get_integer_status(&inst->view, s, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_boolean_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_boolean_t* value) {
+	return fmi2_import_get_boolean_status(&inst->view, s, value);
+}
+
+fmi2_status_t fmi2_import_instance_get_string_status(fmi2_import_instance_t* inst, const fmi2_status_kind_t s, fmi2_string_t*  value) {
+	return fmi2_import_get_string_status(&inst->view, s, value);
+}
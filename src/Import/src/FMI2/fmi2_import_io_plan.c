@@ -0,0 +1,271 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+/* Value buffers: Real, Integer (and Enumeration), Boolean, String */
+#define FMI2_IO_PLAN_TYPES 4
+
+#define FMI2_IO_PLAN_WORST(a, b) (((b) > (a)) ? (b) : (a))
+
+struct fmi2_import_io_plan_t {
+	jm_callbacks* callbacks;
+	fmi2_import_t* fmu;
+
+	size_t n[FMI2_IO_PLAN_TYPES];
+	fmi2_value_reference_t* vr[FMI2_IO_PLAN_TYPES];
+
+	fmi2_real_t* realValues;
+	fmi2_integer_t* integerValues;
+	fmi2_boolean_t* booleanValues;
+	fmi2_string_t* stringValues;
+
+	/* Real values in the selected unit are scale * v + offset; NULL when no variable is converted */
+	fmi2_real_t* scale;
+	fmi2_real_t* offset;
+	fmi2_real_t* realScratch;
+
+	size_t listSize;
+	size_t* listIndex;
+};
+
+static int fmi2_import_io_plan_type_index(fmi2_base_type_enu_t bt) {
+	switch(bt) {
+	case fmi2_base_type_real: return 0;
+	case fmi2_base_type_int:
+	case fmi2_base_type_enum: return 1;
+	case fmi2_base_type_bool: return 2;
+	default: return 3;
+	}
+}
+
+static int fmi2_import_io_plan_compare_vr(const void* a, const void* b) {
+	fmi2_value_reference_t va = *(const fmi2_value_reference_t*)a;
+	fmi2_value_reference_t vb = *(const fmi2_value_reference_t*)b;
+	return (va > vb) - (va < vb);
+}
+
+/* Conversion of one Real variable to the selected unit. Returns zero for the identity. */
+static int fmi2_import_io_plan_get_conversion(fmi2_import_real_variable_t* rv, fmi2_import_io_conversion_enu_t conversion, fmi2_real_t* scale, fmi2_real_t* offset) {
+	int isRelative = fmi2_import_get_real_variable_relative_quantity(rv);
+	*scale = 1.0;
+	*offset = 0.0;
+	if(conversion == fmi2_import_io_display_unit) {
+		fmi2_import_display_unit_t* du = fmi2_import_get_real_variable_display_unit(rv);
+		if(!du) return 0;
+		*scale = fmi2_import_get_display_unit_factor(du);
+		*offset = fmi2_import_get_display_unit_offset(du);
+	}
+	else if(conversion == fmi2_import_io_SI_unit) {
+		fmi2_import_unit_t* u = fmi2_import_get_real_variable_unit(rv);
+		if(!u) return 0;
+		*scale = fmi2_import_get_SI_unit_factor(u);
+		*offset = fmi2_import_get_SI_unit_offset(u);
+	}
+	if(isRelative) *offset = 0.0;
+	return *scale != 1.0 || *offset != 0.0;
+}
+
+fmi2_import_io_plan_t* fmi2_import_io_plan_allocate(fmi2_import_t* fmu, fmi2_import_variable_list_t* vl, fmi2_import_io_conversion_enu_t conversion) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_import_io_plan_t* plan;
+	size_t listSize = fmi2_import_get_variable_list_size(vl);
+	size_t i, n[FMI2_IO_PLAN_TYPES] = {0, 0, 0, 0};
+	int t, isConverted = 0;
+
+	plan = (fmi2_import_io_plan_t*)cb->calloc(1, sizeof(fmi2_import_io_plan_t));
+	if(!plan) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	plan->callbacks = cb;
+	plan->fmu = fmu;
+	plan->listSize = listSize;
+
+	for(i = 0; i < listSize; i++) {
+		n[fmi2_import_io_plan_type_index(fmi2_import_get_variable_base_type(fmi2_import_get_variable(vl, i)))]++;
+	}
+	plan->listIndex = (size_t*)cb->calloc(listSize ? listSize : 1, sizeof(size_t));
+	for(t = 0; t < FMI2_IO_PLAN_TYPES; t++) {
+		plan->vr[t] = (fmi2_value_reference_t*)cb->calloc(n[t] ? n[t] : 1, sizeof(fmi2_value_reference_t));
+	}
+	if(!plan->listIndex || !plan->vr[0] || !plan->vr[1] || !plan->vr[2] || !plan->vr[3]) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		fmi2_import_io_plan_free(plan);
+		return 0;
+	}
+
+	/* partition, sort and remove duplicates */
+	for(i = 0; i < listSize; i++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, i);
+		t = fmi2_import_io_plan_type_index(fmi2_import_get_variable_base_type(v));
+		plan->vr[t][plan->n[t]++] = fmi2_import_get_variable_vr(v);
+	}
+	for(t = 0; t < FMI2_IO_PLAN_TYPES; t++) {
+		size_t k = 0;
+		if(!plan->n[t]) continue;
+		qsort(plan->vr[t], plan->n[t], sizeof(fmi2_value_reference_t), fmi2_import_io_plan_compare_vr);
+		for(i = 1; i < plan->n[t]; i++) {
+			if(plan->vr[t][i] != plan->vr[t][k]) plan->vr[t][++k] = plan->vr[t][i];
+		}
+		plan->n[t] = k + 1;
+	}
+	for(i = 0; i < listSize; i++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, i);
+		fmi2_value_reference_t vr = fmi2_import_get_variable_vr(v);
+		const fmi2_value_reference_t* found;
+		t = fmi2_import_io_plan_type_index(fmi2_import_get_variable_base_type(v));
+		found = (const fmi2_value_reference_t*)bsearch(&vr, plan->vr[t], plan->n[t], sizeof(fmi2_value_reference_t), fmi2_import_io_plan_compare_vr);
+		plan->listIndex[i] = (size_t)(found - plan->vr[t]);
+	}
+
+	plan->realValues = (fmi2_real_t*)cb->calloc(plan->n[0] ? plan->n[0] : 1, sizeof(fmi2_real_t));
+	plan->integerValues = (fmi2_integer_t*)cb->calloc(plan->n[1] ? plan->n[1] : 1, sizeof(fmi2_integer_t));
+	plan->booleanValues = (fmi2_boolean_t*)cb->calloc(plan->n[2] ? plan->n[2] : 1, sizeof(fmi2_boolean_t));
+	plan->stringValues = (fmi2_string_t*)cb->calloc(plan->n[3] ? plan->n[3] : 1, sizeof(fmi2_string_t));
+	if(!plan->realValues || !plan->integerValues || !plan->booleanValues || !plan->stringValues) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		fmi2_import_io_plan_free(plan);
+		return 0;
+	}
+
+	if(conversion != fmi2_import_io_no_conversion && plan->n[0]) {
+		plan->scale = (fmi2_real_t*)cb->calloc(plan->n[0], sizeof(fmi2_real_t));
+		plan->offset = (fmi2_real_t*)cb->calloc(plan->n[0], sizeof(fmi2_real_t));
+		if(!plan->scale || !plan->offset) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			fmi2_import_io_plan_free(plan);
+			return 0;
+		}
+		for(i = 0; i < plan->n[0]; i++) {
+			fmi2_import_variable_t* v = fmi2_import_get_variable_by_vr(fmu, fmi2_base_type_real, plan->vr[0][i]);
+			fmi2_import_real_variable_t* rv = fmi2_import_get_variable_as_real(v);
+			plan->scale[i] = 1.0;
+			plan->offset[i] = 0.0;
+			if(rv && fmi2_import_io_plan_get_conversion(rv, conversion, &plan->scale[i], &plan->offset[i])) {
+				isConverted = 1;
+			}
+		}
+		if(isConverted) {
+			plan->realScratch = (fmi2_real_t*)cb->calloc(plan->n[0], sizeof(fmi2_real_t));
+			if(!plan->realScratch) {
+				jm_log_fatal(cb, module, "Could not allocate memory");
+				fmi2_import_io_plan_free(plan);
+				return 0;
+			}
+		}
+		else {
+			cb->free(plan->scale);
+			cb->free(plan->offset);
+			plan->scale = 0;
+			plan->offset = 0;
+		}
+	}
+	jm_log_verbose(cb, module, "Compiled I/O plan for %u variables: %u Real, %u Integer, %u Boolean, %u String value references",
+		(unsigned)listSize, (unsigned)plan->n[0], (unsigned)plan->n[1], (unsigned)plan->n[2], (unsigned)plan->n[3]);
+	return plan;
+}
+
+void fmi2_import_io_plan_free(fmi2_import_io_plan_t* plan) {
+	jm_callbacks* cb;
+	int t;
+	if(!plan) return;
+	cb = plan->callbacks;
+	for(t = 0; t < FMI2_IO_PLAN_TYPES; t++) {
+		cb->free(plan->vr[t]);
+	}
+	cb->free(plan->realValues);
+	cb->free(plan->integerValues);
+	cb->free(plan->booleanValues);
+	cb->free(plan->stringValues);
+	cb->free(plan->scale);
+	cb->free(plan->offset);
+	cb->free(plan->realScratch);
+	cb->free(plan->listIndex);
+	cb->free(plan);
+}
+
+fmi2_status_t fmi2_import_io_plan_get(fmi2_import_io_plan_t* plan) {
+	fmi2_import_t* fmu = plan->fmu;
+	fmi2_status_t status = fmi2_status_ok;
+	size_t i;
+
+	if(plan->n[0]) {
+		status = FMI2_IO_PLAN_WORST(status, fmi2_import_get_real(fmu, plan->vr[0], plan->n[0], plan->realValues));
+		if(plan->scale) {
+			for(i = 0; i < plan->n[0]; i++) {
+				plan->realValues[i] = plan->scale[i] * plan->realValues[i] + plan->offset[i];
+			}
+		}
+	}
+	if(plan->n[1]) status = FMI2_IO_PLAN_WORST(status, fmi2_import_get_integer(fmu, plan->vr[1], plan->n[1], plan->integerValues));
+	if(plan->n[2]) status = FMI2_IO_PLAN_WORST(status, fmi2_import_get_boolean(fmu, plan->vr[2], plan->n[2], plan->booleanValues));
+	if(plan->n[3]) status = FMI2_IO_PLAN_WORST(status, fmi2_import_get_string(fmu, plan->vr[3], plan->n[3], plan->stringValues));
+	return status;
+}
+
+fmi2_status_t fmi2_import_io_plan_set(fmi2_import_io_plan_t* plan) {
+	fmi2_import_t* fmu = plan->fmu;
+	fmi2_status_t status = fmi2_status_ok;
+	size_t i;
+
+	if(plan->n[0]) {
+		const fmi2_real_t* values = plan->realValues;
+		if(plan->scale) {
+			for(i = 0; i < plan->n[0]; i++) {
+				plan->realScratch[i] = (plan->realValues[i] - plan->offset[i]) / plan->scale[i];
+			}
+			values = plan->realScratch;
+		}
+		status = FMI2_IO_PLAN_WORST(status, fmi2_import_set_real(fmu, plan->vr[0], plan->n[0], values));
+	}
+	if(plan->n[1]) status = FMI2_IO_PLAN_WORST(status, fmi2_import_set_integer(fmu, plan->vr[1], plan->n[1], plan->integerValues));
+	if(plan->n[2]) status = FMI2_IO_PLAN_WORST(status, fmi2_import_set_boolean(fmu, plan->vr[2], plan->n[2], plan->booleanValues));
+	if(plan->n[3]) status = FMI2_IO_PLAN_WORST(status, fmi2_import_set_string(fmu, plan->vr[3], plan->n[3], plan->stringValues));
+	return status;
+}
+
+size_t fmi2_import_io_plan_get_vrs_num(fmi2_import_io_plan_t* plan, fmi2_base_type_enu_t type) {
+	return plan->n[fmi2_import_io_plan_type_index(type)];
+}
+
+const fmi2_value_reference_t* fmi2_import_io_plan_get_vrs(fmi2_import_io_plan_t* plan, fmi2_base_type_enu_t type) {
+	return plan->vr[fmi2_import_io_plan_type_index(type)];
+}
+
+size_t fmi2_import_io_plan_get_value_index(fmi2_import_io_plan_t* plan, size_t listIndex) {
+	return plan->listIndex[listIndex];
+}
+
+fmi2_real_t* fmi2_import_io_plan_get_real_values(fmi2_import_io_plan_t* plan) {
+	return plan->realValues;
+}
+
+fmi2_integer_t* fmi2_import_io_plan_get_integer_values(fmi2_import_io_plan_t* plan) {
+	return plan->integerValues;
+}
+
+fmi2_boolean_t* fmi2_import_io_plan_get_boolean_values(fmi2_import_io_plan_t* plan) {
+	return plan->booleanValues;
+}
+
+fmi2_string_t* fmi2_import_io_plan_get_string_values(fmi2_import_io_plan_t* plan) {
+	return plan->stringValues;
+}
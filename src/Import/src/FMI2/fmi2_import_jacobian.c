@@ -0,0 +1,447 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <FMI2/fmi2_xml_model_description.h>
+#include <FMI2/fmi2_xml_model_structure.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_JAC_NONE ((size_t)-1)
+
+struct fmi2_import_jacobian_t {
+	jm_callbacks* callbacks;
+	fmi2_import_jacobian_kind_enu_t kind;
+
+	size_t nRows;
+	size_t nCols;
+	size_t nnz;
+	size_t nColors;
+
+	fmi2_value_reference_t* rowVR;   /* nRows */
+	fmi2_value_reference_t* colVR;   /* nCols */
+
+	/* Row-compressed pattern */
+	size_t* rowStart;                /* nRows + 1 */
+	size_t* colIndex;                /* nnz */
+
+	/* Column-compressed pattern */
+	size_t* colStart;                /* nCols + 1 */
+	size_t* colRows;                 /* nnz, row index of each entry */
+	size_t* colPos;                  /* nnz, position of the entry in the row-compressed pattern */
+
+	/* Coloring */
+	size_t* colors;                  /* nCols */
+	size_t* colorStart;              /* nColors + 1 */
+	size_t* colorColumns;            /* nCols */
+
+	/* Work buffers for the evaluation */
+	fmi2_value_reference_t* seedVR;  /* nCols, column VRs grouped by color */
+	fmi2_real_t* seed;               /* nCols, all ones */
+	fmi2_real_t* dz;                 /* nRows */
+};
+
+typedef struct fmi2_import_jacobian_degree_t {
+	size_t degree;
+	size_t col;
+} fmi2_import_jacobian_degree_t;
+
+static void* fmi2_import_jacobian_alloc(jm_callbacks* cb, size_t n, size_t size) {
+	/* zero sized arrays are allocated with one element to keep NULL for errors */
+	return cb->calloc(n ? n : 1, size);
+}
+
+static int fmi2_import_jacobian_compare_size_t(const void* a, const void* b) {
+	size_t x = *(const size_t*)a;
+	size_t y = *(const size_t*)b;
+	return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/* Largest degree first, ties broken by column index to keep the result deterministic */
+static int fmi2_import_jacobian_compare_degree(const void* a, const void* b) {
+	const fmi2_import_jacobian_degree_t* x = (const fmi2_import_jacobian_degree_t*)a;
+	const fmi2_import_jacobian_degree_t* y = (const fmi2_import_jacobian_degree_t*)b;
+	if(x->degree != y->degree) return (x->degree > y->degree) ? -1 : 1;
+	return (x->col < y->col) ? -1 : ((x->col > y->col) ? 1 : 0);
+}
+
+/* Append the pattern of the rows described by one dependency block. */
+static jm_status_enu_t fmi2_import_jacobian_add_rows(fmi2_import_jacobian_t* jac, jm_vector(jm_voidp)* unknowns,
+                                                     size_t* startIndex, size_t* dependency,
+                                                     const size_t* colOfVar, size_t nVars,
+                                                     size_t* mark, jm_vector(size_t)* pattern) {
+	size_t n = jm_vector_get_size(jm_voidp)(unknowns);
+	size_t i, k, j;
+
+	for(i = 0; i < n; i++) {
+		size_t row = jac->nRows;
+		size_t first = jm_vector_get_size(size_t)(pattern);
+		fmi2_import_variable_t* v = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(unknowns, i);
+		int dense = (startIndex == 0);
+
+		jac->rowVR[row] = fmi2_import_get_variable_vr(v);
+
+		if(!dense) {
+			for(k = startIndex[i]; k < startIndex[i + 1]; k++) {
+				size_t dep = dependency[k];
+				size_t col;
+				if(dep == 0) {
+					dense = 1;
+					break;
+				}
+				if(dep > nVars) continue;
+				col = colOfVar[dep - 1];
+				if(col == FMI2_JAC_NONE || mark[col] == row) continue;
+				mark[col] = row;
+				if(!jm_vector_push_back(size_t)(pattern, col)) return jm_status_error;
+			}
+		}
+		if(dense) {
+			jm_vector_resize(size_t)(pattern, first);
+			for(j = 0; j < jac->nCols; j++) {
+				mark[j] = row;
+				if(!jm_vector_push_back(size_t)(pattern, j)) return jm_status_error;
+			}
+		}
+		else if(jm_vector_get_size(size_t)(pattern) > first + 1) {
+			qsort(jm_vector_get_itemp(size_t)(pattern, first), jm_vector_get_size(size_t)(pattern) - first,
+			      sizeof(size_t), fmi2_import_jacobian_compare_size_t);
+		}
+		jac->nRows++;
+		jac->rowStart[jac->nRows] = jm_vector_get_size(size_t)(pattern);
+	}
+	return jm_status_success;
+}
+
+static jm_status_enu_t fmi2_import_jacobian_build_pattern(fmi2_import_t* fmu, fmi2_import_jacobian_t* jac) {
+	jm_callbacks* cb = jac->callbacks;
+	fmi2_xml_model_structure_t* ms = fmi2_xml_get_model_structure(fmu->md);
+	jm_vector(jm_voidp)* vars = fmi2_xml_get_variables_original_order(fmu->md);
+	jm_vector(jm_voidp)* derivatives = fmi2_xml_get_derivatives(ms);
+	jm_vector(jm_voidp)* outputs = fmi2_xml_get_outputs(ms);
+	size_t nVars = vars ? jm_vector_get_size(jm_voidp)(vars) : 0;
+	size_t nDer = jm_vector_get_size(jm_voidp)(derivatives);
+	size_t nOut = jm_vector_get_size(jm_voidp)(outputs);
+	size_t *colOfVar, *mark;
+	size_t *startIndex, *dependency;
+	char* factorKind;
+	jm_vector(size_t) pattern;
+	jm_status_enu_t status = jm_status_error;
+	size_t i;
+
+	colOfVar = (size_t*)fmi2_import_jacobian_alloc(cb, nVars, sizeof(size_t));
+	jac->rowVR = (fmi2_value_reference_t*)fmi2_import_jacobian_alloc(cb, nDer + nOut, sizeof(fmi2_value_reference_t));
+	jac->rowStart = (size_t*)fmi2_import_jacobian_alloc(cb, nDer + nOut + 1, sizeof(size_t));
+	if(!colOfVar || !jac->rowVR || !jac->rowStart) {
+		cb->free(colOfVar);
+		return jm_status_error;
+	}
+	for(i = 0; i < nVars; i++) colOfVar[i] = FMI2_JAC_NONE;
+
+	/* Columns */
+	if(jac->kind == fmi2_import_jacobian_states) {
+		jac->colVR = (fmi2_value_reference_t*)fmi2_import_jacobian_alloc(cb, nDer, sizeof(fmi2_value_reference_t));
+		if(!jac->colVR) goto cleanup;
+		for(i = 0; i < nDer; i++) {
+			fmi2_import_variable_t* der = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(derivatives, i);
+			fmi2_import_variable_t* state = (fmi2_import_variable_t*)fmi2_import_get_real_variable_derivative_of(fmi2_import_get_variable_as_real(der));
+			if(!state) {
+				jm_log_error(cb, module, "Derivative '%s' does not reference a state variable", fmi2_import_get_variable_name(der));
+				goto cleanup;
+			}
+			colOfVar[fmi2_import_get_variable_original_order(state)] = i;
+			jac->colVR[i] = fmi2_import_get_variable_vr(state);
+		}
+		jac->nCols = nDer;
+	}
+	else {
+		size_t nIn = 0;
+		for(i = 0; i < nVars; i++) {
+			fmi2_import_variable_t* v = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(vars, i);
+			if((fmi2_import_get_causality(v) == fmi2_causality_enu_input) &&
+			   (fmi2_import_get_variable_base_type(v) == fmi2_base_type_real)) {
+				colOfVar[i] = nIn++;
+			}
+		}
+		jac->colVR = (fmi2_value_reference_t*)fmi2_import_jacobian_alloc(cb, nIn, sizeof(fmi2_value_reference_t));
+		if(!jac->colVR) goto cleanup;
+		for(i = 0; i < nVars; i++) {
+			if(colOfVar[i] != FMI2_JAC_NONE) {
+				jac->colVR[colOfVar[i]] = fmi2_import_get_variable_vr((fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(vars, i));
+			}
+		}
+		jac->nCols = nIn;
+	}
+
+	/* Rows */
+	mark = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nCols, sizeof(size_t));
+	if(!mark) goto cleanup;
+	for(i = 0; i < jac->nCols; i++) mark[i] = FMI2_JAC_NONE;
+
+	jm_vector_init(size_t)(&pattern, 0, cb);
+	jac->nRows = 0;
+	jac->rowStart[0] = 0;
+
+	fmi2_xml_get_derivatives_dependencies(ms, &startIndex, &dependency, &factorKind);
+	status = fmi2_import_jacobian_add_rows(jac, derivatives, startIndex, dependency, colOfVar, nVars, mark, &pattern);
+	if(status == jm_status_success) {
+		fmi2_xml_get_outputs_dependencies(ms, &startIndex, &dependency, &factorKind);
+		status = fmi2_import_jacobian_add_rows(jac, outputs, startIndex, dependency, colOfVar, nVars, mark, &pattern);
+	}
+	if(status == jm_status_success) {
+		jac->nnz = jm_vector_get_size(size_t)(&pattern);
+		jac->colIndex = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nnz, sizeof(size_t));
+		if(!jac->colIndex)
+			status = jm_status_error;
+		else if(jac->nnz)
+			memcpy(jac->colIndex, jm_vector_get_itemp(size_t)(&pattern, 0), jac->nnz * sizeof(size_t));
+	}
+	jm_vector_free_data(size_t)(&pattern);
+	cb->free(mark);
+
+cleanup:
+	cb->free(colOfVar);
+	return status;
+}
+
+static jm_status_enu_t fmi2_import_jacobian_build_transpose(fmi2_import_jacobian_t* jac) {
+	jm_callbacks* cb = jac->callbacks;
+	size_t* fill;
+	size_t r, k;
+
+	jac->colStart = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nCols + 1, sizeof(size_t));
+	jac->colRows = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nnz, sizeof(size_t));
+	jac->colPos = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nnz, sizeof(size_t));
+	fill = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nCols, sizeof(size_t));
+	if(!jac->colStart || !jac->colRows || !jac->colPos || !fill) {
+		cb->free(fill);
+		return jm_status_error;
+	}
+
+	for(k = 0; k < jac->nnz; k++) jac->colStart[jac->colIndex[k] + 1]++;
+	for(k = 0; k < jac->nCols; k++) {
+		jac->colStart[k + 1] += jac->colStart[k];
+		fill[k] = jac->colStart[k];
+	}
+	for(r = 0; r < jac->nRows; r++) {
+		for(k = jac->rowStart[r]; k < jac->rowStart[r + 1]; k++) {
+			size_t pos = fill[jac->colIndex[k]]++;
+			jac->colRows[pos] = r;
+			jac->colPos[pos] = k;
+		}
+	}
+	cb->free(fill);
+	return jm_status_success;
+}
+
+static jm_status_enu_t fmi2_import_jacobian_build_coloring(fmi2_import_jacobian_t* jac) {
+	jm_callbacks* cb = jac->callbacks;
+	fmi2_import_jacobian_degree_t* order;
+	size_t* forbidden;
+	size_t* fill;
+	size_t i, j, k, l, c;
+
+	jac->colors = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nCols, sizeof(size_t));
+	jac->colorColumns = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nCols, sizeof(size_t));
+	order = (fmi2_import_jacobian_degree_t*)fmi2_import_jacobian_alloc(cb, jac->nCols, sizeof(fmi2_import_jacobian_degree_t));
+	forbidden = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nCols, sizeof(size_t));
+	if(!jac->colors || !jac->colorColumns || !order || !forbidden) {
+		cb->free(order);
+		cb->free(forbidden);
+		return jm_status_error;
+	}
+
+	for(j = 0; j < jac->nCols; j++) {
+		jac->colors[j] = FMI2_JAC_NONE;
+		forbidden[j] = FMI2_JAC_NONE;
+		order[j].degree = jac->colStart[j + 1] - jac->colStart[j];
+		order[j].col = j;
+	}
+	if(jac->nCols > 1)
+		qsort(order, jac->nCols, sizeof(fmi2_import_jacobian_degree_t), fmi2_import_jacobian_compare_degree);
+
+	/* Greedy distance-2 coloring: a column may not share a color with any column that has a row in common with it */
+	jac->nColors = 0;
+	for(i = 0; i < jac->nCols; i++) {
+		j = order[i].col;
+		for(k = jac->colStart[j]; k < jac->colStart[j + 1]; k++) {
+			size_t r = jac->colRows[k];
+			for(l = jac->rowStart[r]; l < jac->rowStart[r + 1]; l++) {
+				size_t color = jac->colors[jac->colIndex[l]];
+				if(color != FMI2_JAC_NONE) forbidden[color] = j;
+			}
+		}
+		c = 0;
+		while(forbidden[c] == j) c++;
+		jac->colors[j] = c;
+		if(c + 1 > jac->nColors) jac->nColors = c + 1;
+	}
+	cb->free(order);
+	cb->free(forbidden);
+
+	jac->colorStart = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nColors + 1, sizeof(size_t));
+	fill = (size_t*)fmi2_import_jacobian_alloc(cb, jac->nColors, sizeof(size_t));
+	if(!jac->colorStart || !fill) {
+		cb->free(fill);
+		return jm_status_error;
+	}
+	for(j = 0; j < jac->nCols; j++) jac->colorStart[jac->colors[j] + 1]++;
+	for(c = 0; c < jac->nColors; c++) {
+		jac->colorStart[c + 1] += jac->colorStart[c];
+		fill[c] = jac->colorStart[c];
+	}
+	for(j = 0; j < jac->nCols; j++) jac->colorColumns[fill[jac->colors[j]]++] = j;
+	cb->free(fill);
+	return jm_status_success;
+}
+
+static jm_status_enu_t fmi2_import_jacobian_alloc_work(fmi2_import_jacobian_t* jac) {
+	jm_callbacks* cb = jac->callbacks;
+	size_t k;
+
+	jac->seedVR = (fmi2_value_reference_t*)fmi2_import_jacobian_alloc(cb, jac->nCols, sizeof(fmi2_value_reference_t));
+	jac->seed = (fmi2_real_t*)fmi2_import_jacobian_alloc(cb, jac->nCols, sizeof(fmi2_real_t));
+	jac->dz = (fmi2_real_t*)fmi2_import_jacobian_alloc(cb, jac->nRows, sizeof(fmi2_real_t));
+	if(!jac->seedVR || !jac->seed || !jac->dz) return jm_status_error;
+
+	for(k = 0; k < jac->nCols; k++) {
+		jac->seedVR[k] = jac->colVR[jac->colorColumns[k]];
+		jac->seed[k] = 1.0;
+	}
+	return jm_status_success;
+}
+
+fmi2_import_jacobian_t* fmi2_import_create_jacobian(fmi2_import_t* fmu, fmi2_import_jacobian_kind_enu_t kind) {
+	jm_callbacks* cb;
+	fmi2_import_jacobian_t* jac;
+
+	if(!fmi2_import_check_has_FMU(fmu)) return 0;
+	cb = fmu->callbacks;
+
+	if(kind != fmi2_import_jacobian_states && kind != fmi2_import_jacobian_inputs) {
+		jm_log_error(cb, module, "Unknown Jacobian kind %d", (int)kind);
+		return 0;
+	}
+
+	jac = (fmi2_import_jacobian_t*)cb->calloc(1, sizeof(fmi2_import_jacobian_t));
+	if(!jac) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	jac->callbacks = cb;
+	jac->kind = kind;
+
+	if((fmi2_import_jacobian_build_pattern(fmu, jac) != jm_status_success) ||
+	   (fmi2_import_jacobian_build_transpose(jac) != jm_status_success) ||
+	   (fmi2_import_jacobian_build_coloring(jac) != jm_status_success) ||
+	   (fmi2_import_jacobian_alloc_work(jac) != jm_status_success)) {
+		jm_log_error(cb, module, "Could not build the Jacobian sparsity pattern");
+		fmi2_import_free_jacobian(jac);
+		return 0;
+	}
+
+	jm_log_verbose(cb, module, "Jacobian with %u rows, %u columns and %u non-zeros needs %u colors",
+	               (unsigned)jac->nRows, (unsigned)jac->nCols, (unsigned)jac->nnz, (unsigned)jac->nColors);
+	return jac;
+}
+
+void fmi2_import_free_jacobian(fmi2_import_jacobian_t* jac) {
+	jm_callbacks* cb;
+	if(!jac) return;
+	cb = jac->callbacks;
+	cb->free(jac->rowVR);
+	cb->free(jac->colVR);
+	cb->free(jac->rowStart);
+	cb->free(jac->colIndex);
+	cb->free(jac->colStart);
+	cb->free(jac->colRows);
+	cb->free(jac->colPos);
+	cb->free(jac->colors);
+	cb->free(jac->colorStart);
+	cb->free(jac->colorColumns);
+	cb->free(jac->seedVR);
+	cb->free(jac->seed);
+	cb->free(jac->dz);
+	cb->free(jac);
+}
+
+size_t fmi2_import_get_jacobian_rows_num(fmi2_import_jacobian_t* jac) {
+	return jac->nRows;
+}
+
+size_t fmi2_import_get_jacobian_columns_num(fmi2_import_jacobian_t* jac) {
+	return jac->nCols;
+}
+
+size_t fmi2_import_get_jacobian_nonzeros_num(fmi2_import_jacobian_t* jac) {
+	return jac->nnz;
+}
+
+const fmi2_value_reference_t* fmi2_import_get_jacobian_row_vrs(fmi2_import_jacobian_t* jac) {
+	return jac->rowVR;
+}
+
+const fmi2_value_reference_t* fmi2_import_get_jacobian_column_vrs(fmi2_import_jacobian_t* jac) {
+	return jac->colVR;
+}
+
+void fmi2_import_get_jacobian_sparsity(fmi2_import_jacobian_t* jac, const size_t** rowStart, const size_t** columnIndex) {
+	*rowStart = jac->rowStart;
+	*columnIndex = jac->colIndex;
+}
+
+size_t fmi2_import_get_jacobian_colors_num(fmi2_import_jacobian_t* jac) {
+	return jac->nColors;
+}
+
+const size_t* fmi2_import_get_jacobian_column_colors(fmi2_import_jacobian_t* jac) {
+	return jac->colors;
+}
+
+void fmi2_import_get_jacobian_coloring(fmi2_import_jacobian_t* jac, const size_t** colorStart, const size_t** colorColumns) {
+	*colorStart = jac->colorStart;
+	*colorColumns = jac->colorColumns;
+}
+
+fmi2_status_t fmi2_import_eval_jacobian(fmi2_import_t* fmu, fmi2_import_jacobian_t* jac, fmi2_real_t values[]) {
+	fmi2_status_t ret = fmi2_status_ok;
+	size_t c, i, k;
+
+	if(!fmu->capi || !fmu->capi->fmi2GetDirectionalDerivative) {
+		jm_log_error(fmu->callbacks, module, "The FMU does not provide directional derivatives");
+		return fmi2_status_error;
+	}
+
+	for(c = 0; c < jac->nColors; c++) {
+		size_t first = jac->colorStart[c];
+		size_t nv = jac->colorStart[c + 1] - first;
+		fmi2_status_t status = fmi2_import_get_directional_derivative(fmu, jac->seedVR + first, nv,
+		                                                               jac->rowVR, jac->nRows, jac->seed, jac->dz);
+		if(status > ret) ret = status;
+		if(ret > fmi2_status_warning) return ret;
+
+		for(i = first; i < first + nv; i++) {
+			size_t j = jac->colorColumns[i];
+			for(k = jac->colStart[j]; k < jac->colStart[j + 1]; k++) {
+				values[jac->colPos[k]] = jac->dz[jac->colRows[k]];
+			}
+		}
+	}
+	return ret;
+}
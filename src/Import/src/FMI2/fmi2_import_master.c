@@ -0,0 +1,1016 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <JM/jm_vector.h>
+#include <JM/jm_portability.h>
+#include <JM/jm_thread_pool.h>
+#include <FMI/fmi_trace_recorder.h>
+#include <FMI2/fmi2_import.h>
+
+static const char* module = "FMILIB";
+
+/* Base types that can be connected: Real, Integer (and Enumeration), Boolean */
+#define FMI2_MASTER_TYPES 3
+
+/* Highest order of output derivatives used to extrapolate inputs */
+#define FMI2_MASTER_MAX_ORDER 2
+
+#define FMI2_MASTER_WORST(a, b) (((b) > (a)) ? (b) : (a))
+
+/* Contiguous range of connection slots of one type */
+typedef struct fmi2_import_master_block_t {
+	int type;
+	size_t first;
+	size_t n;
+	size_t fmu;             /* source FMU of an input block */
+} fmi2_import_master_block_t;
+
+typedef struct fmi2_import_master_fmu_t {
+	fmi2_import_t* fmu;
+	fmi2_import_master_block_t outputs[FMI2_MASTER_TYPES]; /* slots of the connections from this FMU */
+	size_t firstInput;      /* range in fmi2_import_master_t::inputs */
+	size_t inputsNum;
+	size_t firstConversion; /* range in the conversion arrays */
+	size_t conversionsNum;
+	size_t position;        /* in the Gauss-Seidel order */
+	unsigned int outputOrder; /* order of the output derivatives used for extrapolation */
+	int canInterpolate;
+	fmi2_FMU_state_t state; /* start of an adaptive step, for rollback */
+	fmi2_status_t status;
+	double exchangeTime;    /* spent in set and get of the last step */
+	fmi2_import_master_fmu_stats_t stats;
+} fmi2_import_master_fmu_t;
+
+/* Connection before it is assigned a slot */
+typedef struct fmi2_import_master_link_t {
+	int type;
+	size_t srcFmu;
+	size_t dstFmu;
+	fmi2_value_reference_t srcVr;
+	fmi2_value_reference_t dstVr;
+	size_t connection;
+	size_t slot;
+} fmi2_import_master_link_t;
+
+struct fmi2_import_master_t {
+	jm_callbacks* callbacks;
+
+	jm_vector(jm_voidp) fmus;
+
+	/* connections */
+	jm_vector(size_t) connSrcFmu;
+	jm_vector(jm_voidp) connSrcVar;
+	jm_vector(size_t) connDstFmu;
+	jm_vector(jm_voidp) connDstVar;
+	int unitConversion;
+
+	/* plan: every connection has a slot in the buffer of its type. Slots are ordered by source FMU,
+	   then by destination FMU, so that a get writes and a set reads a contiguous range. */
+	int isPrepared;
+	fmi2_import_master_mode_enu_t mode;
+	size_t slotsNum[FMI2_MASTER_TYPES];
+	fmi2_value_reference_t* srcVr[FMI2_MASTER_TYPES];
+	fmi2_value_reference_t* dstVr[FMI2_MASTER_TYPES];
+	void* buffers[2][FMI2_MASTER_TYPES]; /* double buffered for Jacobi stepping */
+	int front;                           /* buffer the inputs are set from */
+	fmi2_import_master_block_t* inputs;  /* grouped by destination FMU */
+	size_t* conversionSlot;              /* Real slots with unit conversion, ordered by slot */
+	fmi2_real_t* conversionFactor;
+	fmi2_real_t* conversionOffset;
+	size_t* order;
+	jm_thread_pool_t* pool;
+
+	/* arguments of the current step for the pool tasks */
+	fmi2_real_t time;
+	fmi2_real_t stepSize;
+	void** readBuffers;
+	void** writeBuffers;
+
+	/* adaptive communication step size */
+	int isAdaptive;
+	fmi2_import_master_step_control_t control;
+	fmi2_real_t nextStepSize;
+	int canRollback;
+	int setDerivatives;                              /* set the input derivatives in the current step */
+	fmi2_real_t* derivatives[FMI2_MASTER_MAX_ORDER]; /* output derivatives of the Real slots at the start of the step */
+	fmi2_integer_t* orders[FMI2_MASTER_MAX_ORDER];   /* the order in all entries, for the derivative calls */
+	void* saved[FMI2_MASTER_TYPES];                  /* slots at the start of the step */
+
+	fmi2_import_master_stats_t stats;
+};
+
+static const size_t fmi2_import_master_type_size[FMI2_MASTER_TYPES] = {
+	sizeof(fmi2_real_t), sizeof(fmi2_integer_t), sizeof(fmi2_boolean_t)
+};
+
+static int fmi2_import_master_type_index(fmi2_base_type_enu_t bt) {
+	switch(bt) {
+	case fmi2_base_type_real: return 0;
+	case fmi2_base_type_int:
+	case fmi2_base_type_enum: return 1;
+	case fmi2_base_type_bool: return 2;
+	default: return -1;
+	}
+}
+
+static fmi2_import_master_fmu_t* fmi2_import_master_get(fmi2_import_master_t* m, size_t i) {
+	return (fmi2_import_master_fmu_t*)jm_vector_get_item(jm_voidp)(&m->fmus, i);
+}
+
+static void fmi2_import_master_free_plan(fmi2_import_master_t* m) {
+	jm_callbacks* cb = m->callbacks;
+	int t;
+	for(t = 0; t < FMI2_MASTER_TYPES; t++) {
+		cb->free(m->srcVr[t]);
+		cb->free(m->dstVr[t]);
+		cb->free(m->buffers[0][t]);
+		cb->free(m->buffers[1][t]);
+		cb->free(m->saved[t]);
+		m->srcVr[t] = m->dstVr[t] = 0;
+		m->buffers[0][t] = m->buffers[1][t] = 0;
+		m->saved[t] = 0;
+		m->slotsNum[t] = 0;
+	}
+	for(t = 0; t < FMI2_MASTER_MAX_ORDER; t++) {
+		cb->free(m->derivatives[t]);
+		cb->free(m->orders[t]);
+		m->derivatives[t] = 0;
+		m->orders[t] = 0;
+	}
+	cb->free(m->inputs);
+	cb->free(m->conversionSlot);
+	cb->free(m->conversionFactor);
+	cb->free(m->conversionOffset);
+	cb->free(m->order);
+	m->inputs = 0;
+	m->conversionSlot = 0;
+	m->conversionFactor = 0;
+	m->conversionOffset = 0;
+	m->order = 0;
+	m->isPrepared = 0;
+}
+
+/* Free the FMU states kept for rollback */
+static void fmi2_import_master_free_states(fmi2_import_master_t* m) {
+	size_t i;
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(&m->fmus); i++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+		if(f->state) fmi2_import_free_fmu_state(f->fmu, &f->state);
+	}
+}
+
+fmi2_import_master_t* fmi2_import_master_allocate(jm_callbacks* cb) {
+	fmi2_import_master_t* m;
+	if(!cb) cb = jm_get_default_callbacks();
+	m = (fmi2_import_master_t*)cb->calloc(1, sizeof(fmi2_import_master_t));
+	if(!m) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	m->callbacks = cb;
+	jm_vector_init(jm_voidp)(&m->fmus, 0, cb);
+	jm_vector_init(size_t)(&m->connSrcFmu, 0, cb);
+	jm_vector_init(jm_voidp)(&m->connSrcVar, 0, cb);
+	jm_vector_init(size_t)(&m->connDstFmu, 0, cb);
+	jm_vector_init(jm_voidp)(&m->connDstVar, 0, cb);
+	return m;
+}
+
+void fmi2_import_master_free(fmi2_import_master_t* m) {
+	jm_callbacks* cb;
+	size_t i;
+	if(!m) return;
+	cb = m->callbacks;
+	jm_thread_pool_destroy(m->pool);
+	fmi2_import_master_free_plan(m);
+	fmi2_import_master_free_states(m);
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(&m->fmus); i++) {
+		cb->free(fmi2_import_master_get(m, i));
+	}
+	jm_vector_free_data(jm_voidp)(&m->fmus);
+	jm_vector_free_data(size_t)(&m->connSrcFmu);
+	jm_vector_free_data(jm_voidp)(&m->connSrcVar);
+	jm_vector_free_data(size_t)(&m->connDstFmu);
+	jm_vector_free_data(jm_voidp)(&m->connDstVar);
+	cb->free(m);
+}
+
+jm_status_enu_t fmi2_import_master_add_fmu(fmi2_import_master_t* m, fmi2_import_t* fmu, size_t* fmuIndex) {
+	fmi2_import_master_fmu_t* f;
+	if(fmi2_import_get_fmu_kind(fmu) == fmi2_fmu_kind_me) {
+		jm_log_error(m->callbacks, module, "The co-simulation master only supports co-simulation FMUs");
+		return jm_status_error;
+	}
+	f = (fmi2_import_master_fmu_t*)m->callbacks->calloc(1, sizeof(fmi2_import_master_fmu_t));
+	if(!f || !jm_vector_push_back(jm_voidp)(&m->fmus, f)) {
+		m->callbacks->free(f);
+		jm_log_fatal(m->callbacks, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	f->fmu = fmu;
+	if(fmuIndex) *fmuIndex = jm_vector_get_size(jm_voidp)(&m->fmus) - 1;
+	m->isPrepared = 0;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_master_connect(fmi2_import_master_t* m, size_t srcFmu, const char* output, size_t dstFmu, const char* input) {
+	size_t nFmus = jm_vector_get_size(jm_voidp)(&m->fmus);
+	fmi2_import_variable_t *src, *dst;
+	int type;
+	size_t i;
+
+	if(srcFmu >= nFmus || dstFmu >= nFmus) {
+		jm_log_error(m->callbacks, module, "FMU index out of range");
+		return jm_status_error;
+	}
+	src = fmi2_import_get_variable_by_name(fmi2_import_master_get(m, srcFmu)->fmu, output);
+	dst = fmi2_import_get_variable_by_name(fmi2_import_master_get(m, dstFmu)->fmu, input);
+	if(!src || !dst) {
+		jm_log_error(m->callbacks, module, "Unknown variable %s", src ? input : output);
+		return jm_status_error;
+	}
+	type = fmi2_import_master_type_index(fmi2_import_get_variable_base_type(src));
+	if(type < 0) {
+		jm_log_error(m->callbacks, module, "Cannot connect %s: only Real, Integer, Enumeration and Boolean variables are supported", output);
+		return jm_status_error;
+	}
+	if(type != fmi2_import_master_type_index(fmi2_import_get_variable_base_type(dst))) {
+		jm_log_error(m->callbacks, module, "Cannot connect %s to %s: the variable types differ", output, input);
+		return jm_status_error;
+	}
+	if(fmi2_import_get_causality(src) != fmi2_causality_enu_output) {
+		jm_log_warning(m->callbacks, module, "Connected variable %s is not an output", output);
+	}
+	if(fmi2_import_get_causality(dst) != fmi2_causality_enu_input) {
+		jm_log_warning(m->callbacks, module, "Connected variable %s is not an input", input);
+	}
+	for(i = 0; i < jm_vector_get_size(size_t)(&m->connDstFmu); i++) {
+		fmi2_import_variable_t* v = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(&m->connDstVar, i);
+		if(jm_vector_get_item(size_t)(&m->connDstFmu, i) == dstFmu &&
+		   fmi2_import_get_variable_vr(v) == fmi2_import_get_variable_vr(dst) &&
+		   fmi2_import_master_type_index(fmi2_import_get_variable_base_type(v)) == type) {
+			jm_log_error(m->callbacks, module, "Input %s is already connected", input);
+			return jm_status_error;
+		}
+	}
+	if(!jm_vector_push_back(size_t)(&m->connSrcFmu, srcFmu) ||
+	   !jm_vector_push_back(jm_voidp)(&m->connSrcVar, src) ||
+	   !jm_vector_push_back(size_t)(&m->connDstFmu, dstFmu) ||
+	   !jm_vector_push_back(jm_voidp)(&m->connDstVar, dst)) {
+		jm_log_fatal(m->callbacks, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	m->isPrepared = 0;
+	return jm_status_success;
+}
+
+void fmi2_import_master_set_unit_conversion(fmi2_import_master_t* m, int enable) {
+	m->unitConversion = enable;
+	m->isPrepared = 0;
+}
+
+static int fmi2_import_master_compare_link(const void* a, const void* b) {
+	const fmi2_import_master_link_t* la = (const fmi2_import_master_link_t*)a;
+	const fmi2_import_master_link_t* lb = (const fmi2_import_master_link_t*)b;
+	if(la->type != lb->type) return la->type - lb->type;
+	if(la->srcFmu != lb->srcFmu) return (la->srcFmu > lb->srcFmu) ? 1 : -1;
+	if(la->dstFmu != lb->dstFmu) return (la->dstFmu > lb->dstFmu) ? 1 : -1;
+	return (la->dstVr > lb->dstVr) - (la->dstVr < lb->dstVr);
+}
+
+/* Linear conversion from the unit of the output to the unit of the input. Returns zero for the identity. */
+static int fmi2_import_master_get_conversion(fmi2_import_master_t* m, fmi2_import_variable_t* src, fmi2_import_variable_t* dst, fmi2_real_t* factor, fmi2_real_t* offset) {
+	fmi2_import_real_variable_t* rs = fmi2_import_get_variable_as_real(src);
+	fmi2_import_real_variable_t* rd = fmi2_import_get_variable_as_real(dst);
+	fmi2_import_unit_t* us = fmi2_import_get_real_variable_unit(rs);
+	fmi2_import_unit_t* ud = fmi2_import_get_real_variable_unit(rd);
+	const int *es, *ed;
+	double fs, fd;
+	int k;
+
+	*factor = 1.0;
+	*offset = 0.0;
+	if(!us || !ud || us == ud) return 0;
+	es = fmi2_import_get_SI_unit_exponents(us);
+	ed = fmi2_import_get_SI_unit_exponents(ud);
+	for(k = 0; k < fmi2_SI_base_units_Num; k++) {
+		if(es[k] != ed[k]) {
+			jm_log_warning(m->callbacks, module, "Units of %s and %s are not compatible, values are not converted",
+				fmi2_import_get_variable_name(src), fmi2_import_get_variable_name(dst));
+			return 0;
+		}
+	}
+	fs = fmi2_import_get_SI_unit_factor(us);
+	fd = fmi2_import_get_SI_unit_factor(ud);
+	*factor = fs / fd;
+	if(!fmi2_import_get_real_variable_relative_quantity(rs) && !fmi2_import_get_real_variable_relative_quantity(rd)) {
+		*offset = (fmi2_import_get_SI_unit_offset(us) - fmi2_import_get_SI_unit_offset(ud)) / fd;
+	}
+	return *factor != 1.0 || *offset != 0.0;
+}
+
+/* Assign the connection slots, allocate the buffers and build the input blocks and conversions */
+static jm_status_enu_t fmi2_import_master_plan_buffers(fmi2_import_master_t* m) {
+	jm_callbacks* cb = m->callbacks;
+	size_t nFmus = jm_vector_get_size(jm_voidp)(&m->fmus);
+	size_t nConn = jm_vector_get_size(size_t)(&m->connSrcFmu);
+	fmi2_import_master_link_t* links;
+	size_t *blocksNum, *next;
+	size_t i, c, slot, nBlocks = 0, nConversions = 0;
+	int t;
+
+	links = (fmi2_import_master_link_t*)cb->calloc(nConn ? nConn : 1, sizeof(fmi2_import_master_link_t));
+	blocksNum = (size_t*)cb->calloc(nFmus + 1, sizeof(size_t));
+	next = (size_t*)cb->calloc(nFmus + 1, sizeof(size_t));
+	if(!links || !blocksNum || !next) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(links); cb->free(blocksNum); cb->free(next);
+		return jm_status_error;
+	}
+	for(c = 0; c < nConn; c++) {
+		fmi2_import_variable_t* src = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(&m->connSrcVar, c);
+		fmi2_import_variable_t* dst = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(&m->connDstVar, c);
+		links[c].type = fmi2_import_master_type_index(fmi2_import_get_variable_base_type(src));
+		links[c].srcFmu = jm_vector_get_item(size_t)(&m->connSrcFmu, c);
+		links[c].dstFmu = jm_vector_get_item(size_t)(&m->connDstFmu, c);
+		links[c].srcVr = fmi2_import_get_variable_vr(src);
+		links[c].dstVr = fmi2_import_get_variable_vr(dst);
+		links[c].connection = c;
+		m->slotsNum[links[c].type]++;
+	}
+	qsort(links, nConn, sizeof(fmi2_import_master_link_t), fmi2_import_master_compare_link);
+
+	for(t = 0; t < FMI2_MASTER_TYPES; t++) {
+		size_t n = m->slotsNum[t] ? m->slotsNum[t] : 1;
+		m->srcVr[t] = (fmi2_value_reference_t*)cb->calloc(n, sizeof(fmi2_value_reference_t));
+		m->dstVr[t] = (fmi2_value_reference_t*)cb->calloc(n, sizeof(fmi2_value_reference_t));
+		m->buffers[0][t] = cb->calloc(n, fmi2_import_master_type_size[t]);
+		m->buffers[1][t] = cb->calloc(n, fmi2_import_master_type_size[t]);
+		if(!m->srcVr[t] || !m->dstVr[t] || !m->buffers[0][t] || !m->buffers[1][t]) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			cb->free(links); cb->free(blocksNum); cb->free(next);
+			return jm_status_error;
+		}
+	}
+
+	/* slots and output ranges; an input block is a run of slots with the same type, source and destination */
+	for(i = 0; i < nFmus; i++) {
+		memset(fmi2_import_master_get(m, i)->outputs, 0, sizeof(fmi2_import_master_get(m, i)->outputs));
+	}
+	slot = 0;
+	for(c = 0; c < nConn; c++) {
+		fmi2_import_master_link_t* l = &links[c];
+		fmi2_import_master_block_t* out = &fmi2_import_master_get(m, l->srcFmu)->outputs[l->type];
+		if(c == 0 || l->type != links[c - 1].type) slot = 0;
+		if(out->n == 0) {
+			out->type = l->type;
+			out->first = slot;
+		}
+		out->n++;
+		m->srcVr[l->type][slot] = l->srcVr;
+		m->dstVr[l->type][slot] = l->dstVr;
+		l->slot = slot;
+		slot++;
+		if(c == 0 || l->type != links[c - 1].type || l->srcFmu != links[c - 1].srcFmu || l->dstFmu != links[c - 1].dstFmu) {
+			blocksNum[l->dstFmu + 1]++;
+			nBlocks++;
+		}
+	}
+	m->inputs = (fmi2_import_master_block_t*)cb->calloc(nBlocks ? nBlocks : 1, sizeof(fmi2_import_master_block_t));
+	if(!m->inputs) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(links); cb->free(blocksNum); cb->free(next);
+		return jm_status_error;
+	}
+	for(i = 0; i < nFmus; i++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+		blocksNum[i + 1] += blocksNum[i];
+		next[i] = blocksNum[i];
+		f->firstInput = blocksNum[i];
+		f->inputsNum = 0;
+	}
+	for(c = 0; c < nConn; c++) {
+		fmi2_import_master_link_t* l = &links[c];
+		fmi2_import_master_fmu_t* d = fmi2_import_master_get(m, l->dstFmu);
+		if(c == 0 || l->type != links[c - 1].type || l->srcFmu != links[c - 1].srcFmu || l->dstFmu != links[c - 1].dstFmu) {
+			fmi2_import_master_block_t* b = &m->inputs[next[l->dstFmu]++];
+			b->type = l->type;
+			b->first = l->slot;
+			b->fmu = l->srcFmu;
+			d->inputsNum++;
+		}
+		m->inputs[next[l->dstFmu] - 1].n++;
+	}
+
+	/* unit conversions of Real slots; ordered by slot and therefore grouped by source FMU */
+	if(m->unitConversion && m->slotsNum[0]) {
+		m->conversionSlot = (size_t*)cb->calloc(m->slotsNum[0], sizeof(size_t));
+		m->conversionFactor = (fmi2_real_t*)cb->calloc(m->slotsNum[0], sizeof(fmi2_real_t));
+		m->conversionOffset = (fmi2_real_t*)cb->calloc(m->slotsNum[0], sizeof(fmi2_real_t));
+		if(!m->conversionSlot || !m->conversionFactor || !m->conversionOffset) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			cb->free(links); cb->free(blocksNum); cb->free(next);
+			return jm_status_error;
+		}
+	}
+	for(i = 0; i < nFmus; i++) {
+		fmi2_import_master_get(m, i)->conversionsNum = 0;
+	}
+	for(c = 0; m->conversionSlot && c < nConn && links[c].type == 0; c++) {
+		size_t conn = links[c].connection;
+		fmi2_real_t factor, offset;
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, links[c].srcFmu);
+		if(!fmi2_import_master_get_conversion(m,
+				(fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(&m->connSrcVar, conn),
+				(fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(&m->connDstVar, conn), &factor, &offset)) {
+			continue;
+		}
+		if(f->conversionsNum == 0) f->firstConversion = nConversions;
+		f->conversionsNum++;
+		m->conversionSlot[nConversions] = links[c].slot;
+		m->conversionFactor[nConversions] = factor;
+		m->conversionOffset[nConversions] = offset;
+		nConversions++;
+	}
+	if(nConversions) {
+		jm_log_verbose(cb, module, "Converting units on %u connections", (unsigned)nConversions);
+	}
+
+	cb->free(links);
+	cb->free(blocksNum);
+	cb->free(next);
+	return jm_status_success;
+}
+
+/* Check if an input has direct feedthrough to any output */
+static int fmi2_import_master_is_feedthrough(fmi2_import_t* fmu, fmi2_import_variable_t* input) {
+	size_t *start, *dependent;
+	size_t v = fmi2_import_get_variable_original_order(input);
+	if(fmi2_import_get_dependents(fmu, fmi2_import_dependency_outputs, &start, &dependent) != jm_status_success) {
+		return 1;
+	}
+	return start[v + 1] > start[v];
+}
+
+/* Gauss-Seidel order: topological order of the connection graph. When only FMUs with pending
+   inputs remain, the one with the fewest pending feedthrough inputs, then fewest pending inputs, is taken. */
+static jm_status_enu_t fmi2_import_master_plan_order(fmi2_import_master_t* m) {
+	jm_callbacks* cb = m->callbacks;
+	size_t nFmus = jm_vector_get_size(jm_voidp)(&m->fmus);
+	size_t nConn = jm_vector_get_size(size_t)(&m->connSrcFmu);
+	size_t *pending, *pendingFt;
+	char *isFt, *placed;
+	size_t i, k, c;
+
+	m->order = (size_t*)cb->calloc(nFmus ? nFmus : 1, sizeof(size_t));
+	pending = (size_t*)cb->calloc(nFmus ? nFmus : 1, sizeof(size_t));
+	pendingFt = (size_t*)cb->calloc(nFmus ? nFmus : 1, sizeof(size_t));
+	placed = (char*)cb->calloc(nFmus ? nFmus : 1, 1);
+	isFt = (char*)cb->calloc(nConn ? nConn : 1, 1);
+	if(!m->order || !pending || !pendingFt || !placed || !isFt) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(pending); cb->free(pendingFt); cb->free(placed); cb->free(isFt);
+		return jm_status_error;
+	}
+	for(c = 0; c < nConn; c++) {
+		size_t srcFmu = jm_vector_get_item(size_t)(&m->connSrcFmu, c);
+		size_t dstFmu = jm_vector_get_item(size_t)(&m->connDstFmu, c);
+		if(srcFmu == dstFmu) continue;
+		isFt[c] = (char)fmi2_import_master_is_feedthrough(fmi2_import_master_get(m, dstFmu)->fmu,
+			(fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(&m->connDstVar, c));
+		pending[dstFmu]++;
+		if(isFt[c]) pendingFt[dstFmu]++;
+	}
+	for(k = 0; k < nFmus; k++) {
+		size_t best = nFmus;
+		for(i = 0; i < nFmus; i++) {
+			if(placed[i]) continue;
+			if(best == nFmus || pendingFt[i] < pendingFt[best] ||
+			   (pendingFt[i] == pendingFt[best] && pending[i] < pending[best])) {
+				best = i;
+			}
+		}
+		if(pending[best]) {
+			jm_log_verbose(cb, module, "Breaking a loop between FMUs at FMU %u", (unsigned)best);
+		}
+		placed[best] = 1;
+		m->order[k] = best;
+		for(c = 0; c < nConn; c++) {
+			size_t dstFmu = jm_vector_get_item(size_t)(&m->connDstFmu, c);
+			if(jm_vector_get_item(size_t)(&m->connSrcFmu, c) != best || dstFmu == best || placed[dstFmu]) continue;
+			pending[dstFmu]--;
+			if(isFt[c]) pendingFt[dstFmu]--;
+		}
+	}
+	for(k = 0; k < nFmus; k++) {
+		fmi2_import_master_get(m, m->order[k])->position = k;
+	}
+	cb->free(pending); cb->free(pendingFt); cb->free(placed); cb->free(isFt);
+	return jm_status_success;
+}
+
+/* Check the capabilities for the adaptive step size and allocate the derivatives and saved slots */
+static jm_status_enu_t fmi2_import_master_plan_adaptive(fmi2_import_master_t* m) {
+	jm_callbacks* cb = m->callbacks;
+	size_t nFmus = jm_vector_get_size(jm_voidp)(&m->fmus);
+	size_t n = m->slotsNum[0] ? m->slotsNum[0] : 1, i, s;
+	int k, t;
+
+	m->canRollback = 1;
+	for(i = 0; i < nFmus; i++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+		unsigned int order = fmi2_import_get_capability(f->fmu, fmi2_cs_maxOutputDerivativeOrder);
+		if(!fmi2_import_get_capability(f->fmu, fmi2_cs_canHandleVariableCommunicationStepSize)) {
+			jm_log_error(cb, module, "FMU %u cannot handle a variable communication step size", (unsigned)i);
+			return jm_status_error;
+		}
+		f->outputOrder = (order < m->control.maxDerivativeOrder) ? order : m->control.maxDerivativeOrder;
+		f->canInterpolate = fmi2_import_get_capability(f->fmu, fmi2_cs_canInterpolateInputs) != 0;
+		if(!fmi2_import_get_capability(f->fmu, fmi2_cs_canGetAndSetFMUstate)) m->canRollback = 0;
+	}
+	if(!m->canRollback) {
+		jm_log_warning(cb, module, "Not all FMUs can get and set their state, adaptive steps are accepted without rollback");
+	}
+	for(k = 0; k < FMI2_MASTER_MAX_ORDER; k++) {
+		m->derivatives[k] = (fmi2_real_t*)cb->calloc(n, sizeof(fmi2_real_t));
+		m->orders[k] = (fmi2_integer_t*)cb->calloc(n, sizeof(fmi2_integer_t));
+		if(!m->derivatives[k] || !m->orders[k]) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+		for(s = 0; s < n; s++) m->orders[k][s] = k + 1;
+	}
+	for(t = 0; t < FMI2_MASTER_TYPES; t++) {
+		m->saved[t] = cb->calloc(m->slotsNum[t] ? m->slotsNum[t] : 1, fmi2_import_master_type_size[t]);
+		if(!m->saved[t]) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+	}
+	m->nextStepSize = m->control.initialStepSize;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_master_prepare(fmi2_import_master_t* m, fmi2_import_master_mode_enu_t mode, size_t threadsNum) {
+	size_t nFmus = jm_vector_get_size(jm_voidp)(&m->fmus);
+
+	fmi2_import_master_free_plan(m);
+	fmi2_import_master_free_states(m);
+	m->mode = mode;
+	if(fmi2_import_master_plan_buffers(m) != jm_status_success ||
+	   fmi2_import_master_plan_order(m) != jm_status_success ||
+	   (m->isAdaptive && fmi2_import_master_plan_adaptive(m) != jm_status_success)) {
+		fmi2_import_master_free_plan(m);
+		return jm_status_error;
+	}
+	m->mode = mode;
+	m->front = 0;
+
+	if(threadsNum == 0 || threadsNum > nFmus) threadsNum = nFmus;
+	if(mode != fmi2_import_master_jacobi || threadsNum < 2) {
+		jm_thread_pool_destroy(m->pool);
+		m->pool = 0;
+	}
+	else if(!m->pool || jm_thread_pool_get_threads_num(m->pool) != threadsNum) {
+		jm_thread_pool_destroy(m->pool);
+		m->pool = jm_thread_pool_create(m->callbacks, threadsNum);
+		if(!m->pool) {
+			fmi2_import_master_free_plan(m);
+			return jm_status_error;
+		}
+	}
+	m->isPrepared = 1;
+	jm_log_verbose(m->callbacks, module, "Prepared co-simulation of %u FMUs with %u connections",
+		(unsigned)nFmus, (unsigned)jm_vector_get_size(size_t)(&m->connSrcFmu));
+	return jm_status_success;
+}
+
+/* Set the inputs of one FMU directly from the connection slots, one call per block */
+static fmi2_status_t fmi2_import_master_set_inputs(fmi2_import_master_t* m, fmi2_import_master_fmu_t* f, void** buffers) {
+	fmi2_status_t status = fmi2_status_ok;
+	size_t k;
+	for(k = f->firstInput; k < f->firstInput + f->inputsNum; k++) {
+		const fmi2_import_master_block_t* b = &m->inputs[k];
+		const fmi2_value_reference_t* vr = m->dstVr[b->type] + b->first;
+		switch(b->type) {
+		case 0:
+			status = FMI2_MASTER_WORST(status, fmi2_import_set_real(f->fmu, vr, b->n, (fmi2_real_t*)buffers[0] + b->first));
+			break;
+		case 1:
+			status = FMI2_MASTER_WORST(status, fmi2_import_set_integer(f->fmu, vr, b->n, (fmi2_integer_t*)buffers[1] + b->first));
+			break;
+		default:
+			status = FMI2_MASTER_WORST(status, fmi2_import_set_boolean(f->fmu, vr, b->n, (fmi2_boolean_t*)buffers[2] + b->first));
+			break;
+		}
+	}
+	return status;
+}
+
+/* Get the outputs of one FMU directly into its connection slots and convert units in place */
+static fmi2_status_t fmi2_import_master_get_outputs(fmi2_import_master_t* m, fmi2_import_master_fmu_t* f, void** buffers) {
+	fmi2_status_t status = fmi2_status_ok;
+	const fmi2_import_master_block_t* p = f->outputs;
+	fmi2_real_t* reals = (fmi2_real_t*)buffers[0];
+	size_t k;
+	if(p[0].n) status = FMI2_MASTER_WORST(status, fmi2_import_get_real(f->fmu, m->srcVr[0] + p[0].first, p[0].n, reals + p[0].first));
+	if(p[1].n) status = FMI2_MASTER_WORST(status, fmi2_import_get_integer(f->fmu, m->srcVr[1] + p[1].first, p[1].n, (fmi2_integer_t*)buffers[1] + p[1].first));
+	if(p[2].n) status = FMI2_MASTER_WORST(status, fmi2_import_get_boolean(f->fmu, m->srcVr[2] + p[2].first, p[2].n, (fmi2_boolean_t*)buffers[2] + p[2].first));
+	for(k = f->firstConversion; k < f->firstConversion + f->conversionsNum; k++) {
+		fmi2_real_t* v = reals + m->conversionSlot[k];
+		*v = *v * m->conversionFactor[k] + m->conversionOffset[k];
+	}
+	return status;
+}
+
+/* Order of the polynomial a Real input block is extrapolated with during a step,
+   -1 if the values come from the end of the step since the source is stepped first */
+static int fmi2_import_master_extrapolation_order(fmi2_import_master_t* m, fmi2_import_master_fmu_t* f, const fmi2_import_master_block_t* b) {
+	fmi2_import_master_fmu_t* src;
+	if(b->type != 0) return -1;
+	src = fmi2_import_master_get(m, b->fmu);
+	if(m->mode == fmi2_import_master_gauss_seidel && src->position < f->position) return -1;
+	return f->canInterpolate ? (int)src->outputOrder : 0;
+}
+
+/* Set the derivatives of the extrapolated Real inputs of an FMU that can interpolate inputs */
+static fmi2_status_t fmi2_import_master_set_input_derivatives(fmi2_import_master_t* m, fmi2_import_master_fmu_t* f) {
+	fmi2_status_t status = fmi2_status_ok;
+	size_t k;
+	int order, q;
+	if(!f->canInterpolate) return status;
+	for(k = f->firstInput; k < f->firstInput + f->inputsNum; k++) {
+		const fmi2_import_master_block_t* b = &m->inputs[k];
+		q = fmi2_import_master_extrapolation_order(m, f, b);
+		for(order = 0; order < q; order++) {
+			status = FMI2_MASTER_WORST(status, fmi2_import_set_real_input_derivatives(f->fmu, m->dstVr[0] + b->first, b->n,
+				m->orders[order] + b->first, m->derivatives[order] + b->first));
+		}
+	}
+	return status;
+}
+
+/* Get the derivatives of the Real outputs at the start of a step and convert their units */
+static fmi2_status_t fmi2_import_master_get_output_derivatives(fmi2_import_master_t* m) {
+	fmi2_status_t status = fmi2_status_ok;
+	size_t i, k;
+	unsigned int order;
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(&m->fmus); i++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+		const fmi2_import_master_block_t* b = &f->outputs[0];
+		if(!b->n) continue;
+		for(order = 0; order < f->outputOrder; order++) {
+			status = FMI2_MASTER_WORST(status, fmi2_import_get_real_output_derivatives(f->fmu, m->srcVr[0] + b->first, b->n,
+				m->orders[order] + b->first, m->derivatives[order] + b->first));
+			for(k = f->firstConversion; k < f->firstConversion + f->conversionsNum; k++) {
+				m->derivatives[order][m->conversionSlot[k]] *= m->conversionFactor[k];
+			}
+		}
+	}
+	return status;
+}
+
+/* Keep the previous outputs of an FMU whose outputs could not be read */
+static void fmi2_import_master_keep_outputs(fmi2_import_master_t* m, fmi2_import_master_fmu_t* f) {
+	int t;
+	if(m->readBuffers == m->writeBuffers) return;
+	for(t = 0; t < FMI2_MASTER_TYPES; t++) {
+		size_t sz = fmi2_import_master_type_size[t];
+		if(!f->outputs[t].n) continue;
+		memcpy((char*)m->writeBuffers[t] + f->outputs[t].first * sz,
+			(char*)m->readBuffers[t] + f->outputs[t].first * sz, f->outputs[t].n * sz);
+	}
+}
+
+/* Set inputs, step and get outputs of one FMU */
+static void fmi2_import_master_step_fmu(fmi2_import_master_t* m, size_t i) {
+	fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+	double start = jm_portability_get_time(), exchangeStart, dt;
+	fmi2_status_t status = fmi2_import_master_set_inputs(m, f, m->readBuffers);
+
+	exchangeStart = jm_portability_get_time();
+	f->exchangeTime = exchangeStart - start;
+	fmi_trace_recorder_slice("set inputs", "master", start, exchangeStart);
+	if(m->setDerivatives && status < fmi2_status_error) {
+		status = FMI2_MASTER_WORST(status, fmi2_import_master_set_input_derivatives(m, f));
+	}
+	if(status < fmi2_status_error) {
+		status = FMI2_MASTER_WORST(status, fmi2_import_do_step(f->fmu, m->time, m->stepSize, fmi2_true));
+	}
+	exchangeStart = jm_portability_get_time();
+	if(status < fmi2_status_error) {
+		status = FMI2_MASTER_WORST(status, fmi2_import_master_get_outputs(m, f, m->writeBuffers));
+	}
+	else {
+		fmi2_import_master_keep_outputs(m, f);
+	}
+	f->status = status;
+
+	dt = jm_portability_get_time();
+	f->exchangeTime += dt - exchangeStart;
+	fmi_trace_recorder_slice("get outputs", "master", exchangeStart, dt);
+	dt -= start;
+	f->stats.lastStepTime = dt;
+	f->stats.totalStepTime += dt;
+	if(dt > f->stats.maxStepTime) f->stats.maxStepTime = dt;
+}
+
+static void fmi2_import_master_step_task(void* context, size_t index) {
+	fmi2_import_master_step_fmu((fmi2_import_master_t*)context, index);
+}
+
+static jm_status_enu_t fmi2_import_master_check_prepared(fmi2_import_master_t* m) {
+	if(!m->isPrepared) {
+		jm_log_error(m->callbacks, module, "The co-simulation master must be prepared with fmi2_import_master_prepare()");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+fmi2_status_t fmi2_import_master_exchange(fmi2_import_master_t* m) {
+	size_t nFmus = jm_vector_get_size(jm_voidp)(&m->fmus);
+	fmi2_status_t status = fmi2_status_ok;
+	void** front;
+	double start;
+	size_t k;
+	int t;
+
+	if(fmi2_import_master_check_prepared(m) != jm_status_success) return fmi2_status_error;
+	start = jm_portability_get_time();
+	front = m->buffers[m->front];
+	for(k = 0; k < nFmus; k++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, m->order[k]);
+		f->status = fmi2_import_master_set_inputs(m, f, front);
+		f->status = FMI2_MASTER_WORST(f->status, fmi2_import_master_get_outputs(m, f, front));
+		status = FMI2_MASTER_WORST(status, f->status);
+	}
+	for(t = 0; t < FMI2_MASTER_TYPES; t++) {
+		memcpy(m->buffers[1 - m->front][t], front[t], m->slotsNum[t] * fmi2_import_master_type_size[t]);
+	}
+	fmi_trace_recorder_slice("exchange", "master", start, jm_portability_get_time());
+	return status;
+}
+
+/* Step all FMUs once and collect their status */
+static fmi2_status_t fmi2_import_master_step_all(fmi2_import_master_t* m, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize) {
+	size_t nFmus = jm_vector_get_size(jm_voidp)(&m->fmus);
+	fmi2_status_t status = fmi2_status_ok;
+	size_t i, k;
+
+	m->time = currentCommunicationPoint;
+	m->stepSize = communicationStepSize;
+
+	if(m->mode == fmi2_import_master_jacobi) {
+		/* all FMUs read the outputs of the previous step and write to the other buffer */
+		m->readBuffers = m->buffers[m->front];
+		m->writeBuffers = m->buffers[1 - m->front];
+		if(m->pool) {
+			jm_thread_pool_run(m->pool, nFmus, fmi2_import_master_step_task, m);
+		}
+		else {
+			for(i = 0; i < nFmus; i++) fmi2_import_master_step_fmu(m, i);
+		}
+		m->front = 1 - m->front;
+	}
+	else {
+		m->readBuffers = m->writeBuffers = m->buffers[m->front];
+		for(k = 0; k < nFmus; k++) fmi2_import_master_step_fmu(m, m->order[k]);
+	}
+	for(i = 0; i < nFmus; i++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+		status = FMI2_MASTER_WORST(status, f->status);
+		m->stats.totalExchangeTime += f->exchangeTime;
+	}
+	return status;
+}
+
+static void fmi2_import_master_update_stats(fmi2_import_master_t* m, double start) {
+	double dt = jm_portability_get_time();
+	fmi_trace_recorder_slice("co-simulation step", "master", start, dt);
+	dt -= start;
+	m->stats.stepsNum++;
+	m->stats.lastStepTime = dt;
+	m->stats.totalStepTime += dt;
+	if(dt > m->stats.maxStepTime) m->stats.maxStepTime = dt;
+}
+
+fmi2_status_t fmi2_import_master_do_step(fmi2_import_master_t* m, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize) {
+	fmi2_status_t status;
+	double start;
+
+	if(fmi2_import_master_check_prepared(m) != jm_status_success) return fmi2_status_error;
+	start = jm_portability_get_time();
+	status = fmi2_import_master_step_all(m, currentCommunicationPoint, communicationStepSize);
+	fmi2_import_master_update_stats(m, start);
+	return status;
+}
+
+void fmi2_import_master_get_default_step_control(fmi2_import_master_step_control_t* control) {
+	control->relativeTolerance = 1e-4;
+	control->absoluteTolerance = 1e-4;
+	control->initialStepSize = 1e-3;
+	control->minStepSize = 1e-6;
+	control->maxStepSize = 1.0;
+	control->safetyFactor = 0.9;
+	control->maxIncrease = 2.0;
+	control->maxDecrease = 0.2;
+	control->maxDerivativeOrder = FMI2_MASTER_MAX_ORDER;
+}
+
+jm_status_enu_t fmi2_import_master_set_step_control(fmi2_import_master_t* m, const fmi2_import_master_step_control_t* control) {
+	m->isPrepared = 0;
+	if(!control) {
+		m->isAdaptive = 0;
+		return jm_status_success;
+	}
+	if(!(control->relativeTolerance >= 0 && control->absoluteTolerance > 0 &&
+	     control->minStepSize > 0 && control->minStepSize <= control->initialStepSize && control->initialStepSize <= control->maxStepSize &&
+	     control->safetyFactor > 0 && control->safetyFactor <= 1 && control->maxIncrease >= 1 &&
+	     control->maxDecrease > 0 && control->maxDecrease <= 1 && control->maxDerivativeOrder <= FMI2_MASTER_MAX_ORDER)) {
+		jm_log_error(m->callbacks, module, "Inconsistent step control parameters");
+		return jm_status_error;
+	}
+	m->control = *control;
+	m->isAdaptive = 1;
+	return jm_status_success;
+}
+
+/* Save the slots and, for rollback, the FMU states at the start of an adaptive step */
+static fmi2_status_t fmi2_import_master_save(fmi2_import_master_t* m) {
+	fmi2_status_t status = fmi2_status_ok;
+	size_t i;
+	int t;
+	for(t = 0; t < FMI2_MASTER_TYPES; t++) {
+		memcpy(m->saved[t], m->buffers[m->front][t], m->slotsNum[t] * fmi2_import_master_type_size[t]);
+	}
+	for(i = 0; m->canRollback && i < jm_vector_get_size(jm_voidp)(&m->fmus); i++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+		status = FMI2_MASTER_WORST(status, fmi2_import_get_fmu_state(f->fmu, &f->state));
+	}
+	return status;
+}
+
+/* Roll the FMUs and the slots back to the start of an adaptive step */
+static fmi2_status_t fmi2_import_master_restore(fmi2_import_master_t* m, int front) {
+	fmi2_status_t status = fmi2_status_ok;
+	size_t i;
+	int t;
+	m->front = front;
+	for(t = 0; t < FMI2_MASTER_TYPES; t++) {
+		memcpy(m->buffers[front][t], m->saved[t], m->slotsNum[t] * fmi2_import_master_type_size[t]);
+	}
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(&m->fmus); i++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+		status = FMI2_MASTER_WORST(status, fmi2_import_set_fmu_state(f->fmu, f->state));
+	}
+	return status;
+}
+
+/* Compare the outputs after a step with the extrapolation of the inputs. Sets the largest
+   error relative to the tolerance and returns the factor for the next step size. */
+static fmi2_real_t fmi2_import_master_estimate(fmi2_import_master_t* m, fmi2_real_t h, fmi2_real_t* error) {
+	const fmi2_import_master_step_control_t* c = &m->control;
+	const fmi2_real_t* y0 = (const fmi2_real_t*)m->saved[0];
+	const fmi2_real_t* y1 = (const fmi2_real_t*)m->buffers[m->front][0];
+	fmi2_real_t factor = c->maxIncrease;
+	size_t i, k, s;
+
+	*error = 0;
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(&m->fmus); i++) {
+		fmi2_import_master_fmu_t* f = fmi2_import_master_get(m, i);
+		for(k = f->firstInput; k < f->firstInput + f->inputsNum; k++) {
+			const fmi2_import_master_block_t* b = &m->inputs[k];
+			int q = fmi2_import_master_extrapolation_order(m, f, b);
+			if(q < 0) continue;
+			for(s = b->first; s < b->first + b->n; s++) {
+				fmi2_real_t p = y0[s], scale, e;
+				if(q > 0) p += h * m->derivatives[0][s];
+				if(q > 1) p += 0.5 * h * h * m->derivatives[1][s];
+				scale = c->absoluteTolerance + c->relativeTolerance * ((fabs(y0[s]) > fabs(y1[s])) ? fabs(y0[s]) : fabs(y1[s]));
+				e = fabs(y1[s] - p) / scale;
+				if(e > *error) *error = e;
+				/* the error of an extrapolation of order q grows with the step size to the power q + 1 */
+				if(e > 0) {
+					fmi2_real_t fs = c->safetyFactor * pow(e, -1.0 / (q + 1));
+					if(fs < factor) factor = fs;
+				}
+			}
+		}
+	}
+	return (factor < c->maxDecrease) ? c->maxDecrease : factor;
+}
+
+fmi2_status_t fmi2_import_master_do_adaptive_step(fmi2_import_master_t* m, fmi2_real_t currentCommunicationPoint, fmi2_real_t stopTime, fmi2_real_t* stepSize) {
+	const fmi2_import_master_step_control_t* c = &m->control;
+	fmi2_status_t status;
+	fmi2_real_t h, next, factor = 1.0, error = 0.0;
+	double start;
+	int front = m->front, isCut;
+
+	if(fmi2_import_master_check_prepared(m) != jm_status_success) return fmi2_status_error;
+	if(!m->isAdaptive) {
+		jm_log_error(m->callbacks, module, "The co-simulation master has no step control, see fmi2_import_master_set_step_control()");
+		return fmi2_status_error;
+	}
+	if(!(stopTime > currentCommunicationPoint)) {
+		jm_log_error(m->callbacks, module, "The stop time must be after the current communication point");
+		return fmi2_status_error;
+	}
+	start = jm_portability_get_time();
+	h = m->nextStepSize;
+	isCut = stopTime - currentCommunicationPoint <= h;
+	if(isCut) h = stopTime - currentCommunicationPoint;
+
+	status = fmi2_import_master_get_output_derivatives(m);
+	status = FMI2_MASTER_WORST(status, fmi2_import_master_save(m));
+	if(status >= fmi2_status_error) return status;
+
+	m->setDerivatives = 1;
+	for(;;) {
+		status = FMI2_MASTER_WORST(status, fmi2_import_master_step_all(m, currentCommunicationPoint, h));
+		if(status >= fmi2_status_error) break;
+		if(status == fmi2_status_discard) {
+			/* the FMUs could not complete the step, try half of it */
+			factor = 0.5;
+			error = 2.0;
+		}
+		else {
+			factor = fmi2_import_master_estimate(m, h, &error);
+		}
+		if(error <= 1.0 || !m->canRollback || h <= c->minStepSize) break;
+
+		jm_log_verbose(m->callbacks, module, "Rejected a step of size %g at time %g with relative coupling error %g",
+			h, currentCommunicationPoint, error);
+		m->stats.rejectedStepsNum++;
+		status = fmi2_import_master_restore(m, front);
+		if(status >= fmi2_status_error) break;
+		h *= factor;
+		if(h < c->minStepSize) h = c->minStepSize;
+		isCut = 0;
+	}
+	m->setDerivatives = 0;
+
+	if(status < fmi2_status_error) {
+		if(error > 1.0) {
+			jm_log_verbose(m->callbacks, module, "Accepted a step of size %g at time %g with relative coupling error %g",
+				h, currentCommunicationPoint, error);
+		}
+		next = h * factor;
+		/* a step shortened to the stop time does not reduce the next step */
+		if(isCut && factor >= 1.0 && next < m->nextStepSize) next = m->nextStepSize;
+		if(next > c->maxStepSize) next = c->maxStepSize;
+		if(next < c->minStepSize) next = c->minStepSize;
+		m->nextStepSize = next;
+	}
+	*stepSize = h;
+	fmi2_import_master_update_stats(m, start);
+	return status;
+}
+
+fmi2_real_t fmi2_import_master_get_next_step_size(fmi2_import_master_t* m) {
+	return m->nextStepSize;
+}
+
+size_t fmi2_import_master_get_fmus_num(fmi2_import_master_t* m) {
+	return jm_vector_get_size(jm_voidp)(&m->fmus);
+}
+
+fmi2_status_t fmi2_import_master_get_fmu_status(fmi2_import_master_t* m, size_t fmuIndex) {
+	return fmi2_import_master_get(m, fmuIndex)->status;
+}
+
+const size_t* fmi2_import_master_get_order(fmi2_import_master_t* m) {
+	return m->order;
+}
+
+void fmi2_import_master_get_stats(fmi2_import_master_t* m, fmi2_import_master_stats_t* stats) {
+	*stats = m->stats;
+}
+
+void fmi2_import_master_get_fmu_stats(fmi2_import_master_t* m, size_t fmuIndex, fmi2_import_master_fmu_stats_t* stats) {
+	*stats = fmi2_import_master_get(m, fmuIndex)->stats;
+}
+
+void fmi2_import_master_reset_stats(fmi2_import_master_t* m) {
+	size_t i;
+	memset(&m->stats, 0, sizeof(m->stats));
+	for(i = 0; i < jm_vector_get_size(jm_voidp)(&m->fmus); i++) {
+		memset(&fmi2_import_master_get(m, i)->stats, 0, sizeof(fmi2_import_master_fmu_stats_t));
+	}
+}
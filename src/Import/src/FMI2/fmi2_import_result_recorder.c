@@ -0,0 +1,838 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+#include <JM/jm_thread.h>
+
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_RESULT_DEFAULT_ROWS 256
+#define FMI2_RESULT_MAGIC "FMILRES\n"
+#define FMI2_RESULT_VERSION 1
+
+/* Column types: Real, Integer (and Enumeration), Boolean */
+#define FMI2_RESULT_TYPES 3
+
+#define FMI2_RESULT_WORST(a, b) (((b) > (a)) ? (b) : (a))
+
+/* MATLAB v4 element types */
+#define FMI2_MAT4_DOUBLE 0
+#define FMI2_MAT4_INT32 20
+#define FMI2_MAT4_TEXT 51
+
+typedef struct fmi2_result_entry_t {
+	const char* name;
+	const char* description;
+	int type;
+	fmi2_value_reference_t vr;
+	size_t column;  /* index among all columns, Real columns first */
+} fmi2_result_entry_t;
+
+/* Samples stored column by column: column * chunkRows + row */
+typedef struct fmi2_result_chunk_t {
+	fmi2_real_t* time;
+	fmi2_real_t* reals;
+	fmi2_integer_t* integers;
+	char* booleans;
+	size_t rows;
+	int isFull;     /* handed to the writer; protected by the recorder lock */
+} fmi2_result_chunk_t;
+
+struct fmi2_import_result_recorder_t {
+	jm_callbacks* callbacks;
+	fmi2_import_t* fmu;
+	size_t chunkRows;
+	int compression;
+
+	fmi2_result_entry_t* entries;
+	size_t entriesNum;
+	size_t entriesCapacity;
+
+	/* columns, valid while started */
+	size_t n[FMI2_RESULT_TYPES];
+	fmi2_value_reference_t* vr[FMI2_RESULT_TYPES];
+	fmi2_real_t* realRow;
+	fmi2_integer_t* integerRow;
+	fmi2_boolean_t* booleanRow;
+
+	fmi2_result_chunk_t chunks[2];
+	size_t fillIndex;
+	size_t samplesNum;
+	size_t stallsNum;
+	int isStarted;
+
+	FILE* file;
+	fmi2_import_result_format_enu_t format;
+	long mat4TimesPos;     /* position of the values of the "data_1" matrix */
+	long mat4SamplesPos;   /* position of the column count of the "data_2" matrix */
+
+	jm_mutex_t lock;        /* protects isFull of the chunks and isStopping */
+	jm_cond_t wake;         /* a chunk is full or the recorder stops */
+	jm_cond_t freed;        /* a chunk is written */
+	int isStopping;
+
+	/* used by the writer only */
+	jm_thread_t writer;
+	size_t writeIndex;
+	unsigned char* raw;
+	unsigned char* packed;
+	size_t rawSize;
+	size_t packedSize;
+	int writeFailed;
+	fmi2_real_t mat4Times[2]; /* first and last sample time written to a MAT-file */
+	size_t mat4RowsNum;       /* samples written to a MAT-file */
+};
+
+static int fmi2_result_type_index(fmi2_base_type_enu_t bt) {
+	switch(bt) {
+	case fmi2_base_type_real: return 0;
+	case fmi2_base_type_int:
+	case fmi2_base_type_enum: return 1;
+	case fmi2_base_type_bool: return 2;
+	default: return -1;
+	}
+}
+
+fmi2_import_result_recorder_t* fmi2_import_result_recorder_allocate(fmi2_import_t* fmu, size_t chunkRows) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_import_result_recorder_t* rec = (fmi2_import_result_recorder_t*)cb->calloc(1, sizeof(fmi2_import_result_recorder_t));
+	if(!rec) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	rec->callbacks = cb;
+	rec->fmu = fmu;
+	rec->chunkRows = chunkRows ? chunkRows : FMI2_RESULT_DEFAULT_ROWS;
+	return rec;
+}
+
+jm_status_enu_t fmi2_import_result_recorder_set_compression(fmi2_import_result_recorder_t* rec, int level) {
+	if(rec->isStarted || level < 0 || level > 9) {
+		jm_log_error(rec->callbacks, module, rec->isStarted ? "The result recorder is started" : "Compression level %d is out of range", level);
+		return jm_status_error;
+	}
+	rec->compression = level;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_result_recorder_add_variable(fmi2_import_result_recorder_t* rec, fmi2_import_variable_t* v) {
+	int type = fmi2_result_type_index(fmi2_import_get_variable_base_type(v));
+	fmi2_result_entry_t* e;
+
+	if(rec->isStarted) {
+		jm_log_error(rec->callbacks, module, "Variables cannot be added to a started result recorder");
+		return jm_status_error;
+	}
+	if(type < 0) {
+		jm_log_error(rec->callbacks, module, "String variable %s cannot be recorded", fmi2_import_get_variable_name(v));
+		return jm_status_error;
+	}
+	if(rec->entriesNum == rec->entriesCapacity) {
+		size_t capacity = rec->entriesCapacity ? 2 * rec->entriesCapacity : 64;
+		fmi2_result_entry_t* entries = (fmi2_result_entry_t*)rec->callbacks->realloc(rec->entries, capacity * sizeof(fmi2_result_entry_t));
+		if(!entries) {
+			jm_log_fatal(rec->callbacks, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+		rec->entries = entries;
+		rec->entriesCapacity = capacity;
+	}
+	e = &rec->entries[rec->entriesNum++];
+	e->name = fmi2_import_get_variable_name(v);
+	e->description = fmi2_import_get_variable_description(v);
+	if(!e->description) e->description = "";
+	e->type = type;
+	e->vr = fmi2_import_get_variable_vr(v);
+	e->column = 0;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_result_recorder_add_variables(fmi2_import_result_recorder_t* rec, fmi2_import_variable_list_t* vl) {
+	size_t i, n = fmi2_import_get_variable_list_size(vl), skipped = 0;
+	for(i = 0; i < n; i++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, i);
+		if(fmi2_result_type_index(fmi2_import_get_variable_base_type(v)) < 0) {
+			skipped++;
+			continue;
+		}
+		if(fmi2_import_result_recorder_add_variable(rec, v) != jm_status_success) return jm_status_error;
+	}
+	if(skipped) {
+		jm_log_warning(rec->callbacks, module, "%u String variables are not recorded", (unsigned)skipped);
+	}
+	return jm_status_success;
+}
+
+size_t fmi2_import_result_recorder_get_variables_num(fmi2_import_result_recorder_t* rec) {
+	return rec->entriesNum;
+}
+
+size_t fmi2_import_result_recorder_get_columns_num(fmi2_import_result_recorder_t* rec) {
+	return rec->n[0] + rec->n[1] + rec->n[2];
+}
+
+size_t fmi2_import_result_recorder_get_samples_num(fmi2_import_result_recorder_t* rec) {
+	return rec->samplesNum;
+}
+
+size_t fmi2_import_result_recorder_get_stalls_num(fmi2_import_result_recorder_t* rec) {
+	return rec->stallsNum;
+}
+
+/* Sort key of the alias collapse */
+typedef struct fmi2_result_key_t {
+	int type;
+	fmi2_value_reference_t vr;
+	size_t entry;
+} fmi2_result_key_t;
+
+static int fmi2_result_compare_keys(const void* a, const void* b) {
+	const fmi2_result_key_t* ka = (const fmi2_result_key_t*)a;
+	const fmi2_result_key_t* kb = (const fmi2_result_key_t*)b;
+	if(ka->type != kb->type) return ka->type - kb->type;
+	return (ka->vr > kb->vr) - (ka->vr < kb->vr);
+}
+
+/* Give aliases, i.e., variables with the same base type and value reference, one column */
+static jm_status_enu_t fmi2_result_build_columns(fmi2_import_result_recorder_t* rec) {
+	jm_callbacks* cb = rec->callbacks;
+	fmi2_result_key_t* keys = (fmi2_result_key_t*)cb->calloc(rec->entriesNum, sizeof(fmi2_result_key_t));
+	size_t i, t, offset;
+
+	if(!keys) return jm_status_error;
+	for(i = 0; i < rec->entriesNum; i++) {
+		keys[i].type = rec->entries[i].type;
+		keys[i].vr = rec->entries[i].vr;
+		keys[i].entry = i;
+	}
+	qsort(keys, rec->entriesNum, sizeof(fmi2_result_key_t), fmi2_result_compare_keys);
+
+	for(t = 0; t < FMI2_RESULT_TYPES; t++) {
+		rec->n[t] = 0;
+		rec->vr[t] = (fmi2_value_reference_t*)cb->calloc(rec->entriesNum, sizeof(fmi2_value_reference_t));
+		if(!rec->vr[t]) {
+			cb->free(keys);
+			return jm_status_error;
+		}
+	}
+	for(i = 0; i < rec->entriesNum; i++) {
+		t = keys[i].type;
+		if(i == 0 || fmi2_result_compare_keys(&keys[i - 1], &keys[i]) != 0) {
+			rec->vr[t][rec->n[t]++] = keys[i].vr;
+		}
+		rec->entries[keys[i].entry].column = rec->n[t] - 1;
+	}
+	cb->free(keys);
+
+	for(i = 0; i < rec->entriesNum; i++) {
+		for(offset = 0, t = 0; t < (size_t)rec->entries[i].type; t++) offset += rec->n[t];
+		rec->entries[i].column += offset;
+	}
+
+	rec->realRow = (fmi2_real_t*)cb->calloc(rec->n[0] + 1, sizeof(fmi2_real_t));
+	rec->integerRow = (fmi2_integer_t*)cb->calloc(rec->n[1] + 1, sizeof(fmi2_integer_t));
+	rec->booleanRow = (fmi2_boolean_t*)cb->calloc(rec->n[2] + 1, sizeof(fmi2_boolean_t));
+	for(i = 0; i < 2; i++) {
+		fmi2_result_chunk_t* chunk = &rec->chunks[i];
+		chunk->time = (fmi2_real_t*)cb->calloc(rec->chunkRows, sizeof(fmi2_real_t));
+		chunk->reals = (fmi2_real_t*)cb->calloc(rec->n[0] * rec->chunkRows + 1, sizeof(fmi2_real_t));
+		chunk->integers = (fmi2_integer_t*)cb->calloc(rec->n[1] * rec->chunkRows + 1, sizeof(fmi2_integer_t));
+		chunk->booleans = (char*)cb->calloc(rec->n[2] * rec->chunkRows + 1, 1);
+		chunk->rows = 0;
+		chunk->isFull = 0;
+		if(!chunk->time || !chunk->reals || !chunk->integers || !chunk->booleans) return jm_status_error;
+	}
+	if(!rec->realRow || !rec->integerRow || !rec->booleanRow) return jm_status_error;
+
+	/* scratch of the writer: a block with all columns as doubles, and its compressed form */
+	rec->rawSize = rec->chunkRows * (1 + rec->n[0] + rec->n[1] + rec->n[2]) * sizeof(fmi2_real_t);
+	rec->raw = (unsigned char*)cb->malloc(rec->rawSize);
+	if(!rec->raw) return jm_status_error;
+	if(rec->format == fmi2_import_result_format_binary && rec->compression) {
+		rec->packedSize = compressBound((uLong)rec->rawSize);
+		rec->packed = (unsigned char*)cb->malloc(rec->packedSize);
+		if(!rec->packed) return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+static void fmi2_result_free_columns(fmi2_import_result_recorder_t* rec) {
+	jm_callbacks* cb = rec->callbacks;
+	size_t i;
+	for(i = 0; i < FMI2_RESULT_TYPES; i++) {
+		cb->free(rec->vr[i]);
+		rec->vr[i] = 0;
+	}
+	for(i = 0; i < 2; i++) {
+		cb->free(rec->chunks[i].time);
+		cb->free(rec->chunks[i].reals);
+		cb->free(rec->chunks[i].integers);
+		cb->free(rec->chunks[i].booleans);
+		memset(&rec->chunks[i], 0, sizeof(fmi2_result_chunk_t));
+	}
+	cb->free(rec->realRow);
+	cb->free(rec->integerRow);
+	cb->free(rec->booleanRow);
+	cb->free(rec->raw);
+	cb->free(rec->packed);
+	rec->realRow = 0;
+	rec->integerRow = 0;
+	rec->booleanRow = 0;
+	rec->raw = 0;
+	rec->packed = 0;
+}
+
+static void fmi2_result_write(fmi2_import_result_recorder_t* rec, const void* data, size_t size) {
+	if(size && fwrite(data, 1, size, rec->file) != size) rec->writeFailed = 1;
+}
+
+static void fmi2_result_write_uint(fmi2_import_result_recorder_t* rec, size_t value) {
+	unsigned int v = (unsigned int)value;
+	fmi2_result_write(rec, &v, sizeof(v));
+}
+
+static void fmi2_result_write_mat4_header(fmi2_import_result_recorder_t* rec, int type, size_t mrows, size_t ncols, const char* name) {
+	int one = 1;
+	int header[5];
+	header[0] = type + ((*(char*)&one == 1) ? 0 : 1000);
+	header[1] = (int)mrows;
+	header[2] = (int)ncols;
+	header[3] = 0;
+	header[4] = (int)strlen(name) + 1;
+	fmi2_result_write(rec, header, sizeof(header));
+	fmi2_result_write(rec, name, strlen(name) + 1);
+}
+
+/* Write a text matrix of one string per row. MATLAB stores matrices column by column,
+   so the characters of the rows are interleaved. */
+static void fmi2_result_write_mat4_rows(fmi2_import_result_recorder_t* rec, const char** rows, size_t rowsNum, const char* name) {
+	size_t r, c, len, maxLen = 0;
+	for(r = 0; r < rowsNum; r++) {
+		len = strlen(rows[r]);
+		if(len > maxLen) maxLen = len;
+	}
+	fmi2_result_write_mat4_header(rec, FMI2_MAT4_TEXT, rowsNum, maxLen, name);
+	for(c = 0; c < maxLen; c++) {
+		for(r = 0; r < rowsNum; r++) {
+			fmi2_result_write(rec, (c < strlen(rows[r])) ? rows[r] + c : " ", 1);
+		}
+	}
+}
+
+/* Write one string per column, padded with blanks; the first column is for the time */
+static void fmi2_result_write_mat4_strings(fmi2_import_result_recorder_t* rec, const char* name, const char* time, int isDescription) {
+	size_t i, len, maxLen = strlen(time);
+	for(i = 0; i < rec->entriesNum; i++) {
+		len = strlen(isDescription ? rec->entries[i].description : rec->entries[i].name);
+		if(len > maxLen) maxLen = len;
+	}
+	if(maxLen == 0) maxLen = 1;
+	fmi2_result_write_mat4_header(rec, FMI2_MAT4_TEXT, maxLen, rec->entriesNum + 1, name);
+	for(i = 0; i <= rec->entriesNum; i++) {
+		const char* s = (i == 0) ? time : isDescription ? rec->entries[i - 1].description : rec->entries[i - 1].name;
+		len = strlen(s);
+		fmi2_result_write(rec, s, len);
+		for(; len < maxLen; len++) fmi2_result_write(rec, " ", 1);
+	}
+}
+
+static void fmi2_result_write_file_header(fmi2_import_result_recorder_t* rec) {
+	size_t i, columnsNum = fmi2_import_result_recorder_get_columns_num(rec);
+
+	if(rec->format == fmi2_import_result_format_binary) {
+		fmi2_result_write(rec, FMI2_RESULT_MAGIC, 8);
+		fmi2_result_write_uint(rec, FMI2_RESULT_VERSION);
+		fmi2_result_write_uint(rec, rec->n[0]);
+		fmi2_result_write_uint(rec, rec->n[1]);
+		fmi2_result_write_uint(rec, rec->n[2]);
+		fmi2_result_write_uint(rec, rec->entriesNum);
+		for(i = 0; i < rec->entriesNum; i++) {
+			size_t len = strlen(rec->entries[i].name);
+			fmi2_result_write_uint(rec, rec->entries[i].column);
+			fmi2_result_write_uint(rec, len);
+			fmi2_result_write(rec, rec->entries[i].name, len);
+		}
+	}
+	else {
+		/* the layout of Dymola result files, version 1.1 with transposed matrices */
+		const char* aclass[] = {"Atrajectory", "1.1", "", "binTrans"};
+		fmi2_real_t times[2] = {0, 0};
+		int info[4];
+
+		fmi2_result_write_mat4_rows(rec, aclass, 4, "Aclass");
+		fmi2_result_write_mat4_strings(rec, "name", "time", 0);
+		fmi2_result_write_mat4_strings(rec, "description", "Time", 1);
+
+		/* per variable: the data matrix, the row in it with 1 for the time, interpolation and extrapolation */
+		fmi2_result_write_mat4_header(rec, FMI2_MAT4_INT32, 4, rec->entriesNum + 1, "dataInfo");
+		info[0] = 0;
+		info[1] = 1;
+		info[2] = 0;
+		info[3] = -1;
+		fmi2_result_write(rec, info, sizeof(info));
+		for(i = 0; i < rec->entriesNum; i++) {
+			info[0] = 2;
+			info[1] = (int)rec->entries[i].column + 2;
+			fmi2_result_write(rec, info, sizeof(info));
+		}
+
+		/* the start and stop time, written at the stop since no parameters are stored */
+		fmi2_result_write_mat4_header(rec, FMI2_MAT4_DOUBLE, 1, 2, "data_1");
+		rec->mat4TimesPos = ftell(rec->file);
+		fmi2_result_write(rec, times, sizeof(times));
+
+		/* one column per sample, the count is written at the stop */
+		fmi2_result_write_mat4_header(rec, FMI2_MAT4_DOUBLE, columnsNum + 1, 0, "data_2");
+		rec->mat4SamplesPos = ftell(rec->file) - (long)(strlen("data_2") + 1) - 3 * (long)sizeof(int);
+	}
+}
+
+/* Write one chunk as a block of the binary format */
+static void fmi2_result_write_block(fmi2_import_result_recorder_t* rec, const fmi2_result_chunk_t* chunk) {
+	size_t rows = chunk->rows, c, size = 0;
+	unsigned char* p = rec->raw;
+
+	memcpy(p, chunk->time, rows * sizeof(fmi2_real_t));
+	size += rows * sizeof(fmi2_real_t);
+	for(c = 0; c < rec->n[0]; c++, size += rows * sizeof(fmi2_real_t)) {
+		memcpy(p + size, chunk->reals + c * rec->chunkRows, rows * sizeof(fmi2_real_t));
+	}
+	for(c = 0; c < rec->n[1]; c++, size += rows * sizeof(fmi2_integer_t)) {
+		memcpy(p + size, chunk->integers + c * rec->chunkRows, rows * sizeof(fmi2_integer_t));
+	}
+	for(c = 0; c < rec->n[2]; c++, size += rows) {
+		memcpy(p + size, chunk->booleans + c * rec->chunkRows, rows);
+	}
+
+	if(rec->compression) {
+		uLongf packedSize = (uLongf)rec->packedSize;
+		if(compress2(rec->packed, &packedSize, rec->raw, (uLong)size, rec->compression) == Z_OK && packedSize < size) {
+			fmi2_result_write_uint(rec, rows);
+			fmi2_result_write_uint(rec, size);
+			fmi2_result_write_uint(rec, packedSize);
+			fmi2_result_write(rec, rec->packed, packedSize);
+			return;
+		}
+	}
+	fmi2_result_write_uint(rec, rows);
+	fmi2_result_write_uint(rec, size);
+	fmi2_result_write_uint(rec, size);
+	fmi2_result_write(rec, rec->raw, size);
+}
+
+/* Write one chunk as columns of the "data_2" matrix of the MAT-file */
+static void fmi2_result_write_mat4_columns(fmi2_import_result_recorder_t* rec, const fmi2_result_chunk_t* chunk) {
+	size_t columnsNum = fmi2_import_result_recorder_get_columns_num(rec) + 1;
+	fmi2_real_t* out = (fmi2_real_t*)rec->raw;
+	size_t r, c;
+
+	if(chunk->rows == 0) return;
+	if(rec->mat4RowsNum == 0) rec->mat4Times[0] = chunk->time[0];
+	rec->mat4Times[1] = chunk->time[chunk->rows - 1];
+	rec->mat4RowsNum += chunk->rows;
+
+	for(r = 0; r < chunk->rows; r++) {
+		fmi2_real_t* row = out + r * columnsNum;
+		size_t k = 0;
+		row[k++] = chunk->time[r];
+		for(c = 0; c < rec->n[0]; c++) row[k++] = chunk->reals[c * rec->chunkRows + r];
+		for(c = 0; c < rec->n[1]; c++) row[k++] = chunk->integers[c * rec->chunkRows + r];
+		for(c = 0; c < rec->n[2]; c++) row[k++] = chunk->booleans[c * rec->chunkRows + r];
+	}
+	fmi2_result_write(rec, out, chunk->rows * columnsNum * sizeof(fmi2_real_t));
+}
+
+static void fmi2_result_writer(void* arg) {
+	fmi2_import_result_recorder_t* rec = (fmi2_import_result_recorder_t*)arg;
+	for(;;) {
+		fmi2_result_chunk_t* chunk = &rec->chunks[rec->writeIndex];
+		jm_mutex_lock(&rec->lock);
+		while(!chunk->isFull && !rec->isStopping) jm_cond_wait(&rec->wake, &rec->lock);
+		if(!chunk->isFull) {
+			jm_mutex_unlock(&rec->lock);
+			break;
+		}
+		jm_mutex_unlock(&rec->lock);
+
+		if(!rec->writeFailed) {
+			if(rec->format == fmi2_import_result_format_binary) fmi2_result_write_block(rec, chunk);
+			else fmi2_result_write_mat4_columns(rec, chunk);
+		}
+
+		jm_mutex_lock(&rec->lock);
+		chunk->rows = 0;
+		chunk->isFull = 0;
+		rec->writeIndex ^= 1;
+		jm_cond_signal(&rec->freed);
+		jm_mutex_unlock(&rec->lock);
+	}
+}
+
+jm_status_enu_t fmi2_import_result_recorder_start(fmi2_import_result_recorder_t* rec, const char* fileName, fmi2_import_result_format_enu_t format) {
+	jm_callbacks* cb = rec->callbacks;
+
+	if(rec->isStarted) {
+		jm_log_error(cb, module, "The result recorder is already started");
+		return jm_status_error;
+	}
+	if(!rec->entriesNum) {
+		jm_log_error(cb, module, "No variables are registered with the result recorder");
+		return jm_status_error;
+	}
+	rec->format = format;
+	if(fmi2_result_build_columns(rec) != jm_status_success) {
+		fmi2_result_free_columns(rec);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	rec->file = fopen(fileName, "wb");
+	if(!rec->file) {
+		fmi2_result_free_columns(rec);
+		jm_log_error(cb, module, "Could not open the result file '%s'", fileName);
+		return jm_status_error;
+	}
+	rec->fillIndex = 0;
+	rec->writeIndex = 0;
+	rec->samplesNum = 0;
+	rec->stallsNum = 0;
+	rec->isStopping = 0;
+	rec->writeFailed = 0;
+	rec->mat4Times[0] = rec->mat4Times[1] = 0;
+	rec->mat4RowsNum = 0;
+	fmi2_result_write_file_header(rec);
+
+	jm_mutex_init(&rec->lock);
+	jm_cond_init(&rec->wake);
+	jm_cond_init(&rec->freed);
+	if(jm_thread_create(&rec->writer, fmi2_result_writer, rec) != jm_status_success) {
+		jm_cond_destroy(&rec->freed);
+		jm_cond_destroy(&rec->wake);
+		jm_mutex_destroy(&rec->lock);
+		fclose(rec->file);
+		fmi2_result_free_columns(rec);
+		jm_log_error(cb, module, "Could not start the result writer thread");
+		return jm_status_error;
+	}
+	rec->isStarted = 1;
+	jm_log_verbose(cb, module, "Recording %u variables in %u columns to '%s'", (unsigned)rec->entriesNum,
+		(unsigned)fmi2_import_result_recorder_get_columns_num(rec), fileName);
+	return jm_status_success;
+}
+
+/* Hand the chunk being filled to the writer and continue with the other one */
+static void fmi2_result_hand_over(fmi2_import_result_recorder_t* rec) {
+	fmi2_result_chunk_t* next;
+	jm_mutex_lock(&rec->lock);
+	rec->chunks[rec->fillIndex].isFull = 1;
+	jm_cond_signal(&rec->wake);
+	rec->fillIndex ^= 1;
+	next = &rec->chunks[rec->fillIndex];
+	if(next->isFull) {
+		rec->stallsNum++;
+		while(next->isFull) jm_cond_wait(&rec->freed, &rec->lock);
+	}
+	jm_mutex_unlock(&rec->lock);
+}
+
+fmi2_status_t fmi2_import_result_recorder_sample(fmi2_import_result_recorder_t* rec, fmi2_real_t time) {
+	fmi2_result_chunk_t* chunk = &rec->chunks[rec->fillIndex];
+	fmi2_status_t status = fmi2_status_ok, s;
+	size_t row = chunk->rows, c;
+
+	if(!rec->isStarted) {
+		jm_log_error(rec->callbacks, module, "The result recorder is not started");
+		return fmi2_status_error;
+	}
+	if(rec->n[0]) {
+		s = fmi2_import_get_real(rec->fmu, rec->vr[0], rec->n[0], rec->realRow);
+		status = FMI2_RESULT_WORST(status, s);
+	}
+	if(rec->n[1]) {
+		s = fmi2_import_get_integer(rec->fmu, rec->vr[1], rec->n[1], rec->integerRow);
+		status = FMI2_RESULT_WORST(status, s);
+	}
+	if(rec->n[2]) {
+		s = fmi2_import_get_boolean(rec->fmu, rec->vr[2], rec->n[2], rec->booleanRow);
+		status = FMI2_RESULT_WORST(status, s);
+	}
+	if(status >= fmi2_status_error) return status;
+
+	chunk->time[row] = time;
+	for(c = 0; c < rec->n[0]; c++) chunk->reals[c * rec->chunkRows + row] = rec->realRow[c];
+	for(c = 0; c < rec->n[1]; c++) chunk->integers[c * rec->chunkRows + row] = rec->integerRow[c];
+	for(c = 0; c < rec->n[2]; c++) chunk->booleans[c * rec->chunkRows + row] = (char)(rec->booleanRow[c] != fmi2_false);
+	rec->samplesNum++;
+	if(++chunk->rows == rec->chunkRows) fmi2_result_hand_over(rec);
+	return status;
+}
+
+jm_status_enu_t fmi2_import_result_recorder_stop(fmi2_import_result_recorder_t* rec) {
+	jm_callbacks* cb = rec->callbacks;
+	int failed;
+
+	if(!rec->isStarted) return jm_status_success;
+	if(rec->chunks[rec->fillIndex].rows) fmi2_result_hand_over(rec);
+
+	jm_mutex_lock(&rec->lock);
+	rec->isStopping = 1;
+	jm_cond_signal(&rec->wake);
+	jm_mutex_unlock(&rec->lock);
+	jm_thread_join(&rec->writer);
+
+	if(rec->format == fmi2_import_result_format_binary) {
+		/* a block without samples ends the file */
+		fmi2_result_write_uint(rec, 0);
+		fmi2_result_write_uint(rec, 0);
+		fmi2_result_write_uint(rec, 0);
+	}
+	else if(fseek(rec->file, rec->mat4TimesPos, SEEK_SET) == 0) {
+		int samplesNum = (int)rec->samplesNum;
+		fmi2_result_write(rec, rec->mat4Times, sizeof(rec->mat4Times));
+		if(fseek(rec->file, rec->mat4SamplesPos, SEEK_SET) == 0) {
+			fmi2_result_write(rec, &samplesNum, sizeof(samplesNum));
+		}
+		else {
+			rec->writeFailed = 1;
+		}
+	}
+	else {
+		rec->writeFailed = 1;
+	}
+	failed = rec->writeFailed | (fclose(rec->file) != 0);
+	rec->file = 0;
+
+	jm_cond_destroy(&rec->freed);
+	jm_cond_destroy(&rec->wake);
+	jm_mutex_destroy(&rec->lock);
+	fmi2_result_free_columns(rec);
+	rec->isStarted = 0;
+
+	if(rec->stallsNum) {
+		jm_log_verbose(cb, module, "Result recording waited %u times for the writer", (unsigned)rec->stallsNum);
+	}
+	if(failed) {
+		jm_log_error(cb, module, "Could not write the result file");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+void fmi2_import_result_recorder_free(fmi2_import_result_recorder_t* rec) {
+	if(!rec) return;
+	fmi2_import_result_recorder_stop(rec);
+	rec->callbacks->free(rec->entries);
+	rec->callbacks->free(rec);
+}
+
+/* Reading of the binary format */
+
+struct fmi2_import_result_file_t {
+	jm_callbacks* callbacks;
+	size_t n[FMI2_RESULT_TYPES];
+	size_t variablesNum;
+	char** names;
+	size_t* columns;
+	size_t samplesNum;
+	size_t capacity;
+	fmi2_real_t* time;
+	fmi2_real_t** values;   /* per column */
+};
+
+static int fmi2_result_read_uint(FILE* f, size_t* value) {
+	unsigned int v;
+	if(fread(&v, sizeof(v), 1, f) != 1) return 0;
+	*value = v;
+	return 1;
+}
+
+static int fmi2_result_reserve(fmi2_import_result_file_t* res, size_t rows) {
+	size_t columnsNum = res->n[0] + res->n[1] + res->n[2], capacity = res->capacity ? res->capacity : 1024, c;
+	fmi2_real_t* p;
+	if(res->samplesNum + rows <= res->capacity) return 1;
+	while(capacity < res->samplesNum + rows) capacity *= 2;
+	p = (fmi2_real_t*)res->callbacks->realloc(res->time, capacity * sizeof(fmi2_real_t));
+	if(!p) return 0;
+	res->time = p;
+	for(c = 0; c < columnsNum; c++) {
+		p = (fmi2_real_t*)res->callbacks->realloc(res->values[c], capacity * sizeof(fmi2_real_t));
+		if(!p) return 0;
+		res->values[c] = p;
+	}
+	res->capacity = capacity;
+	return 1;
+}
+
+/* Append the samples of one block in the raw layout */
+static void fmi2_result_read_block(fmi2_import_result_file_t* res, const unsigned char* p, size_t rows) {
+	size_t c, r, columnsNum = res->n[0] + res->n[1] + res->n[2];
+	memcpy(res->time + res->samplesNum, p, rows * sizeof(fmi2_real_t));
+	p += rows * sizeof(fmi2_real_t);
+	for(c = 0; c < columnsNum; c++) {
+		fmi2_real_t* out = res->values[c] + res->samplesNum;
+		if(c < res->n[0]) {
+			memcpy(out, p, rows * sizeof(fmi2_real_t));
+			p += rows * sizeof(fmi2_real_t);
+		}
+		else if(c < res->n[0] + res->n[1]) {
+			for(r = 0; r < rows; r++, p += sizeof(fmi2_integer_t)) {
+				fmi2_integer_t v;
+				memcpy(&v, p, sizeof(v));
+				out[r] = v;
+			}
+		}
+		else {
+			for(r = 0; r < rows; r++) out[r] = p[r];
+			p += rows;
+		}
+	}
+	res->samplesNum += rows;
+}
+
+fmi2_import_result_file_t* fmi2_import_result_file_open(jm_callbacks* cb, const char* fileName) {
+	fmi2_import_result_file_t* res;
+	unsigned char *raw = 0, *packed = 0;
+	size_t version, i, columnsNum, rowSize, rows, size, storedSize;
+	char magic[8];
+	int ok = 0;
+	FILE* f = fopen(fileName, "rb");
+
+	if(!f) {
+		jm_log_error(cb, module, "Could not open the result file '%s'", fileName);
+		return 0;
+	}
+	res = (fmi2_import_result_file_t*)cb->calloc(1, sizeof(fmi2_import_result_file_t));
+	if(!res) {
+		fclose(f);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	res->callbacks = cb;
+	if(fread(magic, 1, 8, f) != 8 || memcmp(magic, FMI2_RESULT_MAGIC, 8) != 0 ||
+	   !fmi2_result_read_uint(f, &version) || version != FMI2_RESULT_VERSION ||
+	   !fmi2_result_read_uint(f, &res->n[0]) || !fmi2_result_read_uint(f, &res->n[1]) ||
+	   !fmi2_result_read_uint(f, &res->n[2]) || !fmi2_result_read_uint(f, &res->variablesNum)) {
+		goto done;
+	}
+	columnsNum = res->n[0] + res->n[1] + res->n[2];
+	rowSize = (1 + res->n[0]) * sizeof(fmi2_real_t) + res->n[1] * sizeof(fmi2_integer_t) + res->n[2];
+	res->names = (char**)cb->calloc(res->variablesNum + 1, sizeof(char*));
+	res->columns = (size_t*)cb->calloc(res->variablesNum + 1, sizeof(size_t));
+	res->values = (fmi2_real_t**)cb->calloc(columnsNum + 1, sizeof(fmi2_real_t*));
+	if(!res->names || !res->columns || !res->values) goto done;
+	for(i = 0; i < res->variablesNum; i++) {
+		size_t len;
+		if(!fmi2_result_read_uint(f, &res->columns[i]) || res->columns[i] >= columnsNum || !fmi2_result_read_uint(f, &len)) goto done;
+		res->names[i] = (char*)cb->calloc(len + 1, 1);
+		if(!res->names[i] || fread(res->names[i], 1, len, f) != len) goto done;
+	}
+
+	for(;;) {
+		if(!fmi2_result_read_uint(f, &rows) || !fmi2_result_read_uint(f, &size) || !fmi2_result_read_uint(f, &storedSize)) goto done;
+		if(!rows) break;
+		/* the size is taken from the file; it must be exactly the size of the samples before they are decoded */
+		if(rows > size / rowSize || rows * rowSize != size) {
+			jm_log_error(cb, module, "A block of %u samples has %u instead of %u bytes per sample",
+				(unsigned)rows, (unsigned)(size / rows), (unsigned)rowSize);
+			goto done;
+		}
+		raw = (unsigned char*)cb->malloc(size);
+		if(!raw || !fmi2_result_reserve(res, rows)) goto done;
+		if(storedSize == size) {
+			if(fread(raw, 1, size, f) != size) goto done;
+		}
+		else {
+			uLongf rawSize = (uLongf)size;
+			packed = (unsigned char*)cb->malloc(storedSize);
+			if(!packed || fread(packed, 1, storedSize, f) != storedSize) goto done;
+			if(uncompress(raw, &rawSize, packed, (uLong)storedSize) != Z_OK || rawSize != size) {
+				jm_log_error(cb, module, "A compressed block does not inflate to %u bytes", (unsigned)size);
+				goto done;
+			}
+			cb->free(packed);
+			packed = 0;
+		}
+		fmi2_result_read_block(res, raw, rows);
+		cb->free(raw);
+		raw = 0;
+	}
+	ok = 1;
+
+done:
+	cb->free(raw);
+	cb->free(packed);
+	fclose(f);
+	if(!ok) {
+		fmi2_import_result_file_close(res);
+		jm_log_error(cb, module, "The result file '%s' is not valid", fileName);
+		return 0;
+	}
+	return res;
+}
+
+void fmi2_import_result_file_close(fmi2_import_result_file_t* res) {
+	jm_callbacks* cb;
+	size_t i;
+	if(!res) return;
+	cb = res->callbacks;
+	if(res->names) {
+		for(i = 0; i < res->variablesNum; i++) cb->free(res->names[i]);
+	}
+	if(res->values) {
+		for(i = 0; i < res->n[0] + res->n[1] + res->n[2]; i++) cb->free(res->values[i]);
+	}
+	cb->free(res->names);
+	cb->free(res->columns);
+	cb->free(res->values);
+	cb->free(res->time);
+	cb->free(res);
+}
+
+size_t fmi2_import_result_file_get_variables_num(fmi2_import_result_file_t* res) {
+	return res->variablesNum;
+}
+
+const char* fmi2_import_result_file_get_variable_name(fmi2_import_result_file_t* res, size_t index) {
+	return (index < res->variablesNum) ? res->names[index] : 0;
+}
+
+jm_status_enu_t fmi2_import_result_file_find_variable(fmi2_import_result_file_t* res, const char* name, size_t* index) {
+	size_t i;
+	for(i = 0; i < res->variablesNum; i++) {
+		if(strcmp(res->names[i], name) == 0) {
+			*index = i;
+			return jm_status_success;
+		}
+	}
+	return jm_status_error;
+}
+
+size_t fmi2_import_result_file_get_samples_num(fmi2_import_result_file_t* res) {
+	return res->samplesNum;
+}
+
+const fmi2_real_t* fmi2_import_result_file_get_time(fmi2_import_result_file_t* res) {
+	return res->time;
+}
+
+void fmi2_import_result_file_get_values(fmi2_import_result_file_t* res, size_t index, fmi2_real_t values[]) {
+	if(index >= res->variablesNum || !res->samplesNum) return;
+	memcpy(values, res->values[res->columns[index]], res->samplesNum * sizeof(fmi2_real_t));
+}
@@ -0,0 +1,76 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef FMI_CALL_STATS_H
+#define FMI_CALL_STATS_H
+#include <stddef.h>
+#include <fmilib_config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+	@file fmi_call_stats.h
+	\brief Timing statistics of the calls to one FMI function.
+
+	*/
+/** \addtogroup jm_utils
+  * @{
+*/
+
+/** \brief Number of latency histogram buckets.
+
+	The buckets are log-linear: durations below 4 ns have one bucket per nanosecond and each
+	following power of two is split into 4 equal buckets, giving a relative resolution of 25%
+	from 4 ns to beyond one hour.
+*/
+#define FMI_CALL_STATS_BUCKETS 168
+
+/** \brief Call count, time and latency histogram of one function. */
+typedef struct fmi_call_stats_t {
+	const char* name;         /**< \brief Name of the FMI function, e.g., "fmi2DoStep" */
+	size_t count;             /**< \brief Number of calls */
+	double totalSeconds;      /**< \brief Total time spent in the calls */
+	double maxSeconds;        /**< \brief Longest call */
+	unsigned int histogram[FMI_CALL_STATS_BUCKETS]; /**< \brief Number of calls per duration bucket, see fmi_call_stats_bucket() */
+} fmi_call_stats_t;
+
+/** \brief Get the histogram bucket of a call duration in seconds. */
+FMILIB_EXPORT size_t fmi_call_stats_bucket(double seconds);
+
+/** \brief Get the shortest duration in seconds that falls into a histogram bucket. */
+FMILIB_EXPORT double fmi_call_stats_bucket_seconds(size_t bucket);
+
+/** \brief Add a call to the statistics.
+	@param stats The statistics of the called function.
+	@param seconds Duration of the call.
+*/
+FMILIB_EXPORT void fmi_call_stats_record(fmi_call_stats_t* stats, double seconds);
+
+/** \brief Estimate a percentile of the call durations from the histogram.
+	@param stats Statistics of a function.
+	@param percentile Percentile between 0 and 100.
+	@return The lower bound of the bucket holding the percentile in seconds, zero if there were no calls.
+*/
+FMILIB_EXPORT double fmi_call_stats_percentile(const fmi_call_stats_t* stats, double percentile);
+
+/** @} */
+#ifdef __cplusplus
+}
+#endif
+
+/* FMI_CALL_STATS_H */
+#endif
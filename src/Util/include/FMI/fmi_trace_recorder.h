@@ -0,0 +1,99 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef FMI_TRACE_RECORDER_H
+#define FMI_TRACE_RECORDER_H
+#include <stddef.h>
+#include <fmilib_config.h>
+#include <JM/jm_callbacks.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+	@file fmi_trace_recorder.h
+	\brief Process-wide recorder of a timeline of FMI calls and simulation phases.
+
+	While a recorder is started, the FMI calls of FMUs and instances with call tracing switched on
+	(see fmi2_import_set_call_tracing()), the steps and data exchange of co-simulation masters and
+	the events found by the solvers are recorded as slices and instant events on the thread that
+	made them. Each thread writes to its own buffer without locking; a background thread moves the
+	events to the trace file. If a buffer is full the events are dropped and counted.
+
+	The file is written in the Chrome Trace Event JSON format or as a Perfetto protobuf trace and
+	can be opened in ui.perfetto.dev or chrome://tracing.
+	*/
+/** \addtogroup jm_utils
+  * @{
+*/
+
+/** \brief Maximum length of the recorded event names. Longer names are truncated. */
+#define FMI_TRACE_RECORDER_NAME_MAX 47
+/** \brief Maximum length of the recorded event categories, e.g., instance names. Longer categories are truncated. */
+#define FMI_TRACE_RECORDER_CATEGORY_MAX 31
+
+/** \brief Trace file formats. */
+typedef enum fmi_trace_format_enu_t {
+	fmi_trace_format_chrome_json, /**< \brief Chrome Trace Event JSON */
+	fmi_trace_format_perfetto     /**< \brief Perfetto protobuf trace packets */
+} fmi_trace_format_enu_t;
+
+/** \brief Start recording to a file.
+	@param cb Callbacks used for memory and logging. Must be thread-safe.
+	@param fileName The trace file, overwritten if it exists.
+	@param format Format of the file.
+	@param bufferEvents Number of events buffered per thread. Zero selects 16384.
+	@return jm_status_error if a recorder is already started or the file could not be opened.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_trace_recorder_start(jm_callbacks* cb, const char* fileName, fmi_trace_format_enu_t format, size_t bufferEvents);
+
+/** \brief Write the remaining events, close the file and release the recorder.
+	Must not be called while other threads record events.
+	@return jm_status_error if the file could not be written.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi_trace_recorder_stop(void);
+
+/** \brief Check if a recorder is started. */
+FMILIB_EXPORT int fmi_trace_recorder_is_active(void);
+
+/** \brief Record a slice on the calling thread. Does nothing if no recorder is started.
+	@param name Name of the slice, e.g., the called function.
+	@param category Category of the slice, e.g., the instance name. May be NULL.
+	@param startTime Start of the slice, from jm_portability_get_time().
+	@param endTime End of the slice, from jm_portability_get_time().
+*/
+FMILIB_EXPORT void fmi_trace_recorder_slice(const char* name, const char* category, double startTime, double endTime);
+
+/** \brief Record an instant event on the calling thread. Does nothing if no recorder is started.
+	@param name Name of the event.
+	@param category Category of the event. May be NULL.
+	@param time Time of the event, from jm_portability_get_time().
+*/
+FMILIB_EXPORT void fmi_trace_recorder_instant(const char* name, const char* category, double time);
+
+/** \brief Name the calling thread in the trace. Does nothing if no recorder is started. */
+FMILIB_EXPORT void fmi_trace_recorder_set_thread_name(const char* name);
+
+/** \brief Get the number of events that were dropped since the recorder was started because a buffer was full. */
+FMILIB_EXPORT size_t fmi_trace_recorder_get_dropped_num(void);
+
+/** @} */
+#ifdef __cplusplus
+}
+#endif
+
+/* FMI_TRACE_RECORDER_H */
+#endif
@@ -86,7 +86,8 @@ struct jm_callbacks {
 	jm_log_level_enu_t log_level; 
 	/** \brief Arbitrary context pointer passed to the logger function  */
 	jm_voidp context;	
-	/** \brief The buffer used along with jm_get_last_error() */
+	/** \brief Not used by the library. Kept so that the layout of the struct does not change,
+		see jm_get_last_error() for the messages. */
 	char errMessageBuffer[JM_MAX_ERROR_MESSAGE_SIZE]; 
 };
 
@@ -95,13 +96,27 @@ struct jm_callbacks {
 *
 * An alternative way to get error information is to use jm_get_last_error(). This is only meaningful
 * if logger function is not present.
+*
+* Only fatal, error and warning messages of enabled log levels are kept. The message is kept per thread:
+* each thread gets the last message it logged itself, whatever callbacks it used, so parsing,
+* loading and unzipping on separate threads report their own errors. The callbacks argument is not used.
 */
-static jm_string jm_get_last_error(jm_callbacks* cb) {return cb->errMessageBuffer; }
+FMILIB_EXPORT
+jm_string jm_get_last_error(jm_callbacks* cb);
 
 /**
- \brief Clear the last generated log message.
+ \brief Clear the last generated log message of the calling thread.
 */
-static void jm_clear_last_error(jm_callbacks* cb) { cb->errMessageBuffer[0] = 0; }
+FMILIB_EXPORT
+void jm_clear_last_error(jm_callbacks* cb);
+
+/**
+ \brief Keep a message for jm_get_last_error() of the calling thread. Called by jm_log() and by the FMU
+ log forwarding functions for the messages of enabled log levels. Messages above jm_log_level_warning are
+ ignored. Longer messages are cut to JM_MAX_ERROR_MESSAGE_SIZE - 1 characters.
+*/
+FMILIB_EXPORT
+void jm_set_last_error(jm_callbacks* cb, jm_log_level_enu_t log_level, jm_string message);
 
 /**
 \brief Set the structure to be returned by jm_get_default_callbacks().
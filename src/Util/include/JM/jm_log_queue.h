@@ -0,0 +1,86 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_LOG_QUEUE_H_
+#define JM_LOG_QUEUE_H_
+
+#include <stddef.h>
+#include "jm_callbacks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file jm_log_queue.h
+	Asynchronous delivery of log messages on a background thread.
+*/
+/** \addtogroup jm_callbacks
+@{*/
+
+/** \brief Opaque log queue. */
+typedef struct jm_log_queue_t jm_log_queue_t;
+
+/** \brief What a thread does when it logs a message and the queue is full. */
+typedef enum jm_log_queue_policy_enu_t {
+	jm_log_queue_drop,  /**< \brief Drop the message and count it (the default). */
+	jm_log_queue_block  /**< \brief Wait until the sink thread has delivered a message. */
+} jm_log_queue_policy_enu_t;
+
+/** \brief Counters of a log queue. */
+typedef struct jm_log_queue_stats_t {
+	size_t queuedNum;    /**< \brief Messages put into the queue. */
+	size_t deliveredNum; /**< \brief Messages passed to the logger. */
+	size_t droppedNum;   /**< \brief Messages dropped because the queue was full. */
+	size_t truncatedNum; /**< \brief Messages cut to the message size of the queue. */
+	size_t waitsNum;     /**< \brief Times a thread waited for a free slot. */
+} jm_log_queue_stats_t;
+
+/**
+	\brief Create a log queue and install it in a callbacks struct.
+
+	The current logger and context of the callbacks become the sink of the queue and are replaced by a
+	logger that copies each message into a bounded ring of slots. A sink thread passes the messages to the
+	original logger in the order they were queued. Threads that log reserve slots with atomic operations and
+	do not take a lock or wait for the logger unless the queue is full and the policy is ::jm_log_queue_block.
+	A message logged by the original logger itself is dropped instead of waiting on the sink thread.
+
+	Callbacks that are copied after this call, e.g. into an import context, log through the queue as well.
+	\param cb - callbacks to install the queue in. The default callbacks are used if this parameter is NULL.
+	\param capacity - number of slots, rounded up to a power of two. Zero selects 1024.
+	\param messageSize - longest message kept in a slot, including the terminating zero. Longer messages
+		are cut. Zero selects 512. Module names are cut to 31 characters.
+	\param policy - what to do when the queue is full.
+	\return The queue or NULL on error, in which case the callbacks are left unchanged.
+*/
+FMILIB_EXPORT jm_log_queue_t* jm_log_queue_create(jm_callbacks* cb, size_t capacity, size_t messageSize, jm_log_queue_policy_enu_t policy);
+
+/**
+	\brief Deliver the remaining messages, stop the sink thread, restore the logger and context of the
+	callbacks and free the queue. No thread may log through the queue during or after this call.
+*/
+FMILIB_EXPORT void jm_log_queue_destroy(jm_log_queue_t* q);
+
+/** \brief Wait until all messages queued before the call have been passed to the logger. */
+FMILIB_EXPORT void jm_log_queue_flush(jm_log_queue_t* q);
+
+/** \brief Get the counters of a queue. The counters are updated concurrently and may be slightly behind. */
+FMILIB_EXPORT void jm_log_queue_get_stats(jm_log_queue_t* q, jm_log_queue_stats_t* stats);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_LOG_QUEUE_H_ */
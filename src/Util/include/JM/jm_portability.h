@@ -64,6 +64,21 @@ jm_status_enu_t jm_portability_get_current_working_directory(char* buffer, size_
 /** \brief Set current working directory*/
 jm_status_enu_t jm_portability_set_current_working_directory(const char* cwd);
 
+/**
+	\brief Get the canonical absolute path of an existing file or directory.
+
+	Symbolic links and "." or ".." components are resolved on POSIX systems.
+	\param cb - callbacks for memory allocation and logging. Default callbacks are used if this parameter is NULL.
+	\param path - path to an existing file (relative or absolute).
+	\param outPath - buffer for storing the path
+	\param len - size of the buffer
+	\return Pointer to outPath on success, 0 - if the path could not be resolved or does not fit into the buffer.
+*/
+char* jm_portability_get_real_path(jm_callbacks* cb, const char* path, char* outPath, size_t len);
+
+/** \brief Get the time in seconds of a monotonic clock, e.g., for measuring wall time intervals. The origin is unspecified. */
+double jm_portability_get_time(void);
+
 /** \brief Get system-wide temporary directory */
 const char* jm_get_system_temp_dir();
 
@@ -120,6 +135,34 @@ jm_status_enu_t jm_mkdir(jm_callbacks* cb, const char* dir);
 */
 jm_status_enu_t jm_rmdir(jm_callbacks* cb, const char* dir);
 
+/**
+	\brief Copy a file with its permission bits. An existing destination file is overwritten.
+	\param cb - callbacks for memory allocation and logging. Default callbacks are used if this parameter is NULL.
+	\param src - path to the file to copy.
+	\param dst - path to the destination file.
+	\return jm_status_success on success, jm_status_error otherwise in which case a message is send to the logger.
+*/
+jm_status_enu_t jm_copy_file(jm_callbacks* cb, const char* src, const char* dst);
+
+/** \brief Read-only view of a file mapped into memory. */
+typedef struct jm_mapped_file_t {
+	const void* data;   /**< \brief The contents of the file. */
+	size_t size;        /**< \brief Size of the file in bytes. */
+	void* handle;       /**< \brief Handle of the mapping object, used on Windows only. */
+} jm_mapped_file_t;
+
+/**
+	\brief Map a file into memory for reading. The pages are read from the file on first access.
+	\param cb - callbacks for logging. Default callbacks are used if this parameter is NULL.
+	\param fileName - path to the file. Empty files cannot be mapped.
+	\param map - the mapping, released with jm_unmap_file().
+	\return jm_status_success on success, jm_status_error otherwise in which case a message is send to the logger.
+*/
+jm_status_enu_t jm_map_file(jm_callbacks* cb, const char* fileName, jm_mapped_file_t* map);
+
+/** \brief Release a mapping created with jm_map_file(). */
+void jm_unmap_file(jm_mapped_file_t* map);
+
 /**
     \brief C89 compatible implementation of C99 vsnprintf.
 
@@ -0,0 +1,185 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_THREAD_H_
+#define JM_THREAD_H_
+
+#include <fmilib_config.h>
+#include "jm_types.h"
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(__MINGW32__)
+#include <windows.h>
+#define JM_THREAD_WIN32
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file jm_thread.h
+	Portable threading primitives.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_thread
+	@}
+*/
+/** \addtogroup jm_thread Threading primitives
+@{*/
+
+/** \brief Storage class of static variables with a separate instance in each thread.
+	Not defined if the compiler does not support thread-local variables. */
+#if defined(_MSC_VER)
+#define JM_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define JM_THREAD_LOCAL __thread
+#endif
+
+/** \brief Mutual exclusion lock. Not recursive. */
+typedef struct jm_mutex_t {
+#ifdef JM_THREAD_WIN32
+	SRWLOCK lock;
+#else
+	pthread_mutex_t lock;
+#endif
+} jm_mutex_t;
+
+/** \brief Static initializer for a ::jm_mutex_t, e.g., for process-wide locks. */
+#ifdef JM_THREAD_WIN32
+#define JM_MUTEX_INITIALIZER { SRWLOCK_INIT }
+#else
+#define JM_MUTEX_INITIALIZER { PTHREAD_MUTEX_INITIALIZER }
+#endif
+
+/** \brief Initialize a mutex. */
+jm_status_enu_t jm_mutex_init(jm_mutex_t* m);
+
+/** \brief Release the resources of a mutex initialized with jm_mutex_init(). */
+void jm_mutex_destroy(jm_mutex_t* m);
+
+/** \brief Lock a mutex, waiting for it to become available. */
+void jm_mutex_lock(jm_mutex_t* m);
+
+/** \brief Unlock a mutex locked by the calling thread. */
+void jm_mutex_unlock(jm_mutex_t* m);
+
+/** \brief Condition variable. */
+typedef struct jm_cond_t {
+#ifdef JM_THREAD_WIN32
+	CONDITION_VARIABLE cond;
+#else
+	pthread_cond_t cond;
+#endif
+} jm_cond_t;
+
+/** \brief Initialize a condition variable. */
+jm_status_enu_t jm_cond_init(jm_cond_t* c);
+
+/** \brief Release the resources of a condition variable. */
+void jm_cond_destroy(jm_cond_t* c);
+
+/** \brief Atomically unlock the mutex and wait for the condition to be signaled. The mutex is locked again on return.
+	Spurious wake-ups are possible, so the condition must be checked in a loop. */
+void jm_cond_wait(jm_cond_t* c, jm_mutex_t* m);
+
+/** \brief Like jm_cond_wait() but return after at most the given number of seconds.
+	\return Zero if the wait timed out, non-zero otherwise. */
+int jm_cond_timed_wait(jm_cond_t* c, jm_mutex_t* m, double seconds);
+
+/** \brief Wake up one thread waiting on the condition. */
+void jm_cond_signal(jm_cond_t* c);
+
+/** \brief Wake up all threads waiting on the condition. */
+void jm_cond_broadcast(jm_cond_t* c);
+
+/** \brief Thread handle. */
+typedef struct jm_thread_t {
+#ifdef JM_THREAD_WIN32
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+} jm_thread_t;
+
+/** \brief Thread entry point. */
+typedef void (*jm_thread_func_ft)(void* arg);
+
+/**
+	\brief Start a new thread.
+	\param t - handle of the started thread.
+	\param func - function to run in the thread.
+	\param arg - argument passed to the function.
+	\return jm_status_success if the thread was started.
+*/
+jm_status_enu_t jm_thread_create(jm_thread_t* t, jm_thread_func_ft func, void* arg);
+
+/** \brief Wait for a thread started with jm_thread_create() to finish and release its resources. */
+void jm_thread_join(jm_thread_t* t);
+
+/** \brief Get the number of processors available to the process. At least one is reported. */
+size_t jm_thread_get_cpus_num(void);
+
+/**
+	\brief Restrict the calling thread to run on one processor.
+	\param cpu - index of the processor, counted from zero.
+	\return jm_status_success if the thread was pinned, jm_status_error if the processor does not exist
+		or the platform does not support thread affinity.
+*/
+jm_status_enu_t jm_thread_pin_current(size_t cpu);
+
+/** \brief Key of a pointer with a separate value in each thread. */
+typedef struct jm_thread_key_t {
+#ifdef JM_THREAD_WIN32
+	DWORD index;
+#else
+	pthread_key_t key;
+#endif
+} jm_thread_key_t;
+
+/** \brief Create a thread-local key. The value is NULL in all threads. */
+jm_status_enu_t jm_thread_key_create(jm_thread_key_t* k);
+
+/** \brief Delete a key created with jm_thread_key_create(). The values are not freed. */
+void jm_thread_key_delete(jm_thread_key_t* k);
+
+/** \brief Get the value of a key in the calling thread. */
+void* jm_thread_key_get(jm_thread_key_t* k);
+
+/** \brief Set the value of a key in the calling thread. */
+void jm_thread_key_set(jm_thread_key_t* k, void* value);
+
+/** \brief Read a counter written by another thread. Reads that follow are not moved before it,
+	so data published with jm_atomic_store_release() is visible. */
+size_t jm_atomic_load_acquire(volatile size_t* p);
+
+/** \brief Write a counter read by another thread. Writes that precede it are not moved after it. */
+void jm_atomic_store_release(volatile size_t* p, size_t value);
+
+/** \brief Replace a counter with a new value if it still has the expected value. Full memory barrier.
+	\return Non-zero if the counter was replaced. */
+int jm_atomic_compare_exchange(volatile size_t* p, size_t expected, size_t desired);
+
+/** \brief Add to a counter and return the previous value. Full memory barrier. */
+size_t jm_atomic_fetch_add(volatile size_t* p, size_t value);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_THREAD_H_ */
@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_THREAD_POOL_H_
+#define JM_THREAD_POOL_H_
+
+#include <stddef.h>
+#include "jm_callbacks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file jm_thread_pool.h
+	Work-stealing thread pool for fork-join parallel loops.
+*/
+/** \addtogroup jm_thread
+@{*/
+
+/** \brief Opaque thread pool. */
+typedef struct jm_thread_pool_t jm_thread_pool_t;
+
+/** \brief Task function. Called once for each index 0..tasksNum-1 passed to jm_thread_pool_run(). */
+typedef void (*jm_thread_pool_task_ft)(void* context, size_t index);
+
+/**
+	\brief Create a thread pool.
+
+	The calling thread of jm_thread_pool_run() takes part in the work, so threadsNum - 1 worker threads are started.
+	\param cb - callbacks for memory allocation and logging. Default callbacks are used if this parameter is NULL.
+	\param threadsNum - total number of threads executing tasks. Values smaller than 1 are treated as 1.
+	\return The pool or NULL on error.
+*/
+jm_thread_pool_t* jm_thread_pool_create(jm_callbacks* cb, size_t threadsNum);
+
+/** \brief Stop the worker threads and free the pool. */
+void jm_thread_pool_destroy(jm_thread_pool_t* pool);
+
+/** \brief Get the number of threads executing tasks, including the calling thread. */
+size_t jm_thread_pool_get_threads_num(jm_thread_pool_t* pool);
+
+/**
+	\brief Run tasks in parallel and wait for all of them to finish.
+
+	The task indices are split into contiguous ranges, one per thread. A thread that runs out of
+	work steals single tasks from the front of the other ranges, so that a few slow tasks do not
+	leave the remaining threads idle. Calls from different threads are serialized.
+	\param pool - the pool.
+	\param tasksNum - number of tasks.
+	\param task - task function.
+	\param context - first argument to the task function.
+*/
+void jm_thread_pool_run(jm_thread_pool_t* pool, size_t tasksNum, jm_thread_pool_task_ft task, void* context);
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_THREAD_POOL_H_ */
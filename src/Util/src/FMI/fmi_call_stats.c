@@ -0,0 +1,54 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <math.h>
+#include <FMI/fmi_call_stats.h>
+
+/* Linear sub-buckets per power of two */
+#define FMI_CALL_STATS_SUB 4
+
+size_t fmi_call_stats_bucket(double seconds) {
+	double ns = seconds * 1e9, m;
+	int e;
+	size_t bucket;
+	if(!(ns >= FMI_CALL_STATS_SUB)) return (ns > 0) ? (size_t)ns : 0;
+	/* ns = m * 2^e with 0.5 <= m < 1, i.e., the leading power of two is 2^(e-1) */
+	m = frexp(ns, &e);
+	bucket = (size_t)(e - 2) * FMI_CALL_STATS_SUB + (size_t)((2 * m - 1) * FMI_CALL_STATS_SUB);
+	return (bucket < FMI_CALL_STATS_BUCKETS) ? bucket : FMI_CALL_STATS_BUCKETS - 1;
+}
+
+double fmi_call_stats_bucket_seconds(size_t bucket) {
+	if(bucket < FMI_CALL_STATS_SUB) return 1e-9 * (double)bucket;
+	return 1e-9 * ldexp(1.0 + (double)(bucket % FMI_CALL_STATS_SUB) / FMI_CALL_STATS_SUB, (int)(bucket / FMI_CALL_STATS_SUB + 1));
+}
+
+void fmi_call_stats_record(fmi_call_stats_t* stats, double seconds) {
+	stats->count++;
+	stats->totalSeconds += seconds;
+	if(seconds > stats->maxSeconds) stats->maxSeconds = seconds;
+	stats->histogram[fmi_call_stats_bucket(seconds)]++;
+}
+
+double fmi_call_stats_percentile(const fmi_call_stats_t* stats, double percentile) {
+	double rank = percentile / 100.0 * (double)stats->count, seen = 0;
+	size_t b;
+	if(stats->count == 0) return 0;
+	for(b = 0; b < FMI_CALL_STATS_BUCKETS; b++) {
+		seen += stats->histogram[b];
+		if(seen >= rank && stats->histogram[b]) return fmi_call_stats_bucket_seconds(b);
+	}
+	return fmi_call_stats_bucket_seconds(FMI_CALL_STATS_BUCKETS - 1);
+}
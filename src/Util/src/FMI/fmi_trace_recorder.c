@@ -0,0 +1,473 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <JM/jm_portability.h>
+#include <JM/jm_thread.h>
+#include <FMI/fmi_trace_recorder.h>
+
+static const char* module = "FMILIB";
+
+#define FMI_TRACE_DEFAULT_EVENTS 16384
+/* Seconds between the flushes of the background thread */
+#define FMI_TRACE_FLUSH_INTERVAL 0.05
+/* Process id and track uuids written to the trace */
+#define FMI_TRACE_PID 1
+#define FMI_TRACE_PROCESS_UUID 1000
+/* Perfetto TrackEvent types */
+#define FMI_TRACE_PB_SLICE_BEGIN 1
+#define FMI_TRACE_PB_SLICE_END 2
+#define FMI_TRACE_PB_INSTANT 3
+
+typedef struct fmi_trace_event_t {
+	double start;
+	double duration; /* negative for instant events */
+	char name[FMI_TRACE_RECORDER_NAME_MAX + 1];
+	char category[FMI_TRACE_RECORDER_CATEGORY_MAX + 1];
+} fmi_trace_event_t;
+
+/* Single producer, single consumer ring of one thread */
+typedef struct fmi_trace_buffer_t {
+	fmi_trace_event_t* events;
+	size_t size;
+	volatile size_t head;  /* next event to write, advanced by the owner thread */
+	volatile size_t tail;  /* next event to flush, advanced by the flusher */
+	size_t droppedNum;     /* written by the owner thread only */
+	size_t tid;
+	char threadName[FMI_TRACE_RECORDER_CATEGORY_MAX + 1];
+	int isDescribed;       /* the thread name is written; protected by the recorder lock */
+	struct fmi_trace_buffer_t* next;
+} fmi_trace_buffer_t;
+
+typedef struct fmi_trace_recorder_t {
+	jm_callbacks* callbacks;
+	FILE* file;
+	fmi_trace_format_enu_t format;
+	size_t bufferEvents;
+	double startTime;
+	jm_thread_key_t key;     /* buffer of the calling thread */
+
+	jm_mutex_t lock;         /* protects the following */
+	jm_cond_t wake;
+	int isStopping;
+	fmi_trace_buffer_t* buffers;
+	size_t threadsNum;
+
+	/* used by the flusher only */
+	jm_thread_t flusher;
+	size_t writtenNum;
+	int writeFailed;
+} fmi_trace_recorder_t;
+
+/* Protobuf message under construction */
+typedef struct fmi_trace_pb_t {
+	unsigned char data[256];
+	size_t n;
+} fmi_trace_pb_t;
+
+static fmi_trace_recorder_t* volatile fmi_trace_active = 0;
+static jm_mutex_t fmi_trace_start_lock = JM_MUTEX_INITIALIZER;
+
+static void fmi_trace_copy(char* dst, const char* src, size_t max) {
+	size_t i = 0;
+	if(src) {
+		for(; i < max && src[i]; i++) dst[i] = src[i];
+	}
+	dst[i] = 0;
+}
+
+/* Get or create the buffer of the calling thread */
+static fmi_trace_buffer_t* fmi_trace_get_buffer(fmi_trace_recorder_t* rec) {
+	fmi_trace_buffer_t* buf = (fmi_trace_buffer_t*)jm_thread_key_get(&rec->key);
+	if(buf) return buf;
+
+	buf = (fmi_trace_buffer_t*)rec->callbacks->calloc(1, sizeof(fmi_trace_buffer_t));
+	if(buf) buf->events = (fmi_trace_event_t*)rec->callbacks->calloc(rec->bufferEvents, sizeof(fmi_trace_event_t));
+	if(!buf || !buf->events) {
+		if(buf) rec->callbacks->free(buf);
+		return 0;
+	}
+	buf->size = rec->bufferEvents;
+	jm_mutex_lock(&rec->lock);
+	buf->tid = ++rec->threadsNum;
+	sprintf(buf->threadName, "thread %u", (unsigned)buf->tid);
+	buf->next = rec->buffers;
+	rec->buffers = buf;
+	jm_mutex_unlock(&rec->lock);
+	jm_thread_key_set(&rec->key, buf);
+	return buf;
+}
+
+static void fmi_trace_record(const char* name, const char* category, double start, double duration) {
+	fmi_trace_recorder_t* rec = fmi_trace_active;
+	fmi_trace_buffer_t* buf;
+	fmi_trace_event_t* ev;
+	size_t head, used;
+
+	if(!rec) return;
+	buf = fmi_trace_get_buffer(rec);
+	if(!buf) return;
+	head = buf->head;
+	used = head - jm_atomic_load_acquire(&buf->tail);
+	if(used >= buf->size) {
+		buf->droppedNum++;
+		return;
+	}
+	ev = &buf->events[head % buf->size];
+	ev->start = start;
+	ev->duration = duration;
+	fmi_trace_copy(ev->name, name, FMI_TRACE_RECORDER_NAME_MAX);
+	fmi_trace_copy(ev->category, category, FMI_TRACE_RECORDER_CATEGORY_MAX);
+	jm_atomic_store_release(&buf->head, head + 1);
+	if(used + 1 == buf->size / 2) {
+		/* wake the flusher early; a missed wake-up only delays the flush */
+		jm_cond_signal(&rec->wake);
+	}
+}
+
+void fmi_trace_recorder_slice(const char* name, const char* category, double startTime, double endTime) {
+	fmi_trace_record(name, category, startTime, (endTime > startTime) ? endTime - startTime : 0);
+}
+
+void fmi_trace_recorder_instant(const char* name, const char* category, double time) {
+	fmi_trace_record(name, category, time, -1);
+}
+
+void fmi_trace_recorder_set_thread_name(const char* name) {
+	fmi_trace_recorder_t* rec = fmi_trace_active;
+	fmi_trace_buffer_t* buf;
+	if(!rec) return;
+	buf = fmi_trace_get_buffer(rec);
+	if(!buf) return;
+	jm_mutex_lock(&rec->lock);
+	fmi_trace_copy(buf->threadName, name, FMI_TRACE_RECORDER_CATEGORY_MAX);
+	buf->isDescribed = 0;
+	jm_mutex_unlock(&rec->lock);
+}
+
+int fmi_trace_recorder_is_active(void) {
+	return fmi_trace_active != 0;
+}
+
+size_t fmi_trace_recorder_get_dropped_num(void) {
+	fmi_trace_recorder_t* rec = fmi_trace_active;
+	fmi_trace_buffer_t* buf;
+	size_t n = 0;
+	if(!rec) return 0;
+	jm_mutex_lock(&rec->lock);
+	for(buf = rec->buffers; buf; buf = buf->next) n += buf->droppedNum;
+	jm_mutex_unlock(&rec->lock);
+	return n;
+}
+
+/* Chrome Trace Event JSON */
+
+static void fmi_trace_json_string(FILE* f, const char* s) {
+	fputc('"', f);
+	for(; *s; s++) {
+		unsigned char c = (unsigned char)*s;
+		if(c == '"' || c == '\\') fprintf(f, "\\%c", c);
+		else if(c < 0x20) fprintf(f, "\\u%04x", c);
+		else fputc(c, f);
+	}
+	fputc('"', f);
+}
+
+static void fmi_trace_json_separator(fmi_trace_recorder_t* rec) {
+	fputs(rec->writtenNum++ ? ",\n" : "\n", rec->file);
+}
+
+static void fmi_trace_json_thread(fmi_trace_recorder_t* rec, fmi_trace_buffer_t* buf) {
+	fmi_trace_json_separator(rec);
+	fprintf(rec->file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+		FMI_TRACE_PID, (unsigned)buf->tid);
+	fmi_trace_json_string(rec->file, buf->threadName);
+	fputs("}}", rec->file);
+}
+
+/* Time in microseconds with three decimals. The decimal point is written explicitly since
+   printf uses the decimal separator of the current locale. */
+static void fmi_trace_json_time(FILE* f, const char* key, double seconds) {
+	double ns = (seconds > 0) ? floor(1e9 * seconds + 0.5) : 0;
+	double us = floor(ns / 1000);
+	fprintf(f, ",\"%s\":%.0f.%03d", key, us, (int)(ns - 1000 * us));
+}
+
+static void fmi_trace_json_event(fmi_trace_recorder_t* rec, fmi_trace_buffer_t* buf, const fmi_trace_event_t* ev) {
+	fmi_trace_json_separator(rec);
+	fputs("{\"name\":", rec->file);
+	fmi_trace_json_string(rec->file, ev->name);
+	fputs(",\"cat\":", rec->file);
+	fmi_trace_json_string(rec->file, ev->category[0] ? ev->category : "fmi");
+	if(ev->duration < 0) {
+		fputs(",\"ph\":\"i\",\"s\":\"t\"", rec->file);
+		fmi_trace_json_time(rec->file, "ts", ev->start - rec->startTime);
+	}
+	else {
+		fputs(",\"ph\":\"X\"", rec->file);
+		fmi_trace_json_time(rec->file, "ts", ev->start - rec->startTime);
+		fmi_trace_json_time(rec->file, "dur", ev->duration);
+	}
+	fprintf(rec->file, ",\"pid\":%d,\"tid\":%u}", FMI_TRACE_PID, (unsigned)buf->tid);
+}
+
+/* Perfetto protobuf. Integers are passed as doubles since C89 has no 64-bit type;
+   they are exact up to 2^53, i.e., for more than 100 days in nanoseconds. */
+
+static void fmi_trace_pb_varint(fmi_trace_pb_t* pb, double v) {
+	v = (v > 0) ? floor(v + 0.5) : 0;
+	while(v >= 128 && pb->n < sizeof(pb->data)) {
+		double q = floor(v / 128);
+		pb->data[pb->n++] = (unsigned char)(0x80 | (int)(v - 128 * q));
+		v = q;
+	}
+	if(pb->n < sizeof(pb->data)) pb->data[pb->n++] = (unsigned char)v;
+}
+
+static void fmi_trace_pb_uint(fmi_trace_pb_t* pb, int field, double v) {
+	fmi_trace_pb_varint(pb, field * 8);
+	fmi_trace_pb_varint(pb, v);
+}
+
+static void fmi_trace_pb_bytes(fmi_trace_pb_t* pb, int field, const void* data, size_t n) {
+	fmi_trace_pb_varint(pb, field * 8 + 2);
+	fmi_trace_pb_varint(pb, (double)n);
+	if(pb->n + n > sizeof(pb->data)) n = sizeof(pb->data) - pb->n;
+	memcpy(pb->data + pb->n, data, n);
+	pb->n += n;
+}
+
+static void fmi_trace_pb_string(fmi_trace_pb_t* pb, int field, const char* s) {
+	fmi_trace_pb_bytes(pb, field, s, strlen(s));
+}
+
+static void fmi_trace_pb_message(fmi_trace_pb_t* pb, int field, const fmi_trace_pb_t* msg) {
+	fmi_trace_pb_bytes(pb, field, msg->data, msg->n);
+}
+
+/* Write a TracePacket as an element of Trace.packet */
+static void fmi_trace_pb_packet(fmi_trace_recorder_t* rec, fmi_trace_pb_t* packet) {
+	fmi_trace_pb_t frame;
+	/* trusted_packet_sequence_id */
+	fmi_trace_pb_uint(packet, 10, 1);
+	if(!rec->writtenNum++) {
+		/* sequence_flags = SEQ_INCREMENTAL_STATE_CLEARED */
+		fmi_trace_pb_uint(packet, 13, 1);
+	}
+	frame.n = 0;
+	fmi_trace_pb_varint(&frame, 1 * 8 + 2);
+	fmi_trace_pb_varint(&frame, (double)packet->n);
+	fwrite(frame.data, 1, frame.n, rec->file);
+	fwrite(packet->data, 1, packet->n, rec->file);
+}
+
+static void fmi_trace_pb_process(fmi_trace_recorder_t* rec) {
+	fmi_trace_pb_t packet, track, process;
+	process.n = 0;
+	fmi_trace_pb_uint(&process, 1, FMI_TRACE_PID);
+	fmi_trace_pb_string(&process, 6, "FMI Library");
+	track.n = 0;
+	fmi_trace_pb_uint(&track, 1, FMI_TRACE_PROCESS_UUID);
+	fmi_trace_pb_message(&track, 3, &process);
+	packet.n = 0;
+	fmi_trace_pb_message(&packet, 60, &track);
+	fmi_trace_pb_packet(rec, &packet);
+}
+
+static void fmi_trace_pb_thread(fmi_trace_recorder_t* rec, fmi_trace_buffer_t* buf) {
+	fmi_trace_pb_t packet, track, thread;
+	thread.n = 0;
+	fmi_trace_pb_uint(&thread, 1, FMI_TRACE_PID);
+	fmi_trace_pb_uint(&thread, 2, (double)buf->tid);
+	fmi_trace_pb_string(&thread, 5, buf->threadName);
+	track.n = 0;
+	fmi_trace_pb_uint(&track, 1, (double)(FMI_TRACE_PROCESS_UUID + buf->tid));
+	fmi_trace_pb_uint(&track, 5, FMI_TRACE_PROCESS_UUID);
+	fmi_trace_pb_message(&track, 4, &thread);
+	packet.n = 0;
+	fmi_trace_pb_message(&packet, 60, &track);
+	fmi_trace_pb_packet(rec, &packet);
+}
+
+static void fmi_trace_pb_track_event(fmi_trace_recorder_t* rec, fmi_trace_buffer_t* buf, double time, int type, const fmi_trace_event_t* ev) {
+	fmi_trace_pb_t packet, event;
+	event.n = 0;
+	fmi_trace_pb_uint(&event, 9, type);
+	fmi_trace_pb_uint(&event, 11, (double)(FMI_TRACE_PROCESS_UUID + buf->tid));
+	if(ev) {
+		fmi_trace_pb_string(&event, 22, ev->category[0] ? ev->category : "fmi");
+		fmi_trace_pb_string(&event, 23, ev->name);
+	}
+	packet.n = 0;
+	fmi_trace_pb_uint(&packet, 8, 1e9 * (time - rec->startTime));
+	fmi_trace_pb_message(&packet, 11, &event);
+	fmi_trace_pb_packet(rec, &packet);
+}
+
+static void fmi_trace_pb_event(fmi_trace_recorder_t* rec, fmi_trace_buffer_t* buf, const fmi_trace_event_t* ev) {
+	if(ev->duration < 0) {
+		fmi_trace_pb_track_event(rec, buf, ev->start, FMI_TRACE_PB_INSTANT, ev);
+	}
+	else {
+		fmi_trace_pb_track_event(rec, buf, ev->start, FMI_TRACE_PB_SLICE_BEGIN, ev);
+		fmi_trace_pb_track_event(rec, buf, ev->start + ev->duration, FMI_TRACE_PB_SLICE_END, 0);
+	}
+}
+
+/* Background flushing */
+
+/* Write the events buffered so far. Called by the flusher thread only. */
+static void fmi_trace_flush(fmi_trace_recorder_t* rec) {
+	fmi_trace_buffer_t* buf;
+
+	jm_mutex_lock(&rec->lock);
+	for(buf = rec->buffers; buf; buf = buf->next) {
+		if(buf->isDescribed) continue;
+		if(rec->format == fmi_trace_format_perfetto) fmi_trace_pb_thread(rec, buf);
+		else fmi_trace_json_thread(rec, buf);
+		buf->isDescribed = 1;
+	}
+	buf = rec->buffers;
+	jm_mutex_unlock(&rec->lock);
+
+	/* buffers are only added at the front, so the list from here on does not change */
+	for(; buf; buf = buf->next) {
+		size_t tail = buf->tail, head = jm_atomic_load_acquire(&buf->head);
+		for(; tail != head; tail++) {
+			const fmi_trace_event_t* ev = &buf->events[tail % buf->size];
+			if(rec->format == fmi_trace_format_perfetto) fmi_trace_pb_event(rec, buf, ev);
+			else fmi_trace_json_event(rec, buf, ev);
+		}
+		jm_atomic_store_release(&buf->tail, tail);
+	}
+	if(fflush(rec->file) != 0) rec->writeFailed = 1;
+}
+
+static void fmi_trace_flusher(void* arg) {
+	fmi_trace_recorder_t* rec = (fmi_trace_recorder_t*)arg;
+	int isStopping;
+	do {
+		jm_mutex_lock(&rec->lock);
+		if(!rec->isStopping) jm_cond_timed_wait(&rec->wake, &rec->lock, FMI_TRACE_FLUSH_INTERVAL);
+		isStopping = rec->isStopping;
+		jm_mutex_unlock(&rec->lock);
+		fmi_trace_flush(rec);
+	} while(!isStopping);
+}
+
+static void fmi_trace_free(fmi_trace_recorder_t* rec) {
+	jm_callbacks* cb = rec->callbacks;
+	while(rec->buffers) {
+		fmi_trace_buffer_t* buf = rec->buffers;
+		rec->buffers = buf->next;
+		cb->free(buf->events);
+		cb->free(buf);
+	}
+	jm_cond_destroy(&rec->wake);
+	jm_mutex_destroy(&rec->lock);
+	jm_thread_key_delete(&rec->key);
+	cb->free(rec);
+}
+
+jm_status_enu_t fmi_trace_recorder_start(jm_callbacks* cb, const char* fileName, fmi_trace_format_enu_t format, size_t bufferEvents) {
+	fmi_trace_recorder_t* rec;
+
+	jm_mutex_lock(&fmi_trace_start_lock);
+	if(fmi_trace_active) {
+		jm_mutex_unlock(&fmi_trace_start_lock);
+		jm_log_error(cb, module, "A trace recorder is already started");
+		return jm_status_error;
+	}
+	rec = (fmi_trace_recorder_t*)cb->calloc(1, sizeof(fmi_trace_recorder_t));
+	if(!rec) {
+		jm_mutex_unlock(&fmi_trace_start_lock);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	rec->callbacks = cb;
+	rec->format = format;
+	rec->bufferEvents = bufferEvents ? bufferEvents : FMI_TRACE_DEFAULT_EVENTS;
+	rec->startTime = jm_portability_get_time();
+	if(jm_thread_key_create(&rec->key) != jm_status_success) {
+		cb->free(rec);
+		jm_mutex_unlock(&fmi_trace_start_lock);
+		jm_log_error(cb, module, "Could not create the thread-local trace buffers");
+		return jm_status_error;
+	}
+	jm_mutex_init(&rec->lock);
+	jm_cond_init(&rec->wake);
+
+	rec->file = fopen(fileName, (format == fmi_trace_format_perfetto) ? "wb" : "w");
+	if(!rec->file) {
+		fmi_trace_free(rec);
+		jm_mutex_unlock(&fmi_trace_start_lock);
+		jm_log_error(cb, module, "Could not open the trace file '%s'", fileName);
+		return jm_status_error;
+	}
+	if(format == fmi_trace_format_perfetto) fmi_trace_pb_process(rec);
+	else fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", rec->file);
+
+	if(jm_thread_create(&rec->flusher, fmi_trace_flusher, rec) != jm_status_success) {
+		fclose(rec->file);
+		fmi_trace_free(rec);
+		jm_mutex_unlock(&fmi_trace_start_lock);
+		jm_log_error(cb, module, "Could not start the trace flushing thread");
+		return jm_status_error;
+	}
+	fmi_trace_active = rec;
+	jm_mutex_unlock(&fmi_trace_start_lock);
+	jm_log_verbose(cb, module, "Recording a trace to '%s'", fileName);
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi_trace_recorder_stop(void) {
+	fmi_trace_recorder_t* rec;
+	jm_callbacks* cb;
+	size_t droppedNum;
+	int failed;
+
+	jm_mutex_lock(&fmi_trace_start_lock);
+	rec = fmi_trace_active;
+	if(!rec) {
+		jm_mutex_unlock(&fmi_trace_start_lock);
+		return jm_status_success;
+	}
+	droppedNum = fmi_trace_recorder_get_dropped_num();
+	fmi_trace_active = 0;
+
+	jm_mutex_lock(&rec->lock);
+	rec->isStopping = 1;
+	jm_cond_signal(&rec->wake);
+	jm_mutex_unlock(&rec->lock);
+	jm_thread_join(&rec->flusher);
+
+	if(rec->format == fmi_trace_format_chrome_json) fputs("\n]}\n", rec->file);
+	failed = rec->writeFailed | (fclose(rec->file) != 0);
+	cb = rec->callbacks;
+	fmi_trace_free(rec);
+	jm_mutex_unlock(&fmi_trace_start_lock);
+
+	if(droppedNum) {
+		jm_log_warning(cb, module, "%u trace events were dropped since the buffers were full", (unsigned)droppedNum);
+	}
+	if(failed) {
+		jm_log_error(cb, module, "Could not write the trace file");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
@@ -21,6 +21,7 @@
 
 #include "JM/jm_callbacks.h"
 #include "JM/jm_portability.h"
+#include "JM/jm_thread.h"
 
 static const char* jm_log_level_str[] = 
 {
@@ -57,13 +58,41 @@ void jm_log(jm_callbacks* cb, const char* module, jm_log_level_enu_t log_level,
 }
 
 void jm_log_v(jm_callbacks* cb, const char* module, jm_log_level_enu_t log_level, const char* fmt, va_list ap) {
+	/* Format on the stack so that the logger gets a message no other thread writes to. */
+	char buffer[JM_MAX_ERROR_MESSAGE_SIZE];
 	if(log_level > cb->log_level) return;
-    jm_vsnprintf(cb->errMessageBuffer, JM_MAX_ERROR_MESSAGE_SIZE, fmt, ap);
+    jm_vsnprintf(buffer, JM_MAX_ERROR_MESSAGE_SIZE, fmt, ap);
+	jm_set_last_error(cb, log_level, buffer);
 	if(cb->logger) {
-		cb->logger(cb,module, log_level, cb->errMessageBuffer);
+		cb->logger(cb,module, log_level, buffer);
 	}
 }
 
+/* Without compiler support all threads share one message */
+#ifndef JM_THREAD_LOCAL
+#define JM_THREAD_LOCAL
+#endif
+
+/* The last warning or error logged by the calling thread */
+static JM_THREAD_LOCAL char jm_last_error[JM_MAX_ERROR_MESSAGE_SIZE];
+
+jm_string jm_get_last_error(jm_callbacks* cb) {
+	return jm_last_error;
+}
+
+void jm_clear_last_error(jm_callbacks* cb) {
+	jm_last_error[0] = 0;
+}
+
+void jm_set_last_error(jm_callbacks* cb, jm_log_level_enu_t log_level, jm_string message) {
+	size_t len;
+	if(log_level > jm_log_level_warning) return;
+	len = strlen(message);
+	if(len >= JM_MAX_ERROR_MESSAGE_SIZE) len = JM_MAX_ERROR_MESSAGE_SIZE - 1;
+	memcpy(jm_last_error, message, len);
+	jm_last_error[len] = 0;
+}
+
 #define CREATE_LOG_FUNCTIONS(log_level) \
 void jm_log_ ## log_level(jm_callbacks* cb, const char* module, const char* fmt, ...) { \
 	va_list args; \
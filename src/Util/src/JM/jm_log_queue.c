@@ -0,0 +1,276 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+#include <stddef.h>
+
+#include <JM/jm_thread.h>
+#include <JM/jm_log_queue.h>
+
+static const char* module = "JMLOGQ";
+
+#define JM_LOG_QUEUE_DEFAULT_CAPACITY 1024
+#define JM_LOG_QUEUE_DEFAULT_MESSAGE_SIZE 512
+#define JM_LOG_QUEUE_MODULE_SIZE 32
+#define JM_LOG_QUEUE_CACHE_LINE 64
+/* Longest sleep of a waiting thread before it looks at the queue again. Wakeups are
+   sent after full barriers on both sides, the poll only bounds the damage of a lost one. */
+#define JM_LOG_QUEUE_POLL 0.05
+
+/* Ring slot. The sequence is the position the slot may be written at next, position + 1
+   once the message is written, and position + capacity after it has been delivered. */
+typedef struct jm_log_queue_slot_t {
+	volatile size_t sequence;
+	jm_log_level_enu_t level;
+	char module[JM_LOG_QUEUE_MODULE_SIZE];
+	char message[1]; /* messageSize characters */
+} jm_log_queue_slot_t;
+
+struct jm_log_queue_t {
+	jm_callbacks* callbacks; /* callbacks the queue is installed in */
+	jm_callbacks sink;       /* the callbacks before installation; used by the sink thread */
+	jm_log_queue_policy_enu_t policy;
+	char* slots;
+	size_t slotSize;
+	size_t mask;             /* capacity - 1 */
+	size_t messageSize;
+
+	char pad0[JM_LOG_QUEUE_CACHE_LINE];
+	volatile size_t enqueuePos;  /* next position to reserve; advanced by the logging threads */
+	char pad1[JM_LOG_QUEUE_CACHE_LINE];
+	volatile size_t dequeuePos;  /* next position to deliver; advanced by the sink thread */
+	char pad2[JM_LOG_QUEUE_CACHE_LINE];
+
+	volatile size_t droppedNum;
+	volatile size_t truncatedNum;
+	volatile size_t waitsNum;
+	volatile size_t sinkSleeping; /* the sink thread waits for dataCond */
+	volatile size_t waitersNum;   /* threads waiting for spaceCond */
+	volatile size_t stop;
+
+	jm_mutex_t lock;
+	jm_cond_t dataCond;
+	jm_cond_t spaceCond;
+	jm_thread_key_t sinkKey; /* set in the sink thread */
+	jm_thread_t thread;
+};
+
+#define JM_LOG_QUEUE_SLOT(q, pos) ((jm_log_queue_slot_t*)((q)->slots + ((pos) & (q)->mask) * (q)->slotSize))
+
+static void jm_log_queue_wake_sink(jm_log_queue_t* q) {
+	jm_mutex_lock(&q->lock);
+	jm_cond_signal(&q->dataCond);
+	jm_mutex_unlock(&q->lock);
+}
+
+/* Wait until the slot at a position has been delivered one round earlier. */
+static void jm_log_queue_wait_space(jm_log_queue_t* q, jm_log_queue_slot_t* slot, size_t pos) {
+	jm_atomic_fetch_add(&q->waitsNum, 1);
+	jm_atomic_fetch_add(&q->waitersNum, 1);
+	jm_mutex_lock(&q->lock);
+	while((ptrdiff_t)(jm_atomic_load_acquire(&slot->sequence) - pos) < 0 && !jm_atomic_load_acquire(&q->stop)) {
+		jm_cond_signal(&q->dataCond);
+		jm_cond_timed_wait(&q->spaceCond, &q->lock, JM_LOG_QUEUE_POLL);
+	}
+	jm_mutex_unlock(&q->lock);
+	jm_atomic_fetch_add(&q->waitersNum, (size_t)-1);
+}
+
+static void jm_log_queue_push(jm_log_queue_t* q, jm_string mod, jm_log_level_enu_t level, jm_string message) {
+	jm_log_queue_slot_t* slot;
+	size_t pos, len;
+
+	pos = jm_atomic_load_acquire(&q->enqueuePos);
+	for(;;) {
+		ptrdiff_t diff;
+		slot = JM_LOG_QUEUE_SLOT(q, pos);
+		diff = (ptrdiff_t)(jm_atomic_load_acquire(&slot->sequence) - pos);
+		if(diff == 0) {
+			if(jm_atomic_compare_exchange(&q->enqueuePos, pos, pos + 1)) break;
+		}
+		else if(diff < 0) {
+			/* The slot still holds the message from one round earlier: the queue is full.
+			   The sink thread must never wait for itself. */
+			if(q->policy == jm_log_queue_drop || jm_thread_key_get(&q->sinkKey) || jm_atomic_load_acquire(&q->stop)) {
+				jm_atomic_fetch_add(&q->droppedNum, 1);
+				return;
+			}
+			jm_log_queue_wait_space(q, slot, pos);
+		}
+		pos = jm_atomic_load_acquire(&q->enqueuePos);
+	}
+
+	slot->level = level;
+	if(!mod) mod = "";
+	strncpy(slot->module, mod, JM_LOG_QUEUE_MODULE_SIZE - 1);
+	slot->module[JM_LOG_QUEUE_MODULE_SIZE - 1] = 0;
+	if(!message) message = "";
+	len = strlen(message);
+	if(len >= q->messageSize) {
+		len = q->messageSize - 1;
+		jm_atomic_fetch_add(&q->truncatedNum, 1);
+	}
+	memcpy(slot->message, message, len);
+	slot->message[len] = 0;
+
+	/* Publish with a full barrier so that the flag read below is not older than the message. */
+	jm_atomic_fetch_add(&slot->sequence, 1);
+	if(jm_atomic_load_acquire(&q->sinkSleeping)) {
+		jm_log_queue_wake_sink(q);
+	}
+}
+
+static void jm_log_queue_logger(jm_callbacks* c, jm_string mod, jm_log_level_enu_t level, jm_string message) {
+	jm_log_queue_push((jm_log_queue_t*)c->context, mod, level, message);
+}
+
+static void jm_log_queue_sink(void* arg) {
+	jm_log_queue_t* q = (jm_log_queue_t*)arg;
+
+	jm_thread_key_set(&q->sinkKey, q);
+	for(;;) {
+		size_t pos = q->dequeuePos;
+		jm_log_queue_slot_t* slot = JM_LOG_QUEUE_SLOT(q, pos);
+
+		if(jm_atomic_load_acquire(&slot->sequence) == pos + 1) {
+			q->sink.logger(&q->sink, slot->module, slot->level, slot->message);
+			jm_atomic_store_release(&slot->sequence, pos + q->mask + 1);
+			jm_atomic_store_release(&q->dequeuePos, pos + 1);
+			if(jm_atomic_load_acquire(&q->waitersNum)) {
+				jm_mutex_lock(&q->lock);
+				jm_cond_broadcast(&q->spaceCond);
+				jm_mutex_unlock(&q->lock);
+			}
+			continue;
+		}
+		if(jm_atomic_load_acquire(&q->stop)) {
+			/* Messages logged before the stop request are visible now. */
+			if(jm_atomic_load_acquire(&slot->sequence) == pos + 1) continue;
+			break;
+		}
+
+		jm_mutex_lock(&q->lock);
+		jm_atomic_compare_exchange(&q->sinkSleeping, 0, 1);
+		if(jm_atomic_load_acquire(&slot->sequence) != pos + 1 && !jm_atomic_load_acquire(&q->stop)) {
+			jm_cond_timed_wait(&q->dataCond, &q->lock, JM_LOG_QUEUE_POLL);
+		}
+		jm_atomic_store_release(&q->sinkSleeping, 0);
+		jm_mutex_unlock(&q->lock);
+	}
+}
+
+jm_log_queue_t* jm_log_queue_create(jm_callbacks* cb, size_t capacity, size_t messageSize, jm_log_queue_policy_enu_t policy) {
+	jm_log_queue_t* q;
+	size_t n, i;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	if(capacity == 0) capacity = JM_LOG_QUEUE_DEFAULT_CAPACITY;
+	if(messageSize == 0) messageSize = JM_LOG_QUEUE_DEFAULT_MESSAGE_SIZE;
+	for(n = 1; n < capacity; n <<= 1);
+
+	q = (jm_log_queue_t*)cb->calloc(1, sizeof(jm_log_queue_t));
+	if(q) {
+		q->slotSize = (offsetof(jm_log_queue_slot_t, message) + messageSize + JM_LOG_QUEUE_CACHE_LINE - 1)
+			/ JM_LOG_QUEUE_CACHE_LINE * JM_LOG_QUEUE_CACHE_LINE;
+		q->slots = (char*)cb->calloc(n, q->slotSize);
+	}
+	if(!q || !q->slots) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		if(q) cb->free(q);
+		return 0;
+	}
+	q->callbacks = cb;
+	q->sink = *cb;
+	q->policy = policy;
+	q->mask = n - 1;
+	q->messageSize = messageSize;
+	for(i = 0; i < n; i++) {
+		JM_LOG_QUEUE_SLOT(q, i)->sequence = i;
+	}
+	jm_mutex_init(&q->lock);
+	jm_cond_init(&q->dataCond);
+	jm_cond_init(&q->spaceCond);
+	if(jm_thread_key_create(&q->sinkKey) != jm_status_success) {
+		jm_log_error(cb, module, "Could not create thread key");
+		jm_cond_destroy(&q->spaceCond);
+		jm_cond_destroy(&q->dataCond);
+		jm_mutex_destroy(&q->lock);
+		cb->free(q->slots);
+		cb->free(q);
+		return 0;
+	}
+	if(jm_thread_create(&q->thread, jm_log_queue_sink, q) != jm_status_success) {
+		jm_log_error(cb, module, "Could not start sink thread");
+		jm_thread_key_delete(&q->sinkKey);
+		jm_cond_destroy(&q->spaceCond);
+		jm_cond_destroy(&q->dataCond);
+		jm_mutex_destroy(&q->lock);
+		cb->free(q->slots);
+		cb->free(q);
+		return 0;
+	}
+	jm_log_verbose(cb, module, "Logging through a queue of %u messages", (unsigned)n);
+	cb->logger = jm_log_queue_logger;
+	cb->context = q;
+	return q;
+}
+
+void jm_log_queue_destroy(jm_log_queue_t* q) {
+	jm_callbacks* cb;
+
+	if(!q) return;
+	cb = q->callbacks;
+
+	jm_mutex_lock(&q->lock);
+	jm_atomic_store_release(&q->stop, 1);
+	jm_cond_signal(&q->dataCond);
+	jm_cond_broadcast(&q->spaceCond);
+	jm_mutex_unlock(&q->lock);
+	jm_thread_join(&q->thread);
+
+	if(cb->logger == jm_log_queue_logger && cb->context == q) {
+		cb->logger = q->sink.logger;
+		cb->context = q->sink.context;
+	}
+	jm_thread_key_delete(&q->sinkKey);
+	jm_cond_destroy(&q->spaceCond);
+	jm_cond_destroy(&q->dataCond);
+	jm_mutex_destroy(&q->lock);
+	q->sink.free(q->slots);
+	q->sink.free(q);
+}
+
+void jm_log_queue_flush(jm_log_queue_t* q) {
+	size_t target;
+
+	if(jm_thread_key_get(&q->sinkKey)) return;
+	target = jm_atomic_load_acquire(&q->enqueuePos);
+	jm_atomic_fetch_add(&q->waitersNum, 1);
+	jm_mutex_lock(&q->lock);
+	while((ptrdiff_t)(jm_atomic_load_acquire(&q->dequeuePos) - target) < 0) {
+		jm_cond_signal(&q->dataCond);
+		jm_cond_timed_wait(&q->spaceCond, &q->lock, JM_LOG_QUEUE_POLL);
+	}
+	jm_mutex_unlock(&q->lock);
+	jm_atomic_fetch_add(&q->waitersNum, (size_t)-1);
+}
+
+void jm_log_queue_get_stats(jm_log_queue_t* q, jm_log_queue_stats_t* stats) {
+	stats->queuedNum = jm_atomic_load_acquire(&q->enqueuePos);
+	stats->deliveredNum = jm_atomic_load_acquire(&q->dequeuePos);
+	stats->droppedNum = jm_atomic_load_acquire(&q->droppedNum);
+	stats->truncatedNum = jm_atomic_load_acquire(&q->truncatedNum);
+	stats->waitsNum = jm_atomic_load_acquire(&q->waitsNum);
+}
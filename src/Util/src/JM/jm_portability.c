@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 #include <locale.h>
 
@@ -42,6 +43,9 @@ static const char * module = "JMPRT";
 #define set_current_working_directory _chdir	
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #define get_current_working_directory getcwd
 #define set_current_working_directory chdir
 #endif
@@ -52,6 +56,10 @@ DLL_HANDLE jm_portability_load_dll_handle(const char* dll_file_path)
 {
 #ifdef WIN32
 	/* printf("Will try to load %s\n", dll_file_path); */
+	if(strchr(dll_file_path, '\\') || strchr(dll_file_path, '/')) {
+		/* Search the directory of the DLL for its dependencies instead of the current directory */
+		return LoadLibraryEx(dll_file_path, NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
+	}
 	return LoadLibrary(dll_file_path);
 #else	
 	return dlopen(dll_file_path, RTLD_NOW|RTLD_LOCAL);
@@ -126,6 +134,23 @@ jm_status_enu_t jm_portability_set_current_working_directory(const char* cwd)
 	}
 }
 
+#ifndef WIN32
+#include <time.h>
+#endif
+
+double jm_portability_get_time(void) {
+#ifdef WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+}
+
 #ifdef WIN32
 #define MAX_TEMP_DIR_NAME_LENGTH 262
 TCHAR jm_temp_dir_buffer[MAX_TEMP_DIR_NAME_LENGTH];
@@ -219,28 +244,199 @@ jm_status_enu_t jm_rmdir(jm_callbacks* cb, const char* dir) {
 	return jm_status_success;
 }
 
-char* jm_get_dir_abspath(jm_callbacks* cb, const char* dir, char* outPath, size_t len) {
-	char curDir[FILENAME_MAX + 2];
-
+jm_status_enu_t jm_copy_file(jm_callbacks* cb, const char* src, const char* dst) {
+	char buf[16384];
+	size_t n;
+	jm_status_enu_t status = jm_status_success;
+	FILE* in;
+	FILE* out;
+
 	if(!cb) {
 		cb = jm_get_default_callbacks();
 	}
-	if( jm_portability_get_current_working_directory(curDir, FILENAME_MAX+1) != jm_status_success) {
-		jm_log_fatal(cb,module, "Could not get current working directory (%s)", strerror(errno));
-		return 0;
-	};
+	in = fopen(src, "rb");
+	if(!in) {
+		jm_log_error(cb, module, "Could not open %s for reading (%s)", src, strerror(errno));
+		return jm_status_error;
+	}
+	out = fopen(dst, "wb");
+	if(!out) {
+		jm_log_error(cb, module, "Could not open %s for writing (%s)", dst, strerror(errno));
+		fclose(in);
+		return jm_status_error;
+	}
+	while((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+		if(fwrite(buf, 1, n, out) != n) {
+			jm_log_error(cb, module, "Could not write to %s (%s)", dst, strerror(errno));
+			status = jm_status_error;
+			break;
+		}
+	}
+	if(status == jm_status_success && ferror(in)) {
+		jm_log_error(cb, module, "Could not read from %s", src);
+		status = jm_status_error;
+	}
+	fclose(in);
+	if(fclose(out) != 0 && status == jm_status_success) {
+		jm_log_error(cb, module, "Could not write to %s (%s)", dst, strerror(errno));
+		status = jm_status_error;
+	}
+#ifndef WIN32
+	if(status == jm_status_success) {
+		/* Keep the permissions, e.g., the execute bits of a shared library */
+		struct stat st;
+		if(stat(src, &st) != 0 || chmod(dst, st.st_mode & 07777) != 0) {
+			jm_log_error(cb, module, "Could not copy the permissions of %s to %s (%s)", src, dst, strerror(errno));
+			status = jm_status_error;
+		}
+	}
+#endif
+	return status;
+}
+
+jm_status_enu_t jm_map_file(jm_callbacks* cb, const char* fileName, jm_mapped_file_t* map) {
+#ifdef WIN32
+	HANDLE file;
+	LARGE_INTEGER size;
+#else
+	struct stat st;
+	void* data;
+	int fd;
+#endif
+
+	if(!cb) {
+		cb = jm_get_default_callbacks();
+	}
+	map->data = 0;
+	map->size = 0;
+	map->handle = 0;
+#ifdef WIN32
+	file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE) {
+		jm_log_error(cb, module, "Could not open %s for reading", fileName);
+		return jm_status_error;
+	}
+	if(!GetFileSizeEx(file, &size) || size.QuadPart == 0 || (ULONGLONG)size.QuadPart > (size_t)-1) {
+		CloseHandle(file);
+		jm_log_error(cb, module, "Could not map %s: the file is empty or too large", fileName);
+		return jm_status_error;
+	}
+	map->handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if(map->handle) map->data = MapViewOfFile(map->handle, FILE_MAP_READ, 0, 0, 0);
+	if(!map->data) {
+		if(map->handle) CloseHandle(map->handle);
+		map->handle = 0;
+		jm_log_error(cb, module, "Could not map %s into memory", fileName);
+		return jm_status_error;
+	}
+	map->size = (size_t)size.QuadPart;
+#else
+	fd = open(fileName, O_RDONLY);
+	if(fd < 0) {
+		jm_log_error(cb, module, "Could not open %s for reading (%s)", fileName, strerror(errno));
+		return jm_status_error;
+	}
+	if(fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		jm_log_error(cb, module, "Could not map %s: the file is empty", fileName);
+		return jm_status_error;
+	}
+	data = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED) {
+		jm_log_error(cb, module, "Could not map %s into memory (%s)", fileName, strerror(errno));
+		return jm_status_error;
+	}
+	map->data = data;
+	map->size = (size_t)st.st_size;
+#endif
+	return jm_status_success;
+}
+
+void jm_unmap_file(jm_mapped_file_t* map) {
+	if(!map->data) return;
+#ifdef WIN32
+	UnmapViewOfFile(map->data);
+	CloseHandle(map->handle);
+#else
+	munmap((void*)map->data, map->size);
+#endif
+	map->data = 0;
+	map->size = 0;
+	map->handle = 0;
+}
+
+char* jm_portability_get_real_path(jm_callbacks* cb, const char* path, char* outPath, size_t len) {
+#ifdef WIN32
+	DWORD n;
+	if(!cb) {
+		cb = jm_get_default_callbacks();
+	}
+	n = GetFullPathName(path, (DWORD)len, outPath, NULL);
+	if(n == 0 || n >= len) {
+		jm_log_verbose(cb, module, "Could not get the full path of %s", path);
+		return 0;
+	}
+	return outPath;
+#else
+	char* resolved;
+	if(!cb) {
+		cb = jm_get_default_callbacks();
+	}
+	resolved = realpath(path, NULL);
+	if(!resolved) {
+		jm_log_verbose(cb, module, "Could not resolve the path %s (%s)", path, strerror(errno));
+		return 0;
+	}
+	if(strlen(resolved) + 1 > len) {
+		jm_log_verbose(cb, module, "Resolved path of %s is too long", path);
+		free(resolved);
+		return 0;
+	}
+	strcpy(outPath, resolved);
+	free(resolved);
+	return outPath;
+#endif
+}
+
+/* Check that a directory exists. Returns 0 or an errno value. */
+static int jm_check_dir(const char* dir) {
+#ifdef WIN32
+	DWORD attr = GetFileAttributes(dir);
+	if(attr == INVALID_FILE_ATTRIBUTES) return ENOENT;
+	if(!(attr & FILE_ATTRIBUTE_DIRECTORY)) return ENOTDIR;
+#else
+	struct stat st;
+	if(stat(dir, &st) != 0) return errno;
+	if(!S_ISDIR(st.st_mode)) return ENOTDIR;
+#endif
+	return 0;
+}
+
+char* jm_get_dir_abspath(jm_callbacks* cb, const char* dir, char* outPath, size_t len) {
+	int err;
+	size_t n;
 
-	if(jm_portability_set_current_working_directory(dir) != jm_status_success) {
-		jm_log_fatal(cb,module, "Could not change to the directory %s", dir);
-		jm_portability_set_current_working_directory(curDir);
+	if(!cb) {
+		cb = jm_get_default_callbacks();
+	}
+	/* Resolve the path without changing the working directory, which is shared by all threads */
+	err = jm_check_dir(dir);
+	if(err) {
+		jm_log_fatal(cb,module, "Could not access the directory %s (%s)", dir, strerror(err));
+		errno = err;
 		return 0;
-	};
-	if( jm_portability_get_current_working_directory(outPath, len) != jm_status_success) {
-		jm_log_fatal(cb,module, "Could not get absolute path for the directory (%s)", strerror(errno));
-		jm_portability_set_current_working_directory(curDir);
+	}
+	if(!jm_portability_get_real_path(cb, dir, outPath, len)) {
+		jm_log_fatal(cb,module, "Could not get absolute path for the directory %s", dir);
 		return 0;
-	};
-	jm_portability_set_current_working_directory(curDir);
+	}
+	/* No terminating separator unless it is a root directory */
+	n = strlen(outPath);
+	while(n > 1 && (outPath[n-1] == '/' || outPath[n-1] == '\\') && outPath[n-2] != ':') {
+		outPath[--n] = 0;
+	}
 	return outPath;
 }
 
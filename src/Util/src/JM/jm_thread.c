@@ -0,0 +1,297 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/* Thread affinity functions of glibc */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <JM/jm_thread.h>
+#include <JM/jm_callbacks.h>
+
+#ifndef JM_THREAD_WIN32
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#endif
+
+/* Start routine argument. Freed by the started thread. */
+typedef struct jm_thread_start_t {
+	jm_thread_func_ft func;
+	void* arg;
+} jm_thread_start_t;
+
+static jm_thread_start_t* jm_thread_start_alloc(jm_thread_func_ft func, void* arg) {
+	jm_thread_start_t* s = (jm_thread_start_t*)jm_get_default_callbacks()->malloc(sizeof(jm_thread_start_t));
+	if(s) {
+		s->func = func;
+		s->arg = arg;
+	}
+	return s;
+}
+
+static void jm_thread_start_run(jm_thread_start_t* s) {
+	jm_thread_func_ft func = s->func;
+	void* arg = s->arg;
+	jm_get_default_callbacks()->free(s);
+	func(arg);
+}
+
+#ifdef JM_THREAD_WIN32
+
+jm_status_enu_t jm_mutex_init(jm_mutex_t* m) {
+	InitializeSRWLock(&m->lock);
+	return jm_status_success;
+}
+
+void jm_mutex_destroy(jm_mutex_t* m) {
+	/* SRW locks need no clean-up */
+}
+
+void jm_mutex_lock(jm_mutex_t* m) {
+	AcquireSRWLockExclusive(&m->lock);
+}
+
+void jm_mutex_unlock(jm_mutex_t* m) {
+	ReleaseSRWLockExclusive(&m->lock);
+}
+
+jm_status_enu_t jm_cond_init(jm_cond_t* c) {
+	InitializeConditionVariable(&c->cond);
+	return jm_status_success;
+}
+
+void jm_cond_destroy(jm_cond_t* c) {
+	/* Condition variables need no clean-up */
+}
+
+void jm_cond_wait(jm_cond_t* c, jm_mutex_t* m) {
+	SleepConditionVariableSRW(&c->cond, &m->lock, INFINITE, 0);
+}
+
+int jm_cond_timed_wait(jm_cond_t* c, jm_mutex_t* m, double seconds) {
+	return SleepConditionVariableSRW(&c->cond, &m->lock, (DWORD)(seconds * 1000.0), 0) != 0;
+}
+
+void jm_cond_signal(jm_cond_t* c) {
+	WakeConditionVariable(&c->cond);
+}
+
+void jm_cond_broadcast(jm_cond_t* c) {
+	WakeAllConditionVariable(&c->cond);
+}
+
+static DWORD WINAPI jm_thread_start_routine(LPVOID p) {
+	jm_thread_start_run((jm_thread_start_t*)p);
+	return 0;
+}
+
+jm_status_enu_t jm_thread_create(jm_thread_t* t, jm_thread_func_ft func, void* arg) {
+	jm_thread_start_t* s = jm_thread_start_alloc(func, arg);
+	if(!s) return jm_status_error;
+	t->handle = CreateThread(NULL, 0, jm_thread_start_routine, s, 0, NULL);
+	if(!t->handle) {
+		jm_get_default_callbacks()->free(s);
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+void jm_thread_join(jm_thread_t* t) {
+	WaitForSingleObject(t->handle, INFINITE);
+	CloseHandle(t->handle);
+}
+
+size_t jm_thread_get_cpus_num(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors > 0) ? (size_t)info.dwNumberOfProcessors : 1;
+}
+
+jm_status_enu_t jm_thread_pin_current(size_t cpu) {
+	if(cpu >= 8 * sizeof(DWORD_PTR)) return jm_status_error;
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) ? jm_status_success : jm_status_error;
+}
+
+jm_status_enu_t jm_thread_key_create(jm_thread_key_t* k) {
+	k->index = TlsAlloc();
+	return (k->index != TLS_OUT_OF_INDEXES) ? jm_status_success : jm_status_error;
+}
+
+void jm_thread_key_delete(jm_thread_key_t* k) {
+	TlsFree(k->index);
+}
+
+void* jm_thread_key_get(jm_thread_key_t* k) {
+	return TlsGetValue(k->index);
+}
+
+void jm_thread_key_set(jm_thread_key_t* k, void* value) {
+	TlsSetValue(k->index, value);
+}
+
+#else
+
+jm_status_enu_t jm_mutex_init(jm_mutex_t* m) {
+	return (pthread_mutex_init(&m->lock, 0) == 0) ? jm_status_success : jm_status_error;
+}
+
+void jm_mutex_destroy(jm_mutex_t* m) {
+	pthread_mutex_destroy(&m->lock);
+}
+
+void jm_mutex_lock(jm_mutex_t* m) {
+	pthread_mutex_lock(&m->lock);
+}
+
+void jm_mutex_unlock(jm_mutex_t* m) {
+	pthread_mutex_unlock(&m->lock);
+}
+
+jm_status_enu_t jm_cond_init(jm_cond_t* c) {
+	return (pthread_cond_init(&c->cond, 0) == 0) ? jm_status_success : jm_status_error;
+}
+
+void jm_cond_destroy(jm_cond_t* c) {
+	pthread_cond_destroy(&c->cond);
+}
+
+void jm_cond_wait(jm_cond_t* c, jm_mutex_t* m) {
+	pthread_cond_wait(&c->cond, &m->lock);
+}
+
+int jm_cond_timed_wait(jm_cond_t* c, jm_mutex_t* m, double seconds) {
+	struct timespec ts;
+	long nsec;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	nsec = ts.tv_nsec + (long)((seconds - (double)(long)seconds) * 1e9);
+	ts.tv_sec += (time_t)seconds + nsec / 1000000000L;
+	ts.tv_nsec = nsec % 1000000000L;
+	return pthread_cond_timedwait(&c->cond, &m->lock, &ts) != ETIMEDOUT;
+}
+
+void jm_cond_signal(jm_cond_t* c) {
+	pthread_cond_signal(&c->cond);
+}
+
+void jm_cond_broadcast(jm_cond_t* c) {
+	pthread_cond_broadcast(&c->cond);
+}
+
+static void* jm_thread_start_routine(void* p) {
+	jm_thread_start_run((jm_thread_start_t*)p);
+	return 0;
+}
+
+jm_status_enu_t jm_thread_create(jm_thread_t* t, jm_thread_func_ft func, void* arg) {
+	jm_thread_start_t* s = jm_thread_start_alloc(func, arg);
+	if(!s) return jm_status_error;
+	if(pthread_create(&t->handle, 0, jm_thread_start_routine, s) != 0) {
+		jm_get_default_callbacks()->free(s);
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+void jm_thread_join(jm_thread_t* t) {
+	pthread_join(t->handle, 0);
+}
+
+size_t jm_thread_get_cpus_num(void) {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? (size_t)n : 1;
+}
+
+jm_status_enu_t jm_thread_pin_current(size_t cpu) {
+#if defined(__linux__) && defined(CPU_SET)
+	cpu_set_t set;
+	if(cpu >= CPU_SETSIZE) return jm_status_error;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return (sched_setaffinity(0, sizeof(set), &set) == 0) ? jm_status_success : jm_status_error;
+#else
+	/* Affinity is only a hint on other systems, e.g., macOS, and is not supported */
+	return jm_status_error;
+#endif
+}
+
+jm_status_enu_t jm_thread_key_create(jm_thread_key_t* k) {
+	return (pthread_key_create(&k->key, 0) == 0) ? jm_status_success : jm_status_error;
+}
+
+void jm_thread_key_delete(jm_thread_key_t* k) {
+	pthread_key_delete(k->key);
+}
+
+void* jm_thread_key_get(jm_thread_key_t* k) {
+	return pthread_getspecific(k->key);
+}
+
+void jm_thread_key_set(jm_thread_key_t* k, void* value) {
+	pthread_setspecific(k->key, value);
+}
+
+#endif
+
+size_t jm_atomic_load_acquire(volatile size_t* p) {
+#if defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#elif defined(JM_THREAD_WIN32)
+	size_t value = *p;
+	MemoryBarrier();
+	return value;
+#else
+	size_t value = *p;
+	__sync_synchronize();
+	return value;
+#endif
+}
+
+void jm_atomic_store_release(volatile size_t* p, size_t value) {
+#if defined(__GNUC__) && defined(__ATOMIC_RELEASE)
+	__atomic_store_n(p, value, __ATOMIC_RELEASE);
+#elif defined(JM_THREAD_WIN32)
+	MemoryBarrier();
+	*p = value;
+#else
+	__sync_synchronize();
+	*p = value;
+#endif
+}
+
+int jm_atomic_compare_exchange(volatile size_t* p, size_t expected, size_t desired) {
+#if defined(__GNUC__) && defined(__ATOMIC_SEQ_CST)
+	return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#elif defined(JM_THREAD_WIN32)
+	return InterlockedCompareExchangePointer((PVOID volatile*)p, (PVOID)desired, (PVOID)expected) == (PVOID)expected;
+#else
+	return __sync_bool_compare_and_swap(p, expected, desired);
+#endif
+}
+
+size_t jm_atomic_fetch_add(volatile size_t* p, size_t value) {
+#if defined(__GNUC__) && defined(__ATOMIC_SEQ_CST)
+	return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+#elif defined(JM_THREAD_WIN32) && defined(_WIN64)
+	return (size_t)InterlockedExchangeAdd64((LONGLONG volatile*)p, (LONGLONG)value);
+#elif defined(JM_THREAD_WIN32)
+	return (size_t)InterlockedExchangeAdd((LONG volatile*)p, (LONG)value);
+#else
+	return __sync_fetch_and_add(p, value);
+#endif
+}
@@ -0,0 +1,248 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <JM/jm_thread.h>
+#include <JM/jm_thread_pool.h>
+
+static const char* module = "JMPOOL";
+
+/* Range of task indices owned by one thread. The owner takes tasks from the back,
+   thieves from the front. */
+typedef struct jm_thread_pool_queue_t {
+	jm_mutex_t lock;
+	unsigned long generation; /* run the range belongs to */
+	size_t first;
+	size_t last; /* one past the last task */
+} jm_thread_pool_queue_t;
+
+typedef struct jm_thread_pool_worker_t {
+	jm_thread_pool_t* pool;
+	size_t index;
+	jm_thread_t thread;
+} jm_thread_pool_worker_t;
+
+struct jm_thread_pool_t {
+	jm_callbacks* callbacks;
+	size_t threadsNum;
+	jm_thread_pool_queue_t* queues;   /* threadsNum, queue 0 belongs to the calling thread */
+	jm_thread_pool_worker_t* workers; /* threadsNum - 1 */
+	size_t workersStarted;
+
+	jm_mutex_t runLock; /* serializes jm_thread_pool_run() */
+
+	jm_mutex_t lock;    /* protects the fields below */
+	jm_cond_t workCond;
+	jm_cond_t doneCond;
+	unsigned long generation;
+	size_t pending;
+	int shutdown;
+	jm_thread_pool_task_ft task;
+	void* context;
+};
+
+static int jm_thread_pool_pop(jm_thread_pool_queue_t* q, unsigned long generation, size_t* index) {
+	int found = 0;
+	jm_mutex_lock(&q->lock);
+	if(q->generation == generation && q->first < q->last) {
+		*index = --q->last;
+		found = 1;
+	}
+	jm_mutex_unlock(&q->lock);
+	return found;
+}
+
+static int jm_thread_pool_steal(jm_thread_pool_queue_t* q, unsigned long generation, size_t* index) {
+	int found = 0;
+	jm_mutex_lock(&q->lock);
+	if(q->generation == generation && q->first < q->last) {
+		*index = q->first++;
+		found = 1;
+	}
+	jm_mutex_unlock(&q->lock);
+	return found;
+}
+
+/* Run tasks of the given run until all queues are empty. Tasks of other runs are
+   never taken, so a thread that is late for one run cannot mix up the task functions. */
+static void jm_thread_pool_work(jm_thread_pool_t* pool, size_t self, unsigned long generation, jm_thread_pool_task_ft task, void* context) {
+	size_t index, done = 0;
+
+	for(;;) {
+		size_t k;
+		int found = jm_thread_pool_pop(&pool->queues[self], generation, &index);
+		for(k = 1; !found && k < pool->threadsNum; k++) {
+			found = jm_thread_pool_steal(&pool->queues[(self + k) % pool->threadsNum], generation, &index);
+		}
+		if(!found) break;
+		task(context, index);
+		done++;
+	}
+
+	if(done) {
+		jm_mutex_lock(&pool->lock);
+		pool->pending -= done;
+		if(pool->pending == 0) {
+			jm_cond_broadcast(&pool->doneCond);
+		}
+		jm_mutex_unlock(&pool->lock);
+	}
+}
+
+static void jm_thread_pool_worker(void* arg) {
+	jm_thread_pool_worker_t* w = (jm_thread_pool_worker_t*)arg;
+	jm_thread_pool_t* pool = w->pool;
+	unsigned long seen = 0;
+
+	for(;;) {
+		jm_thread_pool_task_ft task;
+		void* context;
+
+		jm_mutex_lock(&pool->lock);
+		/* Wait for a run that still has pending tasks. A run that finished before this
+		   thread got here needs no help. */
+		while(!pool->shutdown && (pool->generation == seen || pool->pending == 0)) {
+			seen = pool->generation;
+			jm_cond_wait(&pool->workCond, &pool->lock);
+		}
+		if(pool->shutdown) {
+			jm_mutex_unlock(&pool->lock);
+			return;
+		}
+		seen = pool->generation;
+		task = pool->task;
+		context = pool->context;
+		jm_mutex_unlock(&pool->lock);
+
+		jm_thread_pool_work(pool, w->index, seen, task, context);
+	}
+}
+
+jm_thread_pool_t* jm_thread_pool_create(jm_callbacks* cb, size_t threadsNum) {
+	jm_thread_pool_t* pool;
+	size_t i;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	if(threadsNum < 1) threadsNum = 1;
+
+	pool = (jm_thread_pool_t*)cb->calloc(1, sizeof(jm_thread_pool_t));
+	if(pool) {
+		pool->queues = (jm_thread_pool_queue_t*)cb->calloc(threadsNum, sizeof(jm_thread_pool_queue_t));
+		pool->workers = (jm_thread_pool_worker_t*)cb->calloc(threadsNum, sizeof(jm_thread_pool_worker_t));
+	}
+	if(!pool || !pool->queues || !pool->workers) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		if(pool) {
+			cb->free(pool->queues);
+			cb->free(pool->workers);
+			cb->free(pool);
+		}
+		return 0;
+	}
+	pool->callbacks = cb;
+	pool->threadsNum = threadsNum;
+	jm_mutex_init(&pool->runLock);
+	jm_mutex_init(&pool->lock);
+	jm_cond_init(&pool->workCond);
+	jm_cond_init(&pool->doneCond);
+	for(i = 0; i < threadsNum; i++) {
+		jm_mutex_init(&pool->queues[i].lock);
+	}
+
+	for(i = 1; i < threadsNum; i++) {
+		jm_thread_pool_worker_t* w = &pool->workers[pool->workersStarted];
+		w->pool = pool;
+		w->index = i;
+		if(jm_thread_create(&w->thread, jm_thread_pool_worker, w) != jm_status_success) {
+			jm_log_error(cb, module, "Could not start worker thread");
+			jm_thread_pool_destroy(pool);
+			return 0;
+		}
+		pool->workersStarted++;
+	}
+	jm_log_verbose(cb, module, "Started thread pool with %u threads", (unsigned)threadsNum);
+	return pool;
+}
+
+void jm_thread_pool_destroy(jm_thread_pool_t* pool) {
+	jm_callbacks* cb;
+	size_t i;
+
+	if(!pool) return;
+	cb = pool->callbacks;
+
+	jm_mutex_lock(&pool->lock);
+	pool->shutdown = 1;
+	jm_cond_broadcast(&pool->workCond);
+	jm_mutex_unlock(&pool->lock);
+	for(i = 0; i < pool->workersStarted; i++) {
+		jm_thread_join(&pool->workers[i].thread);
+	}
+
+	for(i = 0; i < pool->threadsNum; i++) {
+		jm_mutex_destroy(&pool->queues[i].lock);
+	}
+	jm_cond_destroy(&pool->doneCond);
+	jm_cond_destroy(&pool->workCond);
+	jm_mutex_destroy(&pool->lock);
+	jm_mutex_destroy(&pool->runLock);
+	cb->free(pool->queues);
+	cb->free(pool->workers);
+	cb->free(pool);
+}
+
+size_t jm_thread_pool_get_threads_num(jm_thread_pool_t* pool) {
+	return pool->threadsNum;
+}
+
+void jm_thread_pool_run(jm_thread_pool_t* pool, size_t tasksNum, jm_thread_pool_task_ft task, void* context) {
+	unsigned long generation;
+	size_t i;
+
+	if(tasksNum == 0) return;
+
+	jm_mutex_lock(&pool->runLock);
+
+	/* Fill the queues before the run is published, so that a worker that sees the new
+	   generation always finds its tasks. Only this thread changes the generation. */
+	generation = pool->generation + 1;
+
+	/* Contiguous ranges keep neighbouring tasks on one thread unless work is stolen */
+	for(i = 0; i < pool->threadsNum; i++) {
+		jm_thread_pool_queue_t* q = &pool->queues[i];
+		jm_mutex_lock(&q->lock);
+		q->generation = generation;
+		q->first = tasksNum * i / pool->threadsNum;
+		q->last = tasksNum * (i + 1) / pool->threadsNum;
+		jm_mutex_unlock(&q->lock);
+	}
+
+	jm_mutex_lock(&pool->lock);
+	pool->task = task;
+	pool->context = context;
+	pool->pending = tasksNum;
+	pool->generation = generation;
+	jm_cond_broadcast(&pool->workCond);
+	jm_mutex_unlock(&pool->lock);
+
+	jm_thread_pool_work(pool, 0, generation, task, context);
+
+	jm_mutex_lock(&pool->lock);
+	while(pool->pending > 0) {
+		jm_cond_wait(&pool->doneCond, &pool->lock);
+	}
+	jm_mutex_unlock(&pool->lock);
+
+	jm_mutex_unlock(&pool->runLock);
+}